@@ -28,6 +28,7 @@ ifeq (,$(findstring :,$(CURDIR)))
  export CD = cd
  export RMSUBDIR = rm -rf
  export MKDIR = mkdir
+ export CMP = cmp
  export NICE_BUILD_TIME = $(shell date +%Y/%m/%d\ %H:%M:%S)
  export BUILD_TIME = $(shell date +%Y%m%d_%H%M%S)
  export BUILD_DATE = $(shell date +%d%m%Y)
@@ -54,6 +55,7 @@ ifeq (,$(findstring :,$(CURDIR)))
  export CD = cd
  export RMSUBDIR = rmdir /Q /S
  export MKDIR = mkdir
+ export CMP = fc /b
  export NATIVE_EXE = .exe
  export BUILD_TIME = $(subst .,,$(subst :,,$(subst /,,$(shell echo %DATE:~6%%DATE:~3,2%%DATE:~0,2%_%TIME:~0,8%))))
  export BUILD_DATE =$(subst /,_,$(shell echo %DATE%))
@@ -0,0 +1,51 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: arena
+ *    desc: This file describes the arena allocator. The arena hands out memory
+ *          from large blocks and all of it is released in one go, it is used for
+ *          the many small items that all have the same lifetime.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 11:02:17
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#define ARENA_BLOCK_SIZE	(64 * 1024)
+#define ARENA_ALIGNMENT		(8)
+
+/*--------------------------------------------------------------------------------*
+ * The arena structures.
+ *
+ * The data of a block follows the block header. An arena that is all zeros is an
+ * empty arena, the first block is allocated on the first allocation.
+ *--------------------------------------------------------------------------------*/
+typedef struct tag_arena_block
+{
+	unsigned int			size;
+	unsigned int			used;
+	struct tag_arena_block*	next;
+
+} ARENA_BLOCK;
+
+typedef struct
+{
+	ARENA_BLOCK*	blocks;
+
+} ARENA;
+
+/*--------------------------------------------------------------------------------*
+ * functions.
+ *--------------------------------------------------------------------------------*/
+void*			arena_alloc(ARENA* arena, unsigned int size);
+unsigned char*	arena_copy(ARENA* arena, const unsigned char* data, unsigned int size);
+void			arena_release(ARENA* arena);
+
+#endif
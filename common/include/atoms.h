@@ -1,19 +1,11 @@
 /*--------------------------------------------------------------------------------*
- * Name: Parser Look-up tree
- * Desc: function and data structures to speed up a specific string search
+ * Name: Keyword recogniser
+ * Desc: function and data structures to recognise a fixed set of keywords
  *
  *         **** DO NOT AMEND THIS CODE - IT IS AUTO_GENERATED ****
  *
  * Code and table produced by:
- *            build_graph 
- *            version 0.8
- *
- *  written by Peter Antoine. 
- *
- *   **** This code can be used however you like, no claims whatsoever are ****
- *   **** placed on the auto-generated code or data, or on the code that   ****
- *   **** uses the that code or data.                                      ****
- *   **** Or, to paraphrase "Fill your boots".                             ****
+ *            common/tools/keyword_hash
  *--------------------------------------------------------------------------------*/
 
 #ifndef	__ATOMS_H__
@@ -79,7 +71,6 @@ typedef enum
 	ATOM_TYPE,
 	ATOM_VALUE,
 	ATOM_WAITFOR,
-	ATOM_ZZZZ,
 	ATOM_NUM_STRINGS
 } ATOM_ATOMS;
 
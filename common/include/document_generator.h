@@ -17,6 +17,7 @@
 #define __DOCUMENT_GENERATOR_H__
 
 #include "atoms.h"
+#include "arena.h"
 #include "document_generator.h"
 #include <limits.h>
 
@@ -24,12 +25,11 @@
 #define	VERSION_MINOR		(0x00)
 
 #define	INVALID_ITEM		(UINT_MAX)
-#define DEFAULT_GROUP		(0xFFFF)
+#define DEFAULT_GROUP		(0xFFFFFFFF)
 #define MAX_NAME_LENGTH		(255)
 #define MAX_OUTPUT_COLUMNS	(255)
 
 #define MAX_RECORD_SIZE		(USHRT_MAX)
-#define MAX_GROUPS_PER_FILE	(0x7fff)
 
 #define MAX_FILENAME		((unsigned int)1024)
 
@@ -54,6 +54,8 @@ typedef struct tag_function FUNCTION;
  *--------------------------------------------------------------------------------*/
 #define COMPILED_SOURCE_MAGIC	{0x47,0x44,0x53,0x43}
 #define LINKED_SOURCE_MAGIC		{0x47,0x44,0x53,0x4c}
+#define LINKED_SOURCE_V2_MAGIC	{0x47,0x44,0x4c,0x32}
+#define OBJECT_ARCHIVE_MAGIC	{0x47,0x44,0x53,0x41}
 
 #define FILE_MAGIC			(0)
 #define FILE_VERSION_MAJOR	(4)
@@ -70,6 +72,15 @@ typedef struct tag_function FUNCTION;
 #define FILE_NAME_START		(16)
 #define FILE_HEADER_SIZE	(18)
 
+/* the object minor versions, each one keeps the changes of the ones before */
+#define OBJECT_VERSION_HASHED	(0x01)		/* the header carries a hash of the content */
+#define OBJECT_VERSION_WIDE		(0x02)		/* the records have varint fields, see object_record.h */
+#define OBJECT_VERSION_WIDE_IDS	(0x03)		/* the group field holds 32 bit ids, with the flags at the top */
+#define OBJECT_VERSION_MINOR	(OBJECT_VERSION_WIDE_IDS)
+
+#define FILE_CONTENT_HASH		(18)
+#define FILE_HASHED_HEADER_SIZE	(22)
+
 /*--------------------------------------------------------------------------------*
  * general file format
  *--------------------------------------------------------------------------------*/
@@ -91,7 +102,7 @@ typedef struct tag_function FUNCTION;
 #define INTERMEDIATE_RECORD_BOOLEAN		(14)
 #define INTERMEDIATE_RECORD_APPLICATION	(15)
 
-/* record format */
+/* record format, the later objects have varint fields after the atom */
 #define RECORD_TYPE			(0)
 #define RECORD_ATOM			(1)
 #define RECORD_GROUP		(2)		/* group and api and function and application share the same field */ 
@@ -103,9 +114,14 @@ typedef struct tag_function FUNCTION;
 #define RECORD_DATA_SIZE	(8) 
 #define RECORD_DATA_START	(10) 
 
-#define RECORD_FUNC_API_MASK	(0xC000)
-#define RECORD_FUNCTION_FLAG	(0xC000)
-#define RECORD_API_FLAG			(0x8000)
+#define RECORD_FUNC_API_MASK	(0xC0000000)
+#define RECORD_FUNCTION_FLAG	(0xC0000000)
+#define RECORD_API_FLAG			(0x80000000)
+
+/* the group field of the objects before OBJECT_VERSION_WIDE_IDS */
+#define RECORD_SHORT_DEFAULT_GROUP	(0xFFFF)
+#define RECORD_SHORT_FUNC_API_MASK	(0xC000)
+#define RECORD_SHORT_FLAGS_SHIFT	(16)
 
 #define RECORD_GROUP_TYPE		(0x01)	/* The record group contains a single type */
 #define RECORD_GROUP_RECORD		(0x02)	/* The record group contains a record structure */
@@ -126,6 +142,133 @@ typedef struct tag_function FUNCTION;
 #define LINKER_NAME_START_OFF		(16)
 #define LINKER_HEADER_SIZE			(18)
 
+/*--------------------------------------------------------------------------------*
+ * linker file format version 2
+ *
+ * The version 2 file starts with a table of contents that says where each of
+ * the sections of the model are. The sections are not blocked, they are the
+ * linker records (below) back to back, so any section can be read on its own.
+ * The TOC entries are fixed size so an entry can be found without reading the
+ * ones before it. The names of the entries are in the string table section,
+ * and all the numbers are big endian.
+ *
+ *	header		= {magic,byte:major,byte:minor,date(6),long:toc_offset,long:toc_entries,long:file_size}
+ *	toc_entry	= {byte:type,byte:name_length,short:0,long:offset,long:length,long:name_offset}
+ *
+ * There is only one string table, samples and applications section, there is
+ * an entry for every group in the model even if it is empty. A partial model
+ * only has the link model and the unresolved sections (see below).
+ *--------------------------------------------------------------------------------*/
+#define LINKER_V2_TOC_OFF			(12)
+#define LINKER_V2_TOC_ENTRIES_OFF	(16)
+#define LINKER_V2_FILE_SIZE_OFF		(20)
+#define LINKER_V2_HEADER_SIZE		(24)
+
+#define LINKER_TOC_TYPE				(0)
+#define LINKER_TOC_NAME_LENGTH		(1)
+#define LINKER_TOC_OFFSET			(4)
+#define LINKER_TOC_LENGTH			(8)
+#define LINKER_TOC_NAME_OFFSET		(12)
+#define LINKER_TOC_ENTRY_SIZE		(16)
+
+#define LINKER_SECTION_STRINGS		(1)		/* the names of the toc entries */
+#define LINKER_SECTION_SAMPLES		(2)		/* the samples */
+#define LINKER_SECTION_APPLICATIONS	(3)		/* the applications */
+#define LINKER_SECTION_GROUP		(4)		/* the state machine, sequence diagram and api of a group */
+#define LINKER_SECTION_LINK_STATE	(5)		/* the objects of an incremental link, only pdsl reads it */
+#define LINKER_SECTION_LINK_MODEL	(6)		/* the merged model of a partial link, only pdsl reads it */
+#define LINKER_SECTION_UNRESOLVED	(7)		/* the symbols that a partial link did not resolve */
+
+/*--------------------------------------------------------------------------------*
+ * The link state section is written by "pdsl -i". It is not linker records, it
+ * has an entry for each object in the order they were linked, with the things
+ * in the model that the object added to. The touch types are LINK_TOUCH_*.
+ *
+ *	link_state	= {long:num_objects, object...}
+ *	object		= {short:name_length, name, long:size, long:fingerprint, long:num_touches, touch...}
+ *	touch		= {byte:type, short:name_length, name}
+ *--------------------------------------------------------------------------------*/
+#define LINK_TOUCH_GROUP			(1)
+#define LINK_TOUCH_FUNCTION			(2)
+#define LINK_TOUCH_SAMPLES			(3)
+#define LINK_TOUCH_APPLICATIONS		(4)
+
+/*--------------------------------------------------------------------------------*
+ * The link model section is written by "pdsl -r". It is the model once all the
+ * objects have been merged, before it is checked, so the triggers, states and
+ * functions that were not found are still ghosts and the messages are still
+ * names. A later link merges it in the place of the objects, as if they had
+ * been merged again.
+ *
+ * The records have the header of the object records (see object_record.h). The
+ * group field is the index of the group, function or application that the
+ * record adds to, in the order that they are declared. The first group is the
+ * document and it is not declared, the first function and application are the
+ * unnamed ones. The declarations use the object record types, so that the
+ * link state finds them as it does in an object, and a group named "all" after
+ * the first group says that the objects used "all" for that group.
+ *
+ *	string		= {varint:length, bytes}
+ *	name		= {byte:fixed, string}
+ *	group_ref	= {varint:index plus one, zero is no group}
+ *	block_name	= {group_ref:owner, string:name}, an empty name is no name
+ *	triggers	= {varint:num_triggers, block_name...}
+ *
+ *	group		= INTERMEDIATE_RECORD_GROUP, the payload is the name
+ *	function	= INTERMEDIATE_RECORD_FUNCTION, the block is the flags, the payload is the name
+ *	application	= INTERMEDIATE_RECORD_APPLICATION, the payload is the name
+ *	sample		= INTERMEDIATE_RECORD_SAMPLE, the payload is the same as in the object
+ *	trigger		= {string:name}, the block is the flags
+ *	state		= {string:name}, the block is the flags and the line is its line
+ *	timeline	= {string:name}, the block is the flags and the line is its line
+ *	transition	= {string:state, string:next_state, string:condition, block_name:trigger, triggers}
+ *	node		= {string:timeline, group_ref, block_name:trigger, triggers, string:function,
+ *				   string:message, block_name:to_timeline, block_name:wait, block_name:after},
+ *				  the block is the flags and the line is its line
+ *	func_node	= {string:call, block_name:message, block_name:after, block_name:sequence,
+ *				   block_name:condition, block_name:to_timeline, block_name:trigger, triggers},
+ *				  the block is the flags
+ *	api_func	= {name:name, name:return_type, name:action, name:description,
+ *				   varint:num_parameters, {name:name, name:type, name:brief}...,
+ *				   varint:num_returns, {name:value, name:brief}...}
+ *	api_brief	= {string:function, name:parameter, name:brief}
+ *	api_type	= {name:name, name:description, varint:depth, varint:num_records,
+ *				   {varint:record_type, name:type_item, name:name_value, name:brief}...}
+ *	constants	= {name:name, name:description, varint:num_constants,
+ *				   {varint:constant, name:name, name:type, name:brief, name:value}...}
+ *	option		= {name:name, name:value, name:description}, the block is the flags
+ *	section		= {name:name, name:data}
+ *	synopsis	= {name:name, name:items}
+ *
+ * The api_brief records are the parameter briefs that did not find their
+ * parameter, they are looked for again in the model that the partial model is
+ * merged into.
+ *
+ * The unresolved section has a record for each symbol that the link could not
+ * find, the type says what the symbol is and the payload is {string:group,
+ * string:name}. The symbols are still in the link model, so this is for the
+ * build to see what is missing.
+ *--------------------------------------------------------------------------------*/
+#define LINK_MODEL_TRIGGER			(0x20)
+#define LINK_MODEL_STATE			(0x21)
+#define LINK_MODEL_TIMELINE			(0x22)
+#define LINK_MODEL_TRANSITION		(0x23)
+#define LINK_MODEL_NODE				(0x24)
+#define LINK_MODEL_FUNCTION_NODE	(0x25)
+#define LINK_MODEL_API_FUNCTION		(0x26)
+#define LINK_MODEL_API_BRIEF		(0x27)
+#define LINK_MODEL_API_TYPE			(0x28)
+#define LINK_MODEL_API_CONSTANTS	(0x29)
+#define LINK_MODEL_OPTION			(0x2a)
+#define LINK_MODEL_SECTION			(0x2b)
+#define LINK_MODEL_SYNOPSIS			(0x2c)
+
+#define LINK_UNRESOLVED_TRIGGER		(1)		/* a trigger that nothing fires */
+#define LINK_UNRESOLVED_STATE		(2)		/* a state that is the target of a transition and not defined */
+#define LINK_UNRESOLVED_FUNCTION	(3)		/* a function that is called and not defined */
+#define LINK_UNRESOLVED_MESSAGE		(4)		/* a message that is sent and that nothing waits for */
+#define LINK_UNRESOLVED_WAIT		(5)		/* a message that is waited for and is not sent */
+
 /* record layout */
 #define LINKER_RECORD_TYPE			(0)
 #define LINKER_RECORD_SIZE			(1)
@@ -137,6 +280,10 @@ typedef struct tag_function FUNCTION;
  *  all data items are size,bytes for strings. BYTE = 1 byte, SHORT = 2 bytes, and
  *  LONG = 4 bytes.
  *
+ *  The start records, the condition, and the api description and action are
+ *  {byte:fixed,size,bytes}. The size is a SHORT in the version 1 model and a
+ *  varint (see object_record.h) in the version 2 model.
+ *
  *	linker_end					= {}
  *  linker_trigger				= {string:name}
  *  linker_triggers				= {string:name}
@@ -352,6 +499,7 @@ typedef struct tag_atom_list
 	unsigned int	multiline:1;
 	ATOM_BLOCK		index;
 	ATOM_BLOCK*		last;
+	ARENA			arena;			/* holds the extra blocks and the strings of the atoms */
 
 } ATOM_INDEX;
 
@@ -430,11 +578,12 @@ typedef struct
 typedef struct tag_block_name
 {
 	unsigned int		name_length;			/* length of the trigger name */
-	unsigned char		name[MAX_NAME_LENGTH];	/* the trigger name */
+	unsigned char*		name;					/* the trigger name, from the string pool */
 	union
 	{
 		GROUP*			group;					/* the group the thing belongs to */
 		FUNCTION*		function;				/* the function it belongs to */
+		unsigned int	local_group;			/* the local id of the group plus one, before it is linked */
 	} owner;
 
 	struct tag_block_name*	next;
@@ -455,6 +604,7 @@ typedef struct
 	unsigned int	max_state_length;	/* max name length for the states */
 	STATE*			init_state;			/* state machine init node */
 	STATE*			state_list;			/* the nodes in a simple list */
+	STATE*			last_state;			/* the end of the list, the new states are added after it */
 	GROUP*			group;				/* the owner group */	
 } STATE_MACHINE;
 
@@ -462,7 +612,7 @@ typedef struct tag_trigger
 {
 	unsigned int		flags;					/* the status flags for the item */
 	unsigned int		name_length;
-	unsigned char		name[MAX_NAME_LENGTH];	/* the name of the trigger */
+	unsigned char*		name;					/* the name of the trigger, from the string pool */
 	GROUP*				group;					/* the group that the trigger belongs to */
 
 	struct tag_trigger*	next;
@@ -501,7 +651,7 @@ typedef struct
 
 typedef struct tag_parameter
 {
-	unsigned char	name[MAX_NAME_LENGTH];
+	unsigned char*	name;				/* from the string pool */
 	unsigned int	name_length;
 	unsigned int	parameter_type;	/* the type of the parameter */
 
@@ -520,7 +670,7 @@ typedef struct tag_node_list
 
 typedef struct tag_message
 {
-	unsigned char		name[MAX_NAME_LENGTH];	/* the name of the message */
+	unsigned char*		name;					/* the name of the message, from the string pool */
 	unsigned int		name_length;
 	unsigned int		flags;					/* flags - what type of message */
 	TIMELINE*			sending_timeline;		/* where the message is being sent from */
@@ -599,7 +749,7 @@ struct tag_function
 {
 	unsigned int	flags;						/* the flags for the function */
 	unsigned int	name_length;				/* the length of the name */
-	unsigned char	name[MAX_NAME_LENGTH];		/* name of the function */
+	unsigned char*	name;						/* name of the function, from the string pool */
 	FUNCTION_NODE*	node;						/* the nodes of the function */
 
 	struct tag_function*	next;
@@ -680,7 +830,7 @@ typedef struct tag_api_function
 	unsigned short	max_param_name_length;
 	unsigned short	max_param_type_length;
 	unsigned short	max_return_value_length;
-	unsigned short	api_id;						/* ID number associated with the API */
+	unsigned int	api_id;						/* ID number associated with the API */
 	NAME			name;
 	NAME			return_type;
 	NAME			action;
@@ -779,7 +929,7 @@ typedef struct tag_application
 
 struct tag_group
 {
-	unsigned char		name[MAX_NAME_LENGTH];
+	unsigned char*		name;					/* from the string pool */
 	unsigned int		name_length;
 	unsigned int		max_message_length;	/* the max message name length */
 	DOCUMENT*			document;			/* This only belongs in the root group, and is the document */
@@ -789,6 +939,8 @@ struct tag_group
 	APPLICATION*		application;		/* if not NULL the application details that belong to this group */
 	TRIGGER*			trigger_list;		/* the list of triggers that belong to this list */
 	SAMPLE*				sample_list;		/* the list of samples that belong to the group */
+	unsigned int		model_start;		/* the offset of the groups section in the linked file */
+	unsigned int		model_end;			/* the end of the groups records, 0 once they are loaded */
 	struct tag_group*	next;				/* the next group in the list */
 };
 
@@ -853,7 +1005,7 @@ typedef struct
 
 typedef struct
 {
-	unsigned short	size;
+	unsigned int	size;
 	unsigned char*	buffer;
 
 } RECORD_BITS;
@@ -863,6 +1015,8 @@ typedef struct
 	int				outfile;
 	unsigned int	parts;
 	unsigned int	offset;
+	unsigned int	written;			/* the number of bytes written to the file */
+	unsigned int	blocked;			/* pad the records into FILE_BLOCK_SIZE blocks */
 	unsigned int	record_size;
 	unsigned char*	buffer;
 	RECORD_BITS		buffer_list[20];
@@ -980,12 +1134,14 @@ void add_api_type_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, NAME* type, NAME* na
 #	define WRITE_FILE_PERM		(S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
 #	define READ_FILE_STATUS		(O_RDONLY)
 #	define DIR_DELIMETER		'/'
+#	define THREAD_LOCAL			__thread
 #elif defined(_WIN32)
 #	include <io.h>
 #	define WRITE_FILE_STATUS	(O_BINARY|O_TRUNC|O_CREAT|O_WRONLY)
 #	define WRITE_FILE_PERM		(S_IWRITE|S_IREAD)
 #	define READ_FILE_STATUS		(O_BINARY|O_RDONLY)
 #	define DIR_DELIMETER		'\\'
+#	define THREAD_LOCAL			__declspec(thread)
 #else
 	#error("Your OS is not supported. Sorry!");
 
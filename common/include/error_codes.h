@@ -130,6 +130,9 @@ typedef enum
 	EC_LARGE_JUMP_IN_INDEX_LEVELS,
 	EC_TOO_MANY_COLUMNS_IN_TABLE,
 	EC_INDEX_NOT_SUPPORTED_OF_THIS_ITEM,
+	EC_GRAPH_LAYOUT_DID_NOT_CONVERGE,
+	EC_AFTER_NODES_FORM_A_LOOP,
+	EC_PARTIAL_MODEL_ALL_GROUP_CHANGED,
 
 	EC_MAX_ERROR_CODE
 
@@ -16,12 +16,29 @@
 #ifndef __FILE_FUNCTIONS_H__
 #define __FILE_FUNCTIONS_H__
 
+/*--------------------------------------------------------------------------------*
+ * Mapped input file.
+ *
+ * The whole file is available at data[0..size). If mapped is set the memory
+ * belongs to the OS mapping, else it is a heap copy of the file. Either way it
+ * is read-only and must be released with unmap_input_file().
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned char*	data;
+	unsigned int	size;
+	unsigned int	mapped;
+
+} FILE_MAP;
+
 unsigned int	extend_path(unsigned char* path_name, unsigned int* path_length, unsigned char* extend_name, unsigned int extend_length);
 void			get_filename(unsigned char* path, unsigned char** file_name, unsigned int* file_name_length);
 unsigned int	copy_extend_path_name(unsigned char* new_file_buffer, unsigned char* path, unsigned int path_length, unsigned char* extend_name, unsigned int extend_length);
 unsigned int	copy_file(unsigned char* source_file_name, unsigned char* new_file_name);
 void			get_filename_with_ext(unsigned char* path, unsigned char** file_name, unsigned int* file_name_length);
 unsigned int	copy_files_to_directory(unsigned char** source_path, unsigned int number_files, unsigned char* directory_name, unsigned int directory_name_length);
+unsigned int	map_input_file(const char* file_name, FILE_MAP* file_map);
+void			unmap_input_file(FILE_MAP* file_map);
 
 #endif
 
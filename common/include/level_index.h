@@ -58,6 +58,7 @@ unsigned short	level_index_get_level(LEVEL_INDEX* index);
 unsigned short	level_index_get_previous_level(LEVEL_INDEX* index);
 unsigned short	level_index_get_index(LEVEL_INDEX* index, unsigned short level);
 unsigned int	level_index_gen_label(LEVEL_INDEX* index, unsigned int start_level, INDEX_STYLE style, unsigned char* buffer, unsigned int buffer_size ,unsigned char delimiter);
+void			level_index_copy(LEVEL_INDEX* index, LEVEL_INDEX* source);
 void			level_index_release(LEVEL_INDEX* index);
 
 #endif
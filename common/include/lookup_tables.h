@@ -19,27 +19,42 @@
 
 /*--------------------------------------------------------------------------------*
  * The Group lookup list structures.
+ *
+ * The items are held in blocks so that they do not move when the list grows,
+ * the id of an item is the order it was added in and does not change. The
+ * names are found through an open addressing hash index that holds the item
+ * id + 1 (zero is an empty slot). A zeroed LOOKUP_LIST is an empty list.
  *--------------------------------------------------------------------------------*/
-#define	LOOKUP_INDEX_SIZE	(100)
+#define	LOOKUP_INDEX_SIZE	(256)
+#define LOOKUP_INDEX_SHIFT	(8)
+#define LOOKUP_MIN_SLOTS	(64)
 
 typedef struct
 {
 	unsigned int	hash;
 	unsigned int	name_length;
 	unsigned int	payload_length;
-	unsigned short	line_num;
-	unsigned short	group_id;
+	unsigned int	line_num;
+	unsigned int	group_id;
 	unsigned char*	name;
 	unsigned char*	payload;
 
 } LOOKUP_ITEM;
 
-typedef struct tag_lookup_list
+typedef struct
 {
-	unsigned int	num_items;
 	LOOKUP_ITEM		lookup[LOOKUP_INDEX_SIZE];
 
-	struct tag_lookup_list*	next;
+} LOOKUP_BLOCK;
+
+typedef struct
+{
+	unsigned int	num_items;
+	unsigned int	num_blocks;
+	unsigned int	num_names;
+	unsigned int	num_slots;
+	unsigned int*	slot;
+	LOOKUP_BLOCK**	block;
 
 } LOOKUP_LIST;
 
@@ -48,11 +63,13 @@ typedef struct tag_lookup_list
  *--------------------------------------------------------------------------------*/
 
 LOOKUP_ITEM* 	find_lookup ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length );
-void			set_lookup_group(LOOKUP_ITEM *item, unsigned short group_id);
-void			set_lookup_name(LOOKUP_ITEM *item, NAME* name, unsigned short line_num);
+LOOKUP_ITEM*	get_lookup ( LOOKUP_LIST* lookup_list, unsigned int item_id );
+void			set_lookup_group(LOOKUP_ITEM *item, unsigned int group_id);
+void			set_lookup_name(LOOKUP_LIST* lookup_list, unsigned int item_id, NAME* name, unsigned int line_num);
 unsigned int	new_lookup ( LOOKUP_LIST* lookup_list );
-unsigned int	add_lookup ( LOOKUP_LIST* lookup_list, const char* name, unsigned int name_length, const char* payload, unsigned int payload_length, unsigned short line_num );
+unsigned int	add_lookup ( LOOKUP_LIST* lookup_list, const char* name, unsigned int name_length, const char* payload, unsigned int payload_length, unsigned int line_num );
 unsigned int	find_add_lookup ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length );
+void			release_lookup ( LOOKUP_LIST* lookup_list );
 
 #endif
 
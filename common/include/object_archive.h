@@ -0,0 +1,107 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: object_archive
+ *    desc: This file describes the object archives that pdsa builds and pdsl
+ *          reads. An archive holds many pdsc objects, so a big tree can be
+ *          linked from a few files instead of thousands.
+ *
+ *          All the numbers are big endian, as in the objects. The archive is:
+ *
+ *              header  : magic:4, major:1, minor:1, pad:2, num_members:4,
+ *                        num_symbols:4, strings_offset:4, strings_size:4
+ *              members : offset:4, size:4, name_offset:4, name_length:2, pad:2
+ *              symbols : type:1, pad:1, name_length:2, member:4, name_offset:4
+ *              strings : the member names and the symbol names
+ *              data    : the objects, as pdsc wrote them
+ *
+ *          The member offsets are from the start of the archive and the name
+ *          offsets are from the start of the strings. The symbols are the
+ *          groups, apis, functions and applications that each member names,
+ *          the type is the record type that the object uses for them.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 17:12:40
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __OBJECT_ARCHIVE_H__
+#define __OBJECT_ARCHIVE_H__
+
+#include "symbol_table.h"
+
+#define ARCHIVE_VERSION_MAJOR	(1)
+#define ARCHIVE_VERSION_MINOR	(0)
+
+#define ARCHIVE_MAGIC				(0)
+#define ARCHIVE_MAJOR				(4)
+#define ARCHIVE_MINOR				(5)
+#define ARCHIVE_NUM_MEMBERS			(8)
+#define ARCHIVE_NUM_SYMBOLS			(12)
+#define ARCHIVE_STRINGS_OFFSET		(16)
+#define ARCHIVE_STRINGS_SIZE		(20)
+#define ARCHIVE_HEADER_SIZE			(24)
+
+#define ARCHIVE_MEMBER_OFFSET		(0)
+#define ARCHIVE_MEMBER_SIZE			(4)
+#define ARCHIVE_MEMBER_NAME			(8)
+#define ARCHIVE_MEMBER_NAME_LENGTH	(12)
+#define ARCHIVE_MEMBER_ENTRY_SIZE	(16)
+
+#define ARCHIVE_SYMBOL_TYPE			(0)
+#define ARCHIVE_SYMBOL_NAME_LENGTH	(2)
+#define ARCHIVE_SYMBOL_MEMBER		(4)
+#define ARCHIVE_SYMBOL_NAME			(8)
+#define ARCHIVE_SYMBOL_ENTRY_SIZE	(12)
+
+#define ARCHIVE_MAX_NAME_LENGTH		(0xffff)
+
+/*--------------------------------------------------------------------------------*
+ * The archive structures.
+ * The names and the data are not copied, they point into the archive or into
+ * the objects that have been added, so those must live as long as the archive.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned char*	name;
+	unsigned int	name_length;
+	unsigned char*	data;
+	unsigned int	size;
+
+} ARCHIVE_MEMBER;
+
+typedef struct
+{
+	unsigned char	type;
+	unsigned int	member;
+	unsigned char*	name;
+	unsigned int	name_length;
+
+} ARCHIVE_SYMBOL;
+
+typedef struct
+{
+	unsigned int	num_members;
+	unsigned int	max_members;
+	ARCHIVE_MEMBER*	members;
+	unsigned int	num_symbols;
+	unsigned int	max_symbols;
+	ARCHIVE_SYMBOL*	symbols;
+	SYMBOL_TABLE	member_names;
+
+} OBJECT_ARCHIVE;
+
+/*--------------------------------------------------------------------------------*
+ * functions.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_archive_is_archive(unsigned char* data, unsigned int size);
+unsigned int	object_archive_read(OBJECT_ARCHIVE* archive, unsigned char* data, unsigned int size);
+unsigned int	object_archive_add(OBJECT_ARCHIVE* archive, unsigned char* name, unsigned int name_length, unsigned char* data, unsigned int size);
+unsigned int	object_archive_write(OBJECT_ARCHIVE* archive, const char* file_name);
+void			object_archive_release(OBJECT_ARCHIVE* archive);
+
+#endif
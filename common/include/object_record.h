@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: object_record
+ *    desc: This file describes the records of the object files that pdsc
+ *          writes and pdsl reads.
+ *
+ *          The first objects had fixed records, with 16 bit fields:
+ *
+ *              type:1, atom:1, group:2, block:2, line:2, data_size:2
+ *
+ *          From OBJECT_VERSION_WIDE on the record is:
+ *
+ *              type:1, atom:1, group:varint, block:varint, line:varint,
+ *              data_size:varint
+ *
+ *          A varint is an unsigned 32 bit value that is written seven bits a
+ *          byte, the lowest bits first. The top bit of a byte is set when
+ *          there are more bytes to follow. Small values take one byte, so the
+ *          objects are no bigger than they were, and the big values no longer
+ *          wrap.
+ *
+ *          From OBJECT_VERSION_WIDE_IDS on the group field is a 32 bit id with
+ *          the function and api flags in the top two bits. The older 16 bit
+ *          group fields are moved to this layout when they are read. The
+ *          default group and the flagged ids take five bytes.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 14:05:31
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __OBJECT_RECORD_H__
+#define __OBJECT_RECORD_H__
+
+#define OBJECT_VARINT_MAX_SIZE		(5)
+#define OBJECT_RECORD_MAX_HEADER	(2 + (4 * OBJECT_VARINT_MAX_SIZE))
+
+/*--------------------------------------------------------------------------------*
+ * The decoded record header.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned char	type;
+	unsigned char	atom;
+	unsigned int	group;			/* group and api and function and application share the same field */
+	unsigned int	block_number;
+	unsigned int	line_number;
+	unsigned int	data_size;
+
+} OBJECT_RECORD;
+
+/*--------------------------------------------------------------------------------*
+ * functions.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_record_encode(unsigned char* buffer, OBJECT_RECORD* record);
+unsigned int	object_record_decode(unsigned char* buffer, unsigned int size, unsigned int version, OBJECT_RECORD* record);
+unsigned int	object_record_encode_varint(unsigned char* buffer, unsigned int value);
+unsigned int	object_record_decode_varint(unsigned char* buffer, unsigned int size, unsigned int* value);
+
+#endif
@@ -172,6 +172,19 @@ typedef struct
 	unsigned int	remaining[MAX_TABLE_SIZE];
 } TABLE_ROW;
 
+/*--------------------------------------------------------------------------------*
+ * Structure for the buffered output.
+ *--------------------------------------------------------------------------------*/
+#define OUTPUT_SINK_SIZE	(64 * 1024)
+
+typedef struct
+{
+	unsigned int	used;
+	unsigned int	size;
+	unsigned char*	buffer;
+
+} OUTPUT_SINK;
+
 /*--------------------------------------------------------------------------------*
  * Structures to holds the drawing state.
  *--------------------------------------------------------------------------------*/
@@ -216,6 +229,8 @@ typedef struct tag_draw_state
 	unsigned int	global_format_flags;	/* this is used to reset the flags after every item */
 	unsigned int	global_number_level;	/* this is used to reset number level after every item */
 	unsigned int	global_max_constant;	/* this is used to reset the max_constant width */
+	unsigned int	graph_layout;			/* the layout used for state machine graphs */
+	unsigned int	graph_iterations;		/* the iteration budget for the graph layout (0 for default) */
 	unsigned char	path[MAX_FILENAME];
 	NAME			number_style;			/* the style that the number will be laid out in */
 	NAME			resources_path;			/* the path to the resources */
@@ -228,6 +243,7 @@ typedef struct tag_draw_state
 	LEVEL_INDEX		list_index;				/* index used for *text* lists */
 	GROUP*			model;					/* the model that is being rendered */
 	LOOKUP_LIST		macro_lookup;			/* the macros that are added to the system */
+	OUTPUT_SINK		sink;					/* buffered writes to the output_file */
 
 	union
 	{
@@ -237,6 +253,18 @@ typedef struct tag_draw_state
 	data;
 } DRAW_STATE;
 
+/*--------------------------------------------------------------------------------*
+ * Output sink functions.
+ *
+ * All output for the output_file should go through these. The formats open the
+ * output_file and should call output_sink_close() rather than close() so the
+ * buffered data is written before the file is closed.
+ *--------------------------------------------------------------------------------*/
+void	output_sink_write(DRAW_STATE* draw_state, const void* data, unsigned int data_size);
+void	output_sink_flush(DRAW_STATE* draw_state);
+void	output_sink_close(DRAW_STATE* draw_state);
+void	output_sink_release(DRAW_STATE* draw_state);
+
 /*--------------------------------------------------------------------------------*
  * Function Pointer Types for the output functions.
  *--------------------------------------------------------------------------------*/
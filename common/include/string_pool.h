@@ -0,0 +1,36 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: string_pool
+ *    desc: This file describes the string pool that holds the names of the
+ *          model. Each name is held once, so the model items point at the
+ *          name instead of each holding a buffer for it. The same name always
+ *          gives the same pointer, so two pooled names are the same name if
+ *          the pointers are the same.
+ *
+ *          The pooled strings are zero terminated, they must not be changed
+ *          and they live until the pool is released. The pool is not locked,
+ *          when the work pool is running the names must only be added while
+ *          the work pool lock is held.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 15:48:09
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __STRING_POOL_H__
+#define __STRING_POOL_H__
+
+/*--------------------------------------------------------------------------------*
+ * functions.
+ *--------------------------------------------------------------------------------*/
+unsigned char*	string_pool_add(const unsigned char* string, unsigned int length);
+unsigned char*	string_pool_find(const unsigned char* string, unsigned int length);
+void			string_pool_stats(void);
+void			string_pool_release(void);
+
+#endif
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: symbol_table
+ *    desc: This file describes the hashed symbol table that is used to find the
+ *          named items in the model. The symbols are keyed on a scope (the item
+ *          that owns the name, i.e. the group) and the name.
+ *
+ *          A table can instead be keyed on names from the string pool, these
+ *          are hashed and compared by their address. A table must only use one
+ *          of the two sets of find and add functions.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 10:12:31
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __SYMBOL_TABLE_H__
+#define __SYMBOL_TABLE_H__
+
+#define SYMBOL_TABLE_INITIAL_SIZE	(64)
+
+/*--------------------------------------------------------------------------------*
+ * The symbol table structures.
+ *
+ * The name in the symbol is not copied, it points to the name in the item so it
+ * must live as long as the item does. The counters are not locked, they are only
+ * statistics.
+ *--------------------------------------------------------------------------------*/
+typedef struct tag_symbol
+{
+	unsigned int		hash;
+	unsigned int		name_length;
+	unsigned char*		name;
+	void*				scope;
+	void*				item;
+
+	struct tag_symbol*	next;
+
+} SYMBOL;
+
+typedef struct
+{
+	unsigned int	num_symbols;
+	unsigned int	num_buckets;
+	unsigned int	lookups;
+	unsigned int	found;
+	unsigned int	compares;
+	SYMBOL**		bucket;
+
+} SYMBOL_TABLE;
+
+/*--------------------------------------------------------------------------------*
+ * functions.
+ *--------------------------------------------------------------------------------*/
+void*			symbol_table_find(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length);
+unsigned int	symbol_table_add(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length, void* item);
+void*			symbol_table_find_interned(SYMBOL_TABLE* table, void* scope, unsigned char* name);
+unsigned int	symbol_table_add_interned(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length, void* item);
+void			symbol_table_stats(SYMBOL_TABLE* table, const char* table_name);
+void			symbol_table_release(SYMBOL_TABLE* table);
+
+#endif
@@ -1,19 +1,11 @@
 /*--------------------------------------------------------------------------------*
- * Name: Parser Look-up tree
- * Desc: function and data structures to speed up a specific string search
+ * Name: Keyword recogniser
+ * Desc: function and data structures to recognise a fixed set of keywords
  *
  *         **** DO NOT AMEND THIS CODE - IT IS AUTO_GENERATED ****
  *
  * Code and table produced by:
- *            build_graph 
- *            version 0.8
- *
- *  written by Peter Antoine. 
- *
- *   **** This code can be used however you like, no claims whatsoever are ****
- *   **** placed on the auto-generated code or data, or on the code that   ****
- *   **** uses the that code or data.                                      ****
- *   **** Or, to paraphrase "Fill your boots".                             ****
+ *            common/tools/keyword_hash
  *--------------------------------------------------------------------------------*/
 
 #ifndef	__SYMBOLS_H__
@@ -44,7 +36,6 @@ typedef enum
 	SYMBOLS_UNSIGNED,
 	SYMBOLS_VOID,
 	SYMBOLS_VOLATILE,
-	SYMBOLS_ZZZZ,
 	SYMBOLS_NUM_STRINGS
 } SYMBOLS_SYMBOLS;
 
@@ -33,11 +33,12 @@ NODE*			search_next_node(NODE* current_node, NODE** active_node);
 NODE*			next_active_node(NODE* current_node);
 GROUP*			add_group ( GROUP* group_tree, unsigned char* name, unsigned int name_length );
 GROUP* 			find_group ( GROUP* group_tree, unsigned char* name, unsigned int name_length, unsigned int* all_groups );
-TIMELINE* 		find_timeline ( GROUP* group, unsigned char* name, unsigned int name_length );
+TIMELINE* 		find_timeline ( GROUP* group, unsigned char* name );
 TIMELINE* 		add_timeline ( GROUP* group, unsigned char* name, unsigned int name_length, unsigned int line_number, unsigned int flags );
 STATE* 			add_state ( GROUP* group, unsigned char* name, unsigned int name_length, unsigned int line_number, unsigned int flags );
-STATE* 			find_state ( GROUP* group, unsigned char* name, unsigned int name_length );
+STATE* 			find_state ( GROUP* group, unsigned char* name );
 void			copy_name(NAME* from, NAME* to);
+void			reference_name(NAME* from, NAME* to);
 int				compare_name(NAME* one, NAME* two);
 void			concat_names(NAME* new_name, NAME* first_name, NAME* second_name, NAME* third_name);
 void			allocate_name(NAME* new_name,unsigned int name_size);
@@ -45,6 +46,8 @@ void			append_string(NAME* name, unsigned char* string, unsigned int string_size
 void			append_name(NAME* name, NAME* append);
 void			free_name(NAME* name);
 unsigned int	lfsr_32(unsigned int seed);
+void			model_symbol_stats(void);
+void			model_symbol_release(void);
 
 
 void			dump(char* string,NAME* name);
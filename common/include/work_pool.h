@@ -0,0 +1,34 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *   @file: work_pool
+ *   @desc: This file holds the definitions for the pool of workers that run
+ *          independent jobs.
+ *
+ * @author: pantoine
+ *   @date: 18/10/2026
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#ifndef __WORK_POOL_H__
+#define __WORK_POOL_H__
+
+#define WORK_POOL_MAX_WORKERS	(64)
+
+/*--------------------------------------------------------------------------------*
+ * The job function, this is called once for each of the jobs.
+ *--------------------------------------------------------------------------------*/
+typedef unsigned int	(*WORK_POOL_FUNCTION)	(void* context, unsigned int job);
+
+/*--------------------------------------------------------------------------------*
+ * Work pool functions.
+ *--------------------------------------------------------------------------------*/
+unsigned int	work_pool_run(unsigned int num_workers, unsigned int num_jobs, WORK_POOL_FUNCTION function, void* context);
+void			work_pool_lock(void);
+void			work_pool_unlock(void);
+
+#endif
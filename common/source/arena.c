@@ -0,0 +1,107 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: arena
+ *    desc: This file holds the functions for the arena allocator.
+ *
+ *          The allocations are taken from the front block until it is full, then
+ *          a new block is put at the front. An allocation that is bigger than a
+ *          block gets a block of its own that is put behind the front block, so
+ *          the space left in the front block is not lost.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 11:02:17
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ALIGN_SIZE(x)		(((x) + (ARENA_ALIGNMENT - 1)) & ~(ARENA_ALIGNMENT - 1))
+#define BLOCK_HEADER_SIZE	ALIGN_SIZE(sizeof(ARENA_BLOCK))
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : arena_alloc
+ * Desc : This function will allocate memory from the arena. The memory is not
+ *        cleared. It returns NULL if a new block cannot be allocated.
+ *--------------------------------------------------------------------------------*/
+void*	arena_alloc(ARENA* arena, unsigned int size)
+{
+	void*			result = NULL;
+	unsigned int	block_size;
+	ARENA_BLOCK*	block = arena->blocks;
+
+	size = ALIGN_SIZE(size);
+
+	if (block == NULL || (block->size - block->used) < size)
+	{
+		block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+
+		if ((block = malloc(BLOCK_HEADER_SIZE + block_size)) != NULL)
+		{
+			block->size = block_size;
+			block->used = 0;
+
+			if (block_size > ARENA_BLOCK_SIZE && arena->blocks != NULL)
+			{
+				/* keep using the front block */
+				block->next = arena->blocks->next;
+				arena->blocks->next = block;
+			}
+			else
+			{
+				block->next = arena->blocks;
+				arena->blocks = block;
+			}
+		}
+	}
+
+	if (block != NULL)
+	{
+		result = ((unsigned char*) block) + BLOCK_HEADER_SIZE + block->used;
+		block->used += size;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : arena_copy
+ * Desc : This function will copy the data into the arena.
+ *--------------------------------------------------------------------------------*/
+unsigned char*	arena_copy(ARENA* arena, const unsigned char* data, unsigned int size)
+{
+	unsigned char*	result;
+
+	if ((result = arena_alloc(arena,size)) != NULL && size > 0)
+	{
+		memcpy(result,data,size);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : arena_release
+ * Desc : This function will free all the memory that was allocated from the
+ *        arena and leave it empty.
+ *--------------------------------------------------------------------------------*/
+void	arena_release(ARENA* arena)
+{
+	ARENA_BLOCK*	next;
+	ARENA_BLOCK*	current = arena->blocks;
+
+	while (current != NULL)
+	{
+		next = current->next;
+		free(current);
+		current = next;
+	}
+
+	arena->blocks = NULL;
+}
@@ -1,24 +1,24 @@
 /*--------------------------------------------------------------------------------*
- * Name: Parser Look-up tree
- * Desc: function and data structures to speed up a specific string search
+ * Name: Keyword recogniser
+ * Desc: function and data structures to recognise a fixed set of keywords
  *
  *         **** DO NOT AMEND THIS CODE - IT IS AUTO_GENERATED ****
  *
  * Code and table produced by:
- *            build_graph 
- *            version 0.8
- *
- *  written by Peter Antoine. 
- *
- *   **** This code can be used however you like, no claims whatsoever are ****
- *   **** placed on the auto-generated code or data, or on the code that   ****
- *   **** uses the that code or data.                                      ****
- *   **** Or, to paraphrase "Fill your boots".                             ****
+ *            common/tools/keyword_hash
  *--------------------------------------------------------------------------------*/
 
+#include <string.h>
 #include "atoms.h"
 
-ATOMS_STRING_TABLE	atoms_table[53] = {
+#define NUM_BUCKETS		(32)
+#define BUCKET_SHIFT	(27)
+#define NUM_SLOTS		(64)
+#define SLOT_SHIFT		(26)
+#define MIN_LENGTH		(2)
+#define MAX_LENGTH		(13)
+
+ATOMS_STRING_TABLE	atoms_table[52] = {
 		{"action",6},
 		{"activation",10},
 		{"after",5},
@@ -70,55 +70,28 @@ ATOMS_STRING_TABLE	atoms_table[53] = {
 		{"triggers",8},
 		{"type",4},
 		{"value",5},
-		{"waitfor",7},
-		{"zzzz",4}
+		{"waitfor",7}
 };
 
-static signed char	symbol_table[256] = 
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x15,
-	 0x00,0x01,0x0F,0x02,0x11,0x09,0x08,0x14,0x0E,0x04,0x00,0x00,0x0C,0x10,0x06,0x05,
-	 0x0B,0x17,0x0A,0x12,0x03,0x0D,0x07,0x18,0x16,0x13,0x19,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00};
-
-typedef struct
-{	unsigned char	mask;
-	unsigned char	table;
-} LOOKUP_TABLE;
+static unsigned char	word_chars[256] = 
+	{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,
+	 0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,1,
+	 0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
-static LOOKUP_TABLE	state_table[43] = {
-	{ 0, 0},{ 1, 1},{ 2, 1},{ 3, 1},{ 4, 1},{ 5, 2},{ 6, 2},{ 7, 3},{ 8, 1},{ 9, 1},{10, 2},{11, 2},{12, 0},{13, 2},{14, 1},{15, 2},
-	{16, 0},{17, 3},{18, 3},{19, 2},{ 9, 3},{20, 4},{21, 1},{22, 5},{23, 1},{24, 4},{25, 3},{24, 5},{21, 3},{12, 0},{26, 4},{24, 6},
-	{27, 5},{28, 7},{29, 8},{30, 6},{ 2, 4},{31, 1},{31, 2},{24, 9},{21, 5},{12, 0},{26, 6}};
+static unsigned short	displacement[NUM_BUCKETS] = 
+	{0x0000,0x0000,0x0000,0x0004,0x0001,0x0005,0x0001,0x0000,0x0003,0x0000,0x0000,0x0000,0x0001,0x0002,0x0008,0x0001,
+	 0x0002,0x0000,0x0006,0x0000,0x0001,0x0009,0x0002,0x0000,0x0006,0x0000,0x0006,0x0003,0x0001,0x0005,0x0007,0x0000};
 
-static unsigned int mask_table[32] = {
-	0x01179ffe,0x00000009,0x00000010,0x000000a0,0x00002904,0x00000810,0x00000022,0x00010840,
-	0x00060000,0x00000202,0x00040000,0x00000004,0x00000000,0x00000401,0x00400040,0x00020008,
-	0x00200000,0x00040004,0x00002010,0x00002200,0x00000402,0x00000400,0x00000002,0x00010000,
-	0x00000200,0x00000008,0x00040001,0x0084080c,0x0008220a,0x00000244,0x00080432,0x00100000};
-
-static unsigned char table[10][25] = {
-	{0x00,0x04,0x06,0x23,0xe9,0xe3,0x14,0xcd,0x12,0x0e,0x1f,0x15,0xe8,0x00,0x00,0xf9,0x13,0x09,0x21,0x00,0xea,0x11,0x00,0x00,0xcc},
-	{0xcb,0xf1,0x01,0x02,0x03,0xff,0x0f,0xfe,0xfd,0x0a,0x17,0x05,0x00,0xfa,0x00,0x00,0x19,0xf6,0xf5,0x00,0x26,0x00,0xed,0x00,0x00},
-	{0xf2,0xf8,0x0d,0xee,0xfc,0x07,0x00,0x00,0x00,0xe7,0xf3,0xfb,0x00,0xe6,0x00,0x00,0x00,0x10,0x0b,0x00,0x27,0x00,0x00,0x00,0x00},
-	{0x00,0xe5,0xf0,0x1b,0xec,0x00,0x08,0x00,0x00,0xe4,0x1e,0xf4,0x00,0xeb,0x00,0x00,0xf7,0x00,0xef,0x00,0x00,0x00,0x00,0x00,0x00},
-	{0xe2,0x16,0x00,0x00,0x25,0x00,0x00,0x00,0x00,0x1a,0xe0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xe1,0x00,0x00,0x00,0x00,0x00,0x00},
-	{0x00,0x18,0xdf,0xdb,0x00,0x00,0x00,0x00,0x00,0x1c,0x2a,0xde,0x00,0x00,0x00,0x00,0x00,0x00,0xdc,0x00,0x00,0x00,0x00,0xdd,0x00},
-	{0xd0,0xd3,0x00,0x00,0xd2,0xd1,0x00,0x00,0x00,0x20,0x24,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xcf,0xce,0x00,0x00,0x00,0x00,0x00},
-	{0x00,0xda,0x00,0xd6,0x00,0x00,0x00,0x00,0x00,0x22,0x00,0x00,0x00,0xd5,0x00,0x00,0x00,0x00,0x00,0xd4,0x00,0x00,0x00,0x00,0x00},
-	{0x00,0x00,0xd9,0x00,0x00,0x00,0xd7,0x00,0x00,0xd8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}};
+static unsigned char	slot[NUM_SLOTS] = 
+	{0x00,0x1e,0x03,0x1c,0x22,0x30,0x05,0x19,0x00,0x29,0x00,0x24,0x2f,0x10,0x28,0x2e,
+	 0x21,0x00,0x09,0x23,0x00,0x0f,0x1d,0x00,0x31,0x15,0x0d,0x0b,0x0c,0x00,0x25,0x33,
+	 0x06,0x0a,0x27,0x04,0x11,0x2b,0x16,0x00,0x13,0x00,0x17,0x2c,0x32,0x00,0x20,0x00,
+	 0x01,0x26,0x1a,0x1b,0x1f,0x2a,0x2d,0x18,0x02,0x14,0x08,0x07,0x0e,0x00,0x00,0x12};
 
 unsigned int atoms_get_length(int word)
 {
@@ -127,49 +100,25 @@ unsigned int atoms_get_length(int word)
 
 int	atoms_check_word(unsigned char* word)
 {
-	signed char		line = 0;
-	unsigned int	symbol = 0;
-	unsigned int	count = 0;
-	unsigned int	letter = 0;
-	unsigned int	symbol_bit;
+	int				result = -1;
+	unsigned int	key;
+	unsigned int	index;
+	unsigned int	length = 0;
+
+	while (length <= MAX_LENGTH && word_chars[word[length]])
+		length++;
 
-	do
+	if (length >= MIN_LENGTH && length <= MAX_LENGTH)
 	{
-		symbol = symbol_table[word[letter]];
-		symbol_bit = (0x1 << (symbol & 0x1F));
+		key = (length << 24) ^ (word[0] << 16) ^ (word[length >> 1] << 8) ^ word[length-1];
+		key ^= displacement[(key * 0x9e3779b1) >> BUCKET_SHIFT];
+		index = slot[(key * 0x85ebca6b) >> SLOT_SHIFT];
 
-		if ((mask_table[state_table[line].mask] & symbol_bit) == 0)
-		{
-			/* bad symbol for line */
-			line = 0;
-		}
-		else
+		if (atoms_table[index].length == length && memcmp(atoms_table[index].name,word,length) == 0)
 		{
-			line = (signed char) table[state_table[line].table][symbol];
+			result = (int) index;
 		}
-		letter++;
-
 	}
-	while (line > 0);
 
-	symbol_bit = (0x1 << (symbol_table[word[letter]] & 0x1F));
-
-	if (line < 0)
-		line = (0-line) - 1;
-	else if (((mask_table[state_table[line].mask] & symbol_bit) != 0) && ((line = (signed char) table[state_table[line].table][symbol_table[0]]) < 0))
-		line = (0-line) - 1;
-	else
-		line = -1;
-	if (line >= 0)
-	{
-		for (count=letter;count < atoms_table[line].length;count++)
-		{
-			if (word[count] != atoms_table[line].name[count])
-			{
-				line = -1;
-				break;
-			}
-		}
-	}
-	return line;
+	return result;
 }
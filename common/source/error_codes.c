@@ -16,9 +16,10 @@
 #include "error_codes.h"
 #include <stdio.h>
 
-char* g_input_filename = NULL;
-char* g_source_filename = NULL;
-unsigned int g_source_filename_length = 0;
+/* the file names are per thread so workers report their own files */
+THREAD_LOCAL char* g_input_filename = NULL;
+THREAD_LOCAL char* g_source_filename = NULL;
+THREAD_LOCAL unsigned int g_source_filename_length = 0;
 
 static char* error_string[EC_MAX_ERROR_CODE] =
 {
@@ -131,6 +132,9 @@ static char* error_string[EC_MAX_ERROR_CODE] =
 	"large jump in index levels detected (and ignored).",
 	"Too many columns in table",
 	"Outputting index not supported for this item.",
+	"State machine layout did not settle within its iterations.",
+	"@after nodes depend on each other in a loop, the order is left as it was.",
+	"The \"all\" group of the partial model is not the first group of the link.",
 };
 	
 /*----- FUNCTION -----------------------------------------------------------------*
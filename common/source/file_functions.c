@@ -19,6 +19,10 @@
 #include <limits.h>
 #include <sys/stat.h>
 
+#ifdef __unix__
+#include <sys/mman.h>
+#endif
+
 #include "error_codes.h"
 #include "file_functions.h"
 
@@ -242,3 +246,105 @@ void	get_filename_with_ext(unsigned char* path, unsigned char** file_name, unsig
 	*file_name_length = pos - start;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : map_input_file
+ * Desc : This function will make the whole of the input file available in
+ *        memory. Where the platform supports it the file is mapped, otherwise
+ *        (or if the map fails) it is read into a single heap buffer with as few
+ *        reads as the OS will allow.
+ *
+ *        The memory is read-only. Anything that needs to outlive the map must
+ *        be copied out before unmap_input_file() is called.
+ *--------------------------------------------------------------------------------*/
+unsigned int	map_input_file(const char* file_name, FILE_MAP* file_map)
+{
+	int				infile;
+	int				bytes_read;
+	unsigned int	offset = 0;
+	unsigned int	result = EC_OK;
+	struct stat		file_stat;
+
+	file_map->data = NULL;
+	file_map->size = 0;
+	file_map->mapped = 0;
+
+	if ((infile = open(file_name,READ_FILE_STATUS,0)) == -1)
+	{
+		result = EC_FAILED_TO_OPEN_INPUT_FILE;
+	}
+	else
+	{
+		if (fstat(infile,&file_stat) != 0 || file_stat.st_size > UINT_MAX)
+		{
+			result = EC_PROBLEM_WITH_INPUT_FILE;
+		}
+		else if (file_stat.st_size > 0)
+		{
+			file_map->size = (unsigned int) file_stat.st_size;
+
+#ifdef __unix__
+			file_map->data = mmap(NULL,file_map->size,PROT_READ,MAP_PRIVATE,infile,0);
+
+			if (file_map->data == MAP_FAILED)
+			{
+				file_map->data = NULL;
+			}
+			else
+			{
+				file_map->mapped = 1;
+			}
+#endif
+			if (file_map->data == NULL)
+			{
+				file_map->data = malloc(file_map->size);
+
+				while (offset < file_map->size)
+				{
+					if ((bytes_read = read(infile,&file_map->data[offset],file_map->size - offset)) <= 0)
+						break;
+
+					offset += bytes_read;
+				}
+
+				if (offset != file_map->size)
+				{
+					free(file_map->data);
+					file_map->data = NULL;
+					file_map->size = 0;
+					result = EC_PROBLEM_WITH_INPUT_FILE;
+				}
+			}
+		}
+
+		close(infile);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : unmap_input_file
+ * Desc : This function releases a file that was made available by the function
+ *        map_input_file().
+ *--------------------------------------------------------------------------------*/
+void	unmap_input_file(FILE_MAP* file_map)
+{
+	if (file_map->data != NULL)
+	{
+#ifdef __unix__
+		if (file_map->mapped)
+		{
+			munmap(file_map->data,file_map->size);
+		}
+		else
+#endif
+		{
+			free(file_map->data);
+		}
+	}
+
+	file_map->data = NULL;
+	file_map->size = 0;
+	file_map->mapped = 0;
+}
+
@@ -215,3 +215,24 @@ void	level_index_release(LEVEL_INDEX* index)
 	index->previous_level	= 0;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: level_index_copy
+ *  desc: This function will copy the level index. The copy has its own table so
+ *        it must be released separately from the source index.
+ *--------------------------------------------------------------------------------*/
+void	level_index_copy(LEVEL_INDEX* index, LEVEL_INDEX* source)
+{
+	*index = *source;
+
+	if (source->level_index != NULL)
+	{
+		if ((index->level_index = malloc(sizeof(unsigned short) * source->max_levels)) == NULL)
+		{
+			index->max_levels = 0;
+		}
+		else
+		{
+			memcpy(index->level_index,source->level_index,sizeof(unsigned short) * source->max_levels);
+		}
+	}
+}
@@ -15,64 +15,157 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include "document_generator.h"
+#include "utilities.h"
 #include "lookup_tables.h"
+#include "document_generator.h"
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : find_lookup
- * Desc : This function will find a lookup in the lookup table.
+ * Name : find_slot
+ * Desc : This function will find the slot in the index for the name. It returns
+ *        the slot that holds the name or the empty slot where the name should be
+ *        added. The index must have at least one empty slot.
  *--------------------------------------------------------------------------------*/
-LOOKUP_ITEM* find_lookup ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length )
+static unsigned int	find_slot ( LOOKUP_LIST* lookup_list, unsigned int hash, unsigned char* name, unsigned int name_length )
+{
+	unsigned int	mask = lookup_list->num_slots - 1;
+	unsigned int	result = hash & mask;
+	LOOKUP_ITEM*	item;
+
+	while (lookup_list->slot[result] != 0)
+	{
+		item = get_lookup(lookup_list,lookup_list->slot[result] - 1);
+
+		if (item->hash == hash && item->name_length == name_length && memcmp(item->name,name,name_length) == 0)
+		{
+			break;
+		}
+
+		result = (result + 1) & mask;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : grow_index
+ * Desc : This function will double the size of the hash index and put all the
+ *        named items back into it.
+ *--------------------------------------------------------------------------------*/
+static void	grow_index ( LOOKUP_LIST* lookup_list )
 {
-	unsigned int	hash = fnv_32_hash(name,name_length);
 	unsigned int	count;
-	unsigned int	index_count = 0;
-	LOOKUP_ITEM*	result = NULL;
-	LOOKUP_LIST*	current = lookup_list;
-	LOOKUP_LIST*	previous = current;
-	
-	while (current != NULL && result == NULL)
+	unsigned int	num_slots = lookup_list->num_slots;
+	unsigned int*	slot = lookup_list->slot;
+	LOOKUP_ITEM*	item;
+
+	lookup_list->num_slots = (num_slots == 0) ? LOOKUP_MIN_SLOTS : num_slots * 2;
+	lookup_list->slot = calloc(lookup_list->num_slots,sizeof(unsigned int));
+
+	for (count=0; count < num_slots; count++)
 	{
-		for (count=0;count<current->num_items;count++)
+		if (slot[count] != 0)
 		{
-			if (current->lookup[count].hash == hash)
-			{
-				result = &current->lookup[count];
-				break;
-			}
+			item = get_lookup(lookup_list,slot[count] - 1);
+			lookup_list->slot[find_slot(lookup_list,item->hash,item->name,item->name_length)] = slot[count];
 		}
+	}
 
-		index_count++;
-		previous = current;
-		current = current->next;
+	free(slot);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : index_lookup
+ * Desc : This function will add the named item to the hash index. If the name is
+ *        already in the index the first item keeps the name.
+ *--------------------------------------------------------------------------------*/
+static void	index_lookup ( LOOKUP_LIST* lookup_list, unsigned int item_id )
+{
+	unsigned int	slot;
+	LOOKUP_ITEM*	item = get_lookup(lookup_list,item_id);
+
+	/* keep the index less than three quarters full */
+	if ((lookup_list->num_names + 1) * 4 > lookup_list->num_slots * 3)
+	{
+		grow_index(lookup_list);
+	}
+
+	slot = find_slot(lookup_list,item->hash,item->name,item->name_length);
+
+	if (lookup_list->slot[slot] == 0)
+	{
+		lookup_list->slot[slot] = item_id + 1;
+		lookup_list->num_names++;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : find_lookup_id
+ * Desc : This function will return the id of the named item or INVALID_ITEM if
+ *        the name is not in the index.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	find_lookup_id ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length )
+{
+	unsigned int	result = INVALID_ITEM;
+
+	if (lookup_list->num_slots > 0)
+	{
+		result = lookup_list->slot[find_slot(lookup_list,fnv_32_hash(name,name_length),name,name_length)] - 1;
 	}
 
 	return result;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : find_lookup
+ * Desc : This function will find a lookup in the lookup table.
+ *--------------------------------------------------------------------------------*/
+LOOKUP_ITEM* find_lookup ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length )
+{
+	unsigned int	item_id;
+	LOOKUP_ITEM*	result = NULL;
+
+	if ((item_id = find_lookup_id(lookup_list,name,name_length)) != INVALID_ITEM)
+	{
+		result = get_lookup(lookup_list,item_id);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : get_lookup
+ * Desc : This function will return the item with the given id.
+ *--------------------------------------------------------------------------------*/
+LOOKUP_ITEM*	get_lookup ( LOOKUP_LIST* lookup_list, unsigned int item_id )
+{
+	return &lookup_list->block[item_id >> LOOKUP_INDEX_SHIFT]->lookup[item_id & (LOOKUP_INDEX_SIZE - 1)];
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : set_lookup_group
  * Desc : This function will set the lookup items group field.
  *--------------------------------------------------------------------------------*/
-void	set_lookup_group(LOOKUP_ITEM *item, unsigned short group_id)
+void	set_lookup_group(LOOKUP_ITEM *item, unsigned int group_id)
 {
 	item->group_id = group_id;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : set_lookup_name
- * Desc : This function will set the lookup name.
+ * Desc : This function will set the lookup name, and add it to the index.
  *--------------------------------------------------------------------------------*/
-void	set_lookup_name(LOOKUP_ITEM *item, NAME* name, unsigned short line_num)
+void	set_lookup_name(LOOKUP_LIST* lookup_list, unsigned int item_id, NAME* name, unsigned int line_num)
 {
-	unsigned int	hash = fnv_32_hash(name->name,name->name_length);
+	LOOKUP_ITEM*	item = get_lookup(lookup_list,item_id);
 	
-	item->hash = hash;
+	item->hash = fnv_32_hash(name->name,name->name_length);
 	item->line_num = line_num;
 	item->name_length = name->name_length;
 	
 	item->name = malloc(name->name_length);
 	memcpy(item->name,name->name,name->name_length);
+
+	index_lookup(lookup_list,item_id);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -81,34 +174,34 @@ void	set_lookup_name(LOOKUP_ITEM *item, NAME* name, unsigned short line_num)
  *--------------------------------------------------------------------------------*/
 unsigned int new_lookup ( LOOKUP_LIST* lookup_list )
 {
-	unsigned int	result = INVALID_ITEM;
-	unsigned int	index_count = 0;
-	LOOKUP_LIST*	current = lookup_list;
-	LOOKUP_LIST*	previous = current;
-	
-	/* find the end of the index */
-	while (current != NULL && result == INVALID_ITEM)
-	{
-		index_count++;
-		previous = current;
-		current = current->next;
-	}
+	unsigned int	result = lookup_list->num_items;
+	LOOKUP_BLOCK**	new_block;
 
-	if (previous->num_items < LOOKUP_INDEX_SIZE)
-	{
-		/*OK, we have space in the first block */
-		index_count--;
-		
-		result = (index_count * LOOKUP_INDEX_SIZE) + previous->num_items;
-		previous->num_items++;
-	}
-	else
+	if ((result >> LOOKUP_INDEX_SHIFT) >= lookup_list->num_blocks)
 	{
 		/* need to add a block to the lookup table */
-		LOOKUP_LIST* temp = calloc(1,sizeof(LOOKUP_LIST));
-		previous->next = temp;
+		if ((new_block = realloc(lookup_list->block,sizeof(LOOKUP_BLOCK*) * (lookup_list->num_blocks + 1))) == NULL)
+		{
+			result = INVALID_ITEM;
+		}
+		else
+		{
+			lookup_list->block = new_block;
 
-		result = ((index_count) * LOOKUP_INDEX_SIZE);
+			if ((lookup_list->block[lookup_list->num_blocks] = calloc(1,sizeof(LOOKUP_BLOCK))) == NULL)
+			{
+				result = INVALID_ITEM;
+			}
+			else
+			{
+				lookup_list->num_blocks++;
+			}
+		}
+	}
+
+	if (result != INVALID_ITEM)
+	{
+		lookup_list->num_items++;
 	}
 
 	return result;
@@ -119,71 +212,28 @@ unsigned int new_lookup ( LOOKUP_LIST* lookup_list )
  * Desc : This function will find a lookup if it exists and if it does not then it
  *        adds it.
  *--------------------------------------------------------------------------------*/
-unsigned int add_lookup ( LOOKUP_LIST* lookup_list, const char* name, unsigned int name_length, const char* payload, unsigned int payload_length, unsigned short line_num )
+unsigned int add_lookup ( LOOKUP_LIST* lookup_list, const char* name, unsigned int name_length, const char* payload, unsigned int payload_length, unsigned int line_num )
 {
-	unsigned int	hash = fnv_32_hash(name,name_length);
-	unsigned int	count;
-	unsigned int	result = INVALID_ITEM;
-	unsigned int	index_count = 0;
-	LOOKUP_LIST*	current = lookup_list;
-	LOOKUP_LIST*	previous = current;
-	
-	while (current != NULL && result == INVALID_ITEM)
+	unsigned int	result;
+	LOOKUP_ITEM*	item;
+
+	if ((result = find_lookup_id(lookup_list,(unsigned char*)name,name_length)) == INVALID_ITEM &&
+		(result = new_lookup(lookup_list)) != INVALID_ITEM)
 	{
-		for (count=0;count<current->num_items;count++)
-		{
-			if (current->lookup[count].hash == hash)
-			{
-				result = (index_count * LOOKUP_INDEX_SIZE) + count;
-				break;
-			}
-		}
+		item = get_lookup(lookup_list,result);
 
-		index_count++;
-		previous = current;
-		current = current->next;
-	}
+		item->hash = fnv_32_hash((unsigned char*)name,name_length);
+		item->line_num = line_num;
+		item->name_length = name_length;
+		
+		item->name = malloc(name_length);
+		memcpy(item->name,name,name_length);
 
-	if (result == INVALID_ITEM)
-	{
-		if (previous->num_items < LOOKUP_INDEX_SIZE)
-		{
-			index_count--;
-			
-			previous->lookup[previous->num_items].hash = hash;
-			previous->lookup[previous->num_items].line_num = line_num;
-			previous->lookup[previous->num_items].name_length = name_length;
-			
-			previous->lookup[previous->num_items].name = malloc(name_length);
-			memcpy(previous->lookup[previous->num_items].name,name,name_length);
-
-			previous->lookup[previous->num_items].payload = malloc(payload_length);
-			previous->lookup[previous->num_items].payload_length = payload_length;
-			memcpy(previous->lookup[previous->num_items].payload,payload,payload_length);
-
-			result = (index_count * LOOKUP_INDEX_SIZE) + previous->num_items;
-			previous->num_items++;
-		}
-		else
-		{
-			LOOKUP_LIST* temp = calloc(1,sizeof(LOOKUP_LIST));
-			previous->next = temp;
-	
-			temp->lookup[0].hash = hash;
-			temp->lookup[0].line_num = line_num;
-			temp->lookup[0].name_length = name_length;
-			
-			temp->lookup[0].name = malloc(name_length);
-			memcpy(temp->lookup[0].name,name,name_length);
-	
-			temp->lookup[0].payload = malloc(payload_length);
-			temp->lookup[0].payload_length = payload_length;
-			memcpy(previous->lookup[0].payload,payload,payload_length);
+		item->payload = malloc(payload_length);
+		item->payload_length = payload_length;
+		memcpy(item->payload,payload,payload_length);
 
-			temp->num_items = 1;
-			
-			result = (index_count * LOOKUP_INDEX_SIZE);
-		}
+		index_lookup(lookup_list,result);
 	}
 
 	return result;
@@ -196,59 +246,51 @@ unsigned int add_lookup ( LOOKUP_LIST* lookup_list, const char* name, unsigned i
  *--------------------------------------------------------------------------------*/
 unsigned int find_add_lookup ( LOOKUP_LIST* lookup_list, unsigned char* name, unsigned int name_length )
 {
-	unsigned int	hash = fnv_32_hash(name,name_length);
-	unsigned int	count;
-	unsigned int	result = INVALID_ITEM;
-	unsigned int	index_count = 0;
-	LOOKUP_LIST*	current = lookup_list;
-	LOOKUP_LIST*	previous = current;
-	
-	while (current != NULL && result == INVALID_ITEM)
-	{
-		for (count=0;count<current->num_items;count++)
-		{
-			if (current->lookup[count].hash == hash)
-			{
-				result = (index_count * LOOKUP_INDEX_SIZE) + count;
-				break;
-			}
-		}
+	unsigned int	result;
+	LOOKUP_ITEM*	item;
 
-		index_count++;
-		previous = current;
-		current = current->next;
-	}
-	
-	if (result == INVALID_ITEM)
+	if ((result = find_lookup_id(lookup_list,name,name_length)) == INVALID_ITEM &&
+		(result = new_lookup(lookup_list)) != INVALID_ITEM)
 	{
-		if (previous->num_items < LOOKUP_INDEX_SIZE)
-		{
-			index_count--;
+		item = get_lookup(lookup_list,result);
 
-			previous->lookup[previous->num_items].hash = hash;
-			previous->lookup[previous->num_items].name = malloc(name_length);
-			previous->lookup[previous->num_items].name_length = name_length;
-			memcpy(previous->lookup[previous->num_items].name,name,name_length);
+		item->hash = fnv_32_hash(name,name_length);
+		item->name = malloc(name_length);
+		item->name_length = name_length;
+		memcpy(item->name,name,name_length);
 
-			result = (index_count * LOOKUP_INDEX_SIZE) + previous->num_items;
-			previous->num_items++;
-		}
-		else
-		{
-			LOOKUP_LIST* temp = calloc(1,sizeof(LOOKUP_LIST));
-			previous->next = temp;
-	
-			temp->lookup[0].hash = hash;
-			temp->lookup[0].name = malloc(name_length);
-			temp->lookup[0].name_length = name_length;
-			memcpy(temp->lookup[0].name,name,name_length);
-			temp->num_items = 1;
-			
-			result = (index_count * LOOKUP_INDEX_SIZE);
-		}
+		index_lookup(lookup_list,result);
 	}
 
 	return result;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : release_lookup
+ * Desc : This function will free the lookup list. The payloads are freed as well
+ *        so any that hold allocated structures must be released first.
+ *--------------------------------------------------------------------------------*/
+void	release_lookup ( LOOKUP_LIST* lookup_list )
+{
+	unsigned int	count;
+	LOOKUP_ITEM*	item;
+
+	for (count=0; count < lookup_list->num_items; count++)
+	{
+		item = get_lookup(lookup_list,count);
+
+		free(item->name);
+		free(item->payload);
+	}
+
+	for (count=0; count < lookup_list->num_blocks; count++)
+	{
+		free(lookup_list->block[count]);
+	}
+
+	free(lookup_list->block);
+	free(lookup_list->slot);
+
+	memset(lookup_list,0,sizeof(LOOKUP_LIST));
+}
 
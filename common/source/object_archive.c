@@ -0,0 +1,484 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: object_archive
+ *    desc: This file holds the functions that read and write the object
+ *          archives.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 17:12:40
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+#include "error_codes.h"
+#include "object_record.h"
+#include "object_archive.h"
+#include "document_generator.h"
+
+#define ARCHIVE_BLOCK_SIZE		(64)
+#define ARCHIVE_TEMP_EXTENSION	".tmp"
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : get_long
+ * Desc : This function reads a big endian 32 bit value.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	get_long(unsigned char* buffer)
+{
+	return ((((unsigned int)buffer[0]) << 24) | (((unsigned int)buffer[1]) << 16) | (((unsigned int)buffer[2]) << 8) | buffer[3]);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : put_long
+ * Desc : This function writes a big endian 32 bit value.
+ *--------------------------------------------------------------------------------*/
+static void	put_long(unsigned char* buffer, unsigned int value)
+{
+	buffer[0] = (unsigned char) ((value >> 24) & 0xff);
+	buffer[1] = (unsigned char) ((value >> 16) & 0xff);
+	buffer[2] = (unsigned char) ((value >> 8) & 0xff);
+	buffer[3] = (unsigned char) (value & 0xff);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : add_member
+ * Desc : This function adds a member to the end of the archive. The member
+ *        name is indexed so that a later add with the same name replaces it.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	add_member(OBJECT_ARCHIVE* archive, unsigned char* name, unsigned int name_length, unsigned char* data, unsigned int size)
+{
+	unsigned int	result = EC_OK;
+	ARCHIVE_MEMBER*	members;
+
+	if (archive->num_members == archive->max_members)
+	{
+		if ((members = realloc(archive->members,(archive->max_members + ARCHIVE_BLOCK_SIZE) * sizeof(ARCHIVE_MEMBER))) == NULL)
+		{
+			result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+		}
+		else
+		{
+			archive->members = members;
+			archive->max_members += ARCHIVE_BLOCK_SIZE;
+		}
+	}
+
+	if (result == EC_OK)
+	{
+		archive->members[archive->num_members].name = name;
+		archive->members[archive->num_members].name_length = name_length;
+		archive->members[archive->num_members].data = data;
+		archive->members[archive->num_members].size = size;
+
+		/* the item is the member number plus one, so that it is never NULL */
+		result = symbol_table_add(&archive->member_names,NULL,name,name_length,(void*) (unsigned long) (archive->num_members + 1));
+
+		archive->num_members++;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : add_symbol
+ * Desc : This function adds a symbol to the archive index.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	add_symbol(OBJECT_ARCHIVE* archive, unsigned char type, unsigned int member, unsigned char* name, unsigned int name_length)
+{
+	unsigned int	result = EC_OK;
+	ARCHIVE_SYMBOL*	symbols;
+
+	if (archive->num_symbols == archive->max_symbols)
+	{
+		if ((symbols = realloc(archive->symbols,(archive->max_symbols + ARCHIVE_BLOCK_SIZE) * sizeof(ARCHIVE_SYMBOL))) == NULL)
+		{
+			result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+		}
+		else
+		{
+			archive->symbols = symbols;
+			archive->max_symbols += ARCHIVE_BLOCK_SIZE;
+		}
+	}
+
+	if (result == EC_OK)
+	{
+		archive->symbols[archive->num_symbols].type = type;
+		archive->symbols[archive->num_symbols].member = member;
+		archive->symbols[archive->num_symbols].name = name;
+		archive->symbols[archive->num_symbols].name_length = name_length;
+		archive->num_symbols++;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : index_member
+ * Desc : This function walks the records of a member and adds the groups, apis,
+ *        functions and applications that it names to the archive index. The
+ *        member has been checked for the object signature when it was added.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	index_member(OBJECT_ARCHIVE* archive, unsigned int member)
+{
+	unsigned int	result = EC_OK;
+	unsigned int	file_pos;
+	unsigned int	header_size = FILE_HEADER_SIZE;
+	unsigned int	record_header;
+	unsigned int	size = archive->members[member].size;
+	unsigned char*	data = archive->members[member].data;
+	OBJECT_RECORD	record;
+
+	if (data[FILE_VERSION_MINOR] >= OBJECT_VERSION_HASHED && size >= FILE_HASHED_HEADER_SIZE)
+	{
+		header_size = FILE_HASHED_HEADER_SIZE;
+	}
+
+	file_pos = header_size + ((((unsigned int)data[FILE_NAME_START]) << 8) | data[FILE_NAME_START+1]);
+
+	while (result == EC_OK && file_pos < size &&
+		   (record_header = object_record_decode(&data[file_pos],size - file_pos,data[FILE_VERSION_MINOR],&record)) > 0)
+	{
+		if (record.data_size > size - (file_pos + record_header))
+		{
+			/* the linker will report the truncated member */
+			break;
+		}
+
+		switch (record.type)
+		{
+			case INTERMEDIATE_RECORD_GROUP:
+			case INTERMEDIATE_RECORD_API:
+			case INTERMEDIATE_RECORD_FUNCTION:
+			case INTERMEDIATE_RECORD_APPLICATION:
+				if (record.data_size > 0 && record.data_size <= ARCHIVE_MAX_NAME_LENGTH)
+				{
+					result = add_symbol(archive,record.type,member,&data[file_pos + record_header],record.data_size);
+				}
+				break;
+		}
+
+		file_pos += record_header + record.data_size;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_archive_is_archive
+ * Desc : This function returns true if the data starts with the archive magic.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_archive_is_archive(unsigned char* data, unsigned int size)
+{
+	unsigned char	signature[4] = OBJECT_ARCHIVE_MAGIC;
+
+	return (size >= ARCHIVE_HEADER_SIZE && memcmp(&data[ARCHIVE_MAGIC],signature,4) == 0);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_archive_read
+ * Desc : This function will fill the archive from the data of an archive file.
+ *        The members, the names and the index are checked against the size of
+ *        the data, and each member must hold an object header, so a damaged
+ *        archive is rejected and not read past the end.
+ *        The archive points into the data, so the data must not be released
+ *        before the archive is.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_archive_read(OBJECT_ARCHIVE* archive, unsigned char* data, unsigned int size)
+{
+	unsigned int	result = EC_OK;
+	unsigned int	count;
+	unsigned int	offset;
+	unsigned int	length;
+	unsigned int	num_members;
+	unsigned int	num_symbols;
+	unsigned int	strings_offset;
+	unsigned int	strings_size;
+	unsigned int	name_offset;
+	unsigned char*	entry;
+	unsigned char	signature[4] = COMPILED_SOURCE_MAGIC;
+
+	memset(archive,0,sizeof(OBJECT_ARCHIVE));
+
+	if (!object_archive_is_archive(data,size))
+	{
+		result = EC_INPUT_FILE_SIGNATURE_INCORRECT;
+	}
+	else if (data[ARCHIVE_MAJOR] > ARCHIVE_VERSION_MAJOR)
+	{
+		result = EC_INPUT_FILE_BUILT_WITH_LATER_MAJOR_VERSION;
+	}
+	else
+	{
+		num_members		= get_long(&data[ARCHIVE_NUM_MEMBERS]);
+		num_symbols		= get_long(&data[ARCHIVE_NUM_SYMBOLS]);
+		strings_offset	= get_long(&data[ARCHIVE_STRINGS_OFFSET]);
+		strings_size	= get_long(&data[ARCHIVE_STRINGS_SIZE]);
+
+		/* the tables must fit before the strings, and the strings in the file */
+		if (num_members > (size - ARCHIVE_HEADER_SIZE) / ARCHIVE_MEMBER_ENTRY_SIZE ||
+			num_symbols > (size - ARCHIVE_HEADER_SIZE) / ARCHIVE_SYMBOL_ENTRY_SIZE ||
+			strings_offset < ARCHIVE_HEADER_SIZE + (num_members * ARCHIVE_MEMBER_ENTRY_SIZE) + (num_symbols * ARCHIVE_SYMBOL_ENTRY_SIZE) ||
+			strings_offset > size || strings_size > size - strings_offset)
+		{
+			result = EC_PROBLEM_WITH_INPUT_FILE;
+		}
+
+		entry = &data[ARCHIVE_HEADER_SIZE];
+
+		for (count=0; result == EC_OK && count < num_members; count++, entry += ARCHIVE_MEMBER_ENTRY_SIZE)
+		{
+			offset		= get_long(&entry[ARCHIVE_MEMBER_OFFSET]);
+			length		= get_long(&entry[ARCHIVE_MEMBER_SIZE]);
+			name_offset	= get_long(&entry[ARCHIVE_MEMBER_NAME]);
+
+			/* the members are indexed when the archive is updated, so must be objects */
+			if (offset > size || length > size - offset ||
+				length < FILE_HEADER_SIZE || memcmp(&data[offset],signature,4) != 0 ||
+				name_offset > strings_size || ((((unsigned int)entry[ARCHIVE_MEMBER_NAME_LENGTH]) << 8) | entry[ARCHIVE_MEMBER_NAME_LENGTH+1]) > strings_size - name_offset)
+			{
+				result = EC_PROBLEM_WITH_INPUT_FILE;
+			}
+			else
+			{
+				result = add_member(archive,
+									&data[strings_offset + name_offset],
+									((((unsigned int)entry[ARCHIVE_MEMBER_NAME_LENGTH]) << 8) | entry[ARCHIVE_MEMBER_NAME_LENGTH+1]),
+									&data[offset],
+									length);
+			}
+		}
+
+		for (count=0; result == EC_OK && count < num_symbols; count++, entry += ARCHIVE_SYMBOL_ENTRY_SIZE)
+		{
+			length		= ((((unsigned int)entry[ARCHIVE_SYMBOL_NAME_LENGTH]) << 8) | entry[ARCHIVE_SYMBOL_NAME_LENGTH+1]);
+			name_offset	= get_long(&entry[ARCHIVE_SYMBOL_NAME]);
+
+			if (get_long(&entry[ARCHIVE_SYMBOL_MEMBER]) >= num_members || name_offset > strings_size || length > strings_size - name_offset)
+			{
+				result = EC_PROBLEM_WITH_INPUT_FILE;
+			}
+			else
+			{
+				result = add_symbol(archive,entry[ARCHIVE_SYMBOL_TYPE],get_long(&entry[ARCHIVE_SYMBOL_MEMBER]),&data[strings_offset + name_offset],length);
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_archive_add
+ * Desc : This function will add an object to the archive. If the archive has a
+ *        member with the same name then that member is replaced and keeps its
+ *        place, else the object is added to the end. The index is rebuilt when
+ *        the archive is written.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_archive_add(OBJECT_ARCHIVE* archive, unsigned char* name, unsigned int name_length, unsigned char* data, unsigned int size)
+{
+	unsigned int	result = EC_OK;
+	unsigned long	member;
+	unsigned char	signature[4] = COMPILED_SOURCE_MAGIC;
+
+	if (size < FILE_HEADER_SIZE || memcmp(data,signature,4) != 0)
+	{
+		result = EC_INPUT_FILE_SIGNATURE_INCORRECT;
+	}
+	else if (name_length > ARCHIVE_MAX_NAME_LENGTH)
+	{
+		result = EC_INVALID_ITEM_NAME;
+	}
+	else if ((member = (unsigned long) symbol_table_find(&archive->member_names,NULL,name,name_length)) != 0)
+	{
+		archive->members[member - 1].data = data;
+		archive->members[member - 1].size = size;
+	}
+	else
+	{
+		result = add_member(archive,name,name_length,data,size);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_archive_write
+ * Desc : This function will rebuild the index and write the archive. The
+ *        archive is written to a temporary file that is renamed over the
+ *        archive, so the archive can be updated from itself and the linker
+ *        never sees a part written archive.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_archive_write(OBJECT_ARCHIVE* archive, const char* file_name)
+{
+	int				outfile;
+	int				written;
+	unsigned int	result = EC_OK;
+	unsigned int	count;
+	unsigned int	offset;
+	unsigned int	length = strlen(file_name);
+	unsigned int	strings_offset;
+	unsigned int	strings_size = 0;
+	unsigned int	data_size = 0;
+	unsigned int	total_size;
+	unsigned char	signature[4] = OBJECT_ARCHIVE_MAGIC;
+	unsigned char*	buffer = NULL;
+	unsigned char*	entry;
+	unsigned char*	strings;
+	unsigned char*	data;
+	char*			temp_name;
+
+	/* the index is rebuilt, the members may have been replaced */
+	archive->num_symbols = 0;
+
+	for (count=0; result == EC_OK && count < archive->num_members; count++)
+	{
+		result = index_member(archive,count);
+	}
+
+	for (count=0; count < archive->num_members; count++)
+	{
+		strings_size += archive->members[count].name_length;
+		data_size += archive->members[count].size;
+	}
+
+	for (count=0; count < archive->num_symbols; count++)
+	{
+		strings_size += archive->symbols[count].name_length;
+	}
+
+	strings_offset = ARCHIVE_HEADER_SIZE + (archive->num_members * ARCHIVE_MEMBER_ENTRY_SIZE) + (archive->num_symbols * ARCHIVE_SYMBOL_ENTRY_SIZE);
+	total_size = strings_offset + strings_size + data_size;
+
+	if (result != EC_OK)
+	{
+		/* failed to build the index */
+	}
+	else if (total_size < data_size || (buffer = calloc(1,total_size)) == NULL)
+	{
+		result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+	}
+	else
+	{
+		memcpy(&buffer[ARCHIVE_MAGIC],signature,4);
+		buffer[ARCHIVE_MAJOR] = ARCHIVE_VERSION_MAJOR;
+		buffer[ARCHIVE_MINOR] = ARCHIVE_VERSION_MINOR;
+		put_long(&buffer[ARCHIVE_NUM_MEMBERS],archive->num_members);
+		put_long(&buffer[ARCHIVE_NUM_SYMBOLS],archive->num_symbols);
+		put_long(&buffer[ARCHIVE_STRINGS_OFFSET],strings_offset);
+		put_long(&buffer[ARCHIVE_STRINGS_SIZE],strings_size);
+
+		entry	= &buffer[ARCHIVE_HEADER_SIZE];
+		strings	= &buffer[strings_offset];
+		data	= &buffer[strings_offset + strings_size];
+		offset	= 0;
+
+		for (count=0; count < archive->num_members; count++, entry += ARCHIVE_MEMBER_ENTRY_SIZE)
+		{
+			put_long(&entry[ARCHIVE_MEMBER_OFFSET],data - buffer);
+			put_long(&entry[ARCHIVE_MEMBER_SIZE],archive->members[count].size);
+			put_long(&entry[ARCHIVE_MEMBER_NAME],offset);
+			entry[ARCHIVE_MEMBER_NAME_LENGTH]	= (unsigned char) ((archive->members[count].name_length >> 8) & 0xff);
+			entry[ARCHIVE_MEMBER_NAME_LENGTH+1]	= (unsigned char) (archive->members[count].name_length & 0xff);
+
+			memcpy(&strings[offset],archive->members[count].name,archive->members[count].name_length);
+			offset += archive->members[count].name_length;
+
+			memcpy(data,archive->members[count].data,archive->members[count].size);
+			data += archive->members[count].size;
+		}
+
+		for (count=0; count < archive->num_symbols; count++, entry += ARCHIVE_SYMBOL_ENTRY_SIZE)
+		{
+			entry[ARCHIVE_SYMBOL_TYPE]				= archive->symbols[count].type;
+			entry[ARCHIVE_SYMBOL_NAME_LENGTH]		= (unsigned char) ((archive->symbols[count].name_length >> 8) & 0xff);
+			entry[ARCHIVE_SYMBOL_NAME_LENGTH+1]	= (unsigned char) (archive->symbols[count].name_length & 0xff);
+			put_long(&entry[ARCHIVE_SYMBOL_MEMBER],archive->symbols[count].member);
+			put_long(&entry[ARCHIVE_SYMBOL_NAME],offset);
+
+			memcpy(&strings[offset],archive->symbols[count].name,archive->symbols[count].name_length);
+			offset += archive->symbols[count].name_length;
+		}
+
+		if ((temp_name = malloc(length + sizeof(ARCHIVE_TEMP_EXTENSION))) == NULL)
+		{
+			result = EC_FAILED_TO_OPEN_OUTPUT_FILE;
+		}
+		else
+		{
+			memcpy(temp_name,file_name,length);
+			memcpy(&temp_name[length],ARCHIVE_TEMP_EXTENSION,sizeof(ARCHIVE_TEMP_EXTENSION));
+
+			if ((outfile = open(temp_name,WRITE_FILE_STATUS,WRITE_FILE_PERM)) == -1)
+			{
+				result = EC_FAILED_TO_OPEN_OUTPUT_FILE;
+			}
+			else
+			{
+				offset = 0;
+
+				while (offset < total_size)
+				{
+					if ((written = write(outfile,&buffer[offset],total_size - offset)) <= 0)
+						break;
+
+					offset += written;
+				}
+
+				close(outfile);
+
+				if (offset != total_size)
+				{
+					result = EC_FAILED_TO_WRITE_TO_OUTPUT_FILE;
+				}
+				else
+				{
+#ifndef __unix__
+					/* rename() will not replace a file that exists on this platform */
+					remove(file_name);
+#endif
+					if (rename(temp_name,file_name) != 0)
+					{
+						result = EC_FAILED_TO_WRITE_TO_OUTPUT_FILE;
+					}
+				}
+
+				if (result != EC_OK)
+				{
+					remove(temp_name);
+				}
+			}
+
+			free(temp_name);
+		}
+
+		free(buffer);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_archive_release
+ * Desc : This function will release the tables of the archive. It does not
+ *        release the data that the archive points into.
+ *--------------------------------------------------------------------------------*/
+void	object_archive_release(OBJECT_ARCHIVE* archive)
+{
+	free(archive->members);
+	free(archive->symbols);
+	symbol_table_release(&archive->member_names);
+
+	memset(archive,0,sizeof(OBJECT_ARCHIVE));
+}
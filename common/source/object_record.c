@@ -0,0 +1,166 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: object_record
+ *    desc: This file holds the functions that encode and decode the record
+ *          headers of the object files.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 14:05:31
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include "object_record.h"
+#include "document_generator.h"
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_record_encode_varint
+ * Desc : This function writes the value as a varint and returns the number of
+ *        bytes that it used. The buffer must hold OBJECT_VARINT_MAX_SIZE bytes.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_record_encode_varint(unsigned char* buffer, unsigned int value)
+{
+	unsigned int	result = 0;
+
+	while (value > 0x7f)
+	{
+		buffer[result++] = (unsigned char) ((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+
+	buffer[result++] = (unsigned char) value;
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_record_decode_varint
+ * Desc : This function reads a varint. It returns the number of bytes that it
+ *        used, or 0 if the varint runs off the end of the buffer or is too long.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_record_decode_varint(unsigned char* buffer, unsigned int size, unsigned int* value)
+{
+	unsigned int	result = 0;
+	unsigned int	shift = 0;
+	unsigned int	more = 1;
+
+	*value = 0;
+
+	while (more && result < size && result < OBJECT_VARINT_MAX_SIZE)
+	{
+		*value |= ((unsigned int) (buffer[result] & 0x7f)) << shift;
+		more = buffer[result] & 0x80;
+		shift += 7;
+		result++;
+	}
+
+	if (more)
+	{
+		result = 0;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_record_encode
+ * Desc : This function writes the record header in the wide format. The buffer
+ *        must hold OBJECT_RECORD_MAX_HEADER bytes. It returns the size of the
+ *        header.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_record_encode(unsigned char* buffer, OBJECT_RECORD* record)
+{
+	unsigned int	result = 2;
+
+	buffer[RECORD_TYPE] = record->type;
+	buffer[RECORD_ATOM] = record->atom;
+
+	result += object_record_encode_varint(&buffer[result],record->group);
+	result += object_record_encode_varint(&buffer[result],record->block_number);
+	result += object_record_encode_varint(&buffer[result],record->line_number);
+	result += object_record_encode_varint(&buffer[result],record->data_size);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : widen_group
+ * Desc : This function moves the 16 bit group field of the older objects to the
+ *        32 bit layout, the flags go to the top of the field.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	widen_group(unsigned int group)
+{
+	unsigned int	result = DEFAULT_GROUP;
+
+	if (group != RECORD_SHORT_DEFAULT_GROUP)
+	{
+		result = ((group & RECORD_SHORT_FUNC_API_MASK) << RECORD_SHORT_FLAGS_SHIFT) | (group & ~RECORD_SHORT_FUNC_API_MASK);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_record_decode
+ * Desc : This function reads the record header, in the wide format or the old
+ *        fixed format, the version is the minor version of the object. It
+ *        returns the size of the header, or 0 if the header runs off the end
+ *        of the buffer.
+ *--------------------------------------------------------------------------------*/
+unsigned int	object_record_decode(unsigned char* buffer, unsigned int size, unsigned int version, OBJECT_RECORD* record)
+{
+	unsigned int	used;
+	unsigned int	count;
+	unsigned int	result = 0;
+	unsigned int*	field[4];
+
+	if (version < OBJECT_VERSION_WIDE)
+	{
+		if (size >= RECORD_DATA_START)
+		{
+			record->type			= buffer[RECORD_TYPE];
+			record->atom			= buffer[RECORD_ATOM];
+			record->group			= ((((unsigned int)buffer[RECORD_GROUP]) << 8) | buffer[RECORD_GROUP+1]);
+			record->block_number	= ((((unsigned int)buffer[RECORD_BLOCK_NUM]) << 8) | buffer[RECORD_BLOCK_NUM+1]);
+			record->line_number		= ((((unsigned int)buffer[RECORD_LINE_NUM]) << 8) | buffer[RECORD_LINE_NUM+1]);
+			record->data_size		= ((((unsigned int)buffer[RECORD_DATA_SIZE]) << 8) | buffer[RECORD_DATA_SIZE+1]);
+
+			result = RECORD_DATA_START;
+		}
+	}
+	else if (size > 2)
+	{
+		record->type = buffer[RECORD_TYPE];
+		record->atom = buffer[RECORD_ATOM];
+		result = 2;
+
+		/* the fields are in the order that they are written */
+		field[0] = &record->group;
+		field[1] = &record->block_number;
+		field[2] = &record->line_number;
+		field[3] = &record->data_size;
+
+		for (count=0; result > 0 && count < 4; count++)
+		{
+			if ((used = object_record_decode_varint(&buffer[result],size - result,field[count])) == 0)
+			{
+				result = 0;
+			}
+			else
+			{
+				result += used;
+			}
+		}
+	}
+
+	if (result > 0 && version < OBJECT_VERSION_WIDE_IDS)
+	{
+		record->group = widen_group(record->group);
+	}
+
+	return result;
+}
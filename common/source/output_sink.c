@@ -0,0 +1,115 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: output_sink
+ *    desc: This file holds the buffered output that the output formats write
+ *          through. The formats produce their output a tag or a fragment at a
+ *          time, this gathers it up so that it hits the file in large writes.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 10:12:41
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "error_codes.h"
+#include "output_format.h"
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: output_sink_write
+ *  desc: This function will add the data to the output buffer. If the data will
+ *        not fit the buffer is flushed first, data that is bigger than the
+ *        buffer is written straight to the file. If the buffer cannot be
+ *        allocated the data is written straight to the file unbuffered.
+ *--------------------------------------------------------------------------------*/
+void	output_sink_write(DRAW_STATE* draw_state, const void* data, unsigned int data_size)
+{
+	OUTPUT_SINK*	sink = &draw_state->sink;
+
+	if (sink->buffer == NULL)
+	{
+		sink->buffer	= malloc(OUTPUT_SINK_SIZE);
+		sink->used		= 0;
+
+		if (sink->buffer == NULL)
+		{
+			sink->size = 0;
+			write(draw_state->output_file,data,data_size);
+			return;
+		}
+
+		sink->size = OUTPUT_SINK_SIZE;
+	}
+
+	if ((sink->used + data_size) > sink->size)
+	{
+		output_sink_flush(draw_state);
+	}
+
+	if (data_size > sink->size)
+	{
+		write(draw_state->output_file,data,data_size);
+	}
+	else
+	{
+		memcpy(&sink->buffer[sink->used],data,data_size);
+		sink->used += data_size;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: output_sink_flush
+ *  desc: This function will write the buffered data to the output file.
+ *--------------------------------------------------------------------------------*/
+void	output_sink_flush(DRAW_STATE* draw_state)
+{
+	OUTPUT_SINK*	sink = &draw_state->sink;
+
+	if (sink->used > 0 && draw_state->output_file != -1)
+	{
+		write(draw_state->output_file,sink->buffer,sink->used);
+	}
+
+	sink->used = 0;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: output_sink_close
+ *  desc: This function will flush the buffer and close the output file. The
+ *        buffer is kept so that it can be used by the next file.
+ *--------------------------------------------------------------------------------*/
+void	output_sink_close(DRAW_STATE* draw_state)
+{
+	if (draw_state->output_file != -1)
+	{
+		output_sink_flush(draw_state);
+		close(draw_state->output_file);
+		draw_state->output_file = -1;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: output_sink_release
+ *  desc: This function will release the buffer. Any data that has not been
+ *        flushed is lost.
+ *--------------------------------------------------------------------------------*/
+void	output_sink_release(DRAW_STATE* draw_state)
+{
+	if (draw_state->sink.buffer != NULL)
+	{
+		free(draw_state->sink.buffer);
+	}
+
+	draw_state->sink.buffer	= NULL;
+	draw_state->sink.size	= 0;
+	draw_state->sink.used	= 0;
+}
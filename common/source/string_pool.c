@@ -0,0 +1,102 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: string_pool
+ *    desc: This file holds the functions for the string pool.
+ *
+ *          The strings are copied into an arena and indexed by a symbol table
+ *          with a NULL scope. The symbol name is the pooled copy, so the table
+ *          does not need any other copy of the string.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 15:48:09
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "error_codes.h"
+#include "symbol_table.h"
+#include "string_pool.h"
+
+static ARENA			g_string_arena;
+static SYMBOL_TABLE		g_string_symbols;
+static unsigned int		g_string_adds;
+static unsigned int		g_string_bytes;
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : string_pool_add
+ * Desc : This function will return the pooled copy of the string, adding it to
+ *        the pool if it is not already there. It returns NULL if the string
+ *        cannot be added.
+ *--------------------------------------------------------------------------------*/
+unsigned char*	string_pool_add(const unsigned char* string, unsigned int length)
+{
+	unsigned char*	result;
+
+	g_string_adds++;
+
+	if ((result = symbol_table_find(&g_string_symbols,NULL,(unsigned char*) string,length)) == NULL)
+	{
+		if ((result = arena_alloc(&g_string_arena,length + 1)) != NULL)
+		{
+			memcpy(result,string,length);
+			result[length] = '\0';
+
+			if (symbol_table_add(&g_string_symbols,NULL,result,length,result) != EC_OK)
+			{
+				/* the arena memory is lost until the pool is released */
+				result = NULL;
+			}
+			else
+			{
+				g_string_bytes += length + 1;
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : string_pool_find
+ * Desc : This function will return the pooled copy of the string without adding
+ *        it. It returns NULL if the string is not in the pool, so nothing that
+ *        is keyed on pooled names can have that name.
+ *--------------------------------------------------------------------------------*/
+unsigned char*	string_pool_find(const unsigned char* string, unsigned int length)
+{
+	return symbol_table_find(&g_string_symbols,NULL,(unsigned char*) string,length);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : string_pool_stats
+ * Desc : This function will print the size of the pool and how many of the
+ *        adds found the string already in the pool.
+ *--------------------------------------------------------------------------------*/
+void	string_pool_stats(void)
+{
+	printf("%-16s strings: %6u adds: %8u bytes: %8u\n",
+			"string pool",
+			g_string_symbols.num_symbols,
+			g_string_adds,
+			g_string_bytes);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : string_pool_release
+ * Desc : This function will release the pool, all the pooled strings are freed.
+ *--------------------------------------------------------------------------------*/
+void	string_pool_release(void)
+{
+	symbol_table_release(&g_string_symbols);
+	arena_release(&g_string_arena);
+
+	g_string_adds = 0;
+	g_string_bytes = 0;
+}
@@ -0,0 +1,288 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: symbol_table
+ *    desc: This file holds the functions for the hashed symbol table.
+ *
+ *          The table is a power of two array of buckets that each hold a chain
+ *          of symbols. The table is doubled when the number of symbols reaches
+ *          the number of buckets so the chains stay short. A table that is all
+ *          zeros is an empty table, the buckets are allocated on the first add.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 10:12:31
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilities.h"
+#include "error_codes.h"
+#include "symbol_table.h"
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_hash
+ * Desc : This function will hash the name and the scope together.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	symbol_hash(void* scope, unsigned char* name, unsigned int name_length)
+{
+	unsigned long	scope_value = (unsigned long) scope;
+
+	return fnv_32_hash(name,name_length) ^ ((unsigned int)(scope_value >> 4) * 0x9e3779b1);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : interned_hash
+ * Desc : This function will hash the address of an interned name and the scope
+ *        together. The name is not read.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	interned_hash(void* scope, unsigned char* name)
+{
+	unsigned long	scope_value = (unsigned long) scope;
+	unsigned long	name_value = (unsigned long) name;
+
+	return ((unsigned int)(name_value >> 3) * 0x85ebca6b) ^ ((unsigned int)(scope_value >> 4) * 0x9e3779b1);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_grow
+ * Desc : This function will move the symbols into a new bucket array of the
+ *        given size.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	symbol_table_grow(SYMBOL_TABLE* table, unsigned int num_buckets)
+{
+	unsigned int	count;
+	unsigned int	result = EC_OK;
+	SYMBOL*			next;
+	SYMBOL*			current;
+	SYMBOL**		bucket;
+
+	if ((bucket = calloc(num_buckets,sizeof(SYMBOL*))) == NULL)
+	{
+		result = EC_FAILED;
+	}
+	else
+	{
+		for (count=0; count < table->num_buckets; count++)
+		{
+			current = table->bucket[count];
+
+			while (current != NULL)
+			{
+				next = current->next;
+
+				current->next = bucket[current->hash & (num_buckets - 1)];
+				bucket[current->hash & (num_buckets - 1)] = current;
+
+				current = next;
+			}
+		}
+
+		free(table->bucket);
+
+		table->bucket = bucket;
+		table->num_buckets = num_buckets;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_find
+ * Desc : This function will find the item with the given name in the scope. It
+ *        returns NULL if the symbol is not in the table.
+ *--------------------------------------------------------------------------------*/
+void*	symbol_table_find(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length)
+{
+	void*			result = NULL;
+	unsigned int	hash;
+	SYMBOL*			current;
+
+	table->lookups++;
+
+	if (table->num_buckets > 0)
+	{
+		hash = symbol_hash(scope,name,name_length);
+		current = table->bucket[hash & (table->num_buckets - 1)];
+
+		while (current != NULL)
+		{
+			table->compares++;
+
+			if (current->hash == hash && current->scope == scope && current->name_length == name_length &&
+				memcmp(current->name,name,name_length) == 0)
+			{
+				table->found++;
+				result = current->item;
+				break;
+			}
+
+			current = current->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_insert
+ * Desc : This function will add the item to the table with the given hash. If
+ *        the name already exists in the scope the first item added is kept, as
+ *        this matches what the list searches that the table replaces would have
+ *        found. Interned names are the same name only if they are the same
+ *        pointer.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	symbol_table_insert(SYMBOL_TABLE* table, unsigned int hash, void* scope, unsigned char* name, unsigned int name_length, void* item, unsigned int interned)
+{
+	unsigned int	result = EC_OK;
+	SYMBOL*			current;
+	SYMBOL*			symbol;
+
+	if (table->num_symbols >= table->num_buckets)
+	{
+		result = symbol_table_grow(table,(table->num_buckets == 0) ? SYMBOL_TABLE_INITIAL_SIZE : table->num_buckets * 2);
+	}
+
+	if (result == EC_OK)
+	{
+		current = table->bucket[hash & (table->num_buckets - 1)];
+
+		while (current != NULL)
+		{
+			if (current->hash == hash && current->scope == scope &&
+				(interned ? (current->name == name) : (current->name_length == name_length && memcmp(current->name,name,name_length) == 0)))
+			{
+				break;
+			}
+
+			current = current->next;
+		}
+
+		if (current == NULL)
+		{
+			if ((symbol = malloc(sizeof(SYMBOL))) == NULL)
+			{
+				result = EC_FAILED;
+			}
+			else
+			{
+				symbol->hash		= hash;
+				symbol->name		= name;
+				symbol->name_length	= name_length;
+				symbol->scope		= scope;
+				symbol->item		= item;
+				symbol->next		= table->bucket[hash & (table->num_buckets - 1)];
+
+				table->bucket[hash & (table->num_buckets - 1)] = symbol;
+				table->num_symbols++;
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_add
+ * Desc : This function will add the item to the table. If the name already
+ *        exists in the scope the first item added is kept.
+ *--------------------------------------------------------------------------------*/
+unsigned int	symbol_table_add(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length, void* item)
+{
+	return symbol_table_insert(table,symbol_hash(scope,name,name_length),scope,name,name_length,item,0);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_find_interned
+ * Desc : This function will find the item with the given interned name in the
+ *        scope. The name must come from the string pool, and the table must
+ *        only have had interned names added to it. The names are compared by
+ *        pointer. It returns NULL if the symbol is not in the table.
+ *--------------------------------------------------------------------------------*/
+void*	symbol_table_find_interned(SYMBOL_TABLE* table, void* scope, unsigned char* name)
+{
+	void*			result = NULL;
+	unsigned int	hash;
+	SYMBOL*			current;
+
+	table->lookups++;
+
+	if (table->num_buckets > 0)
+	{
+		hash = interned_hash(scope,name);
+		current = table->bucket[hash & (table->num_buckets - 1)];
+
+		while (current != NULL)
+		{
+			table->compares++;
+
+			if (current->name == name && current->scope == scope)
+			{
+				table->found++;
+				result = current->item;
+				break;
+			}
+
+			current = current->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_add_interned
+ * Desc : This function will add the item to the table under an interned name.
+ *        The name must come from the string pool. If the name already exists in
+ *        the scope the first item added is kept.
+ *--------------------------------------------------------------------------------*/
+unsigned int	symbol_table_add_interned(SYMBOL_TABLE* table, void* scope, unsigned char* name, unsigned int name_length, void* item)
+{
+	return symbol_table_insert(table,interned_hash(scope,name),scope,name,name_length,item,1);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_stats
+ * Desc : This function will print the lookup counters for the table.
+ *--------------------------------------------------------------------------------*/
+void	symbol_table_stats(SYMBOL_TABLE* table, const char* table_name)
+{
+	printf("%-16s symbols: %6u lookups: %8u found: %8u compares: %8u\n",
+			table_name,
+			table->num_symbols,
+			table->lookups,
+			table->found,
+			table->compares);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_table_release
+ * Desc : This function will free the symbols, the items are not touched.
+ *--------------------------------------------------------------------------------*/
+void	symbol_table_release(SYMBOL_TABLE* table)
+{
+	unsigned int	count;
+	SYMBOL*			next;
+	SYMBOL*			current;
+
+	for (count=0; count < table->num_buckets; count++)
+	{
+		current = table->bucket[count];
+
+		while (current != NULL)
+		{
+			next = current->next;
+			free(current);
+			current = next;
+		}
+	}
+
+	free(table->bucket);
+
+	memset(table,0,sizeof(SYMBOL_TABLE));
+}
@@ -197,7 +197,7 @@ static unsigned int	write_complex (	DRAW_STATE* draw_state, NAME* text_block )
 								{
 									/* write it to the output file */
 									draw_state->output_buffer[out_pos++] = '\n';
-									write(draw_state->output_file,draw_state->output_buffer,out_pos);
+									output_sink_write(draw_state,draw_state->output_buffer,out_pos);
 									memset(draw_state->output_buffer,' ',draw_state->margin_width+level);
 									out_pos = draw_state->margin_width+level;
 									last_comma = 0;
@@ -217,7 +217,7 @@ static unsigned int	write_complex (	DRAW_STATE* draw_state, NAME* text_block )
 								if (level < group)
 								{
 									draw_state->output_buffer[out_pos++] = '\n';
-									write(draw_state->output_file,draw_state->output_buffer,out_pos);
+									output_sink_write(draw_state,draw_state->output_buffer,out_pos);
 									memset(draw_state->output_buffer,' ',draw_state->margin_width+level);
 									out_pos = draw_state->margin_width+level;
 									last_comma = 0;
@@ -243,7 +243,7 @@ static unsigned int	write_complex (	DRAW_STATE* draw_state, NAME* text_block )
 						{
 							unsigned char temp = draw_state->output_buffer[last_comma];
 							draw_state->output_buffer[last_comma] = '\n';
-							write(draw_state->output_file,draw_state->output_buffer,last_comma+1);
+							output_sink_write(draw_state,draw_state->output_buffer,last_comma+1);
 							
 							draw_state->output_buffer[last_comma] = temp;
 							memcpy(&draw_state->output_buffer[draw_state->margin_width + level],&draw_state->output_buffer[last_comma],(out_pos - last_comma));
@@ -252,7 +252,7 @@ static unsigned int	write_complex (	DRAW_STATE* draw_state, NAME* text_block )
 						else
 						{
 							draw_state->output_buffer[out_pos] = '\n';
-							write(draw_state->output_file,draw_state->output_buffer,out_pos+1);
+							output_sink_write(draw_state,draw_state->output_buffer,out_pos+1);
 
 							out_pos = draw_state->margin_width+level;
 						}
@@ -262,7 +262,7 @@ static unsigned int	write_complex (	DRAW_STATE* draw_state, NAME* text_block )
 				}
 
 				draw_state->output_buffer[out_pos] = '\n';
-				write(draw_state->output_file,draw_state->output_buffer,out_pos+1);
+				output_sink_write(draw_state,draw_state->output_buffer,out_pos+1);
 				break;
 		}
 	}
@@ -288,8 +288,8 @@ static void	write_line_clipped(	DRAW_STATE* draw_state, NAME* text_block )
 		{
 			if (length > 0)
 			{
-				write(draw_state->output_file,&text_block->name[start],length);
-				write(draw_state->output_file,"\n",1);
+				output_sink_write(draw_state,&text_block->name[start],length);
+				output_sink_write(draw_state,"\n",1);
 			}
 
 			length = 0;
@@ -305,8 +305,8 @@ static void	write_line_clipped(	DRAW_STATE* draw_state, NAME* text_block )
 
 	if (length > 0)
 	{
-		write(draw_state->output_file,&text_block->name[start],length);
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,&text_block->name[start],length);
+		output_sink_write(draw_state,"\n",1);
 	}
 
 }
@@ -349,14 +349,14 @@ void	write_text(DRAW_STATE* draw_state, NAME* text_block)
 		if (draw_state->offset == 0 || line_left == 0)
 		{
 			/* Ok, write the margin */
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
 			draw_state->offset = draw_state->margin_width;
 			draw_state->no_space = 0;
 		}
 		else if (!text_punctuation(&text_block->name[text_used]) && !draw_state->no_space)
 		{
 			/* it's a continuation - so need to add a space */
-			write(draw_state->output_file," ",1);
+			output_sink_write(draw_state," ",1);
 			draw_state->offset++;
 		}
 
@@ -365,7 +365,7 @@ void	write_text(DRAW_STATE* draw_state, NAME* text_block)
 		if (text_left < line_left)
 		{
 			/* ok, partial so just write it */
-			write(draw_state->output_file,&text_block->name[text_used],text_left);
+			output_sink_write(draw_state,&text_block->name[text_used],text_left);
 			text_used = text_length;
 			draw_state->offset += text_left;
 		}
@@ -377,16 +377,16 @@ void	write_text(DRAW_STATE* draw_state, NAME* text_block)
 			if (!is_wrapped && (draw_state->page_width - draw_state->offset) < full_page)
 			{
 				/* less than a word, end the line and go around again */
-				write(draw_state->output_file,"\n",1);
+				output_sink_write(draw_state,"\n",1);
 				draw_state->offset = 0;
 			}
 			else
 			{
 				/* write the text - increment if it is wrapped */
-				write(draw_state->output_file,&text_block->name[text_used],line_left);
+				output_sink_write(draw_state,&text_block->name[text_used],line_left);
 				text_used += line_left + is_wrapped;
 				draw_state->offset += line_left;
-				write(draw_state->output_file,"\n",1);
+				output_sink_write(draw_state,"\n",1);
 			}
 
 			line_left = 0;
@@ -394,7 +394,7 @@ void	write_text(DRAW_STATE* draw_state, NAME* text_block)
 		else
 		{
 			/* at end of line */
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 			draw_state->offset = 0;
 		}
 	}
@@ -410,7 +410,7 @@ void	write_text(DRAW_STATE* draw_state, NAME* text_block)
  *--------------------------------------------------------------------------------*/
 void	write_block_text(DRAW_STATE* draw_state, NAME* text_block, unsigned int flags)
 {
-	unsigned int start;
+	unsigned int start = 0;
 	unsigned int offset = 0;
 	unsigned int clipped;
 	unsigned int wrapped;
@@ -435,21 +435,21 @@ void	write_block_text(DRAW_STATE* draw_state, NAME* text_block, unsigned int fla
 		{
 			if (text_block->name[offset] == 0x0a)
 			{
-				write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
-				write(draw_state->output_file,&text_block->name[start],(offset - start) + 1);
+				output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
+				output_sink_write(draw_state,&text_block->name[start],(offset - start) + 1);
 				start = offset + 1;
 			}
 			else if ((offset - start) >= draw_state->page_width)
 			{
-				write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
-				write(draw_state->output_file,&text_block->name[start],offset - start);
+				output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
+				output_sink_write(draw_state,&text_block->name[start],offset - start);
 				start = offset + 1;
 			}
 		}
 
-		if ((start - offset) > 0)
+		if (offset > start)
 		{
-			write(draw_state->output_file,&text_block->name[start],offset - start);
+			output_sink_write(draw_state,&text_block->name[start],offset - start);
 		}
 	}
 	else
@@ -462,7 +462,7 @@ void	write_block_text(DRAW_STATE* draw_state, NAME* text_block, unsigned int fla
 			clipped = 0;
 			wrapped = 0;
 
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
 
 			if ((text_block_remaining + draw_state->margin_width) > draw_state->page_width)
 			{
@@ -477,7 +477,7 @@ void	write_block_text(DRAW_STATE* draw_state, NAME* text_block, unsigned int fla
 				}
 
 				/* write the output */
-				write(draw_state->output_file,&text_block->name[offset],text_used);
+				output_sink_write(draw_state,&text_block->name[offset],text_used);
 
 				text_block_remaining	-= text_used + wrapped;
 				offset					+= text_used + wrapped;
@@ -486,14 +486,14 @@ void	write_block_text(DRAW_STATE* draw_state, NAME* text_block, unsigned int fla
 			}
 			else
 			{
-				write(draw_state->output_file,&text_block->name[offset],text_block_remaining);
+				output_sink_write(draw_state,&text_block->name[offset],text_block_remaining);
 				text_block_remaining = 0;
 			}
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 		}
 		while (clipped);
 	}
 	
 	/* add a line after the section */
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 }
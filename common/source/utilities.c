@@ -17,8 +17,20 @@
 #include <string.h>
 #include <malloc.h>
 #include "utilities.h"
+#include "symbol_table.h"
+#include "string_pool.h"
 #include "document_generator.h"
 
+/*--------------------------------------------------------------------------------*
+ * The model symbol tables.
+ *
+ * The groups are scoped by the group tree, the timelines and states by the group
+ * that owns them.
+ *--------------------------------------------------------------------------------*/
+static SYMBOL_TABLE	g_group_symbols;
+static SYMBOL_TABLE	g_timeline_symbols;
+static SYMBOL_TABLE	g_state_symbols;
+
 /*--------------------------------------------------------------------------------*
  * Standard expectable char table
  *
@@ -356,9 +368,11 @@ GROUP*	add_group ( GROUP* group_tree, unsigned char* name, unsigned int name_len
 		if (current->next == NULL)
 		{
 			current->next = calloc(1,sizeof(GROUP));
-			memcpy(current->next->name,name,name_length);
+			current->next->name = string_pool_add(name,name_length);
 			current->next->name_length = name_length;
 			result = current->next;
+
+			symbol_table_add(&g_group_symbols,group_tree,result->name,name_length,result);
 			break;
 		}
 			
@@ -377,7 +391,6 @@ GROUP*	add_group ( GROUP* group_tree, unsigned char* name, unsigned int name_len
 GROUP* find_group ( GROUP* group_tree, unsigned char* name, unsigned int name_length, unsigned int* special_group)
 {
 	GROUP* result = NULL;
-	GROUP* current = group_tree;
 			
 	if (name_length == 3 && (memcmp("all",name,name_length) == 0))
 	{
@@ -392,14 +405,14 @@ GROUP* find_group ( GROUP* group_tree, unsigned char* name, unsigned int name_le
 	}
 	else
 	{
-		while (current != NULL)
+		/* the root is not in the symbol table */
+		if (group_tree->name_length == name_length && memcmp(group_tree->name,name,name_length) == 0)
 		{
-			if (current->name_length == name_length && memcmp(current->name,name,name_length) == 0)
-			{
-				result = current;
-				break;
-			}
-			current = current->next;
+			result = group_tree;
+		}
+		else
+		{
+			result = symbol_table_find(&g_group_symbols,group_tree,name,name_length);
 		}
 	
 		*special_group = NORMAL_GROUP;
@@ -411,31 +424,15 @@ GROUP* find_group ( GROUP* group_tree, unsigned char* name, unsigned int name_le
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : find_timeline
  * Desc : This function will find the timeline in the timeline tree for the given
- *        group.
+ *        group. The name must come from the string pool.
  *--------------------------------------------------------------------------------*/
-TIMELINE* find_timeline ( GROUP* group, unsigned char* name, unsigned int name_length )
+TIMELINE* find_timeline ( GROUP* group, unsigned char* name )
 {
 	TIMELINE*	result = NULL;
-	TIMELINE*	current_timeline = NULL;
 
-	if (group != NULL)
+	if (group != NULL && name != NULL)
 	{
-		if (group->sequence_diagram != NULL && group->sequence_diagram->timeline_list != NULL)
-		{
-			current_timeline = group->sequence_diagram->timeline_list;
-
-			do
-			{
-				if (current_timeline->name_length == name_length && memcmp(current_timeline->name,name,name_length) == 0)
-				{
-					result = current_timeline;
-					break;
-				}
-
-				current_timeline = current_timeline->next;
-			}
-			while (current_timeline != NULL);
-		}
+		result = symbol_table_find_interned(&g_timeline_symbols,group,name);
 	}
 
 	return result;
@@ -446,7 +443,7 @@ TIMELINE* find_timeline ( GROUP* group, unsigned char* name, unsigned int name_l
  * Desc : This function will add the timeline to the timeline list. It will not check to
  *        see if the timeline already exists, so this function MUST be called after
  *        the find has been called or duplicate timelines will occur and the results
- *        will be unpredictable.
+ *        will be unpredictable. The name is held in the string pool.
  *--------------------------------------------------------------------------------*/
 TIMELINE* add_timeline ( GROUP* group, unsigned char* name, unsigned int name_length, unsigned int line_number, unsigned int flags )
 {
@@ -488,13 +485,13 @@ TIMELINE* add_timeline ( GROUP* group, unsigned char* name, unsigned int name_le
 		}
 
 		/* Ok, current timeline is the new timeline - now fill it in */
-		current_timeline->name = malloc(name_length);
+		current_timeline->name = string_pool_add(name,name_length);
 		current_timeline->flags = flags;
 		current_timeline->name_length = name_length;
 		current_timeline->group = group;
 		current_timeline->line_number = line_number;
 
-		memcpy(current_timeline->name,name,name_length);
+		symbol_table_add_interned(&g_timeline_symbols,group,current_timeline->name,name_length,current_timeline);
 		
 		result = current_timeline;
 	}
@@ -505,31 +502,15 @@ TIMELINE* add_timeline ( GROUP* group, unsigned char* name, unsigned int name_le
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : find_state
  * Desc : This function will find the state in the state tree for the given
- *        group.
+ *        group. The name must come from the string pool.
  *--------------------------------------------------------------------------------*/
-STATE* find_state ( GROUP* group, unsigned char* name, unsigned int name_length )
+STATE* find_state ( GROUP* group, unsigned char* name )
 {
 	STATE*	result = NULL;
-	STATE*	current_state = NULL;
 
-	if (group != NULL)
+	if (group != NULL && name != NULL)
 	{
-		if (group->state_machine != NULL && group->state_machine->state_list != NULL)
-		{
-			current_state = group->state_machine->state_list;
-
-			do
-			{
-				if (current_state->name_length == name_length && memcmp(current_state->name,name,name_length) == 0)
-				{
-					result = current_state;
-					break;
-				}
-
-				current_state = current_state->next;
-			}
-			while (current_state != NULL);
-		}
+		result = symbol_table_find_interned(&g_state_symbols,group,name);
 	}
 
 	return result;
@@ -540,7 +521,7 @@ STATE* find_state ( GROUP* group, unsigned char* name, unsigned int name_length
  * Desc : This function will add the state to the state list. It will not check to
  *        see if the state already exists, so this function MUST be called after
  *        the find has been called or duplicate states will occur and the results
- *        will be unpredictable.
+ *        will be unpredictable. The name is held in the string pool.
  *--------------------------------------------------------------------------------*/
 STATE* add_state ( GROUP* group, unsigned char* name, unsigned int name_length, unsigned int line_number, unsigned int flags )
 {
@@ -560,21 +541,13 @@ STATE* add_state ( GROUP* group, unsigned char* name, unsigned int name_length,
 		}
 		else
 		{
-			current_state = group->state_machine->state_list;
-
-			while (current_state != NULL)
-			{
-				if (current_state->next == NULL)
-				{
-					current_state->next = calloc(1,sizeof(STATE));
-					current_state = current_state->next; 
-					break;
-				}
-
-				current_state = current_state->next;
-			}
+			/* add it to the end */
+			current_state = calloc(1,sizeof(STATE));
+			group->state_machine->last_state->next = current_state;
 		}
 
+		group->state_machine->last_state = current_state;
+
 		/* for drawing needs to know the max state length */
 		if (group->state_machine->max_state_length < name_length)
 		{
@@ -582,13 +555,13 @@ STATE* add_state ( GROUP* group, unsigned char* name, unsigned int name_length,
 		}
 
 		/* Ok, current state is the new state - now fill it in */
-		current_state->name = malloc(name_length);
+		current_state->name = string_pool_add(name,name_length);
 		current_state->flags = flags;
 		current_state->name_length = name_length;
 		current_state->group = group;
 		current_state->line_number = line_number;
 
-		memcpy(current_state->name,name,name_length);
+		symbol_table_add_interned(&g_state_symbols,group,current_state->name,name_length,current_state);
 		
 		result = current_state;
 	}
@@ -620,6 +593,20 @@ void	copy_name(NAME* from, NAME* to)
 	}
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : reference_name
+ * Desc : This function will set the name to point at the same string as the
+ *        from name without copying it. The new name is not allocated, so
+ *        free_name() will not release it and the string must outlive the name.
+ *--------------------------------------------------------------------------------*/
+void	reference_name(NAME* from, NAME* to)
+{
+	to->name = from->name;
+	to->name_length = from->name_length;
+	to->fixed = from->fixed;
+	to->allocated_size = 0;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * @name: compare_name
  * @desc: This function will compare two NAMEs.
@@ -755,6 +742,30 @@ void	free_name(NAME* name)
 	name->allocated_size = 0;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_symbol_stats
+ * Desc : This function will print the lookup counters for the model symbols.
+ *--------------------------------------------------------------------------------*/
+void	model_symbol_stats(void)
+{
+	symbol_table_stats(&g_group_symbols,"groups");
+	symbol_table_stats(&g_timeline_symbols,"timelines");
+	symbol_table_stats(&g_state_symbols,"states");
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_symbol_release
+ * Desc : This function will empty the model symbol tables. It is used when the
+ *        model is thrown away and built again, the items that the tables point
+ *        at are not released.
+ *--------------------------------------------------------------------------------*/
+void	model_symbol_release(void)
+{
+	symbol_table_release(&g_group_symbols);
+	symbol_table_release(&g_timeline_symbols);
+	symbol_table_release(&g_state_symbols);
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : lfsr_32
  * Desc : This function is a basic LFSR. 
@@ -827,6 +838,8 @@ void	write_text_index_entry(DRAW_STATE* draw_state, DOC_SECTION* section)
 	buffer = draw_state->output_buffer;
 	buffer_offset = draw_state->margin_width;
 
+	memset(buffer,' ',buffer_offset);
+
 	if ((draw_state->format_flags & OUTPUT_FORMAT_FLAT) == 0)
 	{
 		start = index_generate_label(section,0,INDEX_STYLE_BARE,temp,200,'.');
@@ -910,7 +923,7 @@ unsigned int	make_version_string(unsigned int version, unsigned char* version_st
 			break;
 	}
 
-	result = 10;
+	result = 11;
 	result -= SizeToString(version_string,((version & 0x0000ff00) >> 8),result);
 	version_string[result-1] = '.';
 	result--;
@@ -0,0 +1,184 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *   @file: work_pool
+ *   @desc: This file holds the pool of workers that run independent jobs, the
+ *          output formats in pdp and the input files in pdsc.
+ *
+ *          The jobs are handed out in order to the workers, each job is called
+ *          with its job number so the caller can find the state for the job.
+ *          Anything shared between the jobs that a job changes (in pdp the
+ *          diagram layouts in the model) must be changed holding the pool lock.
+ *
+ * @author: pantoine
+ *   @date: 18/10/2026
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include "error_codes.h"
+#include "work_pool.h"
+
+#ifdef __unix__
+#include <pthread.h>
+#endif
+
+/*--------------------------------------------------------------------------------*
+ * The state of the running pool.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int			next_job;
+	unsigned int			num_jobs;
+	unsigned int			result;
+	void*					context;
+	WORK_POOL_FUNCTION	function;
+
+} WORK_POOL;
+
+#ifdef __unix__
+static pthread_mutex_t	g_job_lock		= PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t	g_shared_lock	= PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static unsigned int		g_pool_running = 0;
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: work_pool_worker
+ *  desc: This function takes jobs from the pool until there are none left.
+ *--------------------------------------------------------------------------------*/
+static void*	work_pool_worker(void* parameter)
+{
+	unsigned int	job;
+	unsigned int	result;
+	WORK_POOL*	pool = parameter;
+
+	do
+	{
+#ifdef __unix__
+		pthread_mutex_lock(&g_job_lock);
+#endif
+		job = pool->next_job;
+
+		if (pool->next_job < pool->num_jobs)
+		{
+			pool->next_job++;
+		}
+#ifdef __unix__
+		pthread_mutex_unlock(&g_job_lock);
+#endif
+
+		if (job < pool->num_jobs)
+		{
+			result = pool->function(pool->context,job);
+
+#ifdef __unix__
+			pthread_mutex_lock(&g_job_lock);
+#endif
+			if (pool->result == EC_OK)
+			{
+				pool->result = result;
+			}
+#ifdef __unix__
+			pthread_mutex_unlock(&g_job_lock);
+#endif
+		}
+	}
+	while (job < pool->num_jobs);
+
+	return NULL;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: work_pool_run
+ *  desc: This function runs the jobs on the given number of workers and waits
+ *        for them all to complete. It returns the first failure of the jobs.
+ *        If the workers cannot be started the jobs are run on the calling
+ *        thread.
+ *--------------------------------------------------------------------------------*/
+unsigned int	work_pool_run(unsigned int num_workers, unsigned int num_jobs, WORK_POOL_FUNCTION function, void* context)
+{
+	unsigned int	count;
+	unsigned int	started = 0;
+	WORK_POOL		pool;
+#ifdef __unix__
+	pthread_t		worker[WORK_POOL_MAX_WORKERS];
+#endif
+
+	pool.next_job	= 0;
+	pool.num_jobs	= num_jobs;
+	pool.result		= EC_OK;
+	pool.context	= context;
+	pool.function	= function;
+
+	if (num_workers > num_jobs)
+	{
+		num_workers = num_jobs;
+	}
+
+	if (num_workers > WORK_POOL_MAX_WORKERS)
+	{
+		num_workers = WORK_POOL_MAX_WORKERS;
+	}
+
+#ifdef __unix__
+	if (num_workers > 1)
+	{
+		g_pool_running = 1;
+
+		/* the calling thread is one of the workers */
+		for (count=1; count < num_workers; count++)
+		{
+			if (pthread_create(&worker[started],NULL,work_pool_worker,&pool) == 0)
+			{
+				started++;
+			}
+		}
+	}
+#endif
+
+	/* this does all the jobs if no workers were started */
+	work_pool_worker(&pool);
+
+#ifdef __unix__
+	for (count=0; count < started; count++)
+	{
+		pthread_join(worker[count],NULL);
+	}
+#endif
+
+	g_pool_running = 0;
+
+	return pool.result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: work_pool_lock
+ *  desc: This function takes the shared lock if the pool is running.
+ *--------------------------------------------------------------------------------*/
+void	work_pool_lock(void)
+{
+#ifdef __unix__
+	if (g_pool_running)
+	{
+		pthread_mutex_lock(&g_shared_lock);
+	}
+#endif
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: work_pool_unlock
+ *  desc: This function releases the shared lock.
+ *--------------------------------------------------------------------------------*/
+void	work_pool_unlock(void)
+{
+#ifdef __unix__
+	if (g_pool_running)
+	{
+		pthread_mutex_unlock(&g_shared_lock);
+	}
+#endif
+}
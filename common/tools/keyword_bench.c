@@ -0,0 +1,139 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: keyword_bench
+ *    desc: This file is a micro-benchmark for the keyword recognisers. It times
+ *          atoms_check_word() and symbols_check_word() over words that are
+ *          keywords, words that start with a keyword and words that are not
+ *          keywords, as they are found in the source. The old build_graph
+ *          recognisers in keyword_bench_old.c are timed over the same words so
+ *          the two can be compared side by side.
+ *
+ *          usage: keyword_bench [iterations]
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 12:20:44
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atoms.h"
+#include "symbols.h"
+
+#define DEFAULT_ITERATIONS	(200000)
+#define MAX_WORD_LENGTH		(32)
+
+extern ATOMS_STRING_TABLE	atoms_table[];
+extern SYMBOLS_STRING_TABLE	symbols_table[];
+
+typedef int	(*CHECK_WORD_FUNCTION)(unsigned char* word);
+
+int	old_atoms_check_word(unsigned char* word);
+int	old_symbols_check_word(unsigned char* word);
+
+/*--------------------------------------------------------------------------------*
+ * Words that are not keywords, these are the common misses.
+ *--------------------------------------------------------------------------------*/
+static const char*	g_misses[] = {"x","the","value_t","returned","main","buffer","i","states",
+								  "uint32_t","size","length","FILE","print","group_id","end","s",
+								  "int32_t","constant","character","shorts"};
+
+#define NUM_MISSES	(sizeof(g_misses) / sizeof(g_misses[0]))
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : make_words
+ * Desc : This function builds the words to look up. Each keyword is followed by
+ *        the characters that follow it in the source, and the misses are mixed in.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	make_words(unsigned char (*words)[MAX_WORD_LENGTH], const char* (*get_name)(unsigned int), unsigned int num_keywords)
+{
+	unsigned int	count;
+	unsigned int	result = 0;
+
+	for (count=0; count < num_keywords; count++)
+	{
+		sprintf((char*) words[result++],"%s: ",get_name(count));
+		sprintf((char*) words[result++],"%s s",get_name(count));
+		sprintf((char*) words[result++],"%s ",g_misses[count % NUM_MISSES]);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : time_lookups
+ * Desc : This function times the lookups and returns the nanoseconds per lookup.
+ *        The number of words that were found is added to found.
+ *--------------------------------------------------------------------------------*/
+static double	time_lookups(CHECK_WORD_FUNCTION check_word, unsigned char (*words)[MAX_WORD_LENGTH], unsigned int num_words, unsigned int iterations, long* found)
+{
+	clock_t			start;
+	unsigned int	count;
+	unsigned int	word;
+
+	start = clock();
+
+	for (count=0; count < iterations; count++)
+	{
+		for (word=0; word < num_words; word++)
+		{
+			*found += (check_word(words[word]) >= 0);
+		}
+	}
+
+	return ((double)(clock() - start) / CLOCKS_PER_SEC) * 1e9 / ((double) iterations * num_words);
+}
+
+static const char*	atom_name(unsigned int index)	{ return atoms_table[index].name; }
+static const char*	symbol_name(unsigned int index)	{ return symbols_table[index].name; }
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : compare_lookups
+ * Desc : This function times the new and the old recogniser over the same words
+ *        and prints them side by side.
+ *--------------------------------------------------------------------------------*/
+static void	compare_lookups(const char* name, CHECK_WORD_FUNCTION new_check, CHECK_WORD_FUNCTION old_check, unsigned char (*words)[MAX_WORD_LENGTH], unsigned int num_words, unsigned int iterations)
+{
+	long	new_found = 0;
+	long	old_found = 0;
+	double	new_time;
+	double	old_time;
+
+	new_time = time_lookups(new_check,words,num_words,iterations,&new_found);
+	old_time = time_lookups(old_check,words,num_words,iterations,&old_found);
+
+	/* the found counts also stop the lookups being optimised away */
+	printf("%-8s new: %6.2f ns/lookup  old: %6.2f ns/lookup  found new: %ld old: %ld\n",
+			name,new_time,old_time,new_found,old_found);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : main
+ * Desc : The entry point for the benchmark.
+ *--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+	unsigned int	num_words;
+	unsigned int	iterations = DEFAULT_ITERATIONS;
+	static unsigned char	words[ATOM_NUM_STRINGS * 3][MAX_WORD_LENGTH];
+
+	if (argc > 1)
+	{
+		iterations = (unsigned int) atoi(argv[1]);
+	}
+
+	num_words = make_words(words,atom_name,ATOM_NUM_STRINGS);
+	compare_lookups("atoms",atoms_check_word,old_atoms_check_word,words,num_words,iterations);
+
+	num_words = make_words(words,symbol_name,SYMBOLS_NUM_STRINGS);
+	compare_lookups("symbols",symbols_check_word,old_symbols_check_word,words,num_words,iterations);
+
+	return 0;
+}
@@ -0,0 +1,607 @@
+/*--------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ *    file: keyword_hash
+ *    desc: This file is the generator for the keyword recognisers. It reads a
+ *          list of keywords, one per line, and writes a header with the enum of
+ *          the keywords and a source file that recognises them.
+ *
+ *          The recogniser uses a perfect hash. The key of a word is made from its
+ *          length, its first, middle and last characters. The key picks a bucket
+ *          and the displacement of the bucket moves the key to the slot of the
+ *          keyword, so one compare confirms the word. If two keywords have the
+ *          same key the whole word is hashed with FNV-1a as it is scanned.
+ *
+ *          The tables are powers of two so that the buckets and slots are found
+ *          with a multiply and a shift.
+ *
+ *          usage: keyword_hash <list_file> <output_base> -h <include_dir> -p <prefix>
+ *
+ *          The output is the same interface as the old buildgraph tables, so
+ *          "source/atoms" makes source/atoms.c and <include_dir>/atoms.h.
+ *
+ *  author: pantoine
+ *    date: 18/10/2026 11:40:05
+ *--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2012 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_KEYWORDS		(255)
+#define MAX_KEYWORD_LENGTH	(64)
+#define MAX_DISPLACEMENT	(0xffff)
+#define MAX_PATH_LENGTH		(1024)
+
+#define FNV_BASIS			(0x811c9dc5UL)
+#define FNV_PRIME			(0x01000193UL)
+#define BUCKET_MULTIPLIER	(0x9e3779b1UL)
+#define SLOT_MULTIPLIER		(0x85ebca6bUL)
+#define HASH_MASK			(0xffffffffUL)
+#define MAX_TABLE_BITS		(8)
+
+/*--------------------------------------------------------------------------------*
+ * The keyword set.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	char			name[MAX_KEYWORD_LENGTH+1];
+	unsigned int	length;
+	unsigned long	key;
+
+} KEYWORD;
+
+typedef struct
+{
+	unsigned int	num_keywords;
+	unsigned int	whole_word;
+	unsigned int	bucket_bits;
+	unsigned int	slot_bits;
+	unsigned int	min_length;
+	unsigned int	max_length;
+	KEYWORD			keyword[MAX_KEYWORDS];
+	unsigned char	word_chars[256];
+	unsigned char	slot[1 << MAX_TABLE_BITS];
+	unsigned int	displacement[1 << MAX_TABLE_BITS];
+
+} KEYWORD_SET;
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : keyword_key
+ * Desc : This function is the key that the generated code uses, the generated
+ *        code works in unsigned int so the key is kept to 32 bits here.
+ *--------------------------------------------------------------------------------*/
+static unsigned long	keyword_key(const char* word, unsigned int length, unsigned int whole_word)
+{
+	unsigned int	count;
+	unsigned long	hash = FNV_BASIS;
+	const unsigned char*	chars = (const unsigned char*) word;
+
+	if (whole_word)
+	{
+		for (count=0; count < length; count++)
+		{
+			hash = ((hash ^ chars[count]) * FNV_PRIME) & HASH_MASK;
+		}
+	}
+	else
+	{
+		hash = ((unsigned long) length << 24) ^ ((unsigned long) chars[0] << 16) ^ ((unsigned long) chars[length >> 1] << 8) ^ chars[length-1];
+	}
+
+	return hash;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : keyword_bucket
+ * Desc : This function returns the bucket of the key.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	keyword_bucket(unsigned long key, unsigned int bucket_bits)
+{
+	return (unsigned int) (((key * BUCKET_MULTIPLIER) & HASH_MASK) >> (32 - bucket_bits));
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : keyword_slot
+ * Desc : This function returns the slot that the displacement moves the key to.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	keyword_slot(unsigned long key, unsigned int displacement, unsigned int slot_bits)
+{
+	return (unsigned int) ((((key ^ displacement) * SLOT_MULTIPLIER) & HASH_MASK) >> (32 - slot_bits));
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : make_keys
+ * Desc : This function makes the keys of the keywords. If two of the keywords have
+ *        the same key then the whole words are hashed.
+ *--------------------------------------------------------------------------------*/
+static void	make_keys(KEYWORD_SET* set)
+{
+	unsigned int	count;
+	unsigned int	index;
+
+	set->whole_word = 0;
+
+	for (count=0; count < set->num_keywords; count++)
+	{
+		set->keyword[count].key = keyword_key(set->keyword[count].name,set->keyword[count].length,0);
+
+		for (index=0; index < count; index++)
+		{
+			if (set->keyword[index].key == set->keyword[count].key)
+				set->whole_word = 1;
+		}
+	}
+
+	if (set->whole_word)
+	{
+		for (count=0; count < set->num_keywords; count++)
+		{
+			set->keyword[count].key = keyword_key(set->keyword[count].name,set->keyword[count].length,1);
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : read_keywords
+ * Desc : This function reads the keywords from the list file.
+ *--------------------------------------------------------------------------------*/
+static int	read_keywords(const char* file_name, KEYWORD_SET* set)
+{
+	int				result = 0;
+	char			line[MAX_KEYWORD_LENGTH+2];
+	unsigned int	count;
+	unsigned int	length;
+	FILE*			infile;
+
+	if ((infile = fopen(file_name,"r")) == NULL)
+	{
+		fprintf(stderr,"keyword_hash: failed to open %s\n",file_name);
+		result = 1;
+	}
+	else
+	{
+		set->min_length = MAX_KEYWORD_LENGTH;
+
+		/* a word runs to the end of the identifier, so "states" is not "state" */
+		for (count=0; count < 256; count++)
+		{
+			set->word_chars[count] = (isalnum(count) || count == '_');
+		}
+
+		while (result == 0 && fgets(line,sizeof(line),infile) != NULL)
+		{
+			length = strlen(line);
+
+			if (length == sizeof(line) - 1 && line[length-1] != '\n')
+			{
+				fprintf(stderr,"keyword_hash: keyword too long in %s\n",file_name);
+				result = 1;
+			}
+			else
+			{
+				while (length > 0 && isspace((unsigned char) line[length-1]))
+				{
+					length--;
+				}
+			}
+
+			if (result == 0 && length > 0)
+			{
+				if (set->num_keywords == MAX_KEYWORDS)
+				{
+					fprintf(stderr,"keyword_hash: too many keywords in %s\n",file_name);
+					result = 1;
+				}
+				else
+				{
+					memcpy(set->keyword[set->num_keywords].name,line,length);
+					set->keyword[set->num_keywords].name[length] = '\0';
+					set->keyword[set->num_keywords].length = length;
+
+					for (count=0; count < length; count++)
+					{
+						set->word_chars[(unsigned char) line[count]] = 1;
+					}
+
+					if (length < set->min_length)
+						set->min_length = length;
+
+					if (length > set->max_length)
+						set->max_length = length;
+
+					set->num_keywords++;
+				}
+			}
+		}
+
+		fclose(infile);
+
+		if (result == 0 && set->num_keywords == 0)
+		{
+			fprintf(stderr,"keyword_hash: no keywords in %s\n",file_name);
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : place_keywords
+ * Desc : This function finds the displacements for the buckets. The buckets are
+ *        placed biggest first, as they are the hardest to fit. It returns 0 if
+ *        all the keywords have a slot. The slots that no keyword uses point at
+ *        the first keyword, the compare will fail for them.
+ *--------------------------------------------------------------------------------*/
+static int	place_keywords(KEYWORD_SET* set, unsigned int bucket_bits, unsigned int slot_bits)
+{
+	int				result = 0;
+	unsigned int	size;
+	unsigned int	bucket;
+	unsigned int	count;
+	unsigned int	index;
+	unsigned int	displacement;
+	unsigned int	slot[MAX_KEYWORDS];
+	unsigned int	member[MAX_KEYWORDS];
+	unsigned int	num_members;
+	unsigned char	used[1 << MAX_TABLE_BITS];
+
+	memset(used,0,sizeof(used));
+	memset(set->slot,0,sizeof(set->slot));
+	memset(set->displacement,0,sizeof(set->displacement));
+
+	set->bucket_bits = bucket_bits;
+	set->slot_bits = slot_bits;
+
+	for (size=set->num_keywords; result == 0 && size > 0; size--)
+	{
+		for (bucket=0; result == 0 && bucket < (1U << bucket_bits); bucket++)
+		{
+			num_members = 0;
+
+			for (count=0; count < set->num_keywords; count++)
+			{
+				if (keyword_bucket(set->keyword[count].key,bucket_bits) == bucket)
+				{
+					member[num_members++] = count;
+				}
+			}
+
+			if (num_members == size)
+			{
+				for (displacement=0; displacement <= MAX_DISPLACEMENT; displacement++)
+				{
+					for (count=0; count < num_members; count++)
+					{
+						slot[count] = keyword_slot(set->keyword[member[count]].key,displacement,slot_bits);
+
+						if (used[slot[count]])
+							break;
+
+						for (index=0; index < count; index++)
+						{
+							if (slot[index] == slot[count])
+								break;
+						}
+
+						if (index < count)
+							break;
+					}
+
+					if (count == num_members)
+						break;
+				}
+
+				if (displacement > MAX_DISPLACEMENT)
+				{
+					result = 1;
+				}
+				else
+				{
+					set->displacement[bucket] = displacement;
+
+					for (count=0; count < num_members; count++)
+					{
+						used[slot[count]] = 1;
+						set->slot[slot[count]] = (unsigned char) member[count];
+					}
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_banner
+ * Desc : This function writes the banner for the generated files.
+ *--------------------------------------------------------------------------------*/
+static void	write_banner(FILE* outfile)
+{
+	fprintf(outfile,
+		"/*--------------------------------------------------------------------------------*\n"
+		" * Name: Keyword recogniser\n"
+		" * Desc: function and data structures to recognise a fixed set of keywords\n"
+		" *\n"
+		" *         **** DO NOT AMEND THIS CODE - IT IS AUTO_GENERATED ****\n"
+		" *\n"
+		" * Code and table produced by:\n"
+		" *            common/tools/keyword_hash\n"
+		" *--------------------------------------------------------------------------------*/\n\n");
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_upper
+ * Desc : This function writes the string in upper case.
+ *--------------------------------------------------------------------------------*/
+static void	write_upper(FILE* outfile, const char* string)
+{
+	while (*string != '\0')
+	{
+		fputc(toupper((unsigned char) *string),outfile);
+		string++;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_header
+ * Desc : This function writes the header file.
+ *--------------------------------------------------------------------------------*/
+static int	write_header(const char* file_name, const char* base_name, const char* prefix, KEYWORD_SET* set)
+{
+	int				result = 0;
+	unsigned int	count;
+	FILE*			outfile;
+
+	if ((outfile = fopen(file_name,"w")) == NULL)
+	{
+		fprintf(stderr,"keyword_hash: failed to create %s\n",file_name);
+		result = 1;
+	}
+	else
+	{
+		write_banner(outfile);
+
+		fprintf(outfile,"#ifndef\t__");
+		write_upper(outfile,base_name);
+		fprintf(outfile,"_H__\n#define __");
+		write_upper(outfile,base_name);
+		fprintf(outfile,"_H__\n\ntypedef\tstruct\n{\n\tchar*\t\t\tname;\n\tunsigned int\tlength;\n} ");
+		write_upper(outfile,base_name);
+		fprintf(outfile,"_STRING_TABLE;\n\ntypedef enum\n{\n");
+
+		for (count=0; count < set->num_keywords; count++)
+		{
+			fprintf(outfile,"\t%s",prefix);
+			write_upper(outfile,set->keyword[count].name);
+			fprintf(outfile,",\n");
+		}
+
+		fprintf(outfile,"\t%sNUM_STRINGS\n} %s",prefix,prefix);
+		write_upper(outfile,base_name);
+		fprintf(outfile,";\n\nunsigned int %s_get_length(int word);\nint\t%s_check_word(unsigned char* word);\n\n#endif\n",base_name,base_name);
+
+		fclose(outfile);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_source
+ * Desc : This function writes the source file.
+ *--------------------------------------------------------------------------------*/
+static int	write_source(const char* file_name, const char* base_name, KEYWORD_SET* set)
+{
+	int				result = 0;
+	unsigned int	count;
+	FILE*			outfile;
+
+	if ((outfile = fopen(file_name,"w")) == NULL)
+	{
+		fprintf(stderr,"keyword_hash: failed to create %s\n",file_name);
+		result = 1;
+	}
+	else
+	{
+		write_banner(outfile);
+
+		fprintf(outfile,"#include <string.h>\n#include \"%s.h\"\n\n",base_name);
+		fprintf(outfile,"#define NUM_BUCKETS\t\t(%u)\n#define BUCKET_SHIFT\t(%u)\n",1U << set->bucket_bits,32 - set->bucket_bits);
+		fprintf(outfile,"#define NUM_SLOTS\t\t(%u)\n#define SLOT_SHIFT\t\t(%u)\n",1U << set->slot_bits,32 - set->slot_bits);
+		fprintf(outfile,"#define MIN_LENGTH\t\t(%u)\n#define MAX_LENGTH\t\t(%u)\n\n",set->min_length,set->max_length);
+
+		/* the keywords */
+		write_upper(outfile,base_name);
+		fprintf(outfile,"_STRING_TABLE\t%s_table[%u] = {\n",base_name,set->num_keywords);
+
+		for (count=0; count < set->num_keywords; count++)
+		{
+			fprintf(outfile,"\t\t{\"%s\",%u}%s\n",set->keyword[count].name,set->keyword[count].length,(count + 1 < set->num_keywords) ? "," : "");
+		}
+
+		fprintf(outfile,"};\n\n");
+
+		/* the characters that make up a word */
+		fprintf(outfile,"static unsigned char\tword_chars[256] = \n\t{");
+
+		for (count=0; count < 256; count++)
+		{
+			fprintf(outfile,"%u%s",set->word_chars[count],(count == 255) ? "};\n\n" : (count % 32 == 31) ? ",\n\t " : ",");
+		}
+
+		/* the displacement for each bucket */
+		fprintf(outfile,"static unsigned short\tdisplacement[NUM_BUCKETS] = \n\t{");
+
+		for (count=0; count < (1U << set->bucket_bits); count++)
+		{
+			fprintf(outfile,"0x%04x%s",set->displacement[count],(count + 1 == (1U << set->bucket_bits)) ? "};\n\n" : (count % 16 == 15) ? ",\n\t " : ",");
+		}
+
+		/* the keyword in each slot */
+		fprintf(outfile,"static unsigned char\tslot[NUM_SLOTS] = \n\t{");
+
+		for (count=0; count < (1U << set->slot_bits); count++)
+		{
+			fprintf(outfile,"0x%02x%s",set->slot[count],(count + 1 == (1U << set->slot_bits)) ? "};\n\n" : (count % 16 == 15) ? ",\n\t " : ",");
+		}
+
+		fprintf(outfile,
+			"unsigned int %s_get_length(int word)\n"
+			"{\n"
+			"\treturn %s_table[word].length;\n"
+			"}\n\n",base_name,base_name);
+
+		fprintf(outfile,
+			"int\t%s_check_word(unsigned char* word)\n"
+			"{\n"
+			"\tint\t\t\t\tresult = -1;\n"
+			"\tunsigned int\tkey;\n"
+			"\tunsigned int\tindex;\n"
+			"\tunsigned int\tlength = 0;\n"
+			"\n",base_name);
+
+		if (set->whole_word)
+		{
+			fprintf(outfile,
+				"\tkey = 0x811c9dc5;\n"
+				"\n"
+				"\twhile (length <= MAX_LENGTH && word_chars[word[length]])\n"
+				"\t{\n"
+				"\t\tkey = (key ^ word[length]) * 0x01000193;\n"
+				"\t\tlength++;\n"
+				"\t}\n"
+				"\n"
+				"\tif (length >= MIN_LENGTH && length <= MAX_LENGTH)\n"
+				"\t{\n");
+		}
+		else
+		{
+			fprintf(outfile,
+				"\twhile (length <= MAX_LENGTH && word_chars[word[length]])\n"
+				"\t\tlength++;\n"
+				"\n"
+				"\tif (length >= MIN_LENGTH && length <= MAX_LENGTH)\n"
+				"\t{\n"
+				"\t\tkey = (length << 24) ^ (word[0] << 16) ^ (word[length >> 1] << 8) ^ word[length-1];\n");
+		}
+
+		fprintf(outfile,
+			"\t\tkey ^= displacement[(key * 0x9e3779b1) >> BUCKET_SHIFT];\n"
+			"\t\tindex = slot[(key * 0x85ebca6b) >> SLOT_SHIFT];\n"
+			"\n"
+			"\t\tif (%s_table[index].length == length && memcmp(%s_table[index].name,word,length) == 0)\n"
+			"\t\t{\n"
+			"\t\t\tresult = (int) index;\n"
+			"\t\t}\n"
+			"\t}\n"
+			"\n"
+			"\treturn result;\n"
+			"}\n",base_name,base_name);
+
+		fclose(outfile);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : main
+ * Desc : The entry point for the generator.
+ *--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+	int				result = 0;
+	int				count;
+	char			file_name[MAX_PATH_LENGTH];
+	const char*		list_file = NULL;
+	const char*		output_base = NULL;
+	const char*		include_dir = NULL;
+	const char*		prefix = "";
+	const char*		base_name;
+	unsigned int	slot_bits;
+	unsigned int	bucket_bits = 0;
+	static KEYWORD_SET	set;
+
+	for (count=1; count < argc; count++)
+	{
+		if (strcmp(argv[count],"-h") == 0 && count + 1 < argc)
+			include_dir = argv[++count];
+
+		else if (strcmp(argv[count],"-p") == 0 && count + 1 < argc)
+			prefix = argv[++count];
+
+		else if (list_file == NULL)
+			list_file = argv[count];
+
+		else
+			output_base = argv[count];
+	}
+
+	if (list_file == NULL || output_base == NULL)
+	{
+		fprintf(stderr,"usage: keyword_hash <list_file> <output_base> -h <include_dir> -p <prefix>\n");
+		result = 1;
+	}
+	else if ((result = read_keywords(list_file,&set)) == 0)
+	{
+		make_keys(&set);
+
+		/* the slot table is the smallest power of two that holds the keywords */
+		for (slot_bits=1; (1U << slot_bits) < set.num_keywords; slot_bits++)
+			;
+
+		/* start with about two keywords a bucket and use more buckets if they cannot be placed */
+		for (; slot_bits <= MAX_TABLE_BITS; slot_bits++)
+		{
+			for (bucket_bits=(slot_bits > 1) ? slot_bits - 1 : 1; bucket_bits <= slot_bits; bucket_bits++)
+			{
+				if (place_keywords(&set,bucket_bits,slot_bits) == 0)
+					break;
+			}
+
+			if (bucket_bits <= slot_bits)
+				break;
+		}
+
+		if (slot_bits > MAX_TABLE_BITS)
+		{
+			fprintf(stderr,"keyword_hash: failed to find a perfect hash for %s\n",list_file);
+			result = 1;
+		}
+		else
+		{
+			if ((base_name = strrchr(output_base,'/')) == NULL)
+				base_name = output_base;
+			else
+				base_name++;
+
+			if (include_dir == NULL)
+			{
+				sprintf(file_name,"%.1000s.h",output_base);
+			}
+			else
+			{
+				sprintf(file_name,"%.500s%s%.500s.h",include_dir,(include_dir[strlen(include_dir)-1] == '/') ? "" : "/",base_name);
+			}
+
+			result = write_header(file_name,base_name,prefix,&set);
+
+			if (result == 0)
+			{
+				sprintf(file_name,"%.1000s.c",output_base);
+				result = write_source(file_name,base_name,&set);
+			}
+		}
+	}
+
+	return result;
+}
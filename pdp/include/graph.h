@@ -18,6 +18,19 @@
 
 /*#include "document_generator.h"*/
 
+/*--------------------------------------------------------------------------------*
+ * graph layout.
+ *
+ * The direct layout calculates the repulsion between every pair of nodes. The
+ * grid layout bins the nodes into a grid of about 3 * sqrt(nodes) cells, the
+ * nodes in the neighbouring cells repel each other directly and the other cells
+ * repel as a single node. Both layouts stop after max_iterations.
+ *--------------------------------------------------------------------------------*/
+#define GRAPH_LAYOUT_DIRECT				((unsigned int) 0)
+#define GRAPH_LAYOUT_GRID				((unsigned int) 1)
+
+#define GRAPH_DEFAULT_MAX_ITERATIONS	(10000)
+
 /*--------------------------------------------------------------------------------*
  * graph structures.
  *--------------------------------------------------------------------------------*/
@@ -52,6 +65,7 @@ typedef	struct tag_graph_node
 	struct tag_graph_node*	list_y;
 	struct tag_graph_node*	next;
 	struct tag_graph_node*	list_next;
+	struct tag_graph_node*	cell_next;
 } GRAPH_NODE;
 
 struct tag_graph_vertex
@@ -73,6 +87,15 @@ typedef struct
 	GRAPH_NODE*		start_x;
 	GRAPH_NODE*		start_y;
 
+	/* layout settings */
+	unsigned int	layout;
+	unsigned int	max_iterations;
+
+	/* layout stats */
+	unsigned int	iterations;
+	unsigned int	converged;
+	float			energy;
+
 } GRAPH;
 
 /*--------------------------------------------------------------------------------*
@@ -81,7 +104,9 @@ typedef struct
 void			graph_initialise(GRAPH* graph);
 void			graph_add_vertex(GRAPH* graph, GRAPH_NODE* from, GRAPH_NODE* to, void* item);
 GRAPH_NODE*		graph_create_node(GRAPH* graph, void* item);
+void			graph_set_layout(GRAPH* graph, unsigned int layout, unsigned int max_iterations);
 void			graph_force_directed(GRAPH* graph);
+void			graph_layout_stats(void);
 void			graph_dump(GRAPH* graph);
 GRAPH_NODE*		graph_get_start_node(GRAPH* graph, unsigned int* x, unsigned int* y, void** item);
 GRAPH_NODE*		graph_get_next_node(GRAPH_NODE* node, unsigned int* x, unsigned int* y, void** item);
@@ -94,9 +94,15 @@ typedef struct
 
 #define OUTPUT_APPLICATION_MULTIPLE			((unsigned int) (0x80000000))
 
+/*--------------------------------------------------------------------------------*
+ * The function that loads a group of the model when it is first used.
+ *--------------------------------------------------------------------------------*/
+typedef unsigned int (*OUTPUT_GROUP_LOADER)(GROUP* group);
+
 /*--------------------------------------------------------------------------------*
  * Function prototypes for the global functions
  *--------------------------------------------------------------------------------*/
+void			output_set_group_loader(OUTPUT_GROUP_LOADER loader);
 void			output_initialise(char* resource_path, int resource_path_length);
 unsigned int	output_open(DRAW_STATE* draw_state, INPUT_STATE* input_state, char* input_file_name, unsigned char* path, unsigned int path_length);
 unsigned int	output_parse_model(DRAW_STATE* draw_state, INPUT_STATE* input_state, GROUP* group_tree, NAME* model);
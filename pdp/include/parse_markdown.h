@@ -16,8 +16,72 @@
 #ifndef __PARSE_MARKDOWN_H__
 #define __PARSE_MARKDOWN_H__
 
+/*--------------------------------------------------------------------------------*
+ * Render event types.
+ *
+ * A markdown file is parsed once into a list of render events. The events are
+ * then replayed against the index and each of the output formats. The first set
+ * are calls to the output format, the second set are the changes that the parser
+ * makes to the draw and input states.
+ *--------------------------------------------------------------------------------*/
+typedef enum
+{
+	MARKDOWN_EVENT_HEADER,
+	MARKDOWN_EVENT_FOOTER,
+	MARKDOWN_EVENT_RAW,
+	MARKDOWN_EVENT_MARKER,
+	MARKDOWN_EVENT_TEXT,
+	MARKDOWN_EVENT_TABLE_START,
+	MARKDOWN_EVENT_TABLE_HEADER,
+	MARKDOWN_EVENT_TABLE_ROW,
+	MARKDOWN_EVENT_TABLE_END,
+	MARKDOWN_EVENT_LIST_ITEM_START,
+	MARKDOWN_EVENT_LIST_NUMERIC_START,
+	MARKDOWN_EVENT_LIST_END,
+
+	MARKDOWN_EVENT_INPUT_STATE,
+	MARKDOWN_EVENT_TITLE,
+	MARKDOWN_EVENT_NO_SPACE,
+	MARKDOWN_EVENT_MARGIN,
+	MARKDOWN_EVENT_HEADER_NUMBERS,
+	MARKDOWN_EVENT_MODEL
+
+} MARKDOWN_EVENT_TYPE;
+
+#define MARKDOWN_EVENT_BLOCK_SIZE	(256)
+
+typedef struct
+{
+	unsigned int	type;
+	unsigned int	value;			/* marker, text style, level, input state, margin change or line number */
+	unsigned int	extra;			/* the list marker */
+	NAME			text;			/* text, title or model reference - points into the document buffer */
+	void*			data;			/* the table layout or the table row names */
+
+} MARKDOWN_EVENT;
+
+typedef struct tag_markdown_event_block
+{
+	unsigned int						num_events;
+	MARKDOWN_EVENT						event[MARKDOWN_EVENT_BLOCK_SIZE];
+	struct tag_markdown_event_block*	next;
+
+} MARKDOWN_EVENT_BLOCK;
+
+typedef struct
+{
+	unsigned char*			buffer;			/* the loaded file - the events point into this */
+	unsigned int			num_events;
+	MARKDOWN_EVENT_BLOCK*	first;
+	MARKDOWN_EVENT_BLOCK*	last;
+
+} MARKDOWN_DOCUMENT;
+
 unsigned int	markdown_parse_input(DRAW_STATE* draw_state,INPUT_STATE* input_state);
 unsigned int	markdown_parse_buffer(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsigned char* buffer, unsigned int buffer_size, unsigned int in_block);
+unsigned int	markdown_load_document(DRAW_STATE* draw_state, INPUT_STATE* input_state, MARKDOWN_DOCUMENT** document);
+unsigned int	markdown_replay_document(DRAW_STATE* draw_state, INPUT_STATE* input_state, MARKDOWN_DOCUMENT* document);
+void			markdown_document_levels(LEVEL_INDEX* index, MARKDOWN_DOCUMENT* document);
+void			markdown_release_document(MARKDOWN_DOCUMENT* document);
 
 #endif
-
@@ -22,7 +22,7 @@
  *              leaves the original text in an almost readable state. The syntax
  *              marking does not stand out too much in the text.
  *
- * @synopsis	all		-v, -i ,-o,-?, files
+ * @synopsis	all		-v, -i ,-o, -j, -?, files
  *
  * @section		Error Reporting
  * 				Please report any problems to https://github.com/PAntoine/docgen
@@ -42,22 +42,51 @@
 #include <strings.h>
 #include <limits.h>
 #include "atoms.h"
+#include "graph.h"
 #include "output.h"
 #include "utilities.h"
 #include "error_codes.h"
+#include "work_pool.h"
 #include "lookup_tables.h"
 #include "output_format.h"
+#include "file_functions.h"
+#include "object_record.h"
+#include "string_pool.h"
 #include "parse_markdown.h"
 #include "indexing_format.h"
 #include "document_generator.h"
 
-extern char* g_input_filename;
+extern THREAD_LOCAL char* g_input_filename;
 
 extern unsigned char	is_valid_char[];
 
 static unsigned char	default_config_dir[] = ".doc_gen";
 static unsigned int		default_config_dir_len = sizeof(default_config_dir) - 1;
 
+/*--------------------------------------------------------------------------------*
+ * The layout of the records in the model file. The version 1 records are in
+ * blocks that follow the header. The version 2 sections are not blocked, so
+ * they are read as if the whole file is one block, and the string records have
+ * a varint length.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int	first_block;
+	unsigned int	block_size;
+	unsigned int	wide_strings;
+
+} MODEL_BLOCKS;
+
+/*--------------------------------------------------------------------------------*
+ * the model that the groups are loaded from when they are first used.
+ *--------------------------------------------------------------------------------*/
+static char*				g_model_file = NULL;
+static FILE_MAP*			g_model_map = NULL;
+static GROUP*				g_model_tree = NULL;
+static MODEL_BLOCKS			g_model_blocks = {LINKER_HEADER_SIZE,FILE_BLOCK_SIZE,0};
+static unsigned int			g_toc_groups = 0;
+static unsigned int			g_loaded_groups = 0;
+
 /*--------------------------------------------------------------------------------*
  * dummy format for handling indexing the input files.
  *--------------------------------------------------------------------------------*/
@@ -122,17 +151,42 @@ static unsigned int	read_numerics_record(unsigned int offset, unsigned char* buf
 	return (offset + 3 + 4);
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : read_long
+ * Desc : This function will read a four byte number.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	read_long(unsigned char* buffer)
+{
+	return	(((unsigned int)buffer[0]) << 24) | 
+			(((unsigned int)buffer[1]) << 16) | 
+			(((unsigned int)buffer[2]) << 8)  | 
+			buffer[3];
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : read_string_record
- * Desc : This function will read a string record.
+ * Desc : This function will read a string record. The wide records have the
+ *        length as a varint.
  *--------------------------------------------------------------------------------*/
-static unsigned int	read_string_record(unsigned int offset, unsigned char* buffer, NAME* name)
+static unsigned int	read_string_record(unsigned int offset, unsigned char* buffer, NAME* name, MODEL_BLOCKS* blocks)
 {
-	name->fixed			= buffer[offset+1];
-	name->name_length	= (((unsigned short)buffer[offset+2]) << 8) | buffer[offset+3];
-	name->name = &buffer[offset+4];
+	unsigned int	header_size = 2;
+
+	name->fixed = buffer[offset+1];
 
-	return (offset + 4 + name->name_length);
+	if (blocks->wide_strings)
+	{
+		header_size += object_record_decode_varint(&buffer[offset+2],OBJECT_VARINT_MAX_SIZE,&name->name_length);
+	}
+	else
+	{
+		name->name_length = (((unsigned short)buffer[offset+2]) << 8) | buffer[offset+3];
+		header_size += 2;
+	}
+
+	name->name = &buffer[offset+header_size];
+
+	return (offset + header_size + name->name_length);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -381,7 +435,7 @@ static	void	add_trigger(STATE_TRANSITION* transition,GROUP* group, NAME* trigger
 	transition->trigger = calloc(1,sizeof(TRIGGER));
 	transition->trigger->group = group;
 	transition->trigger->name_length = trigger_name->name_length;
-	memcpy(transition->trigger->name,trigger_name->name,trigger_name->name_length);
+	transition->trigger->name = string_pool_add(trigger_name->name,trigger_name->name_length);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -393,13 +447,13 @@ static void	add_triggers(STATE_TRANSITION* transition,GROUP* group, NAME* trigge
 {
 	TRIGGERS*	new_triggers;
 
-	new_triggers = malloc(sizeof(TRIGGERS));
+	new_triggers = calloc(1,sizeof(TRIGGERS));
 	new_triggers->trigger = calloc(1,sizeof(TRIGGER));
 	
 	/* set the value of the trigger */
 	new_triggers->trigger->group = group;
 	new_triggers->trigger->name_length = trigger_name->name_length;
-	memcpy(new_triggers->trigger->name,trigger_name->name,trigger_name->name_length);
+	new_triggers->trigger->name = string_pool_add(trigger_name->name,trigger_name->name_length);
 
 	if (transition->triggers == NULL)
 	{
@@ -426,7 +480,7 @@ static void	add_message(NODE* sender, TIMELINE* destination, BLOCK_NAME* name)
 	}
 
 	/* set the values in new message */
-	memcpy(new_message->name,name->name,name->name_length);
+	new_message->name = string_pool_add(name->name,name->name_length);
 	new_message->sender = sender;
 	new_message->name_length = name->name_length;
 	new_message->target_timeline = destination;
@@ -467,7 +521,7 @@ static MESSAGE*	create_message(unsigned short sender_id, unsigned short receiver
 {
 	MESSAGE* result = calloc(1,sizeof(MESSAGE));
 
-	memcpy(result->name,message_name->name,message_name->name_length);
+	result->name = string_pool_add(message_name->name,message_name->name_length);
 	result->name_length = message_name->name_length;
 	result->receiver = (NODE*) ((unsigned long)receiver_id);
 	result->sender = (NODE*) ((unsigned long)sender_id);
@@ -484,8 +538,8 @@ static API_CONSTANTS*	add_api_constants(GROUP* group, NAME* name, NAME* descript
 	API_CONSTANTS* result = calloc(1,sizeof(API_CONSTANTS));
 	API_CONSTANTS* current_constants;
 
-	copy_name(name,&result->name);
-	copy_name(description,&result->description);
+	reference_name(name,&result->name);
+	reference_name(description,&result->description);
 
 	if (group->api == NULL)
 	{
@@ -523,13 +577,13 @@ static API_CONSTANTS*	add_api_constants(GROUP* group, NAME* name, NAME* descript
  *--------------------------------------------------------------------------------*/
 static void	add_api_constant(API_CONSTANTS* api_constants, NAME* name, NAME* type, NAME* value, NAME* brief)
 {
-	API_CONSTANT*	new_constant = malloc(sizeof(API_CONSTANT));
+	API_CONSTANT*	new_constant = calloc(1,sizeof(API_CONSTANT));
 
 	/* initialise the new constant */
-	copy_name(type,&new_constant->type);
-	copy_name(name,&new_constant->name);
-	copy_name(value,&new_constant->value);
-	copy_name(brief,&new_constant->brief);
+	reference_name(type,&new_constant->type);
+	reference_name(name,&new_constant->name);
+	reference_name(value,&new_constant->value);
+	reference_name(brief,&new_constant->brief);
 
 	if (api_constants->max_name_length < name->name_length)
 	{
@@ -563,8 +617,8 @@ static API_TYPE*	add_api_type(GROUP* group, NAME* name, NAME* description)
 	API_TYPE* result = calloc(1,sizeof(API_TYPE));
 	API_TYPE* current_type;
 
-	copy_name(name,&result->name);
-	copy_name(description,&result->description);
+	reference_name(name,&result->name);
+	reference_name(description,&result->description);
 
 	if (group->api == NULL)
 	{
@@ -606,13 +660,13 @@ static API_TYPE*	add_api_type(GROUP* group, NAME* name, NAME* description)
  *--------------------------------------------------------------------------------*/
 static void	add_api_type_record(API_TYPE* api_type, unsigned int record_type, NAME* name, NAME* type,  NAME* brief)
 {
-	API_TYPE_RECORD*	new_record = malloc(sizeof(API_TYPE_RECORD));
+	API_TYPE_RECORD*	new_record = calloc(1,sizeof(API_TYPE_RECORD));
 
 	/* initialise the new record */
 	new_record->record_type = record_type;
-	copy_name(type,&new_record->type_item);
-	copy_name(name,&new_record->name_value);
-	copy_name(brief,&new_record->brief);
+	reference_name(type,&new_record->type_item);
+	reference_name(name,&new_record->name_value);
+	reference_name(brief,&new_record->brief);
 
 	if (api_type->max_type_item_length < type->name_length)
 	{
@@ -671,13 +725,8 @@ static API_FUNCTION*	add_api_function(GROUP* group, NAME* type, NAME* name)
 	}
 
 	/* set the values of the new function */
-	result->name.name_length = name->name_length;
-	result->name.name = malloc(name->name_length);
-	memcpy(result->name.name,name->name,name->name_length);
-
-	result->return_type.name_length = type->name_length;
-	result->return_type.name = malloc(type->name_length);
-	memcpy(result->return_type.name,type->name,type->name_length);
+	reference_name(name,&result->name);
+	reference_name(type,&result->return_type);
 		
 	/* set the minimum name sizes */
 	result->max_param_name_length = 4;
@@ -706,9 +755,9 @@ static void	add_api_parameter(API_FUNCTION* function, NAME* type, NAME* name, NA
 	}
 
 	/* set up the parameter */
-	copy_name(type,&result->type);
-	copy_name(name,&result->name);
-	copy_name(brief,&result->brief);
+	reference_name(type,&result->type);
+	reference_name(name,&result->name);
+	reference_name(brief,&result->brief);
 
 	if (function->parameter_list == NULL)
 	{
@@ -742,8 +791,8 @@ static void	add_api_returns(API_FUNCTION* function, NAME* value, NAME* brief)
 	API_RETURNS*	current_returns;
 
 	/* set up the parameter */
-	copy_name(value,&result->value);
-	copy_name(brief,&result->brief);
+	reference_name(value,&result->value);
+	reference_name(brief,&result->brief);
 
 	if (function->max_return_value_length < result->value.name_length)
 	{
@@ -780,8 +829,8 @@ static void	add_sample(GROUP* group, NAME* name, NAME* payload)
 	SAMPLE* 	result = calloc(1,sizeof(SAMPLE));
 
 	/* set up the parameter */
-	copy_name(name,&result->name);
-	copy_name(payload,&result->sample);
+	reference_name(name,&result->name);
+	reference_name(payload,&result->sample);
 
 	if (group->sample_list == NULL)
 	{
@@ -822,7 +871,7 @@ static APPLICATION*	find_add_application(GROUP* group, NAME* name)
 		result = calloc(1,sizeof(APPLICATION));
 
 		/* set up the parameter */
-		copy_name(name,&result->name);
+		reference_name(name,&result->name);
 
 		if (group->application == NULL)
 		{
@@ -891,8 +940,8 @@ static SECTION*	add_app_section(APPLICATION* application,NAME* name, NAME* secti
 
 		if (result != NULL)
 		{
-			copy_name(name,&result->name);
-			copy_name(section_data,&result->section_data);
+			reference_name(name,&result->name);
+			reference_name(section_data,&result->section_data);
 		}
 	}
 
@@ -928,8 +977,8 @@ static void	add_app_sub_section(SECTION* section,NAME* name,NAME* section_data)
 
 		if (sub_section != NULL)
 		{
-			copy_name(name,&sub_section->name);
-			copy_name(section_data,&sub_section->section_data);
+			reference_name(name,&sub_section->name);
+			reference_name(section_data,&sub_section->section_data);
 		}
 	}
 }
@@ -967,9 +1016,9 @@ static void	add_app_option(APPLICATION* application,unsigned short option_flags,
 			}
 
 			new_option->flags = option_flags;
-			copy_name(name,&new_option->name);
-			copy_name(value,&new_option->value);
-			copy_name(description,&new_option->description);
+			reference_name(name,&new_option->name);
+			reference_name(value,&new_option->value);
+			reference_name(description,&new_option->description);
 		}
 	}
 }
@@ -1005,9 +1054,9 @@ static void	add_app_command(APPLICATION* application,NAME* name,NAME* parameters
 				application->max_command_length = name->name_length;
 			}
 
-			copy_name(name,&new_command->name);
-			copy_name(parameters,&new_command->parameters);
-			copy_name(description,&new_command->description);
+			reference_name(name,&new_command->name);
+			reference_name(parameters,&new_command->parameters);
+			reference_name(description,&new_command->description);
 		}
 	}
 }
@@ -1027,7 +1076,7 @@ static void	add_app_synopsis(APPLICATION* application,NAME* name,unsigned char*
 	unsigned int	index_item;
 	unsigned int	cur_index;
 
-	copy_name(name,&new_synopsis->name);
+	reference_name(name,&new_synopsis->name);
 	new_synopsis->list_length = index_length;
 	new_synopsis->list = malloc(sizeof(OPTION*)*index_length);
 	
@@ -1064,15 +1113,41 @@ static void	add_app_synopsis(APPLICATION* application,NAME* name,unsigned char*
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : input_model
- * Desc : This function will input the model.
+ * Name : input_group
+ * Desc : This function will find the named group, adding it if it is not in the
+ *        model. The root group is found by the empty name even once it has been
+ *        renamed "default".
+ *--------------------------------------------------------------------------------*/
+static GROUP*	input_group(GROUP* group_tree, NAME* name)
+{
+	unsigned int	special_group;
+	GROUP*			result = group_tree;
+
+	if (name->name_length > 0)
+	{
+		if ((result = find_group(group_tree,name->name,name->name_length,&special_group)) == NULL)
+		{
+			result = add_group(group_tree,name->name,name->name_length);
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : input_model_records
+ * Desc : This function will load the records in the model file between the start
+ *        and end offsets. The records do not cross blocks, so the load moves on
+ *        to the next block when it finds the end of the current one.
+ *
+ *        The model strings point into the map rather than being copied, so the
+ *        map must not be released until the model is no longer used.
  *--------------------------------------------------------------------------------*/
-static unsigned int	input_model(char* model_file, GROUP* group_tree,unsigned short *max_state, unsigned short* max_node)
+static unsigned int	input_model_records(char* model_file, FILE_MAP* model_map, GROUP* group_tree, MODEL_BLOCKS* blocks, unsigned int start, unsigned int end, unsigned short *max_state, unsigned short* max_node)
 {
-	int					infile;
-	unsigned int		all_groups;
 	unsigned int		state = MODEL_LOAD_UNKNOWN;
-	unsigned int		offset = 0;
+	unsigned int		block;
+	unsigned int		offset;
 	unsigned int		result = 0;
 	unsigned int		flags;
 	unsigned short		index_length;
@@ -1080,8 +1155,7 @@ static unsigned int	input_model(char* model_file, GROUP* group_tree,unsigned sho
 	unsigned short		option_flags;
 	unsigned char		sender_id = 0;
 	unsigned char		receiver_id = 0;
-	unsigned char		signature[4] = LINKED_SOURCE_MAGIC;
-	unsigned char		record[FILE_BLOCK_SIZE];
+	unsigned char*		record;
 	unsigned char*		index;
 	NAME				timeline;
 	NAME				group;
@@ -1103,407 +1177,547 @@ static unsigned int	input_model(char* model_file, GROUP* group_tree,unsigned sho
 	API_PARAMETER*		current_parameter;
 	STATE_TRANSITION*	current_transition;
 
-	if ((infile = open(model_file,READ_FILE_STATUS)) != -1)
+	/* find the block that the start is in */
+	block = start - ((start - blocks->first_block) % blocks->block_size);
+	offset = start - block;
+
+	while(result == 0 && block < end && (block + blocks->block_size) <= model_map->size)
 	{
-		if (read(infile,record,LINKER_HEADER_SIZE) == LINKER_HEADER_SIZE)
+		record = &model_map->data[block];
+
+		while(offset < blocks->block_size && (block + offset) < end && result == 0)
 		{
-			/* check to see if the file is the correct format */
-			if (record[0] == signature[0] &&
-				record[1] == signature[1] &&	
-				record[2] == signature[2] &&	
-				record[3] == signature[3])
+			if (state == MODEL_LOAD_UNKNOWN)
 			{
-				/* valid formatted file */
-				if (record[FILE_VERSION_MAJOR] > VERSION_MAJOR)
+				switch(record[offset])
 				{
-					raise_warning(0,EC_INPUT_FILE_BUILT_WITH_LATER_MAJOR_VERSION,(unsigned char*)model_file,NULL);
-				}
+					case LINKER_STATE_MACHINE_START:
+						state = MODEL_LOAD_STATE;
+						offset = read_string_record(offset,record,&name,blocks);
+						break;
+
+					case LINKER_SEQUENCE_START:
+						state = MODEL_LOAD_SEQUENCE;
+						offset = read_string_record(offset,record,&name,blocks);
+						break;
+
+					case LINKER_API_START:
+						state = MODEL_LOAD_API;
+						offset = read_string_record(offset,record,&name,blocks);
+						
+						/* init the holders */
+						current_type = NULL;
+						current_function = NULL;
+						current_constants = NULL;
+
+						/* get the group that the API belongs to */
+						current_group = input_group(group_tree,&name);
+						break;
 
-				/* now load the model */
-				while(result == 0 && read(infile,record,FILE_BLOCK_SIZE) == FILE_BLOCK_SIZE)
+					case LINKER_SAMPLE:
+						offset = read_pair_record(offset,record,&name,&brief);
+						add_sample(group_tree,&name,&brief);
+						break;
+					
+					case LINKER_APPLICATION_START:
+						state = MODEL_LOAD_APPLICATION;
+						offset = read_string_record(offset,record,&name,blocks);
+						current_application = find_add_application(group_tree,&name);
+
+						break;
+
+					case LINKER_BLOCK_END:
+						offset = blocks->block_size;
+						break;
+
+					default:
+						hex_dump(&record[offset],16);
+						raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
+						result = 1;
+						break;
+				}
+			}
+			else if (state == MODEL_LOAD_API)
+			{
+				switch(record[offset])
 				{
-					offset = 0;
+					case LINKER_API_FUNCTION:
+						offset = read_type_record(offset,record,&type,&name,&brief);
+						current_function = add_api_function(current_group,&type,&name);
+						break;
 
-					while(offset < FILE_BLOCK_SIZE && result == 0)
-					{
-						if (state == MODEL_LOAD_UNKNOWN)
+					case LINKER_API_ACTION:
+						offset = read_string_record(offset,record,&name,blocks);
+						if (current_function != NULL)
 						{
-							switch(record[offset])
-							{
-								case LINKER_STATE_MACHINE_START:
-									state = MODEL_LOAD_STATE;
-									offset = read_string_record(offset,record,&name);
-									break;
-
-								case LINKER_SEQUENCE_START:
-									state = MODEL_LOAD_SEQUENCE;
-									offset = read_string_record(offset,record,&name);
-									break;
-
-								case LINKER_API_START:
-									state = MODEL_LOAD_API;
-									offset = read_string_record(offset,record,&name);
-									
-									/* init the holders */
-									current_type = NULL;
-									current_function = NULL;
-									current_constants = NULL;
-
-									/* get the group that the API belongs to */
-									if ((current_group = find_group(group_tree,name.name,name.name_length,&all_groups)) == NULL)
-									{
-										current_group = add_group(group_tree,name.name,name.name_length);
-									}
-									break;
-
-								case LINKER_SAMPLE:
-									offset = read_pair_record(offset,record,&name,&brief);
-									add_sample(group_tree,&name,&brief);
-									break;
-								
-								case LINKER_APPLICATION_START:
-									state = MODEL_LOAD_APPLICATION;
-									offset = read_string_record(offset,record,&name);
-									current_application = find_add_application(group_tree,&name);
-
-									break;
-
-								case LINKER_BLOCK_END:
-									offset = FILE_BLOCK_SIZE;
-									break;
-
-								default:
-									hex_dump(&record[offset],16);
-									raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
-									result = 1;
-									break;
-							}
-						}
-						else if (state == MODEL_LOAD_API)
+							reference_name(&name,&current_function->action);
+						}					
+						else
 						{
-							switch(record[offset])
-							{
-								case LINKER_API_FUNCTION:
-									offset = read_type_record(offset,record,&type,&name,&brief);
-									current_function = add_api_function(current_group,&type,&name);
-									break;
-
-								case LINKER_API_ACTION:
-									offset = read_string_record(offset,record,&name);
-									if (current_function != NULL)
-									{
-										copy_name(&name,&current_function->action);
-									}					
-									else
-									{
-										raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
-										result = 1;
-									}
-								break;
-
-								case LINKER_API_DESCRIPTION:
-									offset = read_string_record(offset,record,&name);
-									if (current_function != NULL)
-									{
-										copy_name(&name,&current_function->description);
-									}					
-									else
-									{
-										raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
-										result = 1;
-									}
-								break;
+							raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
+							result = 1;
+						}
+					break;
 
-								case LINKER_API_PARAMETER:
-									offset = read_type_record(offset,record,&type,&name,&brief);
-									if (current_function != NULL)
-									{
-										add_api_parameter(current_function,&type,&name,&brief);
-									}
-									else
-									{
-										raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
-										result = 1;
-									}
-								break;
+					case LINKER_API_DESCRIPTION:
+						offset = read_string_record(offset,record,&name,blocks);
+						if (current_function != NULL)
+						{
+							reference_name(&name,&current_function->description);
+						}					
+						else
+						{
+							raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
+							result = 1;
+						}
+					break;
 
-								case LINKER_API_RETURNS:
-									offset = read_pair_record(offset,record,&name,&brief);	
-									if (current_function != NULL)
-									{
-										add_api_returns(current_function,&name,&brief);
-									}
-									else
-									{
-										raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
-										result = 1;
-									}
-								break;
-
-								case LINKER_API_FUNCTION_END:
-									current_function = NULL;
-									offset++;
-								break;
-
-								case LINKER_API_TYPE_START:
-									offset = read_pair_record(offset,record,&name,&description);
-									current_type = add_api_type(current_group,&name,&description);
-								break;
-								
-								case LINKER_API_TYPE_FIELD:
-									offset = read_type_record(offset,record,&type,&name,&brief);
-									add_api_type_record(current_type,LINKER_API_TYPE_FIELD,&name,&type,&brief);
-								break;
-								
-								case LINKER_API_TYPE_END:
-									current_type = NULL;
-									offset++;
-								break;
-
-								case LINKER_API_END:
-									state = MODEL_LOAD_UNKNOWN;
-									offset++;
-								break;
-
-								case LINKER_API_CONSTANTS_START:
-									offset = read_pair_record(offset,record,&name,&description);
-									current_constants = add_api_constants(current_group,&name,&description);
-								break;
-
-								case LINKER_API_CONSTANT:
-									offset = read_constant_record(offset,record,&type,&name,&value,&brief);
-									add_api_constant(current_constants,&name,&type,&value,&brief);
-								break;
-
-								case LINKER_API_CONSTANTS_END:
-									current_constants = NULL;
-									offset += 1;
-								break;
-
-								case LINKER_END:
-									current_state = NULL;
-									offset += 1;
-									break;
-
-								case LINKER_BLOCK_END:
-									offset = FILE_BLOCK_SIZE;
-									break;
-
-								default:
-									printf("api: %d\n",record[offset]);
-									hex_dump(&record[offset],16);
-									raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)model_file,NULL);
-									result = 1;
-							}
+					case LINKER_API_PARAMETER:
+						offset = read_type_record(offset,record,&type,&name,&brief);
+						if (current_function != NULL)
+						{
+							add_api_parameter(current_function,&type,&name,&brief);
 						}
-						else if (state == MODEL_LOAD_STATE)
+						else
 						{
-							switch(record[offset])
-							{
-								case LINKER_STATE_MACHINE_END:
-									state = MODEL_LOAD_UNKNOWN;
-									offset++;
-									break;
-
-								case LINKER_STATE:
-									offset = read_group_id_record(offset,record,&group,&name,&id);
-									
-									if ((current_group = find_group(group_tree,group.name,group.name_length,&all_groups)) == NULL)
-									{
-										current_group = add_group(group_tree,group.name,group.name_length);
-									}
-									
-									current_state = add_state(current_group,name.name,name.name_length,0,0);
-									current_state->tag_id = id;
-
-									current_transition = NULL;
-
-									if (id > *max_state)
-										*max_state = id;
-
-									break;
-								
-								case LINKER_TRANSITON:
-									/* add the transition to the current_state */
-									offset = read_numeric_record(offset,record,&id);
-									
-									current_transition = add_transition(current_state,id);
-									break;
-
-								case LINKER_TRIGGER:
-									/* add the trigger to the current transition */
-									offset = read_group_record(offset,record,&group,&name);
-									
-									if ((temp_group = find_group(group_tree,group.name,group.name_length,&all_groups)) == NULL)
-									{
-										temp_group = add_group(group_tree,group.name,group.name_length);
-									}
-		
-									add_trigger(current_transition,temp_group,&name);
-									
-									break;
-
-								case LINKER_TRIGGERS:
-									/* add the triggers to the list of triggers to the current state */
-									offset = read_group_record(offset,record,&group,&name);
-
-									if ((temp_group = find_group(group_tree,group.name,group.name_length,&all_groups)) == NULL)
-									{
-										temp_group = add_group(group_tree,group.name,group.name_length);
-									}
-	
-									add_triggers(current_transition,temp_group,&name);
-									break;
-
-								case LINKER_CONDITION:
-									/* add the condition to the current transition */
-									offset = read_string_record(offset,record,&name);
-									current_transition->condition = malloc(name.name_length);
-									current_transition->condition_length = name.name_length;
-									memcpy(current_transition->condition,name.name,name.name_length);
-									break;
-
-								case LINKER_END:
-									current_state = NULL;
-									offset += 1;
-									break;
-
-								case LINKER_BLOCK_END:
-									offset = FILE_BLOCK_SIZE;
-									break;
-
-								default:
-									hex_dump(&record[offset],16);
-									raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
-									result = 1;
-							}
+							raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
+							result = 1;
 						}
+					break;
 
-						else if (state == MODEL_LOAD_APPLICATION)
+					case LINKER_API_RETURNS:
+						offset = read_pair_record(offset,record,&name,&brief);	
+						if (current_function != NULL)
 						{
-							switch(record[offset])
-							{
-								case LINKER_APPLICATION_SECTION:
-									offset = read_pair_record(offset,record,&name,&description);
-									current_section = add_app_section(current_application,&name,&description);
-									break;
-
-								case LINKER_APPLICATION_SUB_SECTION:
-									offset = read_pair_record(offset,record,&name,&description);
-									add_app_sub_section(current_section,&name,&description);
-									break;
-
-								case LINKER_APPLICATION_OPTION:
-									offset = read_option_record(offset,record,&option_flags,&name,&value,&description);
-									add_app_option(current_application,option_flags,&name,&value,&description);
-									break;
-
-								case LINKER_APPLICATION_COMMAND:
-									offset = read_type_record(offset,record,&name,&value,&description);
-									add_app_command(current_application,&name,&value,&description);
-									break;
-
-								case LINKER_APPLICATION_SYNOPSIS:
-									offset = read_synopsis_record(offset,record,&index_length,&index,&name);
-									add_app_synopsis(current_application,&name,index,index_length);
-									break;
-
-								case LINKER_APPLICATION_END:
-									state = MODEL_LOAD_UNKNOWN;
-									offset++;
-								break;
-
-								case LINKER_BLOCK_END:
-									offset = FILE_BLOCK_SIZE;
-									break;
-
-								default:
-									hex_dump(&record[offset],16);
-									raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
-									result = 1;
-							}
+							add_api_returns(current_function,&name,&brief);
 						}
 						else
 						{
-							switch(record[offset])
-							{
-								case LINKER_SEQUENCE_END:
-									state = MODEL_LOAD_UNKNOWN;
-									offset++;
-									break;
-
-								case LINKER_TIMELINE:
-									offset = read_group_record(offset,record,&group,&name);
-									
-									if ((current_group = find_group(group_tree,group.name,group.name_length,&all_groups)) == NULL)
-									{
-										current_group = add_group(group_tree,group.name,group.name_length);
-									}
+							raise_warning(0,EC_ATOM_MUST_BE_DEFINED_WITHIN_A_FUNCTION,NULL,NULL);
+							result = 1;
+						}
+					break;
+
+					case LINKER_API_FUNCTION_END:
+						current_function = NULL;
+						offset++;
+					break;
+
+					case LINKER_API_TYPE_START:
+						offset = read_pair_record(offset,record,&name,&description);
+						current_type = add_api_type(current_group,&name,&description);
+					break;
+					
+					case LINKER_API_TYPE_FIELD:
+						offset = read_type_record(offset,record,&type,&name,&brief);
+						add_api_type_record(current_type,LINKER_API_TYPE_FIELD,&name,&type,&brief);
+					break;
+					
+					case LINKER_API_TYPE_END:
+						current_type = NULL;
+						offset++;
+					break;
+
+					case LINKER_API_END:
+						state = MODEL_LOAD_UNKNOWN;
+						offset++;
+					break;
+
+					case LINKER_API_CONSTANTS_START:
+						offset = read_pair_record(offset,record,&name,&description);
+						current_constants = add_api_constants(current_group,&name,&description);
+					break;
+
+					case LINKER_API_CONSTANT:
+						offset = read_constant_record(offset,record,&type,&name,&value,&brief);
+						add_api_constant(current_constants,&name,&type,&value,&brief);
+					break;
+
+					case LINKER_API_CONSTANTS_END:
+						current_constants = NULL;
+						offset += 1;
+					break;
+
+					case LINKER_END:
+						current_state = NULL;
+						offset += 1;
+						break;
+
+					case LINKER_BLOCK_END:
+						offset = blocks->block_size;
+						break;
+
+					default:
+						printf("api: %d\n",record[offset]);
+						hex_dump(&record[offset],16);
+						raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)model_file,NULL);
+						result = 1;
+				}
+			}
+			else if (state == MODEL_LOAD_STATE)
+			{
+				switch(record[offset])
+				{
+					case LINKER_STATE_MACHINE_END:
+						state = MODEL_LOAD_UNKNOWN;
+						offset++;
+						break;
+
+					case LINKER_STATE:
+						offset = read_group_id_record(offset,record,&group,&name,&id);
+						
+						current_group = input_group(group_tree,&group);
+						
+						current_state = add_state(current_group,name.name,name.name_length,0,0);
+						current_state->tag_id = id;
+
+						current_transition = NULL;
+
+						if (id > *max_state)
+							*max_state = id;
+
+						break;
+					
+					case LINKER_TRANSITON:
+						/* add the transition to the current_state */
+						offset = read_numeric_record(offset,record,&id);
+						
+						current_transition = add_transition(current_state,id);
+						break;
+
+					case LINKER_TRIGGER:
+						/* add the trigger to the current transition */
+						offset = read_group_record(offset,record,&group,&name);
+						
+						temp_group = input_group(group_tree,&group);
+		
+						add_trigger(current_transition,temp_group,&name);
+						
+						break;
 
-									current_timeline = add_timeline(current_group,name.name,name.name_length,0,0);
-									break;
+					case LINKER_TRIGGERS:
+						/* add the triggers to the list of triggers to the current state */
+						offset = read_group_record(offset,record,&group,&name);
+
+						temp_group = input_group(group_tree,&group);
 	
-								case LINKER_NODE_START:
-									offset = read_numerics_record(offset,record,&id,&flags);
-									
-									current_node = add_node(current_timeline,id,flags);
-
-									if (id > *max_node)
-										*max_node = id;
-									break;
-
-								case LINKER_SENT_MESSAGE:
-									offset = read_message_record(	offset,
-																	record,
-																	&sender_id,
-																	&receiver_id,
-																	&timeline,
-																	&name);
-
-									current_node->sent_message = create_message(sender_id,receiver_id,&name);
-									current_node->sent_message->sending_timeline = current_timeline;
-									current_node->sent_message->sender = current_node;
+						add_triggers(current_transition,temp_group,&name);
+						break;
+
+					case LINKER_CONDITION:
+						/* add the condition to the current transition */
+						offset = read_string_record(offset,record,&name,blocks);
+						current_transition->condition = name.name;
+						current_transition->condition_length = name.name_length;
+						break;
+
+					case LINKER_END:
+						current_state = NULL;
+						offset += 1;
+						break;
+
+					case LINKER_BLOCK_END:
+						offset = blocks->block_size;
+						break;
+
+					default:
+						hex_dump(&record[offset],16);
+						raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
+						result = 1;
+				}
+			}
+
+			else if (state == MODEL_LOAD_APPLICATION)
+			{
+				switch(record[offset])
+				{
+					case LINKER_APPLICATION_SECTION:
+						offset = read_pair_record(offset,record,&name,&description);
+						current_section = add_app_section(current_application,&name,&description);
+						break;
+
+					case LINKER_APPLICATION_SUB_SECTION:
+						offset = read_pair_record(offset,record,&name,&description);
+						add_app_sub_section(current_section,&name,&description);
+						break;
+
+					case LINKER_APPLICATION_OPTION:
+						offset = read_option_record(offset,record,&option_flags,&name,&value,&description);
+						add_app_option(current_application,option_flags,&name,&value,&description);
+						break;
+
+					case LINKER_APPLICATION_COMMAND:
+						offset = read_type_record(offset,record,&name,&value,&description);
+						add_app_command(current_application,&name,&value,&description);
+						break;
+
+					case LINKER_APPLICATION_SYNOPSIS:
+						offset = read_synopsis_record(offset,record,&index_length,&index,&name);
+						add_app_synopsis(current_application,&name,index,index_length);
+						break;
+
+					case LINKER_APPLICATION_END:
+						state = MODEL_LOAD_UNKNOWN;
+						offset++;
+					break;
+
+					case LINKER_BLOCK_END:
+						offset = blocks->block_size;
+						break;
+
+					default:
+						hex_dump(&record[offset],16);
+						raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
+						result = 1;
+				}
+			}
+			else
+			{
+				switch(record[offset])
+				{
+					case LINKER_SEQUENCE_END:
+						state = MODEL_LOAD_UNKNOWN;
+						offset++;
+						break;
+
+					case LINKER_TIMELINE:
+						offset = read_group_record(offset,record,&group,&name);
+						
+						current_group = input_group(group_tree,&group);
+
+						current_timeline = add_timeline(current_group,name.name,name.name_length,0,0);
+						break;
 	
-									if (current_timeline->group->max_message_length < name.name_length)
-									{
-										current_timeline->group->max_message_length = name.name_length;
-									}
+					case LINKER_NODE_START:
+						offset = read_numerics_record(offset,record,&id,&flags);
+						
+						current_node = add_node(current_timeline,id,flags);
+
+						if (id > *max_node)
+							*max_node = id;
+						break;
+
+					case LINKER_SENT_MESSAGE:
+						offset = read_message_record(	offset,
+														record,
+														&sender_id,
+														&receiver_id,
+														&timeline,
+														&name);
+
+						current_node->sent_message = create_message(sender_id,receiver_id,&name);
+						current_node->sent_message->sending_timeline = current_timeline;
+						current_node->sent_message->sender = current_node;
 	
-									break;
-
-								case LINKER_CONDITION:
-									offset = read_string_record(offset,record,&name);
-									current_node->condition = malloc(name.name_length);
-									current_node->condition_length = name.name_length;
-									memcpy(current_node->condition,name.name,name.name_length);
-									break;
-
-								case LINKER_NODE_END:
-									current_node = NULL;
-									offset++;
-									break;
-
-								case LINKER_BLOCK_END:
-									offset = FILE_BLOCK_SIZE;
-									break;
-
-								default:
-									hex_dump(&record[offset],16);
-									raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
-									result = 1;
-							}
+						if (current_timeline->group->max_message_length < name.name_length)
+						{
+							current_timeline->group->max_message_length = name.name_length;
 						}
-					}
+	
+						break;
+
+					case LINKER_CONDITION:
+						offset = read_string_record(offset,record,&name,blocks);
+						current_node->condition = name.name;
+						current_node->condition_length = name.name_length;
+						break;
+
+					case LINKER_NODE_END:
+						current_node = NULL;
+						offset++;
+						break;
+
+					case LINKER_BLOCK_END:
+						offset = blocks->block_size;
+						break;
+
+					default:
+						hex_dump(&record[offset],16);
+						raise_warning(0,EC_UNEXPECTED_ITEM_IN_STATE,(unsigned char*)model_file,NULL);
+						result = 1;
 				}
 			}
-			else
+		}
+
+		block += blocks->block_size;
+		offset = 0;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : input_model_toc
+ * Desc : This function will read the table of contents of a version 2 model. The
+ *        samples and applications are loaded, the groups are created with the
+ *        offsets of their sections so they can be loaded when they are first
+ *        used.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	input_model_toc(char* model_file, FILE_MAP* model_map, GROUP* group_tree, unsigned short *max_state, unsigned short* max_node)
+{
+	unsigned int	count;
+	unsigned int	start;
+	unsigned int	length;
+	unsigned int	toc_offset = 0;
+	unsigned int	num_entries = 0;
+	unsigned int	strings = 0;
+	unsigned int	strings_length = 0;
+	unsigned int	result = 0;
+	unsigned char*	entry;
+	NAME			name;
+	GROUP*			group;
+
+	/* the caller only checked the v1 header size */
+	if (model_map->size >= LINKER_V2_HEADER_SIZE)
+	{
+		toc_offset = read_long(&model_map->data[LINKER_V2_TOC_OFF]);
+		num_entries = read_long(&model_map->data[LINKER_V2_TOC_ENTRIES_OFF]);
+	}
+
+	if (model_map->size < LINKER_V2_HEADER_SIZE ||
+		read_long(&model_map->data[LINKER_V2_FILE_SIZE_OFF]) != model_map->size ||
+		toc_offset < LINKER_V2_HEADER_SIZE ||
+		toc_offset > model_map->size ||
+		num_entries > (model_map->size - toc_offset) / LINKER_TOC_ENTRY_SIZE)
+	{
+		raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)model_file,NULL);
+		result = 1;
+	}
+	else
+	{
+		/* check the sections are in the file and find the string table */
+		entry = &model_map->data[toc_offset];
+
+		for (count=0; count < num_entries && result == 0; count++)
+		{
+			start = read_long(&entry[LINKER_TOC_OFFSET]);
+			length = read_long(&entry[LINKER_TOC_LENGTH]);
+
+			if (start > model_map->size || length > model_map->size - start)
 			{
-				raise_warning(0,EC_INPUT_FILE_SIGNATURE_INCORRECT,(unsigned char*)model_file,NULL);
+				raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)model_file,NULL);
 				result = 1;
 			}
+			else if (entry[LINKER_TOC_TYPE] == LINKER_SECTION_STRINGS)
+			{
+				strings = start;
+				strings_length = length;
+			}
+
+			entry += LINKER_TOC_ENTRY_SIZE;
 		}
 
-		close(infile);
+		/* the sections are not blocked */
+		g_model_blocks.first_block = 0;
+		g_model_blocks.block_size = model_map->size;
+		g_model_blocks.wide_strings = 1;
+
+		entry = &model_map->data[toc_offset];
+
+		for (count=0; count < num_entries && result == 0; count++)
+		{
+			start = read_long(&entry[LINKER_TOC_OFFSET]);
+			length = read_long(&entry[LINKER_TOC_LENGTH]);
+
+			switch (entry[LINKER_TOC_TYPE])
+			{
+				case LINKER_SECTION_SAMPLES:
+				case LINKER_SECTION_APPLICATIONS:
+					result = input_model_records(model_file,model_map,group_tree,&g_model_blocks,start,start+length,max_state,max_node);
+					break;
+
+				case LINKER_SECTION_GROUP:
+					name.name = &model_map->data[strings + read_long(&entry[LINKER_TOC_NAME_OFFSET])];
+					name.name_length = entry[LINKER_TOC_NAME_LENGTH];
+					name.fixed = 0;
+					name.allocated_size = 0;
+
+					if (read_long(&entry[LINKER_TOC_NAME_OFFSET]) + name.name_length > strings_length)
+					{
+						raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)model_file,NULL);
+						result = 1;
+					}
+					else
+					{
+						group = input_group(group_tree,&name);
+
+						if (length > 0)
+						{
+							group->model_start = start;
+							group->model_end = start + length;
+							g_toc_groups++;
+						}
+					}
+					break;
+
+				default:
+					/* sections that are not known are skipped */
+					break;
+			}
+
+			entry += LINKER_TOC_ENTRY_SIZE;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : input_model
+ * Desc : This function will input the model.
+ *
+ *        The model file is mapped and the strings in the model point into the
+ *        map rather than being copied, so the map must not be released until
+ *        the model is no longer used. The strings are not allocated, so they
+ *        are safe to pass to free_name().
+ *
+ *        Both versions of the model file are read. If the model has a table of
+ *        contents only the samples and applications are loaded here, the groups
+ *        are loaded by model_load_group() when the document first uses them. A
+ *        version 1 model is loaded in full.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	input_model(char* model_file, FILE_MAP* model_map, GROUP* group_tree,unsigned short *max_state, unsigned short* max_node)
+{
+	unsigned int	result = 0;
+	unsigned char	signature[4] = LINKED_SOURCE_MAGIC;
+	unsigned char	signature_v2[4] = LINKED_SOURCE_V2_MAGIC;
+	unsigned char*	record;
+
+	if (map_input_file(model_file,model_map) == EC_OK)
+	{
+		record = model_map->data;
+
+		if (model_map->size >= LINKER_HEADER_SIZE)
+		{
+			/* check to see if the file is the correct format */
+			if (memcmp(record,signature,4) != 0 && memcmp(record,signature_v2,4) != 0)
+			{
+				raise_warning(0,EC_INPUT_FILE_SIGNATURE_INCORRECT,(unsigned char*)model_file,NULL);
+				result = 1;
+			}
+			else
+			{
+				/* valid formatted file */
+				if (record[FILE_VERSION_MAJOR] > VERSION_MAJOR)
+				{
+					raise_warning(0,EC_INPUT_FILE_BUILT_WITH_LATER_MAJOR_VERSION,(unsigned char*)model_file,NULL);
+				}
+
+				/* the groups are loaded from the map when they are used */
+				g_model_file = model_file;
+				g_model_map = model_map;
+				g_model_tree = group_tree;
+
+				if (memcmp(record,signature_v2,4) == 0)
+				{
+					result = input_model_toc(model_file,model_map,group_tree,max_state,max_node);
+				}
+				else
+				{
+					result = input_model_records(model_file,model_map,group_tree,&g_model_blocks,LINKER_HEADER_SIZE,model_map->size,max_state,max_node);
+				}
+			}
+		}
 	}
 	else
 	{
@@ -1514,121 +1728,143 @@ static unsigned int	input_model(char* model_file, GROUP* group_tree,unsigned sho
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : connect_model
- * Desc : This function will connect the loaded model. It will attach all the
- *        messages and state transitions to the target state/nodes.
+ * Name : connect_group
+ * Desc : This function will connect the loaded group. It will attach all the
+ *        messages and state transitions to the target state/nodes. The jump
+ *        tables must be big enough for the largest ids in the group.
  *--------------------------------------------------------------------------------*/
-static unsigned int	connect_model(GROUP* group_tree, unsigned short max_state, unsigned short max_node)
+static void	connect_group(GROUP* current, STATE** state_jump, NODE** node_jump)
 {
-	unsigned int		result = EC_OK;
 	unsigned short		count;
 	NODE*				current_node;
 	NODE*				function_start;
-	NODE**				node_jump;
-	GROUP*				current = group_tree;
 	STATE*				current_state;
-	STATE**				state_jump;
-	TRIGGERS* 			current_triggers;
 	TIMELINE*			current_timeline;
 	STATE_TRANSITION*	current_trans;
+	STATE_TRANSITION**	transition_link;
 
-	state_jump = malloc((1+max_state) * sizeof(STATE*));
-	node_jump = calloc(1,(1+max_node) * sizeof(NODE*));
-
-	/* ok, we have an open file */
-	while (current != NULL)
+	if (current->state_machine != NULL)
 	{
-		if (current->state_machine != NULL)
+		current_state = current->state_machine->state_list;
+
+		count = 0;
+
+		/* build state jump table */
+		while (current_state != NULL)
 		{
-			current_state = current->state_machine->state_list;
-	
-			count = 0;
+			/* nodes will be in id order */
+			state_jump[count++] = current_state;
 
-			/* build state jump table */
-			while (current_state != NULL)
-			{
-				/* nodes will be in id order */
-				state_jump[count++] = current_state;
+			current_state = current_state->next;
+		}
 
-				current_state = current_state->next;
-			}
+		current_state = current->state_machine->state_list;
+		
+		/* connect the states */
+		while (current_state != NULL)
+		{
+			transition_link = &current_state->transition_list;
 
-			current_state = current->state_machine->state_list;
-			
-			/* connect the states */
-			while (current_state != NULL)
+			if (current_state->name_length > 0)
 			{
-				current_trans = current_state->transition_list;
-
-				if (current_state->name_length > 0)
+				while(*transition_link != NULL)
 				{
-					while(current_trans != NULL)
+					current_trans = *transition_link;
+
+					if (((unsigned long)current_trans->next_state) < count)
 					{
 						current_trans->next_state = state_jump[((unsigned long)current_trans->next_state)];
-						current_trans = current_trans->next;
+						transition_link = &current_trans->next;
+					}
+					else
+					{
+						/* the linker did not output the target state, so drop it */
+						*transition_link = current_trans->next;
 					}
 				}
-				current_state = current_state->next;
 			}
+			current_state = current_state->next;
 		}
+	}
+	
+	if (current->sequence_diagram != NULL)
+	{
+		/* build the jump table first */
+		count = 1;
+		node_jump[0] = NULL;
 		
-		if (current->sequence_diagram != NULL)
+		current_timeline = current->sequence_diagram->timeline_list;
+		
+		while (current_timeline != NULL)
 		{
-			/* build the jump table first */
-			count = 1;
-			node_jump[0] = NULL;
-			
-			current_timeline = current->sequence_diagram->timeline_list;
-			
-			while (current_timeline != NULL)
-			{
-				current_node = current_timeline->node;
+			current_node = current_timeline->node;
 
-				while (current_node != NULL)
+			while (current_node != NULL)
+			{
+				if (current_node->flags & FLAG_FUNCTION)
 				{
-					if (current_node->flags & FLAG_FUNCTION)
-					{
-						function_start = current_node;
-					}
-					else if (current_node->flags & FLAG_FUNCTION_END)
-					{
-						function_start->function_end = current_node;
-						current_node->return_node = function_start;
-					}
-
-					node_jump[count] = current_node;
-					count++;
-
-					current_node = current_node->next;
+					function_start = current_node;
+				}
+				else if (current_node->flags & FLAG_FUNCTION_END)
+				{
+					function_start->function_end = current_node;
+					current_node->return_node = function_start;
 				}
 
-				current_timeline = current_timeline->next;
+				node_jump[count] = current_node;
+				count++;
+
+				current_node = current_node->next;
 			}
 
-			/* now join up the messages */
-			current_timeline = current->sequence_diagram->timeline_list;
+			current_timeline = current_timeline->next;
+		}
 
-			while (current_timeline != NULL)
-			{
-				current_node = current_timeline->node;
+		/* now join up the messages */
+		current_timeline = current->sequence_diagram->timeline_list;
 
-				while (current_node != NULL)
+		while (current_timeline != NULL)
+		{
+			current_node = current_timeline->node;
+
+			while (current_node != NULL)
+			{
+				if (current_node->sent_message != NULL)
 				{
-					if (current_node->sent_message != NULL)
+					if (node_jump[((unsigned long)current_node->sent_message->receiver)])
 					{
-						if (node_jump[((unsigned long)current_node->sent_message->receiver)])
-						{
-							node_jump[((unsigned long)current_node->sent_message->receiver)]->received_message = current_node->sent_message;
-							current_node->sent_message->target_timeline = node_jump[((unsigned long)current_node->sent_message->receiver)]->timeline;
-						}
-						current_node->sent_message->receiver = node_jump[((unsigned long)current_node->sent_message->receiver)];
+						node_jump[((unsigned long)current_node->sent_message->receiver)]->received_message = current_node->sent_message;
+						current_node->sent_message->target_timeline = node_jump[((unsigned long)current_node->sent_message->receiver)]->timeline;
 					}
-					current_node = current_node->next;
+					current_node->sent_message->receiver = node_jump[((unsigned long)current_node->sent_message->receiver)];
 				}
-
-				current_timeline = current_timeline->next;
+				current_node = current_node->next;
 			}
+
+			current_timeline = current_timeline->next;
 		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : connect_model
+ * Desc : This function will connect the loaded model. It will attach all the
+ *        messages and state transitions to the target state/nodes.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	connect_model(GROUP* group_tree, unsigned short max_state, unsigned short max_node)
+{
+	unsigned int		result = EC_OK;
+	NODE**				node_jump;
+	GROUP*				current = group_tree;
+	STATE**				state_jump;
+
+	state_jump = malloc((1+max_state) * sizeof(STATE*));
+	node_jump = calloc(1,(1+max_node) * sizeof(NODE*));
+
+	/* ok, we have an open file */
+	while (current != NULL)
+	{
+		connect_group(current,state_jump,node_jump);
 
 		current = current->next;
 	}
@@ -1639,11 +1875,53 @@ static unsigned int	connect_model(GROUP* group_tree, unsigned short max_state, u
 	return result;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_load_group
+ * Desc : This function will load and connect a group that was left in the model
+ *        file by input_model(). It does nothing if the group has been loaded.
+ *        The caller must hold the pool lock if the work pool is running.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	model_load_group(GROUP* group)
+{
+	unsigned int	start = group->model_start;
+	unsigned int	end = group->model_end;
+	unsigned int	result = EC_OK;
+	unsigned short	max_state = 0;
+	unsigned short	max_node = 0;
+	NODE**			node_jump;
+	STATE**			state_jump;
+
+	if (end != 0 && g_model_map != NULL)
+	{
+		/* mark it loaded first, so a failed load is only reported once */
+		group->model_start = 0;
+		group->model_end = 0;
+		g_loaded_groups++;
+
+		if (input_model_records(g_model_file,g_model_map,g_model_tree,&g_model_blocks,start,end,&max_state,&max_node) != 0)
+		{
+			result = EC_PROBLEM_WITH_INPUT_FILE;
+		}
+		else
+		{
+			state_jump = malloc((1+max_state) * sizeof(STATE*));
+			node_jump = calloc(1,(1+max_node) * sizeof(NODE*));
+			connect_group(group,state_jump,node_jump);
+
+			free(node_jump);
+			free(state_jump);
+		}
+	}
+
+	return result;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : process_input
- * Desc : This function will process the input.
+ * Desc : This function will process the input. The input has already been
+ *        parsed into the document, so this replays it to the current format.
  *--------------------------------------------------------------------------------*/
-static unsigned int	process_input(GROUP* group_tree, DRAW_STATE* draw_state, const char* file_name, char* resource_path, int resource_path_length,const char* output_directory,unsigned int output_length)
+static unsigned int	process_input(GROUP* group_tree, DRAW_STATE* draw_state, const char* file_name, MARKDOWN_DOCUMENT* document, char* resource_path, int resource_path_length,const char* output_directory,unsigned int output_length)
 {
 	unsigned int	pos = 0;
 	unsigned int	format_size = 0;
@@ -1662,19 +1940,28 @@ static unsigned int	process_input(GROUP* group_tree, DRAW_STATE* draw_state, con
 	draw_state->resources_path.name_length	= resource_path_length;
 
 	draw_state->model = group_tree;
+	draw_state->no_space = 0;
 				
 	level_index_set_level(&draw_state->index,0);
 	
-	if (draw_state->format == &index_format || (result = output_open(draw_state,&input_state,(char*)file_name,(unsigned char*)output_directory,output_length)) == EC_OK)
+	if (draw_state->format != &index_format)
+	{
+		/* the open sets the document name in the model */
+		work_pool_lock();
+		result = output_open(draw_state,&input_state,(char*)file_name,(unsigned char*)output_directory,output_length);
+		work_pool_unlock();
+	}
+
+	if (result == EC_OK)
 	{
 		if (draw_state->format == &index_format)
 		{
 			/* don't want to create a directory tree for the index - but do need to call the open */
-			get_filename(file_name,&chapter_name,&chapter_name_length);
+			get_filename(input_state.input_name,&chapter_name,&chapter_name_length);
 			result = draw_state->format->output_open(draw_state,&input_state,chapter_name,chapter_name_length);
 		}
 
-		result = markdown_parse_input(draw_state,&input_state);
+		result = markdown_replay_document(draw_state,&input_state,document);
 
 		output_close(draw_state,&input_state);
 	}
@@ -1682,6 +1969,160 @@ static unsigned int	process_input(GROUP* group_tree, DRAW_STATE* draw_state, con
 	return result;
 }
 
+/*--------------------------------------------------------------------------------*
+ * The state shared between the render jobs.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	GROUP*				group_tree;
+	DRAW_STATE*			draw_state;				/* the template for the job draw states */
+	OUTPUT_FORMAT**		format;
+	const char**		chapter_name;
+	MARKDOWN_DOCUMENT**	chapter_document;
+	LEVEL_INDEX*		chapter_index;			/* the index at the start of each chapter */
+	unsigned int		num_chapters;
+	char*				resource_path;
+	int					resource_path_length;
+	const char*			output_directory;
+	unsigned int		output_length;
+
+} RENDER_CONTEXT;
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : render_job
+ * Desc : This function renders one chapter in one format. Each job has its own
+ *        draw state and index, so the jobs can run at the same time.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	render_job(void* context, unsigned int job)
+{
+	unsigned int	result;
+	unsigned int	chapter;
+	DRAW_STATE		draw_state;
+	RENDER_CONTEXT*	render = context;
+
+	chapter = job % render->num_chapters;
+
+	memcpy(&draw_state,render->draw_state,sizeof(DRAW_STATE));
+	memset(&draw_state.sink,0,sizeof(OUTPUT_SINK));
+	memset(&draw_state.list_index,0,sizeof(LEVEL_INDEX));
+
+	draw_state.output_file		= -1;
+	draw_state.output_buffer	= NULL;
+	draw_state.format_state		= NULL;
+	draw_state.format			= render->format[job / render->num_chapters];
+	draw_state.chapter			= chapter + 1;
+
+	level_index_copy(&draw_state.index,&render->chapter_index[chapter]);
+
+	result = process_input(	render->group_tree,
+							&draw_state,
+							render->chapter_name[chapter],
+							render->chapter_document[chapter],
+							render->resource_path,
+							render->resource_path_length,
+							render->output_directory,
+							render->output_length);
+
+	level_index_release(&draw_state.index);
+	level_index_release(&draw_state.list_index);
+	output_sink_release(&draw_state);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : render_formats
+ * Desc : This function produces all the formats for all the chapters using a
+ *        pool of workers. The index at the start of each chapter is found from
+ *        the headers in the documents before it, so the chapters do not need 
+ *        to be produced in order.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	render_formats(	RENDER_CONTEXT*	render,
+									unsigned int	num_workers,
+									unsigned char*	format_list_string,
+									unsigned int	format_list_length,
+									int				argc,
+									const char*		argv[],
+									unsigned char*	param_mask,
+									MARKDOWN_DOCUMENT** documents,
+									int				verbose)
+{
+	unsigned int	count;
+	unsigned int	start;
+	unsigned int	format_pos = 0;
+	unsigned int	num_formats = 0;
+	unsigned int	result = EC_OK;
+	LEVEL_INDEX		index;
+
+	render->num_chapters		= 0;
+	render->format				= calloc(format_list_length + 1,sizeof(OUTPUT_FORMAT*));
+	render->chapter_name		= calloc(argc,sizeof(char*));
+	render->chapter_document	= calloc(argc,sizeof(MARKDOWN_DOCUMENT*));
+	render->chapter_index		= calloc(argc,sizeof(LEVEL_INDEX));
+
+	if (render->format == NULL || render->chapter_name == NULL || render->chapter_document == NULL || render->chapter_index == NULL)
+	{
+		result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+		raise_warning(0,result,NULL,NULL);
+	}
+	else
+	{
+		for (count=0;count<format_list_length+1;count++)
+		{
+			if (format_list_string[count] == '\0' || format_list_string[count] == ',')
+			{
+				if ((render->format[num_formats] = output_find_format(&format_list_string[format_pos],count - format_pos)) != NULL)
+				{
+					if (verbose)
+					{
+						printf("Producing format %s\n",render->format[num_formats]->name);
+					}
+
+					num_formats++;
+				}
+				format_pos = count+1;
+			}
+		}
+
+		/* work out the index at the start of each of the chapters */
+		memset(&index,0,sizeof(LEVEL_INDEX));
+		level_index_init(&index);
+
+		for (start=1; start < argc; start++)
+		{
+			if (param_mask[start] == 0)
+			{
+				render->chapter_name[render->num_chapters]		= argv[start];
+				render->chapter_document[render->num_chapters]	= documents[start];
+				level_index_copy(&render->chapter_index[render->num_chapters],&index);
+				render->num_chapters++;
+
+				level_index_set_level(&index,0);
+				markdown_document_levels(&index,documents[start]);
+			}
+		}
+
+		level_index_release(&index);
+
+		if (render->num_chapters > 0)
+		{
+			result = work_pool_run(num_workers,num_formats * render->num_chapters,render_job,render);
+		}
+
+		for (count=0; count < render->num_chapters; count++)
+		{
+			level_index_release(&render->chapter_index[count]);
+		}
+	}
+
+	free(render->format);
+	free(render->chapter_name);
+	free(render->chapter_document);
+	free(render->chapter_index);
+
+	return result;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : main
  *--------------------------------------------------------------------------------*/
@@ -1700,6 +2141,7 @@ int main(int argc, const char *argv[])
 	unsigned int	count = 0;
 	unsigned int	start = 1;
 	unsigned int	file_number = 0;
+	unsigned int	num_workers = 1;
 	unsigned int	result = EC_OK;
 	unsigned int	format_pos = 0;
 	unsigned int	special_group;
@@ -1712,10 +2154,15 @@ int main(int argc, const char *argv[])
 	unsigned char*	format_list_string = (unsigned char*) "text";
 	unsigned char*	param_mask;
 	GROUP			group_tree;
+	FILE_MAP		model_map = {NULL,0,0};
 	DRAW_STATE		draw_state;
+	INPUT_STATE		input_state;
+	RENDER_CONTEXT	render_context;
+	MARKDOWN_DOCUMENT**	documents = NULL;
 
 	memset(&group_tree,0,sizeof(GROUP));
 	memset(&draw_state,0,sizeof(DRAW_STATE));
+	draw_state.output_file = -1;
 
 	param_mask = calloc(argc,1);
 
@@ -1967,6 +2414,42 @@ int main(int argc, const char *argv[])
 						}
 						break;
 
+					/**-----------------------------------------------------------*
+					 * @option		-j
+					 * @value		<number of workers>
+					 * @required	no
+					 *
+					 * @description
+					 * This sets the number of workers that are used to produce
+					 * the output. Each format and each chapter within a format
+					 * is produced as a separate job. The default is one worker
+					 * which produces the output in order.
+					 *------------------------------------------------------------*/
+					case 'j':
+						if (argv[start][2] != '\0')
+						{
+							num_workers = atoi(&argv[start][2]);
+						}
+						else if (((start + 1) < argc) && argv[start+1][0] != '-')
+						{
+							param_mask[start] = 1;
+							start++;
+
+							num_workers = atoi(argv[start]);
+							param_mask[start] = 1;
+						}
+						else
+						{
+							error_string = "-j requires a number of workers\n";
+							failed = 1;
+						}
+
+						if (num_workers == 0 || num_workers > WORK_POOL_MAX_WORKERS)
+						{
+							error_string = "-j number of workers is out of range\n";
+							failed = 1;
+						}
+						break;
 
 					/**-----------------------------------------------------------*
 					 * @option		-?
@@ -2058,15 +2541,18 @@ int main(int argc, const char *argv[])
 		}
 
 		/* input the model to process */
-		if (failed == 0 && (result = input_model(input_name,&group_tree,&max_state,&max_node)) == EC_OK)
+		if (failed == 0 && (result = input_model(input_name,&model_map,&group_tree,&max_state,&max_node)) == EC_OK)
 		{
 			/* connect the model */
 			if ((result = connect_model(&group_tree,max_state,max_node)) == EC_OK)
 			{
 				GROUP* temp = find_group(&group_tree,(unsigned char*)"",0,&special_group);
 
+				/* the groups that are still in the model file are loaded when used */
+				output_set_group_loader(model_load_group);
+
 				/* name the default group "default" */
-				memcpy(temp->name,"default",7);
+				temp->name = string_pool_add((unsigned char*)"default",7);
 				temp->name_length = 7;
 
 				/**-----------------------------------------------------------*
@@ -2080,6 +2566,26 @@ int main(int argc, const char *argv[])
 				 * as the structure for producing the output.
 				 *------------------------------------------------------------*/
 
+				/* parse the documents once, the index and each of the formats replay them */
+				if ((documents = calloc(argc,sizeof(MARKDOWN_DOCUMENT*))) == NULL)
+				{
+					result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+					raise_warning(0,result,NULL,NULL);
+				}
+				else
+				{
+					for (start=1; start < argc; start++)
+					{
+						if (param_mask[start] == 0)
+						{
+							memset(&input_state,0,sizeof(input_state));
+							input_state.input_name = (unsigned char*) argv[start];
+
+							markdown_load_document(&draw_state,&input_state,&documents[start]);
+						}
+					}
+				}
+
 				/* build the index for documents passed in */
 				level_index_init(&draw_state.index);
 	
@@ -2090,7 +2596,7 @@ int main(int argc, const char *argv[])
 					printf("Building index for:\n");
 				}
 
-				for (start=1; start < argc; start++)
+				for (start=1; documents != NULL && start < argc; start++)
 				{
 					if (param_mask[start] == 0)
 					{
@@ -2098,14 +2604,25 @@ int main(int argc, const char *argv[])
 						{
 							printf("    %s\n",argv[start]);
 						}
-						result = process_input(&group_tree,&draw_state,argv[start],resource_path,resource_path_length,output_name,output_length);
+						result = process_input(&group_tree,&draw_state,argv[start],documents[start],resource_path,resource_path_length,output_name,output_length);
 					}
 				}
 
 				level_index_release(&draw_state.index);
 
 				/* now produce the documentation */
-				if (result == EC_OK)
+				if (result == EC_OK && num_workers > 1)
+				{
+					render_context.group_tree			= &group_tree;
+					render_context.draw_state			= &draw_state;
+					render_context.resource_path		= resource_path;
+					render_context.resource_path_length	= resource_path_length;
+					render_context.output_directory		= output_name;
+					render_context.output_length		= output_length;
+
+					result = render_formats(&render_context,num_workers,format_list_string,format_list_length,argc,argv,param_mask,documents,verbose);
+				}
+				else if (result == EC_OK)
 				{
 					format_pos = 0;
 	
@@ -2135,7 +2652,7 @@ int main(int argc, const char *argv[])
 										file_number++;
 										draw_state.chapter = file_number;
 
-										result = process_input(&group_tree,&draw_state,argv[start],resource_path,resource_path_length,output_name,output_length);
+										result = process_input(&group_tree,&draw_state,argv[start],documents[start],resource_path,resource_path_length,output_name,output_length);
 									}
 								}
 							}
@@ -2144,10 +2661,32 @@ int main(int argc, const char *argv[])
 					}
 
 					level_index_release(&draw_state.index);
+					output_sink_release(&draw_state);
+				}
+
+				if (documents != NULL)
+				{
+					for (start=1; start < argc; start++)
+					{
+						markdown_release_document(documents[start]);
+					}
+
+					free(documents);
+				}
+
+				if (verbose)
+				{
+					printf("%-16s toc: %4u loaded: %4u\n","model groups",g_toc_groups,g_loaded_groups);
+					model_symbol_stats();
+					string_pool_stats();
+					graph_layout_stats();
 				}
 			}
 		}
 
+		/* the model strings live in the map, so it goes last */
+		unmap_input_file(&model_map);
+
 		/* release the plugins */
 		output_release();
 	}
@@ -21,11 +21,67 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
+#include "error_codes.h"
 #include "document_generator.h" 		/* DEBUG --- remove */
 
 
 #define GRAPH_ENERGY_MINIMUM	(0.1)
 
+/*--------------------------------------------------------------------------------*
+ * layout stats.
+ *
+ * These are totals for all the graphs that have been laid out. The graphs are
+ * laid out under the work pool lock so they do not need locking here.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	g_graph_layouts = 0;
+static unsigned int	g_graph_nodes = 0;
+static unsigned int	g_graph_iterations = 0;
+static unsigned int	g_graph_not_converged = 0;
+
+/*--------------------------------------------------------------------------------*
+ * The grid that the nodes are binned into for the grid layout. Each cell keeps
+ * the nodes that are in it and the centre of their positions, so the cell can
+ * be used as a single heavy node by the nodes that are not next to it.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int	count;
+	float			sum_x;
+	float			sum_y;
+	GRAPH_NODE*		nodes;
+
+} GRAPH_GRID_CELL;
+
+typedef struct
+{
+	float				min_x;
+	float				min_y;
+	float				cell_size;
+	unsigned int		size;
+	unsigned int		width;
+	unsigned int		height;
+	GRAPH_GRID_CELL*	cell;
+
+} GRAPH_GRID;
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: grid_position
+ *  desc: This function returns the column (or row) of the grid that the given
+ *        position is in.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	grid_position(float position, float min, float cell_size, unsigned int limit)
+{
+	unsigned int result = (unsigned int)((position - min) / cell_size);
+
+	if (result >= limit)
+	{
+		result = limit - 1;
+	}
+
+	return result;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  *  name: graph_initialise
  *  desc: This function will initialise a graph.
@@ -36,6 +92,23 @@ void	graph_initialise(GRAPH* graph)
 	graph->number_vertex = 0;
 	graph->start_node = NULL;
 	graph->last_node = NULL;
+	graph->layout = GRAPH_LAYOUT_DIRECT;
+	graph->max_iterations = GRAPH_DEFAULT_MAX_ITERATIONS;
+	graph->iterations = 0;
+	graph->converged = 0;
+	graph->energy = 0;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: graph_set_layout
+ *  desc: This function will set the layout that is used for the graph and the
+ *        maximum number of iterations the layout can take. If max_iterations is
+ *        zero the default is used.
+ *--------------------------------------------------------------------------------*/
+void	graph_set_layout(GRAPH* graph, unsigned int layout, unsigned int max_iterations)
+{
+	graph->layout = layout;
+	graph->max_iterations = (max_iterations == 0) ? GRAPH_DEFAULT_MAX_ITERATIONS : max_iterations;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -132,11 +205,16 @@ static void	calculate_repulsion(GRAPH_POINT_FORCE* point_force, GRAPH_NODE* targ
 
 	/* square of the line distance between points (pythag) */
 	distance = (x_dist * x_dist) + (y_dist * y_dist); 
-	force_ratio = 1/distance;
 
-	/* counting the repulsion between two vertices */
-	point_force->x += x_dist * force_ratio;
-	point_force->y += y_dist * force_ratio;
+	/* nodes on top of each other have no direction to push in */
+	if (distance > 0)
+	{
+		force_ratio = 1/distance;
+
+		/* counting the repulsion between two vertices */
+		point_force->x += x_dist * force_ratio;
+		point_force->y += y_dist * force_ratio;
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -193,6 +271,13 @@ static void	randomise_nodes(GRAPH* graph)
 {
 	GRAPH_NODE*		current_node;
 	unsigned int	seed = 0xa9385323;
+	unsigned int	mask = 0x0f;
+
+	/* large graphs need a bigger area or too many of the nodes start together */
+	while (((mask + 1) * (mask + 1)) < (graph->number_nodes * 4) && mask < 0xffff)
+	{
+		mask = (mask << 1) | 1;
+	}
 
 	/* move the items */
 	current_node = graph->start_node;
@@ -200,9 +285,9 @@ static void	randomise_nodes(GRAPH* graph)
 	while (current_node != NULL)
 	{
 		seed = lfsr_32(seed);
-		current_node->x = (0x0f & seed)+10;
+		current_node->x = (mask & seed)+10;
 		seed = lfsr_32(seed);
-		current_node->y = (0x0f & seed)+30;
+		current_node->y = (mask & seed)+30;
 
 		current_node = current_node->list_next;
 	}
@@ -331,19 +416,209 @@ static void	graph_normalise(GRAPH* graph)
 	}
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: direct_repulsion
+ *  desc: This function calculates the repulsion on the node from every other node
+ *        in the graph.
+ *--------------------------------------------------------------------------------*/
+static void	direct_repulsion(GRAPH* graph, GRAPH_POINT_FORCE* point_force, GRAPH_NODE* current_node)
+{
+	GRAPH_NODE*	repulsion_node = graph->start_node;
+
+	while (repulsion_node != NULL)
+	{
+		/* only want other nodes */
+		if (repulsion_node != current_node)
+		{
+			calculate_repulsion(point_force,current_node,repulsion_node);
+		}
+
+		repulsion_node = repulsion_node->list_next;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: grid_create
+ *  desc: This function will allocate the grid for the graph. The grid has about
+ *        3 * sqrt(nodes) cells, this keeps the cost of the cells and the cost of
+ *        the nodes in the neighbouring cells about the same.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	grid_create(GRAPH* graph, GRAPH_GRID* grid)
+{
+	unsigned int	result = EC_FAILED;
+
+	grid->size = 1;
+
+	while ((grid->size * grid->size * grid->size * grid->size) < (graph->number_nodes * 9))
+	{
+		grid->size++;
+	}
+
+	if ((grid->cell = malloc(sizeof(GRAPH_GRID_CELL) * grid->size * grid->size)) != NULL)
+	{
+		result = EC_OK;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: grid_build
+ *  desc: This function will place the nodes into the grid cells. The cells are
+ *        square and sized so the longest side of the graph fits in the grid.
+ *--------------------------------------------------------------------------------*/
+static void	grid_build(GRAPH* graph, GRAPH_GRID* grid)
+{
+	unsigned int		count;
+	GRAPH_NODE*			node = graph->start_node;
+	GRAPH_GRID_CELL*	cell;
+	float				max_x = node->x;
+	float				max_y = node->y;
+
+	grid->min_x = node->x;
+	grid->min_y = node->y;
+
+	while (node != NULL)
+	{
+		if (node->x < grid->min_x) grid->min_x = node->x;
+		if (node->y < grid->min_y) grid->min_y = node->y;
+		if (node->x > max_x) max_x = node->x;
+		if (node->y > max_y) max_y = node->y;
+
+		node = node->list_next;
+	}
+
+	if ((max_x - grid->min_x) > (max_y - grid->min_y))
+		grid->cell_size = (max_x - grid->min_x) / grid->size;
+	else
+		grid->cell_size = (max_y - grid->min_y) / grid->size;
+
+	if (grid->cell_size <= 0)
+	{
+		grid->cell_size = 1;
+	}
+
+	grid->width  = grid_position(max_x,grid->min_x,grid->cell_size,grid->size) + 1;
+	grid->height = grid_position(max_y,grid->min_y,grid->cell_size,grid->size) + 1;
+
+	memset(grid->cell,0,sizeof(GRAPH_GRID_CELL) * grid->width * grid->height);
+
+	node = graph->start_node;
+
+	while (node != NULL)
+	{
+		cell = &grid->cell[	(grid_position(node->y,grid->min_y,grid->cell_size,grid->height) * grid->width) +
+							 grid_position(node->x,grid->min_x,grid->cell_size,grid->width)];
+
+		cell->count++;
+		cell->sum_x += node->x;
+		cell->sum_y += node->y;
+
+		node->cell_next = cell->nodes;
+		cell->nodes = node;
+
+		node = node->list_next;
+	}
+
+	/* the sums become the centre of the cell */
+	for (count=0; count < grid->width * grid->height; count++)
+	{
+		if (grid->cell[count].count > 0)
+		{
+			grid->cell[count].sum_x /= grid->cell[count].count;
+			grid->cell[count].sum_y /= grid->cell[count].count;
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: grid_repulsion
+ *  desc: This function calculates the repulsion on the node. The nodes in the
+ *        same or the neighbouring cells repel the node directly, the other cells
+ *        repel it as a single node at the centre of the cell with the weight of
+ *        all the nodes in it.
+ *--------------------------------------------------------------------------------*/
+static void	grid_repulsion(GRAPH_GRID* grid, GRAPH_POINT_FORCE* point_force, GRAPH_NODE* current_node)
+{
+	unsigned int		x;
+	unsigned int		y;
+	unsigned int		cell_x;
+	unsigned int		cell_y;
+	float				x_dist;
+	float				y_dist;
+	float				force_ratio;
+	GRAPH_NODE*			repulsion_node;
+	GRAPH_GRID_CELL*	cell;
+
+	cell_x = grid_position(current_node->x,grid->min_x,grid->cell_size,grid->width);
+	cell_y = grid_position(current_node->y,grid->min_y,grid->cell_size,grid->height);
+
+	for (y = 0; y < grid->height; y++)
+	{
+		for (x = 0; x < grid->width; x++)
+		{
+			cell = &grid->cell[(y * grid->width) + x];
+
+			if (cell->count == 0)
+			{
+				/* nothing to push */
+			}
+			else if (x + 1 >= cell_x && x <= cell_x + 1 && y + 1 >= cell_y && y <= cell_y + 1)
+			{
+				repulsion_node = cell->nodes;
+
+				while (repulsion_node != NULL)
+				{
+					if (repulsion_node != current_node)
+					{
+						calculate_repulsion(point_force,current_node,repulsion_node);
+					}
+
+					repulsion_node = repulsion_node->cell_next;
+				}
+			}
+			else
+			{
+				x_dist = current_node->x - cell->sum_x;
+				y_dist = current_node->y - cell->sum_y;
+
+				force_ratio = cell->count / ((x_dist * x_dist) + (y_dist * y_dist));
+
+				point_force->x += x_dist * force_ratio;
+				point_force->y += y_dist * force_ratio;
+			}
+		}
+	}
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  *  name: directed_graph_force
  *  desc: This function will calculate the virtual layout of the graph using a
  *        force directed algorithm.
+ *
+ *        The layout stops when the energy of the graph drops below the minimum
+ *        or the graph has used all its iterations, the graph records which one
+ *        it was so the caller can report it.
  *--------------------------------------------------------------------------------*/
 void	graph_force_directed(GRAPH* graph)
 {
 	GRAPH_NODE*			current_node;
-	GRAPH_NODE*			repulsion_node;
 	GRAPH_VERTEX*		current_vertex;
 	GRAPH_POINT_FORCE	point_force;
+	GRAPH_GRID			grid;
 	float				total_energy = 0;
 
+	graph->iterations = 0;
+	graph->converged = 0;
+
+	grid.cell = NULL;
+
+	if (graph->layout == GRAPH_LAYOUT_GRID && graph->start_node != NULL && grid_create(graph,&grid) != EC_OK)
+	{
+		/* fall back to the direct layout */
+		graph->layout = GRAPH_LAYOUT_DIRECT;
+	}
+
 	/* need to randomise the node locations as to try and avoid local minima */
 	randomise_nodes(graph);
 	
@@ -352,23 +627,24 @@ void	graph_force_directed(GRAPH* graph)
 		current_node = graph->start_node;
 		total_energy = 0;
 
+		if (grid.cell != NULL)
+		{
+			grid_build(graph,&grid);
+		}
+
 		while (current_node != NULL)
 		{
 			point_force.x = 0;
 			point_force.y = 0;
 
 			/* now calculate the repulsion */
-			repulsion_node = graph->start_node;
-
-			while (repulsion_node != NULL)
+			if (grid.cell != NULL)
 			{
-				/* only want other nodes */
-				if (repulsion_node != current_node)
-				{
-					calculate_repulsion(&point_force,current_node,repulsion_node);
-				}
-
-				repulsion_node = repulsion_node->list_next;
+				grid_repulsion(&grid,&point_force,current_node);
+			}
+			else
+			{
+				direct_repulsion(graph,&point_force,current_node);
 			}
 
 			/* now calculate the vertex (spring) forces */
@@ -395,11 +671,45 @@ void	graph_force_directed(GRAPH* graph)
 
 			current_node = current_node->list_next;
 		}
+
+		graph->iterations++;
 	} 
-	while (total_energy > GRAPH_ENERGY_MINIMUM);
-	
+	while (total_energy > GRAPH_ENERGY_MINIMUM && isfinite(total_energy) && graph->iterations < graph->max_iterations);
+
+	graph->energy = total_energy;
+	graph->converged = (total_energy <= GRAPH_ENERGY_MINIMUM);
+
+	g_graph_layouts++;
+	g_graph_nodes += graph->number_nodes;
+	g_graph_iterations += graph->iterations;
+
+	if (!graph->converged)
+	{
+		g_graph_not_converged++;
+	}
+
+	free(grid.cell);
+
 	/* normalise the graph for drawing */
-	graph_normalise(graph);
+	if (graph->start_node != NULL)
+	{
+		graph_normalise(graph);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ *  name: graph_layout_stats
+ *  desc: This function will print the totals for the graphs that have been laid
+ *        out.
+ *--------------------------------------------------------------------------------*/
+void	graph_layout_stats(void)
+{
+	printf("%-16s graphs: %7u nodes: %10u iterations: %6u not converged: %u\n",
+			"state graphs",
+			g_graph_layouts,
+			g_graph_nodes,
+			g_graph_iterations,
+			g_graph_not_converged);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -19,7 +19,9 @@
 #include "plugin.h"
 #include "output.h"
 #include "utilities.h"
+#include "string_pool.h"
 #include "error_codes.h"
+#include "work_pool.h"
 #include "output_format.h"
 #include "file_functions.h"
 #include "indexing_format.h"
@@ -85,6 +87,7 @@ static unsigned char	string_close_square[] = "]";
 static unsigned char	string_ctype[] = "API Types";
 static unsigned char	string_function[] = "API Functions";
 static unsigned char	string_constants[] = "API Constants";
+static unsigned char	string_grid[] = "grid";
 
 static NAME				name_to = {string_to,sizeof(string_to)-1,0,0};
 static NAME				name_from = {string_from,sizeof(string_from)-1,0,0};
@@ -132,6 +135,8 @@ unsigned char	cbreak_string[]		= "cbreak";
 unsigned char	reference_string[]	= "reference";
 unsigned char	number_string[]		= "number";
 unsigned char	number_style_string[] = "number_style";
+unsigned char	layout_string[]		= "layout";
+unsigned char	iterations_string[]	= "iterations";
 
 
 #define	LINE_SIZE			(sizeof(line_string) - 1)
@@ -148,6 +153,8 @@ unsigned char	number_style_string[] = "number_style";
 #define REFERENCE_SIZE		(sizeof(reference_string) - 1)
 #define NUMBER_SIZE			(sizeof(number_string) - 1)
 #define NUMBER_STYLE_SIZE	(sizeof(number_style_string) - 1)
+#define LAYOUT_SIZE			(sizeof(layout_string) - 1)
+#define ITERATIONS_SIZE		(sizeof(iterations_string) - 1)
 
 #define GENERIC_OUTPUT_FLAG_PAGED			((unsigned int)  1)
 #define GENERIC_OUTPUT_FLAG_MARGIN			((unsigned int)  2)
@@ -163,6 +170,8 @@ unsigned char	number_style_string[] = "number_style";
 #define GENERIC_OUTPUT_FLAG_FLAT			((unsigned int) 13)
 #define GENERIC_OUTPUT_FLAG_CBREAK			((unsigned int) 14)
 #define GENERIC_OUTPUT_FLAG_LEVELS			((unsigned int) 15)
+#define GENERIC_OUTPUT_FLAG_LAYOUT			((unsigned int) 16)
+#define GENERIC_OUTPUT_FLAG_ITERATIONS		((unsigned int) 17)
 
 static	OUTPUT_FLAG	generic_out_flags[] =
 {
@@ -179,13 +188,17 @@ static	OUTPUT_FLAG	generic_out_flags[] =
 	{levels_string,			GENERIC_OUTPUT_FLAG_LEVELS		,0,	LEVELS_SIZE,		OUTPUT_FLAG_TYPE_NUMBER},
 	{margin_string,			GENERIC_OUTPUT_FLAG_MARGIN		,0,	MARGIN_SIZE,		OUTPUT_FLAG_TYPE_NUMBER},
 	{format_string,			GENERIC_OUTPUT_FLAG_FORMAT		,0,	FORMAT_SIZE,		OUTPUT_FLAG_TYPE_STRING},
-	{number_style_string,	GENERIC_OUTPUT_FLAG_NUMBER_STYLE,0,	NUMBER_STYLE_SIZE,	OUTPUT_FLAG_TYPE_STRING}
+	{number_style_string,	GENERIC_OUTPUT_FLAG_NUMBER_STYLE,0,	NUMBER_STYLE_SIZE,	OUTPUT_FLAG_TYPE_STRING},
+	{layout_string,			GENERIC_OUTPUT_FLAG_LAYOUT		,0,	LAYOUT_SIZE,		OUTPUT_FLAG_TYPE_STRING},
+	{iterations_string,		GENERIC_OUTPUT_FLAG_ITERATIONS	,0,	ITERATIONS_SIZE,	OUTPUT_FLAG_TYPE_NUMBER}
 };
 
 #define	OUTPUT_FLAG_SIZE	((sizeof(generic_out_flags)/sizeof(generic_out_flags[0])))
 
 static	OUTPUT_FLAG_LIST	g_flag_list = {OUTPUT_FLAG_SIZE,generic_out_flags};
 
+static	OUTPUT_GROUP_LOADER	g_group_loader = NULL;
+
 static unsigned char	string_action[] = "Action";
 static unsigned char	string_cdescription[] = "Description";
 
@@ -418,6 +431,46 @@ void	output_initialise(char* resource_path, int resource_path_length)
 	}
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * name: output_set_group_loader
+ * desc: This function sets the function that loads a group of the model that
+ *       has not been loaded yet. The loader is called the first time that the
+ *       document uses the group.
+ *--------------------------------------------------------------------------------*/
+void	output_set_group_loader(OUTPUT_GROUP_LOADER loader)
+{
+	g_group_loader = loader;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * name: output_load_groups
+ * desc: This function will load the groups that the model reference needs. The
+ *       all group needs all of them.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	output_load_groups(GROUP* group_tree, GROUP* group, unsigned int special_group)
+{
+	unsigned int	result = EC_OK;
+	GROUP*			current = group_tree;
+
+	if (g_group_loader != NULL)
+	{
+		if (special_group == ALL_GROUP)
+		{
+			while (current != NULL && result == EC_OK)
+			{
+				result = g_group_loader(current);
+				current = current->next;
+			}
+		}
+		else if (special_group == NORMAL_GROUP)
+		{
+			result = g_group_loader(group);
+		}
+	}
+
+	return result;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * name: output_release
  * desc: This function will release the resources used by the output system.
@@ -521,6 +574,9 @@ void	output_close(DRAW_STATE* draw_state,INPUT_STATE* input_state)
 	if (draw_state->output_file != -1)
 	{
 		draw_state->format->output_close(draw_state,input_state);
+
+		/* formats should have closed via the sink, but make sure nothing is left buffered */
+		output_sink_close(draw_state);
 	}
 }
 
@@ -692,6 +748,19 @@ static void	output_set_flag(DRAW_STATE* draw_state, OUTPUT_FLAG_VALUE* flag_valu
 		{
 			case GENERIC_OUTPUT_FLAG_MARGIN:		draw_state->margin_width = flag_value->value.number;	break;
 			case GENERIC_OUTPUT_FLAG_LEVELS:		draw_state->number_level = flag_value->value.number;	break;
+			case GENERIC_OUTPUT_FLAG_ITERATIONS:	draw_state->graph_iterations = flag_value->value.number;	break;
+			case GENERIC_OUTPUT_FLAG_LAYOUT:
+				/* anything other than grid gets the direct layout */
+				if (flag_value->value.string.name_length == sizeof(string_grid) - 1 &&
+					memcmp(flag_value->value.string.name,string_grid,sizeof(string_grid) - 1) == 0)
+				{
+					draw_state->graph_layout = GRAPH_LAYOUT_GRID;
+				}
+				else
+				{
+					draw_state->graph_layout = GRAPH_LAYOUT_DIRECT;
+				}
+			break;
 			case GENERIC_OUTPUT_FLAG_FORMAT:
 			case GENERIC_OUTPUT_FLAG_NUMBER_STYLE:
 				flag_value->value.string.name			= flag_value->value.string.name;
@@ -724,6 +793,8 @@ static void	output_parse_flags(INPUT_STATE* input_state, DRAW_STATE* draw_state)
 	draw_state->format_flags = draw_state->global_format_flags;
 	draw_state->number_level = draw_state->global_number_level;
 	draw_state->max_constant_size = draw_state->global_max_constant;
+	draw_state->graph_layout = GRAPH_LAYOUT_DIRECT;
+	draw_state->graph_iterations = 0;
 
 	if (input_state->flags.name_length > 0)
 	{
@@ -818,6 +889,7 @@ static void	output_function_prototype(DRAW_STATE* draw_state, API_FUNCTION* func
 	API_PARAMETER*		current_parameter;
 
 	/* set the table row up */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 6;
 	table_layout.table_flags = OUTPUT_TABLE_FORMAT_PROTOTYPE;
 	table_layout.column_spacing = 1;
@@ -897,6 +969,7 @@ static void	output_function_parameters(DRAW_STATE* draw_state, API_FUNCTION* fun
 	API_PARAMETER*	current_parameter;
 
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 3;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column[0].flags = 0;
@@ -955,6 +1028,7 @@ static void	output_function_returns(DRAW_STATE* draw_state, API_FUNCTION* functi
 	draw_state->format->output_marker(draw_state,OUTPUT_MARKER_HEADER_END|OHL_LEVEL_3);
 
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 2;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column[0].flags = 0;
@@ -995,6 +1069,7 @@ static void	output_type_records(DRAW_STATE* draw_state, API_TYPE* type)
 	API_TYPE_RECORD*	current_record;
 
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 3;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column_spacing = 2;
@@ -1055,6 +1130,7 @@ static void	output_constant_records(DRAW_STATE* draw_state, API_CONSTANTS* const
 	}
 
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 3;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column[0].flags = OUTPUT_COLUMN_FORMAT_NO_TRUNCATE;
@@ -1141,6 +1217,7 @@ static void	output_application_option(DRAW_STATE* draw_state, APPLICATION* appli
 		draw_state->format->output_title(draw_state,OHL_LEVEL_2,&name_options,NULL);
 
 		/* now write the table */
+		memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 		table_layout.num_columns = 2;
 		table_layout.table_flags = 0;
 		table_layout.column[0].flags = OUTPUT_COLUMN_FORMAT_NO_TRUNCATE;
@@ -1194,6 +1271,7 @@ static void	output_application_command(DRAW_STATE* draw_state, APPLICATION* appl
 		draw_state->format->output_title(draw_state,OHL_LEVEL_2,&name_commands,NULL);
 
 		/* now write the table */
+		memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 		table_layout.num_columns = 2;
 		table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 		table_layout.column[0].flags = OUTPUT_COLUMN_FORMAT_NO_TRUNCATE;
@@ -2275,6 +2353,7 @@ static void	handle_state_machine_table(DRAW_STATE* draw_state, STATE_MACHINE* st
 
 	/* create the table layout */
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 4;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column_spacing = 2;
@@ -2472,7 +2551,11 @@ static void	handle_state_machine_graph(DRAW_STATE* draw_state, INPUT_STATE* inpu
 			while(current_trans != NULL)
 			{
 				/* is this transition one that we are interested in? */
-				if (((current_state->flags & FLAG_ACTIVE) == FLAG_ACTIVE) || ((current_trans->next_state->flags & FLAG_ACTIVE) == FLAG_ACTIVE))
+				if (current_trans->next_state->graph_node == NULL)
+				{
+					/* the next state is not in this graph (in another state machine) */
+				}
+				else if (((current_state->flags & FLAG_ACTIVE) == FLAG_ACTIVE) || ((current_trans->next_state->flags & FLAG_ACTIVE) == FLAG_ACTIVE))
 				{
 					graph_add_vertex(&graph,current_state->graph_node,current_trans->next_state->graph_node,current_trans);
 				}
@@ -2485,8 +2568,14 @@ static void	handle_state_machine_graph(DRAW_STATE* draw_state, INPUT_STATE* inpu
 	}
 	
 	/* layout the graph */
+	graph_set_layout(&graph,draw_state->graph_layout,draw_state->graph_iterations);
 	graph_force_directed(&graph);
 
+	if (!graph.converged)
+	{
+		raise_warning(input_state->line_number,EC_GRAPH_LAYOUT_DID_NOT_CONVERGE,NULL,NULL);
+	}
+
 	/* now dump the ordered graph 
 	 * Start by outputting the nodes and tagging them
 	 */
@@ -2522,8 +2611,15 @@ static void	handle_state_machine_graph(DRAW_STATE* draw_state, INPUT_STATE* inpu
 		node = graph_get_next_node(node,&x,&y,(void**)&current_state);
 	}
 	
-	/* release the graph */
+	/* release the graph, and forget the nodes as the next diagram may use these states */
 	graph_release(&graph);
+
+	current_state = state_machine->state_list;
+	while (current_state != NULL)
+	{
+		current_state->graph_node = NULL;
+		current_state = current_state->next;
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -2537,7 +2633,7 @@ static unsigned int	generate_state_machine(DRAW_STATE* draw_state, INPUT_STATE*
 	STATE*				current_state = NULL;
 	STATE_TRANSITION*	current_trans;
 
-	if (input_state->part_name.name_length > 0 && (current_state = find_state(group,input_state->part_name.name,input_state->part_name.name_length)) == NULL)
+	if (input_state->part_name.name_length > 0 && (current_state = find_state(group,string_pool_find(input_state->part_name.name,input_state->part_name.name_length))) == NULL)
 	{
 		raise_warning(input_state->line_number,EC_UNKNOWN_ITEM,input_state->input_name,NULL);
 	}
@@ -2772,6 +2868,7 @@ static void	generate_sequence_table(DRAW_STATE* draw_state, INPUT_STATE* input_s
 
 
 	/* ok. where do the columns start */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
 	table_layout.num_columns = 3;
 	table_layout.table_flags = (OUTPUT_TABLE_FORMAT_HEADER | OUTPUT_TABLE_FORMAT_BOXED | OUTPUT_TABLE_FORMAT_FULL_WIDTH);
 	table_layout.column_spacing = 2;
@@ -2945,7 +3042,7 @@ static unsigned int	generate_sequence_diagram( DRAW_STATE* draw_state, INPUT_STA
 
 	memset(&draw_state->data.sequence,0,sizeof(SEQUENCE_DRAW_STATE));
 
-	if (input_state->part_name.name_length > 0 && (current_timeline = find_timeline(group,input_state->part_name.name,input_state->part_name.name_length)) == NULL)
+	if (input_state->part_name.name_length > 0 && (current_timeline = find_timeline(group,string_pool_find(input_state->part_name.name,input_state->part_name.name_length))) == NULL)
 	{
 		raise_warning(input_state->line_number,EC_UNKNOWN_ITEM,input_state->input_name,NULL);
 	}
@@ -3141,10 +3238,23 @@ unsigned int	output_parse_model(DRAW_STATE* draw_state, INPUT_STATE* input_state
 		output_parse_flags(input_state,draw_state);
 
 		/* check for selected group - or walk the tree if required */
-		if ((group = find_group(group_tree,input_state->group_name.name,input_state->group_name.name_length,&special_group)) == NULL)
+		work_pool_lock();
+
+		if ((group = find_group(group_tree,input_state->group_name.name,input_state->group_name.name_length,&special_group)) != NULL)
+		{
+			result = output_load_groups(group_tree,group,special_group);
+		}
+
+		work_pool_unlock();
+
+		if (group == NULL)
 		{
 			raise_warning(input_state->line_number,EC_UNKNOWN_ITEM,input_state->input_name,NULL);
 		}
+		else if (result != EC_OK)
+		{
+			raise_warning(input_state->line_number,result,input_state->input_name,NULL);
+		}
 		else
 		{
 			if (special_group == DOCUMENT_GROUP)
@@ -3163,12 +3273,17 @@ unsigned int	output_parse_model(DRAW_STATE* draw_state, INPUT_STATE* input_state
 				/* action the found markers */
 				switch (input_state->state)
 				{
+					/* the diagrams tag and lay out the model, so only one at a time */
 					case TYPE_STATE_MACHINE:
+						work_pool_lock();
 						generate_state_machine(draw_state,input_state,group,special_group);
+						work_pool_unlock();
 						break;
 
 					case TYPE_SEQUENCE_DIAGRAM:
+						work_pool_lock();
 						generate_sequence_diagram(draw_state,input_state,group,special_group);
+						work_pool_unlock();
 						break;
 
 					case TYPE_API:
@@ -39,6 +39,7 @@
 #include "document_generator.h"
 
 #include <unistd.h>
+#include <stdlib.h>
 #include <malloc.h>
 #include <string.h>
 #include <sys/types.h>
@@ -73,6 +74,7 @@ typedef struct
 	unsigned int	space_count;	/* the number of spaces at the start of the line */
 	DRAW_STATE*		draw_state;		/* the draw state for the decode */
 	INPUT_STATE*	input_state;	/* the state of the input */
+	MARKDOWN_DOCUMENT*	document;	/* if set, the parse is being recorded into this document */
 
 } MARKDOWN_STATE;
 
@@ -203,21 +205,6 @@ static unsigned int	markdown_whitespace_level(MARKDOWN_STATE* state, unsigned in
 	return pos;
 }
 
-/*----- FUNCTION -----------------------------------------------------------------*
- *  name: markdown_unload_file
- *  desc: This function will unload the file. This function does not close the 
- *        file as it is not its responsibility, but will seek to start to leave
- *        the file in a nice state.
- *--------------------------------------------------------------------------------*/
-static void	markdown_unload_file(INPUT_STATE* input_state)
-{
-	if (input_state->buffer != NULL)
-	{
-		free(input_state->buffer);
-		input_state->buffer = NULL;
-	}
-}
-
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : markdown_skip_newline
  * Desc : This function will handle skipping the new lines.
@@ -262,6 +249,376 @@ static unsigned int	handle_newline(MARKDOWN_STATE* state, unsigned int buffer_po
 	return result;
 }
 
+/*--------------------------------------------------------------------------------*
+ * Render event recording.
+ *
+ * When a document is loaded the parser is run against the record format, this
+ * turns the output calls into events in the document. The changes that the
+ * parser makes directly to the draw and input states are recorded as events by
+ * the markdown_set_* functions so they can be replayed in the same order.
+ *--------------------------------------------------------------------------------*/
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_add_event
+ * Desc : This function will add an event to the end of the document.
+ *--------------------------------------------------------------------------------*/
+static MARKDOWN_EVENT*	markdown_add_event(MARKDOWN_DOCUMENT* document, unsigned int type)
+{
+	MARKDOWN_EVENT*			result = NULL;
+	MARKDOWN_EVENT_BLOCK*	block = document->last;
+
+	if (block == NULL || block->num_events == MARKDOWN_EVENT_BLOCK_SIZE)
+	{
+		if ((block = calloc(1,sizeof(MARKDOWN_EVENT_BLOCK))) == NULL)
+		{
+			raise_warning(0,EC_OUT_OF_MEMORY_OR_FILE_TO_BIG,NULL,NULL);
+		}
+		else
+		{
+			if (document->last == NULL)
+			{
+				document->first = block;
+			}
+			else
+			{
+				document->last->next = block;
+			}
+
+			document->last = block;
+		}
+	}
+
+	if (block != NULL)
+	{
+		result = &block->event[block->num_events++];
+		result->type = type;
+		document->num_events++;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_add_table_event
+ * Desc : This function adds a table event. The table functions are passed
+ *        structures that only live for the call so a copy is kept.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_add_table_event(DRAW_STATE* draw_state, unsigned int type, TABLE_LAYOUT* table_layout, TABLE_ROW* table_row)
+{
+	unsigned int	column;
+	NAME*			row;
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,type)) != NULL)
+	{
+		if (table_row != NULL)
+		{
+			if ((row = malloc(sizeof(NAME) * MAX_TABLE_SIZE)) != NULL)
+			{
+				for (column=0; column < MAX_TABLE_SIZE; column++)
+				{
+					row[column] = *table_row->row[column];
+				}
+			}
+
+			event->data = row;
+		}
+		else if (type == MARKDOWN_EVENT_TABLE_START)
+		{
+			if ((event->data = malloc(sizeof(TABLE_LAYOUT))) != NULL)
+			{
+				memcpy(event->data,table_layout,sizeof(TABLE_LAYOUT));
+			}
+		}
+	}
+}
+
+static void	record_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
+{
+	markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_HEADER);
+}
+
+static void	record_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
+{
+	markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_FOOTER);
+}
+
+static void	record_raw(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buffer_size)
+{
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_RAW)) != NULL)
+	{
+		event->text.name = buffer;
+		event->text.name_length = buffer_size;
+	}
+}
+
+static void	record_marker(DRAW_STATE* draw_state, unsigned int marker)
+{
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_MARKER)) != NULL)
+	{
+		event->value = marker;
+	}
+}
+
+static void	record_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* text)
+{
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_TEXT)) != NULL)
+	{
+		event->value = text_style;
+		event->text = *text;
+	}
+}
+
+static void	record_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
+{
+	markdown_add_table_event(draw_state,MARKDOWN_EVENT_TABLE_START,table_layout,NULL);
+}
+
+static void	record_table_header(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TABLE_ROW* table_row)
+{
+	markdown_add_table_event(draw_state,MARKDOWN_EVENT_TABLE_HEADER,table_layout,table_row);
+}
+
+static void	record_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TABLE_ROW* table_row)
+{
+	markdown_add_table_event(draw_state,MARKDOWN_EVENT_TABLE_ROW,table_layout,table_row);
+}
+
+static void	record_table_end(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
+{
+	markdown_add_table_event(draw_state,MARKDOWN_EVENT_TABLE_END,table_layout,NULL);
+}
+
+static void	record_list_item_start(DRAW_STATE* draw_state, unsigned int level, unsigned char marker)
+{
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_LIST_ITEM_START)) != NULL)
+	{
+		event->value = level;
+		event->extra = marker;
+	}
+}
+
+static void	record_list_numeric_start(DRAW_STATE* draw_state, unsigned int level)
+{
+	MARKDOWN_EVENT*	event;
+
+	if ((event = markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_LIST_NUMERIC_START)) != NULL)
+	{
+		event->value = level;
+	}
+}
+
+static void	record_list_end(DRAW_STATE* draw_state)
+{
+	markdown_add_event(draw_state->format_state,MARKDOWN_EVENT_LIST_END);
+}
+
+/*--------------------------------------------------------------------------------*
+ * pseudo-format that records the parser output into a document.
+ *--------------------------------------------------------------------------------*/
+static OUTPUT_FORMAT	record_format = 
+{
+	(unsigned char*)"record",
+	6,
+	NULL,
+	NULL,
+	NULL,
+	record_header,
+	record_footer,
+	record_raw,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	record_marker,
+	record_text,
+	NULL,
+	NULL,
+	NULL,
+	record_table_start,
+	record_table_header,
+	record_table_row,
+	record_table_end,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	record_list_item_start,
+	record_list_numeric_start,
+	record_list_end,
+	NULL
+};
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_set_input_state
+ * Desc : This function sets the type of the block being output.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_set_input_state(MARKDOWN_STATE* state, unsigned int input_type)
+{
+	MARKDOWN_EVENT*	event;
+
+	if (state->document == NULL)
+	{
+		state->input_state->state = input_type;
+	}
+	else if ((event = markdown_add_event(state->document,MARKDOWN_EVENT_INPUT_STATE)) != NULL)
+	{
+		event->value = input_type;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_set_title
+ * Desc : This function sets the title for the next item that is output.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_set_title(MARKDOWN_STATE* state, unsigned char* title, unsigned int title_length)
+{
+	MARKDOWN_EVENT*	event;
+
+	if (state->document == NULL)
+	{
+		state->input_state->title.name = title;
+		state->input_state->title.name_length = title_length;
+	}
+	else if ((event = markdown_add_event(state->document,MARKDOWN_EVENT_TITLE)) != NULL)
+	{
+		event->text.name = title;
+		event->text.name_length = title_length;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_set_no_space
+ * Desc : This function stops the next text item having a leading space.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_set_no_space(MARKDOWN_STATE* state)
+{
+	if (state->document == NULL)
+	{
+		state->draw_state->no_space = 1;
+	}
+	else
+	{
+		markdown_add_event(state->document,MARKDOWN_EVENT_NO_SPACE);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_set_margin
+ * Desc : This function changes the margin width by the given amount.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_set_margin(MARKDOWN_STATE* state, int change)
+{
+	MARKDOWN_EVENT*	event;
+
+	if (state->document == NULL)
+	{
+		state->draw_state->margin_width += change;
+	}
+	else if ((event = markdown_add_event(state->document,MARKDOWN_EVENT_MARGIN)) != NULL)
+	{
+		event->value = (unsigned int) change;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_output_numbers
+ * Desc : This function outputs the level numbers for a numbered header. The
+ *        numbers come from the index of the format that is being output.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_output_numbers(DRAW_STATE* draw_state)
+{
+	NAME			numbers = {NULL,0,0,0};
+	unsigned char	buffer[MAX_NUMBER_LENGTH];
+
+	numbers.name = buffer;
+	numbers.name_length = level_index_gen_label(&draw_state->index,1,INDEX_STYLE_NUMBERS,buffer,MAX_NUMBER_LENGTH,'.');
+
+	draw_state->format->output_text(draw_state,OUTPUT_TEXT_STYLE_T_SPACE,&numbers);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_header_numbers
+ * Desc : This function handles the level numbers of a numbered header.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_header_numbers(MARKDOWN_STATE* state)
+{
+	if (state->document == NULL)
+	{
+		markdown_output_numbers(state->draw_state);
+	}
+	else
+	{
+		markdown_add_event(state->document,MARKDOWN_EVENT_HEADER_NUMBERS);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_model_reference
+ * Desc : This function outputs the model item that the reference points to.
+ *--------------------------------------------------------------------------------*/
+static void	markdown_model_reference(MARKDOWN_STATE* state, NAME* reference)
+{
+	MARKDOWN_EVENT*	event;
+
+	if (state->document == NULL)
+	{
+		state->input_state->line_number = state->line_number;
+		output_parse_model(state->draw_state,state->input_state,state->draw_state->model,reference);
+	}
+	else if ((event = markdown_add_event(state->document,MARKDOWN_EVENT_MODEL)) != NULL)
+	{
+		event->value = state->line_number;
+		event->text = *reference;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : markdown_parse_state
+ * Desc : This function runs the parser over the buffer in the state.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	markdown_parse_state(MARKDOWN_STATE* state)
+{
+	unsigned int	result = EC_OK;
+	unsigned char	char_size;
+
+	if ((char_size = utf8_char_size(&state->buffer[state->buffer_pos])) == 1)
+	{
+		/* first call to handle the start of the buffer - assumes new line */
+		result = markdown_parse(state);
+	}
+
+	while (state->buffer_pos < state->buffer_size)
+	{
+		if ((char_size = utf8_char_size(&state->buffer[state->buffer_pos])) == 0)
+		{
+			/* invalid utf8 char - replace with a safe char */
+			state->buffer[state->buffer_pos++] = '.';
+		}
+		else if (char_size == 1 && (state->buffer[state->buffer_pos] == 0x0a || state->buffer[state->buffer_pos] == 0x0d))
+		{
+			/* only interested in UNICODE page 0 - get the index into the jump table and call that function */
+			result = markdown_parse(state);
+		}
+		else
+		{
+			state->buffer_pos += char_size;
+		}
+	}
+
+	return result;
+}
+
 /**---- FUNCTION -----------------------------------------------------------------*
  * @api		markdown_parse_buffer
  * @group	markdown_api
@@ -275,11 +632,6 @@ static unsigned int	handle_newline(MARKDOWN_STATE* state, unsigned int buffer_po
  *--------------------------------------------------------------------------------*/
 unsigned int	markdown_parse_buffer(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsigned char* buffer, unsigned int buffer_size, unsigned int in_block)
 {
-	unsigned int	index;
-	unsigned int	result = EC_OK;
-	unsigned int	curr_pos = 0;
-	unsigned int	block_state = in_block;
-	unsigned char	char_size;
 	MARKDOWN_STATE	state;
 
 	memset(&state,0,sizeof(MARKDOWN_STATE));
@@ -290,33 +642,305 @@ unsigned int	markdown_parse_buffer(DRAW_STATE* draw_state, INPUT_STATE* input_st
 	state.buffer_size	= buffer_size;
 	state.line_number	= 0;
 
-	if ((char_size = utf8_char_size(&state.buffer[state.buffer_pos])) == 1)
+	return markdown_parse_state(&state);
+}
+
+/**---- FUNCTION -----------------------------------------------------------------*
+ * @api		markdown_load_document
+ * @group	markdown_api
+ * @desc	This function will load and parse the input in the input state. The
+ *			output of the parser is kept as a list of render events within the
+ *			document so that the file only needs to be parsed once, and then 
+ *			can be replayed for the index and each of the output formats.
+ *
+ *			Macros are expanded when the document is loaded, so all the macros
+ *			must be in the draw state before this function is called.
+ *
+ * @parameter	draw_state	The state of the output, for the macros.
+ * @parameter	input_state	The state of the input.
+ * @parameter	document	Returns the document that has been loaded.
+ *--------------------------------------------------------------------------------*/
+unsigned int	markdown_load_document(DRAW_STATE* draw_state, INPUT_STATE* input_state, MARKDOWN_DOCUMENT** document)
+{
+	unsigned int		result = EC_FAILED;
+	DRAW_STATE			record_state;
+	MARKDOWN_STATE		state;
+	MARKDOWN_DOCUMENT*	new_document;
+
+	*document = NULL;
+
+	if ((new_document = calloc(1,sizeof(MARKDOWN_DOCUMENT))) == NULL)
 	{
-		/* first call to handle the start of the buffer - assumes new line */
-		result = markdown_parse(&state);
+		result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+		raise_warning(0,result,(unsigned char*)input_state->input_name,NULL);
 	}
-
-	while (state.buffer_pos < state.buffer_size)
+	else if ((input_state->input_file = open((char*)input_state->input_name,READ_FILE_STATUS)) == -1)
 	{
-		if ((char_size = utf8_char_size(&state.buffer[state.buffer_pos])) == 0)
+		result = EC_FAILED_TO_OPEN_INPUT_FILE;
+		raise_warning(0,result,(unsigned char*)input_state->input_name,NULL);
+		free(new_document);
+	}
+	else
+	{
+		if ((result = markdown_loadfile(input_state)) == EC_OK)
 		{
-			/* invalid utf8 char - replace with a safe char */
-			state.buffer[state.buffer_pos++] = '.';
+			/* the parser only sees the record format and the macros */
+			memset(&record_state,0,sizeof(DRAW_STATE));
+			record_state.output_file	= -1;
+			record_state.format			= &record_format;
+			record_state.format_state	= new_document;
+			record_state.macro_lookup	= draw_state->macro_lookup;
+
+			memset(&state,0,sizeof(MARKDOWN_STATE));
+			state.draw_state	= &record_state;
+			state.input_state	= input_state;
+			state.document		= new_document;
+			state.buffer		= &input_state->buffer[3];
+			state.buffer_size	= input_state->buffer_size - 4;
+
+			result = markdown_parse_state(&state);
+
+			/* the document now owns the file buffer */
+			new_document->buffer = input_state->buffer;
+			input_state->buffer = NULL;
+
+			*document = new_document;
 		}
-		else if (char_size == 1 && (state.buffer[state.buffer_pos] == 0x0a || state.buffer[state.buffer_pos] == 0x0d))
+		else
 		{
-			/* only interested in UNICODE page 0 - get the index into the jump table and call that function */
-			result = markdown_parse(&state);
+			free(new_document);
 		}
-		else
+
+		close(input_state->input_file);
+	}
+
+	return result;
+}
+
+/**---- FUNCTION -----------------------------------------------------------------*
+ * @api		markdown_replay_document
+ * @group	markdown_api
+ * @desc	This function will replay the render events of a loaded document
+ *			to the format in the draw state.
+ *
+ * @parameter	draw_state	The state of the output.
+ * @parameter	input_state	The state of the input.
+ * @parameter	document	The document to replay.
+ *--------------------------------------------------------------------------------*/
+unsigned int	markdown_replay_document(DRAW_STATE* draw_state, INPUT_STATE* input_state, MARKDOWN_DOCUMENT* document)
+{
+	NAME					text;
+	NAME					row_data[MAX_TABLE_SIZE];
+	NAME*					row;
+	TABLE_ROW				table_row;
+	TABLE_LAYOUT			table_layout;
+	unsigned int			index;
+	unsigned int			column;
+	unsigned int			result = EC_OK;
+	MARKDOWN_EVENT*			event;
+	MARKDOWN_EVENT_BLOCK*	block;
+	OUTPUT_FORMAT*			format = draw_state->format;
+
+	if (format == NULL)
+	{
+		result = EC_UNSUPPORTED_OUTPUT_FORMAT;
+		raise_warning(0,result,(unsigned char*)input_state->input_name,NULL);
+	}
+	else if (document == NULL)
+	{
+		/* the load has already reported the problem */
+		result = EC_FAILED;
+	}
+	else
+	{
+		memset(&table_row,0,sizeof(TABLE_ROW));
+		memset(&table_layout,0,sizeof(TABLE_LAYOUT));
+		memset(row_data,0,sizeof(row_data));
+
+		for (column=0; column < MAX_TABLE_SIZE; column++)
 		{
-			state.buffer_pos += char_size;
+			table_row.row[column] = &row_data[column];
+		}
+
+		for (block = document->first; block != NULL; block = block->next)
+		{
+			for (index=0; index < block->num_events; index++)
+			{
+				event = &block->event[index];
+
+				switch (event->type)
+				{
+					case MARKDOWN_EVENT_HEADER:
+						format->output_header(draw_state,input_state);
+						break;
+
+					case MARKDOWN_EVENT_FOOTER:
+						format->output_footer(draw_state,input_state);
+						break;
+
+					case MARKDOWN_EVENT_RAW:
+						format->output_raw(draw_state,event->text.name,event->text.name_length);
+						break;
+
+					case MARKDOWN_EVENT_MARKER:
+						format->output_marker(draw_state,event->value);
+						break;
+
+					case MARKDOWN_EVENT_TEXT:
+						text = event->text;
+						format->output_text(draw_state,event->value,&text);
+						break;
+
+					case MARKDOWN_EVENT_TABLE_START:
+						/* the formats may update the layout, so it is kept for the rest of the table */
+						if (event->data != NULL)
+						{
+							memcpy(&table_layout,event->data,sizeof(TABLE_LAYOUT));
+						}
+						format->output_table_start(draw_state,&table_layout);
+						break;
+
+					case MARKDOWN_EVENT_TABLE_HEADER:
+					case MARKDOWN_EVENT_TABLE_ROW:
+						if ((row = event->data) != NULL)
+						{
+							memcpy(row_data,row,sizeof(row_data));
+						}
+
+						if (event->type == MARKDOWN_EVENT_TABLE_HEADER)
+						{
+							format->output_table_header(draw_state,&table_layout,&table_row);
+						}
+						else
+						{
+							format->output_table_row(draw_state,&table_layout,&table_row);
+						}
+						break;
+
+					case MARKDOWN_EVENT_TABLE_END:
+						format->output_table_end(draw_state,&table_layout);
+						break;
+
+					case MARKDOWN_EVENT_LIST_ITEM_START:
+						format->output_list_item_start(draw_state,event->value,(unsigned char)event->extra);
+						break;
+
+					case MARKDOWN_EVENT_LIST_NUMERIC_START:
+						format->output_list_numeric_start(draw_state,event->value);
+						break;
+
+					case MARKDOWN_EVENT_LIST_END:
+						format->output_list_end(draw_state);
+						break;
+
+					case MARKDOWN_EVENT_INPUT_STATE:
+						input_state->state = event->value;
+						break;
+
+					case MARKDOWN_EVENT_TITLE:
+						input_state->title.name = event->text.name;
+						input_state->title.name_length = event->text.name_length;
+						break;
+
+					case MARKDOWN_EVENT_NO_SPACE:
+						draw_state->no_space = 1;
+						break;
+
+					case MARKDOWN_EVENT_MARGIN:
+						draw_state->margin_width += event->value;
+						break;
+
+					case MARKDOWN_EVENT_HEADER_NUMBERS:
+						markdown_output_numbers(draw_state);
+						break;
+
+					case MARKDOWN_EVENT_MODEL:
+						text = event->text;
+						input_state->line_number = event->value;
+						output_parse_model(draw_state,input_state,draw_state->model,&text);
+						break;
+				}
+			}
 		}
 	}
 
 	return result;
 }
 
+/**---- FUNCTION -----------------------------------------------------------------*
+ * @api		markdown_document_levels
+ * @group	markdown_api
+ * @desc	This function will move the level index over the headers in the
+ *			document in the same way that the output formats do when the 
+ *			document is replayed. This allows the index at the start of each
+ *			chapter to be found without rendering the chapters before it.
+ *
+ * @parameter	index		The level index to update.
+ * @parameter	document	The document to walk.
+ *--------------------------------------------------------------------------------*/
+void	markdown_document_levels(LEVEL_INDEX* index, MARKDOWN_DOCUMENT* document)
+{
+	unsigned int			count;
+	MARKDOWN_EVENT*			event;
+	MARKDOWN_EVENT_BLOCK*	block;
+
+	if (document != NULL)
+	{
+		for (block = document->first; block != NULL; block = block->next)
+		{
+			for (count=0; count < block->num_events; count++)
+			{
+				event = &block->event[count];
+
+				if (event->type == MARKDOWN_EVENT_MARKER && (event->value & OUTPUT_MARKER_MASK) == OUTPUT_MARKER_HEADER_START)
+				{
+					level_index_set_level(index,event->value & 0x0000ffff);
+				}
+			}
+		}
+	}
+}
+
+/**---- FUNCTION -----------------------------------------------------------------*
+ * @api		markdown_release_document
+ * @group	markdown_api
+ * @desc	This function will release a document and the file buffer that it
+ *			holds.
+ *
+ * @parameter	document	The document to release.
+ *--------------------------------------------------------------------------------*/
+void	markdown_release_document(MARKDOWN_DOCUMENT* document)
+{
+	unsigned int			index;
+	MARKDOWN_EVENT_BLOCK*	block;
+	MARKDOWN_EVENT_BLOCK*	next;
+
+	if (document != NULL)
+	{
+		for (block = document->first; block != NULL; block = next)
+		{
+			next = block->next;
+
+			for (index=0; index < block->num_events; index++)
+			{
+				if (block->event[index].data != NULL)
+				{
+					free(block->event[index].data);
+				}
+			}
+
+			free(block);
+		}
+
+		if (document->buffer != NULL)
+		{
+			free(document->buffer);
+		}
+
+		free(document);
+	}
+}
+
 /**---- FUNCTION -----------------------------------------------------------------*
  * @api		markdown_parse_input
  * @group	markdown_api
@@ -328,30 +952,32 @@ unsigned int	markdown_parse_buffer(DRAW_STATE* draw_state, INPUT_STATE* input_st
  *			on other buffer data within some of the model items, this will make
  *			there usage more flexible.
  *
+ *			If the same file is to be output more than once, then load it with
+ *			markdown_load_document() and replay it for each output.
+ *
  * @parameter	draw_state	The state of the output.
  * @parameter	input_state	The state of the input.
  *--------------------------------------------------------------------------------*/
 unsigned int	markdown_parse_input(DRAW_STATE* draw_state,INPUT_STATE* input_state)
 {
-	unsigned int result = EC_FAILED;
+	unsigned int		result = EC_FAILED;
+	MARKDOWN_DOCUMENT*	document;
 
 	if (draw_state->format == NULL)
 	{
 		result = EC_UNSUPPORTED_OUTPUT_FORMAT;
 		raise_warning(0,result,(unsigned char*)input_state->input_name,NULL);
 	}
-	else if ((input_state->input_file = open((char*)input_state->input_name,READ_FILE_STATUS)) == -1)
-	{
-		result = EC_FAILED_TO_OPEN_INPUT_FILE;
-		raise_warning(0,result,(unsigned char*)input_state->input_name,NULL);
-	}
-	else if ((result = markdown_loadfile(input_state)) == EC_OK)
+	else
 	{
-		result = markdown_parse_buffer(draw_state,input_state,&input_state->buffer[3],input_state->buffer_size-4,0);
+		result = markdown_load_document(draw_state,input_state,&document);
 
-		markdown_unload_file(input_state);
-	
-		close(input_state->input_file);
+		if (document != NULL)
+		{
+			markdown_replay_document(draw_state,input_state,document);
+
+			markdown_release_document(document);
+		}
 	}
 
 	return result;
@@ -499,16 +1125,14 @@ static unsigned int	markdown_parse_square_bracket(MARKDOWN_STATE* state, unsigne
 		if (state->buffer[start_url + 7] == ':' && memcmp(&state->buffer[start_url],doc_gen_string,doc_gen_size) == 0)
 		{
 			/* copy the title */
-			state->input_state->title.name = title.name;
-			state->input_state->title.name_length = title.name_length;
+			markdown_set_title(state,title.name,title.name_length);
 
 			/* ok it's a doc_gen url and we need to handle it */
 			reference.name = &state->buffer[start_url + 8];
 			reference.name_length = end_url - start_url - 8;
 
 			/* handle the model objects */
-			state->input_state->line_number = state->line_number;
-			output_parse_model(state->draw_state,state->input_state,state->draw_state->model,&reference);
+			markdown_model_reference(state,&reference);
 		}
 		else
 		{
@@ -718,7 +1342,7 @@ static unsigned int	markdown_consume_line(MARKDOWN_STATE* state, unsigned int st
 				
 			if (state->buffer[result] != ' ')
 			{
-				state->draw_state->no_space = 1;
+				markdown_set_no_space(state);
 			}
 
 
@@ -938,10 +1562,12 @@ static unsigned int	markdown_parse_table_block(MARKDOWN_STATE* state)
 	TABLE_LAYOUT	table_layout;
 	
 	/* Ok, start the table block */
-	state->input_state->state = TYPE_TABLE;
+	markdown_set_input_state(state,TYPE_TABLE);
 	state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 	/* initialise the table */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
+
 	for (column=0; column < MAX_TABLE_SIZE; column++)
 	{
 		column_data[column].fixed = 0;
@@ -1039,6 +1665,9 @@ static unsigned int	markdown_parse_table_block(MARKDOWN_STATE* state)
 				
 			table_layout.column[column].width = column_header[column].name_length;
 		
+			/* the first row is always the header */
+			table_layout.table_flags = OUTPUT_TABLE_FORMAT_HEADER;
+
 			if (boxed)
 			{
 				table_layout.table_flags |= OUTPUT_TABLE_FORMAT_BOXED;
@@ -1136,10 +1765,12 @@ static unsigned int	markdown_parse_simple_table_block(MARKDOWN_STATE* state)
 	TABLE_LAYOUT table_layout;
 	
 	/* Ok, start the table block */
-	state->input_state->state = TYPE_TABLE;
+	markdown_set_input_state(state,TYPE_TABLE);
 	state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 	/* initialise the table */
+	memset(&table_layout,0,sizeof(TABLE_LAYOUT));
+
 	for (column=0; column < MAX_TABLE_SIZE; column++)
 	{
 		column_data[column].fixed = 0;
@@ -1357,7 +1988,7 @@ static unsigned int	markdown_parse_code_block(MARKDOWN_STATE* state)
 	unsigned int	result = EC_OK;
 
 	/* Ok, start the code block */
-	state->input_state->state = TYPE_CODE_BLOCK;
+	markdown_set_input_state(state,TYPE_CODE_BLOCK);
 	state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 	while (pos < state->buffer_size)
@@ -1455,9 +2086,8 @@ unsigned int markdown_parse_fenced_code_block(MARKDOWN_STATE* state)
 		pos += 3;
 
 		/* start the code block */
-		state->input_state->state = TYPE_CODE_BLOCK;
-		state->input_state->title.name = NULL;
-		state->input_state->title.name_length = 0;
+		markdown_set_input_state(state,TYPE_CODE_BLOCK);
+		markdown_set_title(state,NULL,0);
 		state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 		state->draw_state->format->output_marker(state->draw_state,OUTPUT_MARKER_CODE_START);
@@ -1614,12 +2244,10 @@ static unsigned int	markdown_parse_hash(MARKDOWN_STATE* state)
  *--------------------------------------------------------------------------------*/
 static unsigned int	markdown_parse_numbered_header(MARKDOWN_STATE* state)
 {
-	NAME			numbers = {NULL,0,0,0};
 	unsigned int	pos = state->buffer_pos;
 	unsigned int	bpos = pos - 1;
 	unsigned int	level = 0;
 	unsigned int	result = EC_OK;
-	unsigned char	buffer[MAX_NUMBER_LENGTH];
 	
 	/* Ok, get to the end of the first number */
 	while (state->buffer[pos] >= '0' && state->buffer[pos] <= '9')
@@ -1667,11 +2295,8 @@ static unsigned int	markdown_parse_numbered_header(MARKDOWN_STATE* state)
 		state->draw_state->format->output_marker(state->draw_state,OUTPUT_MARKER_HEADER_START|level);
 
 		/* output the level numbers */
-		numbers.name = buffer;
-		numbers.name_length = level_index_gen_label(&state->draw_state->index,1,INDEX_STYLE_NUMBERS,buffer,MAX_NUMBER_LENGTH,'.');
-
-		state->draw_state->format->output_text(state->draw_state,OUTPUT_TEXT_STYLE_T_SPACE,&numbers);
-		state->draw_state->no_space = 1;
+		markdown_header_numbers(state);
+		markdown_set_no_space(state);
 
 		state->buffer_pos = markdown_consume_line(state,pos);
 
@@ -1727,12 +2352,12 @@ static unsigned int	markdown_handle_quote_block(MARKDOWN_STATE* state, unsigned
 					text.name_length = 2;
 					state->draw_state->format->output_text(state->draw_state,leading,&text);
 					leading |= OUTPUT_TEXT_STYLE_L_NEWLINE;
-					state->draw_state->margin_width += 2;
+					markdown_set_margin(state,2);
 				}
 				else
 				{
 					/* going down a level */
-					state->draw_state->margin_width -= 2;
+					markdown_set_margin(state,-2);
 					text.name = (unsigned char*) "''";
 					text.name_length = 2;
 					state->draw_state->format->output_text(state->draw_state,OUTPUT_TEXT_STYLE_NORMAL|OUTPUT_TEXT_STYLE_T_NEWLINE,&text);
@@ -1768,7 +2393,7 @@ static unsigned int	markdown_handle_quote_block(MARKDOWN_STATE* state, unsigned
 	}
 
 	/* need to end the quote block */
-	state->draw_state->margin_width -= 2;
+	markdown_set_margin(state,-2);
 	text.name = (unsigned char*) "''";
 	text.name_length = 2;
 	state->draw_state->format->output_text(state->draw_state,OUTPUT_TEXT_STYLE_NORMAL,&text);
@@ -1893,7 +2518,7 @@ static	unsigned int	markdown_parse_quote_block(MARKDOWN_STATE* state)
 {
 	unsigned int result = EC_OK;
 	
-	state->input_state->state = TYPE_QUOTE_BLOCK;
+	markdown_set_input_state(state,TYPE_QUOTE_BLOCK);
 	state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 	state->buffer_pos = markdown_handle_quote_block(state,state->buffer_pos,0);
@@ -1925,7 +2550,7 @@ static unsigned int	markdown_parse_list_block(MARKDOWN_STATE* state)
 	unsigned int result = EC_OK;
 	unsigned int marker;
 
-	state->input_state->state = TYPE_LIST;
+	markdown_set_input_state(state,TYPE_LIST);
 	state->draw_state->format->output_header(state->draw_state,state->input_state);
 
 	do
@@ -1979,7 +2604,7 @@ static unsigned int	markdown_parse_list_block(MARKDOWN_STATE* state)
 
 	state->buffer_pos = pos;
 
-	state->input_state->state = TYPE_LIST;
+	markdown_set_input_state(state,TYPE_LIST);
 	state->draw_state->format->output_footer(state->draw_state,state->input_state);
 
 	return result;
@@ -107,8 +107,10 @@ unsigned int	text_open(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsigne
 		draw_state->path[length] = '\0';
 	
 		draw_state->page_width = DEFAULT_PAGE_WIDTH;
+		draw_state->offset = 0;
 		draw_state->margin_width = 4;
 		draw_state->global_margin_width = 4;
+		draw_state->global_format_flags = 0;
 		draw_state->global_max_constant = 50;
 
 		draw_state->output_buffer = malloc(draw_state->page_width + 1);
@@ -132,7 +134,7 @@ void	text_close(DRAW_STATE* draw_state,INPUT_STATE* input_state)
 {
 	if (draw_state->output_file != -1)
 	{
-		close(draw_state->output_file);
+		output_sink_close(draw_state);
 		free(draw_state->output_buffer);
 	}
 }
@@ -161,7 +163,7 @@ void	text_output_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 		default:
 			if ((draw_state->format_flags & OUTPUT_FORMAT_INLINE) == 0)
 			{
-				write(draw_state->output_file,"\n",1);
+				output_sink_write(draw_state,"\n",1);
 			}
 	}
 }
@@ -218,8 +220,8 @@ void	text_output_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 		{
 			if (offset - start_point > 1)
 			{
-				write(draw_state->output_file,"\n",1);
-				write(draw_state->output_file,&buffer[start_point],offset-start_point);
+				output_sink_write(draw_state,"\n",1);
+				output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 			}
 			start_point = offset + 1;
 		}
@@ -228,8 +230,8 @@ void	text_output_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 
 	if (start_point < offset)
 	{
-		write(draw_state->output_file,"\n",1);
-		write(draw_state->output_file,&buffer[start_point],offset-start_point);
+		output_sink_write(draw_state,"\n",1);
+		output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 	}
 		
 	draw_state->offset = 0;
@@ -243,9 +245,9 @@ void	text_output_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 void	text_output_sample(DRAW_STATE* draw_state, SAMPLE* sample)
 {
 	/* text version ignores the header level */
-	write(draw_state->output_file,"\n",1);
-	write(draw_state->output_file,sample->name.name,sample->name.name_length);
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
+	output_sink_write(draw_state,sample->name.name,sample->name.name_length);
+	output_sink_write(draw_state,"\n",1);
 
 	/* now output the block */
 	write_block_text(draw_state,&sample->sample,OUTPUT_COLUMN_FORMAT_LINE_CLIP);
@@ -286,7 +288,7 @@ void	text_output_timelines(DRAW_STATE* draw_state)
 	}
 			
 	draw_state->output_buffer[write_size++] = '\n';
-	write(draw_state->output_file,draw_state->output_buffer,write_size);
+	output_sink_write(draw_state,draw_state->output_buffer,write_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -409,7 +411,7 @@ void	text_output_message(DRAW_STATE* draw_state, MESSAGE* message)
 			pos = draw_state->data.sequence.column[count] - draw_state->data.sequence.window_start;
 		
 			/* now write the line to the file */
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->page_width+1);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->page_width+1);
 		}
 	}
 }
@@ -475,18 +477,18 @@ void	text_output_marker(DRAW_STATE* draw_state, unsigned int marker)
 
 		case OUTPUT_MARKER_PARAGRAPH_BREAK:
 			draw_state->offset = 0;
-			write(draw_state->output_file,"\n\n",2);
+			output_sink_write(draw_state,"\n\n",2);
 			break;
 
 		case OUTPUT_MARKER_LINE_BREAK:
 			draw_state->offset = 0;
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 			break;
 
 		case OUTPUT_MARKER_ASCII_CHAR:
 			array[0] = (unsigned char) marker & 0x7f;
 			draw_state->offset++;
-			write(draw_state->output_file,array,1);
+			output_sink_write(draw_state,array,1);
 			break;
 	}
 }
@@ -499,19 +501,19 @@ void	text_output_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* tex
 {
 	if (text_style & OUTPUT_TEXT_STYLE_L_NEWLINE)
 	{
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,"\n",1);
 		draw_state->offset = 0;
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_L_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 		draw_state->offset++;
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_ITALIC)
 	{
-		write(draw_state->output_file,"*",1);
+		output_sink_write(draw_state,"*",1);
 		draw_state->offset++;
 	}
 
@@ -522,19 +524,19 @@ void	text_output_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* tex
 
 	if (text_style & OUTPUT_TEXT_STYLE_ITALIC)
 	{
-		write(draw_state->output_file,"*",1);
+		output_sink_write(draw_state,"*",1);
 		draw_state->offset++;
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_T_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 		draw_state->offset++;
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_T_NEWLINE)
 	{
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,"\n",1);
 		draw_state->offset = 0;
 	}
 }
@@ -547,9 +549,9 @@ void	text_output_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* tex
 void	text_output_section( DRAW_STATE* draw_state, unsigned int header_level, NAME* name, unsigned int format, NAME* section_data)
 {
 	/* text version ignores the header level */
-	write(draw_state->output_file,"\n",1);
-	write(draw_state->output_file,name->name,name->name_length);
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
+	output_sink_write(draw_state,name->name,name->name_length);
+	output_sink_write(draw_state,"\n",1);
 
 	/* now output the block */
 	write_block_text(draw_state,section_data,format);
@@ -562,16 +564,16 @@ void	text_output_section( DRAW_STATE* draw_state, unsigned int header_level, NAM
 void	text_output_title(DRAW_STATE* draw_state, unsigned int header_level, NAME* title, NAME* name)
 {
 	/* text functions ignore header level */
-	write(draw_state->output_file,"\n",1);
-	write(draw_state->output_file,title->name,title->name_length);
+	output_sink_write(draw_state,"\n",1);
+	output_sink_write(draw_state,title->name,title->name_length);
 
 	if (name != NULL)
 	{
-		write(draw_state->output_file,"    ",4);
-		write(draw_state->output_file,name->name,name->name_length);
+		output_sink_write(draw_state,"    ",4);
+		output_sink_write(draw_state,name->name,name->name_length);
 	}
 	
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -674,7 +676,7 @@ void	text_output_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 				/* ok, naive layout does not work - or we have variable width columns */
 				if ((fixed_size + total_column_spacing) < draw_state->page_width && (variable_width_columns || adjustable_columns))
 				{
-					write(draw_state->output_file,"with\n",5);
+					output_sink_write(draw_state,"with\n",5);
 					/* ok, the table will fit with the fixed columns */
 					per_column = (draw_state->page_width - total_column_spacing - draw_state->margin_width - fixed_size) 
 									/ (table_layout->num_columns - num_fixed_width);
@@ -728,33 +730,33 @@ void	text_output_table_header(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout
 		memset(draw_state->output_buffer,' ',draw_state->page_width);
 
 		/* ok, we have a valid table */
-		write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
+		output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
 		
 		for (count=0; count < table_layout->num_columns; count++)
 		{
 			if (table_row->row[count]->name_length < table_layout->column[count].width)
 			{
 				/* write the text and pad with spaces */
-				write(draw_state->output_file,table_row->row[count]->name,table_row->row[count]->name_length);
-				write(draw_state->output_file,draw_state->output_buffer,table_layout->column[count].width - table_row->row[count]->name_length);
+				output_sink_write(draw_state,table_row->row[count]->name,table_row->row[count]->name_length);
+				output_sink_write(draw_state,draw_state->output_buffer,table_layout->column[count].width - table_row->row[count]->name_length);
 			}
 			else
 			{
 				/* write the title clipped */
-				write(draw_state->output_file,table_row->row[count]->name,table_layout->column[count].width);
+				output_sink_write(draw_state,table_row->row[count]->name,table_layout->column[count].width);
 			}
 
-			write(draw_state->output_file,draw_state->output_buffer,table_layout->column_spacing);
+			output_sink_write(draw_state,draw_state->output_buffer,table_layout->column_spacing);
 		}
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,"\n",1);
 		
 		/* now write the underlines */
 		for (count=0; count < table_layout->num_columns; count++)
 		{
 			memset(&draw_state->output_buffer[table_layout->column[count].offset],'-',table_layout->column[count].width);
 		}
-		write(draw_state->output_file,draw_state->output_buffer,draw_state->page_width);
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,draw_state->output_buffer,draw_state->page_width);
+		output_sink_write(draw_state,"\n",1);
 	}
 
 }
@@ -789,7 +791,7 @@ void	text_output_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout,TA
 		{
 			clipped = 0;
 		
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->margin_width);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->margin_width);
 
 			/* write each column */
 			for (column = 0; column < table_layout->num_columns; column++)
@@ -806,7 +808,7 @@ void	text_output_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout,TA
 							write_size = word_wrap(&table_rows->row[column]->name[table_rows->copied[column]],write_size,&wrapped);
 						}
 
-						write(draw_state->output_file,&table_rows->row[column]->name[table_rows->copied[column]],write_size);
+						output_sink_write(draw_state,&table_rows->row[column]->name[table_rows->copied[column]],write_size);
 
 						/* adjust the counts */
 						table_rows->remaining[column] -= write_size + wrapped;
@@ -817,8 +819,8 @@ void	text_output_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout,TA
 					else
 					{
 						write_size = table_rows->remaining[column];
-						write(draw_state->output_file,&table_rows->row[column]->name[table_rows->copied[column]],write_size);
-						write(draw_state->output_file,draw_state->output_buffer,table_layout->column[column].width - write_size);
+						output_sink_write(draw_state,&table_rows->row[column]->name[table_rows->copied[column]],write_size);
+						output_sink_write(draw_state,draw_state->output_buffer,table_layout->column[column].width - write_size);
 
 						table_rows->remaining[column] -= write_size;
 						table_rows->copied[column]    += write_size;
@@ -826,14 +828,14 @@ void	text_output_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout,TA
 				}
 				else
 				{
-					write(draw_state->output_file,draw_state->output_buffer,table_layout->column[column].width);
+					output_sink_write(draw_state,draw_state->output_buffer,table_layout->column[column].width);
 				}
 		
-				write(draw_state->output_file,draw_state->output_buffer,table_layout->column_spacing);
+				output_sink_write(draw_state,draw_state->output_buffer,table_layout->column_spacing);
 			}
 				
 			/* need a new line */
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 		}
 		while (clipped);
 	}
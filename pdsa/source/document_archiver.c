@@ -0,0 +1,402 @@
+/**-------------------------------------------------------------------------------*
+ *               Document Generator Project
+ *			        by Peter Antoine
+ *
+ * Name  : document_archiver
+ * Desc  : This file holds the code that builds, lists and updates the archives
+ *         of objects that have been compiled with the document source compiler.
+ *
+ * Author: pantoine
+ * Date  : 18/10/2026 17:12:40
+ *
+ * @application	pdsa
+ *
+ * @section		Description
+ *
+ * Document Source Archiver
+ *
+ * This application will take the object files that have been generated by the
+ * document compiler *pdsc* and put them into a single archive file. The archive
+ * can be given to the document linker *pdsl* in place of the objects, so a big
+ * tree does not have to pass thousands of objects to the linker.
+ *
+ * The archive has an index of the groups, apis, functions and applications
+ * that each of the objects names, this can be listed with the -t and -v flags.
+ *
+ * @synopsis	all		-v, -q, -c, -u, -t, archive, input_files
+ *
+ * @section		Error Reporting
+ * 				Please report any problems to https://github.com/PAntoine/docgen
+ *
+ * @section		Author
+ * 				Peter Antoine
+ *
+ * @ignore
+*--------------------------------------------------------------------------------*
+ *                     Copyright (c) 2011 Peter Antoine
+ *                            All rights Reserved.
+ *                    Released Under the Artistic Licence
+ *--------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error_codes.h"
+#include "file_functions.h"
+#include "object_archive.h"
+#include "document_generator.h"
+
+#define ARCHIVE_MODE_NONE	(0)
+#define ARCHIVE_MODE_CREATE	(1)
+#define ARCHIVE_MODE_UPDATE	(2)
+#define ARCHIVE_MODE_LIST	(3)
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : symbol_type_name
+ * Desc : This function returns the name of the type of an index symbol.
+ *--------------------------------------------------------------------------------*/
+static const char*	symbol_type_name(unsigned char type)
+{
+	const char*	result = "unknown";
+
+	switch (type)
+	{
+		case INTERMEDIATE_RECORD_GROUP:			result = "group";		break;
+		case INTERMEDIATE_RECORD_API:			result = "api";			break;
+		case INTERMEDIATE_RECORD_FUNCTION:		result = "function";	break;
+		case INTERMEDIATE_RECORD_APPLICATION:	result = "application";	break;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : list_archive
+ * Desc : This function will list the members of the archive, and if verbose is
+ *        set the symbols that the index holds for each member.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	list_archive(const char* archive_name, int verbose)
+{
+	unsigned int	result;
+	unsigned int	count;
+	unsigned int	symbol = 0;
+	FILE_MAP		archive_file;
+	OBJECT_ARCHIVE	archive;
+
+	if ((result = map_input_file(archive_name,&archive_file)) != EC_OK)
+	{
+		raise_warning(0,result,(unsigned char*)archive_name,NULL);
+	}
+	else
+	{
+		if ((result = object_archive_read(&archive,archive_file.data,archive_file.size)) != EC_OK)
+		{
+			raise_warning(0,result,(unsigned char*)archive_name,NULL);
+		}
+		else
+		{
+			/* the index is written in member order */
+			for (count=0; count < archive.num_members; count++)
+			{
+				printf("%.*s\n",archive.members[count].name_length,archive.members[count].name);
+
+				while (symbol < archive.num_symbols && archive.symbols[symbol].member == count)
+				{
+					if (verbose)
+					{
+						printf("\t%-12s %.*s\n",
+								symbol_type_name(archive.symbols[symbol].type),
+								archive.symbols[symbol].name_length,
+								archive.symbols[symbol].name);
+					}
+
+					symbol++;
+				}
+			}
+		}
+
+		object_archive_release(&archive);
+		unmap_input_file(&archive_file);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : build_archive
+ * Desc : This function will write the archive from the input files. When the
+ *        archive is updated the members of the old archive are kept and the
+ *        inputs with the same names replace them. An input that is itself an
+ *        archive adds all of its members. The archive is not written if any of
+ *        the inputs cannot be added.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	build_archive(const char* archive_name, char** input_list, unsigned int num_inputs, unsigned int update, int verbose)
+{
+	unsigned int	result = EC_OK;
+	unsigned int	error;
+	unsigned int	count;
+	unsigned int	member;
+	FILE_MAP		archive_file;
+	FILE_MAP*		input_files;
+	OBJECT_ARCHIVE	archive;
+	OBJECT_ARCHIVE	input_archive;
+
+	memset(&archive,0,sizeof(OBJECT_ARCHIVE));
+	memset(&archive_file,0,sizeof(FILE_MAP));
+
+	if ((input_files = calloc(num_inputs,sizeof(FILE_MAP))) == NULL)
+	{
+		result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
+		raise_warning(0,result,NULL,NULL);
+	}
+	else if (update && map_input_file(archive_name,&archive_file) == EC_OK)
+	{
+		/* an archive that does not exist yet is created */
+		if ((result = object_archive_read(&archive,archive_file.data,archive_file.size)) != EC_OK)
+		{
+			raise_warning(0,result,(unsigned char*)archive_name,NULL);
+		}
+	}
+
+	for (count=0; result == EC_OK && count < num_inputs; count++)
+	{
+		if ((error = map_input_file(input_list[count],&input_files[count])) != EC_OK)
+		{
+			/* reported below */
+		}
+		else if (object_archive_is_archive(input_files[count].data,input_files[count].size))
+		{
+			if ((error = object_archive_read(&input_archive,input_files[count].data,input_files[count].size)) == EC_OK)
+			{
+				for (member=0; error == EC_OK && member < input_archive.num_members; member++)
+				{
+					error = object_archive_add(	&archive,
+												input_archive.members[member].name,
+												input_archive.members[member].name_length,
+												input_archive.members[member].data,
+												input_archive.members[member].size);
+				}
+			}
+
+			object_archive_release(&input_archive);
+		}
+		else
+		{
+			error = object_archive_add(&archive,(unsigned char*)input_list[count],strlen(input_list[count]),input_files[count].data,input_files[count].size);
+		}
+
+		if (error != EC_OK)
+		{
+			raise_warning(0,error,(unsigned char*)input_list[count],NULL);
+			result = error;
+		}
+	}
+
+	if (result == EC_OK)
+	{
+		if ((result = object_archive_write(&archive,archive_name)) != EC_OK)
+		{
+			raise_warning(0,result,(unsigned char*)archive_name,NULL);
+		}
+		else if (verbose)
+		{
+			printf("archived %u members with %u symbols in %s\n",archive.num_members,archive.num_symbols,archive_name);
+		}
+	}
+
+	object_archive_release(&archive);
+
+	if (input_files != NULL)
+	{
+		for (count=0; count < num_inputs; count++)
+		{
+			unmap_input_file(&input_files[count]);
+		}
+
+		free(input_files);
+	}
+
+	unmap_input_file(&archive_file);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : main
+ * Desc : This is the main function.
+ *--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+	int				quiet = 0;
+	int				failed = 0;
+	int				verbose = 0;
+	char*			error_string = "";
+	char*			archive_name = NULL;
+	char**			input_list = NULL;
+	unsigned int	start = 1;
+	unsigned int	mode = ARCHIVE_MODE_NONE;
+	unsigned int	num_inputs = 0;
+
+	if (argc < 2)
+	{
+		failed = 1;
+	}
+	else
+	{
+		input_list = calloc(argc,sizeof(char*));
+
+		do
+		{
+			if (argv[start][0] == '-')
+			{
+				switch (argv[start][1])
+				{
+					/**-----------------------------------------------------------*
+					 * @option	-v
+					 *
+					 * @description
+					 * This produces extra output information. When the archive
+					 * is listed it also lists the index of each member.
+					 *------------------------------------------------------------*/
+					case 'v':	/* verbose - add extra comments to the output */
+						verbose = 1;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-q
+					 *
+					 * @description
+					 * quiet. This flag suppresses any non-error output from the
+					 * application.
+					 *------------------------------------------------------------*/
+					case 'q':	/* quiet - suppress non error outputs */
+						quiet = 1;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-c
+					 *
+					 * @description
+					 * This creates the archive from the input files. If the
+					 * archive exists it is replaced.
+					 *------------------------------------------------------------*/
+					case 'c':	/* create - write a new archive */
+						failed |= (mode != ARCHIVE_MODE_NONE);
+						mode = ARCHIVE_MODE_CREATE;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-u
+					 *
+					 * @description
+					 * This updates the archive with the input files. An input
+					 * file replaces the member with the same name, the other
+					 * input files are added to the end of the archive. If the
+					 * archive does not exist it is created.
+					 *------------------------------------------------------------*/
+					case 'u':	/* update - replace or add the members */
+						failed |= (mode != ARCHIVE_MODE_NONE);
+						mode = ARCHIVE_MODE_UPDATE;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-t
+					 *
+					 * @description
+					 * This lists the members of the archive in the order that
+					 * they will be linked.
+					 *------------------------------------------------------------*/
+					case 't':	/* table - list the members */
+						failed |= (mode != ARCHIVE_MODE_NONE);
+						mode = ARCHIVE_MODE_LIST;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option		-?
+					 *
+					 * @description
+					 * This outputs the help message.
+					 *------------------------------------------------------------*/
+					case '?':	/* help  - just fail! */
+						failed = 1;
+						break;
+
+					default:
+						failed = 1;
+						error_string = "Unknown parameter\n";
+				}
+			}
+			else if (archive_name == NULL)
+			{
+				/**-----------------------------------------------------------*
+				 * @option 		archive
+				 * @required	yes
+				 *
+				 * @description
+				 *
+				 * The archive file to build, update or list.
+				 *------------------------------------------------------------*/
+				archive_name = argv[start];
+			}
+			else
+			{
+				/**-----------------------------------------------------------*
+				 * @option 		input_files
+				 * @required	no
+				 * @multiple	yes
+				 *
+				 * @description
+				 *
+				 * The object files to put in the archive. The members are
+				 * linked in the order that they are given. If an input file is
+				 * an archive then all of its members are added.
+				 *------------------------------------------------------------*/
+				input_list[num_inputs++] = argv[start];
+			}
+
+			start++;
+		}
+		while(start < argc);
+	}
+
+	if (failed)
+	{
+		/* handle failure */
+	}
+	else if (mode == ARCHIVE_MODE_NONE)
+	{
+		error_string = "one of -c, -u or -t is required\n";
+		failed = 1;
+	}
+	else if (archive_name == NULL)
+	{
+		error_string = "must have an archive file\n";
+		failed = 1;
+	}
+	else if (mode == ARCHIVE_MODE_LIST)
+	{
+		failed = (list_archive(archive_name,verbose) != EC_OK);
+	}
+	else if (num_inputs == 0)
+	{
+		error_string = "must have an input file\n";
+		failed = 1;
+	}
+	else
+	{
+		failed = (build_archive(archive_name,input_list,num_inputs,(mode == ARCHIVE_MODE_UPDATE),verbose && !quiet) != EC_OK);
+	}
+
+	if (failed)
+	{
+		printf("%s",error_string);
+	}
+
+	free(input_list);
+
+	if (failed)
+		exit(EXIT_FAILURE);
+	else
+		exit(EXIT_SUCCESS);
+}
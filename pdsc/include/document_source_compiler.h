@@ -16,8 +16,91 @@
 #ifndef __DOCUMENT_SOURCE_COMPILER_H__
 #define __DOCUMENT_SOURCE_COMPILER_H__
 
+#include "lookup_tables.h"
+#include "input_formats.h"
+
+#define INPUT_LIST_BLOCK_SIZE	(32)
+#define LINE_BUFFER_BLOCK_SIZE	(128)
+#define OBJECT_BUFFER_BLOCK_SIZE	(4096)
+#define OBJECT_TEMP_EXTENSION	".tmp"
+#define OBJECT_COMPARE_BLOCK_SIZE	(4096)
+
+/*--------------------------------------------------------------------------------*
+ * Compile Context.
+ *
+ * This holds everything that is collected from one input file and the state of
+ * the parser between the lines of the file. Each file being compiled has its
+ * own context, only the macros are shared and they are not changed once the
+ * files are being compiled.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int	input_type;
+	SOURCE_STATE	source_state;
+	ATOM_INDEX		atoms;
+
+	/* the items found in the file */
+	LOOKUP_LIST		group_lookup;
+	LOOKUP_LIST		functions;
+	LOOKUP_LIST		apis;
+	LOOKUP_LIST		samples;
+	LOOKUP_LIST		applications;
+
+	/* parser state */
+	NAME			return_type;
+	NAME			function_name;
+	unsigned int	ignore;
+	unsigned int	multiline;
+	unsigned char	type_state;
+	unsigned int	in_function;
+	unsigned int	current_api;
+	unsigned int	current_group;
+	unsigned int	in_file_block;
+	unsigned int	default_group;
+	unsigned int	current_sample;
+	unsigned int	current_function;
+	unsigned int	current_application;
+	unsigned char	looking_for_type;
+	unsigned int	waiting_to_collect;
+	unsigned char	collecting_sample;
+	unsigned char	looking_for_comment;
+	unsigned char	looking_for_globals;
+	unsigned char	looking_for_function;
+	unsigned char	looking_for_constants;
+	unsigned char	function_state;
+
+} COMPILE_CONTEXT;
+
+/*--------------------------------------------------------------------------------*
+ * Object Buffer.
+ *
+ * The object file is built in this buffer and written out in one go when it is
+ * complete.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned char*	data;
+	unsigned int	size;
+	unsigned int	used;
+	unsigned int	failed;
+
+} OBJECT_BUFFER;
+
+/*--------------------------------------------------------------------------------*
+ * The files to compile, and the results of the compile.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int	num_inputs;
+	unsigned int	num_failed;
+	char**			input_list;
+	char*			output_filename;
+	char*			output_directory;
+
+} COMPILE_JOBS;
+
 void add_pair_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* name, unsigned int name_length, unsigned char* string, unsigned int string_length);
-void add_api_end_atom (ATOM_INDEX* list, unsigned short group_id);
+void add_api_end_atom (ATOM_INDEX* list, unsigned int group_id);
 
 
 #endif
@@ -42,26 +42,77 @@ typedef enum
 } INPUT_FORMATS;
 
 /*--------------------------------------------------------------------------------*
- * Function Pointer Types for the input functions.
+ * Source State.
+ *
+ * The state that the input functions keep between the lines of a file. Each
+ * file that is being compiled has its own, so that files can be compiled at
+ * the same time.
  *--------------------------------------------------------------------------------*/
-typedef unsigned int	(*INPUT_FIND_COMMENT_FUNCTION)		(unsigned char* line,unsigned int line_length,unsigned int* pos);
-typedef unsigned int	(*INPUT_END_COMMENT_FUNCTION)		(unsigned char* line,unsigned int line_length,unsigned int* pos);
-typedef unsigned int	(*INPUT_START_FUNCTION)				(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name);
-typedef unsigned int	(*INPUT_FIND_PARAMETER_FUNCTION)	(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found);
-typedef unsigned int	(*INPUT_START_LEVEL_FUNCTION)		(unsigned char* line,unsigned int line_length,unsigned int* pos);
-typedef unsigned int	(*INPUT_END_LEVEL_FUNCTION)			(unsigned char* line,unsigned int line_length,unsigned int* pos);
-typedef unsigned int	(*INPUT_END_FUNCTION)				(unsigned char* line,unsigned int line_length,unsigned int* pos);
-
-typedef unsigned int	(*INPUT_TYPE_DECODE_FUNCTION)		(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
-typedef unsigned int	(*INPUT_DECODE_CONSTANT_FUNCTION)	(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
-typedef unsigned int	(*INPUT_TRIM_MULTILINE_FUNCTION)	(unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef struct
+{
+	unsigned int	found_start;
+	unsigned int	level;
+
+	/* type name decoder */
+	unsigned int	type_hold_symbol;
+	unsigned int	type_name_state;
+	unsigned int	type_name_length;
+	unsigned int	type_return_length;
+	unsigned char	type_name_string[MAX_NAME_LENGTH];
+	unsigned char	type_return_name[MAX_NAME_LENGTH * 3];
+
+	/* function header decoder */
+	unsigned int	start_got_type;
+	unsigned int	parameter_got_type;
+	unsigned int	parameter_state;
+
+	/* type decoder */
+	unsigned int	decode_level;
+	unsigned int	decode_state;
+	unsigned int	decode_internal_type;
+	unsigned int	decode_type_def_length;
+	unsigned char	decode_value_string[MAX_NAME_LENGTH];
+	unsigned char	decode_name_string[MAX_NAME_LENGTH];
+	unsigned char	decode_type_definition[MAX_NAME_LENGTH * 3];
+
+	/* constant decoder */
+	unsigned int	constant_state;
+	unsigned int	constant_brack_count;
+	NAME			constant_type_name;
+	NAME			constant_return_type;
+
+} SOURCE_STATE;
 
+/*--------------------------------------------------------------------------------*
+ * Function Pointer Types for the input functions.
+ *--------------------------------------------------------------------------------*/
+typedef unsigned int	(*INPUT_FIND_COMMENT_FUNCTION)		(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef unsigned int	(*INPUT_END_COMMENT_FUNCTION)		(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef unsigned int	(*INPUT_START_FUNCTION)				(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name);
+typedef unsigned int	(*INPUT_FIND_PARAMETER_FUNCTION)	(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found);
+typedef unsigned int	(*INPUT_START_LEVEL_FUNCTION)		(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef unsigned int	(*INPUT_END_LEVEL_FUNCTION)			(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef unsigned int	(*INPUT_END_FUNCTION)				(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+
+typedef unsigned int	(*INPUT_TYPE_DECODE_FUNCTION)		(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
+typedef unsigned int	(*INPUT_DECODE_CONSTANT_FUNCTION)	(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
+typedef unsigned int	(*INPUT_TRIM_MULTILINE_FUNCTION)	(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+typedef void			(*INPUT_RESET_FUNCTION)				(SOURCE_STATE* state);
 
+/*--------------------------------------------------------------------------------*
+ * The input format.
+ *
+ * comment_start and comment_end are the first characters of the comment start
+ * and end markers. A line that does not hold the character cannot start or end
+ * a comment, so the compiler can skip over it when it is outside a comment.
+ *--------------------------------------------------------------------------------*/
 typedef struct
 {
 	unsigned char*					format_name;
 	unsigned int					format_name_length;
 	unsigned int					end_of_line_comment_size;
+	unsigned char					comment_start;
+	unsigned char					comment_end;
 	INPUT_FIND_COMMENT_FUNCTION		find_comment;
 	INPUT_END_COMMENT_FUNCTION		end_comment;
 	INPUT_START_FUNCTION			function_start;
@@ -72,6 +123,7 @@ typedef struct
 	INPUT_TYPE_DECODE_FUNCTION		decode_type;
 	INPUT_DECODE_CONSTANT_FUNCTION	decode_constant;
 	INPUT_TRIM_MULTILINE_FUNCTION	trim_multiline;
+	INPUT_RESET_FUNCTION			reset;
 
 } SOURCE_FORMAT;
 
@@ -80,17 +132,19 @@ typedef struct
  *--------------------------------------------------------------------------------*/
 unsigned int	input_decode_format(unsigned char* file_name);
 
-unsigned int	c_find_comment(unsigned char* line,unsigned int line_length,unsigned int* pos);
-unsigned int	c_end_comment(unsigned char* line,unsigned int line_length,unsigned int* pos);
-unsigned int	c_function_start(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name);
-unsigned int	c_find_parameter(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found);
-unsigned int	c_function_start_level(unsigned char* line,unsigned int line_length,unsigned int* pos);
-unsigned int	c_function_end_level(unsigned char* line,unsigned int line_length,unsigned int* pos);
-unsigned int	c_function_end(unsigned char* line,unsigned int line_length,unsigned int* pos);
+unsigned int	c_find_comment(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+unsigned int	c_end_comment(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+unsigned int	c_function_start(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name);
+unsigned int	c_find_parameter(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found);
+unsigned int	c_function_start_level(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+unsigned int	c_function_end_level(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+unsigned int	c_function_end(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
+
+unsigned int	c_decode_type(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
+unsigned int	c_decode_constant(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
 
-unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
-unsigned int	c_decode_constant(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list);
+unsigned int 	c_trim_multiline(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos);
 
-unsigned int 	c_trim_multiline(unsigned char* line,unsigned int line_length,unsigned int* pos);
+void			c_reset_state(SOURCE_STATE* state);
 #endif
 
@@ -31,8 +31,6 @@ static unsigned char	g_comment_end_end		= '/';
 static unsigned char	g_function_start		= '{';
 static unsigned char	g_function_end			= '}';
 
-static unsigned int		g_found_start = 0;
-static unsigned int		g_level = 0;
 static unsigned int		g_comment_start_length = 2;
 
 extern unsigned char is_valid_char[];
@@ -83,6 +81,22 @@ extern SYMBOLS_STRING_TABLE	symbols_table[];
 #define C_CONSTANT_GET_ARRAY_DATA			(8)
 #define C_CONSTANT_FOUND_EQUALS				(9)
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : c_reset_state
+ * Desc : This function will set the state machines back to the state that they
+ *        are in at the start of a file.
+ *--------------------------------------------------------------------------------*/
+void	c_reset_state(SOURCE_STATE* state)
+{
+	memset(state,0,sizeof(SOURCE_STATE));
+
+	state->type_name_state			= C_START;
+	state->parameter_state			= C_FIND_TYPE;
+	state->decode_state				= C_TYPE_STATE_LOOKING;
+	state->decode_internal_type		= SYMBOLS_NUM_STRINGS;
+	state->constant_state			= C_CONSTANT_STATE_LOOKING;
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : c_get_type_name
  * Desc : This function will decode a C/C++ type. It will return the length of
@@ -109,79 +123,73 @@ extern SYMBOLS_STRING_TABLE	symbols_table[];
  *       symbol is returned in the 'symbol' parameter. This will help in some 
  *       of the searches so it does not have to search again to find the symbol.
  *--------------------------------------------------------------------------------*/
-static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length,unsigned int *pos,NAME* return_type, NAME* name,unsigned int* symbol)
+static unsigned int	c_get_type_name(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int *pos,NAME* return_type, NAME* name,unsigned int* symbol)
 {
 	int						word;
 	unsigned int			token_start;
 	unsigned int			result = 0;
 	unsigned int			current_pos = *pos;
-	static unsigned int		hold_symbol;
-	static unsigned int		current_state = C_START;
-	static unsigned int		name_length = 0;
-	static unsigned int		return_type_length = 0;
-	static unsigned char	name_string[MAX_NAME_LENGTH];
-	static unsigned char	return_type_name[MAX_NAME_LENGTH * 3];
-
-	if (current_state == C_START)
+
+	if (state->type_name_state == C_START)
 	{
-		hold_symbol = SYMBOLS_NUM_STRINGS;
-		name_length = 0;
-		return_type_length = 0;
-		current_state = C_LOOKING;
+		state->type_hold_symbol = SYMBOLS_NUM_STRINGS;
+		state->type_name_length = 0;
+		state->type_return_length = 0;
+		state->type_name_state = C_LOOKING;
 	}
 
-	if (current_state == C_GET_INDEX)
+	if (state->type_name_state == C_GET_INDEX)
 	{
 		while (current_pos < line_length && is_valid_char[line[current_pos]])
 		{
-			return_type_name[return_type_length++] = line[current_pos++];
+			state->type_return_name[state->type_return_length++] = line[current_pos++];
 		}
 
 		if (line[current_pos] == ']')
 		{
-			return_type_name[return_type_length++] = ']';
+			state->type_return_name[state->type_return_length++] = ']';
 			*pos = current_pos + 1;
-			current_state = C_LOOK_FOR_ARRAY;
+			state->type_name_state = C_LOOK_FOR_ARRAY;
 		}
 		else
 		{
-			current_state = C_START;
+			state->type_name_state = C_START;
 			result = 2;
 		}
 	}
-	else if (current_state == C_LOOK_FOR_ARRAY)
+	else if (state->type_name_state == C_LOOK_FOR_ARRAY)
 	{
 		if (line[current_pos] == '[')
 		{
-			return_type_name[return_type_length++] = '[';
+			state->type_return_name[state->type_return_length++] = '[';
 			*pos = *pos + 1;
-			current_state = C_GET_INDEX;
+			state->type_name_state = C_GET_INDEX;
 		}
 		else
 		{
 			*pos = current_pos;
-			g_level = 0;
-			current_state = C_START;
+			state->level = 0;
+			state->type_name_state = C_START;
 			result = 1;
 
 			/* set the names */
-			name->name_length = name_length;
-			name->name = malloc(name_length);
-			memcpy(name->name,name_string,name_length);
+			name->name_length = state->type_name_length;
+			name->name = malloc(state->type_name_length);
+			memcpy(name->name,state->type_name_string,state->type_name_length);
 
-			return_type->name_length = return_type_length;
-			return_type->name = malloc(return_type_length);
-			memcpy(return_type->name,return_type_name,return_type_length);
+			return_type->name_length = state->type_return_length;
+			return_type->name = malloc(state->type_return_length);
+			memcpy(return_type->name,state->type_return_name,state->type_return_length);
 		}
 	}
-	else if (current_state == C_GET_NAME)
+	else if (state->type_name_state == C_GET_NAME)
 	{
 		if (line[current_pos] == '*')
 		{
 			*pos = *pos + 1;
-			return_type_name[return_type_length++] = line[current_pos];
-			return_type_name[return_type_length++] = ' ';
-			current_state = C_POINTER;
+			state->type_return_name[state->type_return_length++] = line[current_pos];
+			state->type_return_name[state->type_return_length++] = ' ';
+			state->type_name_state = C_POINTER;
 		}
 		else
 		{
@@ -189,7 +197,7 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 
 			while (current_pos < line_length && is_valid_char[line[current_pos]])
 			{
-				name_string[name_length++] = line[current_pos++];
+				state->type_name_string[state->type_name_length++] = line[current_pos++];
 			}
 
 			if (line[current_pos] == '(' 	|| line[current_pos] == '\t' || line[current_pos] == ' ' ||
@@ -205,28 +213,28 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 				if (line[current_pos] == '[')
 				{
 					*pos = current_pos;
-					current_state = C_LOOK_FOR_ARRAY;
+					state->type_name_state = C_LOOK_FOR_ARRAY;
 				}
 				else
 				{
 					*pos = current_pos;
-					g_level = 0;
-					current_state = C_START;
+					state->level = 0;
+					state->type_name_state = C_START;
 					result = 1;
 
 					/* set the names */
-					name->name_length = name_length;
-					name->name = malloc(name_length);
-					memcpy(name->name,name_string,name_length);
+					name->name_length = state->type_name_length;
+					name->name = malloc(state->type_name_length);
+					memcpy(name->name,state->type_name_string,state->type_name_length);
 
-					return_type->name_length = return_type_length;
-					return_type->name = malloc(return_type_length);
-					memcpy(return_type->name,return_type_name,return_type_length);
+					return_type->name_length = state->type_return_length;
+					return_type->name = malloc(state->type_return_length);
+					memcpy(return_type->name,state->type_return_name,state->type_return_length);
 				}
 			}
 			else
 			{
-				current_state = C_START;
+				state->type_name_state = C_START;
 				result = 2;
 			}
 		}
@@ -237,88 +245,88 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 		{
 			case SYMBOLS_EXTERN:
 			case SYMBOLS_STATIC:
-				if (current_state == C_LOOKING)
+				if (state->type_name_state == C_LOOKING)
 				{
 					/* add the name to the return type */
-					memcpy(return_type_name,&line[*pos],symbols_get_length(word));
-					return_type_length = symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(state->type_return_name,&line[*pos],symbols_get_length(word));
+					state->type_return_length = symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 						
-					current_state = C_GOT_EXTERN_STATIC;
+					state->type_name_state = C_GOT_EXTERN_STATIC;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
 			
 			case SYMBOLS_CONST:
 			case SYMBOLS_VOLATILE:
-				if (current_state == C_POINTER)
+				if (state->type_name_state == C_POINTER)
 				{
 					/* add the name to the return type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 						
-					current_state = C_POINTER;
+					state->type_name_state = C_POINTER;
 				}
-				else if (current_state == C_LOOKING || current_state == C_GOT_EXTERN_STATIC)
+				else if (state->type_name_state == C_LOOKING || state->type_name_state == C_GOT_EXTERN_STATIC)
 				{
 					/* add the name to the return type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 						
-					current_state = C_GOT_CONST_VOLATILE;
+					state->type_name_state = C_GOT_CONST_VOLATILE;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
 
 			case SYMBOLS_LONG:
-				if (current_state == C_GOT_LONG)
+				if (state->type_name_state == C_GOT_LONG)
 				{
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 					
-					current_state = C_GET_NAME;
+					state->type_name_state = C_GET_NAME;
 				}
-				else if (current_state == C_LOOKING || current_state == C_GOT_EXTERN_STATIC || current_state == C_GOT_PRE_TYPE || current_state == C_GOT_CONST_VOLATILE)
+				else if (state->type_name_state == C_LOOKING || state->type_name_state == C_GOT_EXTERN_STATIC || state->type_name_state == C_GOT_PRE_TYPE || state->type_name_state == C_GOT_CONST_VOLATILE)
 				{
 					/* add to current type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 				
-					current_state = C_GOT_LONG;
+					state->type_name_state = C_GOT_LONG;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
 
 			case SYMBOLS_SIGNED:
 			case SYMBOLS_UNSIGNED:
-				if (current_state == C_LOOKING || current_state == C_GOT_EXTERN_STATIC || current_state == C_GOT_CONST_VOLATILE)
+				if (state->type_name_state == C_LOOKING || state->type_name_state == C_GOT_EXTERN_STATIC || state->type_name_state == C_GOT_CONST_VOLATILE)
 				{
 					/* add to current type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 				
-					current_state = C_GOT_PRE_TYPE;
+					state->type_name_state = C_GOT_PRE_TYPE;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
@@ -326,19 +334,19 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 			case SYMBOLS_ENUM:
 			case SYMBOLS_UNION:
 			case SYMBOLS_STRUCT:
-				if (current_state == C_LOOKING || current_state == C_GOT_EXTERN_STATIC ||  current_state == C_GOT_CONST_VOLATILE)
+				if (state->type_name_state == C_LOOKING || state->type_name_state == C_GOT_EXTERN_STATIC ||  state->type_name_state == C_GOT_CONST_VOLATILE)
 				{
 					/* add to current type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 				
-					hold_symbol = word;
-					current_state = C_GOT_UNION_STRUCT_ENUM;
+					state->type_hold_symbol = word;
+					state->type_name_state = C_GOT_UNION_STRUCT_ENUM;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
@@ -349,27 +357,27 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 			case SYMBOLS_FLOAT:
 			case SYMBOLS_SHORT:
 			case SYMBOLS_DOUBLE:
-				if (current_state == C_GOT_PRE_TYPE			|| 
-					current_state == C_LOOKING				|| 
-					current_state == C_GOT_EXTERN_STATIC	||  
-					current_state == C_GOT_CONST_VOLATILE)
+				if (state->type_name_state == C_GOT_PRE_TYPE			|| 
+					state->type_name_state == C_LOOKING				|| 
+					state->type_name_state == C_GOT_EXTERN_STATIC	||  
+					state->type_name_state == C_GOT_CONST_VOLATILE)
 				{
 					/* add to current type */
-					memcpy(&return_type_name[return_type_length],&line[*pos],symbols_get_length(word));
-					return_type_length += symbols_get_length(word);
-					return_type_name[return_type_length++] = ' ';
+					memcpy(&state->type_return_name[state->type_return_length],&line[*pos],symbols_get_length(word));
+					state->type_return_length += symbols_get_length(word);
+					state->type_return_name[state->type_return_length++] = ' ';
 	
-					current_state = C_GET_NAME;
+					state->type_name_state = C_GET_NAME;
 				}
 				else
 				{
-					current_state = C_START;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 				break;
 
 			default:
-				current_state = C_START;
+				state->type_name_state = C_START;
 				result = 2;
 		}
 
@@ -378,56 +386,56 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
 	}
 	else
 	{
-		if (current_state == C_POINTER && line[current_pos] != '*')
+		if (state->type_name_state == C_POINTER && line[current_pos] != '*')
 		{
-			current_state = C_GET_NAME;
+			state->type_name_state = C_GET_NAME;
 		}
-		else if (line[current_pos] == '*' || current_state == C_POINTER || current_state == C_GOT_PRE_TYPE || current_state == C_GOT_LONG)
+		else if (line[current_pos] == '*' || state->type_name_state == C_POINTER || state->type_name_state == C_GOT_PRE_TYPE || state->type_name_state == C_GOT_LONG)
 		{
-			return_type_name[return_type_length++] = line[current_pos];
-			return_type_name[return_type_length++] = ' ';
+			state->type_return_name[state->type_return_length++] = line[current_pos];
+			state->type_return_name[state->type_return_length++] = ' ';
 			*pos = current_pos + 1;
 
-			current_state = C_POINTER;
+			state->type_name_state = C_POINTER;
 		}
 		else
 		{
 			/* read the token from the buffer */
 			while (current_pos < line_length && is_valid_char[line[current_pos]])
 			{
-				return_type_name[return_type_length++] = line[current_pos++];
+				state->type_return_name[state->type_return_length++] = line[current_pos++];
 			}
 
-			if (current_state == C_LOOKING 				|| 
-				current_state == C_GOT_EXTERN_STATIC	||
-				current_state == C_GOT_CONST_VOLATILE	||
-				current_state == C_GOT_UNION_STRUCT_ENUM)
+			if (state->type_name_state == C_LOOKING 				|| 
+				state->type_name_state == C_GOT_EXTERN_STATIC	||
+				state->type_name_state == C_GOT_CONST_VOLATILE	||
+				state->type_name_state == C_GOT_UNION_STRUCT_ENUM)
 			{
 				/* OK, assume it is a non-standard type */
 				if (line[current_pos] == '\t' || line[current_pos] == ' ' || line[current_pos] == 0x0a || line[current_pos] == 0x0d)
 				{
 					/* name length: current_pos - token_start */
 					*pos = current_pos;
-					current_state = C_GET_NAME;
+					state->type_name_state = C_GET_NAME;
 				}
 				else if (line[current_pos] == '*')
 				{
-					return_type_name[return_type_length++] = line[current_pos++];
-					return_type_name[return_type_length++] = ' ';
+					state->type_return_name[state->type_return_length++] = line[current_pos++];
+					state->type_return_name[state->type_return_length++] = ' ';
 					*pos = current_pos;
-					current_state = C_POINTER;
+					state->type_name_state = C_POINTER;
 				}
 				else
 				{
 					/* if we had the struct/union/enum that might be useful */
-					*symbol = hold_symbol;
-					current_state = C_START;
+					*symbol = state->type_hold_symbol;
+					state->type_name_state = C_START;
 					result = 2;
 				}
 			}
 			else
 			{
-				current_state = C_START;
+				state->type_name_state = C_START;
 				result = 2;
 			}
 		}
@@ -441,7 +449,7 @@ static unsigned int	c_get_type_name(unsigned char* line,unsigned int line_length
  * Desc : This function will check to see if the comment starts at the current 
  *        file position, having first removed leading whitespace.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_find_comment(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_find_comment(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int result = 0;
 
@@ -468,7 +476,7 @@ unsigned int	c_find_comment(unsigned char* line,unsigned int line_length,unsigne
  * Name : end_comment
  * Desc : This function will find the end of the comment.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_end_comment(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_end_comment(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int result = 0;
 
@@ -508,17 +516,16 @@ unsigned int	c_end_comment(unsigned char* line,unsigned int line_length,unsigned
  *        if unknown_string and state == get_name next goto exit
  *
  *--------------------------------------------------------------------------------*/
-unsigned int	c_function_start(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name)
+unsigned int	c_function_start(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name)
 {
 	unsigned int		result = FUNCTION_STATE_SEARCHING;
 	unsigned int		unsued;
-	static unsigned int	got_type = 0;
 			
 	if (line[*pos] == '(')
 	{
-		if (got_type == 1)
+		if (state->start_got_type == 1)
 		{
-			g_found_start = 1;
+			state->found_start = 1;
 			result = FUNCTION_STATE_PARAMETERS;
 		}
 		else
@@ -528,14 +535,14 @@ unsigned int	c_function_start(unsigned char* line,unsigned int line_length,unsig
 	}
 	else
 	{
-		got_type = c_get_type_name(line,line_length,pos,return_type,name,&unsued);
+		state->start_got_type = c_get_type_name(state,line,line_length,pos,return_type,name,&unsued);
 
-		if (got_type == 1 && line[*pos] == '(')
+		if (state->start_got_type == 1 && line[*pos] == '(')
 		{
-			g_found_start = 1;
+			state->found_start = 1;
 			result = FUNCTION_STATE_PARAMETERS;
 		}
-		else if (got_type == 2)
+		else if (state->start_got_type == 2)
 		{
 			result = FUNCTION_STATE_FAILED;
 		}
@@ -549,12 +556,10 @@ unsigned int	c_function_start(unsigned char* line,unsigned int line_length,unsig
  * Desc : This function will find the parameters and when the parameter list
  *        comes to and end will set the state to the next correct state.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_find_parameter(unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found)
+unsigned int	c_find_parameter(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, NAME* return_type, NAME* name, unsigned int* found)
 {
 	unsigned int		result = FUNCTION_STATE_PARAMETERS;
 	unsigned int		unused;
-	static unsigned int	got_type = 0;
-	static unsigned int	state = C_FIND_TYPE;
 
 	*found = 0;
 
@@ -574,10 +579,10 @@ unsigned int	c_find_parameter(unsigned char* line,unsigned int line_length,unsig
 	}
 	else
 	{
-		got_type = c_get_type_name(line,line_length,pos,return_type,name,&unused);
-		*found = got_type;
+		state->parameter_got_type = c_get_type_name(state,line,line_length,pos,return_type,name,&unused);
+		*found = state->parameter_got_type;
 		
-		if (got_type == 2)
+		if (state->parameter_got_type == 2)
 		{
 			result = FUNCTION_STATE_FAILED;
 			*found = 0;
@@ -591,13 +596,13 @@ unsigned int	c_find_parameter(unsigned char* line,unsigned int line_length,unsig
  * Name : function_start_level
  * Desc : This function is looking for the next level.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_function_start_level(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_function_start_level(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int result = 0;
 	
 	if (line[*pos] == '{')
 	{
-		g_level++;
+		state->level++;
 		*pos = *pos + 1;
 
 		result = 1;
@@ -610,13 +615,13 @@ unsigned int	c_function_start_level(unsigned char* line,unsigned int line_length
  * Name : function_end_level
  * Desc : This function will find the end of function marker.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_function_end_level(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_function_end_level(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int result = 0;
 		
 	if (line[*pos] == '}')
 	{
-		g_level--;
+		state->level--;
 		result = 1;
 	}
 
@@ -630,13 +635,13 @@ unsigned int	c_function_end_level(unsigned char* line,unsigned int line_length,u
  * Desc : This function will always return 1 as c does not have a specific
  *        function end.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_function_end(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_function_end(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int result = 0;
 
-	if (g_level == 0 && g_found_start)
+	if (state->level == 0 && state->found_start)
 	{
-		g_found_start = 0;
+		state->found_start = 0;
 		result = 1;
 	}
 
@@ -654,7 +659,7 @@ unsigned int	c_function_end(unsigned char* line,unsigned int line_length,unsigne
  *
  *        If we cannot find this then we fail.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list)
+unsigned int	c_decode_type(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list)
 {
 	NAME					name;
 	NAME					value;
@@ -668,30 +673,23 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 	unsigned int			value_length = 0;
 	unsigned int			current_pos = *pos;
 	unsigned int			sub_type_type;
-	static unsigned int		level = 0;
-	static unsigned int		state = C_TYPE_STATE_LOOKING;
-	static unsigned int		internal_type = SYMBOLS_NUM_STRINGS;
-	static unsigned int		type_def_length;
-	static unsigned char	value_string[MAX_NAME_LENGTH];
-	static unsigned char	name_string[MAX_NAME_LENGTH];
-	static unsigned char	type_definition[MAX_NAME_LENGTH * 3];
 
 	if (line[*pos] == '#')
 	{
 		/* pre-processor line - skip it */
 		*pos = line_length;
 	}
-	else if (state == C_TYPE_STATE_LOOKING || state == C_TYPE_STATE_GOT_TYPEDEF)
+	else if (state->decode_state == C_TYPE_STATE_LOOKING || state->decode_state == C_TYPE_STATE_GOT_TYPEDEF)
 	{
 		/* find something */
-		if (state != C_TYPE_STATE_GOT_TYPEDEF && (word = symbols_check_word(&line[*pos])) == SYMBOLS_TYPEDEF)
+		if (state->decode_state != C_TYPE_STATE_GOT_TYPEDEF && (word = symbols_check_word(&line[*pos])) == SYMBOLS_TYPEDEF)
 		{
-			state = C_TYPE_STATE_GOT_TYPEDEF;
+			state->decode_state = C_TYPE_STATE_GOT_TYPEDEF;
 			*pos = *pos + symbols_get_length(word);
-			memcpy(type_definition,symbols_table[word].name,symbols_get_length(word));
-			type_def_length  = symbols_get_length(word);
+			memcpy(state->decode_type_definition,symbols_table[word].name,symbols_get_length(word));
+			state->decode_type_def_length  = symbols_get_length(word);
 		}
-		else if (state == C_TYPE_STATE_GOT_TYPEDEF)
+		else if (state->decode_state == C_TYPE_STATE_GOT_TYPEDEF)
 		{
 			word = symbols_check_word(&line[*pos]);
 			*pos = *pos + symbols_get_length(word);
@@ -700,27 +698,27 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 			{
 				case SYMBOLS_STRUCT:
 				case SYMBOLS_UNION:
-					internal_type = SYMBOLS_STRUCT;
-					state = C_TYPE_STATE_GET_TAG;
+					state->decode_internal_type = SYMBOLS_STRUCT;
+					state->decode_state = C_TYPE_STATE_GET_TAG;
 				
-					type_definition[type_def_length++] = ' ';
-					memcpy(&type_definition[type_def_length],symbols_table[word].name,symbols_get_length(word));
-					type_def_length += symbols_get_length(word);
+					state->decode_type_definition[state->decode_type_def_length++] = ' ';
+					memcpy(&state->decode_type_definition[state->decode_type_def_length],symbols_table[word].name,symbols_get_length(word));
+					state->decode_type_def_length += symbols_get_length(word);
 					break;
 
 				case SYMBOLS_ENUM:						/* enum is wrong here - but we are not a c-compiler */
-					internal_type = SYMBOLS_ENUM;
-					state = C_TYPE_STATE_GET_TAG;
+					state->decode_internal_type = SYMBOLS_ENUM;
+					state->decode_state = C_TYPE_STATE_GET_TAG;
 				
-					type_definition[type_def_length++] = ' ';
-					memcpy(&type_definition[type_def_length],symbols_table[word].name,symbols_get_length(word));
-					type_def_length += symbols_get_length(word);
+					state->decode_type_definition[state->decode_type_def_length++] = ' ';
+					memcpy(&state->decode_type_definition[state->decode_type_def_length],symbols_table[word].name,symbols_get_length(word));
+					state->decode_type_def_length += symbols_get_length(word);
 					break;
 
 				default:
 					/* found a typedef now looking for a plain type */
-					got_type = c_get_type_name(line,line_length,pos,&return_type,&name,&unused);
-					state = C_TYPE_STATE_GET_TYPE;
+					got_type = c_get_type_name(state,line,line_length,pos,&return_type,&name,&unused);
+					state->decode_state = C_TYPE_STATE_GET_TYPE;
 
 					if (got_type == 2)
 					{
@@ -732,7 +730,7 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 		else
 		{
 			/* start decoding a plain type */
-			if (got_type = c_get_type_name(line,line_length,pos,&return_type,&name,&unused))
+			if (got_type = c_get_type_name(state,line,line_length,pos,&return_type,&name,&unused))
 			{
 				if (got_type == 2)
 				{
@@ -747,7 +745,7 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 			}
 		}
 	}
-	else if (state == C_TYPE_STATE_GET_TAG)
+	else if (state->decode_state == C_TYPE_STATE_GET_TAG)
 	{
 		/* get the tag name after the struct/union/enum definition */
 		if(line[current_pos] == '{')
@@ -755,28 +753,28 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 			current_pos++;
 			
 			add_api_start_atom(atom_list,RECORD_GROUP_RECORD,current_group);
-			add_string_atom(atom_list,ATOM_TYPE,type_definition,type_def_length,0);
+			add_string_atom(atom_list,ATOM_TYPE,state->decode_type_definition,state->decode_type_def_length,0);
 
-			if (internal_type == SYMBOLS_STRUCT)
+			if (state->decode_internal_type == SYMBOLS_STRUCT)
 			{
-				level = 0;
-				state = C_TYPE_STATE_GET_STRUCT_FIELD;
+				state->decode_level = 0;
+				state->decode_state = C_TYPE_STATE_GET_STRUCT_FIELD;
 			}
 			else
 			{
-				level = 0;
-				state = C_TYPE_STATE_GET_ENUM_FIELD;
+				state->decode_level = 0;
+				state->decode_state = C_TYPE_STATE_GET_ENUM_FIELD;
 			}
 		}
 		else
 		{
 			token_start = current_pos;
-			type_definition[type_def_length++] = ' ';
+			state->decode_type_definition[state->decode_type_def_length++] = ' ';
 			
 			/* get the type */
 			while (current_pos < line_length && is_valid_char[line[current_pos]])
 			{
-				type_definition[type_def_length++] = line[current_pos++];
+				state->decode_type_definition[state->decode_type_def_length++] = line[current_pos++];
 			}
 
 			/*remove whitespace */
@@ -798,10 +796,10 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 
 		*pos = current_pos;
 	}
-	else if (state == C_TYPE_STATE_GET_TYPE)
+	else if (state->decode_state == C_TYPE_STATE_GET_TYPE)
 	{
 		/* expect a type - do get it */
-		if (got_type = c_get_type_name(line,line_length,pos,&return_type,&name,&unused))
+		if (got_type = c_get_type_name(state,line,line_length,pos,&return_type,&name,&unused))
 		{
 			if (got_type == 2)
 			{
@@ -818,56 +816,56 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 			}
 		}
 	}
-	else if (state == C_TYPE_STATE_GET_NAME || state == C_TYPE_STATE_GET_SUB_NAME)
+	else if (state->decode_state == C_TYPE_STATE_GET_NAME || state->decode_state == C_TYPE_STATE_GET_SUB_NAME)
 	{
 		/* get a name string */
 		token_start = current_pos;
 
 		while (current_pos < line_length && is_valid_char[line[current_pos]])
 		{
-			name_string[name_length++] = line[current_pos++];
+			state->decode_name_string[name_length++] = line[current_pos++];
 		}
 
 		if (line[current_pos] == ';')
 		{
 			*pos = current_pos + 1;
 			/* found the end of the type - start looking again */
-			if (state == C_TYPE_STATE_GET_SUB_NAME)
+			if (state->decode_state == C_TYPE_STATE_GET_SUB_NAME)
 			{
-				name_string[name_length] = 0;
-				state = C_TYPE_STATE_GET_STRUCT_FIELD;
+				state->decode_name_string[name_length] = 0;
+				state->decode_state = C_TYPE_STATE_GET_STRUCT_FIELD;
 			}
 			else
 			{
-				name_string[name_length] = 0;
-				state = C_TYPE_STATE_LOOKING;
+				state->decode_name_string[name_length] = 0;
+				state->decode_state = C_TYPE_STATE_LOOKING;
 				result = TYPE_STATE_FINISHED;
 			}
 
-			add_string_atom(atom_list,ATOM_NAME,name_string,name_length,0);
+			add_string_atom(atom_list,ATOM_NAME,state->decode_name_string,name_length,0);
 		}
 		else
 		{
 			result = TYPE_STATE_FAILED;
 		}
 	}
-	else if (state == C_TYPE_STATE_GET_STRUCT_FIELD)
+	else if (state->decode_state == C_TYPE_STATE_GET_STRUCT_FIELD)
 	{
 		/* handle the struct list item - note the does allow for nested structs/unions */
 		if (line[current_pos] == '}')
 		{
-			if (level == 0)
+			if (state->decode_level == 0)
 			{
-				state = C_TYPE_STATE_GET_NAME;
+				state->decode_state = C_TYPE_STATE_GET_NAME;
 			}
 			else
 			{
-				level--;
-				state = C_TYPE_STATE_GET_SUB_NAME;
+				state->decode_level--;
+				state->decode_state = C_TYPE_STATE_GET_SUB_NAME;
 			}
 			*pos = *pos + 1;
 		}
-		else if (got_type = c_get_type_name(line,line_length,pos,&return_type,&name,&sub_type_type))
+		else if (got_type = c_get_type_name(state,line,line_length,pos,&return_type,&name,&sub_type_type))
 		{
 			if (got_type == 2)
 			{
@@ -875,7 +873,7 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 				{
 					add_string_atom(atom_list,ATOM_RECORD,(unsigned char*)symbols_table[sub_type_type].name,symbols_get_length(sub_type_type),0);
 					
-					level++;
+					state->decode_level++;
 					*pos = *pos + 1;
 				}
 				else
@@ -890,7 +888,7 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 			}
 		}
 	}
-	else if (state == C_TYPE_STATE_GET_ENUM_FIELD) 
+	else if (state->decode_state == C_TYPE_STATE_GET_ENUM_FIELD) 
 	{
 		/* all enum fields must follow the 'NAME {= VALUE}{,} {trailing comment}' */
 		token_start = current_pos;
@@ -954,11 +952,11 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
 		{
 			/* ok, reached the end of the enum definition */
 			current_pos++;
-			state = C_TYPE_STATE_GET_NAME;
+			state->decode_state = C_TYPE_STATE_GET_NAME;
 		}
 		else if (line[current_pos] != g_comment_start)
 		{
-			state = C_TYPE_STATE_LOOKING;
+			state->decode_state = C_TYPE_STATE_LOOKING;
 			result = TYPE_STATE_FAILED;
 		}
 
@@ -987,7 +985,7 @@ unsigned int	c_decode_type(unsigned char* line,unsigned int line_length,unsigned
  *        Also, unlike other functions that will fail/produce warnings this code
  *        does not because the #define's can define constants and MACROS.
  *--------------------------------------------------------------------------------*/
-unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list)
+unsigned int c_decode_constant(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos, unsigned int current_group, ATOM_INDEX* atom_list)
 {
 	unsigned int		got_type;
 	unsigned int 		result = 0;
@@ -998,15 +996,8 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 	unsigned int		name_length = 0;
 	unsigned int		type_type;
 	unsigned char		define_name[MAX_NAME_LENGTH];
-	NAME				type_name;
-	NAME				return_type;
-	static unsigned int	state = C_CONSTANT_STATE_LOOKING;
-	static unsigned int brack_count = 0;
-
-	type_name.fixed = 0;
-	return_type.fixed = 0;
 
-	switch(state)
+	switch(state->constant_state)
 	{
 		case C_CONSTANT_STATE_CONTINUATION:
 		{
@@ -1024,12 +1015,12 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 
 			if (line[line_end] == '\\')
 			{
-				state = C_CONSTANT_STATE_CONTINUATION;
+				state->constant_state = C_CONSTANT_STATE_CONTINUATION;
 				current_pos = line_end;
 			}
 			else
 			{
-				state = C_CONSTANT_STATE_LOOKING;
+				state->constant_state = C_CONSTANT_STATE_LOOKING;
 				line_end = current_pos;
 			}
 		}
@@ -1040,20 +1031,20 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 			if (line[current_pos] == '#')
 			{
 				*pos = current_pos + 1;
-				state = C_CONSTANT_STATE_DEFINE;
+				state->constant_state = C_CONSTANT_STATE_DEFINE;
 			}
-			else if (got_type = c_get_type_name(line,line_length,pos,&return_type,&type_name,&type_type))
+			else if (got_type = c_get_type_name(state,line,line_length,pos,&state->constant_return_type,&state->constant_type_name,&type_type))
 			{
 				if (got_type == 2)
 				{
 					/* failed to get a type - so fail the whole thing */
-					state = C_CONSTANT_STATE_FAILED;
+					state->constant_state = C_CONSTANT_STATE_FAILED;
 					result = 2;
 				}
 				else
 				{
 					add_api_start_atom(atom_list,RECORD_GROUP_CONSTANT,current_group);
-					state = C_CONSTANT_STATE_TYPE_DATA;
+					state->constant_state = C_CONSTANT_STATE_TYPE_DATA;
 				}
 			}
 		}
@@ -1072,24 +1063,24 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 				/* look for type starters */
 				if (line[current_pos] == '"')
 				{
-					state = C_CONSTANT_GET_STRING;
+					state->constant_state = C_CONSTANT_GET_STRING;
 				}
 				else if (line[current_pos] >= 0 && line[current_pos] <= 9)
 				{
-					state = C_CONSTANT_GET_NUMBERS;
+					state->constant_state = C_CONSTANT_GET_NUMBERS;
 				}
 				else if (is_valid_char[line[current_pos]])
 				{
-					state = C_CONSTANT_GET_NAME;
+					state->constant_state = C_CONSTANT_GET_NAME;
 				}
 				else if (line[current_pos] == '{')
 				{
-					state = C_CONSTANT_GET_ARRAY_DATA;
+					state->constant_state = C_CONSTANT_GET_ARRAY_DATA;
 				}
 				else
 				{
 					/* fail as given data invalid */
-					state = C_CONSTANT_STATE_FAILED;
+					state->constant_state = C_CONSTANT_STATE_FAILED;
 					result = 2;
 				}
 			}
@@ -1098,18 +1089,18 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 
 		case C_CONSTANT_STATE_TYPE_DATA:
 		{
-			/* add the type */
-			add_api_type_atom (atom_list,ATOM_CONSTANTS,&return_type,&type_name,NULL);
+			/* add the type, the names were found on an earlier call */
+			add_api_type_atom (atom_list,ATOM_CONSTANTS,&state->constant_return_type,&state->constant_type_name,NULL);
 
 			if (line[current_pos] != '=')
 			{
-				state = C_CONSTANT_STATE_FAILED;
+				state->constant_state = C_CONSTANT_STATE_FAILED;
 				result = 2;
 			}
 			else
 			{
 				*pos = current_pos + 1;
-				state = C_CONSTANT_FOUND_EQUALS;
+				state->constant_state = C_CONSTANT_FOUND_EQUALS;
 			}
 		}
 		break;
@@ -1129,13 +1120,13 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 			if (line[current_pos] == ';')
 			{
 				result = 1;
-				state = C_CONSTANT_STATE_LOOKING;
+				state->constant_state = C_CONSTANT_STATE_LOOKING;
 				current_pos++;
 			}
 			else
 			{
 				result = 2;
-				state = C_CONSTANT_STATE_LOOKING;
+				state->constant_state = C_CONSTANT_STATE_LOOKING;
 			}
 			
 			/* always end the atom - work or fail */
@@ -1161,16 +1152,16 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 
 				if (line[current_pos] == '{')
 				{
-					brack_count++;
+					state->constant_brack_count++;
 				}
 				else if (line[current_pos] == '}')
 				{
-					brack_count--;
+					state->constant_brack_count--;
 				}
 
 				current_pos++;
 			}
-			while (current_pos < line_length && brack_count > 0);
+			while (current_pos < line_length && state->constant_brack_count > 0);
 		
 			if ((current_pos - start_pos) > 0)
 			{
@@ -1181,7 +1172,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 			{
 				add_api_end_atom (atom_list,current_group);
 				result = 1;
-				state = C_CONSTANT_STATE_LOOKING;
+				state->constant_state = C_CONSTANT_STATE_LOOKING;
 				current_pos++;
 			}
 
@@ -1213,7 +1204,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 			{
 				add_api_end_atom (atom_list,current_group);
 				result = 1;
-				state = C_CONSTANT_STATE_LOOKING;
+				state->constant_state = C_CONSTANT_STATE_LOOKING;
 			}
 
 			*pos = current_pos + 1;
@@ -1263,7 +1254,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 
 					if (line[line_end] == '\\')
 					{
-						state = C_CONSTANT_STATE_CONTINUATION;
+						state->constant_state = C_CONSTANT_STATE_CONTINUATION;
 						line_end = line_length;
 					}
 					else
@@ -1275,7 +1266,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 						value_start = current_pos;
 						while (current_pos < (line_length - 1) && (line[line_end] != 0x0a && line[line_end] != 0x0d))
 						{
-							if (c_find_comment(line,line_length,&current_pos))
+							if (c_find_comment(state,line,line_length,&current_pos))
 							{
 								/* Ok, found a comment - skip back over it. */
 								current_pos -= g_comment_start_length + 1;
@@ -1294,7 +1285,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
 						}
 
 						add_pair_atom(atom_list,ATOM_RECORD,&line[name_start],name_length,&line[value_start],current_pos-value_start+1);
-						state = C_CONSTANT_STATE_LOOKING;
+						state->constant_state = C_CONSTANT_STATE_LOOKING;
 					}
 				}
 			}
@@ -1311,7 +1302,7 @@ unsigned int c_decode_constant(unsigned char* line,unsigned int line_length,unsi
  * @desc: This function will trim the comment block of whitespace for the
  *        multiline comments.
  *--------------------------------------------------------------------------------*/
-unsigned int	c_trim_multiline(unsigned char* line,unsigned int line_length,unsigned int* pos)
+unsigned int	c_trim_multiline(SOURCE_STATE* state, unsigned char* line,unsigned int line_length,unsigned int* pos)
 {
 	unsigned int 	result = 0;
 	unsigned int 	current_pos = *pos;
@@ -26,7 +26,7 @@
  * The purpose of this system it to allow for generic documentation to be create
  * from the build, and tailored to a specific build configuration.
  * 
- * @synopsis	all		-v, -q, -o, -D, input_file
+ * @synopsis	all		-v, -q, -o, -O, -j, -D, @response_file, input_file
  *
  * @section		Error Reporting
  * 				Please report any problems to https://github.com/PAntoine/docgen
@@ -47,10 +47,18 @@
 #include <stdlib.h>
 #include <strings.h>
 
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
 #include "atoms.h"
+#include "utilities.h"
 #include "error_codes.h"
 #include "lookup_tables.h"
+#include "work_pool.h"
+#include "file_functions.h"
 #include "input_formats.h"
+#include "object_record.h"
 #include "document_generator.h"
 #include "document_source_compiler.h"
 
@@ -62,16 +70,11 @@ static unsigned char	g_marker = '@';
 /*--------------------------------------------------------------------------------*
  * Global Structures.
  *--------------------------------------------------------------------------------*/
-static LOOKUP_LIST	g_group_lookup;
 static LOOKUP_LIST	g_macro_lookup;
-static LOOKUP_LIST	g_functions;
-static LOOKUP_LIST	g_apis;
-static LOOKUP_LIST	g_samples;
-static LOOKUP_LIST	g_applications;
 
 extern unsigned char is_valid_char[];
 
-extern char* g_input_filename;
+extern THREAD_LOCAL char* g_input_filename;
 
 extern SOURCE_FORMAT	input_formats[];
 
@@ -84,11 +87,182 @@ extern unsigned int		g_date_offset;
 extern unsigned int		g_number_records_offset;
 extern unsigned int		g_date_offset;
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_write
+ * Desc : This function will add the data to the object buffer. The buffer is
+ *        grown to fit the data, if it cannot be grown the buffer is marked as
+ *        failed and the rest of the data is dropped.
+ *--------------------------------------------------------------------------------*/
+static void	object_write(OBJECT_BUFFER* object, const void* data, unsigned int data_size)
+{
+	unsigned int	new_size;
+	unsigned char*	new_buffer;
+
+	if (object->failed == 0 && (object->used + data_size) > object->size)
+	{
+		new_size = object->size + OBJECT_BUFFER_BLOCK_SIZE;
+
+		while (new_size < (object->used + data_size))
+		{
+			new_size *= 2;
+		}
+
+		if ((new_buffer = realloc(object->data,new_size)) == NULL)
+		{
+			object->failed = 1;
+		}
+		else
+		{
+			object->data = new_buffer;
+			object->size = new_size;
+		}
+	}
+
+	if (object->failed == 0)
+	{
+		memcpy(&object->data[object->used],data,data_size);
+		object->used += data_size;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_unchanged
+ * Desc : This function will check if the object file that is already on disk
+ *        holds the same content as the object buffer. The content hash in the
+ *        header is used as a quick reject, if it matches and the file is the
+ *        same size the rest of the file is compared with the buffer, so that a
+ *        hash collision does not leave a stale object behind.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	object_unchanged(OBJECT_BUFFER* object, char* filename)
+{
+	int				infile;
+	int				bytes_read;
+	unsigned int	offset;
+	unsigned int	result = 0;
+	unsigned char	header[FILE_HASHED_HEADER_SIZE];
+	unsigned char	buffer[OBJECT_COMPARE_BLOCK_SIZE];
+
+	if (object->failed == 0 && object->used >= FILE_HASHED_HEADER_SIZE && (infile = open(filename,READ_FILE_STATUS,0)) != -1)
+	{
+		if (read(infile,header,FILE_HASHED_HEADER_SIZE) == FILE_HASHED_HEADER_SIZE &&
+			memcmp(header,object->data,FILE_DATE) == 0 &&
+			memcmp(&header[FILE_NUMBER_RECORDS],&object->data[FILE_NUMBER_RECORDS],FILE_HASHED_HEADER_SIZE - FILE_NUMBER_RECORDS) == 0 &&
+			lseek(infile,0,SEEK_END) == (off_t) object->used &&
+			lseek(infile,FILE_HASHED_HEADER_SIZE,SEEK_SET) == FILE_HASHED_HEADER_SIZE)
+		{
+			/* the hash matches, check that the content really does */
+			offset = FILE_HASHED_HEADER_SIZE;
+
+			while (offset < object->used)
+			{
+				if ((bytes_read = read(infile,buffer,OBJECT_COMPARE_BLOCK_SIZE)) <= 0 ||
+					(offset + bytes_read) > object->used ||
+					memcmp(buffer,&object->data[offset],bytes_read) != 0)
+				{
+					break;
+				}
+
+				offset += bytes_read;
+			}
+
+			result = (offset == object->used);
+		}
+
+		close(infile);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_save
+ * Desc : This function will write the object buffer to the file. The object is
+ *        written to a temporary file that is renamed over the object file, so
+ *        that the linker never sees a part written object.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	object_save(OBJECT_BUFFER* object, char* filename)
+{
+	int				outfile;
+	int				written;
+	unsigned int	length = strlen(filename);
+	unsigned int	offset = 0;
+	unsigned int	result = EC_OK;
+	char*			temp_name;
+
+	if (object->failed)
+	{
+		/* the object did not fit in memory */
+		result = EC_FAILED_TO_WRITE_TO_OUTPUT_FILE;
+	}
+	else if ((temp_name = malloc(length + sizeof(OBJECT_TEMP_EXTENSION))) == NULL)
+	{
+		result = EC_FAILED_TO_OPEN_OUTPUT_FILE;
+	}
+	else
+	{
+		memcpy(temp_name,filename,length);
+		memcpy(&temp_name[length],OBJECT_TEMP_EXTENSION,sizeof(OBJECT_TEMP_EXTENSION));
+
+		if ((outfile = open(temp_name,WRITE_FILE_STATUS,WRITE_FILE_PERM)) == -1)
+		{
+			result = EC_FAILED_TO_OPEN_OUTPUT_FILE;
+		}
+		else
+		{
+			while (offset < object->used)
+			{
+				if ((written = write(outfile,&object->data[offset],object->used - offset)) <= 0)
+					break;
+
+				offset += written;
+			}
+
+			close(outfile);
+
+			if (offset != object->used)
+			{
+				result = EC_FAILED_TO_WRITE_TO_OUTPUT_FILE;
+			}
+			else
+			{
+#ifndef __unix__
+				/* rename() will not replace a file that exists on this platform */
+				remove(filename);
+#endif
+				if (rename(temp_name,filename) != 0)
+				{
+					result = EC_FAILED_TO_WRITE_TO_OUTPUT_FILE;
+				}
+			}
+
+			if (result != EC_OK)
+			{
+				remove(temp_name);
+			}
+		}
+
+		free(temp_name);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_record
+ * Desc : This function will write the record header to the object.
+ *--------------------------------------------------------------------------------*/
+static void	write_record(OBJECT_BUFFER* object, OBJECT_RECORD* record)
+{
+	unsigned char	header[OBJECT_RECORD_MAX_HEADER];
+
+	object_write(object,header,object_record_encode(header,record));
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : write_string
  * Desc : This function will write a string to the output file.
  *--------------------------------------------------------------------------------*/
-static void	write_string(int output_file, NAME* string)
+static void	write_string(OBJECT_BUFFER* object, NAME* string)
 {
 	unsigned char	length[2];
 
@@ -103,11 +277,11 @@ static void	write_string(int output_file, NAME* string)
 		length[1] = 0;
 	}
 
-	write(output_file,length,2);
+	object_write(object,length,2);
 	
 	if (string != NULL && string->name_length > 0)
 	{
-		write(output_file,string->name,string->name_length);
+		object_write(object,string->name,string->name_length);
 	}
 }
 
@@ -115,13 +289,11 @@ static void	write_string(int output_file, NAME* string)
  * Name : output_atoms
  * Desc : This function will output a lookup table to the output file.
  *--------------------------------------------------------------------------------*/
-static void output_atoms (int output_file, ATOM_INDEX* index)
+static void output_atoms (OBJECT_BUFFER* object, ATOM_INDEX* index)
 {
-	unsigned int	size;
 	unsigned int	count;
-	unsigned int	data_size;
 	unsigned char	length[2];
-	unsigned char	record[RECORD_DATA_START+1];
+	OBJECT_RECORD	record;
 	ATOM_BLOCK*		current = &index->index;
 	
 	while (current != NULL)
@@ -129,14 +301,11 @@ static void output_atoms (int output_file, ATOM_INDEX* index)
 		for (count=0;count<current->num_items;count++)
 		{
 			/* output the common fields */
-			record[RECORD_TYPE] = current->index[count].any.type;
-			record[RECORD_ATOM] = current->index[count].any.atom;
-			record[RECORD_GROUP  ] = (current->index[count].any.func_api & 0xff00) >> 8;
-			record[RECORD_GROUP+1] = current->index[count].any.func_api & 0xff;
-			record[RECORD_LINE_NUM  ] = (current->index[count].any.line & 0xff00) >> 8;
-			record[RECORD_LINE_NUM+1] = current->index[count].any.line & 0xff;
-			record[RECORD_BLOCK_NUM  ] = (current->index[count].any.block & 0xff00) >> 8;
-			record[RECORD_BLOCK_NUM+1] = current->index[count].any.block & 0xff;
+			record.type			= current->index[count].any.type;
+			record.atom			= current->index[count].any.atom;
+			record.group		= current->index[count].any.func_api;
+			record.line_number	= current->index[count].any.line;
+			record.block_number	= current->index[count].any.block;
 
 			/* now write the records to the file */
 			switch(current->index[count].any.type)
@@ -145,83 +314,75 @@ static void output_atoms (int output_file, ATOM_INDEX* index)
 
 					if (current->index[count].any.func_api == INVALID_ITEM)
 					{
-						record[RECORD_GROUP  ] = (current->index[count].name.group & 0xff00) >> 8;
-						record[RECORD_GROUP+1] = current->index[count].name.group & 0xff;
+						record.group = current->index[count].name.group;
 					}
-					record[RECORD_DATA_SIZE  ] = ((current->index[count].name.name_length+1) & 0xff00) >> 8;
-					record[RECORD_DATA_SIZE+1] = (current->index[count].name.name_length+1) & 0xff;
+					record.data_size = current->index[count].name.name_length+1;
+					write_record(object,&record);
 
-					record[RECORD_DATA_START ] = 0;					/* fixed flag that is not used for strings */
-					write(output_file,record,RECORD_DATA_START+1);
-					write(output_file,current->index[count].name.name,current->index[count].name.name_length);
+					length[0] = 0;					/* fixed flag that is not used for strings */
+					object_write(object,length,1);
+					object_write(object,current->index[count].name.name,current->index[count].name.name_length);
 				break;
 
 				case INTERMEDIATE_RECORD_PAIR:
 				/* set data length and write record header */
-					data_size = 2 + current->index[count].pair.name_length + 2 + current->index[count].pair.string_length;
-					record[RECORD_DATA_SIZE  ] = (data_size & 0xff00) >> 8;
-					record[RECORD_DATA_SIZE+1] = data_size & 0xff;
-					write(output_file,record,RECORD_DATA_START);
+					record.data_size = 2 + current->index[count].pair.name_length + 2 + current->index[count].pair.string_length;
+					write_record(object,&record);
 					
 					/* write name */
 					length[0] = (current->index[count].pair.name_length & 0x0ff00) >> 8;
 					length[1] = (current->index[count].pair.name_length & 0x000ff);
-					write(output_file,length,2);
-					write(output_file,current->index[count].pair.name,current->index[count].pair.name_length);
+					object_write(object,length,2);
+					object_write(object,current->index[count].pair.name,current->index[count].pair.name_length);
 	
 					/* write string */
 					length[0] = (current->index[count].pair.string_length & 0x0ff00) >> 8;
 					length[1] = (current->index[count].pair.string_length & 0x000ff);
-					write(output_file,length,2);
-					write(output_file,current->index[count].pair.string,current->index[count].pair.string_length);
+					object_write(object,length,2);
+					object_write(object,current->index[count].pair.string,current->index[count].pair.string_length);
 					break;
 				
 				case INTERMEDIATE_RECORD_STRING:
 				case INTERMEDIATE_RECORD_MULTILINE:
 
-					record[RECORD_DATA_SIZE  ] = ((current->index[count].string.string_length+1) & 0xff00) >> 8;
-					record[RECORD_DATA_SIZE+1] = (current->index[count].string.string_length+1) & 0xff;
-					record[RECORD_DATA_START ] = current->index[count].string.fixed;
+					record.data_size = current->index[count].string.string_length+1;
+					write_record(object,&record);
 
-					write(output_file,record,RECORD_DATA_START+1);
-					write(output_file,current->index[count].string.string,current->index[count].string.string_length);
+					length[0] = current->index[count].string.fixed;
+					object_write(object,length,1);
+					object_write(object,current->index[count].string.string,current->index[count].string.string_length);
 					break;
 
 				case INTERMEDIATE_RECORD_NUMBERIC:
-					record[RECORD_DATA_SIZE  ] = 0;
-					record[RECORD_DATA_SIZE+1] = 4;
-
-					write(output_file,record,RECORD_DATA_START);
-					write(output_file,current->index[count].number.number,4);
+					record.data_size = 4;
+					write_record(object,&record);
+					object_write(object,current->index[count].number.number,4);
 				break;
 
 				case INTERMEDIATE_RECORD_END:
 				case INTERMEDIATE_RECORD_START:
 				case INTERMEDIATE_RECORD_EMPTY:
-					record[RECORD_DATA_SIZE  ] = 0;
-					record[RECORD_DATA_SIZE+1] = 0;
-					write(output_file,record,RECORD_DATA_START);
+					record.data_size = 0;
+					write_record(object,&record);
 					break;
 
 				case INTERMEDIATE_RECORD_TYPE:
-					size =	current->index[count].type.name.name_length +
-							current->index[count].type.type_type.name_length +
-							current->index[count].type.description.name_length + 6;
-
-					record[RECORD_DATA_SIZE  ] = (size & 0xff00) >> 8;
-					record[RECORD_DATA_SIZE+1] = (size & 0x00ff);
-					write(output_file,record,RECORD_DATA_START);
+					record.data_size =	current->index[count].type.name.name_length +
+										current->index[count].type.type_type.name_length +
+										current->index[count].type.description.name_length + 6;
+					write_record(object,&record);
 	
-					write_string(output_file,&current->index[count].type.type_type);
-					write_string(output_file,&current->index[count].type.name);
-					write_string(output_file,&current->index[count].type.description);
+					write_string(object,&current->index[count].type.type_type);
+					write_string(object,&current->index[count].type.name);
+					write_string(object,&current->index[count].type.description);
 					break;
 
 				case INTERMEDIATE_RECORD_BOOLEAN:
-					record[RECORD_DATA_SIZE  ] = 0;
-					record[RECORD_DATA_SIZE+1] = 1;
-					record[RECORD_DATA_START]  = current->index[count].boolean.true_false;
-					write(output_file,record,RECORD_DATA_START+1);
+					record.data_size = 1;
+					write_record(object,&record);
+
+					length[0] = current->index[count].boolean.true_false;
+					object_write(object,length,1);
 					break;
 
 				default:
@@ -237,12 +398,10 @@ static void output_atoms (int output_file, ATOM_INDEX* index)
  * Name : output_type
  * Desc : This function will output a type to the file.
  *--------------------------------------------------------------------------------*/
-static void	output_type(int output_file, ATOM_ATOMS atom_type, unsigned short api_id, unsigned short line_num, NAME* return_type, NAME* name, NAME* brief)
+static void	output_type(OBJECT_BUFFER* object, ATOM_ATOMS atom_type, unsigned int api_id, unsigned int line_num, NAME* return_type, NAME* name, NAME* brief)
 {
-	unsigned char	empty[] = {0x00,0x00};
-	unsigned char	length[2];
-	unsigned char	record[RECORD_DATA_START];
-	unsigned short	data_size = 0;
+	OBJECT_RECORD	record;
+	unsigned int	data_size = 0;
 	unsigned short	name_size = 0;
 	unsigned short	brief_size = 0;
 	unsigned short	return_size = 0;
@@ -265,208 +424,214 @@ static void	output_type(int output_file, ATOM_ATOMS atom_type, unsigned short ap
 	data_size = 2 + return_size + 2 + name_size + 2 + brief_size;
 
 	/* generic header for the function output */
-	record[RECORD_TYPE] = INTERMEDIATE_RECORD_TYPE;
-	record[RECORD_ATOM] = atom_type;
-	record[RECORD_GROUP  ] = (api_id & 0xff00) >> 8;
-	record[RECORD_GROUP+1] = api_id & 0xff;
-	record[RECORD_LINE_NUM  ] = (line_num & 0xff00) >> 8;
-	record[RECORD_LINE_NUM+1] = line_num & 0xff;
-	record[RECORD_BLOCK_NUM  ] = 0;
-	record[RECORD_BLOCK_NUM+1] = 0;
-	record[RECORD_DATA_SIZE  ] = (data_size & 0xff00) >> 8;
-	record[RECORD_DATA_SIZE+1] = data_size & 0xff;
-
-	write(output_file,record,RECORD_DATA_START);
-
-	write_string(output_file,return_type);
-	write_string(output_file,name);
-	write_string(output_file,brief);
+	record.type			= INTERMEDIATE_RECORD_TYPE;
+	record.atom			= atom_type;
+	record.group		= api_id;
+	record.line_number	= line_num;
+	record.block_number	= 0;
+	record.data_size	= data_size;
+
+	write_record(object,&record);
+
+	write_string(object,return_type);
+	write_string(object,name);
+	write_string(object,brief);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : output_empty
  * Desc : This function will output the empty record.
  *--------------------------------------------------------------------------------*/
-static void	output_empty(int output_file, ATOM_ATOMS atom)
+static void	output_empty(OBJECT_BUFFER* object, ATOM_ATOMS atom)
 {
-	unsigned char	record[RECORD_DATA_START];
+	OBJECT_RECORD	record;
 
 	/* generic header for the function output */
-	record[RECORD_TYPE] = INTERMEDIATE_RECORD_EMPTY;
-	record[RECORD_ATOM] = atom;
-	record[RECORD_GROUP  ] = 0;
-	record[RECORD_GROUP+1] = 0;
-	record[RECORD_LINE_NUM  ] = 0;
-	record[RECORD_LINE_NUM+1] = 0;
-	record[RECORD_BLOCK_NUM  ] = 0;
-	record[RECORD_BLOCK_NUM+1] = 0;
-	record[RECORD_DATA_SIZE  ] = 0;
-	record[RECORD_DATA_SIZE+1] = 0;
-
-	write(output_file,record,RECORD_DATA_START);
+	record.type			= INTERMEDIATE_RECORD_EMPTY;
+	record.atom			= atom;
+	record.group		= 0;
+	record.line_number	= 0;
+	record.block_number	= 0;
+	record.data_size	= 0;
+
+	write_record(object,&record);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : output_api_function
  * Desc : This function outputs the contents of the api function to the file.
  *--------------------------------------------------------------------------------*/
-static void	output_api_function(int output_file, API_FUNCTION* function, unsigned short group_id, unsigned short line_num)
+static void	output_api_function(OBJECT_BUFFER* object, API_FUNCTION* function, unsigned int group_id, unsigned int line_num)
 {
 	API_PARAMETER*	current_parameter = function->parameter_list;
 
-	output_type(output_file,ATOM_API,function->api_id,line_num,&function->return_type,&function->name,NULL);
+	output_type(object,ATOM_API,function->api_id,line_num,&function->return_type,&function->name,NULL);
 
 	while (current_parameter != NULL)
 	{
 		/* output the parameter */
-		output_type(output_file,ATOM_PARAMETER,function->api_id,line_num,&current_parameter->type,&current_parameter->name,&current_parameter->brief);
+		output_type(object,ATOM_PARAMETER,function->api_id,line_num,&current_parameter->type,&current_parameter->name,&current_parameter->brief);
 
 		current_parameter = current_parameter->next;
 	}
 
-	output_empty(output_file,ATOM_API);
+	output_empty(object,ATOM_API);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : output_lookup
  * Desc : This function will output a lookup table to the output file.
  *--------------------------------------------------------------------------------*/
-static void output_lookup (int output_file, LOOKUP_LIST* lookup_list, unsigned int type)
+static void output_lookup (OBJECT_BUFFER* object, LOOKUP_LIST* lookup_list, unsigned int type)
 {
 	unsigned int	count;
-	unsigned int	data_size;
-	unsigned char	record[RECORD_DATA_START];
-	LOOKUP_LIST*	current = lookup_list;
+	unsigned char	sizes[4];
+	OBJECT_RECORD	record;
+	LOOKUP_ITEM*	item;
 	
-	while (current != NULL)
+	for (count=0;count<lookup_list->num_items;count++)
 	{
-		for (count=0;count<current->num_items;count++)
-		{
-			record[RECORD_TYPE] = type;
-			record[RECORD_ATOM] = 0;
-			record[RECORD_GROUP      ] = (current->lookup[count].group_id & 0xff00) >> 8;
-			record[RECORD_GROUP+1    ] = current->lookup[count].group_id & 0xff;
-			record[RECORD_BLOCK_NUM  ] = 0;
-			record[RECORD_BLOCK_NUM+1] = 0;
-			record[RECORD_LINE_NUM   ] = (current->lookup[count].line_num & 0xff00) >> 8;
-			record[RECORD_LINE_NUM+1 ] = current->lookup[count].line_num & 0xff;
-		
-			if (type == INTERMEDIATE_RECORD_SAMPLE)
-			{
-				/* write the header */
-				data_size = current->lookup[count].name_length + current->lookup[count].payload_length + 4;
-	
-				record[RECORD_DATA_SIZE  ] = (data_size & 0xff00) >> 8;
-				record[RECORD_DATA_SIZE+1] = data_size & 0xff;
+		item = get_lookup(lookup_list,count);
 
-				write(output_file,record,RECORD_DATA_START);
-
-				/* write the data sizes */
-				record[0] = (current->lookup[count].name_length & 0xff00) >> 8;
-				record[1] = current->lookup[count].name_length & 0xff;
-				record[2] = (current->lookup[count].payload_length & 0xff00) >> 8;
-				record[3] = current->lookup[count].payload_length & 0xff;
-				write(output_file,record,4);
+		record.type			= type;
+		record.atom			= 0;
+		record.group		= item->group_id;
+		record.block_number	= 0;
+		record.line_number	= item->line_num;
+	
+		if (type == INTERMEDIATE_RECORD_SAMPLE)
+		{
+			/* write the header */
+			record.data_size = item->name_length + item->payload_length + 4;
+			write_record(object,&record);
+
+			/* write the data sizes */
+			sizes[0] = (item->name_length & 0xff00) >> 8;
+			sizes[1] = item->name_length & 0xff;
+			sizes[2] = (item->payload_length & 0xff00) >> 8;
+			sizes[3] = item->payload_length & 0xff;
+			object_write(object,sizes,4);
+
+			/* write the payload */	
+			object_write(object,item->name,item->name_length);
+			object_write(object,item->payload,item->payload_length);
+		}
+		else
+		{
+			/* write all other records */
+			record.data_size = item->name_length;
+			write_record(object,&record);
+			object_write(object,item->name,item->name_length);
 
-				/* write the payload */	
-				write(output_file,current->lookup[count].name,current->lookup[count].name_length);
-				write(output_file,current->lookup[count].payload,current->lookup[count].payload_length);
-			}
-			else
+			if (type == INTERMEDIATE_RECORD_API && item->payload != NULL)
 			{
-				/* write all other records */
-				data_size = current->lookup[count].name_length;
-				
-				record[RECORD_DATA_SIZE  ] = (data_size & 0xff00) >> 8;
-				record[RECORD_DATA_SIZE+1] = data_size & 0xff;
-
-				write(output_file,record,RECORD_DATA_START);
-				write(output_file,current->lookup[count].name,current->lookup[count].name_length);
-
-				if (type == INTERMEDIATE_RECORD_API && current->lookup[count].payload != NULL)
-				{
-					output_api_function(output_file,(API_FUNCTION*)current->lookup[count].payload,current->lookup[count].group_id,current->lookup[count].line_num);
-				}
+				output_api_function(object,(API_FUNCTION*)item->payload,item->group_id,item->line_num);
 			}
 		}
-
-		current = current->next;
 	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : generate_output
  * Desc : This function will create the object file that holds all the atoms
- *        that have been recovered from the input file.
+ *        that have been recovered from the input file. The object is built in
+ *        memory and then saved with a single write.
  *--------------------------------------------------------------------------------*/
-static unsigned int	generate_output(ATOM_INDEX* atom_index, char* filename, char* input_name)
+static unsigned int	generate_output(COMPILE_CONTEXT* context, char* filename, char* input_name)
 {
-	int				outfile;
 	unsigned int	in_size;
+	unsigned int	error;
 	unsigned int	result = 0;
+	unsigned int	content_hash;
+	OBJECT_BUFFER	object;
 	unsigned char	signature[4] = COMPILED_SOURCE_MAGIC;
 	time_t			now = time(NULL);
-	struct tm*		curr_time = gmtime(&now);
-	unsigned char	file_header[FILE_HEADER_SIZE];
+	struct tm		curr_time;
+	unsigned char	file_header[FILE_HASHED_HEADER_SIZE];
+
+	/* gmtime() uses a static buffer, so copy it out while holding the pool lock */
+	work_pool_lock();
+	curr_time = *gmtime(&now);
+	work_pool_unlock();
 	
-	if ((outfile = open(filename,WRITE_FILE_STATUS,WRITE_FILE_PERM)) != -1)
-	{
-		/* ok, we have created the output file */
-		file_header[0] = signature[0];
-		file_header[1] = signature[1];
-		file_header[2] = signature[2];
-		file_header[3] = signature[3];
-		file_header[4] = VERSION_MAJOR;
-		file_header[5] = VERSION_MINOR;
+	memset(&object,0,sizeof(OBJECT_BUFFER));
+	memset(file_header,0,FILE_HASHED_HEADER_SIZE);
 
-		/* time stamp the file */
-		file_header[FILE_DAY_OFF	  ] = (unsigned char) curr_time->tm_mday;
-		file_header[FILE_MONTH_OFF	  ] = (unsigned char) curr_time->tm_mon;
-		file_header[FILE_YEAR_OFF	  ] = (unsigned char) curr_time->tm_year;
-		file_header[FILE_HOUR_OFF	  ] = (unsigned char) curr_time->tm_hour;
-		file_header[FILE_MINUTE_OFF   ] = (unsigned char) curr_time->tm_min;
-		file_header[FILE_SECONDS_OFF  ] = (unsigned char) curr_time->tm_sec;
+	file_header[0] = signature[0];
+	file_header[1] = signature[1];
+	file_header[2] = signature[2];
+	file_header[3] = signature[3];
+	file_header[4] = VERSION_MAJOR;
+	file_header[5] = OBJECT_VERSION_MINOR;
 
-		/* put the number of records in the header */
-		in_size = g_group_lookup.num_items + atom_index->number_atoms;
-		file_header[FILE_NUMBER_RECORDS+0] = (unsigned char)((in_size & 0xff00) >>8);
-		file_header[FILE_NUMBER_RECORDS+1] = (unsigned char)(in_size & 0xff);
+	/* put the number of records in the header */
+	in_size = context->group_lookup.num_items + context->atoms.number_atoms;
+	file_header[FILE_NUMBER_RECORDS+0] = (unsigned char)((in_size & 0xff00) >>8);
+	file_header[FILE_NUMBER_RECORDS+1] = (unsigned char)(in_size & 0xff);
 
-		/* put the size of the input name in the header */
-		in_size = strlen(input_name);
-		file_header[FILE_NAME_START+0] = (unsigned char)((in_size & 0xff00) >>8);
-		file_header[FILE_NAME_START+1] = (unsigned char)(in_size & 0xff);
+	/* put the size of the input name in the header */
+	in_size = strlen(input_name);
+	file_header[FILE_NAME_START+0] = (unsigned char)((in_size & 0xff00) >>8);
+	file_header[FILE_NAME_START+1] = (unsigned char)(in_size & 0xff);
 
-		write(outfile,file_header,FILE_HEADER_SIZE);
-		write(outfile,input_name,in_size);
+	object_write(&object,file_header,FILE_HASHED_HEADER_SIZE);
+	object_write(&object,input_name,in_size);
 
-		/* dump the groups first */
-		output_lookup(outfile,&g_group_lookup,INTERMEDIATE_RECORD_GROUP);
+	/* dump the groups first */
+	output_lookup(&object,&context->group_lookup,INTERMEDIATE_RECORD_GROUP);
 
-		/* dump the functions next */
-		output_lookup(outfile,&g_functions,INTERMEDIATE_RECORD_FUNCTION);
+	/* dump the functions next */
+	output_lookup(&object,&context->functions,INTERMEDIATE_RECORD_FUNCTION);
 
-		/* dump the apis next */
-		output_lookup(outfile,&g_apis,INTERMEDIATE_RECORD_API);
+	/* dump the apis next */
+	output_lookup(&object,&context->apis,INTERMEDIATE_RECORD_API);
 
-		/* dump the apis next */
-		output_lookup(outfile,&g_samples,INTERMEDIATE_RECORD_SAMPLE);
-		
-		/* dump the apis next */
-		output_lookup(outfile,&g_applications,INTERMEDIATE_RECORD_APPLICATION);
+	/* dump the apis next */
+	output_lookup(&object,&context->samples,INTERMEDIATE_RECORD_SAMPLE);
+	
+	/* dump the apis next */
+	output_lookup(&object,&context->applications,INTERMEDIATE_RECORD_APPLICATION);
 
-		/* dump the atoms */
-		output_atoms (outfile,atom_index);
+	/* dump the atoms */
+	output_atoms (&object,&context->atoms);
 
-		result = 1;
+	if (object.failed == 0)
+	{
+		/* hash the object before the time stamp is added, so the same input gives the same hash */
+		content_hash = fnv_32_hash(object.data,object.used);
+
+		object.data[FILE_CONTENT_HASH+0] = (unsigned char)((content_hash & 0xff000000) >> 24);
+		object.data[FILE_CONTENT_HASH+1] = (unsigned char)((content_hash & 0x00ff0000) >> 16);
+		object.data[FILE_CONTENT_HASH+2] = (unsigned char)((content_hash & 0x0000ff00) >> 8);
+		object.data[FILE_CONTENT_HASH+3] = (unsigned char)((content_hash & 0x000000ff));
+
+		/* time stamp the file */
+		object.data[FILE_DAY_OFF	] = (unsigned char) curr_time.tm_mday;
+		object.data[FILE_MONTH_OFF	] = (unsigned char) curr_time.tm_mon;
+		object.data[FILE_YEAR_OFF	] = (unsigned char) curr_time.tm_year;
+		object.data[FILE_HOUR_OFF	] = (unsigned char) curr_time.tm_hour;
+		object.data[FILE_MINUTE_OFF	] = (unsigned char) curr_time.tm_min;
+		object.data[FILE_SECONDS_OFF] = (unsigned char) curr_time.tm_sec;
+	}
 
-		close(outfile);
+	if (object_unchanged(&object,filename))
+	{
+		/* the object is already up to date, leave it alone so that its time does not change.
+		 * the source has still been compiled to find this out, the skip only saves the write.
+		 */
+		result = 1;
+	}
+	else if ((error = object_save(&object,filename)) != EC_OK)
+	{
+		raise_warning(0,error,(unsigned char*)filename,NULL);
 	}
 	else
 	{
-		raise_warning(0,EC_FAILED_TO_OPEN_OUTPUT_FILE,(unsigned char*)filename,NULL);
+		result = 1;
 	}
 
+	free(object.data);
+
 	return result;
 }
 
@@ -480,6 +645,101 @@ static void init_atoms_index ( ATOM_INDEX* index )
 	index->last = &index->index;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : release_atoms_index
+ * Desc : This function will free the strings held in the atoms and the extra
+ *        atom blocks, and leave the index empty. They are all held in the arena
+ *        of the index.
+ *--------------------------------------------------------------------------------*/
+static void release_atoms_index ( ATOM_INDEX* index )
+{
+	arena_release(&index->arena);
+
+	init_atoms_index(index);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : release_api_functions
+ * Desc : This function will free the function descriptions that are held as the
+ *        payloads of the api lookup. The names are owned by the lookup items.
+ *--------------------------------------------------------------------------------*/
+static void release_api_functions ( LOOKUP_LIST* lookup_list )
+{
+	unsigned int	count;
+	API_FUNCTION*	function;
+	API_PARAMETER*	next;
+	API_PARAMETER*	current;
+
+	for (count=0; count < lookup_list->num_items; count++)
+	{
+		if ((function = (API_FUNCTION*) get_lookup(lookup_list,count)->payload) != NULL)
+		{
+			current = function->parameter_list;
+
+			while (current != NULL)
+			{
+				next = current->next;
+
+				free(current->name.name);
+				free(current->type.name);
+				free(current);
+
+				current = next;
+			}
+
+			free(function->return_type.name);
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : init_compile_context
+ * Desc : This function will set up the context for compiling a file of the
+ *        given input type.
+ *--------------------------------------------------------------------------------*/
+static void	init_compile_context(COMPILE_CONTEXT* context, unsigned int input_type)
+{
+	memset(context,0,sizeof(COMPILE_CONTEXT));
+
+	init_atoms_index(&context->atoms);
+
+	context->input_type				= input_type;
+	context->type_state				= TYPE_STATE_SEARCHING;
+	context->current_api			= INVALID_ITEM;
+	context->current_group			= DEFAULT_GROUP;
+	context->default_group			= DEFAULT_GROUP;
+	context->current_sample			= INVALID_ITEM;
+	context->current_function		= INVALID_ITEM;
+	context->current_application	= INVALID_ITEM;
+	context->looking_for_comment	= 1;
+	context->function_state			= FUNCTION_STATE_SEARCHING;
+
+	input_formats[input_type].reset(&context->source_state);
+
+	/* add a holder for the default group */
+	find_add_lookup(&context->group_lookup,(unsigned char*)"",0);
+
+	/* application 0 - means not defined so add a default */
+	find_add_lookup(&context->applications,(unsigned char*)"",0);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : release_compile_context
+ * Desc : This function will release everything that was collected from the
+ *        file that the context was used to compile.
+ *--------------------------------------------------------------------------------*/
+static void	release_compile_context(COMPILE_CONTEXT* context)
+{
+	release_atoms_index(&context->atoms);
+	release_api_functions(&context->apis);
+
+	release_lookup(&context->group_lookup);
+	release_lookup(&context->functions);
+	release_lookup(&context->apis);
+	release_lookup(&context->samples);
+	release_lookup(&context->applications);
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : add_parameter_brief
  * Desc : This function will add a parameter to the API. It will add the parameter
@@ -697,8 +957,9 @@ static ATOM_ITEM* add_atom ( ATOM_INDEX* list, unsigned int type, ATOM_ATOMS ato
 	if (list->last->num_items >= ATOM_BLOCK_SIZE)
 	{
 		/* need to increase the size of the index */
-		list->last->next = calloc(1,sizeof(ATOM_BLOCK));
+		list->last->next = arena_alloc(&list->arena,sizeof(ATOM_BLOCK));
 		list->last = list->last->next;
+		memset(list->last,0,sizeof(ATOM_BLOCK));
 	}
 
 	result = &list->last->index[list->last->num_items++];
@@ -716,10 +977,10 @@ static ATOM_ITEM* add_atom ( ATOM_INDEX* list, unsigned int type, ATOM_ATOMS ato
  * Name : add_name_atom
  * Desc : This function will add an atom_name item to the atom index.
  *--------------------------------------------------------------------------------*/
-static unsigned int add_name_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* atom_group, unsigned int atom_group_length, unsigned char* atom_name, unsigned int atom_name_length, unsigned int func_api )
+static unsigned int add_name_atom ( COMPILE_CONTEXT* context, ATOM_ATOMS atom, unsigned char* atom_group, unsigned int atom_group_length, unsigned char* atom_name, unsigned int atom_name_length, unsigned int func_api )
 {
 	unsigned int	result = EC_OK;
-	ATOM_ITEM*		item = add_atom(list,INTERMEDIATE_RECORD_NAME,atom);
+	ATOM_ITEM*		item = add_atom(&context->atoms,INTERMEDIATE_RECORD_NAME,atom);
 	
 	if (atom_group_length > 255)
 	{
@@ -734,7 +995,7 @@ static unsigned int add_name_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned
 		/* do we have a group */
 		if (atom_group != NULL)
 		{
-			item->name.group = find_add_lookup(&g_group_lookup,atom_group,atom_group_length);
+			item->name.group = find_add_lookup(&context->group_lookup,atom_group,atom_group_length);
 		}
 		else
 		{
@@ -743,9 +1004,8 @@ static unsigned int add_name_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned
 
 		/* set the atoms details */
 		item->name.func_api		= func_api;
-		item->name.name 		= malloc(atom_name_length);
+		item->name.name 		= arena_copy(&context->atoms.arena,atom_name,atom_name_length);
 		item->name.name_length	= atom_name_length;
-		memcpy(item->name.name,atom_name,atom_name_length);
 	}
 
 	return result;
@@ -771,10 +1031,9 @@ void add_string_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* string,
 	ATOM_ITEM*	item = add_atom(list,INTERMEDIATE_RECORD_STRING,atom);
 	
 	item->string.func_api		= func_api;
-	item->string.string			= malloc(string_length);
+	item->string.string			= arena_copy(&list->arena,string,string_length);
 	item->string.string_length	= string_length;
 	item->string.fixed			= 0;
-	memcpy(item->string.string,string,string_length);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -787,6 +1046,29 @@ void add_api_start_atom (ATOM_INDEX* list, unsigned char record_group_type, unsi
 	item->any.func_api	= group_id;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : arena_copy_name
+ * Desc : This function will copy a name into the arena. It is copy_name() for
+ *        the names that are held by the atoms.
+ *--------------------------------------------------------------------------------*/
+static void	arena_copy_name(ARENA* arena, NAME* from, NAME* to)
+{
+	if (from != NULL)
+	{
+		to->name = arena_copy(arena,from->name,from->name_length);
+		to->name_length = from->name_length;
+		to->fixed = from->fixed;
+		to->allocated_size = from->name_length;
+	}
+	else
+	{
+		to->name = NULL;
+		to->fixed = 0;
+		to->name_length = 0;
+		to->allocated_size = 0;
+	}
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : add_api_type_atom
  * Desc : This function will add the api type atom. This will add the type and
@@ -801,16 +1083,16 @@ void add_api_type_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, NAME* type, NAME* na
 {
 	ATOM_ITEM*	item = add_atom(list,INTERMEDIATE_RECORD_TYPE,atom);
 
-	copy_name(name,&item->type.name);
-	copy_name(type,&item->type.type_type);
-	copy_name(description,&item->type.description);
+	arena_copy_name(&list->arena,name,&item->type.name);
+	arena_copy_name(&list->arena,type,&item->type.type_type);
+	arena_copy_name(&list->arena,description,&item->type.description);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : add_api_end_atom
  * desc : This function adds the api end atom to the atom_list.
  *--------------------------------------------------------------------------------*/
-void add_api_end_atom (ATOM_INDEX* list, unsigned short group_id)
+void add_api_end_atom (ATOM_INDEX* list, unsigned int group_id)
 {
 	ATOM_ITEM*	item = add_atom(list,INTERMEDIATE_RECORD_END,0);
 	item->any.func_api = group_id;
@@ -821,14 +1103,15 @@ void add_api_end_atom (ATOM_INDEX* list, unsigned short group_id)
  * Desc : This function will add the multiline atom, it will trim the white space
  *        from the front and the end of the string.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_multiline_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* string, unsigned int string_length, unsigned int input_type, unsigned int* end_comment, unsigned int dont_trim)
+static unsigned int	add_multiline_atom ( COMPILE_CONTEXT* context, ATOM_ATOMS atom, unsigned char* string, unsigned int string_length, unsigned int* end_comment, unsigned int dont_trim)
 {
 	unsigned int	size = 0;
 	unsigned int	count;
 	unsigned int	found = dont_trim;
 	unsigned int	end = string_length;
 	unsigned int	start = 0;
-	ATOM_ITEM*		item = add_atom(list,INTERMEDIATE_RECORD_MULTILINE,atom);
+	unsigned int	input_type = context->input_type;
+	ATOM_ITEM*		item = add_atom(&context->atoms,INTERMEDIATE_RECORD_MULTILINE,atom);
 	
 	item->string.fixed = dont_trim;
 
@@ -838,7 +1121,7 @@ static unsigned int	add_multiline_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsi
 		{
 			start++;
 		}
-		else if (input_formats[input_type].end_comment(string,string_length,&count))
+		else if (input_formats[input_type].end_comment(&context->source_state,string,string_length,&count))
 		{
 			*end_comment = 1;
 			size = count - start - input_formats[input_type].end_of_line_comment_size;
@@ -861,11 +1144,9 @@ static unsigned int	add_multiline_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsi
 
 	size += dont_trim;
 
-	item->string.string			= malloc(size);
+	item->string.string			= arena_copy(&context->atoms.arena,&string[start],size);
 	item->string.string_length	= size;
 
-	memcpy(item->string.string,&string[start],size);
-
 	if (dont_trim)
 	{
 		/* need to add a linefeed to the end as this is fixed format */
@@ -901,16 +1182,14 @@ void add_pair_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* name, uns
 
 	if (name_length > 0)
 	{
-		item->pair.name				= malloc(name_length);
+		item->pair.name				= arena_copy(&list->arena,name,name_length);
 		item->pair.name_length		= name_length;
-		memcpy(item->pair.name,name,name_length);
 	}
 
 	if (string_length > 0)
 	{
-		item->pair.string			= malloc(string_length);
+		item->pair.string			= arena_copy(&list->arena,string,string_length);
 		item->pair.string_length	= string_length;
-		memcpy(item->pair.string,string,string_length);
 	}
 }
 
@@ -925,8 +1204,9 @@ void add_pair_atom ( ATOM_INDEX* list, ATOM_ATOMS atom, unsigned char* name, uns
  *  	  alpha_num_string.alpha_num_string
  *  	  $(alpha_num_string).alpha_num_string
  *--------------------------------------------------------------------------------*/
-static unsigned int decode_name(unsigned char* buffer, ATOM_INDEX* atom_list, ATOM_ATOMS atom, unsigned int function)
+static unsigned int decode_name(unsigned char* buffer, COMPILE_CONTEXT* context, ATOM_ATOMS atom, unsigned int function)
 {
+	ATOM_INDEX*		atom_list = &context->atoms;
 	unsigned int	result = EC_OK;
 	unsigned int	buff_pos;
 	unsigned int	item_length = 0;
@@ -943,7 +1223,7 @@ static unsigned int decode_name(unsigned char* buffer, ATOM_INDEX* atom_list, AT
 			{
 				if (atom == ATOM_STATE || atom == ATOM_TRIGGERS || atom == ATOM_TRIGGER || atom == ATOM_TIMELINE)
 				{
-					if ((result = add_name_atom(atom_list,atom,first_part,first_length,item_name,item_length,function)) != EC_OK)
+					if ((result = add_name_atom(context,atom,first_part,first_length,item_name,item_length,function)) != EC_OK)
 					{
 						raise_warning(atom_list->line_number,result,NULL,NULL);
 					}
@@ -974,7 +1254,7 @@ static unsigned int decode_name(unsigned char* buffer, ATOM_INDEX* atom_list, AT
 			{
 				if (atom == ATOM_STATE || atom == ATOM_TRIGGERS || atom == ATOM_TRIGGER || atom == ATOM_TIMELINE)
 				{
-					if ((result = add_name_atom(atom_list,atom,first_part,first_length,item_name,item_length,function)) != EC_OK)
+					if ((result = add_name_atom(context,atom,first_part,first_length,item_name,item_length,function)) != EC_OK)
 					{
 						raise_warning(atom_list->line_number,result,NULL,NULL);
 					}
@@ -994,7 +1274,7 @@ static unsigned int decode_name(unsigned char* buffer, ATOM_INDEX* atom_list, AT
 		else
 		{
 			/* add a simple item - no atom_group */
-			if ((result = add_name_atom(atom_list,atom,NULL,0,first_part,first_length,function)) != EC_OK)
+			if ((result = add_name_atom(context,atom,NULL,0,first_part,first_length,function)) != EC_OK)
 			{
 				raise_warning(atom_list->line_number,result,NULL,NULL);
 			}
@@ -1138,10 +1418,10 @@ static void decode_pair (unsigned char* buffer, unsigned int buffer_length, ATOM
  *        Actually there is not much to do, as the group will be all data on the
  *        line to the end, so just add it to the atom list.
  *--------------------------------------------------------------------------------*/
-static unsigned short decode_group (unsigned char* buffer, unsigned int buffer_length, ATOM_INDEX* atom_list, ATOM_ATOMS atom)
+static unsigned int decode_group (unsigned char* buffer, unsigned int buffer_length, COMPILE_CONTEXT* context, ATOM_ATOMS atom)
 {
 	unsigned int count;
-	unsigned short result;
+	unsigned int result;
 
 	/* trim any unsightly characters */
 	for (count=buffer_length-1;count>0 && buffer[count] < 0x0f ;count--)
@@ -1150,9 +1430,9 @@ static unsigned short decode_group (unsigned char* buffer, unsigned int buffer_l
 
 	buffer_length = count+1;
 								
-	result = find_add_lookup(&g_group_lookup,buffer,buffer_length);
+	result = find_add_lookup(&context->group_lookup,buffer,buffer_length);
 
-	add_number_atom(atom_list,atom,result,INVALID_ITEM);
+	add_number_atom(&context->atoms,atom,result,INVALID_ITEM);
 
 	return result;
 }
@@ -1163,10 +1443,10 @@ static unsigned short decode_group (unsigned char* buffer, unsigned int buffer_l
  *        Actually there is not much to do, as the application will be all data on the
  *        line to the end, so just add it to the atom list.
  *--------------------------------------------------------------------------------*/
-static unsigned short decode_application (unsigned char* buffer, unsigned int buffer_length)
+static unsigned int decode_application (unsigned char* buffer, unsigned int buffer_length, COMPILE_CONTEXT* context)
 {
 	unsigned int count;
-	unsigned short result;
+	unsigned int result;
 
 	/* trim any unsightly characters */
 	for (count=buffer_length-1;count>0 && buffer[count] < 0x0f ;count--)
@@ -1175,7 +1455,7 @@ static unsigned short decode_application (unsigned char* buffer, unsigned int bu
 
 	buffer_length = count+1;
 					
-	result = find_add_lookup(&g_applications,buffer,buffer_length);
+	result = find_add_lookup(&context->applications,buffer,buffer_length);
 
 	return result;
 }
@@ -1205,7 +1485,7 @@ static void	collect_sample(LOOKUP_ITEM *item, unsigned char* data, unsigned int
  * Desc : This function will parse the line and extract any atoms from it and add
  *        them to the atom list.
  *--------------------------------------------------------------------------------*/
-static unsigned int parse_line ( unsigned char* line, unsigned int line_length, ATOM_INDEX* atom_list, unsigned int input_type )
+static unsigned int parse_line ( COMPILE_CONTEXT* context, unsigned char* line, unsigned int line_length )
 {
 	unsigned int			err = EC_OK;
 	unsigned int			pos = 0;
@@ -1220,88 +1500,69 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 	unsigned int			sample_start = 0;
 	unsigned int			comment_end = 0;
 	unsigned int			collect_start = 0;
+	unsigned int			input_type = context->input_type;
 	NAME					name;
 	API_FUNCTION*			temp;
-	static NAME				return_type;
-	static NAME				function_name;
-	static unsigned int		g_ignore = 0;
-	static unsigned int		g_multiline = 0;
-	static unsigned char	g_type_state = TYPE_STATE_SEARCHING;
-	static unsigned int		g_in_function = 0;
-	static unsigned int		g_current_api = INVALID_ITEM;
-	static unsigned int		g_current_group = DEFAULT_GROUP;
-	static unsigned int		g_in_file_block = 0;
-	static unsigned short	g_default_group = DEFAULT_GROUP;
-	static unsigned int		g_current_sample = INVALID_ITEM;
-	static unsigned int		g_current_function = INVALID_ITEM;
-	static unsigned int		g_current_application = INVALID_ITEM;
-	static unsigned char	g_looking_for_type = 0;
-	static unsigned int		g_waiting_to_collect = 0;
-	static unsigned char	g_collecting_sample = 0;
-	static unsigned char	g_looking_for_comment = 1;
-	static unsigned char	g_looking_for_globals = 0;
-	static unsigned char	g_looking_for_function = 0;
-	static unsigned char	g_looking_for_constants = 0;
-	static unsigned char	g_function_state = FUNCTION_STATE_SEARCHING;
+	ATOM_INDEX*				atom_list = &context->atoms;
 
 	/* must be more then one char before the end of the line */
 	while(pos < line_length)
 	{
 		pos = remove_white_space(pos,line);
 	
-		if (g_looking_for_comment)
+		if (context->looking_for_comment)
 		{
 			/* find the comment start */
-			if ((comment_type = input_formats[input_type].find_comment(line,line_length,&pos)))
+			if ((comment_type = input_formats[input_type].find_comment(&context->source_state,line,line_length,&pos)))
 			{
 				if (comment_type == 1)
 				{
 					/* we need to skip the contents of this comment */
-					g_looking_for_comment = 0;
-					g_ignore = 1;
+					context->looking_for_comment = 0;
+					context->ignore = 1;
 				}
 				else if (comment_type == 2)
 				{
-					if (g_looking_for_function && g_function_state != FUNCTION_STATE_BODY)
+					if (context->looking_for_function && context->function_state != FUNCTION_STATE_BODY)
 					{
 						result = EC_FOUND_COMMENT_EXPECTING_FUNCTION;
 						raise_warning(atom_list->line_number,result,NULL,NULL);
 					}
 
 					/* we have found the comment we are looking for */
-					g_current_group = g_default_group;
-					g_looking_for_comment = 0;
+					context->current_group = context->default_group;
+					context->looking_for_comment = 0;
 					atom_list->block_count++;
 				}
 			}
-			else if (g_looking_for_constants)
+			else if (context->looking_for_constants)
 			{
 				/* decode the constants */
-				if (input_formats[input_type].decode_constant(line,line_length,&pos,g_current_group,atom_list) == 2)
+				if (input_formats[input_type].decode_constant(&context->source_state,line,line_length,&pos,context->current_group,atom_list) == 2)
 				{
 					result = EC_FAILED_TO_FIND_CONSTANT;
 					raise_warning(atom_list->line_number,result,NULL,NULL);
 				}
 			}
-			else if (g_looking_for_type)
+			else if (context->looking_for_type)
 			{
-				switch(g_type_state)
+				switch(context->type_state)
 				{
 					case TYPE_STATE_SEARCHING:
-						if ((g_type_state = input_formats[input_type].decode_type(line,line_length,&pos,g_current_group,atom_list)) == TYPE_STATE_FINISHED)
+						if ((context->type_state = input_formats[input_type].decode_type(&context->source_state,line,line_length,&pos,context->current_group,atom_list)) == TYPE_STATE_FINISHED)
 						{
 							/* we have finished getting the type - end it.
 							 * This also gives us time to collect the last of the comments that follow the type.
 							 */
-							add_api_end_atom(atom_list,g_current_group);
-							g_type_state = TYPE_STATE_SEARCHING;
-							g_looking_for_type = 0;
+							add_api_end_atom(atom_list,context->current_group);
+							context->type_state = TYPE_STATE_SEARCHING;
+							context->looking_for_type = 0;
 						}
 						break;
 
 					case TYPE_STATE_FAILED:
-						g_function_state = TYPE_STATE_SEARCHING;
-						g_looking_for_type = 0;
+						context->function_state = TYPE_STATE_SEARCHING;
+						context->looking_for_type = 0;
 						
 						result = EC_FAILED_TO_FIND_TYPE;
 						raise_warning(atom_list->line_number,result,NULL,NULL);
@@ -1311,106 +1572,106 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						result = EC_INTERNAL_STATE_ERROR;
 						raise_warning(atom_list->line_number,result,NULL,NULL);
 						
-						g_function_state = TYPE_STATE_SEARCHING;
+						context->function_state = TYPE_STATE_SEARCHING;
 				}
 			}
-			else if (g_looking_for_function)
+			else if (context->looking_for_function)
 			{
-				switch(g_function_state)
+				switch(context->function_state)
 				{
 					case FUNCTION_STATE_SEARCHING:
-						if ((g_function_state = input_formats[input_type].function_start(line,line_length,&pos,&return_type,&function_name)) == FUNCTION_STATE_PARAMETERS)
+						if ((context->function_state = input_formats[input_type].function_start(&context->source_state,line,line_length,&pos,&context->return_type,&context->function_name)) == FUNCTION_STATE_PARAMETERS)
 						{
-							if (g_current_function != -1)
+							if (context->current_function != -1)
 							{
-								if (g_functions.lookup[g_current_function].name_length > 0)
+								if (get_lookup(&context->functions,context->current_function)->name_length > 0)
 								{
 									result = EC_DUPLICATE_NAME;
-									raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+									raise_warning(atom_list->line_number,result,get_lookup(&context->functions,context->current_function)->name,NULL);
 								}
-								else if (find_lookup(&g_functions,function_name.name,function_name.name_length) != NULL)
+								else if (find_lookup(&context->functions,context->function_name.name,context->function_name.name_length) != NULL)
 								{
 									result = EC_DUPLICATE_FUNCTION;
-									raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+									raise_warning(atom_list->line_number,result,get_lookup(&context->functions,context->current_function)->name,NULL);
 								}
 								else
 								{
 									/* found the function specification now add the function return type and the name */
-									set_lookup_name(&g_functions.lookup[g_current_function],&function_name,atom_list->line_number);
+									set_lookup_name(&context->functions,context->current_function,&context->function_name,atom_list->line_number);
 								}
 							}
 
-							if (g_current_api != -1)
+							if (context->current_api != -1)
 							{
-								if (g_apis.lookup[g_current_api].name_length > 0)
+								if (get_lookup(&context->apis,context->current_api)->name_length > 0)
 								{
 									result = EC_DUPLICATE_NAME;
-									raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+									raise_warning(atom_list->line_number,result,get_lookup(&context->apis,context->current_api)->name,NULL);
 								}
-								else if (find_lookup(&g_apis,function_name.name,function_name.name_length) != NULL)
+								else if (find_lookup(&context->apis,context->function_name.name,context->function_name.name_length) != NULL)
 								{
 									result = EC_DUPLICATE_FUNCTION;
-									raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+									raise_warning(atom_list->line_number,result,get_lookup(&context->apis,context->current_api)->name,NULL);
 								}
 								else
 								{
 									/* found the function specification now add the function return type and the name */
-									set_lookup_name(&g_apis.lookup[g_current_api],&function_name,atom_list->line_number);
-									set_lookup_group(&g_apis.lookup[g_current_api],g_current_group);
+									set_lookup_name(&context->apis,context->current_api,&context->function_name,atom_list->line_number);
+									set_lookup_group(get_lookup(&context->apis,context->current_api),context->current_group);
 
 									/* set the function headers */
-									temp = (API_FUNCTION*)g_apis.lookup[g_current_api].payload;
-									temp->name.name = g_apis.lookup[g_current_api].name;
-									temp->name.name_length = g_apis.lookup[g_current_api].name_length;
-									memcpy(&((API_FUNCTION*)g_apis.lookup[g_current_api].payload)->return_type,&return_type,sizeof(NAME));
+									temp = (API_FUNCTION*)get_lookup(&context->apis,context->current_api)->payload;
+									temp->name.name = get_lookup(&context->apis,context->current_api)->name;
+									temp->name.name_length = get_lookup(&context->apis,context->current_api)->name_length;
+									copy_name(&context->return_type,&temp->return_type);
 								}
 							}
 						}
 						break;
 
 					case FUNCTION_STATE_PARAMETERS:
-						g_function_state = input_formats[input_type].find_parameter(line,line_length,&pos,&return_type,&function_name,&found);
-						if (found && g_current_api != -1)
+						context->function_state = input_formats[input_type].find_parameter(&context->source_state,line,line_length,&pos,&context->return_type,&context->function_name,&found);
+						if (found && context->current_api != -1)
 						{
 							/* found a parameter, time to add the atom for it */
-							if (add_parameter_type(	(API_FUNCTION*)g_apis.lookup[g_current_api].payload,
-													&function_name,
-													&return_type) != EC_PARAMETER_ADDED)
+							if (add_parameter_type(	(API_FUNCTION*)get_lookup(&context->apis,context->current_api)->payload,
+													&context->function_name,
+													&context->return_type) != EC_PARAMETER_ADDED)
 							{
 								result = EC_DUPLICATE_PARAMETER;
-								raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+								raise_warning(atom_list->line_number,result,get_lookup(&context->apis,context->current_api)->name,NULL);
 							}
 						}
 						break;
 					
 					case FUNCTION_STATE_BODY:
-						g_in_function == 1;
+						context->in_function == 1;
 
-						if (input_formats[input_type].start_level(line,line_length,&pos))
+						if (input_formats[input_type].start_level(&context->source_state,line,line_length,&pos))
 						{
 						}
-						else if (input_formats[input_type].end_level(line,line_length,&pos))
+						else if (input_formats[input_type].end_level(&context->source_state,line,line_length,&pos))
 						{
 						}
 						
-						if (input_formats[input_type].function_end(line,line_length,&pos))
+						if (input_formats[input_type].function_end(&context->source_state,line,line_length,&pos))
 						{
 							/* found the function end - end the function */
-							g_in_function = 0;
-							g_looking_for_function = 0;
-							g_function_state = FUNCTION_STATE_SEARCHING;
+							context->in_function = 0;
+							context->looking_for_function = 0;
+							context->function_state = FUNCTION_STATE_SEARCHING;
 
-							g_current_function = INVALID_ITEM;
-							g_current_api = INVALID_ITEM;
+							context->current_function = INVALID_ITEM;
+							context->current_api = INVALID_ITEM;
 						}
 						break;
 
 					default:
 						result = EC_FAILED_TO_FIND_FUNCTION;
-						raise_warning(atom_list->line_number,result,g_functions.lookup[g_current_function].name,NULL);
+						raise_warning(atom_list->line_number,result,get_lookup(&context->functions,context->current_function)->name,NULL);
 						
-						g_function_state = FUNCTION_STATE_SEARCHING;
-						g_looking_for_function = 0;
+						context->function_state = FUNCTION_STATE_SEARCHING;
+						context->looking_for_function = 0;
 						break;
 				}
 			}
@@ -1419,7 +1680,7 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 				pos++;
 			}
 		}
-		else if (g_ignore == 0 && line[pos] == g_marker)
+		else if (context->ignore == 0 && line[pos] == g_marker)
 		{
 			if (line[pos+1] == g_marker)
 			{
@@ -1429,7 +1690,7 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 			else if ((atom = atoms_check_word(&line[pos+1])) != -1)
 			{
 				/* found an atom */
-				g_multiline = 0;
+				context->multiline = 0;
 				pos += atoms_get_length(atom) + 1;
 
 				if (pos < line_length && line[pos] != ':' && line[pos] != 0x09 && line[pos] != 0x20 && line[pos] != 0x0a && line[pos] != 0x0d)
@@ -1448,7 +1709,7 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 					/* detach end of line comments. */
 					{
 						unsigned int temp = line_length-input_formats[input_type].end_of_line_comment_size;
-						if (input_formats[input_type].end_comment(line,line_length,&temp))
+						if (input_formats[input_type].end_comment(&context->source_state,line,line_length,&temp))
 						{
 							line_length -= input_formats[input_type].end_of_line_comment_size;
 							comment_end = 1;
@@ -1461,13 +1722,13 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 				{
 					/* handle ingore atom - this is special as it ends the comment block */
 					case ATOM_IGNORE:
-						if (g_multiline)
+						if (context->multiline)
 						{
-							g_multiline = 0;
-							add_atom(atom_list,INTERMEDIATE_RECORD_EMPTY,g_multiline);
+							context->multiline = 0;
+							add_atom(atom_list,INTERMEDIATE_RECORD_EMPTY,context->multiline);
 						}
 						
-						g_ignore = 1;
+						context->ignore = 1;
 						break;
 
 					/* handle atoms that take a name */
@@ -1475,12 +1736,12 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 					case ATOM_STATE:
 					case ATOM_TIMELINE:
 					case ATOM_ACTIVATION:
-						if (g_looking_for_function)
+						if (context->looking_for_function)
 						{
 							result = EC_CANNOT_CALL_HAVE_THESE_ATOMS_IN_A_FUNCTION;
 							raise_warning(atom_list->line_number,result,NULL,NULL);
 						}
-						else if ((err = decode_name(&line[pos],atom_list,atom,INVALID_ITEM)) != EC_OK)
+						else if ((err = decode_name(&line[pos],context,atom,INVALID_ITEM)) != EC_OK)
 						{
 							result = err;
 						}
@@ -1493,9 +1754,9 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 							result = EC_FILE_BLOCK_NOT_FIRST_BLOCK;
 							raise_warning(atom_list->line_number,result,NULL,NULL);
 						}
-						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| g_current_function));
+						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| context->current_function));
 
-						g_in_file_block = 1;
+						context->in_file_block = 1;
 						break;
 
 					/* name atoms */
@@ -1508,7 +1769,7 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 					case ATOM_TRIGGER:
 					case ATOM_TRIGGERS:
 					case ATOM_RESPONDS:
-						if ((err = decode_name(&line[pos],atom_list,atom,(RECORD_FUNCTION_FLAG| g_current_function))) != EC_OK)
+						if ((err = decode_name(&line[pos],context,atom,(RECORD_FUNCTION_FLAG| context->current_function))) != EC_OK)
 						{
 							/*TODO: decode name needs to change POS so that we dont search the same chars more than once */
 							result = err;
@@ -1516,16 +1777,16 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						break;
 
 					case ATOM_GROUP:
-						g_current_group = decode_group(&line[pos],line_length-pos,atom_list,atom);
+						context->current_group = decode_group(&line[pos],line_length-pos,context,atom);
 
-						if (g_in_file_block)
+						if (context->in_file_block)
 						{
-							g_default_group = g_current_group;
+							context->default_group = context->current_group;
 						}
 						break;
 					
 					case ATOM_SAMPLE:
-						if (g_collecting_sample == 1)
+						if (context->collecting_sample == 1)
 						{
 							result = EC_MULTIPLE_SAMPLES_WITHOUT_END;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
@@ -1533,34 +1794,34 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						else
 						{
 							decode_name_string(&line[pos],line_length-pos,&name);
-							g_current_sample = new_lookup(&g_samples);
-							set_lookup_name(&g_samples.lookup[g_current_sample],&name,atom_list->line_number);
+							context->current_sample = new_lookup(&context->samples);
+							set_lookup_name(&context->samples,context->current_sample,&name,atom_list->line_number);
 							
-							g_waiting_to_collect = 1;
+							context->waiting_to_collect = 1;
 						}
 						break;
 
 					case ATOM_END_SAMPLE:
-						if (g_collecting_sample == 0)
+						if (context->collecting_sample == 0)
 						{
 							result = EC_END_SAMPLE_WITHOUT_START;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
 						else
 						{
-							g_collecting_sample = 0;
-							g_waiting_to_collect = 0;
+							context->collecting_sample = 0;
+							context->waiting_to_collect = 0;
 						}
 						break;
 
 					/* go find the language dependant constants */
 					case ATOM_CONSTANTS:
-						if (g_looking_for_constants == 1)
+						if (context->looking_for_constants == 1)
 						{
 							result = EC_MULTIPLE_CONSTANTS_REQUEST_WITHOUT_END;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
-						else if (g_in_function)
+						else if (context->in_function)
 						{
 							result = EC_CANNOT_CALL_HAVE_THESE_ATOMS_IN_A_FUNCTION;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
@@ -1568,12 +1829,12 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						else
 						{
 							add_atom(atom_list,INTERMEDIATE_RECORD_EMPTY,atom);
-							g_looking_for_constants = 1;
+							context->looking_for_constants = 1;
 						}
 						break;
 
 					case ATOM_END_CONSTANTS:
-						if (g_looking_for_constants == 0)
+						if (context->looking_for_constants == 0)
 						{
 							result = EC_END_CONSTANTS_WITHOUT_START;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
@@ -1581,31 +1842,31 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						else
 						{
 							add_atom(atom_list,INTERMEDIATE_RECORD_EMPTY,atom);
-							g_looking_for_constants = 0;
+							context->looking_for_constants = 0;
 						}
 						break;
 
 					/* need to collect the type from the file */
 					case ATOM_TYPE:
-						if (g_looking_for_type != 0)
+						if (context->looking_for_type != 0)
 						{
 							result = EC_MULTIPLE_TYPE_REQUESTS_WITHOUT_TYPE;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
-						else if (g_in_function)
+						else if (context->in_function)
 						{
 							result = EC_CANNOT_CALL_HAVE_THESE_ATOMS_IN_A_FUNCTION;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
 						else
 						{
-							g_looking_for_type = 1;
+							context->looking_for_type = 1;
 						}
 						break;
 
 					/* add an application lookup */
 					case ATOM_APPLICATION:
-						g_current_application = decode_application(&line[pos],line_length-pos);
+						context->current_application = decode_application(&line[pos],line_length-pos,context);
 						break;
 
 					/* function or API atom, starts a function lookup and a creates a function/api */
@@ -1616,17 +1877,17 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 						else
 							mask = 0x10;
 
-						if ((g_looking_for_function & mask) != 0)
+						if ((context->looking_for_function & mask) != 0)
 						{
 							result = EC_MULTIPLE_FUNCTION_ATOMS_WITHOUT_FUNCTION;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
-						else if (g_in_function)
+						else if (context->in_function)
 						{
 							result = EC_NESTED_FUNCTION_DEFINITIONS_NOT_ALLOWED;
 							raise_warning(atom_list->line_number,result,&line[pos],NULL);
 						}
-						else if (find_lookup(&g_functions,&line[pos],line_length-pos) != NULL)
+						else if (find_lookup(&context->functions,&line[pos],line_length-pos) != NULL)
 						{
 							/* multiple definition of function has been found */
 							result = EC_MULTIPLE_DEFINITIONS_OF_FUNCTION;
@@ -1637,33 +1898,33 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 							/* create the new api/function but don't set the name until the function header is found */
 							if (atom == ATOM_API)
 							{
-								g_current_api = new_lookup(&g_apis);
-								g_apis.lookup[g_current_api].payload = calloc(1,sizeof(API_FUNCTION));
-								((API_FUNCTION*)g_apis.lookup[g_current_api].payload)->api_id = g_current_api;
-								add_number_atom(atom_list,atom,g_current_api,INVALID_ITEM);
+								context->current_api = new_lookup(&context->apis);
+								get_lookup(&context->apis,context->current_api)->payload = calloc(1,sizeof(API_FUNCTION));
+								((API_FUNCTION*)get_lookup(&context->apis,context->current_api)->payload)->api_id = context->current_api;
+								add_number_atom(atom_list,atom,context->current_api,INVALID_ITEM);
 							}
 							else
 							{
-								g_current_function = new_lookup(&g_functions);
+								context->current_function = new_lookup(&context->functions);
 							}
-							g_looking_for_function |= mask;
+							context->looking_for_function |= mask;
 						}
 						break;
 					
 					case ATOM_SYNOPSIS:
-							/* TODO: pos += */ decode_pair(&line[pos],line_length-pos,atom_list,atom,g_current_application);
+							/* TODO: pos += */ decode_pair(&line[pos],line_length-pos,atom_list,atom,context->current_application);
 						break;
 
 					case ATOM_RETURNS:
 					case ATOM_PARAMETER:
-						if (g_in_function)
+						if (context->in_function)
 						{
 							result = EC_CANNOT_CALL_HAVE_THESE_ATOMS_IN_A_FUNCTION;
 							raise_warning(atom_list->line_number,result,NULL,NULL);
 						}
 						else 
 						{
-							/* TODO: pos += */ decode_pair(&line[pos],line_length-pos,atom_list,atom,g_current_api);
+							/* TODO: pos += */ decode_pair(&line[pos],line_length-pos,atom_list,atom,context->current_api);
 						}
 						break;
 					
@@ -1679,33 +1940,33 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 							atom = ATOM_DESCRIPTION;
 						}
 
-						g_multiline = atom + 1;
+						context->multiline = atom + 1;
 						comment_end = 0;
 
-						fixed = input_formats[input_type].trim_multiline(line,line_length,&pos);
-						pos += add_multiline_atom(atom_list,g_multiline-1,&line[pos],line_length-pos,input_type,&comment_end,fixed);
+						fixed = input_formats[input_type].trim_multiline(&context->source_state,line,line_length,&pos);
+						pos += add_multiline_atom(context,context->multiline-1,&line[pos],line_length-pos,&comment_end,fixed);
 
 						if (comment_end)
 						{
-							g_multiline = 0;
-							g_looking_for_comment = 1;
+							context->multiline = 0;
+							context->looking_for_comment = 1;
 						}
 						break;
 
 					/* string atom, that have a multiline follower */
 					case ATOM_SECTION:
 					case ATOM_SUBSECTION:
-						g_multiline = atom + 1;
+						context->multiline = atom + 1;
 						comment_end = 0;
 
-						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,g_current_application);
+						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,context->current_application);
 						break;
 					
 					/* string atoms for applications */	
 					case ATOM_VALUE:
 					case ATOM_OPTION:
 					case ATOM_COMMAND:
-						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,g_current_application);
+						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,context->current_application);
 						break;
 
 					/* string atoms */
@@ -1713,12 +1974,12 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 					case ATOM_AUTHOR:
 					case ATOM_REPEATS:
 					case ATOM_CONDITION:
-						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| g_current_function));
+						pos += decode_string(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| context->current_function));
 						break;
 
 					case ATOM_MULTIPLE:
 					case ATOM_REQUIRED:
-						pos += decode_boolean(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| g_current_application));
+						pos += decode_boolean(&line[pos],line_length-pos,atom_list,atom,(RECORD_FUNCTION_FLAG| context->current_application));
 						break;
 
 					default:	
@@ -1731,10 +1992,10 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 				if (comment_end)
 				{
 					/* ok, the comment block has come to an end */
-					g_ignore = 0;
-					g_multiline = 0;
-					g_in_file_block = 0;
-					g_looking_for_comment = 1;
+					context->ignore = 0;
+					context->multiline = 0;
+					context->in_file_block = 0;
+					context->looking_for_comment = 1;
 				}
 				break;
 			}
@@ -1746,26 +2007,26 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 				break;
 			}
 		}
-		else if (input_formats[input_type].end_comment(line,line_length,&pos))
+		else if (input_formats[input_type].end_comment(&context->source_state,line,line_length,&pos))
 		{
-			g_ignore = 0;
-			g_multiline = 0;
-			g_in_file_block = 0;
-			g_looking_for_comment = 1;
+			context->ignore = 0;
+			context->multiline = 0;
+			context->in_file_block = 0;
+			context->looking_for_comment = 1;
 		
 			comment_end = 1;
 		}
-		else if (g_ignore == 0 && g_multiline)
+		else if (context->ignore == 0 && context->multiline)
 		{
 			/* trim the multiline comments down */
-			fixed = input_formats[input_type].trim_multiline(line,line_length,&pos);
-			pos += add_multiline_atom(atom_list,g_multiline-1,&line[pos],line_length-pos,input_type,&comment_end,fixed);
+			fixed = input_formats[input_type].trim_multiline(&context->source_state,line,line_length,&pos);
+			pos += add_multiline_atom(context,context->multiline-1,&line[pos],line_length-pos,&comment_end,fixed);
 			
 			if (comment_end)
 			{
-				g_multiline = 0;
-				g_in_file_block = 0;
-				g_looking_for_comment = 1;
+				context->multiline = 0;
+				context->in_file_block = 0;
+				context->looking_for_comment = 1;
 			}
 		}
 		else
@@ -1776,14 +2037,340 @@ static unsigned int parse_line ( unsigned char* line, unsigned int line_length,
 	}
 	
 	/* see if a sample jar is open and collect the sample */
-	if (g_waiting_to_collect && comment_end)
+	if (context->waiting_to_collect && comment_end)
 	{
-		g_collecting_sample = 1;
-		g_waiting_to_collect = 0;
+		context->collecting_sample = 1;
+		context->waiting_to_collect = 0;
 	}
-	else if (g_collecting_sample)
+	else if (context->collecting_sample)
 	{
-		collect_sample(&g_samples.lookup[g_current_sample],line,real_eol);
+		collect_sample(get_lookup(&context->samples,context->current_sample),line,real_eol);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : object_file_name
+ * Desc : This function will make the name of the object file for an input file
+ *        in a batch. The object is the input file name with ".pdso" added, and
+ *        is placed in the output directory if one was given.
+ *--------------------------------------------------------------------------------*/
+static char*	object_file_name(char* output_directory, char* input_name)
+{
+	char*			result = NULL;
+	char*			base_name = input_name;
+	unsigned int	length = 0;
+	unsigned int	dir_length = 0;
+
+	if (output_directory != NULL)
+	{
+		if ((base_name = strrchr(input_name,DIR_DELIMETER)) == NULL)
+		{
+			base_name = input_name;
+		}
+		else
+		{
+			base_name++;
+		}
+
+		dir_length = strlen(output_directory);
+	}
+
+	length = strlen(base_name);
+
+	if ((dir_length + length + 6) < MAX_FILENAME && (result = malloc(dir_length + length + 7)) != NULL)
+	{
+		if (dir_length > 0)
+		{
+			memcpy(result,output_directory,dir_length);
+
+			if (output_directory[dir_length-1] != DIR_DELIMETER)
+			{
+				result[dir_length++] = DIR_DELIMETER;
+			}
+		}
+
+		memcpy(&result[dir_length],base_name,length);
+		memcpy(&result[dir_length+length],".pdso",6);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : skip_source
+ * Desc : This function will skip the lines of the source that cannot change the
+ *        state of the parser. Outside of a comment only a line that holds the
+ *        start of a comment matters, and inside a comment that is being ignored
+ *        only a line that holds the end of the comment matters. Any other state
+ *        needs every line. It returns the offset of the next line to parse and
+ *        counts the lines that were skipped.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	skip_source(COMPILE_CONTEXT* context, unsigned char* data, unsigned int size, unsigned int offset)
+{
+	unsigned int	end;
+	unsigned int	result = offset;
+	unsigned char	search = 0;
+	unsigned char*	found;
+
+	if (context->collecting_sample == 0 && context->waiting_to_collect == 0)
+	{
+		if (context->looking_for_comment)
+		{
+			if (context->looking_for_constants == 0 && context->looking_for_type == 0 && context->looking_for_function == 0)
+			{
+				search = input_formats[context->input_type].comment_start;
+			}
+		}
+		else if (context->ignore)
+		{
+			search = input_formats[context->input_type].comment_end;
+		}
+	}
+
+	if (search != 0)
+	{
+		if ((found = memchr(&data[offset],search,size - offset)) == NULL)
+		{
+			end = size;
+		}
+		else
+		{
+			end = found - data;
+
+			/* back up to the start of the line that holds the character */
+			while (end > offset && data[end-1] != '\n')
+			{
+				end--;
+			}
+		}
+
+		/* count the lines that are being skipped */
+		while ((found = memchr(&data[result],'\n',end - result)) != NULL)
+		{
+			context->atoms.line_number++;
+			result = (found - data) + 1;
+		}
+
+		result = end;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : compile_file
+ * Desc : This function will compile the input file and write the object file.
+ *        It returns EC_OK if the object file was written. The file is compiled
+ *        in its own context so that files can be compiled at the same time.
+ *
+ *        The input file is mapped and only the lines that can change the state
+ *        of the parser are copied out and passed to parse_line().
+ *--------------------------------------------------------------------------------*/
+static unsigned int	compile_file(char* infile_name, char* output_filename)
+{
+	unsigned int		offset = 0;
+	unsigned int		result = EC_FAILED;
+	unsigned int		failed = 0;
+	unsigned int		linesize = 0;
+	unsigned int		buffer_size = 0;
+	unsigned int		input_file_type;
+	unsigned char*		line_end;
+	unsigned char*		line_buffer = NULL;
+	FILE_MAP			file_map;
+	COMPILE_CONTEXT*	context;
+
+	g_input_filename = infile_name;
+
+	if ((input_file_type = input_decode_format((unsigned char*)infile_name)) == INPUT_FORMAT_INVALID)
+	{
+		/* A file type that we don't support */
+		raise_warning(0,EC_UNSUPPORTED_INPUT_FILE,(unsigned char*)infile_name,NULL);
+	}
+	else if (map_input_file(infile_name,&file_map) != EC_OK)
+	{
+		raise_warning(0,EC_FAILED_TO_OPEN_INPUT_FILE,(unsigned char*)infile_name,NULL);
+	}
+	else
+	{
+		if ((context = malloc(sizeof(COMPILE_CONTEXT))) != NULL)
+		{
+			init_compile_context(context,input_file_type);
+
+			while (offset < file_map.size && (offset = skip_source(context,file_map.data,file_map.size,offset)) < file_map.size)
+			{
+				context->atoms.line_number++;
+
+				if ((line_end = memchr(&file_map.data[offset],'\n',file_map.size - offset)) == NULL)
+				{
+					linesize = file_map.size - offset;
+				}
+				else
+				{
+					linesize = line_end - &file_map.data[offset];
+				}
+
+				if (linesize > 0)
+				{
+					/* the parser expects the line to be terminated the same way as getline() did */
+					if (linesize + 2 > buffer_size)
+					{
+						buffer_size = linesize + 2 + LINE_BUFFER_BLOCK_SIZE;
+						free(line_buffer);
+
+						if ((line_buffer = malloc(buffer_size)) == NULL)
+						{
+							buffer_size = 0;
+							failed = 1;
+						}
+					}
+
+					if (line_buffer != NULL)
+					{
+						memcpy(line_buffer,&file_map.data[offset],linesize);
+						line_buffer[linesize] = '\n';
+						line_buffer[linesize+1] = '\0';
+
+						if (parse_line(context,line_buffer,linesize) != EC_OK)
+						{
+							raise_warning(context->atoms.line_number,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)infile_name,NULL);
+							failed = 1;
+						}
+					}
+				}
+
+				offset += linesize + 1;
+			}
+
+			free(line_buffer);
+
+			if (failed == 0 && generate_output(context,output_filename,infile_name))
+			{
+				result = EC_OK;
+			}
+
+			release_compile_context(context);
+			free(context);
+		}
+
+		unmap_input_file(&file_map);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : compile_job
+ * Desc : This function will compile one of the input files, it is called by the
+ *        work pool.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	compile_job(void* parameter, unsigned int job)
+{
+	char*			object_name;
+	unsigned int	result = EC_FAILED;
+	COMPILE_JOBS*	jobs = parameter;
+
+	if (jobs->num_inputs == 1 && jobs->output_directory == NULL)
+	{
+		object_name = jobs->output_filename;
+	}
+	else
+	{
+		object_name = object_file_name(jobs->output_directory,jobs->input_list[job]);
+	}
+
+	if (object_name == NULL)
+	{
+		raise_warning(0,EC_FAILED_TO_OPEN_OUTPUT_FILE,(unsigned char*)jobs->input_list[job],NULL);
+	}
+	else
+	{
+		result = compile_file(jobs->input_list[job],object_name);
+
+		if (object_name != jobs->output_filename)
+		{
+			free(object_name);
+		}
+	}
+
+	if (result != EC_OK)
+	{
+		work_pool_lock();
+		jobs->num_failed++;
+		work_pool_unlock();
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : add_input_file
+ * Desc : This function will add a file name to the list of files to compile.
+ *--------------------------------------------------------------------------------*/
+static void	add_input_file(char*** input_list, unsigned int* num_inputs, char* file_name)
+{
+	if ((*num_inputs % INPUT_LIST_BLOCK_SIZE) == 0)
+	{
+		*input_list = realloc(*input_list,(*num_inputs + INPUT_LIST_BLOCK_SIZE) * sizeof(char*));
+	}
+
+	(*input_list)[(*num_inputs)++] = file_name;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : read_response_file
+ * Desc : This function will read the file names from a response file. The names
+ *        are separated by white space. The file is kept in memory as the names
+ *        point into it.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	read_response_file(char* file_name, char*** input_list, unsigned int* num_inputs)
+{
+	long			size;
+	long			pos = 0;
+	long			start;
+	char*			buffer;
+	unsigned int	result = EC_FAILED;
+	FILE*			response_file;
+
+	if ((response_file = fopen(file_name,"r")) != NULL)
+	{
+		fseek(response_file,0,SEEK_END);
+		size = ftell(response_file);
+		fseek(response_file,0,SEEK_SET);
+
+		if (size >= 0 && (buffer = malloc(size + 1)) != NULL)
+		{
+			if (fread(buffer,1,size,response_file) == (size_t) size)
+			{
+				buffer[size] = '\0';
+
+				while (pos < size)
+				{
+					while (pos < size && (buffer[pos] == ' ' || buffer[pos] == '\t' || buffer[pos] == '\n' || buffer[pos] == '\r'))
+					{
+						pos++;
+					}
+
+					start = pos;
+
+					while (pos < size && buffer[pos] != ' ' && buffer[pos] != '\t' && buffer[pos] != '\n' && buffer[pos] != '\r')
+					{
+						pos++;
+					}
+
+					if (pos > start)
+					{
+						buffer[pos++] = '\0';
+						add_input_file(input_list,num_inputs,&buffer[start]);
+					}
+				}
+
+				result = EC_OK;
+			}
+		}
+
+		fclose(response_file);
 	}
 
 	return result;
@@ -1799,30 +2386,19 @@ int main(int argc, char* argv[])
 	int				failed = 0;
 	int				verbose = 0;
 	int				exit_code = 0;
-	int				buffer_size = 100;
-	int				have_filename = 0;
+	int				have_output = 0;
 	char*			equals = NULL;
-	char*			infile_name = NULL;
 	char*			error_param = "";
 	char*			error_string = "";
 	char*			output_filename = "doc.pdso";
-	unsigned int	err;
+	char*			output_directory = NULL;
+	char**			input_list = NULL;
 	unsigned int	start = 1;
-	unsigned int	result = 0;
-	unsigned int	linesize = 0;
-	unsigned int	input_file_type;
-	unsigned char*	line_buffer;
-	FILE*			input_file;
-	ATOM_INDEX		raw_atoms;
+	unsigned int	num_inputs = 0;
+	unsigned int	num_workers = 1;
+	COMPILE_JOBS	jobs;
 
-	memset(&g_group_lookup,0, sizeof(g_group_lookup));
 	memset(&g_macro_lookup,0, sizeof(g_macro_lookup));
-	memset(&g_functions,0, sizeof(g_functions));
-	memset(&g_apis,0, sizeof(g_apis));
-	memset(&g_samples,0, sizeof(g_samples));
-	memset(&g_applications,0, sizeof(g_applications));
-
-	raw_atoms.line_number = 0;
 
 	if (argc < 2)
 	{
@@ -1867,17 +2443,20 @@ int main(int argc, char* argv[])
 					 *
 					 * This function defines the name of the output file produced
 					 * by this application. If the name is not given then it will
-					 * default to "doc.pdso".
+					 * default to "doc.pdso". It can only be used when a single
+					 * input file is given.
 					 *------------------------------------------------------------*/
 					case 'o':
 						if (argv[start][2] != '\0')
 						{
 							output_filename = &argv[start][2];
+							have_output = 1;
 						}
 						else if (((start + 1) < argc) && argv[start+1][0] != '-')
 						{
 							start++;
 							output_filename = argv[start];
+							have_output = 1;
 						}
 						else
 						{
@@ -1886,6 +2465,36 @@ int main(int argc, char* argv[])
 						}
 						break;
 
+					/**-----------------------------------------------------------*
+					 * @option		-O
+					 * @value		<output directory name>
+					 * @required	no
+					 *
+					 * @description
+					 *
+					 * When more than one input file is given each one produces
+					 * its own object file, named after the input file with
+					 * ".pdso" added. This option names the directory that the
+					 * object files are written to. If it is not given then the
+					 * object files are written next to the input files.
+					 *------------------------------------------------------------*/
+					case 'O':
+						if (argv[start][2] != '\0')
+						{
+							output_directory = &argv[start][2];
+						}
+						else if (((start + 1) < argc) && argv[start+1][0] != '-')
+						{
+							start++;
+							output_directory = argv[start];
+						}
+						else
+						{
+							error_string = "-O requires a directory name\n";
+							failed = 1;
+						}
+						break;
+
 					/**-----------------------------------------------------------*
 					 * @option		-D
 					 * @value		MACRO_NAME=MACRO_VALUE
@@ -1957,6 +2566,40 @@ int main(int argc, char* argv[])
 						}
 						break;
 
+					/**-----------------------------------------------------------*
+					 * @option		-j
+					 * @value		<number of workers>
+					 * @required	no
+					 *
+					 * @description
+					 * This sets the number of workers that are used to compile
+					 * the input files. Each input file is compiled as a separate
+					 * job. The default is one worker which compiles the files in
+					 * order.
+					 *------------------------------------------------------------*/
+					case 'j':
+						if (argv[start][2] != '\0')
+						{
+							num_workers = atoi(&argv[start][2]);
+						}
+						else if (((start + 1) < argc) && argv[start+1][0] != '-')
+						{
+							start++;
+							num_workers = atoi(argv[start]);
+						}
+						else
+						{
+							error_string = "-j requires a number of workers\n";
+							failed = 1;
+						}
+
+						if (num_workers == 0 || num_workers > WORK_POOL_MAX_WORKERS)
+						{
+							error_string = "-j number of workers is out of range\n";
+							failed = 1;
+						}
+						break;
+
 					/**-----------------------------------------------------------*
 					 * @option		-?
 					 *
@@ -1972,38 +2615,56 @@ int main(int argc, char* argv[])
 						error_string = "Unknown parameter\n";
 				}		
 
-			}else{
+			}
+			else if (argv[start][0] == '@')
+			{
 				/**-----------------------------------------------------------*
-				 * @option 		input_file
-				 * @required	yes
+				 * @option 		@response_file
+				 * @required	no
+				 * @multiple	yes
 				 *
 				 * @description
 				 *
-				 * The source code file to compile.
+				 * A file that holds the names of input files to compile, the
+				 * names are separated by white space.
 				 *------------------------------------------------------------*/
-		
-				/* the input file is just a position file */
-				if (have_filename)
+				if (read_response_file(&argv[start][1],&input_list,&num_inputs) != EC_OK)
 				{
-					error_string = "too many input file names.\n";
+					error_string = "failed to read the response file: %s\n";
+					error_param = &argv[start][1];
 					failed = 1;
-				}else{
-					infile_name = argv[start];
-					g_input_filename = infile_name;
-					have_filename = 1;
 				}
 			}
+			else
+			{
+				/**-----------------------------------------------------------*
+				 * @option 		input_file
+				 * @required	yes
+				 * @multiple	yes
+				 *
+				 * @description
+				 *
+				 * The source code files to compile. Each input file produces
+				 * its own object file.
+				 *------------------------------------------------------------*/
+				add_input_file(&input_list,&num_inputs,argv[start]);
+			}
 
 			start++;
 		}
 		while(start < argc);
 	}
 
-	if (infile_name == NULL)
+	if (failed == 0 && num_inputs == 0)
 	{
 		error_string = "must have a input file";
 		failed = 1;
 	}
+	else if (failed == 0 && num_inputs > 1 && have_output)
+	{
+		error_string = "-o cannot be used with more than one input file, use -O.\n";
+		failed = 1;
+	}
 
 	if (verbose)
 	{
@@ -2017,61 +2678,21 @@ int main(int argc, char* argv[])
 	}
 	else
 	{
-		if ((input_file_type = input_decode_format((unsigned char*)infile_name)) == INPUT_FORMAT_INVALID)
-		{
-			/* A file type that we don't support */
-			raise_warning(0,EC_UNSUPPORTED_INPUT_FILE,(unsigned char*)infile_name,NULL);
-			result = 1;
-		}
-		else
-		{
-			if ((input_file = fopen(infile_name,"r")) == NULL)
-			{
-				raise_warning(0,EC_FAILED_TO_OPEN_INPUT_FILE,(unsigned char*)infile_name,NULL);
-				exit_code = 1;
-			}
-			else
-			{
-				exit_code = EXIT_FAILURE;
+		jobs.num_inputs		= num_inputs;
+		jobs.num_failed		= 0;
+		jobs.input_list		= input_list;
+		jobs.output_filename	= output_filename;
+		jobs.output_directory	= output_directory;
 
-				line_buffer = malloc(buffer_size);
+		work_pool_run(num_workers,num_inputs,compile_job,&jobs);
 
-				init_atoms_index(&raw_atoms);
-
-				/* add a holder for the default group */
-				find_add_lookup(&g_group_lookup,(unsigned char*)"",0);
-				
-				/* application 0 - means not defined so add a default */
-				find_add_lookup(&g_applications,(unsigned char*)"",0);
-
-				while((linesize = getline((char**)&line_buffer,(size_t*)&buffer_size,input_file)) != -1)
-				{
-					raw_atoms.line_number++;
-
-					if (linesize > 1)
-					{
-						if ((err = parse_line(line_buffer,linesize-1,&raw_atoms,input_file_type)) != EC_OK)
-						{
-							raise_warning(raw_atoms.line_number,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)infile_name,NULL);
-							result = 1;
-						}
-					}
-				}
-
-				free(line_buffer);
-
-				if (result == 0)
-				{
-					if (generate_output(&raw_atoms,output_filename,infile_name))
-					{
-						exit_code = EXIT_SUCCESS;
-					}
-				}
-				fclose(input_file);
-			}
+		if (verbose && num_inputs > 1)
+		{
+			printf("compiled %u of %u files\n",num_inputs - jobs.num_failed,num_inputs);
 		}
+
+		exit_code = (jobs.num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
 	exit(exit_code);
 }
-
@@ -29,13 +29,13 @@ static unsigned char	cpp_fmt[] = "cpp";
 /*--------------------------------------------------------------------------------*
  * Input format structures.
  *--------------------------------------------------------------------------------*/
-#define c_style_functions	c_find_comment, c_end_comment, c_function_start, c_find_parameter, c_function_start_level, c_function_end_level, c_function_end, c_decode_type, c_decode_constant, c_trim_multiline
+#define c_style_functions	c_find_comment, c_end_comment, c_function_start, c_find_parameter, c_function_start_level, c_function_end_level, c_function_end, c_decode_type, c_decode_constant, c_trim_multiline, c_reset_state
 
 SOURCE_FORMAT	input_formats[] = 
 {
-	{c_fmt,		C_FMT_LENGTH,	2,	c_style_functions},
-	{h_fmt,		H_FMT_LENGTH,	2,	c_style_functions},
-	{cpp_fmt,	CPP_FMT_LENGTH,	2,	c_style_functions}
+	{c_fmt,		C_FMT_LENGTH,	2,	'/',	'*',	c_style_functions},
+	{h_fmt,		H_FMT_LENGTH,	2,	'/',	'*',	c_style_functions},
+	{cpp_fmt,	CPP_FMT_LENGTH,	2,	'/',	'*',	c_style_functions}
 };
 
 /*--------------------------------------------------------------------------------*
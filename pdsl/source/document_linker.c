@@ -26,7 +26,11 @@
  * It produces an output file that can be passed to the document processor (*pdp*)
  * that can be used as the model to be used to generate final documents.
  *
- * @synopsis	all		-v, -q, -o, input_files
+ * With -r it produces a partial model, that can be linked again with other
+ * objects and partial models, so a big tree can be linked in parts. The
+ * partial model has the merged model and the symbols that it did not resolve.
+ *
+ * @synopsis	all		-v, -q, -o, -j, -i, -r, input_files
  *
  * @section		Error Reporting
  * 				Please report any problems to https://github.com/PAntoine/docgen
@@ -46,15 +50,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
 #include "utilities.h"
 #include "error_codes.h"
+#include "symbol_table.h"
+#include "string_pool.h"
+#include "work_pool.h"
+#include "file_functions.h"
+#include "object_record.h"
+#include "object_archive.h"
 #include "document_generator.h"
 
-static unsigned char	record_buffer[MAX_RECORD_SIZE];
-
-extern unsigned char*	g_input_filename;
-extern unsigned char*	g_source_filename;
-extern unsigned int		g_source_filename_length;
+extern THREAD_LOCAL unsigned char*	g_input_filename;
+extern THREAD_LOCAL unsigned char*	g_source_filename;
+extern THREAD_LOCAL unsigned int		g_source_filename_length;
 
 unsigned char	finish_state[] = "finish";
 unsigned int	finish_state_length = sizeof(finish_state);
@@ -63,6 +76,305 @@ unsigned int	finish_state_length = sizeof(finish_state);
  * The linking options
  *--------------------------------------------------------------------------------*/
 static unsigned int	g_max_call_depth	= 10;
+static unsigned int	g_link_state		= 0;		/* -i: record the link state */
+static unsigned int	g_partial_link		= 0;		/* -r: write a partial model */
+
+/*--------------------------------------------------------------------------------*
+ * Loaded objects
+ *
+ * The objects are loaded by the work pool, this maps the file and finds the
+ * records. The work pool then decodes each object into its own model, and they
+ * are merged into the model one at a time in the order that they were given,
+ * so the output does not depend on the number of workers.
+ *
+ * The members of an archive are loaded by a second pass of the work pool and
+ * are merged in the place of the archive, in the order they are in it.
+ *--------------------------------------------------------------------------------*/
+#define LINK_RECORD_BLOCK_SIZE	(256)
+#define LINK_TOUCH_BLOCK_SIZE	(16)
+#define LINK_NODE_BLOCK_SIZE	(256)
+#define LINK_LOCAL_BLOCK_SIZE	(64)
+#define LINK_ITEM_BLOCK_SIZE	(256)
+#define LINK_BLOCK_LOOKUPS		(3)
+
+typedef struct
+{
+	OBJECT_RECORD	record;
+	unsigned char*	payload;
+
+} LINK_RECORD;
+
+typedef struct
+{
+	unsigned char	type;				/* LINK_TOUCH_* */
+	unsigned char*	name;
+	unsigned int	name_length;
+
+} LINK_TOUCH;
+
+/*--------------------------------------------------------------------------------*
+ * Object local tables
+ *
+ * The records of an object name the groups, functions, applications and api
+ * functions by the order that the object declares them in. The tables are sized
+ * when the object is decoded and map them to the model when it is merged, they
+ * grow with the object so there is no limit to the number that one object can
+ * have. The first group is the default group of the file, and the first
+ * function is not used.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned int	num_items;
+	unsigned int	max_items;
+	void**			items;
+
+} LINK_LOCAL_TABLE;
+
+typedef struct
+{
+	LINK_LOCAL_TABLE	groups;
+	LINK_LOCAL_TABLE	functions;
+	LINK_LOCAL_TABLE	applications;
+	LINK_LOCAL_TABLE	api_functions;
+
+} LINK_LOCALS;
+
+/*--------------------------------------------------------------------------------*
+ * Object models
+ *
+ * Each object is decoded into its own model by the work pool. The model is a
+ * list of items in the order of the records: the things that the object
+ * declares, the blocks, and the warnings found while decoding, that are raised
+ * when the object is merged so they come out in the same order as before.
+ *
+ * The items do not touch the model. They name the groups, applications and api
+ * functions by a reference, that is the local id plus one so zero is no group,
+ * the functions by their local id, and the names are views into the object.
+ * The merge finds or adds the symbols in the model, and then hands the blocks
+ * over to it. The lookups of the states and timelines are kept in the order of
+ * the atoms, as that is the order they are added to the group in.
+ *--------------------------------------------------------------------------------*/
+#define LINK_ITEM_WARNING		(1)		/* line_number, value is the error, text */
+#define LINK_ITEM_NOTE			(2)		/* an atom that is ignored, text and value */
+#define LINK_ITEM_GROUP			(3)		/* id and name */
+#define LINK_ITEM_FUNCTION		(4)		/* id and name */
+#define LINK_ITEM_APPLICATION	(5)		/* id and name */
+#define LINK_ITEM_SAMPLE		(6)		/* name is the sample record */
+#define LINK_ITEM_API			(7)		/* id, value is the local group, and name */
+#define LINK_ITEM_API_TYPE		(8)		/* id of the api function, value is the atom, names */
+#define LINK_ITEM_SECTION		(9)		/* id of the application, value is fixed, name */
+#define LINK_ITEM_SECTION_DATA	(10)	/* id of the application, value is fixed, name */
+#define LINK_ITEM_SYNOPSIS		(11)	/* id of the application, synopsis */
+#define LINK_ITEM_TOUCH			(12)	/* id of the group that an atom adds to */
+#define LINK_ITEM_BLOCK			(13)	/* block */
+
+#define LINK_LOOKUP_STATE		(1)
+#define LINK_LOOKUP_TIMELINE	(2)
+#define LINK_LOOKUP_TO			(3)
+
+typedef struct
+{
+	unsigned int	type;				/* LINK_LOOKUP_* */
+	unsigned int	group;				/* local id */
+	unsigned char*	name;
+	unsigned int	name_length;
+
+} LINK_LOOKUP;
+
+typedef struct
+{
+	BLOCK_NODE		node;				/* the model pointers are filled in when it is merged */
+	unsigned int	group;				/* reference */
+	unsigned int	function;			/* local id */
+	unsigned int	api_function;		/* reference */
+	unsigned int	num_lookups;
+	LINK_LOOKUP		lookups[LINK_BLOCK_LOOKUPS];
+
+} LINK_BLOCK;
+
+typedef struct
+{
+	unsigned int	type;				/* LINK_ITEM_* */
+	unsigned int	line_number;
+	unsigned int	id;
+	unsigned int	value;
+	unsigned char*	name;
+	unsigned int	name_length;
+	union
+	{
+		const unsigned char*	text;
+		NAME*					names;	/* the type, name and brief of the record */
+		SYNOPSIS_LIST*			synopsis;
+		LINK_BLOCK*				block;
+	} data;
+
+} LINK_ITEM;
+
+/*--------------------------------------------------------------------------------*
+ * Incremental linking
+ *
+ * With -i the model has a link state section, that has a fingerprint of each
+ * object and the groups, functions, samples and applications that the object
+ * added to. Two things that the same object added to are joined, so all the
+ * things in the model fall into sets that do not depend on each other.
+ *
+ * When a model is linked, the objects that are in the previous model and have
+ * not changed are kept. The sets that only kept objects added to are copied
+ * from the previous model, the other sets are rebuilt: the objects that added
+ * to them are merged and checked as normal. If a changed object adds to a set
+ * that was not rebuilt, the model is thrown away and all the objects are
+ * linked. A partial model is an object to the link state.
+ *--------------------------------------------------------------------------------*/
+typedef struct
+{
+	unsigned char*	name;
+	unsigned int	name_length;
+	unsigned int	size;
+	unsigned int	fingerprint;
+	unsigned int	num_touches;
+	LINK_TOUCH*		touches;
+	unsigned int	used:1;				/* the object is in this link */
+
+} LINK_STATE_OBJECT;
+
+typedef struct
+{
+	unsigned char*	name;
+	unsigned int	name_length;
+	unsigned char*	data;				/* in the model */
+	unsigned int	length;
+
+} LINK_STATE_SECTION;
+
+typedef struct
+{
+	unsigned int		index;				/* in the sources of the link state */
+	unsigned char*		data;
+	unsigned int		size;
+	unsigned int		reordered:1;		/* the objects are not in the same order */
+	unsigned int		num_objects;
+	LINK_STATE_OBJECT*	objects;
+	unsigned int		num_groups;
+	LINK_STATE_SECTION*	groups;
+	LINK_STATE_SECTION	samples;
+	LINK_STATE_SECTION	applications;
+	SYMBOL_TABLE		object_names;
+	SYMBOL_TABLE		group_names;
+
+} LINK_SOURCE;
+
+typedef struct
+{
+	const char*		filename;
+	FILE_MAP		input_file;
+	unsigned char*	data;				/* the object, in the input file or in an archive */
+	unsigned int	size;
+	unsigned int	mapped:1;
+	unsigned int	loaded:1;			/* the file has the object signature */
+	unsigned int	is_archive:1;		/* the members are merged before the archive is released */
+	unsigned int	is_partial:1;		/* a partial model, the records are its link model */
+	unsigned int	later_version:1;
+	unsigned int	truncated:1;		/* the last record runs off the end of the file */
+	unsigned int	error;				/* reported when the object is merged */
+	unsigned int	num_records;
+	unsigned int	max_records;
+	LINK_RECORD*	records;
+	unsigned int	decode:1;			/* it is decoded in the next pass of the work pool */
+	unsigned int	failed:1;			/* a problem was found when it was decoded */
+	unsigned int	num_items;
+	unsigned int	max_items;
+	LINK_ITEM*		items;				/* the model of the object */
+	LINK_LOCALS		locals;
+	unsigned char*	source_name;
+	unsigned int	source_name_length;
+	unsigned int	first_member;
+	OBJECT_ARCHIVE	archive;
+	unsigned int	num_unresolved;		/* the symbols that a partial model did not resolve */
+	unsigned int	fingerprint;
+	LINK_SOURCE*	source;				/* the model that the object is in */
+	unsigned int	previous;			/* the object in the link state of the source, plus one */
+	unsigned int	kept:1;				/* it has not changed since the source was linked */
+	unsigned int	merge:1;			/* merged in an incremental link */
+	unsigned int	num_touches;
+	unsigned int	max_touches;
+	LINK_TOUCH*		touches;			/* the things in the model that the object added to */
+
+} LINK_OBJECT;
+
+typedef struct
+{
+	LINK_TOUCH		touch;
+	unsigned int	parent;				/* the sets of the nodes */
+	unsigned int	owner;				/* the source of the set, plus one */
+	unsigned int	rebuild:1;			/* set on the first node of the sets to rebuild */
+
+} LINK_NODE;
+
+typedef struct
+{
+	FILE_MAP		model;
+	LINK_SOURCE		previous;			/* the model of the last link, with -i */
+	unsigned int	num_sources;
+	LINK_SOURCE**	sources;
+	SYMBOL_TABLE	node_names;			/* the touches, scoped by their type */
+	unsigned int	num_nodes;
+	unsigned int	max_nodes;
+	LINK_NODE*		nodes;
+	unsigned int	num_order;
+	unsigned int	max_order;
+	LINK_TOUCH*		order;				/* the groups, in the order that they are added */
+	unsigned int	num_unresolved;		/* the symbols that a partial link did not find */
+	unsigned int	incremental:1;		/* the sets that are not rebuilt are copied */
+
+} LINK_STATE;
+
+/*--------------------------------------------------------------------------------*
+ * Partial linking
+ *
+ * With -r the model is written as it is once the objects have been merged and
+ * before it is checked, with the symbols that were not resolved (see the link
+ * model in document_generator.h). A later link merges the partial model in the
+ * place of its objects, the records find or add the things in the model as the
+ * objects did, so the objects are not read again.
+ *
+ * The groups are referenced by their index in the partial model, when it is
+ * written the index is found from the name of the group with a table. The
+ * parameter briefs that do not find their parameter are kept, it may be in an
+ * object that is in another partial model.
+ *--------------------------------------------------------------------------------*/
+typedef struct tag_link_brief
+{
+	API_FUNCTION*			function;
+	NAME					name;
+	NAME					brief;
+
+	struct tag_link_brief*	next;
+
+} LINK_BRIEF;
+
+typedef struct
+{
+	unsigned int	size;
+	unsigned int	max_size;
+	unsigned char*	data;				/* the payload of the record being written */
+	unsigned int	failed:1;			/* the payload could not grow */
+	SYMBOL_TABLE	groups;				/* the index of the groups, plus one */
+
+} LINK_MODEL_WRITER;
+
+typedef struct
+{
+	unsigned char*	data;				/* the payload of the record being read */
+	unsigned int	size;
+	unsigned int	pos;
+	unsigned int	failed:1;			/* the payload is too short or names a missing group */
+	LINK_LOCALS*	locals;
+
+} LINK_MODEL_READER;
+
+static LINK_BRIEF*		g_link_briefs = NULL;
+static LINK_BRIEF*		g_last_link_brief = NULL;
+static unsigned int		g_all_group_used = 0;		/* an object named the "all" group */
 
 /*--------------------------------------------------------------------------------*
  * Linking Structures
@@ -72,6 +384,84 @@ static SAMPLE		g_sample_list;
 static FUNCTION		g_function_list;
 static APPLICATION	g_application_list;
 
+/*--------------------------------------------------------------------------------*
+ * Linking symbol tables
+ *
+ * The triggers and api functions are scoped by their group, the functions and
+ * applications are global so use a NULL scope.
+ *--------------------------------------------------------------------------------*/
+static SYMBOL_TABLE	g_trigger_symbols;
+static SYMBOL_TABLE	g_function_symbols;
+static SYMBOL_TABLE	g_api_function_symbols;
+static SYMBOL_TABLE	g_application_symbols;
+
+/*--------------------------------------------------------------------------------*
+ * Sequence diagram wait index
+ *
+ * The nodes that wait for a message are indexed by their timeline and the name
+ * of the message. Each list holds the waiting nodes in the order that they are
+ * on the timeline, so the first node on the list is the first node that a walk
+ * of the timeline would match. The copies that are made when the messages are
+ * connected are added after the node that they were copied from. Duplicating a
+ * function adds nodes all over the diagram, so that marks the index as stale
+ * and it is rebuilt on the next lookup.
+ *--------------------------------------------------------------------------------*/
+typedef struct tag_wait_entry
+{
+	NODE*					node;
+	struct tag_wait_entry*	next;
+
+} WAIT_ENTRY;
+
+typedef struct
+{
+	unsigned int	generation;		/* the build of the index that the list belongs to */
+	WAIT_ENTRY*		first;
+	WAIT_ENTRY*		last;
+
+} WAIT_LIST;
+
+typedef struct
+{
+	unsigned int	diagrams;
+	unsigned int	timelines;
+	unsigned int	nodes;			/* as they were read */
+	unsigned int	expanded;		/* after the functions are inserted */
+	unsigned int	linked;			/* after the messages are connected */
+	unsigned int	waits;
+	unsigned int	sends;
+	unsigned int	matched;
+	unsigned int	steps;
+	unsigned int	rebuilds;
+
+} SEQUENCE_STATS;
+
+/*--------------------------------------------------------------------------------*
+ * Timeline reordering
+ *
+ * Each node of the timeline has an entry while it is being reordered. The
+ * entries are in the old order of the timeline.
+ *--------------------------------------------------------------------------------*/
+#define REORDER_NOT_PLACED	(0)
+#define REORDER_VISITING	(1)
+#define REORDER_PLACED		(2)
+
+typedef struct tag_reorder_node
+{
+	NODE*						node;
+	unsigned int				state;
+	struct tag_reorder_node*	block_end;		/* the last node that moves with this node */
+	struct tag_reorder_node*	after;			/* the block that this node is after */
+	struct tag_reorder_node*	dependent;		/* the node that this block is placed in front of */
+
+} REORDER_NODE;
+
+static SYMBOL_TABLE			g_wait_symbols;
+static SEQUENCE_DIAGRAM*	g_wait_diagram;
+static unsigned int			g_wait_generation;
+static unsigned int			g_wait_stale;
+static SEQUENCE_STATS		g_sequence_stats;
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : test_walk_node_tree
  * Desc : This function will walk the tree as a test.
@@ -110,26 +500,10 @@ static void	test_walk_node_tree(NODE* start)
 static TRIGGER* find_trigger ( GROUP* group, unsigned char* name, unsigned int name_length )
 {
 	TRIGGER*	result = NULL;
-	TRIGGER*	current_trigger = NULL;
 
 	if (group != NULL)
 	{
-		if (group->trigger_list != NULL)
-		{
-			current_trigger = group->trigger_list;
-
-			do
-			{
-				if (current_trigger->name_length == name_length && memcmp(current_trigger->name,name,name_length) == 0)
-				{
-					result = current_trigger;
-					break;
-				}
-
-				current_trigger = current_trigger->next;
-			}
-			while (current_trigger != NULL);
-		}
+		result = symbol_table_find(&g_trigger_symbols,group,name,name_length);
 	}
 
 	return result;
@@ -177,7 +551,9 @@ static TRIGGER* add_trigger ( GROUP* group, unsigned char* name, unsigned int na
 		current_trigger->name_length = name_length;
 		current_trigger->group = group;
 
-		memcpy(current_trigger->name,name,name_length);
+		current_trigger->name = string_pool_add(name,name_length);
+
+		symbol_table_add(&g_trigger_symbols,group,current_trigger->name,name_length,current_trigger);
 		
 		result = current_trigger;
 	}
@@ -256,7 +632,7 @@ static MESSAGE*	create_message(NODE* sender, TIMELINE* destination, BLOCK_NAME*
 	}
 	
 	/* set the values in new message */
-	memcpy(new_message->name,name->name,name->name_length);
+	new_message->name = string_pool_add(name->name,name->name_length);
 	new_message->sender = sender;
 	new_message->name_length = name->name_length;
 	new_message->target_timeline = destination;
@@ -271,27 +647,7 @@ static MESSAGE*	create_message(NODE* sender, TIMELINE* destination, BLOCK_NAME*
  *--------------------------------------------------------------------------------*/
 static API_FUNCTION*	find_api_function(unsigned char* name, unsigned int name_length, GROUP* group)
 {
-	API_FUNCTION* 	result = NULL;
-	API_FUNCTION*	current_func;
-
-	if (group->api != NULL)
-	{
-		/* add it to the end of the list */
-		current_func = group->api->function_list;
-
-		while (current_func != NULL)
-		{
-			if (current_func->name.name_length == name_length && memcmp(name,current_func->name.name,current_func->name.name_length) == 0)
-			{
-				result = current_func;
-				break;
-			}
-
-			current_func = current_func->next;
-		}
-	}
-
-	return result;
+	return symbol_table_find(&g_api_function_symbols,group,name,name_length);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -300,7 +656,7 @@ static API_FUNCTION*	find_api_function(unsigned char* name, unsigned int name_le
  *--------------------------------------------------------------------------------*/
 static void	add_api_type_record(API_TYPE* api_type, unsigned int record_type,NAME* name, NAME* type,  NAME* brief)
 {
-	API_TYPE_RECORD*	new_record = malloc(sizeof(API_TYPE_RECORD));
+	API_TYPE_RECORD*	new_record = calloc(1,sizeof(API_TYPE_RECORD));
 
 	/* initialise the new record */
 	new_record->record_type = record_type;
@@ -327,7 +683,7 @@ static void	add_api_type_record(API_TYPE* api_type, unsigned int record_type,NAM
  *--------------------------------------------------------------------------------*/
 static void	add_api_constant_record(API_CONSTANTS* api_constants, unsigned int record_type,NAME* type, NAME* name,  NAME* brief)
 {
-	API_CONSTANT*	new_constant = malloc(sizeof(API_CONSTANT));
+	API_CONSTANT*	new_constant = calloc(1,sizeof(API_CONSTANT));
 
 	/* initialise the new constant */
 	copy_name(name,&new_constant->name);
@@ -354,7 +710,7 @@ static void	add_api_constant_record(API_CONSTANTS* api_constants, unsigned int r
  *--------------------------------------------------------------------------------*/
 static void	add_api_constant(API_CONSTANTS* api_constant, NAME* name, NAME* value)
 {
-	API_CONSTANT*	new_record = malloc(sizeof(API_CONSTANT));
+	API_CONSTANT*	new_record = calloc(1,sizeof(API_CONSTANT));
 
 	/* initialise the new record */
 	copy_name(name,&new_record->name);
@@ -411,6 +767,8 @@ static API_FUNCTION*	add_api_function(unsigned char* name, unsigned int name_len
 	
 	result->name.name = malloc(name_length);
 	memcpy(result->name.name,name,name_length);
+
+	symbol_table_add(&g_api_function_symbols,group,result->name.name,name_length,result);
 			
 	return result;
 }
@@ -423,14 +781,10 @@ static FUNCTION*	find_function(unsigned char* name, unsigned int name_length)
 {
 	FUNCTION* result = &g_function_list;
 
-	while (result != NULL)
+	/* the head of the list is not in the symbol table */
+	if (name_length != result->name_length || memcmp(name,result->name,name_length) != 0)
 	{
-		if (name_length == result->name_length && memcmp(name,result->name,name_length) == 0)
-		{
-			break;
-		}
-
-		result = result->next;
+		result = symbol_table_find(&g_function_symbols,NULL,name,name_length);
 	}
 
 	return result;
@@ -446,33 +800,31 @@ static APPLICATION*	find_add_application(unsigned char* name, unsigned int name_
 	APPLICATION* 	result = NULL;
 	APPLICATION*	current_appl;
 
-	/* add it to the end of the list */
-	current_appl = &g_application_list;
-
-	while (current_appl != NULL)
+	/* the head of the list is not in the symbol table */
+	if (g_application_list.name.name_length == name_length && memcmp(g_application_list.name.name,name,name_length) == 0)
 	{
-		if (current_appl->next == NULL)
-		{
-			/* we have reached the end of the list -- add new application */
-			result = calloc(1,sizeof(APPLICATION));
-
-			result->name.name_length = name_length;
-			result->name.name = malloc(name_length);
-			memcpy(result->name.name,name,name_length);
+		result = &g_application_list;
+	}
+	else if ((result = symbol_table_find(&g_application_symbols,NULL,name,name_length)) == NULL)
+	{
+		/* add it to the end of the list */
+		current_appl = &g_application_list;
 
-			current_appl->next = result;
-			break;
-		}
-		else if (current_appl->name.name_length == name_length && memcmp(current_appl->name.name,name,name_length) == 0)
+		while (current_appl->next != NULL)
 		{
-			/* found the item */
-			result = current_appl;
-			break;
+			current_appl = current_appl->next;
 		}
 
-		current_appl = current_appl->next;
-	}
+		result = calloc(1,sizeof(APPLICATION));
+
+		result->name.name_length = name_length;
+		result->name.name = malloc(name_length);
+		memcpy(result->name.name,name,name_length);
 
+		current_appl->next = result;
+
+		symbol_table_add(&g_application_symbols,NULL,result->name.name,name_length,result);
+	}
 
 	return result;
 }
@@ -522,7 +874,9 @@ static FUNCTION*	add_function(unsigned char* name, unsigned int name_length, uns
 	/* set the values of the new function */
 	result->flags = flags;
 	result->name_length = name_length;
-	memcpy(result->name,name,name_length);
+	result->name = string_pool_add(name,name_length);
+
+	symbol_table_add(&g_function_symbols,NULL,result->name,name_length,result);
 
 	return result;
 }
@@ -555,128 +909,356 @@ static void	add_sample(unsigned char* data, unsigned int data_length)
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : add_block_node
- * Desc : This function will add a sequence diagram block to the diagram tree.
+ * Name : local_add
+ * Desc : This function adds the item to the end of the local table, growing the
+ *        table if it is full. The caller reports the error if it cannot grow.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_node(BLOCK_NODE* block, GROUP** local_group_list)
+static unsigned int	local_add(LINK_LOCAL_TABLE* table, void* item)
 {
-	NODE*			after;
-	NODE*			sequence;
-	NODE*			new_node;
-	GROUP*			owing_group = NULL;
-	TRIGGER*		trigger = NULL;
-	MESSAGE*		message = NULL;
-	MESSAGE*		new_message = NULL;
-	MESSAGE*		wait_message = NULL;
-	FUNCTION*		function = NULL;
 	unsigned int	result = EC_OK;
-	
-	if (block->timeline == NULL && block->to_timeline == NULL)
-	{
-		result = EC_SEQUENCE_NODE_MISSING_TIMELINE;
-	}
-	else
-	{
-		/* create the new node */
-		new_node = calloc(1,sizeof(NODE));
-		new_node->flags = block->flags;
-		new_node->group = block->group;
-		new_node->timeline = block->timeline;
-
-		/* decode the trigger */
-		if (block->trigger != NULL)
-		{
-			if ((new_node->trigger = find_trigger(block->trigger->owner.group,block->trigger->name,block->trigger->name_length)) == NULL)
-			{
-				/* add ghost trigger */
-				new_node->trigger = add_trigger(block->trigger->owner.group,block->trigger->name,block->trigger->name_length,FLAG_GHOST);
-			}
-		}
+	void**			items;
 
-		if (block->message.name_length > 0)
+	if (table->num_items == table->max_items)
+	{
+		if ((items = realloc(table->items,(table->max_items + LINK_LOCAL_BLOCK_SIZE) * sizeof(void*))) == NULL)
 		{
-			/* does the block call a function or send a message */
-			if ((block->flags & FLAG_MESSAGE_CALL) == FLAG_MESSAGE_CALL)
-			{
-				if((new_node->function = find_function(block->message.name,block->message.name_length)) == NULL)
-				{
-					/* Ok, we have a function that we don't know about yet */
-					new_node->function = add_function(block->message.name,block->message.name_length,FLAG_GHOST);
-				}
-			}
-			else
-			{
-				new_node->sent_message = create_message(new_node,block->to_timeline,&block->message);
-				new_node->sent_message->flags = block->flags;
-			}
+			result = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
 		}
-
-		/* wait- this needs to fixed-up after the functions are */
-		if (block->sequence.name_length > 0)
+		else
 		{
-			memcpy(&new_node->wait_message,&block->sequence,sizeof(BLOCK_NAME));
+			table->items = items;
+			table->max_items += LINK_LOCAL_BLOCK_SIZE;
 		}
+	}
 
-		/* handle the sequence */
-		if (block->after.name_length > 0)
-		{
-			memcpy(&new_node->after,&block->after,sizeof(BLOCK_NAME));
-		}
+	if (result == EC_OK)
+	{
+		table->items[table->num_items++] = item;
+	}
 
-		/* handle the trigger wait */
-		if (block->trigger != NULL)
-		{
-			new_node->trigger = handle_trigger(block->trigger,block->group);
-		}
+	return result;
+}
 
-		/* add the generated triggers to the group */
-		if (block->triggers_list != NULL)
-		{
-			add_triggers(&new_node->triggers,block->triggers_list,block->group);
-		}
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : local_item
+ * Desc : This function returns the item from the local table, or NULL if the
+ *        object has not declared it.
+ *--------------------------------------------------------------------------------*/
+static void*	local_item(LINK_LOCAL_TABLE* table, unsigned int index)
+{
+	void*	result = NULL;
 
-		/* insert at the end */
-		if (block->timeline->last_node == NULL)
-		{
-			block->timeline->node = new_node;
-			block->timeline->last_node = new_node;
-		}
-		else
-		{
-			block->timeline->last_node->next = new_node;
-			block->timeline->last_node = new_node;
-		}
+	if (index < table->num_items)
+	{
+		result = table->items[index];
 	}
 
 	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : add_block_type
- * Desc : This function will add a type block to the diagram tree.
+ * Name : local_ref
+ * Desc : This function returns the item for a reference, that is the local id
+ *        plus one. A reference of zero is no item.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_type(BLOCK_NODE* block, GROUP** local_group_list)
+static void*	local_ref(LINK_LOCAL_TABLE* table, unsigned int reference)
 {
-	GROUP*			owing_group = NULL;
-	API_TYPE*		current_type;
-	unsigned int	result = EC_OK;
-	
-	if (block->description.name_length > 0)
-	{
-		block->api_type->description.fixed = block->description.fixed;
-		block->api_type->description.name = block->description.name;
-		block->api_type->description.name_length = block->description.name_length;
-	}
+	void*	result = NULL;
 
-	if (block->group == NULL)
+	if (reference > 0)
 	{
-		/* if no group defined, default to the default */
-		block->group = local_group_list[0];
+		result = local_item(table,reference - 1);
 	}
 
-	owing_group = block->group;
+	return result;
+}
 
-	/* create the API group if required */
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : local_reference
+ * Desc : This function returns the reference for a local id, or zero if the
+ *        object has not declared it yet.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	local_reference(LINK_LOCAL_TABLE* table, unsigned int index)
+{
+	unsigned int	result = 0;
+
+	if (index < table->num_items)
+	{
+		result = index + 1;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : local_release
+ * Desc : This function releases the local tables of an object.
+ *--------------------------------------------------------------------------------*/
+static void	local_release(LINK_LOCALS* locals)
+{
+	free(locals->groups.items);
+	free(locals->functions.items);
+	free(locals->applications.items);
+	free(locals->api_functions.items);
+
+	memset(locals,0,sizeof(LINK_LOCALS));
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_item
+ * Desc : This function adds an item to the end of the model of the object. If
+ *        the list cannot grow the object is failed, and NULL is returned.
+ *--------------------------------------------------------------------------------*/
+static LINK_ITEM*	link_item(LINK_OBJECT* object, unsigned int type, unsigned int line_number)
+{
+	LINK_ITEM*	result = NULL;
+	LINK_ITEM*	items;
+
+	if (object->num_items == object->max_items)
+	{
+		if ((items = realloc(object->items,(object->max_items + LINK_ITEM_BLOCK_SIZE) * sizeof(LINK_ITEM))) == NULL)
+		{
+			object->failed = 1;
+		}
+		else
+		{
+			object->items = items;
+			object->max_items += LINK_ITEM_BLOCK_SIZE;
+		}
+	}
+
+	if (object->num_items < object->max_items)
+	{
+		result = &object->items[object->num_items++];
+
+		memset(result,0,sizeof(LINK_ITEM));
+		result->type = type;
+		result->line_number = line_number;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_warning
+ * Desc : This function keeps a warning that was found while decoding the object,
+ *        it is raised when the object is merged.
+ *--------------------------------------------------------------------------------*/
+static void	link_warning(LINK_OBJECT* object, unsigned int line_number, unsigned int error, const unsigned char* parameter)
+{
+	LINK_ITEM*	item;
+
+	if ((item = link_item(object,LINK_ITEM_WARNING,line_number)) != NULL)
+	{
+		item->value = error;
+		item->data.text = parameter;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_note
+ * Desc : This function keeps a note of an atom that is ignored, it is printed
+ *        when the object is merged.
+ *--------------------------------------------------------------------------------*/
+static void	link_note(LINK_OBJECT* object, const char* text, unsigned int value)
+{
+	LINK_ITEM*	item;
+
+	if ((item = link_item(object,LINK_ITEM_NOTE,0)) != NULL)
+	{
+		item->value = value;
+		item->data.text = (const unsigned char*) text;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_declare
+ * Desc : This function adds a declaration to the model of the object, and the
+ *        slot in the local table that it fills when it is merged.
+ *--------------------------------------------------------------------------------*/
+static LINK_ITEM*	link_declare(	LINK_OBJECT*		object,
+									LINK_LOCAL_TABLE*	table,
+									unsigned int		type,
+									unsigned int		line_number,
+									unsigned char*		name,
+									unsigned int		name_length)
+{
+	LINK_ITEM*	result = NULL;
+
+	if (local_add(table,NULL) != EC_OK)
+	{
+		link_warning(object,0,EC_OUT_OF_MEMORY_OR_FILE_TO_BIG,NULL);
+		object->failed = 1;
+	}
+	else if ((result = link_item(object,type,line_number)) != NULL)
+	{
+		result->id = table->num_items - 1;
+		result->name = name;
+		result->name_length = name_length;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_lookup
+ * Desc : This function adds a lookup of a state or a timeline to the block.
+ *--------------------------------------------------------------------------------*/
+static void	link_lookup(LINK_BLOCK* block, unsigned int type, unsigned int group, unsigned char* name, unsigned int name_length)
+{
+	if (block->num_lookups < LINK_BLOCK_LOOKUPS)
+	{
+		block->lookups[block->num_lookups].type = type;
+		block->lookups[block->num_lookups].group = group;
+		block->lookups[block->num_lookups].name = name;
+		block->lookups[block->num_lookups].name_length = name_length;
+		block->num_lookups++;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_has_lookup
+ * Desc : This function returns the lookup of the type if the block has one.
+ *--------------------------------------------------------------------------------*/
+static LINK_LOOKUP*	link_has_lookup(LINK_BLOCK* block, unsigned int type)
+{
+	unsigned int	count;
+	LINK_LOOKUP*	result = NULL;
+
+	for (count=0; count < block->num_lookups && result == NULL; count++)
+	{
+		if (block->lookups[count].type == type)
+		{
+			result = &block->lookups[count];
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : add_block_node
+ * Desc : This function will add a sequence diagram block to the diagram tree.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	add_block_node(BLOCK_NODE* block, LINK_LOCALS* locals)
+{
+	NODE*			after;
+	NODE*			sequence;
+	NODE*			new_node;
+	GROUP*			owing_group = NULL;
+	TRIGGER*		trigger = NULL;
+	MESSAGE*		message = NULL;
+	MESSAGE*		new_message = NULL;
+	MESSAGE*		wait_message = NULL;
+	FUNCTION*		function = NULL;
+	unsigned int	result = EC_OK;
+	
+	if (block->timeline == NULL && block->to_timeline == NULL)
+	{
+		result = EC_SEQUENCE_NODE_MISSING_TIMELINE;
+	}
+	else
+	{
+		/* create the new node */
+		new_node = calloc(1,sizeof(NODE));
+		new_node->flags = block->flags;
+		new_node->group = block->group;
+		new_node->timeline = block->timeline;
+
+		/* decode the trigger */
+		if (block->trigger != NULL)
+		{
+			if ((new_node->trigger = find_trigger(block->trigger->owner.group,block->trigger->name,block->trigger->name_length)) == NULL)
+			{
+				/* add ghost trigger */
+				new_node->trigger = add_trigger(block->trigger->owner.group,block->trigger->name,block->trigger->name_length,FLAG_GHOST);
+			}
+		}
+
+		if (block->message.name_length > 0)
+		{
+			/* does the block call a function or send a message */
+			if ((block->flags & FLAG_MESSAGE_CALL) == FLAG_MESSAGE_CALL)
+			{
+				if((new_node->function = find_function(block->message.name,block->message.name_length)) == NULL)
+				{
+					/* Ok, we have a function that we don't know about yet */
+					new_node->function = add_function(block->message.name,block->message.name_length,FLAG_GHOST);
+				}
+			}
+			else
+			{
+				new_node->sent_message = create_message(new_node,block->to_timeline,&block->message);
+				new_node->sent_message->flags = block->flags;
+			}
+		}
+
+		/* wait- this needs to fixed-up after the functions are */
+		if (block->sequence.name_length > 0)
+		{
+			memcpy(&new_node->wait_message,&block->sequence,sizeof(BLOCK_NAME));
+		}
+
+		/* handle the sequence */
+		if (block->after.name_length > 0)
+		{
+			memcpy(&new_node->after,&block->after,sizeof(BLOCK_NAME));
+		}
+
+		/* handle the trigger wait */
+		if (block->trigger != NULL)
+		{
+			new_node->trigger = handle_trigger(block->trigger,block->group);
+		}
+
+		/* add the generated triggers to the group */
+		if (block->triggers_list != NULL)
+		{
+			add_triggers(&new_node->triggers,block->triggers_list,block->group);
+		}
+
+		/* insert at the end */
+		if (block->timeline->last_node == NULL)
+		{
+			block->timeline->node = new_node;
+			block->timeline->last_node = new_node;
+		}
+		else
+		{
+			block->timeline->last_node->next = new_node;
+			block->timeline->last_node = new_node;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : add_block_type
+ * Desc : This function will add a type block to the diagram tree.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	add_block_type(BLOCK_NODE* block, LINK_LOCALS* locals)
+{
+	GROUP*			owing_group = NULL;
+	API_TYPE*		current_type;
+	unsigned int	result = EC_OK;
+	
+	if (block->description.name_length > 0)
+	{
+		block->api_type->description.fixed = block->description.fixed;
+		block->api_type->description.name = block->description.name;
+		block->api_type->description.name_length = block->description.name_length;
+	}
+
+	if (block->group == NULL)
+	{
+		/* if no group defined, default to the default */
+		block->group = locals->groups.items[0];
+	}
+
+	owing_group = block->group;
+
+	/* create the API group if required */
 	if (owing_group->api == NULL)
 	{
 		owing_group->api = calloc(1,sizeof(API));
@@ -712,7 +1294,7 @@ static unsigned int	add_block_type(BLOCK_NODE* block, GROUP** local_group_list)
  * Name : add_block_constants
  * Desc : This function will add a constants block to the diagram tree.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_constants(BLOCK_NODE* block, GROUP** local_group_list)
+static unsigned int	add_block_constants(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	GROUP*			owing_group = NULL;
 	API_CONSTANTS*	current_constants;
@@ -728,7 +1310,7 @@ static unsigned int	add_block_constants(BLOCK_NODE* block, GROUP** local_group_l
 	if (block->group == NULL)
 	{
 		/* if no group defined, default to the default */
-		block->group = local_group_list[0];
+		block->group = locals->groups.items[0];
 	}
 
 	owing_group = block->group;
@@ -769,7 +1351,7 @@ static unsigned int	add_block_constants(BLOCK_NODE* block, GROUP** local_group_l
  * Name : add_block_function
  * Desc : This function will add a function block.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_function(BLOCK_NODE* block, FUNCTION** local_function_list)
+static unsigned int	add_block_function(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	unsigned int		result = EC_OK;
 	unsigned int		function_id = 0;
@@ -867,7 +1449,7 @@ static unsigned int	add_block_function(BLOCK_NODE* block, FUNCTION** local_funct
  * Desc : This will add the block for the file. It's major function is to set the
  *        defaults that are require while processing this file.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_file(BLOCK_NODE* block, GROUP** local_group_list)
+static unsigned int	add_block_file(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	unsigned int result = EC_OK;
 
@@ -875,7 +1457,7 @@ static unsigned int	add_block_file(BLOCK_NODE* block, GROUP** local_group_list)
 
 	if (block->group != NULL)
 	{
-		local_group_list[0] = block->group;
+		locals->groups.items[0] = block->group;
 	}
 
 	return result;
@@ -885,7 +1467,7 @@ static unsigned int	add_block_file(BLOCK_NODE* block, GROUP** local_group_list)
  * Name : add_block_application
  * Desc : This will add the block for the application.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_application(BLOCK_NODE* block, GROUP** local_group_list, APPLICATION** local_application_list)
+static unsigned int	add_block_application(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	unsigned int 	result = EC_OK;
 	OPTION*			current_option = NULL;
@@ -893,12 +1475,12 @@ static unsigned int	add_block_application(BLOCK_NODE* block, GROUP** local_group
 	
 	if (block->application_id != 0)
 	{
-		application = local_application_list[block->application_id];
+		application = local_item(&locals->applications,block->application_id);
 	}
 
 	if (block->group != NULL)
 	{
-		local_group_list[0] = block->group;
+		locals->groups.items[0] = block->group;
 	}
 
 	if (block->option.name_length > 0)
@@ -973,12 +1555,40 @@ static unsigned int	add_block_application(BLOCK_NODE* block, GROUP** local_group
 	return result;
 }
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_brief_add
+ * Desc : This function keeps a parameter brief that did not find its parameter,
+ *        so that it can be written in the partial model.
+ *--------------------------------------------------------------------------------*/
+static void	link_brief_add(API_FUNCTION* function, NAME* name, NAME* brief)
+{
+	LINK_BRIEF*	new_brief = calloc(1,sizeof(LINK_BRIEF));
+
+	if (new_brief != NULL)
+	{
+		new_brief->function = function;
+		copy_name(name,&new_brief->name);
+		copy_name(brief,&new_brief->brief);
+
+		if (g_link_briefs == NULL)
+		{
+			g_link_briefs = new_brief;
+		}
+		else
+		{
+			g_last_link_brief->next = new_brief;
+		}
+
+		g_last_link_brief = new_brief;
+	}
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : add_block_api
  * Desc : This will add the block for the api. This can add fields to the parts
  *        of the API.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_api(BLOCK_NODE* block, GROUP** local_group_list)
+static unsigned int	add_block_api(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	unsigned int		result = EC_OK;
 	API_RETURNS*		current_return;
@@ -988,7 +1598,7 @@ static unsigned int	add_block_api(BLOCK_NODE* block, GROUP** local_group_list)
 	if (block->group == NULL)
 	{
 		/* if no group defined, default to the default */
-		block->group = local_group_list[0];
+		block->group = locals->groups.items[0];
 	}
 
 	if (block->description.name_length > 0)
@@ -1038,6 +1648,12 @@ static unsigned int	add_block_api(BLOCK_NODE* block, GROUP** local_group_list)
 				current_parameter = current_parameter->next;
 			}
 
+			if (current_parameter == NULL && g_partial_link)
+			{
+				/* the parameter may be in an object of another partial model */
+				link_brief_add(block->api_function,&current_item->name,&current_item->string);
+			}
+
 			current_item = current_item->next;
 		}
 	}
@@ -1099,7 +1715,7 @@ static unsigned int	add_block_api(BLOCK_NODE* block, GROUP** local_group_list)
  * Name : add_block_state
  * Desc : This function will add a state block to the diagram tree.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_block_state(BLOCK_NODE* block, GROUP** local_group_list)
+static unsigned int	add_block_state(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	STATE*				to_state = NULL;
 	GROUP*				owing_group = NULL;
@@ -1115,7 +1731,7 @@ static unsigned int	add_block_state(BLOCK_NODE* block, GROUP** local_group_list)
 	else
 	{
 		/* ok, looks valid lets add it together */
-		if ((to_state = find_state(block->state->group,block->transition.name,block->transition.name_length)) == NULL)
+		if ((to_state = find_state(block->state->group,block->transition.name)) == NULL)
 		{
 			/* cannot find the state, so add a ghost state */
 			to_state = add_state(block->state->group,block->transition.name,block->transition.name_length,block->line_number,FLAG_GHOST);
@@ -1184,7 +1800,7 @@ static unsigned int	add_block_state(BLOCK_NODE* block, GROUP** local_group_list)
  * Name : add_block
  * Desc : This function will add a block to the diagram tree.
  *--------------------------------------------------------------------------------*/
-static unsigned int add_block(BLOCK_NODE* block, GROUP** local_group_list, FUNCTION** local_function_list, APPLICATION** local_application_list )
+static unsigned int add_block(BLOCK_NODE* block, LINK_LOCALS* locals)
 {
 	STATE*				to_state = NULL;
 	GROUP*				owing_group = NULL;
@@ -1197,40 +1813,40 @@ static unsigned int add_block(BLOCK_NODE* block, GROUP** local_group_list, FUNCT
 	/* validate the node first */
 	if (block->type == ATOM_BLOCK_FILE)
 	{
-		result = add_block_file(block,local_group_list);
+		result = add_block_file(block,locals);
 	}
 	else if (block->state != NULL)
 	{
-		result = add_block_state(block,local_group_list);
+		result = add_block_state(block,locals);
 
 	}
 	else if (block->timeline != NULL)
 	{
-		result = add_block_node(block,local_group_list);
+		result = add_block_node(block,locals);
 	}
 	else if (block->api_constants != NULL)
 	{
-		result = add_block_constants(block,local_group_list);
+		result = add_block_constants(block,locals);
 	}
 	else if (block->api_type != NULL)
 	{
-		result = add_block_type(block,local_group_list);
+		result = add_block_type(block,locals);
 	}
 	else if (block->application_id != 0)
 	{
-		result = add_block_application(block,local_group_list,local_application_list);
+		result = add_block_application(block,locals);
 	}
 	else if (block->api_function != NULL || (block->flags & FLAG_IN_FUNCTION) == FLAG_IN_FUNCTION)
 	{
 		/* block can both be an API and a function */
 		if (block->api_function != NULL)
 		{
-			result = add_block_api(block,local_group_list);
+			result = add_block_api(block,locals);
 		}
 
 		if ((block->flags & FLAG_IN_FUNCTION) == FLAG_IN_FUNCTION)
 		{
-			if ((temp = add_block_function(block,local_function_list)) != EC_OK)
+			if ((temp = add_block_function(block,locals)) != EC_OK)
 			{
 				result = temp;
 			}
@@ -1253,52 +1869,50 @@ static unsigned int add_block(BLOCK_NODE* block, GROUP** local_group_list, FUNCT
  * Name : add_numeric_to_block
  * Desc : This function will add the numeric atom to the block.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_numeric_to_block (	GROUP**			local_group_list,
-											FUNCTION**		local_function_list,
-											API_FUNCTION**	local_api_function_list,
-											BLOCK_NODE*		node,
-											unsigned char*	record,
+static unsigned int	add_numeric_to_block (	LINK_OBJECT*	object,
+											LINK_BLOCK*		block,
+											OBJECT_RECORD*	record,
 											unsigned char*	payload,
 											unsigned int	payload_length )
 {
 	unsigned int	result = EC_OK;
-	unsigned int	line_number = line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+	unsigned int	line_number = record->line_number;
 	unsigned int	numeric_value;
 	
 	numeric_value =  ((((unsigned int) payload[0])<< 24) |
 					  (((unsigned int) payload[1])<< 16) |
-					  (((unsigned int) payload[2])<< 16) |
+					  (((unsigned int) payload[2])<< 8) |
 					   ((unsigned int) payload[3]));
 
-	switch(record[RECORD_ATOM])
+	switch(record->atom)
 	{
 		case ATOM_API:
-				if (numeric_value > MAX_GROUPS_PER_FILE)
+				if (numeric_value >= object->locals.api_functions.num_items)
 				{
 					result = EC_UNDEFINED_API;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
-					node->api_function = local_api_function_list[numeric_value];
+					block->api_function = local_reference(&object->locals.api_functions,numeric_value);
 				}
 			break;
 
 		case ATOM_GROUP:
-				if (numeric_value > MAX_GROUPS_PER_FILE)
+				if (numeric_value >= object->locals.groups.num_items)
 				{
 					result = EC_UNDEFINED_GROUP;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
-					node->group = local_group_list[numeric_value];
+					block->group = local_reference(&object->locals.groups,numeric_value);
 				}
 			break;
 
 		default:
 			result = EC_UNKNOWN_ATOM;
-			raise_warning(line_number,result,NULL,NULL);
+			link_warning(object,line_number,result,NULL);
 			break;
 	}
 
@@ -1326,7 +1940,7 @@ static void	add_to_pair_list(NAME_PAIRS_LIST* list, NAME* name, NAME* string)
 		{
 			if (current_item->next == NULL)
 			{
-				current_item->next = malloc(sizeof(NAME_PAIRS_LIST));
+				current_item->next = calloc(1,sizeof(NAME_PAIRS_LIST));
 				copy_name(name,&current_item->next->name);
 				copy_name(string,&current_item->next->string);
 				break;
@@ -1341,19 +1955,18 @@ static void	add_to_pair_list(NAME_PAIRS_LIST* list, NAME* name, NAME* string)
  * Name : add_pair_to_block
  * Desc : This function will add the numeric atom to the block.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_pair_to_block (	GROUP**			local_group_list,
-										FUNCTION**		local_function_list,
-										APPLICATION**	local_application_list,
-										API_FUNCTION**	local_api_function_list,
-										BLOCK_NODE*		node,
-										unsigned char*	record,
+static unsigned int	add_pair_to_block (	LINK_OBJECT*	object,
+										LINK_BLOCK*		block,
+										OBJECT_RECORD*	record,
 										unsigned char*	payload,
 										unsigned int	payload_length )
 {
 	unsigned int	result = EC_OK;
-	unsigned int	line_number = line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-	NAME			name;
-	NAME			string;
+	unsigned int	line_number = record->line_number;
+	NAME			name = {NULL,0,0,0};
+	NAME			string = {NULL,0,0,0};
+	BLOCK_NODE*		node = &block->node;
+	LINK_ITEM*		item;
 
 	name.name			= &payload[2];
 	name.name_length	= ((((unsigned int)payload[0]) << 8) | payload[1]);
@@ -1361,7 +1974,7 @@ static unsigned int	add_pair_to_block (	GROUP**			local_group_list,
 	string.name			= &payload[2 + 2 + name.name_length];
 	string.name_length	= ((((unsigned int)payload[2 + name.name_length]) << 8) | payload[1 + 2 + name.name_length]);
 	
-	switch(record[RECORD_ATOM])
+	switch(record->atom)
 	{
 		case ATOM_PARAMETER:
 			node->num_parameters++;
@@ -1388,37 +2001,20 @@ static unsigned int	add_pair_to_block (	GROUP**			local_group_list,
 			break;
 
 		case ATOM_SYNOPSIS:
-			if (node->application_id > 0)
+			/* the application has the synopsis, it is added when the object is merged */
+			if (node->application_id > 0 && (item = link_item(object,LINK_ITEM_SYNOPSIS,line_number)) != NULL)
 			{
-				APPLICATION*	application = local_application_list[node->application_id];
-
-				if (application != NULL)
-				{
-					if (application->synopsis_list.name.name_length == 0)
-					{
-						/* ad to start */
-						copy_name(&name,&application->synopsis_list.name);
-						copy_name(&string,&application->synopsis_list.items);
-						application->synopsis_list.last = &application->synopsis_list;
-					}
-					else
-					{
-						/* add to end */
-						SYNOPSIS_LIST*	new_synopsis = calloc(1,sizeof(SYNOPSIS_LIST));
-
-						copy_name(&name,&new_synopsis->name);
-						copy_name(&string,&new_synopsis->items);
+				item->id = node->application_id;
+				item->data.synopsis = calloc(1,sizeof(SYNOPSIS_LIST));
 
-						application->synopsis_list.last->next = new_synopsis;
-						application->synopsis_list.last = new_synopsis;
-					}
-				}
+				copy_name(&name,&item->data.synopsis->name);
+				copy_name(&string,&item->data.synopsis->items);
 			}
 			break;
 
 		default:
 			result = EC_UNKNOWN_ATOM;
-			raise_warning(line_number,result,NULL,NULL);
+			link_warning(object,line_number,result,NULL);
 			break;
 	}
 
@@ -1429,11 +2025,9 @@ static unsigned int	add_pair_to_block (	GROUP**			local_group_list,
  * Name : add_atom_to_constant
  * Desc : This function will add the atom to the block. 
   *--------------------------------------------------------------------------------*/
-static unsigned int	add_atom_to_constant(	GROUP** 		local_group_list,
-										FUNCTION**		local_function_list,
-										API_FUNCTION**	local_api_function_list,
+static unsigned int	add_atom_to_constant(	LINK_OBJECT*	object,
 										BLOCK_NODE*		node,
-										unsigned char*	record,
+										OBJECT_RECORD*	record,
 										unsigned char*	payload,
 										unsigned int	payload_length )
 {
@@ -1445,7 +2039,7 @@ static unsigned int	add_atom_to_constant(	GROUP** 		local_group_list,
 	temp.fixed = fixed;
 	temp.name_length = payload_length - 1;
 
-	switch(record[RECORD_ATOM])
+	switch(record->atom)
 	{
 		case ATOM_DESC:
 		case ATOM_DESCRIPTION:
@@ -1467,13 +2061,13 @@ static unsigned int	add_atom_to_constant(	GROUP** 		local_group_list,
 				else
 				{
 					result = EC_DOUBLE_DESCRIPTOR_FOUND;
-					raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+					link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 				}
 			}
 			else
 			{
 				result = EC_BRIEF_WITHOUT_A_TYPE;
-				raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+				link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 			}
 			break;
 
@@ -1499,7 +2093,7 @@ static unsigned int	add_atom_to_constant(	GROUP** 		local_group_list,
 
 		default:
 			result = EC_UNEXPECTED_ATOM;
-			raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+			link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 	}
 
 	return result;
@@ -1581,11 +2175,9 @@ static unsigned int	extend_section(APPLICATION* application, unsigned char* name
  * Name : add_atom_to_type
  * Desc : This function will add the atom to the block. 
   *--------------------------------------------------------------------------------*/
-static unsigned int	add_atom_to_type(	GROUP** 		local_group_list,
-									FUNCTION**		local_function_list,
-									API_FUNCTION**	local_api_function_list,
+static unsigned int	add_atom_to_type(	LINK_OBJECT*	object,
 									BLOCK_NODE*		node,
-									unsigned char*	record,
+									OBJECT_RECORD*	record,
 									unsigned char*	payload,
 									unsigned int	payload_length )
 {
@@ -1597,7 +2189,7 @@ static unsigned int	add_atom_to_type(	GROUP** 		local_group_list,
 	temp.fixed = fixed;
 	temp.name_length = payload_length - 1;
 
-	switch(record[RECORD_ATOM])
+	switch(record->atom)
 	{
 		case ATOM_NAME:
 			if (node->api_type->depth > 0)
@@ -1618,7 +2210,7 @@ static unsigned int	add_atom_to_type(	GROUP** 		local_group_list,
 			break;
 
 		case ATOM_TYPE:
-			add_api_type_record(node->api_type,record[RECORD_ATOM],NULL,&temp,NULL);
+			add_api_type_record(node->api_type,record->atom,NULL,&temp,NULL);
 			break;
 
 		case ATOM_BRIEF:
@@ -1631,19 +2223,19 @@ static unsigned int	add_atom_to_type(	GROUP** 		local_group_list,
 				else
 				{
 					result = EC_DOUBLE_DESCRIPTOR_FOUND;
-					raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+					link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 				}
 			}
 			else
 			{
 				result = EC_BRIEF_WITHOUT_A_TYPE;
-				raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+				link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 			}
 			break;
 
 		default:
 			result = EC_UNEXPECTED_ATOM;
-			raise_warning (0,result,node->api_constants->last_constant->brief.name,NULL);
+			link_warning(object,0,result,node->api_constants->last_constant->brief.name);
 	}
 
 	return result;
@@ -1651,31 +2243,29 @@ static unsigned int	add_atom_to_type(	GROUP** 		local_group_list,
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : add_atom_to_block
- * Desc : This function will add the atom to the block. 
- *
- * TODO: fix this code it knows the record format, and it should not. Means that
- *       too many functions have to be changed when the format changes.
+ * Desc : This function will add the atom to the block. The names are left in
+ *        the object, and the states and timelines are looked up when the block
+ *        is merged.
  *--------------------------------------------------------------------------------*/
-static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
-									FUNCTION**		local_function_list,
-									APPLICATION**	local_application_list,
-									API_FUNCTION**	local_api_function_list,
-									BLOCK_NODE*		node,
-									unsigned char*	record,
+static unsigned int	add_atom_to_block ( LINK_OBJECT*	object,
+									LINK_BLOCK*		block,
+									OBJECT_RECORD*	record,
 									unsigned char*	payload,
 									unsigned int	payload_length )
 {
 	unsigned int	in_function = 0;
 	unsigned int	result = EC_OK;
 	unsigned int	line_number = 0;
-	unsigned int	group_id = ((record[RECORD_GROUP]<< 8) | record[RECORD_GROUP+1]);
+	unsigned int	group_id = record->group;
 	unsigned int	application_id = group_id;
 	unsigned int	string_length = payload_length - 1;
 	unsigned char	fixed = payload[0];
 	unsigned char*	string = &payload[1];
 	NAME			temp;
-	TRIGGER*		trigger;
-	FUNCTION*		function;
+	BLOCK_NODE*		node = &block->node;
+	LINK_LOOKUP*	timeline;
+	LINK_ITEM*		item;
+	LINK_LOCALS*	locals = &object->locals;
 
 	temp.name	= string;
 	temp.fixed	= fixed;
@@ -1687,17 +2277,17 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 		node->flags |= FLAG_IN_FUNCTION;
 		group_id &= ~RECORD_FUNC_API_MASK;
 	
-		node->function = local_function_list[group_id+1];
+		block->function = group_id + 1;
 
 		in_function = 1;
 	}
 
 	if (group_id != DEFAULT_GROUP && ((group_id & RECORD_FUNC_API_MASK) == RECORD_API_FLAG))
 	{
-		node->api_function = local_api_function_list[(~RECORD_FUNC_API_MASK) & group_id];
+		block->api_function = local_reference(&locals->api_functions,(~RECORD_FUNC_API_MASK) & group_id);
 	}
 	
-	switch(record[RECORD_ATOM])
+	switch(record->atom)
 	{
 		case ATOM_FILE:
 			node->type = ATOM_BLOCK_FILE;
@@ -1707,13 +2297,13 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			if (node->author.name_length > 0)
 			{
 				result = EC_MULTIPLE_AUTHORS_IN_ONE_BLOCK;
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,result,NULL,NULL);
+				line_number = record->line_number;
+				link_warning(object,line_number,result,NULL);
 			}
 			else
 			{
 				node->author.name_length = string_length;
-				memcpy(node->author.name,string,string_length);
+				node->author.name = string;
 			}
 			break;
 
@@ -1745,50 +2335,51 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 				group_id = 0;
 			}
 				
-			node->group = local_group_list[group_id];
+			block->group = local_reference(&locals->groups,group_id);
 
-			if (node->state != NULL)
+			if (block->group == 0)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_MULTIPLE_STATES_IN_ONE_BLOCK,NULL,NULL);
-				result = EC_MULTIPLE_STATES_IN_ONE_BLOCK;
+				line_number = record->line_number;
+				result = EC_UNDEFINED_GROUP;
+				link_warning(object,line_number,result,NULL);
 			}
-			else if (node->timeline != NULL)
+			else if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_MIXED_DIAGRAM_TYPES_IN_BLOCK,NULL,NULL);
-				result = EC_MIXED_DIAGRAM_TYPES_IN_BLOCK;
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_MULTIPLE_STATES_IN_ONE_BLOCK,NULL);
+				result = EC_MULTIPLE_STATES_IN_ONE_BLOCK;
 			}
-			else if ((node->state = find_state(local_group_list[group_id],string,string_length)) == NULL)
+			else if (link_has_lookup(block,LINK_LOOKUP_TIMELINE) != NULL)
 			{
-				node->state = add_state(local_group_list[group_id],string,string_length,node->line_number,0);
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_MIXED_DIAGRAM_TYPES_IN_BLOCK,NULL);
+				result = EC_MIXED_DIAGRAM_TYPES_IN_BLOCK;
 			}
-			else if ((node->state->flags & FLAG_GHOST) == FLAG_GHOST)
+			else
 			{
-				node->state->flags &= ~FLAG_GHOST;
-				node->state->line_number = node->line_number;
+				link_lookup(block,LINK_LOOKUP_STATE,group_id,string,string_length);
 			}
 			break;
 
 		case ATOM_NEXT:
-			if (node->timeline != NULL)
+			if (link_has_lookup(block,LINK_LOOKUP_TIMELINE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_WRONG_ATOM_IN_BLOCK,NULL,NULL);
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_WRONG_ATOM_IN_BLOCK,NULL);
 				result = EC_WRONG_ATOM_IN_BLOCK;
 			}
 			else
 			{
 				if (node->transition.name_length > 0)
 				{
-					line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+					line_number = record->line_number;
 					result = EC_DUPLICATE_TRANSITION;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
-					memcpy(node->transition.name,string,string_length);
-					node->transition.owner.group = local_group_list[group_id];
+					node->transition.name = string;
+					node->transition.owner.local_group = local_reference(&locals->groups,group_id);
 					node->transition.name_length = string_length;
 				}
 			}
@@ -1798,20 +2389,20 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			/* condition for a state condition */
 			if (node->condition.name_length > 0)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_DUPLICATE_CONDITION_IN_TRANSITION;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else if (node->trigger != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_CANNOT_HAVE_TRIGGER_AND_CONDITION_IN_TRANSITION;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else
 			{
-				memcpy(node->condition.name,string,string_length);
-				node->condition.owner.group = local_group_list[group_id];
+				node->condition.name = string;
+				node->condition.owner.local_group = local_reference(&locals->groups,group_id);
 				node->condition.name_length = string_length;
 			}
 			break;
@@ -1819,23 +2410,23 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 		case ATOM_TRIGGER:
 			if (node->condition.name_length > 0)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_CANNOT_HAVE_TRIGGER_AND_CONDITION_IN_TRANSITION;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else if (node->trigger != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_MULTIPLE_TRIGGER;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else 
 			{
 				/* add the trigger reference */
 				node->trigger = calloc(1,sizeof(BLOCK_NAME));
-				node->trigger->owner.group = local_group_list[group_id];
+				node->trigger->owner.local_group = local_reference(&locals->groups,group_id);
 				node->trigger->name_length = string_length;
-				memcpy(node->trigger->name,string,string_length);
+				node->trigger->name = string;
 			}
 			break;
 
@@ -1843,9 +2434,9 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			{
 				BLOCK_NAME* temp = node->triggers_list;
 				node->triggers_list = calloc(1,sizeof(BLOCK_NAME));
-				node->triggers_list->owner.group = local_group_list[group_id];
+				node->triggers_list->owner.local_group = local_reference(&locals->groups,group_id);
 				node->triggers_list->name_length = string_length;
-				memcpy(node->triggers_list->name,string,string_length);
+				node->triggers_list->name = string;
 				node->triggers_list->next = temp;
 			}
 			break;
@@ -1858,108 +2449,118 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 
 			if (in_function)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_CANNOT_CALL_HAVE_THESE_ATOMS_IN_A_FUNCTION;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
-			if (node->timeline != NULL)
+			if (link_has_lookup(block,LINK_LOOKUP_TIMELINE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_MULTIPLE_TIMELINES_IN_ONE_BLOCK;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
-			else if (node->state != NULL)
+			else if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_MIXED_DIAGRAM_TYPES_IN_BLOCK;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
+			}
+			else if (local_reference(&locals->groups,group_id) == 0)
+			{
+				line_number = record->line_number;
+				result = EC_UNDEFINED_GROUP;
+				link_warning(object,line_number,result,NULL);
 			}
-			else if ((node->timeline = find_timeline(local_group_list[group_id],string,string_length)) == NULL)
+			else
 			{
-				node->timeline = add_timeline(local_group_list[group_id],string,string_length,node->line_number,0);
+				link_lookup(block,LINK_LOOKUP_TIMELINE,group_id,string,string_length);
 			}
 
-			node->group = node->timeline->group;
+			/* the block is in the group of the timeline */
+			if ((timeline = link_has_lookup(block,LINK_LOOKUP_TIMELINE)) != NULL)
+			{
+				block->group = timeline->group + 1;
+			}
 			break;
 
 		case ATOM_CALL:
 		case ATOM_SEND:
 		case ATOM_RESPONDS:
-			if (node->state != NULL)
+			if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_WRONG_ATOM_IN_BLOCK,NULL,NULL);
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_WRONG_ATOM_IN_BLOCK,NULL);
 				result = EC_WRONG_ATOM_IN_BLOCK;
 			}
 			else
 			{
 				if (node->message.name_length > 0)
 				{
-					line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+					line_number = record->line_number;
 					result = EC_DUPLICATE_MESSAGE;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
-					if (record[RECORD_ATOM] == ATOM_SEND)
+					if (record->atom == ATOM_SEND)
 						node->flags |= FLAG_MESSAGE_SEND;
-					else if (record[RECORD_ATOM] == ATOM_RESPONDS)
+					else if (record->atom == ATOM_RESPONDS)
 						node->flags |= FLAG_SEQUENCE_RESPONDS;
 					else
 						node->flags |= FLAG_MESSAGE_CALL;
 
-					node->message.owner.group = local_group_list[group_id];
-					memcpy(node->message.name,string,string_length);
+					node->message.owner.local_group = local_reference(&locals->groups,group_id);
+					node->message.name = string;
 					node->message.name_length = string_length;
 				}
 			}
 			break;
 
 		case ATOM_AFTER:
-			if (node->state != NULL)
+			if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_WRONG_ATOM_IN_BLOCK,NULL,NULL);
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_WRONG_ATOM_IN_BLOCK,NULL);
 				result = EC_WRONG_ATOM_IN_BLOCK;
 			}
 			else
 			{
 				if (node->after.name_length > 0)
 				{
-					line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+					line_number = record->line_number;
 					result = EC_DUPLICATE_AFTER;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
-					node->after.owner.group = local_group_list[group_id];
-					memcpy(node->after.name,string,string_length);
+					node->after.owner.local_group = local_reference(&locals->groups,group_id);
+					node->after.name = string;
 					node->after.name_length = string_length;
 				}
 			}
 			break;
 
 		case ATOM_WAITFOR:
-			if (node->state != NULL)
+			if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-				raise_warning(line_number,EC_WRONG_ATOM_IN_BLOCK,NULL,NULL);
+				line_number = record->line_number;
+				link_warning(object,line_number,EC_WRONG_ATOM_IN_BLOCK,NULL);
 				result = EC_WRONG_ATOM_IN_BLOCK;
 			}
 			else
 			{
 				if (node->sequence.name_length > 0)
 				{
-					line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+					line_number = record->line_number;
 					result = EC_DUPLICATE_SEQUENCE;
-					raise_warning(line_number,result,NULL,NULL);
+					link_warning(object,line_number,result,NULL);
 				}
 				else
 				{
 					node->flags |= FLAG_SEQUENCE_WAITFOR;
 
-					node->sequence.owner.group = local_group_list[group_id];
-					memcpy(node->sequence.name,string,string_length);
+					node->sequence.owner.local_group = local_reference(&locals->groups,group_id);
+					node->sequence.name = string;
 					node->sequence.name_length = string_length;
 				}
 			}
@@ -1971,61 +2572,80 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 				group_id = 0;
 			}
 
-			if (node->to_timeline != NULL || node->function_to_timeline.name_length > 0)
+			if (link_has_lookup(block,LINK_LOOKUP_TO) != NULL || node->function_to_timeline.name_length > 0)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_MULTIPLE_TO_TIMELINES_IN_ONE_BLOCK;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
-			else if (node->state != NULL)
+			else if (link_has_lookup(block,LINK_LOOKUP_STATE) != NULL)
 			{
-				line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
+				line_number = record->line_number;
 				result = EC_MIXED_DIAGRAM_TYPES_IN_BLOCK;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else if (in_function)
 			{
 				/* have to differ the lookup till we know what the group the function will be unpacked in
 				 * will be, so just save the name.
 				 */
-				memcpy(node->function_to_timeline.name,string,string_length);
+				node->function_to_timeline.name = string;
 				node->function_to_timeline.name_length = string_length;
 			}
-			else if ((node->to_timeline = find_timeline(local_group_list[group_id],string,string_length)) == NULL)
+			else if (local_reference(&locals->groups,group_id) == 0)
+			{
+				line_number = record->line_number;
+				result = EC_UNDEFINED_GROUP;
+				link_warning(object,line_number,result,NULL);
+			}
+			else
 			{
-				node->to_timeline = add_timeline(local_group_list[group_id],string,string_length,node->line_number,0);
+				link_lookup(block,LINK_LOOKUP_TO,group_id,string,string_length);
 			}
 			break;
 
 			/* handle atoms that take a name */
 		case ATOM_ACTIVATION:
-			printf("ignoring activation\n");
+			link_note(object,"ignoring activation\n",0);
 			break;
 
 			/* string atoms */
 		case ATOM_REPEATS:
-			printf("ignoring repeat\n");
+			link_note(object,"ignoring repeat\n",0);
 			break;
 
 		case ATOM_COPYRIGHT:
-			printf("ignoring copyright\n");
+			link_note(object,"ignoring copyright\n",0);
 			break;
 
 		case ATOM_SECTION:
 			if (application_id != 0)
 			{
 				node->application_id = application_id; 
-				new_section(local_application_list[application_id],string,string_length,fixed);
+
+				if ((item = link_item(object,LINK_ITEM_SECTION,record->line_number)) != NULL)
+				{
+					item->id = application_id;
+					item->value = fixed;
+					item->name = string;
+					item->name_length = string_length;
+				}
 			}
 			else if (node->application_id != 0)
 			{
 				/* need to extend the section data */
-				extend_section(local_application_list[node->application_id],string,string_length,fixed);
+				if ((item = link_item(object,LINK_ITEM_SECTION_DATA,record->line_number)) != NULL)
+				{
+					item->id = node->application_id;
+					item->value = fixed;
+					item->name = string;
+					item->name_length = string_length;
+				}
 			}
 			else
 			{
 				result = EC_ATOM_REQUIRES_APPLICATION_ATOM;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			break;
 
@@ -2033,7 +2653,7 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			if (node->option.name != NULL)
 			{
 				result = EC_MULTIPLE_DEFINITION_OPTION;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else
 			{
@@ -2050,7 +2670,7 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			if (node->value.name != NULL)
 			{
 				result = EC_MULTIPLE_DEFINITION_VALUE;
-				raise_warning(line_number,result,NULL,NULL);
+				link_warning(object,line_number,result,NULL);
 			}
 			else
 			{
@@ -2064,9 +2684,9 @@ static unsigned int	add_atom_to_block ( GROUP** 		local_group_list,
 			break;
 
 		default:
-			printf("atom: %d\n",record[RECORD_ATOM]);
-			line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-			raise_warning(line_number,EC_UNKNOWN_ATOM,NULL,NULL);
+			link_note(object,"atom: %d\n",record->atom);
+			line_number = record->line_number;
+			link_warning(object,line_number,EC_UNKNOWN_ATOM,NULL);
 			result = EC_UNKNOWN_ATOM;
 			break;
 	}
@@ -2192,2215 +2812,6178 @@ static void	new_constant(API_CONSTANTS* constants)
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : process_input
- * Desc : This function will read an input file and add the atoms to the set if
- *        atoms. It will also handle the first parse on the building of the 
- *        connections.
+ * Name : read_long
+ * Desc : This function reads a four byte number from the buffer.
  *--------------------------------------------------------------------------------*/
-static unsigned int	process_input(const char* filename)
+static unsigned int	read_long(unsigned char* buffer)
 {
-	int				infile;
-	int				bytes_read;
-	unsigned int 	result = 0;
-	unsigned int	special_group;
-	unsigned int	in_api_group = 0;
-	unsigned int	line_number = 0;
-	unsigned int	num_groups = 1;
-	unsigned int	num_functions = 1;
-	unsigned int	num_applications = 0;
-	unsigned int	num_api_functions = 0;
-	unsigned int	record_size;
-	unsigned int	file_name_size;
-	unsigned int	new_block_number;
-	unsigned int	current_api_function = MAX_GROUPS_PER_FILE;
-	unsigned char	signature[4] = COMPILED_SOURCE_MAGIC;
-	unsigned char	record[RECORD_DATA_START];
-	unsigned char	header[FILE_HEADER_SIZE];
-	unsigned short	group;
-	NAME			type;
-	NAME			name;
-	NAME			brief;
-	BLOCK_NODE		block_node;
-
-	static GROUP*			local_group[MAX_GROUPS_PER_FILE];
-	static FUNCTION*		local_functions[MAX_GROUPS_PER_FILE];
-	static APPLICATION*		local_applications[MAX_GROUPS_PER_FILE];
-	static API_FUNCTION*	local_api_functions[MAX_GROUPS_PER_FILE];
-	static unsigned char	source_file_name[MAX_FILENAME+1];
-
-	memset(&block_node,0,sizeof(block_node));
-	block_node.line_number = 0;
+	return	(((unsigned int)buffer[0]) << 24) |
+			(((unsigned int)buffer[1]) << 16) |
+			(((unsigned int)buffer[2]) << 8)  |
+			buffer[3];
+}
 
-	local_group[0] = &g_group_tree;
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_source_read
+ * Desc : This function will read the table of contents and the link state of
+ *        the previous model. The names and sections are left in the model so
+ *        it must stay mapped. Any problem with the model means it cannot be
+ *        used.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_source_read(LINK_SOURCE* source, unsigned char* data, unsigned int size)
+{
+	unsigned int	result = EC_FAILED;
+	unsigned int	count;
+	unsigned int	touch;
+	unsigned int	start;
+	unsigned int	length;
+	unsigned int	toc_offset = 0;
+	unsigned int	num_entries = 0;
+	unsigned int	strings = 0;
+	unsigned int	strings_length = 0;
+	unsigned int	state_start = 0;
+	unsigned int	state_end = 0;
+	unsigned int	pos;
+	unsigned char	signature[4] = LINKED_SOURCE_V2_MAGIC;
+	unsigned char*	entry;
+	LINK_STATE_OBJECT*	object;
+
+	memset(source,0,sizeof(LINK_SOURCE));
+
+	source->data = data;
+	source->size = size;
+
+	if (size >= LINKER_V2_HEADER_SIZE &&
+		memcmp(data,signature,4) == 0 &&
+		read_long(&data[LINKER_V2_FILE_SIZE_OFF]) == size)
+	{
+		toc_offset = read_long(&data[LINKER_V2_TOC_OFF]);
+		num_entries = read_long(&data[LINKER_V2_TOC_ENTRIES_OFF]);
 
-	g_input_filename = NULL;
-	g_source_filename = source_file_name;
-	g_source_filename[0] = '\0';
+		if (toc_offset >= LINKER_V2_HEADER_SIZE &&
+			toc_offset <= size &&
+			num_entries <= (size - toc_offset) / LINKER_TOC_ENTRY_SIZE &&
+			(source->groups = calloc(num_entries + 1,sizeof(LINK_STATE_SECTION))) != NULL)
+		{
+			result = EC_OK;
+		}
+	}
 
-	if ((infile = open(filename,READ_FILE_STATUS,0)) != -1)
+	/* find the sections */
+	for (count=0; result == EC_OK && count < num_entries; count++)
 	{
-		/* reset the local list */
-		num_groups = 1;
-		num_functions = 1;
+		entry = &data[toc_offset + (count * LINKER_TOC_ENTRY_SIZE)];
+		start = read_long(&entry[LINKER_TOC_OFFSET]);
+		length = read_long(&entry[LINKER_TOC_LENGTH]);
 
-		if (read(infile,header,FILE_HEADER_SIZE) == FILE_HEADER_SIZE)
+		if (start > size || length > size - start)
+		{
+			result = EC_FAILED;
+		}
+		else
 		{
-			if(memcmp(header,signature,4) == 0)
+			switch (entry[LINKER_TOC_TYPE])
 			{
-				/* we have a object file -- we are ignoring all other files at this pass */
-				if (header[FILE_VERSION_MAJOR] > VERSION_MAJOR)
-				{
-					raise_warning(0,EC_INPUT_FILE_BUILT_WITH_LATER_MAJOR_VERSION,NULL,NULL);
-					result = 1;
-				}
-
-				/* read the input file name */
-				file_name_size = ((((unsigned int)header[FILE_NAME_START]) << 8) | header[FILE_NAME_START+1]);
-
-				if (file_name_size < MAX_FILENAME)
-				{
-					bytes_read = read(infile,source_file_name,file_name_size);
-					g_source_filename_length = file_name_size;
-				}
-				else
-				{
-					while(file_name_size > MAX_FILENAME)
-					{
-						read(infile,source_file_name,MAX_FILENAME);
-						file_name_size -= MAX_FILENAME;
-					}
-
-					bytes_read = read(infile,source_file_name,MAX_FILENAME);
-				}
-
-				source_file_name[bytes_read] = '\0';
-
-				/* now read the atoms */
-				while ((bytes_read = read(infile,record,RECORD_DATA_START)) == RECORD_DATA_START)
-				{
-					line_number = ((((unsigned int)record[RECORD_LINE_NUM]) << 8) | record[RECORD_LINE_NUM+1]);
-					record_size = ((((unsigned int)record[RECORD_DATA_SIZE]) << 8) | record[RECORD_DATA_SIZE+1]);
-					new_block_number = ((((unsigned int)record[RECORD_BLOCK_NUM]) << 8) | record[RECORD_BLOCK_NUM+1]);
-
-					/* check to see if the block number changes */
-					if (new_block_number != block_node.block_number && !in_api_group)
-					{
-						/* ignore all blocks that are found while in a type */
-						if (block_node.line_number != 0)
-						{
-							/* add the block to the output */
-							add_block(&block_node,local_group,local_functions,local_applications);
-						}
-
-						memset(&block_node,0,sizeof(block_node));
-						block_node.line_number = line_number;
-						block_node.block_number = new_block_number;
-					}
-
-					if (record_size > 0 && read(infile,record_buffer,record_size) != record_size)
-					{
-						/* failed to read the record --- problem with the file */
-						raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)filename,NULL);
-						result = 1;
-					}
-					else
-					{
-						switch(record[RECORD_TYPE])
-						{
-							case INTERMEDIATE_RECORD_EMPTY:
-								if (record[RECORD_ATOM] == ATOM_API)
-								{
-									current_api_function = MAX_GROUPS_PER_FILE;
-								}
-								else if (record[RECORD_ATOM] == ATOM_CONSTANTS)
-								{
-									/* Start the CONSTANT grouping */
-									if (block_node.api_constants != NULL)
-									{
-										result = EC_MULTIPLE_CONSTANTS_REQUEST_WITHOUT_END;
-										raise_warning(line_number,result,NULL,NULL);
-									}
-									else
-									{
-										block_node.api_constants = calloc(1,sizeof(API_CONSTANTS));
-										in_api_group = 1;
-									}
-								}
-								else if (record[RECORD_ATOM] == ATOM_END_CONSTANTS)
-								{
-									/* End the CONSTANT grouping */
-									in_api_group = 0;
-								}
-								break;
-
-							case INTERMEDIATE_RECORD_FUNCTION:
-								if ((local_functions[num_functions] = find_function(record_buffer,record_size)) == NULL)
-								{
-									local_functions[num_functions] = add_function(record_buffer,record_size,0);
-								}
-								num_functions++;
-								break;
-
-							case INTERMEDIATE_RECORD_APPLICATION:
-								local_applications[num_applications] = find_add_application(record_buffer,record_size);
-								num_applications++;
-								break;
-
-							case INTERMEDIATE_RECORD_SAMPLE:
-								 add_sample(record_buffer,record_size);
-								break;
-
-							case INTERMEDIATE_RECORD_API:
-								group = (((unsigned int)(record[RECORD_GROUP]) << 8) | record[RECORD_GROUP+1]);
+				case LINKER_SECTION_STRINGS:
+					strings = start;
+					strings_length = length;
+					break;
 
-								if (group == DEFAULT_GROUP)
-								{
-									group = 0;
-								}
+				case LINKER_SECTION_SAMPLES:
+					source->samples.data = &data[start];
+					source->samples.length = length;
+					break;
 
-								if (current_api_function != MAX_GROUPS_PER_FILE)
-								{
-									result = EC_NESTED_FUNCTION_DEFINITIONS_NOT_ALLOWED;
-									raise_warning(line_number,result,NULL,NULL);
-								}
+				case LINKER_SECTION_APPLICATIONS:
+					source->applications.data = &data[start];
+					source->applications.length = length;
+					break;
 
-								if ((local_api_functions[num_api_functions] = find_api_function(record_buffer,record_size,local_group[group])) == NULL)
-								{
-									local_api_functions[num_api_functions] = add_api_function(record_buffer,record_size,local_group[group]);
-								}
+				case LINKER_SECTION_GROUP:
+					source->groups[source->num_groups].data = &data[start];
+					source->groups[source->num_groups].length = length;
+					source->groups[source->num_groups].name_length = entry[LINKER_TOC_NAME_LENGTH];
+					source->groups[source->num_groups].name = &entry[LINKER_TOC_NAME_OFFSET];
+					source->num_groups++;
+					break;
 
-								current_api_function = num_api_functions;
-								num_api_functions++;
-								break;
+				case LINKER_SECTION_LINK_STATE:
+					state_start = start;
+					state_end = start + length;
+					break;
+			}
+		}
+	}
 
-							case INTERMEDIATE_RECORD_TYPE:
-								result = decode_type(record_buffer,record_size,&type,&name,&brief);
-	
-								if (block_node.api_type != NULL)
-								{
-									add_api_type_record(block_node.api_type,ATOM_TYPE_RECORD,&type,&name,&brief);
-								}
-								else if (block_node.api_constants != NULL)
-								{
-									add_api_constant_record(block_node.api_constants,ATOM_TYPE_RECORD,&type,&name,&brief);
-								}
-								else if (current_api_function != MAX_GROUPS_PER_FILE)
-								{
-									decode_api_function_type(local_api_functions[current_api_function],record[RECORD_ATOM],&type,&name,&brief);
-								}
-								else
-								{
-									result = EC_TYPE_DEFINITION_IN_INVALID_PLACE;
-									raise_warning(line_number,result,NULL,NULL);
-								}
-								break;
+	/* the group names are in the strings, the first group is the document */
+	for (count=0; result == EC_OK && count < source->num_groups; count++)
+	{
+		start = read_long(source->groups[count].name);
 
-							case INTERMEDIATE_RECORD_GROUP:
-								/* does not have a name then it should map to the default */
-								if (record_size > 0)
-								{
-									if ((local_group[num_groups] = find_group(&g_group_tree,record_buffer,record_size,&special_group)) == NULL)
-									{
-										if (special_group != NORMAL_GROUP)
-										{
-											result = EC_SPECIFIED_SPECIAL_GROUP_IN_MODEL;
-											raise_warning(line_number,result,NULL,NULL);
-										}
-
-										local_group[num_groups] = add_group(&g_group_tree,record_buffer,record_size);
-									}
-
-									num_groups++;
-								}
-								break;
+		if (start > strings_length || source->groups[count].name_length > strings_length - start)
+		{
+			result = EC_FAILED;
+		}
+		else
+		{
+			source->groups[count].name = &data[strings + start];
+			symbol_table_add(&source->group_names,NULL,source->groups[count].name,source->groups[count].name_length,&source->groups[count]);
+		}
+	}
 
-							case INTERMEDIATE_RECORD_NAME:
-							case INTERMEDIATE_RECORD_STRING:
-							case INTERMEDIATE_RECORD_MULTILINE:
-								if (block_node.api_constants != NULL)
-								{
-									add_atom_to_constant( 	local_group,
-															local_functions,
-															local_api_functions,
-															&block_node,
-															record,
-															record_buffer,
-															record_size);
-								}
-								else if (block_node.api_type != NULL)
-								{
-									add_atom_to_type( 	local_group,
-														local_functions,
-														local_api_functions,
-														&block_node,
-														record,
-														record_buffer,
-														record_size);
-								}
-								else
-								{
-									add_atom_to_block(	local_group,
-														local_functions,
-														local_applications,
-														local_api_functions,
-														&block_node,
-														record,
-														record_buffer,
-														record_size);
-								}
-								break;
-
-							case INTERMEDIATE_RECORD_NUMBERIC:
-								add_numeric_to_block(	local_group,
-														local_functions,
-														local_api_functions,
-														&block_node,
-														record,
-														record_buffer,
-														record_size);
-								break;
-
-							case INTERMEDIATE_RECORD_PAIR:
-								add_pair_to_block(	local_group,
-													local_functions,
-													local_applications,
-													local_api_functions,
-													&block_node,
-													record,
-													record_buffer,
-													record_size);
-								break;
+	if (result == EC_OK && (source->num_groups == 0 || source->groups[0].name_length != 0 || state_end - state_start < 4))
+	{
+		result = EC_FAILED;
+	}
 
-							case INTERMEDIATE_RECORD_START:
-								group = (((unsigned int)(record[RECORD_GROUP]) << 8) | record[RECORD_GROUP+1]);
+	/* now the objects of the link */
+	if (result == EC_OK)
+	{
+		pos = state_start + 4;
+		source->num_objects = read_long(&data[state_start]);
 
-								if (group == DEFAULT_GROUP)
-								{
-									group = 0;
-								}
+		if (source->num_objects > (state_end - pos) / 14 ||
+			(source->objects = calloc(source->num_objects + 1,sizeof(LINK_STATE_OBJECT))) == NULL)
+		{
+			result = EC_FAILED;
+		}
 
-								/* types can be created here */
-								/* TODO: this is wrong -- all types must have a type block - originally coded badly.
-								 * so this should be fixed.
-								 *
-								 * The constants are correct already.
-								 */
-								if (record[RECORD_ATOM] != RECORD_GROUP_CONSTANT)
-								{
-									block_node.api_type = calloc(1,sizeof(API_TYPE));
-									in_api_group = 1;
-								}
-								else if (block_node.api_constants == NULL)
-								{
-									raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)filename,NULL);
-								}
-								else
-								{
-									new_constant(block_node.api_constants);
-								}
+		for (count=0; result == EC_OK && count < source->num_objects; count++)
+		{
+			object = &source->objects[count];
 
-								break;
+			if (state_end - pos < 2)
+			{
+				result = EC_FAILED;
+				break;
+			}
 
-							case INTERMEDIATE_RECORD_END:
-								if (block_node.api_type != NULL)
-								{
-									in_api_group = 0;
-								}
-								break;
+			object->name_length = (data[pos] << 8) | data[pos+1];
+			object->name = &data[pos+2];
+			pos += 2 + object->name_length;
 
-							case INTERMEDIATE_RECORD_BOOLEAN:
-								{
-									unsigned int	flags = 0;
+			if (pos > state_end || state_end - pos < 12)
+			{
+				result = EC_FAILED;
+				break;
+			}
 
-									switch(record[RECORD_ATOM])
-									{
-										case ATOM_REQUIRED: flags = OPTION_FLAG_REQUIRED; break;
-										case ATOM_MULTIPLE: flags = OPTION_FLAG_MULTIPLE; break;
-									}
+			object->size = read_long(&data[pos]);
+			object->fingerprint = read_long(&data[pos+4]);
+			object->num_touches = read_long(&data[pos+8]);
+			pos += 12;
 
-									block_node.application_flag |= flags;
-								}
-								break;
+			if (object->num_touches > (state_end - pos) / 3 ||
+				(object->touches = calloc(object->num_touches + 1,sizeof(LINK_TOUCH))) == NULL)
+			{
+				result = EC_FAILED;
+				break;
+			}
 
-							default:
-								printf("%d\n",record[RECORD_TYPE]);
-								raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)filename,NULL);
-								result = 1;
-						}
-					}
+			for (touch=0; touch < object->num_touches; touch++)
+			{
+				if (state_end - pos < 3)
+				{
+					result = EC_FAILED;
+					break;
 				}
 
-				if (block_node.line_number != 0)
+				object->touches[touch].type = data[pos];
+				object->touches[touch].name_length = (data[pos+1] << 8) | data[pos+2];
+				object->touches[touch].name = &data[pos+3];
+				pos += 3 + object->touches[touch].name_length;
+
+				if (pos > state_end || object->touches[touch].type == 0 || object->touches[touch].type > LINK_TOUCH_APPLICATIONS)
 				{
-					add_block(&block_node,local_group,local_functions,local_applications);
+					result = EC_FAILED;
+					break;
 				}
 			}
-			else
-			{
-				raise_warning(0,EC_INPUT_FILE_SIGNATURE_INCORRECT,(unsigned char*)filename,NULL);
-				result = 1;
-			}
-		}
 
-		close(infile);
+			symbol_table_add(&source->object_names,NULL,object->name,object->name_length,object);
+		}
 	}
 
-	g_source_filename = NULL;
-
 	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : check_state_machine
- * Desc : This function will check to see if the state machine is valid.
+ * Name : link_source_release
+ * Desc : This function releases the link state of a model. It does not unmap
+ *        the model.
  *--------------------------------------------------------------------------------*/
-static unsigned int	check_state_machine(STATE_MACHINE* state_machine)
+static void	link_source_release(LINK_SOURCE* source)
 {
-	unsigned int		result = EC_OK;
-	STATE*				current_state = NULL;
-	STATE_TRANSITION*	current_trans = NULL;
-	
-	current_state = state_machine->state_list;
+	unsigned int	count;
 
-	while (current_state != NULL)
+	if (source->objects != NULL)
 	{
-		if (current_state->name[0] == 's' && current_state->name_length == 5 && memcmp(current_state->name,"start",5) == 0)
-		{
-			/* found the start state */
-			state_machine->init_state = current_state;
-		}
-
-		if ((current_state->flags & FLAG_GHOST) == FLAG_GHOST)
+		for (count=0; count < source->num_objects; count++)
 		{
-			if (current_state->name_length == finish_state_length && memcmp(current_state->name,finish_state,finish_state_length) != 0)
-			{
-				result = EC_UNDEFINDED_REFERENCED_STATE_FOUND;
-				raise_warning(current_state->line_number,result,NULL,NULL);
-			}
+			free(source->objects[count].touches);
 		}
-
-		current_state = current_state->next;
 	}
 
-	if (state_machine->init_state == NULL)
-	{
-		result = EC_STATE_MACHINE_DOES_NOT_HAVE_START;
-		raise_warning(0,result,state_machine->group->name,NULL);
-	}
+	free(source->objects);
+	free(source->groups);
 
-	return result;
+	symbol_table_release(&source->object_names);
+	symbol_table_release(&source->group_names);
+
+	memset(source,0,sizeof(LINK_SOURCE));
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : handle_reorder
- * Desc : This function handles the reordering of the node. If the node is either
- *        part of a function or has a sub-wait these are moved to.
+ * Name : load_records
+ * Desc : This function finds the records in the data and adds them to the
+ *        object, the payloads are views into the data.
  *--------------------------------------------------------------------------------*/
-static NODE*	handle_reorder(NODE* search_node, NODE* psearch_node, NODE* previous_node, TIMELINE* timeline)
+static void	load_records(LINK_OBJECT* object, unsigned char* data, unsigned int size, unsigned int version)
 {
-	search_node->flags |= FLAG_DEPENDENCY;
-
-	/* start the insert */
-	if (previous_node == NULL)
-	{
-		timeline->node = search_node;
-	}
-	else
-	{
-		previous_node->next = search_node;
-	}
+	unsigned int	pos = 0;
+	unsigned int	record_header;
+	LINK_RECORD*	records;
+	OBJECT_RECORD	record;
 
-	/* is there more that one item to copy 
-	 * we need to copy all subsequent waits and the items within a function */
-	do
+	while (!object->truncated && (record_header = object_record_decode(&data[pos],size - pos,version,&record)) > 0)
 	{
-		if (search_node->next != NULL)
+		if (object->num_records == object->max_records)
 		{
-			if ((search_node->next->flags & (FLAG_WAIT |FLAG_IN_FUNCTION)) != 0)
-			{
-				search_node = search_node->next;
-			}
-			else
+			if ((records = realloc(object->records,(object->max_records + LINK_RECORD_BLOCK_SIZE) * sizeof(LINK_RECORD))) == NULL)
 			{
+				object->error = EC_OUT_OF_MEMORY_OR_FILE_TO_BIG;
 				break;
 			}
+
+			object->records = records;
+			object->max_records += LINK_RECORD_BLOCK_SIZE;
 		}
-	}
-	while (search_node != NULL);
 
-	/* set the end of the insert */
-	if (psearch_node == NULL)
-	{
-		timeline->node = search_node->next;
-	}
-	else
-	{
-		psearch_node->next = search_node->next;
-	}
+		object->records[object->num_records].record = record;
+		object->records[object->num_records].payload = &data[pos + record_header];
+		object->num_records++;
 
-	return search_node;
+		if (record.data_size > size - (pos + record_header))
+		{
+			/* record runs off the end --- problem with the file */
+			object->truncated = 1;
+		}
+		else
+		{
+			pos += record_header + record.data_size;
+		}
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : reorder_nodes
- * Desc : This function will reorder the nodes in the specific timeline.
+ * Name : link_model_read
+ * Desc : This function finds the link model in a partial model and loads its
+ *        records, so that it can be merged in the place of the objects that
+ *        were linked into it. The unresolved symbols are only counted.
  *--------------------------------------------------------------------------------*/
-static ERROR_CODES	reorder_nodes(TIMELINE* timeline)
+static unsigned int	link_model_read(LINK_OBJECT* object)
 {
-	int			found = 0;
-	NODE*		temp_node;
-	NODE*		search_node;
-	NODE*		psearch_node;
-	NODE*		current_node;
-	NODE*		previous_node = NULL;
-	ERROR_CODES result = EC_OK;
+	unsigned int	result = EC_INPUT_FILE_SIGNATURE_INCORRECT;
+	unsigned int	count;
+	unsigned int	start;
+	unsigned int	length;
+	unsigned int	pos;
+	unsigned int	record_header;
+	unsigned int	toc_offset = 0;
+	unsigned int	num_entries = 0;
+	unsigned int	model_start = 0;
+	unsigned int	model_end = 0;
+	unsigned int	unresolved_start = 0;
+	unsigned int	unresolved_end = 0;
+	unsigned char*	data = object->data;
+	unsigned char*	entry;
+	OBJECT_RECORD	record;
+
+	if (object->size >= LINKER_V2_HEADER_SIZE && read_long(&data[LINKER_V2_FILE_SIZE_OFF]) == object->size)
+	{
+		toc_offset = read_long(&data[LINKER_V2_TOC_OFF]);
+		num_entries = read_long(&data[LINKER_V2_TOC_ENTRIES_OFF]);
+
+		if (toc_offset < LINKER_V2_HEADER_SIZE ||
+			toc_offset > object->size ||
+			num_entries > (object->size - toc_offset) / LINKER_TOC_ENTRY_SIZE)
+		{
+			num_entries = 0;
+		}
+	}
 
-	if (timeline->node != NULL)
+	for (count=0; count < num_entries; count++)
 	{
-		current_node = timeline->node;
+		entry = &data[toc_offset + (count * LINKER_TOC_ENTRY_SIZE)];
+		start = read_long(&entry[LINKER_TOC_OFFSET]);
+		length = read_long(&entry[LINKER_TOC_LENGTH]);
 
-		do
+		if (start > object->size || length > object->size - start)
 		{
-			if (current_node->after.name_length > 0)
-			{
-				/* we have a relocation */
-				psearch_node = NULL;
-				search_node = timeline->node;
-				found = 0;
+			result = EC_INPUT_FILE_SIGNATURE_INCORRECT;
+			break;
+		}
+		else if (entry[LINKER_TOC_TYPE] == LINKER_SECTION_LINK_MODEL)
+		{
+			model_start = start;
+			model_end = start + length;
+			result = EC_OK;
+		}
+		else if (entry[LINKER_TOC_TYPE] == LINKER_SECTION_UNRESOLVED)
+		{
+			unresolved_start = start;
+			unresolved_end = start + length;
+		}
+	}
 
-				do
-				{
-					if ((search_node->flags & FLAG_WAIT) == 0)
-					{
-						if (search_node->function != NULL)
-						{
-							if (search_node->function->name_length == current_node->after.name_length &&
-								memcmp(search_node->function->name,current_node->after.name,search_node->after.name_length) == 0)
-							{
-								search_node = handle_reorder(search_node,psearch_node,previous_node,timeline);
-								search_node->next = current_node;
-								found = 1;
-								break;
-							}
-						}
-						else if (search_node->sent_message != NULL && search_node->sent_message->name_length > 0)
-						{
-							if (search_node->sent_message->name_length == current_node->after.name_length &&
-								memcmp(search_node->sent_message->name,current_node->after.name,current_node->after.name_length) == 0)
-							{
-								search_node = handle_reorder(search_node,psearch_node,previous_node,timeline);
-								search_node->next = current_node;
-								found = 1;
-								break;
-							}
-						}
-					}
+	if (result == EC_OK)
+	{
+		object->loaded = 1;
+		object->later_version = (data[FILE_VERSION_MAJOR] > VERSION_MAJOR);
+		object->fingerprint = fnv_32_hash(data,object->size);
 
-					psearch_node = search_node;
-					search_node = search_node->next;
-				}
-				while(search_node != NULL);
+		/* the warnings are reported against the partial model */
+		object->source_name = (unsigned char*) object->filename;
+		object->source_name_length = strlen(object->filename);
 
-				if (!found)
-				{
-					result = EC_AFTER_NODE_DOES_NOT_EXIST;
-					raise_warning(current_node->line_number,result,NULL,NULL);
-				}
-			}
+		load_records(object,&data[model_start],model_end - model_start,OBJECT_VERSION_MINOR);
 
-			previous_node = current_node;
-			current_node = current_node->next;
+		pos = unresolved_start;
+
+		while ((record_header = object_record_decode(&data[pos],unresolved_end - pos,OBJECT_VERSION_MINOR,&record)) > 0 &&
+			   record.data_size <= unresolved_end - (pos + record_header))
+		{
+			object->num_unresolved++;
+			pos += record_header + record.data_size;
 		}
-		while (current_node != NULL);
 	}
 
 	return result;
 }
 
-
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : insert_function
- * Desc : This function will insert the parts of a function into the current
- *        timeline after the given node. It will also do the basic checks that
- *        are required. Note: this call recursively call itself if the code is
- *        a function.
+ * Name : load_object
+ * Desc : This function will map an object file and find the records in it. It
+ *        does not touch the model, so the objects can be loaded in parallel.
+ *        Any problems are kept in the object and reported when it is merged.
  *
- *        The depth parameter is used to depth check the call list to stop 
- *        recursive call breaking it.
+ *        The members of an archive already have their data, they are views
+ *        into the archive. An archive is not loaded as an object, its members
+ *        are found here and loaded by the caller. The records of a partial
+ *        model are the records of its link model.
  *--------------------------------------------------------------------------------*/
-static unsigned int	insert_function(TIMELINE* timeline, NODE** start, FUNCTION* function, unsigned int depth)
+static void	load_object(LINK_OBJECT* object)
 {
-	NODE*			current_node = *start;
-	NODE*			new_node = *start;
-	MESSAGE*		message = NULL;
-	MESSAGE*		new_message = NULL;
-	MESSAGE*		wait_message = NULL;
-	TIMELINE*		target = NULL;
-	FUNCTION_NODE*	function_node = function->node;
-	unsigned int	result = EC_OK;
-
-	current_node->flags |= FLAG_FUNCTION;
+	unsigned int	file_pos;
+	unsigned int	file_name_size;
+	unsigned int	header_size = FILE_HEADER_SIZE;
+	unsigned char	signature[4] = COMPILED_SOURCE_MAGIC;
+	unsigned char	model_signature[4] = LINKED_SOURCE_V2_MAGIC;
+	unsigned char*	header;
 
-	if (depth > g_max_call_depth)
-	{
-		result = EC_MAX_FUNCTION_DEPTH_REACHED;
-	}
-	else
+	if (object->data == NULL && map_input_file(object->filename,&object->input_file) == EC_OK)
 	{
-		while (function_node != NULL)
-		{
-			new_node = calloc(1,sizeof(NODE));
-
-			/* add the new node into the node list */
-			new_node->next = current_node->next;
-			new_node->timeline = timeline;
-			current_node->next = new_node;
-			current_node = new_node;
-			new_node->flags = (FLAG_IN_FUNCTION | FLAG_DEPENDENCY);
-			target = function_node->to_timeline;
+		object->mapped = 1;
+		object->data = object->input_file.data;
+		object->size = object->input_file.size;
 
-			if (function_node->to_timeline_name.name_length > 0)
-			{
-				/* now we can fixup the @to timeline */
-				if ((target = find_timeline(timeline->group,
-											function_node->to_timeline_name.name,
-											function_node->to_timeline_name.name_length)) == NULL)
-				{
-					target = add_timeline(timeline->group,
-											function_node->to_timeline_name.name,
-											function_node->to_timeline_name.name_length,
-											0,
-											FLAG_GHOST);
-				}
-			}
+		if (object_archive_is_archive(object->data,object->size))
+		{
+			object->is_archive = 1;
+			object->error = object_archive_read(&object->archive,object->data,object->size);
+		}
+		else if (object->size >= 4 && memcmp(object->data,model_signature,4) == 0)
+		{
+			/* a model can only be linked if it is a partial model */
+			object->is_partial = 1;
+			object->error = link_model_read(object);
+		}
+	}
 
-			if (function_node->call != NULL)
-			{
-				result = insert_function(timeline,&current_node,function_node->call,depth + 1);
-				new_node->function = find_function(function_node->call->name,function_node->call->name_length);
-			}
+	if (object->data != NULL && !object->is_archive && !object->is_partial)
+	{
+		header = object->data;
 
-			/* handle the send */
-			if (function_node->message.name_length > 0)
-			{
-				new_node->sent_message = create_message(new_node,target,&function_node->message);
-				new_node->sent_message->flags = function_node->flags;
-			}
+		if (object->size < FILE_HEADER_SIZE)
+		{
+			/* too small to be an object, it is ignored */
+		}
+		else if (memcmp(header,signature,4) != 0)
+		{
+			object->error = EC_INPUT_FILE_SIGNATURE_INCORRECT;
+		}
+		else
+		{
+			object->loaded = 1;
+			object->later_version = (header[FILE_VERSION_MAJOR] > VERSION_MAJOR);
 
-			/* "wait" - this needs to fixed-up after the functions are */
-			if (function_node->sequence.name_length > 0)
+			/* the later objects have the content hash after the header */
+			if (header[FILE_VERSION_MINOR] >= OBJECT_VERSION_HASHED && object->size >= FILE_HASHED_HEADER_SIZE)
 			{
-				memcpy(&new_node->wait_message,&function_node->sequence,sizeof(BLOCK_NAME));
+				header_size = FILE_HASHED_HEADER_SIZE;
 			}
 
-			/* handle the sequence */
-			if (function_node->after.name_length > 0)
+			/* pdsc hashes the content of the object, the older objects are hashed here */
+			if (header_size == FILE_HASHED_HEADER_SIZE)
 			{
-				memcpy(&new_node->after,&function_node->after,sizeof(BLOCK_NAME));
+				object->fingerprint = read_long(&header[FILE_CONTENT_HASH]);
 			}
-
-			/* trigger is attached to the node */
-			if (function_node->trigger != NULL)
+			else
 			{
-				new_node->trigger = handle_trigger(function_node->trigger,timeline->group);
+				object->fingerprint = fnv_32_hash(object->data,object->size);
 			}
 
-			/* trigger is attached to the node */
-			if (function_node->triggers_list != NULL)
-			{
-				add_triggers(&new_node->triggers,function_node->triggers_list,timeline->group);
-			}
+			/* find the input file name */
+			file_name_size = ((((unsigned int)header[FILE_NAME_START]) << 8) | header[FILE_NAME_START+1]);
+			file_pos = header_size + file_name_size;
 
-			if (function_node->condition.name_length > 0)
+			if (file_pos > object->size)
 			{
-				if (function_node->condition.name_length > 0)
-				{
-					new_node->condition = malloc(function_node->condition.name_length);
-					memcpy(new_node->condition,function_node->condition.name,function_node->condition.name_length);
-					new_node->condition_length = function_node->condition.name_length;
-				}
+				file_name_size = object->size - header_size;
+				file_pos = object->size;
 			}
 
-			/* build the new node */
-			new_node->group = timeline->group;
-
-			/* next function node */
-			function_node = function_node->next;
-		}
-
-		/* add the end of function node - must have one as the last node may have received a message */
-		new_node = calloc(1,sizeof(NODE));
-		new_node->flags = FLAG_FUNCTION_END;
-		new_node->timeline = timeline;
-		new_node->return_node = *start;
-		new_node->next = current_node->next;
-		current_node->next = new_node;
-		
-		(*start)->function_end = new_node;
+			object->source_name = &header[file_pos - file_name_size];
+			object->source_name_length = file_name_size;
 
-		if (timeline->last_node == *start)
-		{
-			timeline->last_node = new_node;
+			/* now find the records, the payloads are views into the file */
+			load_records(object,&header[file_pos],object->size - file_pos,header[FILE_VERSION_MINOR]);
 		}
-
-		*start = new_node;
 	}
-
-	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : node_reorder
- * Desc : This function will reorder the nodes. If the node has an after then it
- *        will search the list of nodes to find out where the after message is
- *        sent or waited for and place the node there.
+ * Name : load_job
+ * Desc : This function loads one of the objects, it is called by the work pool.
  *--------------------------------------------------------------------------------*/
-static ERROR_CODES	node_reorder(SEQUENCE_DIAGRAM* sequence_diagram)
+static unsigned int	load_job(void* parameter, unsigned int job)
 {
-	NODE*			current_node;
-	TIMELINE*		current_timeline;
-	ERROR_CODES		error;
-	unsigned int	result = EC_OK;
-			
-	if (sequence_diagram != NULL)
-	{
-		current_timeline = sequence_diagram->timeline_list;
-		
-		while (current_timeline != NULL)
-		{
-			if ((error = reorder_nodes(current_timeline)) != EC_OK)
-			{
-				result = EC_FAILED;
-			}
+	LINK_OBJECT*	objects = parameter;
 
-			current_timeline = current_timeline->next;
-		}
-	}
+	load_object(&objects[job]);
 
-	return result;
+	return EC_OK;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : function_fixup
- * Desc : This function will fixup the function references in the tree. It will
- *        just add the functions and all the atoms that are associated with the
- *        function into the tree at the current location.
+ * Name : release_object_model
+ * Desc : This function releases the model of an object. The blocks and the
+ *        items that have been merged belong to the model, only the parts that
+ *        held them are freed.
  *--------------------------------------------------------------------------------*/
-static unsigned int	function_fixup(SEQUENCE_DIAGRAM* sequence_diagram)
+static void	release_object_model(LINK_OBJECT* object)
 {
-	NODE*			current_node;
-	TIMELINE*		current_timeline;
-	unsigned int	error;
-	unsigned int	result = EC_OK;
+	unsigned int	count;
+	LINK_ITEM*		item;
 
-	if (sequence_diagram != NULL)
+	for (count=0; count < object->num_items; count++)
 	{
-		current_timeline = sequence_diagram->timeline_list;
-		
-		while (current_timeline != NULL)
+		item = &object->items[count];
+
+		switch (item->type)
 		{
-			current_node = current_timeline->node;
+			case LINK_ITEM_API_TYPE:
+				free(item->data.names);
+				break;
 
-			while (current_node != NULL)
-			{
-				if (current_node->function != NULL)
+			case LINK_ITEM_SYNOPSIS:
+				if (item->data.synopsis != NULL)
 				{
-					if ((current_node->function->flags & FLAG_GHOST) != 0)
-					{
-						result = EC_UNDEFINED_FUNCTION;
-						raise_warning(0,result,current_node->function->name,NULL);
-					}
-					else
-					{
-						/* ok, now we have a function its contents will have to be inserted here */
-						if ((error = insert_function(current_timeline,&current_node,current_node->function,0)) != EC_OK)
-						{
-							result = error;
-						}
-					}
+					free(item->data.synopsis->name.name);
+					free(item->data.synopsis->items.name);
+					free(item->data.synopsis);
 				}
+				break;
 
-				current_node = current_node->next;
-			}
-
-			current_timeline = current_timeline->next;
+			case LINK_ITEM_BLOCK:
+				free(item->data.block);
+				break;
 		}
 	}
 
-	return result;
+	free(object->items);
+	object->items = NULL;
+	object->num_items = 0;
+	object->max_items = 0;
+	object->failed = 0;
+
+	local_release(&object->locals);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : copy_node
- * Desc : This function this will copy a node and add it to the list of nodes
- *        that have been copied.
+ * Name : release_object
+ * Desc : This function will release the object once it has been merged.
  *--------------------------------------------------------------------------------*/
-static NODE*	copy_node(NODE* node, NODE_LIST* list)
+static void	release_object(LINK_OBJECT* object)
 {
-	NODE*		result;
-	NODE_LIST*	list_end = list;
-	NODE_LIST*	list_entry = list;
-
-	result = malloc(sizeof(NODE));
-	memcpy(result,node,sizeof(NODE));
-	result->next = NULL;
-
-	while (list_entry != NULL)
+	if (object->is_archive)
 	{
-		if (list_entry->timeline == node->timeline)
-		{
-			/* found the list that it belongs to */
-			list_entry->last->next = result;
-			list_entry->last = list_entry->last->next;
-			break;
-		}
-
-		list_end = list_entry;
-		list_entry = list_entry->next;
+		object_archive_release(&object->archive);
 	}
 
-	if (list_entry == NULL)
+	if (object->mapped)
 	{
-		/* ok, did not find the time line so add it to the end */
-		list_end->next = calloc(1,sizeof(NODE_LIST));
-		list_end->next->last = result;
-		list_end->next->timeline = node->timeline;
-		list_end->next->node = result;
+		unmap_input_file(&object->input_file);
+		object->mapped = 0;
 	}
 
-	return result;
+	object->data = NULL;
+	object->size = 0;
+
+	free(object->records);
+	object->records = NULL;
+	object->num_records = 0;
+	object->max_records = 0;
+
+	release_object_model(object);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : merge_nodes
- * Desc : This function will merge the copied list of nodes into the sequence
- *        diagram.
- *
- *        This function will also tidy up the function pointers for the copied
- *        nodes.
+ * Name : link_touch
+ * Desc : This function records that the object added to a thing in the model.
+ *        The names are pooled, so the same thing always has the same name.
+ *        Nothing is recorded unless the link state is being written.
  *--------------------------------------------------------------------------------*/
-static void	merge_nodes(NODE_LIST* list, NODE* insert_node)
+static void	link_touch(LINK_OBJECT* object, unsigned char type, unsigned char* name, unsigned int name_length)
 {
-	NODE*		end_node;
-	NODE*		start_node;
-	NODE*		current_node;
-	NODE*		function_start;
-	NODE_LIST*	current_list = list->next;
+	unsigned int	count;
+	unsigned int	found = !g_link_state;
+	LINK_TOUCH*		touches;
 
-	while (current_list != NULL)
+	for (count=0; count < object->num_touches && !found; count++)
 	{
-		current_node = current_list->node;
-		start_node = current_node;
-		end_node = current_node;
+		found = (object->touches[count].type == type && object->touches[count].name == name);
+	}
 
-		while (current_node != NULL)
+	if (!found)
+	{
+		if (object->num_touches == object->max_touches)
 		{
-			if (current_node->flags & FLAG_FUNCTION)
+			if ((touches = realloc(object->touches,(object->max_touches + LINK_TOUCH_BLOCK_SIZE) * sizeof(LINK_TOUCH))) != NULL)
 			{
-				function_start = current_node;
-			}
-			else if (current_node->flags & FLAG_FUNCTION_END)
-			{
-				function_start->function_end = current_node;
-				current_node->return_node = function_start;
+				object->touches = touches;
+				object->max_touches += LINK_TOUCH_BLOCK_SIZE;
 			}
-
-			end_node = current_node;
-			current_node = current_node->next;
 		}
 
-		/* add the copied node to the correct timeline */
-		if (insert_node->timeline == current_list->timeline)
-		{
-			/* ok, we have the copied node here */
-			end_node->next = insert_node->next;
-			insert_node->next = start_node;
-		}
-		else
+		if (object->num_touches < object->max_touches)
 		{
-			/* add to the end of the relevant timeline */
-			current_list->timeline->last_node->next = start_node;
-			current_list->timeline->last_node = end_node;
+			object->touches[object->num_touches].type = type;
+			object->touches[object->num_touches].name = name;
+			object->touches[object->num_touches].name_length = name_length;
+			object->num_touches++;
 		}
-
-		current_list = current_list->next;
 	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : duplicate_function
- * Desc : This function will duplicate a node and all off the sub-nodes and the
- *        messages that the node has. It will add the duplicate nodes to the end 
- *        of the timelines that they belong in.
+ * Name : link_touch_record
+ * Desc : This function records the group that an atom adds to. The named groups
+ *        are recorded when they are looked up, this finds the atoms that add to
+ *        the default group of the file. The group is only known when the object
+ *        is merged, so the local id is kept in the model of the object.
  *--------------------------------------------------------------------------------*/
-static NODE*	duplicate_function(NODE* start_node)
+static void	link_touch_record(LINK_OBJECT* object, OBJECT_RECORD* record)
 {
-	NODE* 		result = start_node;
-	NODE* 		copy;
-	NODE* 		prev_node;
-	NODE* 		stop_node = start_node->function_end;
-	NODE* 		active_node = start_node;
-	MESSAGE*	new_message;
-	NODE_LIST	insert_list = {NULL,NULL,NULL,NULL};
+	unsigned int	group = record->group;
+	LINK_ITEM*		item;
 
-	start_node->return_node = NULL;
-	
-	copy = copy_node(active_node,&insert_list);
-	result = copy;
+	if (group == DEFAULT_GROUP)
+	{
+		group = 0;
+	}
+	else if ((group & RECORD_FUNC_API_MASK) == RECORD_FUNCTION_FLAG)
+	{
+		group &= ~RECORD_FUNC_API_MASK;
+	}
 
-	while (active_node != NULL && stop_node != active_node)
+	switch (record->atom)
 	{
-		prev_node = copy;
-		active_node = next_active_node(active_node);
+		case ATOM_STATE:
+		case ATOM_NEXT:
+		case ATOM_CONDITION:
+		case ATOM_TRIGGER:
+		case ATOM_TRIGGERS:
+		case ATOM_TIMELINE:
+		case ATOM_CALL:
+		case ATOM_SEND:
+		case ATOM_RESPONDS:
+		case ATOM_AFTER:
+		case ATOM_WAITFOR:
+		case ATOM_TO:
+			if (g_link_state && (item = link_item(object,LINK_ITEM_TOUCH,record->line_number)) != NULL)
+			{
+				item->id = group;
+			}
+			break;
+	}
+}
 
-		copy = copy_node(active_node,&insert_list);
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_touch_block
+ * Desc : This function records the group that a block was added to, and the
+ *        function that it calls. The file blocks only change the default group,
+ *        and a block that is only in a function is added to the function that
+ *        has already been recorded.
+ *--------------------------------------------------------------------------------*/
+static void	link_touch_block(LINK_OBJECT* object, BLOCK_NODE* block_node, LINK_LOCALS* locals)
+{
+	GROUP*	group = block_node->group;
 
-		if (prev_node->sent_message != NULL)
+	if (group == NULL)
+	{
+		group = locals->groups.items[0];
+	}
+
+	if (block_node->type == ATOM_BLOCK_FILE)
+	{
+		/* only changes the default group */
+	}
+	else if (block_node->group == NULL &&
+			 (block_node->flags & FLAG_IN_FUNCTION) == FLAG_IN_FUNCTION &&
+			 block_node->state == NULL &&
+			 block_node->timeline == NULL &&
+			 block_node->api_constants == NULL &&
+			 block_node->api_type == NULL &&
+			 block_node->api_function == NULL &&
+			 block_node->application_id == 0)
+	{
+		/* only added to the function */
+	}
+	else
+	{
+		link_touch(object,LINK_TOUCH_GROUP,group->name,group->name_length);
+	}
+
+	if (block_node->application_id != 0)
+	{
+		link_touch(object,LINK_TOUCH_APPLICATIONS,NULL,0);
+	}
+
+	/* the function is found by name, it is inserted into the diagram later */
+	if (block_node->message.name_length > 0 && (block_node->flags & FLAG_MESSAGE_CALL) == FLAG_MESSAGE_CALL)
+	{
+		link_touch(object,LINK_TOUCH_FUNCTION,block_node->message.name,block_node->message.name_length);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : decode_object
+ * Desc : This function decodes the records of a loaded object into the model of
+ *        the object. It does not touch the model, so the objects are decoded in
+ *        parallel, and the warnings are kept until the object is merged.
+ *--------------------------------------------------------------------------------*/
+static void	decode_object(LINK_OBJECT* object)
+{
+	unsigned int 	result = 0;
+	unsigned int	count;
+	unsigned int	in_api_group = 0;
+	unsigned int	line_number = 0;
+	unsigned int	record_size;
+	unsigned int	new_block_number;
+	unsigned int	current_api_function = INVALID_ITEM;
+	unsigned int	group;
+	unsigned char*	payload;
+	OBJECT_RECORD	record;
+	NAME			type;
+	NAME			name;
+	NAME			brief;
+	LINK_ITEM*		item;
+	LINK_BLOCK*		block;
+	LINK_LOCALS*	locals = &object->locals;
+
+	if ((block = calloc(1,sizeof(LINK_BLOCK))) == NULL ||
+		local_add(&locals->groups,NULL) != EC_OK ||
+		local_add(&locals->functions,NULL) != EC_OK)
+	{
+		/* the merge reports it, as it cannot use the model */
+		result = 1;
+	}
+	else
+	{
+		/* now walk the atoms */
+		for (count=0; count < object->num_records; count++)
 		{
-			new_message = malloc(sizeof(MESSAGE));
-			memcpy(new_message,prev_node->sent_message,sizeof(MESSAGE));
-			
-			prev_node->sent_message = new_message;
-			new_message->sender = prev_node;
+			record = object->records[count].record;
+			payload = object->records[count].payload;
+			line_number = record.line_number;
+			record_size = record.data_size;
+			new_block_number = record.block_number;
+
+			/* check to see if the block number changes */
+			if (new_block_number != block->node.block_number && !in_api_group)
+			{
+				/* ignore all blocks that are found while in a type */
+				if (block->node.line_number != 0)
+				{
+					/* add the block to the output */
+					if ((item = link_item(object,LINK_ITEM_BLOCK,block->node.line_number)) != NULL)
+					{
+						item->data.block = block;
+					}
+					else
+					{
+						free(block);
+					}
 
-			if (prev_node->sent_message->receiver != NULL)
+					if ((block = calloc(1,sizeof(LINK_BLOCK))) == NULL)
+					{
+						result = 1;
+						break;
+					}
+				}
+
+				memset(block,0,sizeof(LINK_BLOCK));
+				block->node.line_number = line_number;
+				block->node.block_number = new_block_number;
+			}
+
+			if (object->truncated && count + 1 == object->num_records)
 			{
-				new_message->receiver = copy;
+				/* record runs off the end --- problem with the file */
+				link_warning(object,0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)object->filename);
+				result = 1;
+			}
+			else
+			{
+					switch(record.type)
+					{
+						case INTERMEDIATE_RECORD_EMPTY:
+							if (record.atom == ATOM_API)
+							{
+								current_api_function = INVALID_ITEM;
+							}
+							else if (record.atom == ATOM_CONSTANTS)
+							{
+								/* Start the CONSTANT grouping */
+								if (block->node.api_constants != NULL)
+								{
+									result = EC_MULTIPLE_CONSTANTS_REQUEST_WITHOUT_END;
+									link_warning(object,line_number,result,NULL);
+								}
+								else
+								{
+									block->node.api_constants = calloc(1,sizeof(API_CONSTANTS));
+									in_api_group = 1;
+								}
+							}
+							else if (record.atom == ATOM_END_CONSTANTS)
+							{
+								/* End the CONSTANT grouping */
+								in_api_group = 0;
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_FUNCTION:
+							link_declare(object,&locals->functions,LINK_ITEM_FUNCTION,line_number,payload,record_size);
+							break;
+
+						case INTERMEDIATE_RECORD_APPLICATION:
+							link_declare(object,&locals->applications,LINK_ITEM_APPLICATION,line_number,payload,record_size);
+							break;
+
+						case INTERMEDIATE_RECORD_SAMPLE:
+							if ((item = link_item(object,LINK_ITEM_SAMPLE,line_number)) != NULL)
+							{
+								item->name = payload;
+								item->name_length = record_size;
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_API:
+							group = record.group;
+
+							if (group == DEFAULT_GROUP)
+							{
+								group = 0;
+							}
+
+							if (current_api_function != INVALID_ITEM)
+							{
+								result = EC_NESTED_FUNCTION_DEFINITIONS_NOT_ALLOWED;
+								link_warning(object,line_number,result,NULL);
+							}
+
+							if (group >= locals->groups.num_items)
+							{
+								result = EC_UNDEFINED_GROUP;
+								link_warning(object,line_number,result,NULL);
+							}
+							else if ((item = link_declare(object,&locals->api_functions,LINK_ITEM_API,line_number,payload,record_size)) != NULL)
+							{
+								item->value = group;
+								current_api_function = item->id;
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_TYPE:
+							result = decode_type(payload,record_size,&type,&name,&brief);
+
+							if (block->node.api_type != NULL)
+							{
+								add_api_type_record(block->node.api_type,ATOM_TYPE_RECORD,&type,&name,&brief);
+							}
+							else if (block->node.api_constants != NULL)
+							{
+								add_api_constant_record(block->node.api_constants,ATOM_TYPE_RECORD,&type,&name,&brief);
+							}
+							else if (current_api_function != INVALID_ITEM)
+							{
+								/* the api function is in the model, so it is changed when merged */
+								if ((item = link_item(object,LINK_ITEM_API_TYPE,line_number)) != NULL &&
+									(item->data.names = calloc(3,sizeof(NAME))) != NULL)
+								{
+									item->id = current_api_function;
+									item->value = record.atom;
+									item->data.names[0] = type;
+									item->data.names[1] = name;
+									item->data.names[2] = brief;
+								}
+							}
+							else
+							{
+								result = EC_TYPE_DEFINITION_IN_INVALID_PLACE;
+								link_warning(object,line_number,result,NULL);
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_GROUP:
+							/* does not have a name then it should map to the default */
+							if (record_size > 0)
+							{
+								link_declare(object,&locals->groups,LINK_ITEM_GROUP,line_number,payload,record_size);
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_NAME:
+						case INTERMEDIATE_RECORD_STRING:
+						case INTERMEDIATE_RECORD_MULTILINE:
+							if (block->node.api_constants != NULL)
+							{
+								add_atom_to_constant( 	object,
+														&block->node,
+														&record,
+														payload,
+														record_size);
+							}
+							else if (block->node.api_type != NULL)
+							{
+								add_atom_to_type( 	object,
+													&block->node,
+													&record,
+													payload,
+													record_size);
+							}
+							else
+							{
+								link_touch_record(object,&record);
+
+								add_atom_to_block(	object,
+													block,
+													&record,
+													payload,
+													record_size);
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_NUMBERIC:
+							add_numeric_to_block(	object,
+													block,
+													&record,
+													payload,
+													record_size);
+							break;
+
+						case INTERMEDIATE_RECORD_PAIR:
+							add_pair_to_block(	object,
+												block,
+												&record,
+												payload,
+												record_size);
+							break;
+
+						case INTERMEDIATE_RECORD_START:
+							/* types can be created here */
+							/* TODO: this is wrong -- all types must have a type block - originally coded badly.
+							 * so this should be fixed.
+							 *
+							 * The constants are correct already.
+							 */
+							if (record.atom != RECORD_GROUP_CONSTANT)
+							{
+								block->node.api_type = calloc(1,sizeof(API_TYPE));
+								in_api_group = 1;
+							}
+							else if (block->node.api_constants == NULL)
+							{
+								link_warning(object,0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)object->filename);
+							}
+							else
+							{
+								new_constant(block->node.api_constants);
+							}
+
+							break;
+
+						case INTERMEDIATE_RECORD_END:
+							if (block->node.api_type != NULL)
+							{
+								in_api_group = 0;
+							}
+							break;
+
+						case INTERMEDIATE_RECORD_BOOLEAN:
+							{
+								unsigned int	flags = 0;
+
+								switch(record.atom)
+								{
+									case ATOM_REQUIRED: flags = OPTION_FLAG_REQUIRED; break;
+									case ATOM_MULTIPLE: flags = OPTION_FLAG_MULTIPLE; break;
+								}
+
+								block->node.application_flag |= flags;
+							}
+							break;
+
+						default:
+							link_note(object,"%d\n",record.type);
+							link_warning(object,0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)object->filename);
+							result = 1;
+					}
 			}
 		}
+
+		if (object->error != EC_OK)
+		{
+			link_warning(object,0,object->error,(unsigned char*)object->filename);
+			result = 1;
+		}
+
+		if (block != NULL && block->node.line_number != 0 && (item = link_item(object,LINK_ITEM_BLOCK,block->node.line_number)) != NULL)
+		{
+			item->data.block = block;
+			block = NULL;
+		}
 	}
 
-	merge_nodes(&insert_list,stop_node);
+	free(block);
 
-	return result;
+	if (result != 0)
+	{
+		object->failed = 1;
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : find_wait_node
- * Desc : This function will find the waiting message that matches the send in
- *        the given node. It will return the node that it finds.
+ * Name : decode_job
+ * Desc : This function decodes one of the objects that are to be merged, it is
+ *        called by the work pool.
  *--------------------------------------------------------------------------------*/
-static NODE*	find_wait_node(MESSAGE* search_message, MESSAGE* sent_message)
+static unsigned int	decode_job(void* parameter, unsigned int job)
 {
-	NODE*			result = NULL;
-	NODE*			temp_node;
-	NODE*			start_node;
-	NODE*			insert_node;
-	NODE*			current_node = search_message->sender->timeline->node;
-	TIMELINE*		target_timeline = search_message->sender->timeline;
+	LINK_OBJECT**	link_list = parameter;
+
+	if (link_list[job]->decode && link_list[job]->loaded && !link_list[job]->is_partial)
+	{
+		decode_object(link_list[job]);
+	}
+
+	return EC_OK;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_name
+ * Desc : This function pools the name of a block and finds the group that owns
+ *        it, now that the object is being merged.
+ *--------------------------------------------------------------------------------*/
+static void	merge_name(BLOCK_NAME* name, LINK_LOCALS* locals)
+{
+	unsigned int	local_group = name->owner.local_group;
+
+	name->owner.group = local_ref(&locals->groups,local_group);
+
+	if (name->name != NULL)
+	{
+		name->name = string_pool_add(name->name,name->name_length);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_block
+ * Desc : This function finds the things in the model that a decoded block names
+ *        and adds the block to the model. The default group may have been
+ *        changed by the earlier blocks, so the groups are found here.
+ *--------------------------------------------------------------------------------*/
+static void	merge_block(LINK_OBJECT* object, LINK_BLOCK* block)
+{
+	unsigned int	count;
+	unsigned char*	name;
+	GROUP*			group;
+	BLOCK_NAME*		current;
+	LINK_LOOKUP*	lookup;
+	BLOCK_NODE*		node = &block->node;
+	LINK_LOCALS*	locals = &object->locals;
+
+	node->group = local_ref(&locals->groups,block->group);
+	node->function = local_item(&locals->functions,block->function);
+	node->api_function = local_ref(&locals->api_functions,block->api_function);
+
+	merge_name(&node->after,locals);
+	merge_name(&node->author,locals);
+	merge_name(&node->message,locals);
+	merge_name(&node->sequence,locals);
+	merge_name(&node->condition,locals);
+	merge_name(&node->transition,locals);
+	merge_name(&node->function_to_timeline,locals);
+
+	if (node->trigger != NULL)
+	{
+		merge_name(node->trigger,locals);
+	}
+
+	for (current = node->triggers_list; current != NULL; current = current->next)
+	{
+		merge_name(current,locals);
+	}
 
-	while (current_node != NULL)
+	/* the states and timelines are added to the group in the order of the atoms */
+	for (count=0; count < block->num_lookups; count++)
 	{
-		if (sent_message->name_length == current_node->wait_message.name_length &&
-			memcmp(sent_message->name,current_node->wait_message.name,sent_message->name_length) == 0)
+		lookup = &block->lookups[count];
+
+		if ((group = local_item(&locals->groups,lookup->group)) != NULL)
 		{
-			if (current_node->received_message == NULL)
-			{
-				result = current_node;
-				break;
-			}
-			else if ((search_message->flags & FLAG_BROADCAST) != 0)
+			name = string_pool_add(lookup->name,lookup->name_length);
+
+			switch (lookup->type)
 			{
-				if (current_node->flags & FLAG_FUNCTION)
-				{
-					result = duplicate_function(current_node);
-				}
-				else if (((current_node->flags & FLAG_IN_FUNCTION) == 0))
-				{
-					/* message to a non-function node */
-					temp_node = malloc(sizeof(NODE));
-					memcpy(temp_node,current_node,sizeof(NODE));
-					temp_node->next = current_node->next;
-					current_node->next = temp_node;
-					result = temp_node;
-				}
-				else
-				{
-					printf("failed ---- currently not supported - messages to inside a function -- s/b reponses \n");
-				}
+				case LINK_LOOKUP_STATE:
+					if ((node->state = find_state(group,name)) == NULL)
+					{
+						node->state = add_state(group,lookup->name,lookup->name_length,node->line_number,0);
+					}
+					else if ((node->state->flags & FLAG_GHOST) == FLAG_GHOST)
+					{
+						node->state->flags &= ~FLAG_GHOST;
+						node->state->line_number = node->line_number;
+					}
+					break;
 
-				break;
+				case LINK_LOOKUP_TIMELINE:
+					if ((node->timeline = find_timeline(group,name)) == NULL)
+					{
+						node->timeline = add_timeline(group,lookup->name,lookup->name_length,node->line_number,0);
+					}
+					break;
+
+				case LINK_LOOKUP_TO:
+					if ((node->to_timeline = find_timeline(group,name)) == NULL)
+					{
+						node->to_timeline = add_timeline(group,lookup->name,lookup->name_length,node->line_number,0);
+					}
+					break;
 			}
 		}
-		current_node = current_node->next;
 	}
 
-	return result;
+	add_block(node,locals);
+	link_touch_block(object,node,locals);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_synopsis
+ * Desc : This function adds a decoded synopsis to the end of the application.
+ *--------------------------------------------------------------------------------*/
+static void	merge_synopsis(APPLICATION* application, SYNOPSIS_LIST* synopsis)
+{
+	if (application->synopsis_list.name.name_length == 0)
+	{
+		/* ad to start */
+		application->synopsis_list.name = synopsis->name;
+		application->synopsis_list.items = synopsis->items;
+		application->synopsis_list.last = &application->synopsis_list;
+
+		free(synopsis);
+	}
+	else
+	{
+		/* add to end */
+		application->synopsis_list.last->next = synopsis;
+		application->synopsis_list.last = synopsis;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_varint
+ * Desc : This function reads a number from the payload of a link model record.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	model_get_varint(LINK_MODEL_READER* reader)
+{
+	unsigned int	result = 0;
+	unsigned int	used;
+
+	if ((used = object_record_decode_varint(&reader->data[reader->pos],reader->size - reader->pos,&result)) == 0)
+	{
+		reader->failed = 1;
+	}
+
+	reader->pos += used;
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_string
+ * Desc : This function reads a string from the payload, it returns a view into
+ *        the partial model.
+ *--------------------------------------------------------------------------------*/
+static unsigned char*	model_get_string(LINK_MODEL_READER* reader, unsigned int* length)
+{
+	unsigned char*	result = NULL;
+
+	*length = model_get_varint(reader);
+
+	if (*length > reader->size - reader->pos)
+	{
+		reader->failed = 1;
+		*length = 0;
+	}
+	else
+	{
+		result = &reader->data[reader->pos];
+		reader->pos += *length;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_name
+ * Desc : This function reads a name from the payload. The name is copied, as the
+ *        partial model is released once it has been merged.
+ *--------------------------------------------------------------------------------*/
+static void	model_get_name(LINK_MODEL_READER* reader, NAME* name)
+{
+	NAME	temp;
+
+	memset(name,0,sizeof(NAME));
+	memset(&temp,0,sizeof(NAME));
+
+	if (reader->pos < reader->size)
+	{
+		temp.fixed = reader->data[reader->pos++];
+	}
+	else
+	{
+		reader->failed = 1;
+	}
+
+	temp.name = model_get_string(reader,&temp.name_length);
+
+	if (temp.name_length > 0)
+	{
+		copy_name(&temp,name);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_group
+ * Desc : This function reads a group reference and returns the group in the
+ *        model, or NULL if there is no group.
+ *--------------------------------------------------------------------------------*/
+static GROUP*	model_get_group(LINK_MODEL_READER* reader)
+{
+	GROUP*			result = NULL;
+	unsigned int	reference = model_get_varint(reader);
+
+	if (reference > 0 && (result = local_ref(&reader->locals->groups,reference)) == NULL)
+	{
+		reader->failed = 1;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_block_name
+ * Desc : This function reads a block name, the name is pooled.
+ *--------------------------------------------------------------------------------*/
+static void	model_get_block_name(LINK_MODEL_READER* reader, BLOCK_NAME* name)
+{
+	unsigned char*	string;
+
+	memset(name,0,sizeof(BLOCK_NAME));
+
+	name->owner.group = model_get_group(reader);
+	string = model_get_string(reader,&name->name_length);
+
+	if (name->name_length > 0)
+	{
+		name->name = string_pool_add(string,name->name_length);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_trigger
+ * Desc : This function reads a reference to a trigger. The triggers have been
+ *        declared, so they are found.
+ *--------------------------------------------------------------------------------*/
+static TRIGGER*	model_get_trigger(LINK_MODEL_READER* reader)
+{
+	TRIGGER*	result = NULL;
+	BLOCK_NAME	name;
+
+	model_get_block_name(reader,&name);
+
+	if (name.name_length > 0 && name.owner.group == NULL)
+	{
+		reader->failed = 1;
+	}
+	else if (name.name_length > 0)
+	{
+		result = handle_trigger(&name,NULL);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_get_triggers
+ * Desc : This function reads a list of trigger references and adds them to the
+ *        end of the list.
+ *--------------------------------------------------------------------------------*/
+static void	model_get_triggers(LINK_MODEL_READER* reader, TRIGGERS** triggers)
+{
+	unsigned int	count;
+	unsigned int	num_triggers = model_get_varint(reader);
+	TRIGGERS*		new_triggers;
+	TRIGGERS**		last = triggers;
+
+	for (count=0; count < num_triggers && !reader->failed; count++)
+	{
+		new_triggers = calloc(1,sizeof(TRIGGERS));
+		new_triggers->trigger = model_get_trigger(reader);
+
+		*last = new_triggers;
+		last = &new_triggers->next;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_transition
+ * Desc : This function adds a transition of the partial model to its state. The
+ *        trigger is checked the same way as when the block is added.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_transition(LINK_MODEL_READER* reader, GROUP* group, unsigned int line_number)
+{
+	STATE*				state;
+	STATE*				next_state;
+	TRIGGER*			trigger;
+	TRIGGERS*			triggers = NULL;
+	unsigned char*		name;
+	unsigned char*		condition;
+	unsigned int		name_length;
+	unsigned int		condition_length;
+	STATE_TRANSITION*	current_trans;
+	STATE_TRANSITION*	new_transition = NULL;
+
+	name = model_get_string(reader,&name_length);
+	state = find_state(group,string_pool_add(name,name_length));
+
+	name = model_get_string(reader,&name_length);
+	next_state = find_state(group,string_pool_add(name,name_length));
+
+	condition = model_get_string(reader,&condition_length);
+	trigger = model_get_trigger(reader);
+	model_get_triggers(reader,&triggers);
+
+	if (state == NULL || next_state == NULL)
+	{
+		reader->failed = 1;
+	}
+	else if (state->transition_list == NULL)
+	{
+		state->transition_list = calloc(1,sizeof(STATE_TRANSITION));
+		new_transition = state->transition_list;
+	}
+	else
+	{
+		current_trans = state->transition_list;
+
+		while(current_trans != NULL)
+		{
+			if (current_trans->next == NULL)
+			{
+				current_trans->next = calloc(1,sizeof(STATE_TRANSITION));
+				new_transition = current_trans->next;
+				break;
+			}
+			else if (trigger != NULL && current_trans->trigger == trigger)
+			{
+				raise_warning(line_number,EC_DUPLICATE_TRIGGER,NULL,NULL);
+				break;
+			}
+
+			current_trans = current_trans->next;
+		}
+	}
+
+	if (new_transition != NULL)
+	{
+		new_transition->next_state = next_state;
+		new_transition->trigger = trigger;
+		new_transition->triggers = triggers;
+
+		if (condition_length > 0)
+		{
+			new_transition->condition = malloc(condition_length);
+			new_transition->condition_length = condition_length;
+			memcpy(new_transition->condition,condition,condition_length);
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_node
+ * Desc : This function adds a sequence diagram node of the partial model to the
+ *        end of its timeline.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_node(LINK_MODEL_READER* reader, GROUP* group, OBJECT_RECORD* record)
+{
+	NODE*			new_node;
+	TIMELINE*		timeline;
+	TIMELINE*		to_timeline = NULL;
+	BLOCK_NAME		message;
+	BLOCK_NAME		to_name;
+	unsigned char*	name;
+	unsigned int	name_length;
+
+	name = model_get_string(reader,&name_length);
+
+	if ((timeline = find_timeline(group,string_pool_add(name,name_length))) == NULL)
+	{
+		reader->failed = 1;
+	}
+	else
+	{
+		new_node = calloc(1,sizeof(NODE));
+		new_node->flags = record->block_number;
+		new_node->line_number = record->line_number;
+		new_node->timeline = timeline;
+		new_node->group = model_get_group(reader);
+		new_node->trigger = model_get_trigger(reader);
+		model_get_triggers(reader,&new_node->triggers);
+
+		name = model_get_string(reader,&name_length);
+
+		if (name_length > 0 && (new_node->function = find_function(name,name_length)) == NULL)
+		{
+			new_node->function = add_function(name,name_length,FLAG_GHOST);
+		}
+
+		memset(&message,0,sizeof(BLOCK_NAME));
+		message.name = model_get_string(reader,&message.name_length);
+		model_get_block_name(reader,&to_name);
+
+		if (to_name.name_length > 0 && (to_timeline = find_timeline(to_name.owner.group,to_name.name)) == NULL)
+		{
+			reader->failed = 1;
+		}
+
+		if (message.name_length > 0)
+		{
+			new_node->sent_message = create_message(new_node,to_timeline,&message);
+			new_node->sent_message->flags = new_node->flags;
+		}
+
+		model_get_block_name(reader,&new_node->wait_message);
+		model_get_block_name(reader,&new_node->after);
+
+		/* insert at the end */
+		if (timeline->last_node == NULL)
+		{
+			timeline->node = new_node;
+		}
+		else
+		{
+			timeline->last_node->next = new_node;
+		}
+
+		timeline->last_node = new_node;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_function_node
+ * Desc : This function adds a node of the partial model to the end of the
+ *        function.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_function_node(LINK_MODEL_READER* reader, FUNCTION* function, unsigned int flags)
+{
+	unsigned int	count;
+	unsigned int	num_triggers;
+	unsigned int	name_length;
+	unsigned char*	name;
+	BLOCK_NAME		trigger;
+	BLOCK_NAME**	last;
+	FUNCTION_NODE*	current;
+	FUNCTION_NODE*	function_node = calloc(1,sizeof(FUNCTION_NODE));
+
+	function_node->flags = flags;
+
+	name = model_get_string(reader,&name_length);
+
+	if (name_length > 0 && (function_node->call = find_function(name,name_length)) == NULL)
+	{
+		function_node->call = add_function(name,name_length,FLAG_GHOST);
+	}
+
+	model_get_block_name(reader,&function_node->message);
+	model_get_block_name(reader,&function_node->after);
+	model_get_block_name(reader,&function_node->sequence);
+	model_get_block_name(reader,&function_node->condition);
+	model_get_block_name(reader,&function_node->to_timeline_name);
+	model_get_block_name(reader,&trigger);
+
+	if (trigger.name_length > 0)
+	{
+		function_node->trigger = malloc(sizeof(BLOCK_NAME));
+		memcpy(function_node->trigger,&trigger,sizeof(BLOCK_NAME));
+	}
+
+	num_triggers = model_get_varint(reader);
+	last = &function_node->triggers_list;
+
+	for (count=0; count < num_triggers && !reader->failed; count++)
+	{
+		*last = malloc(sizeof(BLOCK_NAME));
+		model_get_block_name(reader,*last);
+		last = &(*last)->next;
+	}
+
+	/* add node to the end of the function */
+	if ((current = function->node) == NULL)
+	{
+		function->node = function_node;
+	}
+	else
+	{
+		while (current->next != NULL)
+		{
+			current = current->next;
+		}
+
+		current->next = function_node;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_brief
+ * Desc : This function looks for the parameter of a brief that the partial link
+ *        did not find, in the parameters that the api function has now. If it
+ *        is still not found it is kept for the next partial model.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_brief(LINK_MODEL_READER* reader, GROUP* group, unsigned int line_number)
+{
+	NAME			name;
+	NAME			brief;
+	unsigned char*	function_name;
+	unsigned int	function_name_length;
+	API_FUNCTION*	function;
+	API_PARAMETER*	current_parameter;
+
+	function_name = model_get_string(reader,&function_name_length);
+	model_get_name(reader,&name);
+	model_get_name(reader,&brief);
+
+	if ((function = find_api_function(function_name,function_name_length,group)) == NULL)
+	{
+		function = add_api_function(function_name,function_name_length,group);
+	}
+
+	current_parameter = function->parameter_list;
+
+	while (current_parameter != NULL)
+	{
+		if (name.name_length == current_parameter->name.name_length &&
+			memcmp(name.name,current_parameter->name.name,name.name_length) == 0)
+		{
+			if (current_parameter->brief.name_length > 0)
+			{
+				raise_warning(line_number,EC_DUPLICATE_PARAMETER,current_parameter->brief.name,NULL);
+			}
+			else
+			{
+				copy_name(&brief,&current_parameter->brief);
+			}
+			break;
+		}
+
+		current_parameter = current_parameter->next;
+	}
+
+	if (current_parameter == NULL && g_partial_link)
+	{
+		link_brief_add(function,&name,&brief);
+	}
+
+	free(name.name);
+	free(brief.name);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_api_function
+ * Desc : This function merges an api function of the partial model. The names
+ *        that the partial model set replace the ones in the model, the
+ *        parameters are added to the front and the returns to the end, as
+ *        the objects would have added them.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_api_function(LINK_MODEL_READER* reader, GROUP* group)
+{
+	NAME			name;
+	NAME			return_type;
+	NAME			action;
+	NAME			description;
+	unsigned int	count;
+	unsigned int	num_items;
+	API_FUNCTION*	function;
+	API_PARAMETER*	parameters = NULL;
+	API_PARAMETER**	last_parameter = &parameters;
+	API_RETURNS*	returns = NULL;
+	API_RETURNS**	last_return;
+
+	model_get_name(reader,&name);
+	model_get_name(reader,&return_type);
+	model_get_name(reader,&action);
+	model_get_name(reader,&description);
+
+	if ((function = find_api_function(name.name,name.name_length,group)) == NULL)
+	{
+		function = add_api_function(name.name,name.name_length,group);
+	}
+
+	if (return_type.name_length > 0)
+	{
+		function->name = name;
+		function->return_type = return_type;
+	}
+	else
+	{
+		free(name.name);
+	}
+
+	if (action.name_length > 0)
+	{
+		function->action = action;
+	}
+
+	if (description.name_length > 0)
+	{
+		function->description = description;
+	}
+
+	num_items = model_get_varint(reader);
+
+	for (count=0; count < num_items && !reader->failed; count++)
+	{
+		*last_parameter = calloc(1,sizeof(API_PARAMETER));
+		model_get_name(reader,&(*last_parameter)->name);
+		model_get_name(reader,&(*last_parameter)->type);
+		model_get_name(reader,&(*last_parameter)->brief);
+		last_parameter = &(*last_parameter)->next;
+	}
+
+	*last_parameter = function->parameter_list;
+	function->parameter_list = parameters;
+
+	last_return = &function->returns_list;
+
+	while (*last_return != NULL)
+	{
+		last_return = &(*last_return)->next;
+	}
+
+	num_items = model_get_varint(reader);
+
+	for (count=0; count < num_items && !reader->failed; count++)
+	{
+		returns = calloc(1,sizeof(API_RETURNS));
+		model_get_name(reader,&returns->value);
+		model_get_name(reader,&returns->brief);
+
+		*last_return = returns;
+		last_return = &returns->next;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_type
+ * Desc : This function adds an api type of the partial model to the end of the
+ *        types of the group.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_type(LINK_MODEL_READER* reader, GROUP* group)
+{
+	unsigned int		count;
+	unsigned int		num_records;
+	API_TYPE*			current_type;
+	API_TYPE*			api_type = calloc(1,sizeof(API_TYPE));
+	API_TYPE_RECORD*	new_record;
+
+	model_get_name(reader,&api_type->name);
+	model_get_name(reader,&api_type->description);
+	api_type->depth = model_get_varint(reader);
+
+	num_records = model_get_varint(reader);
+
+	for (count=0; count < num_records && !reader->failed; count++)
+	{
+		new_record = calloc(1,sizeof(API_TYPE_RECORD));
+		new_record->record_type = model_get_varint(reader);
+		model_get_name(reader,&new_record->type_item);
+		model_get_name(reader,&new_record->name_value);
+		model_get_name(reader,&new_record->brief);
+
+		if (api_type->record_list == NULL)
+		{
+			api_type->record_list = new_record;
+		}
+		else
+		{
+			api_type->last_record->next = new_record;
+		}
+
+		api_type->last_record = new_record;
+	}
+
+	if ((current_type = group->api->type_list) == NULL)
+	{
+		group->api->type_list = api_type;
+	}
+	else
+	{
+		while (current_type->next != NULL)
+		{
+			current_type = current_type->next;
+		}
+
+		current_type->next = api_type;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_constants
+ * Desc : This function adds a constants group of the partial model to the end
+ *        of the constants of the group.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_constants(LINK_MODEL_READER* reader, GROUP* group)
+{
+	unsigned int	count;
+	unsigned int	num_constants;
+	API_CONSTANT*	new_constant;
+	API_CONSTANTS*	current_constants;
+	API_CONSTANTS*	api_constants = calloc(1,sizeof(API_CONSTANTS));
+
+	model_get_name(reader,&api_constants->name);
+	model_get_name(reader,&api_constants->description);
+
+	num_constants = model_get_varint(reader);
+
+	for (count=0; count < num_constants && !reader->failed; count++)
+	{
+		new_constant = calloc(1,sizeof(API_CONSTANT));
+		new_constant->constant = model_get_varint(reader);
+		model_get_name(reader,&new_constant->name);
+		model_get_name(reader,&new_constant->type);
+		model_get_name(reader,&new_constant->brief);
+		model_get_name(reader,&new_constant->value);
+
+		if (api_constants->constant_list == NULL)
+		{
+			api_constants->constant_list = new_constant;
+		}
+		else
+		{
+			api_constants->last_constant->next = new_constant;
+		}
+
+		api_constants->last_constant = new_constant;
+	}
+
+	if ((current_constants = group->api->constants_list) == NULL)
+	{
+		group->api->constants_list = api_constants;
+	}
+	else
+	{
+		while (current_constants->next != NULL)
+		{
+			current_constants = current_constants->next;
+		}
+
+		current_constants->next = api_constants;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_application
+ * Desc : This function adds an option, a section or a synopsis of the partial
+ *        model to the end of the application.
+ *--------------------------------------------------------------------------------*/
+static void	merge_partial_application(LINK_MODEL_READER* reader, APPLICATION* application, OBJECT_RECORD* record)
+{
+	OPTION*			option;
+	SECTION*		section;
+	SYNOPSIS_LIST*	synopsis;
+
+	if (record->type == LINK_MODEL_OPTION)
+	{
+		option = calloc(1,sizeof(OPTION));
+		option->flags = record->block_number;
+		model_get_name(reader,&option->name);
+		model_get_name(reader,&option->value);
+		model_get_name(reader,&option->description);
+
+		if (application->option_list == NULL)
+		{
+			application->option_list = option;
+		}
+		else
+		{
+			option->option_id = application->option_list->last->option_id + 1;
+			application->option_list->last->next = option;
+		}
+
+		application->option_list->last = option;
+	}
+	else if (record->type == LINK_MODEL_SECTION)
+	{
+		section = calloc(1,sizeof(SECTION));
+		model_get_name(reader,&section->name);
+		model_get_name(reader,&section->section_data);
+
+		if (application->section_list == NULL)
+		{
+			application->section_list = section;
+		}
+		else
+		{
+			application->section_list->last->next = section;
+		}
+
+		application->section_list->last = section;
+	}
+	else
+	{
+		synopsis = calloc(1,sizeof(SYNOPSIS_LIST));
+		model_get_name(reader,&synopsis->name);
+		model_get_name(reader,&synopsis->items);
+
+		merge_synopsis(application,synopsis);
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial_group
+ * Desc : This function finds or adds a group that the partial model declares.
+ *        A group named "all" after the first group is the "all" group that the
+ *        objects used, it has to be the first group of the model as well.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	merge_partial_group(LINK_OBJECT* object, LINK_MODEL_READER* reader)
+{
+	unsigned int	result = 0;
+	unsigned int	special_group;
+	GROUP*			group;
+	LINK_LOCALS*	locals = &object->locals;
+
+	if ((group = find_group(&g_group_tree,reader->data,reader->size,&special_group)) == NULL)
+	{
+		if (special_group != NORMAL_GROUP)
+		{
+			result = EC_SPECIFIED_SPECIAL_GROUP_IN_MODEL;
+			raise_warning(0,result,NULL,NULL);
+		}
+
+		group = add_group(&g_group_tree,reader->data,reader->size);
+	}
+
+	if (special_group == ALL_GROUP)
+	{
+		g_all_group_used = 1;
+	}
+
+	if (special_group == ALL_GROUP && locals->groups.num_items > 1)
+	{
+		if (group != locals->groups.items[1])
+		{
+			result = EC_PARTIAL_MODEL_ALL_GROUP_CHANGED;
+			raise_warning(0,result,(unsigned char*)object->filename,NULL);
+		}
+	}
+	else if (local_add(&locals->groups,group) != EC_OK)
+	{
+		reader->failed = 1;
+	}
+
+	link_touch(object,LINK_TOUCH_GROUP,group->name,group->name_length);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_partial
+ * Desc : This function merges the link model of a partial model. The records
+ *        find or add the things in the model in the order that the objects of
+ *        the partial link added them, so the model is the same as if the
+ *        objects had been merged. The partial model can be merged again if
+ *        the model is built again.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	merge_partial(LINK_OBJECT* object)
+{
+	unsigned int		result = 0;
+	unsigned int		count;
+	unsigned int		num_records = object->num_records;
+	unsigned int		name_length;
+	unsigned char*		name;
+	void*				item;
+	GROUP*				group;
+	OBJECT_RECORD*		record;
+	LINK_MODEL_READER	reader;
+	LINK_LOCALS*		locals = &object->locals;
+
+	if (object->truncated)
+	{
+		num_records--;
+		raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)object->filename,NULL);
+		result = 1;
+	}
+
+	if (local_add(&locals->groups,&g_group_tree) != EC_OK ||
+		local_add(&locals->functions,&g_function_list) != EC_OK ||
+		local_add(&locals->applications,&g_application_list) != EC_OK)
+	{
+		raise_warning(0,EC_OUT_OF_MEMORY_OR_FILE_TO_BIG,(unsigned char*)object->filename,NULL);
+		num_records = 0;
+		result = 1;
+	}
+
+	for (count=0; count < num_records; count++)
+	{
+		record = &object->records[count].record;
+
+		memset(&reader,0,sizeof(LINK_MODEL_READER));
+		reader.data = object->records[count].payload;
+		reader.size = record->data_size;
+		reader.locals = locals;
+
+		group = local_item(&locals->groups,record->group);
+
+		switch (record->type)
+		{
+			case INTERMEDIATE_RECORD_GROUP:
+				result |= merge_partial_group(object,&reader);
+				group = NULL;
+				break;
+
+			case INTERMEDIATE_RECORD_FUNCTION:
+				if ((item = find_function(reader.data,reader.size)) == NULL)
+				{
+					item = add_function(reader.data,reader.size,record->block_number);
+				}
+
+				reader.failed = (local_add(&locals->functions,item) != EC_OK);
+				link_touch(object,LINK_TOUCH_FUNCTION,((FUNCTION*)item)->name,((FUNCTION*)item)->name_length);
+				group = NULL;
+				break;
+
+			case INTERMEDIATE_RECORD_APPLICATION:
+				reader.failed = (local_add(&locals->applications,find_add_application(reader.data,reader.size)) != EC_OK);
+
+				if (reader.size > 0)
+				{
+					link_touch(object,LINK_TOUCH_APPLICATIONS,NULL,0);
+				}
+
+				group = NULL;
+				break;
+
+			case INTERMEDIATE_RECORD_SAMPLE:
+				if (reader.size < 4 || ((reader.data[0] << 8) | reader.data[1]) + ((reader.data[2] << 8) | reader.data[3]) != reader.size - 4)
+				{
+					reader.failed = 1;
+				}
+				else
+				{
+					add_sample(reader.data,reader.size);
+					link_touch(object,LINK_TOUCH_SAMPLES,NULL,0);
+				}
+
+				group = NULL;
+				break;
+
+			case LINK_MODEL_OPTION:
+			case LINK_MODEL_SECTION:
+			case LINK_MODEL_SYNOPSIS:
+				if ((item = local_item(&locals->applications,record->group)) == NULL)
+				{
+					reader.failed = 1;
+				}
+				else
+				{
+					merge_partial_application(&reader,item,record);
+					link_touch(object,LINK_TOUCH_APPLICATIONS,NULL,0);
+				}
+
+				group = NULL;
+				break;
+
+			case LINK_MODEL_FUNCTION_NODE:
+				if ((item = local_item(&locals->functions,record->group)) == NULL)
+				{
+					reader.failed = 1;
+				}
+				else
+				{
+					merge_partial_function_node(&reader,item,record->block_number);
+				}
+
+				group = NULL;
+				break;
+
+			default:
+				if (group == NULL)
+				{
+					reader.failed = 1;
+				}
+				else if (group->api == NULL && (record->type == LINK_MODEL_API_TYPE || record->type == LINK_MODEL_API_CONSTANTS))
+				{
+					group->api = calloc(1,sizeof(API));
+					group->api->group = group;
+				}
+
+				switch (group == NULL ? 0 : record->type)
+				{
+					case LINK_MODEL_TRIGGER:
+						name = model_get_string(&reader,&name_length);
+
+						if ((item = find_trigger(group,name,name_length)) == NULL)
+						{
+							add_trigger(group,name,name_length,record->block_number);
+						}
+						else if ((record->block_number & FLAG_GHOST) == 0)
+						{
+							((TRIGGER*)item)->flags &= ~FLAG_GHOST;
+						}
+						break;
+
+					case LINK_MODEL_STATE:
+						name = model_get_string(&reader,&name_length);
+
+						if ((item = find_state(group,string_pool_add(name,name_length))) == NULL)
+						{
+							add_state(group,name,name_length,record->line_number,record->block_number);
+						}
+						else if ((((STATE*)item)->flags & FLAG_GHOST) == FLAG_GHOST && (record->block_number & FLAG_GHOST) == 0)
+						{
+							((STATE*)item)->flags &= ~FLAG_GHOST;
+							((STATE*)item)->line_number = record->line_number;
+						}
+						break;
+
+					case LINK_MODEL_TIMELINE:
+						name = model_get_string(&reader,&name_length);
+
+						if (find_timeline(group,string_pool_add(name,name_length)) == NULL)
+						{
+							add_timeline(group,name,name_length,record->line_number,record->block_number);
+						}
+						break;
+
+					case LINK_MODEL_TRANSITION:
+						merge_partial_transition(&reader,group,record->line_number);
+						break;
+
+					case LINK_MODEL_NODE:
+						merge_partial_node(&reader,group,record);
+						break;
+
+					case LINK_MODEL_API_BRIEF:
+						merge_partial_brief(&reader,group,record->line_number);
+						break;
+
+					case LINK_MODEL_API_FUNCTION:
+						merge_partial_api_function(&reader,group);
+						break;
+
+					case LINK_MODEL_API_TYPE:
+						merge_partial_type(&reader,group);
+						break;
+
+					case LINK_MODEL_API_CONSTANTS:
+						merge_partial_constants(&reader,group);
+						break;
+				}
+				break;
+		}
+
+		if (group != NULL)
+		{
+			link_touch(object,LINK_TOUCH_GROUP,group->name,group->name_length);
+		}
+
+		if (reader.failed)
+		{
+			raise_warning(0,EC_PROBLEM_WITH_INPUT_FILE,(unsigned char*)object->filename,NULL);
+			result = 1;
+			break;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_object
+ * Desc : This function will add the model of a decoded object to the model. It
+ *        finds or adds the things that the object declares, and the blocks are
+ *        then handed over to the model. It will also handle the first parse on
+ *        the building of the connections. The objects must be merged in the
+ *        order that they were given. The object is not released, as the model
+ *        may have to be built again.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	merge_object(LINK_OBJECT* object)
+{
+	unsigned int 	result = 0;
+	unsigned int	count;
+	unsigned int	special_group;
+	unsigned int	file_name_size;
+	void*			item;
+	LINK_ITEM*		current;
+	LINK_LOCALS*	locals = &object->locals;
+
+	static unsigned char	source_file_name[MAX_FILENAME+1];
+
+	g_input_filename = NULL;
+	g_source_filename = source_file_name;
+	g_source_filename[0] = '\0';
+
+	if (object->error != EC_OK && !object->loaded)
+	{
+		raise_warning(0,object->error,(unsigned char*)object->filename,NULL);
+		result = 1;
+	}
+	else if (object->loaded)
+	{
+		/* we have a object file -- we are ignoring all other files at this pass */
+		if (object->later_version)
+		{
+			raise_warning(0,EC_INPUT_FILE_BUILT_WITH_LATER_MAJOR_VERSION,NULL,NULL);
+			result = 1;
+		}
+
+		/* over-long names keep the tail, that is the useful end of a path */
+		file_name_size = object->source_name_length;
+
+		if (file_name_size > MAX_FILENAME)
+		{
+			file_name_size = MAX_FILENAME;
+		}
+
+		memcpy(source_file_name,&object->source_name[object->source_name_length - file_name_size],file_name_size);
+		source_file_name[file_name_size] = '\0';
+		g_source_filename_length = file_name_size;
+
+		if (object->is_partial)
+		{
+			/* the partial model is merged from its records, it has no items */
+			result |= merge_partial(object);
+		}
+		else if (locals->groups.num_items == 0)
+		{
+			/* the object could not be decoded */
+			raise_warning(0,EC_OUT_OF_MEMORY_OR_FILE_TO_BIG,(unsigned char*)object->filename,NULL);
+			result = 1;
+		}
+		else
+		{
+			locals->groups.items[0] = &g_group_tree;
+		}
+
+		/* now walk the model of the object */
+		for (count=0; locals->groups.num_items > 0 && count < object->num_items; count++)
+		{
+			current = &object->items[count];
+
+			switch (current->type)
+			{
+				case LINK_ITEM_WARNING:
+					raise_warning(current->line_number,current->value,current->data.text,NULL);
+					break;
+
+				case LINK_ITEM_NOTE:
+					printf((const char*) current->data.text,current->value);
+					break;
+
+				case LINK_ITEM_GROUP:
+					if ((item = find_group(&g_group_tree,current->name,current->name_length,&special_group)) == NULL)
+					{
+						if (special_group != NORMAL_GROUP)
+						{
+							result = EC_SPECIFIED_SPECIAL_GROUP_IN_MODEL;
+							raise_warning(current->line_number,result,NULL,NULL);
+						}
+
+						item = add_group(&g_group_tree,current->name,current->name_length);
+					}
+
+					/* a partial model has to say that "all" was used */
+					if (special_group == ALL_GROUP)
+					{
+						g_all_group_used = 1;
+					}
+
+					link_touch(object,LINK_TOUCH_GROUP,((GROUP*)item)->name,((GROUP*)item)->name_length);
+					locals->groups.items[current->id] = item;
+					break;
+
+				case LINK_ITEM_FUNCTION:
+					if ((item = find_function(current->name,current->name_length)) == NULL)
+					{
+						item = add_function(current->name,current->name_length,0);
+					}
+
+					link_touch(object,LINK_TOUCH_FUNCTION,((FUNCTION*)item)->name,((FUNCTION*)item)->name_length);
+					locals->functions.items[current->id] = item;
+					break;
+
+				case LINK_ITEM_APPLICATION:
+					locals->applications.items[current->id] = find_add_application(current->name,current->name_length);
+
+					if (current->name_length > 0)
+					{
+						link_touch(object,LINK_TOUCH_APPLICATIONS,NULL,0);
+					}
+					break;
+
+				case LINK_ITEM_SAMPLE:
+					add_sample(current->name,current->name_length);
+					link_touch(object,LINK_TOUCH_SAMPLES,NULL,0);
+					break;
+
+				case LINK_ITEM_API:
+					if ((item = local_item(&locals->groups,current->value)) != NULL)
+					{
+						link_touch(object,LINK_TOUCH_GROUP,((GROUP*)item)->name,((GROUP*)item)->name_length);
+
+						if ((locals->api_functions.items[current->id] = find_api_function(current->name,current->name_length,item)) == NULL)
+						{
+							locals->api_functions.items[current->id] = add_api_function(current->name,current->name_length,item);
+						}
+					}
+					break;
+
+				case LINK_ITEM_API_TYPE:
+					if ((item = local_item(&locals->api_functions,current->id)) != NULL && current->data.names != NULL)
+					{
+						decode_api_function_type(item,current->value,&current->data.names[0],&current->data.names[1],&current->data.names[2]);
+					}
+					break;
+
+				case LINK_ITEM_SECTION:
+					new_section(local_item(&locals->applications,current->id),current->name,current->name_length,current->value);
+					break;
+
+				case LINK_ITEM_SECTION_DATA:
+					extend_section(local_item(&locals->applications,current->id),current->name,current->name_length,current->value);
+					break;
+
+				case LINK_ITEM_SYNOPSIS:
+					if ((item = local_item(&locals->applications,current->id)) != NULL)
+					{
+						merge_synopsis(item,current->data.synopsis);
+						current->data.synopsis = NULL;
+					}
+					break;
+
+				case LINK_ITEM_TOUCH:
+					if ((item = local_item(&locals->groups,current->id)) != NULL)
+					{
+						link_touch(object,LINK_TOUCH_GROUP,((GROUP*)item)->name,((GROUP*)item)->name_length);
+					}
+					break;
+
+				case LINK_ITEM_BLOCK:
+					merge_block(object,current->data.block);
+					break;
+			}
+		}
+
+		if (object->failed)
+		{
+			result = 1;
+		}
+	}
+
+	release_object_model(object);
+
+	g_source_filename = NULL;
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_find
+ * Desc : This function finds the first node of the set that the node is in.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_find(LINK_STATE* state, unsigned int node)
+{
+	while (state->nodes[node].parent != node)
+	{
+		state->nodes[node].parent = state->nodes[state->nodes[node].parent].parent;
+		node = state->nodes[node].parent;
+	}
+
+	return node;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_node
+ * Desc : This function finds the node for a thing in the model. If the node is
+ *        not found and create is set, it is added in a set of its own. It
+ *        returns the node plus one, or zero if it is not found.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_node(LINK_STATE* state, unsigned char type, unsigned char* name, unsigned int name_length, unsigned int create)
+{
+	static unsigned char	touch_scope[LINK_TOUCH_APPLICATIONS+1];
+
+	unsigned int	result;
+	LINK_NODE*		nodes;
+
+	result = (unsigned int)(size_t) symbol_table_find(&state->node_names,&touch_scope[type],name,name_length);
+
+	if (result == 0 && create)
+	{
+		if (state->num_nodes == state->max_nodes)
+		{
+			if ((nodes = realloc(state->nodes,(state->max_nodes + LINK_NODE_BLOCK_SIZE) * sizeof(LINK_NODE))) != NULL)
+			{
+				state->nodes = nodes;
+				state->max_nodes += LINK_NODE_BLOCK_SIZE;
+			}
+		}
+
+		if (state->num_nodes < state->max_nodes)
+		{
+			memset(&state->nodes[state->num_nodes],0,sizeof(LINK_NODE));
+			state->nodes[state->num_nodes].touch.type = type;
+			state->nodes[state->num_nodes].touch.name = name;
+			state->nodes[state->num_nodes].touch.name_length = name_length;
+			state->nodes[state->num_nodes].parent = state->num_nodes;
+			state->num_nodes++;
+
+			result = state->num_nodes;
+			symbol_table_add(&state->node_names,&touch_scope[type],name,name_length,(void*)(size_t) result);
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_rebuilt
+ * Desc : This function returns true if the thing is in a set that is rebuilt.
+ *        The things that are not in the link state are not rebuilt, as no
+ *        object that is kept added to them.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_rebuilt(LINK_STATE* state, unsigned char type, unsigned char* name, unsigned int name_length)
+{
+	unsigned int	node = link_state_node(state,type,name,name_length,0);
+
+	return (node > 0 && state->nodes[link_state_find(state,node-1)].rebuild);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_touches
+ * Desc : This function will join the things that an object added to into one
+ *        set, or if mark is set it will mark the sets that they are in to be
+ *        rebuilt.
+ *--------------------------------------------------------------------------------*/
+static void	link_state_touches(LINK_STATE* state, LINK_TOUCH* touches, unsigned int num_touches, unsigned int mark)
+{
+	unsigned int	count;
+	unsigned int	node;
+	unsigned int	first = 0;
+
+	for (count=0; count < num_touches; count++)
+	{
+		if ((node = link_state_node(state,touches[count].type,touches[count].name,touches[count].name_length,1)) > 0)
+		{
+			node = link_state_find(state,node-1);
+
+			if (mark)
+			{
+				state->nodes[node].rebuild = 1;
+			}
+			else if (first == 0)
+			{
+				first = node + 1;
+			}
+			else
+			{
+				state->nodes[node].parent = link_state_find(state,first-1);
+			}
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_mark_object
+ * Desc : This function will mark the sets that an object names to be rebuilt,
+ *        the groups, the functions it has or calls, the samples and the
+ *        applications. These are found from the records as the object has not
+ *        been merged, they are checked once it has been.
+ *--------------------------------------------------------------------------------*/
+static void	link_state_mark_object(LINK_STATE* state, LINK_OBJECT* object)
+{
+	unsigned int	count;
+	unsigned int	node;
+	unsigned int	type;
+	unsigned int	name_length;
+	unsigned char*	name;
+	LINK_RECORD*	record;
+
+	for (count=0; count < object->num_records; count++)
+	{
+		record = &object->records[count];
+		name = record->payload;
+		name_length = record->record.data_size;
+		type = 0;
+
+		switch (record->record.type)
+		{
+			case INTERMEDIATE_RECORD_GROUP:
+				if (name_length == 0)
+				{
+					/* maps to the default group */
+				}
+				else if (name_length == 3 && memcmp("all",name,name_length) == 0)
+				{
+					name = state->order[0].name;
+					name_length = state->order[0].name_length;
+					type = LINK_TOUCH_GROUP;
+				}
+				else if (name_length == 8 && memcmp("document",name,name_length) == 0)
+				{
+					name_length = 0;
+					type = LINK_TOUCH_GROUP;
+				}
+				else
+				{
+					type = LINK_TOUCH_GROUP;
+				}
+				break;
+
+			case INTERMEDIATE_RECORD_FUNCTION:
+				type = LINK_TOUCH_FUNCTION;
+				break;
+
+			case INTERMEDIATE_RECORD_APPLICATION:
+				if (name_length > 0)
+				{
+					name_length = 0;
+					type = LINK_TOUCH_APPLICATIONS;
+				}
+				break;
+
+			case INTERMEDIATE_RECORD_SAMPLE:
+				name_length = 0;
+				type = LINK_TOUCH_SAMPLES;
+				break;
+
+			case INTERMEDIATE_RECORD_NAME:
+				if (record->record.atom == ATOM_CALL)
+				{
+					type = LINK_TOUCH_FUNCTION;
+				}
+				break;
+		}
+
+		if (type != 0 && (node = link_state_node(state,type,name,name_length,1)) > 0)
+		{
+			state->nodes[link_state_find(state,node-1)].rebuild = 1;
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_order
+ * Desc : This function finds the order of the groups in the model. It follows
+ *        the group lookups the same way that the objects are merged, the groups
+ *        are added in the order that they are first named. It fails if "all"
+ *        is used before there is a group, as merging the object will fail.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_order(LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links)
+{
+	unsigned int	result = 1;
+	unsigned int	count;
+	unsigned int	record;
+	unsigned int	name_length;
+	unsigned char*	name;
+	LINK_TOUCH*		order;
+	SYMBOL_TABLE	groups;
+
+	memset(&groups,0,sizeof(SYMBOL_TABLE));
+
+	for (count=0; result && count < num_links; count++)
+	{
+		for (record=0; result && record < link_list[count]->num_records; record++)
+		{
+			name = link_list[count]->records[record].payload;
+			name_length = link_list[count]->records[record].record.data_size;
+
+			if (link_list[count]->records[record].record.type != INTERMEDIATE_RECORD_GROUP || name_length == 0)
+			{
+				/* not a group lookup */
+			}
+			else if (name_length == 3 && memcmp("all",name,name_length) == 0)
+			{
+				result = (state->num_order > 0);
+			}
+			else if (name_length == 8 && memcmp("document",name,name_length) == 0)
+			{
+				/* the document group */
+			}
+			else if (symbol_table_find(&groups,NULL,name,name_length) == NULL)
+			{
+				if (state->num_order == state->max_order)
+				{
+					if ((order = realloc(state->order,(state->max_order + LINK_NODE_BLOCK_SIZE) * sizeof(LINK_TOUCH))) == NULL)
+					{
+						result = 0;
+						break;
+					}
+
+					state->order = order;
+					state->max_order += LINK_NODE_BLOCK_SIZE;
+				}
+
+				state->order[state->num_order].type = LINK_TOUCH_GROUP;
+				state->order[state->num_order].name = name;
+				state->order[state->num_order].name_length = name_length;
+				state->num_order++;
+
+				symbol_table_add(&groups,NULL,name,name_length,state->order);
+			}
+		}
+	}
+
+	symbol_table_release(&groups);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_object
+ * Desc : This function returns the entry in the link state of the model that the
+ *        object was kept from.
+ *--------------------------------------------------------------------------------*/
+static LINK_STATE_OBJECT*	link_state_object(LINK_OBJECT* object)
+{
+	LINK_STATE_OBJECT*	result = NULL;
+
+	if (object->source != NULL && object->previous > 0)
+	{
+		result = &object->source->objects[object->previous-1];
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_section
+ * Desc : This function returns the section of one of the models that can be
+ *        copied for the thing, or NULL if the section has to be written.
+ *--------------------------------------------------------------------------------*/
+static LINK_STATE_SECTION*	link_state_section(LINK_STATE* state, unsigned char type, unsigned char* name, unsigned int name_length)
+{
+	unsigned int		node;
+	LINK_SOURCE*		source;
+	LINK_STATE_SECTION*	result = NULL;
+
+	if (state != NULL && state->incremental && (node = link_state_node(state,type,name,name_length,0)) > 0)
+	{
+		node = link_state_find(state,node-1);
+
+		if (!state->nodes[node].rebuild && state->nodes[node].owner > 0)
+		{
+			source = state->sources[state->nodes[node].owner-1];
+
+			if (type == LINK_TOUCH_SAMPLES)
+			{
+				result = &source->samples;
+			}
+			else if (type == LINK_TOUCH_APPLICATIONS)
+			{
+				result = &source->applications;
+			}
+			else if (type == LINK_TOUCH_GROUP)
+			{
+				result = symbol_table_find(&source->group_names,NULL,name,name_length);
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_plan
+ * Desc : This function decides which of the objects have to be merged and the
+ *        sections that can be copied from the models. An object is kept if it
+ *        is in one of the models and it has not changed, a set of things can
+ *        be copied if all the objects that add to it are kept from the same
+ *        model. It returns zero and the reason if all of the objects have to
+ *        be linked.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_plan(LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links, const char** reason)
+{
+	unsigned int		result = 1;
+	unsigned int		count;
+	unsigned int		touch;
+	unsigned int		node;
+	unsigned int*		last;
+	LINK_OBJECT*		object;
+	LINK_SOURCE*		source;
+	LINK_STATE_OBJECT*	previous;
+	LINK_STATE_SECTION*	section;
+
+	if ((last = calloc(state->num_sources + 1,sizeof(unsigned int))) == NULL)
+	{
+		*reason = "out of memory";
+		result = 0;
+	}
+	else if (!link_state_order(state,link_list,num_links))
+	{
+		*reason = "an object names the \"all\" group before there are groups";
+		result = 0;
+	}
+
+	/* find the objects in the models */
+	for (count=0; result && count < num_links; count++)
+	{
+		object = link_list[count];
+
+		if (object->error != EC_OK || object->later_version || object->truncated)
+		{
+			*reason = "an object has an error";
+			result = 0;
+		}
+		else if (object->loaded)
+		{
+			previous = NULL;
+
+			if (state->previous.num_objects > 0)
+			{
+				previous = symbol_table_find(&state->previous.object_names,NULL,(unsigned char*)object->filename,strlen(object->filename));
+			}
+
+			if (previous != NULL && !previous->used)
+			{
+				object->source = &state->previous;
+				object->previous = (previous - state->previous.objects) + 1;
+			}
+
+			previous = link_state_object(object);
+
+			object->kept = (previous != NULL && previous->size == object->size && previous->fingerprint == object->fingerprint);
+
+			if (previous != NULL)
+			{
+				previous->used = 1;
+
+				/* the kept objects of a model must be in the same order */
+				if (object->previous <= last[object->source->index])
+				{
+					object->source->reordered = 1;
+				}
+
+				last[object->source->index] = object->previous;
+			}
+
+			/* "all" is the first group in the model, that might have changed */
+			for (touch=0; object->kept && touch < object->num_records; touch++)
+			{
+				object->kept = !(object->records[touch].record.type == INTERMEDIATE_RECORD_GROUP &&
+								 object->records[touch].record.data_size == 3 &&
+								 memcmp("all",object->records[touch].payload,3) == 0);
+			}
+		}
+	}
+
+	if (result)
+	{
+		for (count=0; count < num_links; count++)
+		{
+			if (link_list[count]->kept && link_list[count]->source->reordered)
+			{
+				link_list[count]->kept = 0;
+			}
+		}
+
+		/* join the things that the same kept object added to */
+		for (count=0; count < num_links; count++)
+		{
+			if (link_list[count]->loaded && link_list[count]->kept)
+			{
+				previous = link_state_object(link_list[count]);
+				link_state_touches(state,previous->touches,previous->num_touches,0);
+			}
+		}
+
+		/* rebuild the sets that the removed and the changed objects added to */
+		for (count=0; count < state->previous.num_objects; count++)
+		{
+			if (!state->previous.objects[count].used)
+			{
+				link_state_touches(state,state->previous.objects[count].touches,state->previous.objects[count].num_touches,1);
+			}
+		}
+
+		for (count=0; count < num_links; count++)
+		{
+			object = link_list[count];
+
+			if (object->loaded && !object->kept)
+			{
+				if ((previous = link_state_object(object)) != NULL)
+				{
+					link_state_touches(state,previous->touches,previous->num_touches,1);
+				}
+
+				link_state_mark_object(state,object);
+			}
+		}
+
+		/* a set can only be copied from one model */
+		for (count=0; count < num_links; count++)
+		{
+			object = link_list[count];
+
+			if (object->loaded && object->kept)
+			{
+				previous = link_state_object(object);
+
+				for (touch=0; touch < previous->num_touches; touch++)
+				{
+					node = link_state_node(state,previous->touches[touch].type,previous->touches[touch].name,previous->touches[touch].name_length,0);
+					node = link_state_find(state,node-1);
+
+					if (state->nodes[node].owner == 0)
+					{
+						state->nodes[node].owner = object->source->index + 1;
+					}
+					else if (state->nodes[node].owner != object->source->index + 1)
+					{
+						state->nodes[node].rebuild = 1;
+					}
+				}
+			}
+		}
+
+		/* and the model must have the sections */
+		state->incremental = 1;
+
+		for (count=0; count < state->num_nodes; count++)
+		{
+			node = link_state_find(state,count);
+
+			if (!state->nodes[node].rebuild && state->nodes[count].touch.type == LINK_TOUCH_GROUP)
+			{
+				source = state->sources[state->nodes[node].owner-1];
+				section = symbol_table_find(&source->group_names,NULL,state->nodes[count].touch.name,state->nodes[count].touch.name_length);
+				state->nodes[node].rebuild = (section == NULL);
+			}
+		}
+
+		/* the kept objects that added to the rebuilt sets are merged again */
+		for (count=0; count < num_links; count++)
+		{
+			object = link_list[count];
+			object->merge = (object->loaded && !object->kept);
+
+			if (object->loaded && object->kept)
+			{
+				previous = link_state_object(object);
+
+				for (touch=0; touch < previous->num_touches && !object->merge; touch++)
+				{
+					object->merge = link_state_rebuilt(state,previous->touches[touch].type,previous->touches[touch].name,previous->touches[touch].name_length);
+				}
+			}
+		}
+	}
+
+	free(last);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_check
+ * Desc : This function checks that the merged objects only added to the sets
+ *        that were rebuilt. If a changed object now adds to a group that is
+ *        copied from one of the models then the model would be wrong.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	link_state_check(LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links)
+{
+	unsigned int	result = 1;
+	unsigned int	count;
+	unsigned int	touch;
+	unsigned int	num_groups = 0;
+	LINK_TOUCH*		touches;
+	GROUP*			current = &g_group_tree;
+
+	while (current != NULL)
+	{
+		num_groups++;
+		current = current->next;
+	}
+
+	for (count=0; result && count < num_links; count++)
+	{
+		touches = link_list[count]->touches;
+
+		for (touch=0; result && link_list[count]->merge && touch < link_list[count]->num_touches; touch++)
+		{
+			result = link_state_rebuilt(state,touches[touch].type,touches[touch].name,touches[touch].name_length);
+		}
+	}
+
+	return (result && num_groups == state->num_order + 1);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : link_state_release
+ * Desc : This function releases the link state and unmaps the previous model.
+ *--------------------------------------------------------------------------------*/
+static void	link_state_release(LINK_STATE* state)
+{
+	link_source_release(&state->previous);
+	unmap_input_file(&state->model);
+
+	free(state->sources);
+	free(state->nodes);
+	free(state->order);
+
+	symbol_table_release(&state->node_names);
+
+	memset(state,0,sizeof(LINK_STATE));
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : reset_model
+ * Desc : This function throws away the model so that it can be built again.
+ *        The items in the model are not freed, the names that the objects
+ *        recorded are in the string pool so they still exist.
+ *--------------------------------------------------------------------------------*/
+static void	reset_model(LINK_OBJECT** link_list, unsigned int num_links)
+{
+	unsigned int	count;
+
+	memset(&g_group_tree,0,sizeof(GROUP));
+	memset(&g_sample_list,0,sizeof(SAMPLE));
+	memset(&g_function_list,0,sizeof(FUNCTION));
+	memset(&g_application_list,0,sizeof(APPLICATION));
+
+	symbol_table_release(&g_trigger_symbols);
+	symbol_table_release(&g_function_symbols);
+	symbol_table_release(&g_api_function_symbols);
+	symbol_table_release(&g_application_symbols);
+	model_symbol_release();
+
+	for (count=0; count < num_links; count++)
+	{
+		link_list[count]->num_touches = 0;
+		link_list[count]->merge = 1;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_objects
+ * Desc : This function merges the objects in the link order. In an incremental
+ *        link only the objects that have been marked are merged. The objects
+ *        that are to be merged are decoded by the work pool first, then they
+ *        are merged one at a time. The objects are released as they are
+ *        merged, unless they are kept for the link state as the model may have
+ *        to be built again.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	merge_objects(LINK_OBJECT** link_list, unsigned int num_links, unsigned int num_workers, unsigned int incremental, unsigned int release)
+{
+	unsigned int	result = 0;
+	unsigned int	count;
+
+	for (count=0; count < num_links; count++)
+	{
+		link_list[count]->decode = (!incremental || link_list[count]->merge);
+	}
+
+	work_pool_run(num_workers,num_links,decode_job,link_list);
+
+	for (count=0; count < num_links; count++)
+	{
+		if (link_list[count]->decode)
+		{
+			result |= merge_object(link_list[count]);
+		}
+
+		if (release)
+		{
+			release_object(link_list[count]);
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : check_state_machine
+ * Desc : This function will check to see if the state machine is valid.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	check_state_machine(STATE_MACHINE* state_machine)
+{
+	unsigned int		result = EC_OK;
+	STATE*				current_state = NULL;
+	STATE_TRANSITION*	current_trans = NULL;
+	
+	current_state = state_machine->state_list;
+
+	while (current_state != NULL)
+	{
+		if (current_state->name[0] == 's' && current_state->name_length == 5 && memcmp(current_state->name,"start",5) == 0)
+		{
+			/* found the start state */
+			state_machine->init_state = current_state;
+		}
+
+		if ((current_state->flags & FLAG_GHOST) == FLAG_GHOST)
+		{
+			if (current_state->name_length == finish_state_length && memcmp(current_state->name,finish_state,finish_state_length) != 0)
+			{
+				result = EC_UNDEFINDED_REFERENCED_STATE_FOUND;
+				raise_warning(current_state->line_number,result,NULL,NULL);
+			}
+		}
+
+		current_state = current_state->next;
+	}
+
+	if (state_machine->init_state == NULL)
+	{
+		result = EC_STATE_MACHINE_DOES_NOT_HAVE_START;
+		raise_warning(0,result,state_machine->group->name,NULL);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : after_name
+ * Desc : This function returns the name that an @after on another node would
+ *        use to reference this node, the function that it calls or the message
+ *        that it sends.
+ *--------------------------------------------------------------------------------*/
+static unsigned char*	after_name(NODE* node, unsigned int* name_length)
+{
+	unsigned char*	result = NULL;
+
+	if (node->function != NULL)
+	{
+		result = node->function->name;
+		*name_length = node->function->name_length;
+	}
+	else if (node->sent_message != NULL && node->sent_message->name_length > 0)
+	{
+		result = node->sent_message->name;
+		*name_length = node->sent_message->name_length;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : place_node
+ * Desc : This function adds the node to the new order of the timeline. If the
+ *        node is the last node that is after a block, the block is placed in
+ *        front of it first.
+ *--------------------------------------------------------------------------------*/
+static void	place_node(REORDER_NODE* entry, NODE** last_node, TIMELINE* timeline)
+{
+	REORDER_NODE*	block;
+
+	if (entry->state == REORDER_VISITING)
+	{
+		raise_warning(entry->node->line_number,EC_AFTER_NODES_FORM_A_LOOP,NULL,NULL);
+	}
+	else if (entry->state == REORDER_NOT_PLACED)
+	{
+		entry->state = REORDER_VISITING;
+
+		if (entry->after != NULL && entry->after->dependent == entry)
+		{
+			for (block = entry->after; block <= entry->after->block_end; block++)
+			{
+				place_node(block,last_node,timeline);
+			}
+		}
+
+		if (*last_node == NULL)
+		{
+			timeline->node = entry->node;
+		}
+		else
+		{
+			(*last_node)->next = entry->node;
+		}
+
+		*last_node = entry->node;
+		entry->state = REORDER_PLACED;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : reorder_nodes
+ * Desc : This function will reorder the nodes in the specific timeline.
+ *
+ *        A node with an @after depends on the block that sends the message or
+ *        calls the function, a block being the node and the waits and function
+ *        nodes that follow it. The names are looked up in one pass, then one
+ *        more pass places each block directly in front of the last node that
+ *        depends on it, placing the blocks that it depends on first.
+ *--------------------------------------------------------------------------------*/
+static ERROR_CODES	reorder_nodes(TIMELINE* timeline)
+{
+	NODE*			last_node = NULL;
+	NODE*			current_node;
+	REORDER_NODE*	entry;
+	REORDER_NODE*	nodes;
+	REORDER_NODE*	block_start = NULL;
+	SYMBOL_TABLE	names = {0};
+	unsigned char*	name;
+	unsigned int	count;
+	unsigned int	num_nodes = 0;
+	unsigned int	name_length;
+	ERROR_CODES 	result = EC_OK;
+
+	for (current_node = timeline->node; current_node != NULL; current_node = current_node->next)
+	{
+		num_nodes++;
+	}
+
+	g_sequence_stats.nodes += num_nodes;
+
+	if (num_nodes > 0 && (nodes = calloc(num_nodes,sizeof(REORDER_NODE))) != NULL)
+	{
+		/* find the blocks and the names that can be depended on */
+		current_node = timeline->node;
+
+		for (count=0; count < num_nodes; count++)
+		{
+			entry = &nodes[count];
+			entry->node = current_node;
+
+			if ((current_node->flags & (FLAG_WAIT | FLAG_IN_FUNCTION)) == 0 || block_start == NULL)
+			{
+				block_start = entry;
+
+				if ((current_node->flags & FLAG_WAIT) == 0 && (name = after_name(current_node,&name_length)) != NULL)
+				{
+					if (symbol_table_find(&names,NULL,name,name_length) == NULL)
+					{
+						symbol_table_add(&names,NULL,name,name_length,entry);
+					}
+				}
+			}
+
+			block_start->block_end = entry;
+			current_node = current_node->next;
+		}
+
+		/* connect the dependencies, the last node that is after a block gets it */
+		for (count=0; count < num_nodes; count++)
+		{
+			entry = &nodes[count];
+
+			if (entry->node->after.name_length > 0)
+			{
+				if ((entry->after = symbol_table_find(&names,NULL,entry->node->after.name,entry->node->after.name_length)) == NULL)
+				{
+					result = EC_AFTER_NODE_DOES_NOT_EXIST;
+					raise_warning(entry->node->line_number,result,NULL,NULL);
+				}
+				else
+				{
+					entry->after->dependent = entry;
+					entry->after->node->flags |= FLAG_DEPENDENCY;
+				}
+			}
+		}
+
+		/* place the nodes, the blocks that are depended on are placed by their dependent */
+		for (count=0; count < num_nodes; count++)
+		{
+			entry = &nodes[count];
+
+			if (entry->dependent != NULL)
+			{
+				count = entry->block_end - nodes;
+			}
+			else
+			{
+				place_node(entry,&last_node,timeline);
+			}
+		}
+
+		/* anything not placed is on a loop of dependencies, keep it in the old order */
+		for (count=0; count < num_nodes; count++)
+		{
+			if (nodes[count].state != REORDER_PLACED)
+			{
+				if (nodes[count].dependent != NULL && result != EC_AFTER_NODES_FORM_A_LOOP)
+				{
+					raise_warning(nodes[count].node->line_number,EC_AFTER_NODES_FORM_A_LOOP,NULL,NULL);
+					result = EC_AFTER_NODES_FORM_A_LOOP;
+				}
+
+				nodes[count].after = NULL;
+				place_node(&nodes[count],&last_node,timeline);
+			}
+		}
+
+		last_node->next = NULL;
+		timeline->last_node = last_node;
+
+		symbol_table_release(&names);
+		free(nodes);
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : insert_function
+ * Desc : This function will insert the parts of a function into the current
+ *        timeline after the given node. It will also do the basic checks that
+ *        are required. Note: this call recursively call itself if the code is
+ *        a function.
+ *
+ *        The depth parameter is used to depth check the call list to stop 
+ *        recursive call breaking it.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	insert_function(TIMELINE* timeline, NODE** start, FUNCTION* function, unsigned int depth)
+{
+	NODE*			current_node = *start;
+	NODE*			new_node = *start;
+	MESSAGE*		message = NULL;
+	MESSAGE*		new_message = NULL;
+	MESSAGE*		wait_message = NULL;
+	TIMELINE*		target = NULL;
+	FUNCTION_NODE*	function_node = function->node;
+	unsigned int	result = EC_OK;
+
+	current_node->flags |= FLAG_FUNCTION;
+
+	if (depth > g_max_call_depth)
+	{
+		result = EC_MAX_FUNCTION_DEPTH_REACHED;
+	}
+	else
+	{
+		while (function_node != NULL)
+		{
+			new_node = calloc(1,sizeof(NODE));
+
+			/* add the new node into the node list */
+			new_node->next = current_node->next;
+			new_node->timeline = timeline;
+			current_node->next = new_node;
+			current_node = new_node;
+			new_node->flags = (FLAG_IN_FUNCTION | FLAG_DEPENDENCY);
+			target = function_node->to_timeline;
+
+			if (function_node->to_timeline_name.name_length > 0)
+			{
+				/* now we can fixup the @to timeline */
+				if ((target = find_timeline(timeline->group,function_node->to_timeline_name.name)) == NULL)
+				{
+					target = add_timeline(timeline->group,
+											function_node->to_timeline_name.name,
+											function_node->to_timeline_name.name_length,
+											0,
+											FLAG_GHOST);
+				}
+			}
+
+			if (function_node->call != NULL)
+			{
+				result = insert_function(timeline,&current_node,function_node->call,depth + 1);
+				new_node->function = find_function(function_node->call->name,function_node->call->name_length);
+			}
+
+			/* handle the send */
+			if (function_node->message.name_length > 0)
+			{
+				new_node->sent_message = create_message(new_node,target,&function_node->message);
+				new_node->sent_message->flags = function_node->flags;
+			}
+
+			/* "wait" - this needs to fixed-up after the functions are */
+			if (function_node->sequence.name_length > 0)
+			{
+				memcpy(&new_node->wait_message,&function_node->sequence,sizeof(BLOCK_NAME));
+			}
+
+			/* handle the sequence */
+			if (function_node->after.name_length > 0)
+			{
+				memcpy(&new_node->after,&function_node->after,sizeof(BLOCK_NAME));
+			}
+
+			/* trigger is attached to the node */
+			if (function_node->trigger != NULL)
+			{
+				new_node->trigger = handle_trigger(function_node->trigger,timeline->group);
+			}
+
+			/* trigger is attached to the node */
+			if (function_node->triggers_list != NULL)
+			{
+				add_triggers(&new_node->triggers,function_node->triggers_list,timeline->group);
+			}
+
+			if (function_node->condition.name_length > 0)
+			{
+				if (function_node->condition.name_length > 0)
+				{
+					new_node->condition = malloc(function_node->condition.name_length);
+					memcpy(new_node->condition,function_node->condition.name,function_node->condition.name_length);
+					new_node->condition_length = function_node->condition.name_length;
+				}
+			}
+
+			/* build the new node */
+			new_node->group = timeline->group;
+
+			/* next function node */
+			function_node = function_node->next;
+		}
+
+		/* add the end of function node - must have one as the last node may have received a message */
+		new_node = calloc(1,sizeof(NODE));
+		new_node->flags = FLAG_FUNCTION_END;
+		new_node->timeline = timeline;
+		new_node->return_node = *start;
+		new_node->next = current_node->next;
+		current_node->next = new_node;
+		
+		(*start)->function_end = new_node;
+
+		if (timeline->last_node == *start)
+		{
+			timeline->last_node = new_node;
+		}
+
+		*start = new_node;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : node_reorder
+ * Desc : This function will reorder the nodes. If the node has an after then it
+ *        will search the list of nodes to find out where the after message is
+ *        sent or waited for and place the node there.
+ *--------------------------------------------------------------------------------*/
+static ERROR_CODES	node_reorder(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*			current_node;
+	TIMELINE*		current_timeline;
+	ERROR_CODES		error;
+	unsigned int	result = EC_OK;
+			
+	if (sequence_diagram != NULL)
+	{
+		current_timeline = sequence_diagram->timeline_list;
+		
+		while (current_timeline != NULL)
+		{
+			if ((error = reorder_nodes(current_timeline)) != EC_OK)
+			{
+				result = EC_FAILED;
+			}
+
+			current_timeline = current_timeline->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : function_fixup
+ * Desc : This function will fixup the function references in the tree. It will
+ *        just add the functions and all the atoms that are associated with the
+ *        function into the tree at the current location.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	function_fixup(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*			current_node;
+	TIMELINE*		current_timeline;
+	unsigned int	error;
+	unsigned int	result = EC_OK;
+
+	if (sequence_diagram != NULL)
+	{
+		current_timeline = sequence_diagram->timeline_list;
+		
+		while (current_timeline != NULL)
+		{
+			current_node = current_timeline->node;
+
+			while (current_node != NULL)
+			{
+				if (current_node->function != NULL)
+				{
+					if ((current_node->function->flags & FLAG_GHOST) != 0)
+					{
+						result = EC_UNDEFINED_FUNCTION;
+						raise_warning(0,result,current_node->function->name,NULL);
+					}
+					else
+					{
+						/* ok, now we have a function its contents will have to be inserted here */
+						if ((error = insert_function(current_timeline,&current_node,current_node->function,0)) != EC_OK)
+						{
+							result = error;
+						}
+					}
+				}
+
+				current_node = current_node->next;
+			}
+
+			current_timeline = current_timeline->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : wait_index_list
+ * Desc : This function will find the list of waiting nodes for the message on
+ *        the timeline. A list that was left from an old build of the index is
+ *        emptied. If create is set a missing list is added.
+ *--------------------------------------------------------------------------------*/
+static WAIT_LIST*	wait_index_list(TIMELINE* timeline, unsigned char* name, unsigned int name_length, unsigned int create)
+{
+	WAIT_LIST*	result;
+	WAIT_ENTRY*	next;
+
+	result = symbol_table_find(&g_wait_symbols,timeline,name,name_length);
+
+	if (result != NULL && result->generation != g_wait_generation)
+	{
+		while (result->first != NULL)
+		{
+			next = result->first->next;
+			free(result->first);
+			result->first = next;
+		}
+
+		result->last = NULL;
+		result->generation = g_wait_generation;
+	}
+	else if (result == NULL && create)
+	{
+		if ((result = calloc(1,sizeof(WAIT_LIST))) != NULL)
+		{
+			result->generation = g_wait_generation;
+
+			if (symbol_table_add(&g_wait_symbols,timeline,name,name_length,result) != EC_OK)
+			{
+				free(result);
+				result = NULL;
+			}
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : wait_index_add
+ * Desc : This function will add a waiting node to the index. If after is given
+ *        the node is added after it, else the node is added to the end of the
+ *        list.
+ *--------------------------------------------------------------------------------*/
+static void	wait_index_add(NODE* node, NODE* after)
+{
+	WAIT_LIST*	list;
+	WAIT_ENTRY*	entry;
+	WAIT_ENTRY*	current;
+
+	if (node->wait_message.name_length > 0 && (list = wait_index_list(node->timeline,node->wait_message.name,node->wait_message.name_length,1)) != NULL)
+	{
+		if ((entry = malloc(sizeof(WAIT_ENTRY))) != NULL)
+		{
+			entry->node = node;
+			entry->next = NULL;
+
+			current = list->first;
+
+			while (after != NULL && current != NULL && current->node != after)
+			{
+				current = current->next;
+			}
+
+			if (current == NULL || after == NULL)
+			{
+				if (list->last == NULL)
+				{
+					list->first = entry;
+				}
+				else
+				{
+					list->last->next = entry;
+				}
+
+				list->last = entry;
+			}
+			else
+			{
+				entry->next = current->next;
+				current->next = entry;
+
+				if (list->last == current)
+				{
+					list->last = entry;
+				}
+			}
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : wait_index_build
+ * Desc : This function will build the wait index for the sequence diagram.
+ *--------------------------------------------------------------------------------*/
+static void	wait_index_build(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*		current_node;
+	TIMELINE*	current_timeline = sequence_diagram->timeline_list;
+
+	g_wait_generation++;
+
+	if (g_wait_stale)
+	{
+		g_sequence_stats.rebuilds++;
+	}
+	else
+	{
+		g_sequence_stats.diagrams++;
+	}
+
+	while (current_timeline != NULL)
+	{
+		current_node = current_timeline->node;
+
+		while (current_node != NULL)
+		{
+			if (!g_wait_stale)
+			{
+				g_sequence_stats.expanded++;
+
+				if (current_node->wait_message.name_length > 0)
+				{
+					g_sequence_stats.waits++;
+				}
+			}
+
+			wait_index_add(current_node,NULL);
+
+			current_node = current_node->next;
+		}
+
+		if (!g_wait_stale)
+		{
+			g_sequence_stats.timelines++;
+		}
+
+		current_timeline = current_timeline->next;
+	}
+
+	g_wait_diagram = sequence_diagram;
+	g_wait_stale = 0;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : wait_index_first
+ * Desc : This function will return the first node on the timeline that waits
+ *        for the message, the rest of the nodes follow it on the list.
+ *--------------------------------------------------------------------------------*/
+static WAIT_ENTRY*	wait_index_first(TIMELINE* timeline, MESSAGE* message)
+{
+	WAIT_LIST*	list;
+	WAIT_ENTRY*	result = NULL;
+
+	if (g_wait_stale)
+	{
+		wait_index_build(g_wait_diagram);
+	}
+
+	if ((list = wait_index_list(timeline,message->name,message->name_length,0)) != NULL)
+	{
+		result = list->first;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : count_nodes
+ * Desc : This function will count the nodes on the timelines of the diagram.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	count_nodes(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*			current_node;
+	TIMELINE*		current_timeline = sequence_diagram->timeline_list;
+	unsigned int	result = 0;
+
+	while (current_timeline != NULL)
+	{
+		for (current_node = current_timeline->node; current_node != NULL; current_node = current_node->next)
+		{
+			result++;
+		}
+
+		current_timeline = current_timeline->next;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : sequence_stats
+ * Desc : This function will print the sizes of the sequence diagrams and the
+ *        counters for matching the messages.
+ *--------------------------------------------------------------------------------*/
+static void	sequence_stats(void)
+{
+	printf("%-16s diagrams: %5u timelines: %6u waits: %8u\n",
+			"sequences",
+			g_sequence_stats.diagrams,
+			g_sequence_stats.timelines,
+			g_sequence_stats.waits);
+
+	printf("%-16s read: %8u expanded: %8u linked: %8u\n",
+			"nodes",
+			g_sequence_stats.nodes,
+			g_sequence_stats.expanded,
+			g_sequence_stats.linked);
+
+	printf("%-16s sends: %8u matched: %8u steps: %8u rebuilds: %6u\n",
+			"messages",
+			g_sequence_stats.sends,
+			g_sequence_stats.matched,
+			g_sequence_stats.steps,
+			g_sequence_stats.rebuilds);
+
+	symbol_table_stats(&g_wait_symbols,"waits");
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : copy_node
+ * Desc : This function this will copy a node and add it to the list of nodes
+ *        that have been copied.
+ *--------------------------------------------------------------------------------*/
+static NODE*	copy_node(NODE* node, NODE_LIST* list)
+{
+	NODE*		result;
+	NODE_LIST*	list_end = list;
+	NODE_LIST*	list_entry = list;
+
+	result = malloc(sizeof(NODE));
+	memcpy(result,node,sizeof(NODE));
+	result->next = NULL;
+
+	while (list_entry != NULL)
+	{
+		if (list_entry->timeline == node->timeline)
+		{
+			/* found the list that it belongs to */
+			list_entry->last->next = result;
+			list_entry->last = list_entry->last->next;
+			break;
+		}
+
+		list_end = list_entry;
+		list_entry = list_entry->next;
+	}
+
+	if (list_entry == NULL)
+	{
+		/* ok, did not find the time line so add it to the end */
+		list_end->next = calloc(1,sizeof(NODE_LIST));
+		list_end->next->last = result;
+		list_end->next->timeline = node->timeline;
+		list_end->next->node = result;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : merge_nodes
+ * Desc : This function will merge the copied list of nodes into the sequence
+ *        diagram.
+ *
+ *        This function will also tidy up the function pointers for the copied
+ *        nodes.
+ *--------------------------------------------------------------------------------*/
+static void	merge_nodes(NODE_LIST* list, NODE* insert_node)
+{
+	NODE*		end_node;
+	NODE*		start_node;
+	NODE*		current_node;
+	NODE*		function_start;
+	NODE_LIST*	current_list = list->next;
+
+	while (current_list != NULL)
+	{
+		current_node = current_list->node;
+		start_node = current_node;
+		end_node = current_node;
+
+		while (current_node != NULL)
+		{
+			if (current_node->flags & FLAG_FUNCTION)
+			{
+				function_start = current_node;
+			}
+			else if (current_node->flags & FLAG_FUNCTION_END)
+			{
+				function_start->function_end = current_node;
+				current_node->return_node = function_start;
+			}
+
+			end_node = current_node;
+			current_node = current_node->next;
+		}
+
+		/* add the copied node to the correct timeline */
+		if (insert_node->timeline == current_list->timeline)
+		{
+			/* ok, we have the copied node here */
+			end_node->next = insert_node->next;
+			insert_node->next = start_node;
+		}
+		else
+		{
+			/* add to the end of the relevant timeline */
+			current_list->timeline->last_node->next = start_node;
+			current_list->timeline->last_node = end_node;
+		}
+
+		current_list = current_list->next;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : duplicate_function
+ * Desc : This function will duplicate a node and all off the sub-nodes and the
+ *        messages that the node has. It will add the duplicate nodes to the end 
+ *        of the timelines that they belong in.
+ *--------------------------------------------------------------------------------*/
+static NODE*	duplicate_function(NODE* start_node)
+{
+	NODE* 		result = start_node;
+	NODE* 		copy;
+	NODE* 		prev_node;
+	NODE* 		stop_node = start_node->function_end;
+	NODE* 		active_node = start_node;
+	MESSAGE*	new_message;
+	NODE_LIST	insert_list = {NULL,NULL,NULL,NULL};
+
+	start_node->return_node = NULL;
+	
+	copy = copy_node(active_node,&insert_list);
+	result = copy;
+
+	while (active_node != NULL && stop_node != active_node)
+	{
+		prev_node = copy;
+		active_node = next_active_node(active_node);
+
+		copy = copy_node(active_node,&insert_list);
+
+		if (prev_node->sent_message != NULL)
+		{
+			new_message = malloc(sizeof(MESSAGE));
+			memcpy(new_message,prev_node->sent_message,sizeof(MESSAGE));
+			
+			prev_node->sent_message = new_message;
+			new_message->sender = prev_node;
+
+			if (prev_node->sent_message->receiver != NULL)
+			{
+				new_message->receiver = copy;
+			}
+		}
+	}
+
+	merge_nodes(&insert_list,stop_node);
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : find_wait_node
+ * Desc : This function will find the waiting message that matches the send in
+ *        the given node. It will return the node that it finds.
+ *--------------------------------------------------------------------------------*/
+static NODE*	find_wait_node(MESSAGE* search_message, MESSAGE* sent_message)
+{
+	NODE*			result = NULL;
+	NODE*			temp_node;
+	NODE*			current_node;
+	WAIT_ENTRY*		current_entry;
+
+	current_entry = wait_index_first(search_message->sender->timeline,sent_message);
+
+	while (current_entry != NULL)
+	{
+		current_node = current_entry->node;
+		g_sequence_stats.steps++;
+
+		if (current_node->received_message == NULL)
+		{
+			result = current_node;
+			break;
+		}
+		else if ((search_message->flags & FLAG_BROADCAST) != 0)
+		{
+			if (current_node->flags & FLAG_FUNCTION)
+			{
+				result = duplicate_function(current_node);
+
+				/* the copies are all over the diagram */
+				g_wait_stale = 1;
+			}
+			else if (((current_node->flags & FLAG_IN_FUNCTION) == 0))
+			{
+				/* message to a non-function node */
+				temp_node = malloc(sizeof(NODE));
+				memcpy(temp_node,current_node,sizeof(NODE));
+				temp_node->next = current_node->next;
+				current_node->next = temp_node;
+				wait_index_add(temp_node,current_node);
+				result = temp_node;
+			}
+			else
+			{
+				printf("failed ---- currently not supported - messages to inside a function -- s/b reponses \n");
+			}
+
+			break;
+		}
+
+		current_entry = current_entry->next;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : find_wait
+ * Desc : This function will find the waiting message that matches the send in
+ *        the given node. It will then attach the waiting message to sending 
+ *        message.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	find_wait(TIMELINE* search_timeline, TIMELINE* timeline, NODE** sending_node, unsigned int broadcast)
+{
+	NODE*			temp_node;
+	NODE*			current_node;
+	MESSAGE*		temp_message;
+	MESSAGE*		sent_message = (*sending_node)->sent_message;
+	TIMELINE*		target_timeline = search_timeline;
+	WAIT_ENTRY*		current_entry;
+	unsigned int	result = EC_FAILED;
+
+	if (search_timeline == NULL)
+	{
+		target_timeline = timeline;
+	}
+
+	/* the first node that waits for the message is the one that gets it */
+	if ((current_entry = wait_index_first(target_timeline,sent_message)) != NULL)
+	{
+		current_node = current_entry->node;
+		g_sequence_stats.steps++;
+
+		/* add to the list of received messages */
+		if (current_node->received_message != NULL)
+		{
+			if (sent_message->receiver != NULL)
+			{
+				printf("supported cascade copy required\n");
+			}
+			else
+			{
+				/* copy the node as the message needs to be unique */
+				temp_node = malloc(sizeof(NODE));
+				memcpy(temp_node,current_node,sizeof(NODE));
+
+				/* link them in the chain */
+				temp_node->next = current_node->next;
+				current_node->next = temp_node;
+				wait_index_add(temp_node,current_node);
+				current_node = temp_node;
+
+				current_node->received_message = sent_message;
+				sent_message->target_timeline = target_timeline;
+				sent_message->receiver = current_node;
+			}
+		}
+		else if (sent_message->receiver != NULL)
+		{
+			TIMELINE* sending_timeline = sent_message->sending_timeline;
+
+			/* copy the node as the message needs to be unique */
+			temp_node = malloc(sizeof(NODE));
+			memcpy(temp_node,*sending_node,sizeof(NODE));
+
+			/* copy the message */
+			temp_message = malloc(sizeof(MESSAGE));
+			memcpy(temp_message,sent_message,sizeof(MESSAGE));
+
+			temp_message->sender = temp_node;
+			temp_message->receiver = current_node;
+			temp_message->target_timeline = target_timeline;
+
+			temp_node->sent_message = temp_message;
+
+			/* link them in the chain */
+			(*sending_node)->next = temp_node;
+			wait_index_add(temp_node,*sending_node);
+			*sending_node = temp_node;
+
+			if (*sending_node == sending_timeline->last_node)
+			{
+				sending_timeline->last_node = temp_node;
+			}
+
+			current_node->received_message = temp_message;
+		}
+		else
+		{
+			/* make the connection between the two nodes */
+			sent_message->receiver = current_node;
+			sent_message->target_timeline = target_timeline;
+			current_node->received_message = sent_message;
+		}
+
+		g_sequence_stats.matched++;
+		result = EC_OK;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : connect_responses
+ * Desc : This function will connect the messages that are responses together to
+ *        create the sequence diagram.
+ *
+ *        This also as a side effect (to save a couple of cycles) also sets the
+ *        function end message to the same one as the function start.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	connect_responses(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*			target_node;
+	NODE*			current_node;
+	NODE*			function_node = NULL;
+	MESSAGE*		current_message;
+	TIMELINE*		broadcast;
+	TIMELINE*		search_timeline;
+	TIMELINE*		current_timeline;
+	FUNCTION*		current_function = NULL;
+	DEFFERED_LIST*	temp = NULL;
+	DEFFERED_LIST*	current_deferred = NULL;
+	DEFFERED_LIST*	deferred_message = NULL;
+	unsigned int	error;
+	unsigned int	satisfied;
+	unsigned int	is_broadcast;
+	unsigned int	result = EC_OK;
+
+	/* TODO: replace this function will one based on the walker code. This will solve the 
+	 *       problem of nested functions.
+	 */
+	if (sequence_diagram != NULL)
+	{
+		broadcast = find_timeline(sequence_diagram->group,string_pool_find((unsigned char*)"broadcast",sizeof("broadcast")-1));
+
+		current_timeline = sequence_diagram->timeline_list;
+		
+		while (current_timeline != NULL)
+		{
+			current_node = current_timeline->node;
+
+			while (current_node != NULL)
+			{
+				if ((current_node->flags & FLAG_FUNCTION) != 0)
+				{
+					/* if walking into a function remember then entry as any responses
+					 * within a function go to the sending timeline.
+					 */
+					/* TODO: need to handle nested functions. Will have to set the function_end
+					 *       node to the function that called the function.
+					 */
+					if (function_node != NULL)
+					{
+						printf("function not null ---- NESTED FUNCITON not currently handled \n");
+					}
+					else
+					{
+						function_node = current_node;
+					}
+				}
+				else if ((current_node->flags & FLAG_FUNCTION_END) != 0)
+				{
+					function_node = NULL;
+				}
+				else if (current_node->sent_message != NULL && (current_node->sent_message->flags & FLAG_SEQUENCE_RESPONDS) != 0)
+				{
+					target_node = NULL;
+					g_sequence_stats.sends++;
+
+					if (current_node->received_message != NULL)
+					{
+						target_node = find_wait_node(current_node->received_message,current_node->sent_message);
+					}
+					else if (function_node != NULL && function_node->received_message != NULL)
+					{
+						target_node = find_wait_node(function_node->received_message,current_node->sent_message);
+					}
+
+					if (target_node != NULL)
+					{
+						g_sequence_stats.matched++;
+						target_node->received_message = current_node->sent_message;
+						current_node->sent_message->receiver = target_node;
+						current_node->sent_message->target_timeline = target_node->timeline;
+					}
+					else
+					{
+						/*TODO: handle responses to reponses */
+						printf("deferred: %s ---- NOT CURRENTLY HANDLED \n",current_node->sent_message->name);
+					}
+				}
+
+				current_node = current_node->next;
+			}
+			current_timeline = current_timeline->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : connect_sequence
+ * Desc : This function will connect the messages from the different timelines
+ *        together to create the sequence diagram.
+ *
+ *        SIDE-EFFECT WARNING: this code also flags any broadcast message as a 
+ *        broadcast. Done here to safe some cycles.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	connect_sequence(SEQUENCE_DIAGRAM* sequence_diagram)
+{
+	NODE*			current_node;
+	TIMELINE*		broadcast;
+	TIMELINE*		search_timeline;
+	TIMELINE*		current_timeline;
+	unsigned int	error;
+	unsigned int	result = EC_OK;
+
+	if (sequence_diagram != NULL)
+	{
+		broadcast = find_timeline(sequence_diagram->group,string_pool_find((unsigned char*)"broadcast",sizeof("broadcast")-1));
+
+		if (broadcast != NULL)
+		{
+			broadcast->flags |= FLAG_BROADCAST;
+		}
+
+		current_timeline = sequence_diagram->timeline_list;
+		
+		while (current_timeline != NULL)
+		{
+			current_node = current_timeline->node;
+
+			while (current_node != NULL)
+			{
+				if (current_node->sent_message != NULL)
+				{
+					if (current_node->sent_message->target_timeline == broadcast)
+					{
+						current_node->sent_message->flags |= FLAG_BROADCAST;
+					}
+
+					if ((current_node->sent_message->flags & FLAG_SEQUENCE_RESPONDS) == 0)
+					{
+						g_sequence_stats.sends++;
+
+						if (current_node->sent_message->target_timeline == broadcast)
+						{
+							/* message to broadcast */
+							search_timeline = sequence_diagram->timeline_list;
+						
+							while(search_timeline != NULL)
+							{
+								find_wait(search_timeline,current_timeline,&current_node,1);
+
+								search_timeline = search_timeline->next;
+							}
+						}
+						else if (find_wait(current_node->sent_message->target_timeline,current_timeline,&current_node,0) != EC_OK)
+						{
+							raise_warning(0,EC_SEND_AND_NO_WAIT,current_node->sent_message->name,NULL);
+							result = EC_FAILED;
+						}
+					}
+				}
+
+				current_node = current_node->next;
+			}
+
+			current_timeline = current_timeline->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : check_group
+ * Desc : This function will check that a group is sensible and all the nodes that
+ *        have to be defined are properly defined. It returns the result of the
+ *        last check made in the group, or the result passed in if the group has
+ *        nothing to check.
+ *--------------------------------------------------------------------------------*/
+static unsigned int check_group(GROUP* group, unsigned int result)
+{
+	TRIGGER*			current_trigger = NULL;
+
+	if (group->state_machine != NULL)
+	{
+		result = check_state_machine(group->state_machine);
+	}
+	
+	if (group->sequence_diagram != NULL)
+	{
+		/* handle sequence diagram */
+		if ((result = node_reorder(group->sequence_diagram)) == EC_OK)
+		{
+			if ((result = function_fixup(group->sequence_diagram)) == EC_OK)
+			{
+				wait_index_build(group->sequence_diagram);
+
+				if ((result = connect_sequence(group->sequence_diagram)) == EC_OK)
+				{
+					result = connect_responses(group->sequence_diagram);
+				}
+
+				g_sequence_stats.linked += count_nodes(group->sequence_diagram);
+			}
+		}
+	}
+
+	/* check the triggers are valid */
+	if (group->trigger_list != NULL)
+	{
+		current_trigger = group->trigger_list;
+
+		while (current_trigger != NULL)
+		{
+			if ((current_trigger->flags & FLAG_GHOST) == FLAG_GHOST)
+			{
+				result = EC_UNDEFINED_TRIGGER;
+				raise_warning(0,result,current_trigger->name,NULL);
+			}
+
+			current_trigger = current_trigger->next;
+		}
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : semantic_check
+ * Desc : This function will check that the files input are sensible and all the
+ *        nodes that have to be defined are properly defined. The result is the
+ *        result of the last check that was made.
+ *--------------------------------------------------------------------------------*/
+static unsigned int semantic_check ( void )
+{
+	GROUP*				current = &g_group_tree;
+	unsigned int		result = EC_OK;
+
+	while (current != NULL)
+	{
+		result = check_group(current,result);
+		current = current->next;
+	}
+
+	return result;
+}
+
+
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : open_file
+ * Desc : This function will open the output file and initialise the output
+ *        structure for the file.
+ *--------------------------------------------------------------------------------*/
+static int	open_file(OUTPUT_FILE* file, char* file_name)
+{
+	int result = 0;
+
+	if ((file->outfile = open(file_name,WRITE_FILE_STATUS,WRITE_FILE_PERM)) != -1)
+	{
+		file->buffer = malloc(FILE_BLOCK_SIZE);
+		file->offset = 0;
+		file->written = 0;
+		file->blocked = 0;
+
+		result = 1;
+	}
+
+	return result;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : flush_block
+ * Desc : This function will write the current block to the file if it has any
+ *        records in it. A blocked file is padded to the block size.
+ *--------------------------------------------------------------------------------*/
+static void	flush_block(OUTPUT_FILE* file)
+{
+	if (file->offset > 0)
+	{
+		if (file->blocked)
+		{
+			if (file->offset < FILE_BLOCK_SIZE)
+			{
+				file->buffer[file->offset++] = LINKER_BLOCK_END;
+			}
+
+			file->offset = FILE_BLOCK_SIZE;
+		}
+
+		write(file->outfile,file->buffer,file->offset);
+		file->written += file->offset;
+		file->offset = 0;
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_to_file
+ * Desc : This function will write the specific record to the file. It will handle
+ *        the block structure and padding. If the file is not blocked a record
+ *        that is bigger than the buffer is written straight to the file, in a
+ *        blocked file it is dropped.
+ *--------------------------------------------------------------------------------*/
+static void	write_to_file(OUTPUT_FILE* file)
+{
+	unsigned int count = 0;
+
+	if ((file->record_size + file->offset) > FILE_BLOCK_SIZE)
+	{
+		flush_block(file);
+	}
+
+	if (file->blocked && file->record_size > FILE_BLOCK_SIZE)
+	{
+		/* the record cannot be split across the blocks */
+		raise_warning(0,EC_DATA_TOO_LARGE,NULL,NULL);
+	}
+	else if (!file->blocked && file->record_size > FILE_BLOCK_SIZE)
+	{
+		for (count=0;count < file->parts; count++)
+		{
+			write(file->outfile,file->buffer_list[count].buffer,file->buffer_list[count].size);
+			file->written += file->buffer_list[count].size;
+		}
+	}
+	else
+	{
+		/* Ok, copy the parts to the output */
+		for (count=0;count < file->parts; count++)
+		{
+			if (file->offset >= FILE_BLOCK_SIZE)
+			{
+				raise_warning(0,EC_DATA_TOO_LARGE,NULL,NULL);
+			}
+			else
+			{
+				memcpy(&file->buffer[file->offset],file->buffer_list[count].buffer,file->buffer_list[count].size);
+				file->offset += file->buffer_list[count].size;
+			}
+		}
+	}
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : file_position
+ * Desc : This function returns the offset in the file that the next record will
+ *        be written to. If the record does not fit in the current block it will
+ *        be after the block end marker, which readers will skip.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	file_position(OUTPUT_FILE* file)
+{
+	return file->written + file->offset;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : close_file
+ * Desc : This function will close the output file and flush the last write
+ *        block to the file.
+ *--------------------------------------------------------------------------------*/
+static void	close_file(OUTPUT_FILE* file)
+{
+	flush_block(file);
+	
+	free(file->buffer);
+	file->buffer = NULL;
+
+	close(file->outfile);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_empty_record
+ * Desc : This function writes empty record to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_empty_record(unsigned char type, OUTPUT_FILE* file)
+{
+	unsigned char	buffer[1];
+
+	buffer[0] = type;
+
+	file->parts = 1;
+	file->record_size = 1;
+	file->buffer_list[0].size = 1;
+	file->buffer_list[0].buffer = buffer;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_numerics_record
+ * Desc : This function writes a short and a int to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_numerics_record(unsigned char type, OUTPUT_FILE* file, unsigned short param1, unsigned int param2)
+{
+	unsigned char	buffer[7];
+
+	buffer[0] = type;
+	buffer[1] = (param1 >> 8) & 0xff;
+	buffer[2] = param1 & 0xff;
+	
+	buffer[3] = (param2 & 0xff000000) >> 24;
+	buffer[4] = (param2 & 0x00ff0000) >> 16;
+	buffer[5] = (param2 & 0x0000ff00) >> 8;
+	buffer[6] = (param2 & 0xff);
+
+	file->parts = 1;
+	file->record_size = 7;
+	file->buffer_list[0].size = 7;
+	file->buffer_list[0].buffer = buffer;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_numeric_record
+ * Desc : This function writes a short to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_numeric_record(unsigned char type, OUTPUT_FILE* file, unsigned short param)
+{
+	unsigned char	buffer[3];
+
+	buffer[0] = type;
+	buffer[1] = (param >> 8) & 0xff;
+	buffer[2] = param & 0xff;
+
+	file->parts = 1;
+	file->record_size = 3;
+	file->buffer_list[0].size = 3;
+	file->buffer_list[0].buffer = buffer;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_string_param_record
+ * Desc : This function writes a string record to the file. With a parameter.
+ *--------------------------------------------------------------------------------*/
+static void	write_string_param_record(unsigned char type, OUTPUT_FILE* file,unsigned char* string,unsigned short string_length, unsigned short param)
+{
+	unsigned char	buffer[4];
+
+	buffer[0] = type;
+	buffer[1] = (param >> 8) & 0xff;
+	buffer[2] = param & 0xff;
+	buffer[3] = string_length & 0xff;
+
+	file->parts = 2;
+	file->record_size = 4 + string_length;
+	file->buffer_list[0].size = 4;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = string_length;
+	file->buffer_list[1].buffer = string;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_string_record
+ * Desc : This function writes a string record to the file. The version 2 model
+ *        has the length as a varint so the long strings do not wrap, the
+ *        blocked version 1 model keeps the short length.
+ *--------------------------------------------------------------------------------*/
+static void	write_string_record(unsigned char type, OUTPUT_FILE* file, NAME* string)
+{
+	unsigned int	header_size = 2;
+	unsigned char	buffer[2 + OBJECT_VARINT_MAX_SIZE];
+
+	buffer[0] = type;
+	buffer[1] = string->fixed;
+
+	if (file->blocked)
+	{
+		buffer[header_size++] = (string->name_length >> 8) & 0xff;
+		buffer[header_size++] = string->name_length & 0xff;
+	}
+	else
+	{
+		header_size += object_record_encode_varint(&buffer[header_size],string->name_length);
+	}
+
+	file->parts = 2;
+	file->record_size = header_size + string->name_length;
+	file->buffer_list[0].size = header_size;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = string->name_length;
+	file->buffer_list[1].buffer = string->name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_group_id_record
+ * Desc : This function writes a group record with an id attached..
+ *--------------------------------------------------------------------------------*/
+static void	write_group_id_record(	unsigned char	type, 
+								OUTPUT_FILE*	file, 
+								GROUP*			group, 
+								unsigned char*	string,
+								unsigned short	string_length,
+								unsigned short	id)
+{
+	unsigned char	buffer[5];
+
+	buffer[0] = type;
+	buffer[1] = (id >> 8) & 0xff;
+	buffer[2] = (id & 0xff);
+	buffer[3] = group->name_length & 0xff;
+	buffer[4] = string_length & 0xff;
+
+	file->parts = 4;
+	file->record_size = 4 + group->name_length + 1 + string_length;
+	file->buffer_list[0].size = 4;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = group->name_length;
+	file->buffer_list[1].buffer = group->name;
+	file->buffer_list[2].size = 1;
+	file->buffer_list[2].buffer = &buffer[4];
+	file->buffer_list[3].size = string_length;
+	file->buffer_list[3].buffer = string;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_option_record
+ * Desc : This function writes a group option record.
+ *--------------------------------------------------------------------------------*/
+static void	write_option_record( unsigned char type, OUTPUT_FILE* file, OPTION* option)
+{
+	unsigned char	fixed = 0;
+	unsigned char	buffer[10];
+
+	if (option->name.fixed)
+	{
+		fixed = 0x01;
+	}
+
+	if (option->value.fixed)
+	{
+		fixed |= 0x02;
+	}
+
+	if (option->description.fixed)
+	{
+		fixed |= 0x04;
+	}
+
+	buffer[0] = type;
+	buffer[1] = (option->flags & 0xff00) >> 8;
+	buffer[2] = option->flags & 0x00ff;
+	buffer[3] = fixed;
+	buffer[4] = (option->name.name_length & 0xff00) >> 8;
+	buffer[5] = option->name.name_length & 0xff;
+	buffer[6] = (option->value.name_length & 0xff00) >> 8;
+	buffer[7] = option->value.name_length & 0xff;
+	buffer[8] = (option->description.name_length & 0xff00) >> 8;
+	buffer[9] = option->description.name_length & 0xff;
+
+	file->parts = 4;
+	file->record_size = sizeof(buffer) + option->name.name_length + option->value.name_length + option->description.name_length;
+	file->buffer_list[0].size = sizeof(buffer);
+	file->buffer_list[0].buffer	= buffer;
+	file->buffer_list[1].size	= option->name.name_length;
+	file->buffer_list[1].buffer = option->name.name;
+	file->buffer_list[2].size	= option->value.name_length;
+	file->buffer_list[2].buffer = option->value.name;
+	file->buffer_list[3].size	= option->description.name_length;
+	file->buffer_list[3].buffer = option->description.name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * @name: write_synopsis_record
+ * @desc: This function will write te synopsis record to the output file.
+ *--------------------------------------------------------------------------------*/
+static void	write_synopsis_record(unsigned char type, OUTPUT_FILE* file, NAME* name, unsigned char* synopsis_index, unsigned int index_size)
+{
+	unsigned char	buffer[5];
+
+	buffer[0] = type;
+	buffer[1] = (name->name_length & 0xff00) >> 8;
+	buffer[2] = name->name_length & 0xff;
+	buffer[3] = (index_size & 0xff00) >> 8;
+	buffer[4] = index_size & 0xff;
+
+	file->parts = 3;
+	file->record_size = sizeof(buffer) + name->name_length + index_size;
+	file->buffer_list[0].size = sizeof(buffer);
+	file->buffer_list[0].buffer	= buffer;
+	file->buffer_list[1].size	= name->name_length;
+	file->buffer_list[1].buffer = name->name;
+	file->buffer_list[2].size	= index_size;
+	file->buffer_list[2].buffer = synopsis_index;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_group_record
+ * Desc : This function writes a group record.
+ *--------------------------------------------------------------------------------*/
+static void	write_group_record(unsigned char type, OUTPUT_FILE* file, GROUP* group, unsigned char* string, unsigned short string_length)
+{
+	unsigned char	buffer[3];
+
+	buffer[0] = type;
+	buffer[1] = group->name_length & 0xff;
+	buffer[2] = string_length & 0xff;
+
+	file->parts = 4;
+	file->record_size = 2 + group->name_length + 1 + string_length;
+	file->buffer_list[0].size = 2;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = group->name_length;
+	file->buffer_list[1].buffer = group->name;
+	file->buffer_list[2].size = 1;
+	file->buffer_list[2].buffer = &buffer[2];
+	file->buffer_list[3].size = string_length;
+	file->buffer_list[3].buffer = string;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_message_record
+ * Desc : This function writes a message record.
+ *--------------------------------------------------------------------------------*/
+static void	write_message_record(	unsigned char	type,
+								OUTPUT_FILE*	file,
+								NODE*			current_node,
+								NODE*			other_node,
+								TIMELINE*		other_timeline,
+								unsigned char*	message_name,
+								unsigned int	message_length)
+{
+	unsigned char	buffer[5];
+	unsigned short	other_id = 0;
+	unsigned short	current_id = 0;
+	unsigned short	timeline_length = sizeof("unknown")-1;
+	unsigned char*	timeline_name = (unsigned char*) "Unknown";
+
+	if (current_node != NULL)
+	{
+		current_id = current_node->level;
+	}
+
+	if (other_node != NULL)
+	{
+		other_id = other_node->level;
+	}
+
+	if (other_timeline != NULL)
+	{
+		timeline_name = other_timeline->name;
+		timeline_length = other_timeline->name_length;
+	}
+
+	buffer[0] = type;
+	buffer[1] = current_id & 0xff;
+	buffer[2] = other_id & 0xff;
+
+	buffer[3] = timeline_length & 0xff;
+	
+	buffer[4] = message_length & 0xff;
+
+	file->parts = 4;
+	file->record_size = 4 + timeline_length + 1 + message_length;
+	file->buffer_list[0].size = 4;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = timeline_length;
+	file->buffer_list[1].buffer = timeline_name;
+	file->buffer_list[2].size = 1;
+	file->buffer_list[2].buffer = &buffer[4];
+	file->buffer_list[3].size = message_length;
+	file->buffer_list[3].buffer = message_name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_type_record
+ * Desc : This function writes a api type record to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_type_record(unsigned char type, OUTPUT_FILE* file, NAME* type_type, NAME* name, NAME* brief)
+{
+	unsigned char	buffer[6];
+
+	buffer[0] = type;
+	buffer[1] = brief->fixed;
+	buffer[2] = type_type->name_length & 0xff;
+	buffer[3] = name->name_length & 0xff;
+	buffer[4] = (brief->name_length & 0xff00) >> 8;
+	buffer[5] = brief->name_length & 0xff;
+
+	file->parts = 4;
+	file->record_size = 6 + type_type->name_length + name->name_length + brief->name_length;
+	file->buffer_list[0].size = 6;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = 	type_type->name_length;
+	file->buffer_list[1].buffer =	type_type->name;
+	file->buffer_list[2].size = 	name->name_length;
+	file->buffer_list[2].buffer =	name->name;
+	file->buffer_list[3].size =		brief->name_length;
+	file->buffer_list[3].buffer =	brief->name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_constant_record
+ * Desc : This function writes a api constant record to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_constant_record(unsigned char type, OUTPUT_FILE* file, NAME* type_type, NAME* name, NAME* value, NAME* brief)
+{
+	unsigned char	buffer[8];
+
+	buffer[0] = type;
+	buffer[1] = brief->fixed;
+	buffer[2] = type_type->name_length & 0xff;
+	buffer[3] = name->name_length & 0xff;
+	buffer[4] = (value->name_length & 0xff00) >> 8;
+	buffer[5] = value->name_length & 0xff;
+	buffer[6] = (brief->name_length & 0xff00) >> 8;
+	buffer[7] = brief->name_length & 0xff;
+
+	file->parts = 5;
+	file->record_size = 8 + type_type->name_length + name->name_length + brief->name_length + value->name_length;
+	file->buffer_list[0].size = 8;
+	file->buffer_list[0].buffer	= buffer;
+	file->buffer_list[1].size	= type_type->name_length;
+	file->buffer_list[1].buffer = type_type->name;
+	file->buffer_list[2].size	= name->name_length;
+	file->buffer_list[2].buffer = name->name;
+	file->buffer_list[3].size	= value->name_length;
+	file->buffer_list[3].buffer = value->name;
+	file->buffer_list[4].size	= brief->name_length;
+	file->buffer_list[4].buffer = brief->name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : write_pair_record
+ * Desc : This function writes a api pair record to the file.
+ *--------------------------------------------------------------------------------*/
+static void	write_pair_record(unsigned char type, OUTPUT_FILE* file, NAME* value, NAME* string)
+{
+	unsigned char	buffer[5];
+
+	buffer[0] = type;
+	buffer[1] = string->fixed;
+	buffer[2] = value->name_length & 0xff;
+	buffer[3] = (string->name_length & 0xff00) >> 8;
+	buffer[4] = string->name_length & 0xff;
+
+	file->parts = 3;
+	file->record_size = 5 + value->name_length + string->name_length;
+	file->buffer_list[0].size = 5;
+	file->buffer_list[0].buffer = buffer;
+	file->buffer_list[1].size = 	value->name_length;
+	file->buffer_list[1].buffer =	value->name;
+	file->buffer_list[2].size = 	string->name_length;
+	file->buffer_list[2].buffer =	string->name;
+
+	write_to_file(file);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : output_api
+ * Desc : This function will output the api to the open file.
+ *--------------------------------------------------------------------------------*/
+static void	output_api(OUTPUT_FILE* outfile, API* api)
+{
+	NAME				empty = {NULL,0,0,0};
+	NAME				group_name;
+	API_TYPE*			current_type;
+	API_RETURNS*		current_returns;
+	API_FUNCTION*		current_function;
+	API_CONSTANT*		current_constant;
+	API_CONSTANTS*		current_constants;
+	API_PARAMETER*		current_parameter;
+	API_TYPE_RECORD*	current_type_record;
+
+	/* let the file know that we are starting a new api */
+	group_name.name			= api->group->name;
+	group_name.fixed 		= 0;
+	group_name.name_length	= api->group->name_length;
+	write_string_record(LINKER_API_START,outfile,&group_name);
+	
+	/* write all the functions to the file */
+	current_function = api->function_list;
+
+	while(current_function != NULL)
+	{
+		write_type_record(LINKER_API_FUNCTION,outfile,&current_function->return_type,&current_function->name,&empty);
+		write_string_record(LINKER_API_DESCRIPTION,outfile,&current_function->description);
+		write_string_record(LINKER_API_ACTION,outfile,&current_function->action);
+			
+		/* dump parameter */
+		current_parameter = current_function->parameter_list;
+
+		while(current_parameter != NULL)
+		{
+			write_type_record(LINKER_API_PARAMETER,outfile,&current_parameter->type,&current_parameter->name,&current_parameter->brief);
+
+			current_parameter = current_parameter->next;
+		}
+
+		/* dump returns */
+		current_returns = current_function->returns_list;
+
+		while(current_returns != NULL)
+		{
+			write_pair_record(LINKER_API_RETURNS,outfile,&current_returns->value,&current_returns->brief);
+
+			current_returns = current_returns->next;
+		}
+		
+		write_empty_record(LINKER_API_FUNCTION_END,outfile);
+
+		current_function = current_function->next;
+	}
+
+	/* now output the types for the API */
+	current_type = api->type_list;
+
+	while (current_type != NULL)
+	{
+		write_pair_record(LINKER_API_TYPE_START,outfile,&current_type->name,&current_type->description);
+		
+		current_type_record = current_type->record_list;
+
+		while (current_type_record != NULL)
+		{
+			write_type_record(	LINKER_API_TYPE_FIELD,
+								outfile,
+								&current_type_record->type_item,
+								&current_type_record->name_value,
+								&current_type_record->brief);
+
+			current_type_record = current_type_record->next;
+		}
+
+		write_empty_record(LINKER_API_TYPE_END,outfile);
+
+		current_type = current_type->next;
+	}
+
+	/* now output the constantss for the API */
+	current_constants = api->constants_list;
+
+	while (current_constants != NULL)
+	{
+		write_pair_record(LINKER_API_CONSTANTS_START,outfile,&current_constants->name,&current_constants->description);
+		
+		current_constant = current_constants->constant_list;
+
+		while (current_constant != NULL)
+		{
+			write_constant_record(	LINKER_API_CONSTANT,
+									outfile,
+									&current_constant->type,
+									&current_constant->name,
+									&current_constant->value,
+									&current_constant->brief);
+
+			current_constant = current_constant->next;
+		}
+
+		write_empty_record(LINKER_API_CONSTANTS_END,outfile);
+
+		current_constants = current_constants->next;
+	}
+
+	/* Ok, we have finished outputting the API */
+	write_empty_record(LINKER_API_END,outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : find_wait
- * Desc : This function will find the waiting message that matches the send in
- *        the given node. It will then attach the waiting message to sending 
- *        message.
+ * Name : output_state_machine
+ * Desc : This function will output the state machine to the open file.
  *--------------------------------------------------------------------------------*/
-static unsigned int	find_wait(TIMELINE* search_timeline, TIMELINE* timeline, NODE** sending_node, unsigned int broadcast)
+static void	output_state_machine(OUTPUT_FILE* outfile,STATE_MACHINE* state_machine)
 {
-	NODE*			temp_node;
-	NODE*			current_node;
-	MESSAGE*		new_message;
-	MESSAGE*		temp_message;
-	MESSAGE*		sent_message = (*sending_node)->sent_message;
-	TIMELINE*		target_timeline = search_timeline;
-	unsigned int	result = EC_FAILED;
-
-	if (search_timeline == NULL)
+	unsigned int		node_id = 0;
+	NAME				temp_name;
+	STATE*				current_state = state_machine->state_list;
+	TRIGGERS* 			current_triggers;
+	STATE_TRANSITION*	current_trans;
+	
+	/* enumerate all the states first first */
+	while (current_state != NULL)
 	{
-		target_timeline = timeline;
+		current_state->tag_id = node_id++;
+
+		current_state = current_state->next;
 	}
 
-	current_node = target_timeline->node;
+	current_state = state_machine->state_list;
+	
+	temp_name.name			= state_machine->group->name;
+	temp_name.fixed 		= 0;
+	temp_name.name_length	= state_machine->group->name_length;
+
+	write_string_record(LINKER_STATE_MACHINE_START,outfile,&temp_name);
 
-	while (current_node != NULL)
+	while (current_state != NULL)
 	{
-		if (current_node->wait_message.name_length > 0 && 
-			sent_message->name_length == current_node->wait_message.name_length &&
-			memcmp(sent_message->name,current_node->wait_message.name,sent_message->name_length) == 0)
+		current_trans = current_state->transition_list;
+
+		if (current_state->name_length > 0)
 		{
-			/* add to the list of received messages */
-			if (current_node->received_message != NULL)
+			write_group_id_record(LINKER_STATE,outfile,current_state->group,current_state->name,current_state->name_length,current_state->tag_id);
+
+			while(current_trans != NULL)
 			{
-				if (sent_message->receiver != NULL)
+				write_numeric_record(LINKER_TRANSITON,outfile,current_trans->next_state->tag_id);
+
+				if (current_trans->trigger != NULL)
 				{
-					printf("supported cascade copy required\n");
+					write_group_record(	LINKER_TRIGGER,
+										outfile,
+										current_trans->trigger->group,
+										current_trans->trigger->name,
+										current_trans->trigger->name_length);
 				}
-				else
+				else if (current_trans->condition != NULL)
 				{
-					/* copy the node as the message needs to be unique */
-					temp_node = malloc(sizeof(NODE));
-					memcpy(temp_node,current_node,sizeof(NODE));
-
-					/* link them in the chain */
-					temp_node->next = current_node->next;
-					current_node->next = temp_node;
-					current_node = temp_node;
-
-					current_node->received_message = sent_message;
-					sent_message->target_timeline = target_timeline;
-					sent_message->receiver = current_node;
+					temp_name.name			= current_trans->condition;
+					temp_name.name_length	= current_trans->condition_length;
+					write_string_record(LINKER_CONDITION,outfile,&temp_name);
 				}
-				result = EC_OK;
-				break;
-			}
-			else if (current_node->received_message == NULL)
-			{
-				if (sent_message->receiver != NULL)
-				{
-					TIMELINE* sending_timeline = sent_message->sending_timeline;
-
-					/* copy the node as the message needs to be unique */
-					temp_node = malloc(sizeof(NODE));
-					memcpy(temp_node,*sending_node,sizeof(NODE));
-
-					/* copy the message */
-					temp_message = malloc(sizeof(MESSAGE));
-					memcpy(temp_message,sent_message,sizeof(MESSAGE));
-
-					temp_message->sender = temp_node;
-					temp_message->receiver = current_node;
-					temp_message->target_timeline = target_timeline;
 
-					temp_node->sent_message = temp_message;
-
-					/* link them in the chain */
-					(*sending_node)->next = temp_node;
-					*sending_node = temp_node;
+				if (current_trans->triggers != NULL)
+				{
+					current_triggers = current_trans->triggers;
 
-					if (*sending_node == sending_timeline->last_node)
+					do
 					{
-						sending_timeline->last_node = temp_node;
-					}
+						write_group_record(	LINKER_TRIGGERS,
+											outfile,
+											current_triggers->trigger->group,
+											current_triggers->trigger->name,
+											current_triggers->trigger->name_length);
 
-					current_node->received_message = temp_message;
-				}
-				else
-				{
-					/* make the connection between the two nodes */
-					sent_message->receiver = current_node;
-					sent_message->target_timeline = target_timeline;
-					current_node->received_message = sent_message;
+						current_triggers = current_triggers->next;
+					} 
+					while (current_triggers != NULL);
 				}
 
-				result = EC_OK;
-				break;
+				current_trans = current_trans->next;
 			}
-		}
 
-		current_node = current_node->next;
+			/* end the state */
+			write_empty_record(LINKER_END,outfile);
+		}
+		current_state = current_state->next;
 	}
 
-	return result;
+	write_empty_record(LINKER_STATE_MACHINE_END,outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : connect_responses
- * Desc : This function will connect the messages that are responses together to
- *        create the sequence diagram.
- *
- *        This also as a side effect (to save a couple of cycles) also sets the
- *        function end message to the same one as the function start.
+ * Name : output_sequence_diagram
+ * Desc : This function will output the sequence diagram.
  *--------------------------------------------------------------------------------*/
-static unsigned int	connect_responses(SEQUENCE_DIAGRAM* sequence_diagram)
+static void	output_sequence_diagram(OUTPUT_FILE* outfile, SEQUENCE_DIAGRAM* sequence_diagram)
 {
-	NODE*			target_node;
-	NODE*			current_node;
-	NODE*			function_node = NULL;
-	MESSAGE*		current_message;
-	TIMELINE*		broadcast;
-	TIMELINE*		search_timeline;
-	TIMELINE*		current_timeline;
-	FUNCTION*		current_function = NULL;
-	DEFFERED_LIST*	temp = NULL;
-	DEFFERED_LIST*	current_deferred = NULL;
-	DEFFERED_LIST*	deferred_message = NULL;
-	unsigned int	error;
-	unsigned int	satisfied;
-	unsigned int	is_broadcast;
-	unsigned int	result = EC_OK;
+	NAME		group_name;
+	NODE*		current_node;
+	MESSAGE*	current_message;
+	TIMELINE*	current_timeline;
+	unsigned int	node_id = 1;
+	unsigned int 	result = EC_OK;
 
-	/* TODO: replace this function will one based on the walker code. This will solve the 
-	 *       problem of nested functions.
-	 */
-	if (sequence_diagram != NULL)
+	current_timeline = sequence_diagram->timeline_list;
+	
+	group_name.name			= sequence_diagram->group->name;
+	group_name.fixed 		= 0;
+	group_name.name_length	= sequence_diagram->group->name_length;
+	write_string_record(LINKER_SEQUENCE_START,outfile,&group_name);
+
+	/* enumerate all the nodes first */
+	while (current_timeline != NULL)
 	{
-		broadcast = find_timeline(sequence_diagram->group,(unsigned char*)"broadcast",sizeof("broadcast")-1);
+		current_node = current_timeline->node;
 
-		current_timeline = sequence_diagram->timeline_list;
-		
-		while (current_timeline != NULL)
+		while (current_node != NULL)
+		{
+			current_node->level = node_id++;
+			current_node = current_node->next;
+		}
+
+		current_timeline = current_timeline->next;
+	}
+
+	/* now dump the nodes */
+	current_timeline = sequence_diagram->timeline_list;
+
+	while (current_timeline != NULL)
+	{
+		if ((current_timeline->flags & FLAG_BROADCAST) != FLAG_BROADCAST)
 		{
 			current_node = current_timeline->node;
 
+			write_group_record(LINKER_TIMELINE,outfile,current_timeline->group,current_timeline->name,current_timeline->name_length);
+
 			while (current_node != NULL)
 			{
-				if ((current_node->flags & FLAG_FUNCTION) != 0)
+				/* start the node */
+				write_numerics_record(LINKER_NODE_START,outfile,current_node->level,current_node->flags);
+
+				/* check the messages that have been sent from the current node */
+				current_message = current_node->sent_message;
+
+				if (current_message != NULL)
 				{
-					/* if walking into a function remember then entry as any responses
-					 * within a function go to the sending timeline.
-					 */
-					/* TODO: need to handle nested functions. Will have to set the function_end
-					 *       node to the function that called the function.
-					 */
-					if (function_node != NULL)
-					{
-						printf("function not null ---- NESTED FUNCITON not currently handled \n");
-					}
-					else
-					{
-						function_node = current_node;
-					}
+					write_message_record(	LINKER_SENT_MESSAGE,
+											outfile,
+											current_node,
+											current_message->receiver,
+											current_message->target_timeline,
+											current_message->name,
+											current_message->name_length);
 				}
-				else if ((current_node->flags & FLAG_FUNCTION_END) != 0)
+
+				if (current_node->received_message == NULL && current_node->wait_message.name_length > 0)
 				{
-					function_node = NULL;
+					/* TODO: not sure if this is required to be output */
+					printf("found a recives and waits -- need to fix w: %s (%p %p)\n",current_node->wait_message.name,(void*)current_node,(void*)current_node->sent_message);
 				}
-				else if (current_node->sent_message != NULL && (current_node->sent_message->flags & FLAG_SEQUENCE_RESPONDS) != 0)
-				{
-					target_node = NULL;
-
-					if (current_node->received_message != NULL)
-					{
-						target_node = find_wait_node(current_node->received_message,current_node->sent_message);
-					}
-					else if (function_node != NULL && function_node->received_message != NULL)
-					{
-						target_node = find_wait_node(function_node->received_message,current_node->sent_message);
-					}
 
-					if (target_node != NULL)
-					{
-						target_node->received_message = current_node->sent_message;
-						current_node->sent_message->receiver = target_node;
-						current_node->sent_message->target_timeline = target_node->timeline;
-					}
-					else
-					{
-						/*TODO: handle responses to reponses */
-						printf("deferred: %s ---- NOT CURRENTLY HANDLED \n",current_node->sent_message->name);
-					}
-				}
+				write_empty_record(LINKER_NODE_END,outfile);
 
 				current_node = current_node->next;
 			}
-			current_timeline = current_timeline->next;
 		}
+
+		current_timeline = current_timeline->next;
 	}
 
-	return result;
+	write_empty_record(LINKER_SEQUENCE_END,outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : connect_sequence
- * Desc : This function will connect the messages from the different timelines
- *        together to create the sequence diagram.
- *
- *        SIDE-EFFECT WARNING: this code also flags any broadcast message as a 
- *        broadcast. Done here to safe some cycles.
+ * Name : output_samples
+ * Desc : This function will output all the samples collected to the output
+ *        file.
  *--------------------------------------------------------------------------------*/
-static unsigned int	connect_sequence(SEQUENCE_DIAGRAM* sequence_diagram)
+static void	output_samples(OUTPUT_FILE* outfile, SAMPLE* list)
 {
-	NODE*			current_node;
-	TIMELINE*		broadcast;
-	TIMELINE*		search_timeline;
-	TIMELINE*		current_timeline;
-	unsigned int	error;
-	unsigned int	result = EC_OK;
+	SAMPLE*	current_sample = list;
+
+	while (current_sample != NULL)
+	{
+		write_pair_record(LINKER_SAMPLE,outfile,&current_sample->name,&current_sample->sample);
+		current_sample = current_sample->next;
+	}
+}
+
+#if (MAX_NUM_OPTIONS > 255)
+#error Need to fix the following code to allow for greater the 255 - also will need to fix the processor
+#endif
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * @name: output_synopsis
+ * @desc: This function will output the synopsis. As part of this it will try
+ *        and validate the options specified in the synopsis list. it will list
+ *        the synopsis in the numeric order that they appear in the applications
+ *        list.
+ *--------------------------------------------------------------------------------*/
+static void	output_synopsis(OUTPUT_FILE* outfile, SYNOPSIS_LIST* synopsys, OPTION* option_list)
+{
+	unsigned int	end;
+	unsigned int	start;
+	unsigned int	item;
+	unsigned int	index = 0;
+	unsigned int	position = 0;
+	unsigned int	name_length;
+	unsigned char	synopsis_index[MAX_NUM_OPTIONS];
+	OPTION*			option;
 
-	if (sequence_diagram != NULL)
+	while(position < synopsys->items.name_length && index < MAX_NUM_OPTIONS)
 	{
-		broadcast = find_timeline(sequence_diagram->group,(unsigned char*)"broadcast",sizeof("broadcast")-1);
+		start = position;
 
-		if (broadcast != NULL)
+		/* remove white space */
+		while ((start < synopsys->items.name_length) && (synopsys->items.name[start] < 0x0f || synopsys->items.name[start] == 0x20))
 		{
-			broadcast->flags |= FLAG_BROADCAST;
+			start++;
 		}
 
-		current_timeline = sequence_diagram->timeline_list;
-		
-		while (current_timeline != NULL)
+		/* find the string */
+		while (synopsys->items.name[position] != ',' && (position < synopsys->items.name_length))
 		{
-			current_node = current_timeline->node;
+			position++;
+		}
 
-			while (current_node != NULL)
-			{
-				if (current_node->sent_message != NULL)
-				{
-					if (current_node->sent_message->target_timeline == broadcast)
-					{
-						current_node->sent_message->flags |= FLAG_BROADCAST;
-					}
+		/* trim non-valid chars */
+		end = position;
+		while ((end-1 > start) && (synopsys->items.name[end-1] < 0x0f || synopsys->items.name[end-1] == 0x20))
+		{
+			end--;
+		}
 
-					if ((current_node->sent_message->flags & FLAG_SEQUENCE_RESPONDS) == 0)
-					{
-						if (current_node->sent_message->target_timeline == broadcast)
-						{
-							/* message to broadcast */
-							search_timeline = sequence_diagram->timeline_list;
-						
-							while(search_timeline != NULL)
-							{
-								find_wait(search_timeline,current_timeline,&current_node,1);
+		/* now find the option in the option list */
+		option = option_list;
 
-								search_timeline = search_timeline->next;
-							}
-						}
-						else if (find_wait(current_node->sent_message->target_timeline,current_timeline,&current_node,0) != EC_OK)
-						{
-							raise_warning(0,EC_SEND_AND_NO_WAIT,current_node->sent_message->name,NULL);
-							result = EC_FAILED;
-						}
-					}
-				}
+		name_length = end - start;
 
-				current_node = current_node->next;
+		while (option != NULL)
+		{
+			if (name_length == option->name.name_length && memcmp(&synopsys->items.name[start],option->name.name,name_length) == 0)
+			{
+				/* Ok, found it */
+				synopsis_index[index++] = option->option_id;
+				break;
 			}
 
-			current_timeline = current_timeline->next;
+			option = option->next;
+		}
+
+		if (option == NULL)
+		{
+			unsigned char	hold = synopsys->items.name[end];
+
+			synopsys->items.name[end] = '\0';
+			raise_warning(0,EC_OPTION_REQUIRED_BY_SYNOPSIS_MISSING,&synopsys->items.name[start],NULL);
+			synopsys->items.name[end] = hold;
 		}
+
+		position++;
 	}
 
-	return result;
+	/* output the synopsis to the file */
+	write_synopsis_record(LINKER_APPLICATION_SYNOPSIS,outfile,&synopsys->name,synopsis_index,index);
+
+	if (index == MAX_NUM_OPTIONS)
+	{
+		raise_warning(0,EC_MAX_NUMBER_OF_OPTIONS_IN_SYNOPSIS,NULL,NULL);
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : semantic_check
- * Desc : This function will check that the files input are sensible and all the
- *        nodes that have to be defined are properly defined.
+ * Name : output_applications
+ * Desc : This function will output all the applications collected to the output
+ *        file.
  *--------------------------------------------------------------------------------*/
-static unsigned int semantic_check ( void )
+static void	output_applications(OUTPUT_FILE* outfile, APPLICATION* list)
 {
-	GROUP*				current = &g_group_tree;
-	TRIGGER*			current_trigger = NULL;
-	unsigned int		result = EC_OK;
+	OPTION*			option;
+	SECTION*		section;
+	COMMAND*		command;
+	SECTION*		sub_section;
+	APPLICATION*	application = list;
+	SYNOPSIS_LIST*	synopsis;
 
-	while (current != NULL)
+	while (application != NULL)
 	{
-		if (current->state_machine != NULL)
-		{
-			result = check_state_machine(current->state_machine);
-		}
-		
-		if (current->sequence_diagram != NULL)
+		if (application->name.name_length > 0)
 		{
-			/* handle sequence diagram */
-			if ((result = node_reorder(current->sequence_diagram)) == EC_OK)
+			write_string_record(LINKER_APPLICATION_START,outfile,&application->name);
+	
+			/* now output the options */
+			option = application->option_list;
+
+			while (option != NULL)
 			{
-				if ((result = function_fixup(current->sequence_diagram)) == EC_OK)
-				{
-					if ((result = connect_sequence(current->sequence_diagram)) == EC_OK)
-					{
-						result = connect_responses(current->sequence_diagram);
-					
-					}
-				}
+				write_option_record(LINKER_APPLICATION_OPTION,outfile,option);
+
+				option = option->next;
 			}
-		}
 
-		/* check the triggers are valid */
-		if (current->trigger_list != NULL)
-		{
-			current_trigger = current->trigger_list;
+			/* now write the synposis */
+			synopsis = &application->synopsis_list;
 
-			while (current_trigger != NULL)
+			while (synopsis != NULL)
 			{
-				if ((current_trigger->flags & FLAG_GHOST) == FLAG_GHOST)
+				if (synopsis->name.name_length > 0)
 				{
-					result = EC_UNDEFINED_TRIGGER;
-					raise_warning(0,result,current_trigger->name,NULL);
+					/* we have a synopsis and now need to process the list */
+					output_synopsis(outfile,synopsis,application->option_list);
 				}
 
-				current_trigger = current_trigger->next;
+				synopsis = synopsis->next;
 			}
-		}
 
-		current = current->next;
-	}
+			/* now output the commands */
+			command = application->command_list;
 
-	return result;
-}
+			while (command != NULL)
+			{
+				write_type_record(LINKER_APPLICATION_COMMAND,outfile,&command->name,&command->parameters,&command->description);
 
+				command = command->next;
+			}
 
+			/* now write the sections */
+			section = application->section_list;
+			
+			while (section != NULL)
+			{
+				/* now write the sections to the file */
+				write_pair_record(LINKER_APPLICATION_SECTION,outfile,&section->name,&section->section_data);
+				
+				sub_section = section->sub_section_list;
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * Name : open_file
- * Desc : This function will open the output file and initialise the output
- *        structure for the file.
- *--------------------------------------------------------------------------------*/
-static int	open_file(OUTPUT_FILE* file, char* file_name)
-{
-	int result = 0;
+				while (sub_section != NULL)
+				{
+					write_pair_record(LINKER_APPLICATION_SUB_SECTION,outfile,&sub_section->name,&sub_section->section_data);
+				
+					sub_section = sub_section->next;
+				}
 
-	if ((file->outfile = open(file_name,WRITE_FILE_STATUS,WRITE_FILE_PERM)) != -1)
-	{
-		file->buffer = malloc(FILE_BLOCK_SIZE);
-		file->offset = 0;
+				section = section->next;
+			}
 
-		result = 1;
+			write_empty_record(LINKER_APPLICATION_END,outfile);
+		
+		}
+		application = application->next;
 	}
-
-	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_to_file
- * Desc : This function will write the specific record to the file. It will handle
- *        the block structure and padding.
+ * Name : write_long
+ * Desc : This function writes a four byte number to the buffer.
  *--------------------------------------------------------------------------------*/
-static void	write_to_file(OUTPUT_FILE* file)
+static void	write_long(unsigned char* buffer, unsigned int value)
 {
-	unsigned int count = 0;
+	buffer[0] = (value & 0xff000000) >> 24;
+	buffer[1] = (value & 0x00ff0000) >> 16;
+	buffer[2] = (value & 0x0000ff00) >> 8;
+	buffer[3] = (value & 0xff);
+}
 
-	if ((file->record_size + file->offset) > FILE_BLOCK_SIZE)
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : output_group
+ * Desc : This function will output the records that belong to the group.
+ *--------------------------------------------------------------------------------*/
+static void	output_group(OUTPUT_FILE* outfile, GROUP* group)
+{
+	if (group->state_machine != NULL)
 	{
-		if (file->offset < FILE_BLOCK_SIZE)
-		{
-			file->buffer[file->offset++] = LINKER_BLOCK_END;
-		}
-
-		write(file->outfile,file->buffer,FILE_BLOCK_SIZE);
-		file->offset = 0;
+		output_state_machine(outfile,group->state_machine);
 	}
 
-	/* Ok, copy the parts to the output */
-	for (count=0;count < file->parts; count++)
+	if (group->sequence_diagram != NULL)
 	{
-		if (file->offset >= FILE_BLOCK_SIZE)
-		{
-			raise_warning(0,EC_DATA_TOO_LARGE,NULL,NULL);
-		}
-		else
-		{
-			memcpy(&file->buffer[file->offset],file->buffer_list[count].buffer,file->buffer_list[count].size);
-			file->offset += file->buffer_list[count].size;
-		}
+		output_sequence_diagram(outfile,group->sequence_diagram);
 	}
-}
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * Name : close_file
- * Desc : This function will close the output file and flush the last write
- *        block to the file.
- *--------------------------------------------------------------------------------*/
-static void	close_file(OUTPUT_FILE* file)
-{
-	if (file->offset > 0)
+	if (group->api != NULL)
 	{
-		file->buffer[file->offset++] = LINKER_BLOCK_END;
-		write(file->outfile,file->buffer,FILE_BLOCK_SIZE);
+		output_api(outfile,group->api);
 	}
-	
-	free(file->buffer);
-	file->buffer = NULL;
-
-	close(file->outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_empty_record
- * Desc : This function writes empty record to the file.
+ * Name : output_version_1
+ * Desc : This function will output the model in the blocked version 1 format.
  *--------------------------------------------------------------------------------*/
-static void	write_empty_record(unsigned char type, OUTPUT_FILE* file)
+static void	output_version_1(OUTPUT_FILE* outfile, unsigned char* file_header)
 {
-	unsigned char	buffer[1];
+	GROUP*			current = &g_group_tree;
 
-	buffer[0] = type;
+	write_long(&file_header[LINKER_NUMBER_RECORDS_OFF],0);
+	file_header[LINKER_NAME_START_OFF  ] = 0;
+	file_header[LINKER_NAME_START_OFF+1] = 0;
 
-	file->parts = 1;
-	file->record_size = 1;
-	file->buffer_list[0].size = 1;
-	file->buffer_list[0].buffer = buffer;
+	write(outfile->outfile,file_header,LINKER_HEADER_SIZE);
 
-	write_to_file(file);
-}
+	outfile->written = LINKER_HEADER_SIZE;
+	outfile->blocked = 1;
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_numerics_record
- * Desc : This function writes a short and a int to the file.
- *--------------------------------------------------------------------------------*/
-static void	write_numerics_record(unsigned char type, OUTPUT_FILE* file, unsigned short param1, unsigned int param2)
-{
-	unsigned char	buffer[7];
+	/* first dump all the samples */
+	output_samples(outfile,g_sample_list.next);
 
-	buffer[0] = type;
-	buffer[1] = (param1 >> 8) & 0xff;
-	buffer[2] = param1 & 0xff;
-	
-	buffer[3] = (param2 & 0xff000000) >> 24;
-	buffer[4] = (param2 & 0x00ff0000) >> 16;
-	buffer[5] = (param2 & 0x0000ff00) >> 8;
-	buffer[6] = (param2 & 0xff);
+	/* second dump the applications to the file */
+	output_applications(outfile,g_application_list.next);
 
-	file->parts = 1;
-	file->record_size = 7;
-	file->buffer_list[0].size = 7;
-	file->buffer_list[0].buffer = buffer;
+	/* ok, we have an open file */
+	while (current != NULL)
+	{
+		output_group(outfile,current);
+		current = current->next;
+	}
 
-	write_to_file(file);
+	flush_block(outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_numeric_record
- * Desc : This function writes a short to the file.
+ * Name : set_toc_entry
+ * Desc : This function fills in an entry in the table of contents.
  *--------------------------------------------------------------------------------*/
-static void	write_numeric_record(unsigned char type, OUTPUT_FILE* file, unsigned short param)
+static void	set_toc_entry(unsigned char* entry, unsigned char type, unsigned int start, unsigned int end, unsigned int name_offset, unsigned char name_length)
 {
-	unsigned char	buffer[3];
-
-	buffer[0] = type;
-	buffer[1] = (param >> 8) & 0xff;
-	buffer[2] = param & 0xff;
+	entry[LINKER_TOC_TYPE] = type;
+	entry[LINKER_TOC_NAME_LENGTH] = name_length;
+	entry[LINKER_TOC_NAME_LENGTH+1] = 0;
+	entry[LINKER_TOC_NAME_LENGTH+2] = 0;
+
+	write_long(&entry[LINKER_TOC_OFFSET],start);
+	write_long(&entry[LINKER_TOC_LENGTH],end - start);
+	write_long(&entry[LINKER_TOC_NAME_OFFSET],name_offset);
+}
 
-	file->parts = 1;
-	file->record_size = 3;
-	file->buffer_list[0].size = 3;
-	file->buffer_list[0].buffer = buffer;
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : copy_section
+ * Desc : This function copies a section of the previous model to the output.
+ *        The sections are not blocked so they can be copied as they are.
+ *--------------------------------------------------------------------------------*/
+static void	copy_section(OUTPUT_FILE* outfile, unsigned char* data, unsigned int size)
+{
+	flush_block(outfile);
 
-	write_to_file(file);
+	write(outfile->outfile,data,size);
+	outfile->written += size;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_string_param_record
- * Desc : This function writes a string record to the file. With a parameter.
+ * Name : output_link_state
+ * Desc : This function writes the link state section. The objects that were not
+ *        merged keep the touches from the link state that they were kept from.
  *--------------------------------------------------------------------------------*/
-static void	write_string_param_record(unsigned char type, OUTPUT_FILE* file,unsigned char* string,unsigned short string_length, unsigned short param)
+static void	output_link_state(OUTPUT_FILE* outfile, LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links)
 {
-	unsigned char	buffer[4];
+	unsigned int		count;
+	unsigned int		touch;
+	unsigned int		num_objects = 0;
+	unsigned int		num_touches;
+	unsigned int		name_length;
+	unsigned char		buffer[16];
+	LINK_TOUCH*			touches;
+	LINK_OBJECT*		object;
+
+	for (count=0; count < num_links; count++)
+	{
+		num_objects += link_list[count]->loaded;
+	}
 
-	buffer[0] = type;
-	buffer[1] = (param >> 8) & 0xff;
-	buffer[2] = param & 0xff;
-	buffer[3] = string_length & 0xff;
+	write_long(buffer,num_objects);
 
-	file->parts = 2;
-	file->record_size = 4 + string_length;
-	file->buffer_list[0].size = 4;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = string_length;
-	file->buffer_list[1].buffer = string;
+	outfile->parts = 1;
+	outfile->record_size = 4;
+	outfile->buffer_list[0].size = 4;
+	outfile->buffer_list[0].buffer = buffer;
+	write_to_file(outfile);
 
-	write_to_file(file);
+	for (count=0; count < num_links; count++)
+	{
+		object = link_list[count];
+
+		if (object->loaded)
+		{
+			touches = object->touches;
+			num_touches = object->num_touches;
+
+			if (state->incremental && !object->merge)
+			{
+				touches = link_state_object(object)->touches;
+				num_touches = link_state_object(object)->num_touches;
+			}
+
+			name_length = strlen(object->filename);
+
+			if (name_length > 0xffff)
+			{
+				name_length = 0xffff;
+			}
+
+			buffer[0] = (name_length & 0xff00) >> 8;
+			buffer[1] = (name_length & 0x00ff);
+			write_long(&buffer[2],object->size);
+			write_long(&buffer[6],object->fingerprint);
+			write_long(&buffer[10],num_touches);
+
+			outfile->parts = 3;
+			outfile->record_size = 14 + name_length;
+			outfile->buffer_list[0].size = 2;
+			outfile->buffer_list[0].buffer = buffer;
+			outfile->buffer_list[1].size = name_length;
+			outfile->buffer_list[1].buffer = (unsigned char*) object->filename;
+			outfile->buffer_list[2].size = 12;
+			outfile->buffer_list[2].buffer = &buffer[2];
+			write_to_file(outfile);
+
+			for (touch=0; touch < num_touches; touch++)
+			{
+				buffer[0] = touches[touch].type;
+				buffer[1] = (touches[touch].name_length & 0xff00) >> 8;
+				buffer[2] = (touches[touch].name_length & 0x00ff);
+
+				outfile->parts = 2;
+				outfile->record_size = 3 + touches[touch].name_length;
+				outfile->buffer_list[0].size = 3;
+				outfile->buffer_list[0].buffer = buffer;
+				outfile->buffer_list[1].size = touches[touch].name_length;
+				outfile->buffer_list[1].buffer = touches[touch].name;
+				write_to_file(outfile);
+			}
+		}
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_string_record
- * Desc : This function writes a string record to the file.
+ * Name : model_put
+ * Desc : This function adds bytes to the payload of the link model record that
+ *        is being built.
  *--------------------------------------------------------------------------------*/
-static void	write_string_record(unsigned char type, OUTPUT_FILE* file, NAME* string)
+static void	model_put(LINK_MODEL_WRITER* writer, unsigned char* data, unsigned int size)
 {
-	unsigned char	buffer[4];
-
-	buffer[0] = type;
-	buffer[1] = string->fixed;
-	buffer[2] = (string->name_length >> 8) & 0xff;
-	buffer[3] = string->name_length & 0xff;
+	unsigned char*	new_data;
 
-	file->parts = 2;
-	file->record_size = 4 + string->name_length;
-	file->buffer_list[0].size = 4;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = string->name_length;
-	file->buffer_list[1].buffer = string->name;
+	if (writer->size + size > writer->max_size)
+	{
+		if ((new_data = realloc(writer->data,writer->size + size + 1024)) == NULL)
+		{
+			writer->failed = 1;
+			size = 0;
+		}
+		else
+		{
+			writer->data = new_data;
+			writer->max_size = writer->size + size + 1024;
+		}
+	}
 
-	write_to_file(file);
+	if (size > 0)
+	{
+		memcpy(&writer->data[writer->size],data,size);
+		writer->size += size;
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_group_id_record
- * Desc : This function writes a group record with an id attached..
+ * Name : model_put_varint
+ * Desc : This function adds a number to the payload.
  *--------------------------------------------------------------------------------*/
-static void	write_group_id_record(	unsigned char	type, 
-								OUTPUT_FILE*	file, 
-								GROUP*			group, 
-								unsigned char*	string,
-								unsigned short	string_length,
-								unsigned short	id)
+static void	model_put_varint(LINK_MODEL_WRITER* writer, unsigned int value)
 {
-	unsigned char	buffer[5];
+	unsigned char	buffer[OBJECT_VARINT_MAX_SIZE];
 
-	buffer[0] = type;
-	buffer[1] = (id >> 8) & 0xff;
-	buffer[2] = (id & 0xff);
-	buffer[3] = group->name_length & 0xff;
-	buffer[4] = string_length & 0xff;
+	model_put(writer,buffer,object_record_encode_varint(buffer,value));
+}
 
-	file->parts = 4;
-	file->record_size = 4 + group->name_length + 1 + string_length;
-	file->buffer_list[0].size = 4;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = group->name_length;
-	file->buffer_list[1].buffer = group->name;
-	file->buffer_list[2].size = 1;
-	file->buffer_list[2].buffer = &buffer[4];
-	file->buffer_list[3].size = string_length;
-	file->buffer_list[3].buffer = string;
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_put_string
+ * Desc : This function adds a string to the payload.
+ *--------------------------------------------------------------------------------*/
+static void	model_put_string(LINK_MODEL_WRITER* writer, unsigned char* string, unsigned int length)
+{
+	model_put_varint(writer,length);
+	model_put(writer,string,length);
+}
 
-	write_to_file(file);
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_put_name
+ * Desc : This function adds a name to the payload.
+ *--------------------------------------------------------------------------------*/
+static void	model_put_name(LINK_MODEL_WRITER* writer, NAME* name)
+{
+	unsigned char	fixed = name->fixed;
+
+	model_put(writer,&fixed,1);
+	model_put_string(writer,name->name,name->name_length);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_option_record
- * Desc : This function writes a group option record.
+ * Name : model_put_group
+ * Desc : This function adds a reference to a group to the payload.
  *--------------------------------------------------------------------------------*/
-static void	write_option_record( unsigned char type, OUTPUT_FILE* file, OPTION* option)
+static void	model_put_group(LINK_MODEL_WRITER* writer, GROUP* group)
 {
-	unsigned char	fixed = 0;
-	unsigned char	buffer[10];
+	unsigned int	reference = 0;
 
-	if (option->name.fixed)
+	if (group != NULL)
 	{
-		fixed = 0x01;
+		reference = (unsigned int)(size_t) symbol_table_find(&writer->groups,NULL,group->name,group->name_length);
 	}
 
-	if (option->value.fixed)
+	model_put_varint(writer,reference);
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : model_put_block_name
+ * Desc : This function adds a block name to the payload, NULL is no name.
+ *--------------------------------------------------------------------------------*/
+static void	model_put_block_name(LINK_MODEL_WRITER* writer, BLOCK_NAME* name)
+{
+	if (name == NULL || name->name_length == 0)
 	{
-		fixed |= 0x02;
+		model_put_varint(writer,0);
+		model_put_varint(writer,0);
 	}
-
-	if (option->description.fixed)
+	else
 	{
-		fixed |= 0x04;
+		model_put_group(writer,name->owner.group);
+		model_put_string(writer,name->name,name->name_length);
 	}
-
-	buffer[0] = type;
-	buffer[1] = (option->flags & 0xff00) >> 8;
-	buffer[2] = option->flags & 0x00ff;
-	buffer[3] = fixed;
-	buffer[4] = (option->name.name_length & 0xff00) >> 8;
-	buffer[5] = option->name.name_length & 0xff;
-	buffer[6] = (option->value.name_length & 0xff00) >> 8;
-	buffer[7] = option->value.name_length & 0xff;
-	buffer[8] = (option->description.name_length & 0xff00) >> 8;
-	buffer[9] = option->description.name_length & 0xff;
-
-	file->parts = 4;
-	file->record_size = sizeof(buffer) + option->name.name_length + option->value.name_length + option->description.name_length;
-	file->buffer_list[0].size = sizeof(buffer);
-	file->buffer_list[0].buffer	= buffer;
-	file->buffer_list[1].size	= option->name.name_length;
-	file->buffer_list[1].buffer = option->name.name;
-	file->buffer_list[2].size	= option->value.name_length;
-	file->buffer_list[2].buffer = option->value.name;
-	file->buffer_list[3].size	= option->description.name_length;
-	file->buffer_list[3].buffer = option->description.name;
-
-	write_to_file(file);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * @name: write_synopsis_record
- * @desc: This function will write te synopsis record to the output file.
+ * Name : model_put_trigger
+ * Desc : This function adds a reference to a trigger to the payload.
  *--------------------------------------------------------------------------------*/
-static void	write_synopsis_record(unsigned char type, OUTPUT_FILE* file, NAME* name, unsigned char* synopsis_index, unsigned int index_size)
+static void	model_put_trigger(LINK_MODEL_WRITER* writer, TRIGGER* trigger)
 {
-	unsigned char	buffer[5];
-
-	buffer[0] = type;
-	buffer[1] = (name->name_length & 0xff00) >> 8;
-	buffer[2] = name->name_length & 0xff;
-	buffer[3] = (index_size & 0xff00) >> 8;
-	buffer[4] = index_size & 0xff;
-
-	file->parts = 3;
-	file->record_size = sizeof(buffer) + name->name_length + index_size;
-	file->buffer_list[0].size = sizeof(buffer);
-	file->buffer_list[0].buffer	= buffer;
-	file->buffer_list[1].size	= name->name_length;
-	file->buffer_list[1].buffer = name->name;
-	file->buffer_list[2].size	= index_size;
-	file->buffer_list[2].buffer = synopsis_index;
-
-	write_to_file(file);
+	if (trigger == NULL)
+	{
+		model_put_block_name(writer,NULL);
+	}
+	else
+	{
+		model_put_group(writer,trigger->group);
+		model_put_string(writer,trigger->name,trigger->name_length);
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_group_record
- * Desc : This function writes a group record.
+ * Name : model_put_triggers
+ * Desc : This function adds a list of trigger references to the payload.
  *--------------------------------------------------------------------------------*/
-static void	write_group_record(unsigned char type, OUTPUT_FILE* file, GROUP* group, unsigned char* string, unsigned short string_length)
+static void	model_put_triggers(LINK_MODEL_WRITER* writer, TRIGGERS* triggers)
 {
-	unsigned char	buffer[3];
+	unsigned int	num_triggers = 0;
+	TRIGGERS*		current = triggers;
 
-	buffer[0] = type;
-	buffer[1] = group->name_length & 0xff;
-	buffer[2] = string_length & 0xff;
+	while (current != NULL)
+	{
+		num_triggers++;
+		current = current->next;
+	}
 
-	file->parts = 4;
-	file->record_size = 2 + group->name_length + 1 + string_length;
-	file->buffer_list[0].size = 2;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = group->name_length;
-	file->buffer_list[1].buffer = group->name;
-	file->buffer_list[2].size = 1;
-	file->buffer_list[2].buffer = &buffer[2];
-	file->buffer_list[3].size = string_length;
-	file->buffer_list[3].buffer = string;
+	model_put_varint(writer,num_triggers);
 
-	write_to_file(file);
+	for (current = triggers; current != NULL; current = current->next)
+	{
+		model_put_trigger(writer,current->trigger);
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_message_record
- * Desc : This function writes a message record.
+ * Name : model_write
+ * Desc : This function writes the record that has been built and starts the
+ *        next one.
  *--------------------------------------------------------------------------------*/
-static void	write_message_record(	unsigned char	type,
-								OUTPUT_FILE*	file,
-								NODE*			current_node,
-								NODE*			other_node,
-								TIMELINE*		other_timeline,
-								unsigned char*	message_name,
-								unsigned int	message_length)
+static void	model_write(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer, unsigned char type, unsigned int group, unsigned int block, unsigned int line)
 {
-	unsigned char	buffer[5];
-	unsigned short	other_id = 0;
-	unsigned short	current_id = 0;
-	unsigned short	timeline_length = sizeof("unknown")-1;
-	unsigned char*	timeline_name = (unsigned char*) "Unknown";
+	OBJECT_RECORD	record;
+	unsigned int	header_size;
+	unsigned char	header[OBJECT_RECORD_MAX_HEADER];
 
-	if (current_node != NULL)
+	if (!writer->failed)
 	{
-		current_id = current_node->level;
+		memset(&record,0,sizeof(OBJECT_RECORD));
+		record.type = type;
+		record.group = group;
+		record.block_number = block;
+		record.line_number = line;
+		record.data_size = writer->size;
+
+		header_size = object_record_encode(header,&record);
+
+		outfile->parts = 2;
+		outfile->record_size = header_size + writer->size;
+		outfile->buffer_list[0].size = header_size;
+		outfile->buffer_list[0].buffer = header;
+		outfile->buffer_list[1].size = writer->size;
+		outfile->buffer_list[1].buffer = writer->data;
+		write_to_file(outfile);
 	}
 
-	if (other_node != NULL)
+	writer->size = 0;
+}
+
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : output_link_api
+ * Desc : This function writes the api of a group. The briefs that did not find
+ *        their parameter are written before their function, so that they are
+ *        looked for in the parameters that were in the model before it.
+ *--------------------------------------------------------------------------------*/
+static void	output_link_api(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer, API* api, unsigned int index)
+{
+	unsigned int		count;
+	LINK_BRIEF*			brief;
+	API_TYPE*			api_type;
+	API_TYPE_RECORD*	type_record;
+	API_RETURNS*		returns;
+	API_FUNCTION*		function;
+	API_PARAMETER*		parameter;
+	API_CONSTANT*		constant;
+	API_CONSTANTS*		constants;
+
+	for (function = api->function_list; function != NULL; function = function->next)
 	{
-		other_id = other_node->level;
+		for (brief = g_link_briefs; brief != NULL; brief = brief->next)
+		{
+			if (brief->function == function)
+			{
+				model_put_string(writer,function->name.name,function->name.name_length);
+				model_put_name(writer,&brief->name);
+				model_put_name(writer,&brief->brief);
+				model_write(outfile,writer,LINK_MODEL_API_BRIEF,index,0,0);
+			}
+		}
+
+		model_put_name(writer,&function->name);
+		model_put_name(writer,&function->return_type);
+		model_put_name(writer,&function->action);
+		model_put_name(writer,&function->description);
+
+		for (count=0, parameter = function->parameter_list; parameter != NULL; parameter = parameter->next)
+		{
+			count++;
+		}
+
+		model_put_varint(writer,count);
+
+		for (parameter = function->parameter_list; parameter != NULL; parameter = parameter->next)
+		{
+			model_put_name(writer,&parameter->name);
+			model_put_name(writer,&parameter->type);
+			model_put_name(writer,&parameter->brief);
+		}
+
+		for (count=0, returns = function->returns_list; returns != NULL; returns = returns->next)
+		{
+			count++;
+		}
+
+		model_put_varint(writer,count);
+
+		for (returns = function->returns_list; returns != NULL; returns = returns->next)
+		{
+			model_put_name(writer,&returns->value);
+			model_put_name(writer,&returns->brief);
+		}
+
+		model_write(outfile,writer,LINK_MODEL_API_FUNCTION,index,0,0);
 	}
 
-	if (other_timeline != NULL)
+	for (api_type = api->type_list; api_type != NULL; api_type = api_type->next)
 	{
-		timeline_name = other_timeline->name;
-		timeline_length = other_timeline->name_length;
+		model_put_name(writer,&api_type->name);
+		model_put_name(writer,&api_type->description);
+		model_put_varint(writer,api_type->depth);
+
+		for (count=0, type_record = api_type->record_list; type_record != NULL; type_record = type_record->next)
+		{
+			count++;
+		}
+
+		model_put_varint(writer,count);
+
+		for (type_record = api_type->record_list; type_record != NULL; type_record = type_record->next)
+		{
+			model_put_varint(writer,type_record->record_type);
+			model_put_name(writer,&type_record->type_item);
+			model_put_name(writer,&type_record->name_value);
+			model_put_name(writer,&type_record->brief);
+		}
+
+		model_write(outfile,writer,LINK_MODEL_API_TYPE,index,0,0);
 	}
 
-	buffer[0] = type;
-	buffer[1] = current_id & 0xff;
-	buffer[2] = other_id & 0xff;
+	for (constants = api->constants_list; constants != NULL; constants = constants->next)
+	{
+		model_put_name(writer,&constants->name);
+		model_put_name(writer,&constants->description);
 
-	buffer[3] = timeline_length & 0xff;
-	
-	buffer[4] = message_length & 0xff;
+		for (count=0, constant = constants->constant_list; constant != NULL; constant = constant->next)
+		{
+			count++;
+		}
 
-	file->parts = 4;
-	file->record_size = 4 + timeline_length + 1 + message_length;
-	file->buffer_list[0].size = 4;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = timeline_length;
-	file->buffer_list[1].buffer = timeline_name;
-	file->buffer_list[2].size = 1;
-	file->buffer_list[2].buffer = &buffer[4];
-	file->buffer_list[3].size = message_length;
-	file->buffer_list[3].buffer = message_name;
+		model_put_varint(writer,count);
 
-	write_to_file(file);
+		for (constant = constants->constant_list; constant != NULL; constant = constant->next)
+		{
+			model_put_varint(writer,constant->constant);
+			model_put_name(writer,&constant->name);
+			model_put_name(writer,&constant->type);
+			model_put_name(writer,&constant->brief);
+			model_put_name(writer,&constant->value);
+		}
+
+		model_write(outfile,writer,LINK_MODEL_API_CONSTANTS,index,0,0);
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_type_record
- * Desc : This function writes a api type record to the file.
+ * Name : output_link_nodes
+ * Desc : This function writes the transitions and the sequence diagram nodes of
+ *        a group.
  *--------------------------------------------------------------------------------*/
-static void	write_type_record(unsigned char type, OUTPUT_FILE* file, NAME* type_type, NAME* name, NAME* brief)
+static void	output_link_nodes(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer, GROUP* group, unsigned int index)
 {
-	unsigned char	buffer[6];
+	NODE*				node;
+	STATE*				state;
+	TIMELINE*			timeline;
+	STATE_TRANSITION*	transition;
 
-	buffer[0] = type;
-	buffer[1] = brief->fixed;
-	buffer[2] = type_type->name_length & 0xff;
-	buffer[3] = name->name_length & 0xff;
-	buffer[4] = (brief->name_length & 0xff00) >> 8;
-	buffer[5] = brief->name_length & 0xff;
+	if (group->state_machine != NULL)
+	{
+		for (state = group->state_machine->state_list; state != NULL; state = state->next)
+		{
+			for (transition = state->transition_list; transition != NULL; transition = transition->next)
+			{
+				model_put_string(writer,state->name,state->name_length);
+				model_put_string(writer,transition->next_state->name,transition->next_state->name_length);
 
-	file->parts = 4;
-	file->record_size = 6 + type_type->name_length + name->name_length + brief->name_length;
-	file->buffer_list[0].size = 6;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = 	type_type->name_length;
-	file->buffer_list[1].buffer =	type_type->name;
-	file->buffer_list[2].size = 	name->name_length;
-	file->buffer_list[2].buffer =	name->name;
-	file->buffer_list[3].size =		brief->name_length;
-	file->buffer_list[3].buffer =	brief->name;
+				model_put_string(writer,transition->condition,transition->condition_length);
+				model_put_trigger(writer,transition->trigger);
+				model_put_triggers(writer,transition->triggers);
+				model_write(outfile,writer,LINK_MODEL_TRANSITION,index,0,0);
+			}
+		}
+	}
 
-	write_to_file(file);
-}
+	if (group->sequence_diagram != NULL)
+	{
+		for (timeline = group->sequence_diagram->timeline_list; timeline != NULL; timeline = timeline->next)
+		{
+			for (node = timeline->node; node != NULL; node = node->next)
+			{
+				model_put_string(writer,timeline->name,timeline->name_length);
+				model_put_group(writer,node->group);
+				model_put_trigger(writer,node->trigger);
+				model_put_triggers(writer,node->triggers);
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_constant_record
- * Desc : This function writes a api constant record to the file.
- *--------------------------------------------------------------------------------*/
-static void	write_constant_record(unsigned char type, OUTPUT_FILE* file, NAME* type_type, NAME* name, NAME* value, NAME* brief)
-{
-	unsigned char	buffer[8];
+				if (node->function == NULL)
+				{
+					model_put_string(writer,NULL,0);
+				}
+				else
+				{
+					model_put_string(writer,node->function->name,node->function->name_length);
+				}
 
-	buffer[0] = type;
-	buffer[1] = brief->fixed;
-	buffer[2] = type_type->name_length & 0xff;
-	buffer[3] = name->name_length & 0xff;
-	buffer[4] = (value->name_length & 0xff00) >> 8;
-	buffer[5] = value->name_length & 0xff;
-	buffer[6] = (brief->name_length & 0xff00) >> 8;
-	buffer[7] = brief->name_length & 0xff;
+				if (node->sent_message == NULL)
+				{
+					model_put_string(writer,NULL,0);
+					model_put_block_name(writer,NULL);
+				}
+				else
+				{
+					model_put_string(writer,node->sent_message->name,node->sent_message->name_length);
 
-	file->parts = 5;
-	file->record_size = 8 + type_type->name_length + name->name_length + brief->name_length + value->name_length;
-	file->buffer_list[0].size = 8;
-	file->buffer_list[0].buffer	= buffer;
-	file->buffer_list[1].size	= type_type->name_length;
-	file->buffer_list[1].buffer = type_type->name;
-	file->buffer_list[2].size	= name->name_length;
-	file->buffer_list[2].buffer = name->name;
-	file->buffer_list[3].size	= value->name_length;
-	file->buffer_list[3].buffer = value->name;
-	file->buffer_list[4].size	= brief->name_length;
-	file->buffer_list[4].buffer = brief->name;
+					if (node->sent_message->target_timeline == NULL)
+					{
+						model_put_block_name(writer,NULL);
+					}
+					else
+					{
+						model_put_group(writer,node->sent_message->target_timeline->group);
+						model_put_string(writer,node->sent_message->target_timeline->name,node->sent_message->target_timeline->name_length);
+					}
+				}
 
-	write_to_file(file);
+				model_put_block_name(writer,&node->wait_message);
+				model_put_block_name(writer,&node->after);
+				model_write(outfile,writer,LINK_MODEL_NODE,index,node->flags,node->line_number);
+			}
+		}
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : write_pair_record
- * Desc : This function writes a api pair record to the file.
+ * Name : output_link_application
+ * Desc : This function writes the options, sections and synopsis of an
+ *        application.
  *--------------------------------------------------------------------------------*/
-static void	write_pair_record(unsigned char type, OUTPUT_FILE* file, NAME* value, NAME* string)
+static void	output_link_application(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer, APPLICATION* application, unsigned int index)
 {
-	unsigned char	buffer[5];
+	OPTION*			option;
+	SECTION*		section;
+	SYNOPSIS_LIST*	synopsis;
 
-	buffer[0] = type;
-	buffer[1] = string->fixed;
-	buffer[2] = value->name_length & 0xff;
-	buffer[3] = (string->name_length & 0xff00) >> 8;
-	buffer[4] = string->name_length & 0xff;
+	for (option = application->option_list; option != NULL; option = option->next)
+	{
+		model_put_name(writer,&option->name);
+		model_put_name(writer,&option->value);
+		model_put_name(writer,&option->description);
+		model_write(outfile,writer,LINK_MODEL_OPTION,index,option->flags,0);
+	}
 
-	file->parts = 3;
-	file->record_size = 5 + value->name_length + string->name_length;
-	file->buffer_list[0].size = 5;
-	file->buffer_list[0].buffer = buffer;
-	file->buffer_list[1].size = 	value->name_length;
-	file->buffer_list[1].buffer =	value->name;
-	file->buffer_list[2].size = 	string->name_length;
-	file->buffer_list[2].buffer =	string->name;
+	for (section = application->section_list; section != NULL; section = section->next)
+	{
+		model_put_name(writer,&section->name);
+		model_put_name(writer,&section->section_data);
+		model_write(outfile,writer,LINK_MODEL_SECTION,index,0,0);
+	}
 
-	write_to_file(file);
+	/* the first synopsis is held in the application */
+	synopsis = &application->synopsis_list;
+
+	if (synopsis->name.name_length == 0)
+	{
+		synopsis = synopsis->next;
+	}
+
+	while (synopsis != NULL)
+	{
+		model_put_name(writer,&synopsis->name);
+		model_put_name(writer,&synopsis->items);
+		model_write(outfile,writer,LINK_MODEL_SYNOPSIS,index,0,0);
+
+		if (synopsis == &application->synopsis_list)
+		{
+			synopsis = application->synopsis_list.next;
+		}
+		else
+		{
+			synopsis = synopsis->next;
+		}
+	}
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : output_api
- * Desc : This function will output the api to the open file.
+ * Name : output_link_model
+ * Desc : This function writes the link model section. All the groups, functions
+ *        and applications are declared and then all the things that are in the
+ *        model are declared, before the records that refer to them. The samples
+ *        are written last, in the order that they were added.
  *--------------------------------------------------------------------------------*/
-static void	output_api(OUTPUT_FILE* outfile, API* api)
+static void	output_link_model(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer)
 {
-	NAME				empty = {NULL,0,0,0};
-	NAME				group_name;
-	API_TYPE*			current_type;
-	API_RETURNS*		current_returns;
-	API_FUNCTION*		current_function;
-	API_CONSTANT*		current_constant;
-	API_CONSTANTS*		current_constants;
-	API_PARAMETER*		current_parameter;
-	API_TYPE_RECORD*	current_type_record;
-
-	/* let the file know that we are starting a new api */
-	group_name.name			= api->group->name;
-	group_name.fixed 		= 0;
-	group_name.name_length	= api->group->name_length;
-	write_string_record(LINKER_API_START,outfile,&group_name);
-	
-	/* write all the functions to the file */
-	current_function = api->function_list;
+	unsigned int	index;
+	unsigned int	count;
+	unsigned int	num_samples = 0;
+	unsigned char	size[4];
+	GROUP*			group;
+	STATE*			state;
+	SAMPLE*			sample;
+	SAMPLE**		samples;
+	TRIGGER*		trigger;
+	TIMELINE*		timeline;
+	FUNCTION*		function;
+	FUNCTION_NODE*	function_node;
+	BLOCK_NAME*		block_name;
+	APPLICATION*	application;
 
-	while(current_function != NULL)
+	/* the groups, the document is the first group and is not declared */
+	for (group = &g_group_tree, index = 0; group != NULL; group = group->next, index++)
 	{
-		write_type_record(LINKER_API_FUNCTION,outfile,&current_function->return_type,&current_function->name,&empty);
-		write_string_record(LINKER_API_DESCRIPTION,outfile,&current_function->description);
-		write_string_record(LINKER_API_ACTION,outfile,&current_function->action);
-			
-		/* dump parameter */
-		current_parameter = current_function->parameter_list;
+		if (symbol_table_add(&writer->groups,NULL,group->name,group->name_length,(void*)(size_t)(index + 1)) != EC_OK)
+		{
+			writer->failed = 1;
+		}
 
-		while(current_parameter != NULL)
+		if (index > 0)
 		{
-			write_type_record(LINKER_API_PARAMETER,outfile,&current_parameter->type,&current_parameter->name,&current_parameter->brief);
+			model_put(writer,group->name,group->name_length);
+			model_write(outfile,writer,INTERMEDIATE_RECORD_GROUP,0,0,0);
+		}
 
-			current_parameter = current_parameter->next;
+		if (index == 1 && g_all_group_used)
+		{
+			model_put(writer,(unsigned char*)"all",sizeof("all")-1);
+			model_write(outfile,writer,INTERMEDIATE_RECORD_GROUP,0,0,0);
 		}
+	}
 
-		/* dump returns */
-		current_returns = current_function->returns_list;
+	for (function = g_function_list.next; function != NULL; function = function->next)
+	{
+		model_put(writer,function->name,function->name_length);
+		model_write(outfile,writer,INTERMEDIATE_RECORD_FUNCTION,0,function->flags,0);
+	}
 
-		while(current_returns != NULL)
+	for (application = g_application_list.next; application != NULL; application = application->next)
+	{
+		model_put(writer,application->name.name,application->name.name_length);
+		model_write(outfile,writer,INTERMEDIATE_RECORD_APPLICATION,0,0,0);
+	}
+
+	/* the things in the groups */
+	for (group = &g_group_tree, index = 0; group != NULL; group = group->next, index++)
+	{
+		for (trigger = group->trigger_list; trigger != NULL; trigger = trigger->next)
 		{
-			write_pair_record(LINKER_API_RETURNS,outfile,&current_returns->value,&current_returns->brief);
+			model_put_string(writer,trigger->name,trigger->name_length);
+			model_write(outfile,writer,LINK_MODEL_TRIGGER,index,trigger->flags,0);
+		}
 
-			current_returns = current_returns->next;
+		if (group->state_machine != NULL)
+		{
+			for (state = group->state_machine->state_list; state != NULL; state = state->next)
+			{
+				model_put_string(writer,state->name,state->name_length);
+				model_write(outfile,writer,LINK_MODEL_STATE,index,state->flags,state->line_number);
+			}
 		}
-		
-		write_empty_record(LINKER_API_FUNCTION_END,outfile);
 
-		current_function = current_function->next;
-	}
+		if (group->sequence_diagram != NULL)
+		{
+			for (timeline = group->sequence_diagram->timeline_list; timeline != NULL; timeline = timeline->next)
+			{
+				model_put_string(writer,timeline->name,timeline->name_length);
+				model_write(outfile,writer,LINK_MODEL_TIMELINE,index,timeline->flags,timeline->line_number);
+			}
+		}
 
-	/* now output the types for the API */
-	current_type = api->type_list;
+		if (group->api != NULL)
+		{
+			output_link_api(outfile,writer,group->api,index);
+		}
+	}
 
-	while (current_type != NULL)
+	for (group = &g_group_tree, index = 0; group != NULL; group = group->next, index++)
 	{
-		write_pair_record(LINKER_API_TYPE_START,outfile,&current_type->name,&current_type->description);
-		
-		current_type_record = current_type->record_list;
+		output_link_nodes(outfile,writer,group,index);
+	}
 
-		while (current_type_record != NULL)
+	for (function = &g_function_list, index = 0; function != NULL; function = function->next, index++)
+	{
+		for (function_node = function->node; function_node != NULL; function_node = function_node->next)
 		{
-			write_type_record(	LINKER_API_TYPE_FIELD,
-								outfile,
-								&current_type_record->type_item,
-								&current_type_record->name_value,
-								&current_type_record->brief);
+			if (function_node->call == NULL)
+			{
+				model_put_string(writer,NULL,0);
+			}
+			else
+			{
+				model_put_string(writer,function_node->call->name,function_node->call->name_length);
+			}
 
-			current_type_record = current_type_record->next;
-		}
+			model_put_block_name(writer,&function_node->message);
+			model_put_block_name(writer,&function_node->after);
+			model_put_block_name(writer,&function_node->sequence);
+			model_put_block_name(writer,&function_node->condition);
+			model_put_block_name(writer,&function_node->to_timeline_name);
+			model_put_block_name(writer,function_node->trigger);
 
-		write_empty_record(LINKER_API_TYPE_END,outfile);
+			for (count=0, block_name = function_node->triggers_list; block_name != NULL; block_name = block_name->next)
+			{
+				count++;
+			}
 
-		current_type = current_type->next;
+			model_put_varint(writer,count);
+
+			for (block_name = function_node->triggers_list; block_name != NULL; block_name = block_name->next)
+			{
+				model_put_block_name(writer,block_name);
+			}
+
+			model_write(outfile,writer,LINK_MODEL_FUNCTION_NODE,index,function_node->flags,0);
+		}
 	}
 
-	/* now output the constantss for the API */
-	current_constants = api->constants_list;
+	for (application = &g_application_list, index = 0; application != NULL; application = application->next, index++)
+	{
+		output_link_application(outfile,writer,application,index);
+	}
 
-	while (current_constants != NULL)
+	/* the samples are added to the front of the list, so write them backwards */
+	for (sample = g_sample_list.next; sample != NULL; sample = sample->next)
 	{
-		write_pair_record(LINKER_API_CONSTANTS_START,outfile,&current_constants->name,&current_constants->description);
-		
-		current_constant = current_constants->constant_list;
+		num_samples++;
+	}
 
-		while (current_constant != NULL)
+	if (num_samples > 0 && (samples = malloc(num_samples * sizeof(SAMPLE*))) == NULL)
+	{
+		writer->failed = 1;
+	}
+	else if (num_samples > 0)
+	{
+		for (sample = g_sample_list.next, count = num_samples; sample != NULL; sample = sample->next)
 		{
-			write_constant_record(	LINKER_API_CONSTANT,
-									outfile,
-									&current_constant->type,
-									&current_constant->name,
-									&current_constant->value,
-									&current_constant->brief);
-
-			current_constant = current_constant->next;
+			samples[--count] = sample;
 		}
 
-		write_empty_record(LINKER_API_CONSTANTS_END,outfile);
+		for (count=0; count < num_samples; count++)
+		{
+			size[0] = (samples[count]->name.name_length & 0xff00) >> 8;
+			size[1] = (samples[count]->name.name_length & 0x00ff);
+			size[2] = (samples[count]->sample.name_length & 0xff00) >> 8;
+			size[3] = (samples[count]->sample.name_length & 0x00ff);
+
+			model_put(writer,size,4);
+			model_put(writer,samples[count]->name.name,samples[count]->name.name_length);
+			model_put(writer,samples[count]->sample.name,samples[count]->sample.name_length);
+			model_write(outfile,writer,INTERMEDIATE_RECORD_SAMPLE,0,0,0);
+		}
 
-		current_constants = current_constants->next;
+		free(samples);
 	}
-
-	/* Ok, we have finished outputting the API */
-	write_empty_record(LINKER_API_END,outfile);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : output_state_machine
- * Desc : This function will output the state machine to the open file.
+ * Name : output_unresolved
+ * Desc : This function writes a record to the unresolved section.
  *--------------------------------------------------------------------------------*/
-static void	output_state_machine(OUTPUT_FILE* outfile,STATE_MACHINE* state_machine)
+static void	output_unresolved(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer, unsigned char type, GROUP* group, unsigned char* name, unsigned int name_length)
 {
-	unsigned int		node_id = 0;
-	NAME				temp_name;
-	STATE*				current_state = state_machine->state_list;
-	TRIGGERS* 			current_triggers;
-	STATE_TRANSITION*	current_trans;
-	
-	/* enumerate all the states first first */
-	while (current_state != NULL)
+	if (group == NULL)
 	{
-		current_state->tag_id = node_id++;
-
-		current_state = current_state->next;
+		model_put_string(writer,NULL,0);
+	}
+	else
+	{
+		model_put_string(writer,group->name,group->name_length);
 	}
 
-	current_state = state_machine->state_list;
-	
-	temp_name.name			= state_machine->group->name;
-	temp_name.fixed 		= 0;
-	temp_name.name_length	= state_machine->group->name_length;
+	model_put_string(writer,name,name_length);
+	model_write(outfile,writer,type,0,0,0);
+}
 
-	write_string_record(LINKER_STATE_MACHINE_START,outfile,&temp_name);
+/*----- FUNCTION -----------------------------------------------------------------*
+ * Name : output_link_unresolved
+ * Desc : This function writes the symbols that the partial link did not find.
+ *        They are the ghost triggers, states and functions, the messages that
+ *        are sent that nothing waits for and the messages that are waited for
+ *        that nothing sends. The messages of the functions can be in any group
+ *        as the function can be called from any of them. It returns the number
+ *        of symbols written.
+ *--------------------------------------------------------------------------------*/
+static unsigned int	output_link_unresolved(OUTPUT_FILE* outfile, LINK_MODEL_WRITER* writer)
+{
+	unsigned int	result = 0;
+	NODE*			node;
+	GROUP*			group;
+	STATE*			state;
+	MESSAGE*		message;
+	TRIGGER*		trigger;
+	TIMELINE*		target;
+	TIMELINE*		timeline;
+	TIMELINE*		broadcast;
+	FUNCTION*		function;
+	FUNCTION_NODE*	function_node;
+	SYMBOL_TABLE	waits;
+	SYMBOL_TABLE	sends;
+	SYMBOL_TABLE	found;
 
-	while (current_state != NULL)
-	{
-		current_trans = current_state->transition_list;
+	memset(&waits,0,sizeof(SYMBOL_TABLE));
+	memset(&sends,0,sizeof(SYMBOL_TABLE));
+	memset(&found,0,sizeof(SYMBOL_TABLE));
 
-		if (current_state->name_length > 0)
+	/* the waits are by timeline and the sends by group, NULL is any of them */
+	for (function = &g_function_list; function != NULL; function = function->next)
+	{
+		for (function_node = function->node; function_node != NULL; function_node = function_node->next)
 		{
-			write_group_id_record(LINKER_STATE,outfile,current_state->group,current_state->name,current_state->name_length,current_state->tag_id);
+			if (function_node->sequence.name_length > 0)
+			{
+				symbol_table_add_interned(&waits,NULL,function_node->sequence.name,function_node->sequence.name_length,function_node);
+			}
 
-			while(current_trans != NULL)
+			if (function_node->message.name_length > 0)
 			{
-				write_numeric_record(LINKER_TRANSITON,outfile,current_trans->next_state->tag_id);
+				symbol_table_add_interned(&sends,NULL,function_node->message.name,function_node->message.name_length,function_node);
+			}
+		}
+	}
 
-				if (current_trans->trigger != NULL)
+	for (group = &g_group_tree; group != NULL; group = group->next)
+	{
+		for (timeline = (group->sequence_diagram == NULL) ? NULL : group->sequence_diagram->timeline_list; timeline != NULL; timeline = timeline->next)
+		{
+			for (node = timeline->node; node != NULL; node = node->next)
+			{
+				if (node->wait_message.name_length > 0)
 				{
-					write_group_record(	LINKER_TRIGGER,
-										outfile,
-										current_trans->trigger->group,
-										current_trans->trigger->name,
-										current_trans->trigger->name_length);
+					symbol_table_add_interned(&waits,timeline,node->wait_message.name,node->wait_message.name_length,node);
 				}
-				else if (current_trans->condition != NULL)
+
+				if (node->sent_message != NULL)
 				{
-					temp_name.name			= current_trans->condition;
-					temp_name.name_length	= current_trans->condition_length;
-					write_string_record(LINKER_CONDITION,outfile,&temp_name);
+					symbol_table_add_interned(&sends,group,node->sent_message->name,node->sent_message->name_length,node);
 				}
+			}
+		}
+	}
 
-				if (current_trans->triggers != NULL)
+	for (group = &g_group_tree; group != NULL; group = group->next)
+	{
+		for (trigger = group->trigger_list; trigger != NULL; trigger = trigger->next)
+		{
+			if ((trigger->flags & FLAG_GHOST) == FLAG_GHOST)
+			{
+				output_unresolved(outfile,writer,LINK_UNRESOLVED_TRIGGER,group,trigger->name,trigger->name_length);
+				result++;
+			}
+		}
+
+		for (state = (group->state_machine == NULL) ? NULL : group->state_machine->state_list; state != NULL; state = state->next)
+		{
+			if ((state->flags & FLAG_GHOST) == FLAG_GHOST &&
+				!(state->name_length == sizeof("finish")-1 && memcmp(state->name,"finish",sizeof("finish")-1) == 0))
+			{
+				output_unresolved(outfile,writer,LINK_UNRESOLVED_STATE,group,state->name,state->name_length);
+				result++;
+			}
+		}
+
+		if (group->sequence_diagram != NULL)
+		{
+			broadcast = find_timeline(group,string_pool_find((unsigned char*)"broadcast",sizeof("broadcast")-1));
+
+			for (timeline = group->sequence_diagram->timeline_list; timeline != NULL; timeline = timeline->next)
+			{
+				for (node = timeline->node; node != NULL; node = node->next)
 				{
-					current_triggers = current_trans->triggers;
+					message = node->sent_message;
 
-					do
+					if (message != NULL && (message->flags & FLAG_SEQUENCE_RESPONDS) == 0 && message->target_timeline != broadcast)
 					{
-						write_group_record(	LINKER_TRIGGERS,
-											outfile,
-											current_triggers->trigger->group,
-											current_triggers->trigger->name,
-											current_triggers->trigger->name_length);
+						target = (message->target_timeline == NULL) ? timeline : message->target_timeline;
 
-						current_triggers = current_triggers->next;
-					} 
-					while (current_triggers != NULL);
-				}
+						if (symbol_table_find_interned(&waits,target,message->name) == NULL &&
+							symbol_table_find_interned(&waits,NULL,message->name) == NULL &&
+							symbol_table_find_interned(&found,group,message->name) == NULL)
+						{
+							symbol_table_add_interned(&found,group,message->name,message->name_length,message);
+							output_unresolved(outfile,writer,LINK_UNRESOLVED_MESSAGE,group,message->name,message->name_length);
+							result++;
+						}
+					}
 
-				current_trans = current_trans->next;
+					if (node->wait_message.name_length > 0 &&
+						symbol_table_find_interned(&sends,group,node->wait_message.name) == NULL &&
+						symbol_table_find_interned(&sends,NULL,node->wait_message.name) == NULL &&
+						symbol_table_find_interned(&found,timeline,node->wait_message.name) == NULL)
+					{
+						symbol_table_add_interned(&found,timeline,node->wait_message.name,node->wait_message.name_length,node);
+						output_unresolved(outfile,writer,LINK_UNRESOLVED_WAIT,group,node->wait_message.name,node->wait_message.name_length);
+						result++;
+					}
+				}
 			}
+		}
+	}
 
-			/* end the state */
-			write_empty_record(LINKER_END,outfile);
+	for (function = g_function_list.next; function != NULL; function = function->next)
+	{
+		if ((function->flags & FLAG_GHOST) == FLAG_GHOST)
+		{
+			output_unresolved(outfile,writer,LINK_UNRESOLVED_FUNCTION,NULL,function->name,function->name_length);
+			result++;
 		}
-		current_state = current_state->next;
 	}
 
-	write_empty_record(LINKER_STATE_MACHINE_END,outfile);
+	symbol_table_release(&waits);
+	symbol_table_release(&sends);
+	symbol_table_release(&found);
+
+	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : output_sequence_diagram
- * Desc : This function will output the sequence diagram.
+ * Name : output_partial_model
+ * Desc : This function writes a partial model. It has the link model and the
+ *        unresolved symbols, it does not have the sections that pdp reads as
+ *        the model is not complete.
  *--------------------------------------------------------------------------------*/
-static void	output_sequence_diagram(OUTPUT_FILE* outfile, SEQUENCE_DIAGRAM* sequence_diagram)
+static unsigned int	output_partial_model(OUTPUT_FILE* outfile, unsigned char* file_header, LINK_STATE* state)
 {
-	NAME		group_name;
-	NODE*		current_node;
-	MESSAGE*	current_message;
-	TIMELINE*	current_timeline;
-	unsigned int	node_id = 1;
-	unsigned int 	result = EC_OK;
+	unsigned int		start;
+	unsigned int		toc_size = 2 * LINKER_TOC_ENTRY_SIZE;
+	unsigned int		result = EC_OK;
+	unsigned char*		toc;
+	LINK_MODEL_WRITER	writer;
 
-	current_timeline = sequence_diagram->timeline_list;
-	
-	group_name.name			= sequence_diagram->group->name;
-	group_name.fixed 		= 0;
-	group_name.name_length	= sequence_diagram->group->name_length;
-	write_string_record(LINKER_SEQUENCE_START,outfile,&group_name);
+	memset(&writer,0,sizeof(LINK_MODEL_WRITER));
 
-	/* enumerate all the nodes first */
-	while (current_timeline != NULL)
+	if ((toc = calloc(1,toc_size)) == NULL)
 	{
-		current_node = current_timeline->node;
-
-		while (current_node != NULL)
-		{
-			current_node->level = node_id++;
-			current_node = current_node->next;
-		}
-
-		current_timeline = current_timeline->next;
+		result = EC_FAILED;
 	}
-
-	/* now dump the nodes */
-	current_timeline = sequence_diagram->timeline_list;
-
-	while (current_timeline != NULL)
+	else
 	{
-		if ((current_timeline->flags & FLAG_BROADCAST) != FLAG_BROADCAST)
-		{
-			current_node = current_timeline->node;
+		write_long(&file_header[LINKER_V2_TOC_OFF],LINKER_V2_HEADER_SIZE);
+		write_long(&file_header[LINKER_V2_TOC_ENTRIES_OFF],2);
+		write_long(&file_header[LINKER_V2_FILE_SIZE_OFF],0);
 
-			write_group_record(LINKER_TIMELINE,outfile,current_timeline->group,current_timeline->name,current_timeline->name_length);
+		write(outfile->outfile,file_header,LINKER_V2_HEADER_SIZE);
+		write(outfile->outfile,toc,toc_size);
 
-			while (current_node != NULL)
-			{
-				/* start the node */
-				write_numerics_record(LINKER_NODE_START,outfile,current_node->level,current_node->flags);
+		outfile->written = LINKER_V2_HEADER_SIZE + toc_size;
 
-				/* check the messages that have been sent from the current node */
-				current_message = current_node->sent_message;
+		start = file_position(outfile);
+		output_link_model(outfile,&writer);
+		set_toc_entry(&toc[0],LINKER_SECTION_LINK_MODEL,start,file_position(outfile),0,0);
 
-				if (current_message != NULL)
-				{
-					write_message_record(	LINKER_SENT_MESSAGE,
-											outfile,
-											current_node,
-											current_message->receiver,
-											current_message->target_timeline,
-											current_message->name,
-											current_message->name_length);
-				}
+		start = file_position(outfile);
+		state->num_unresolved = output_link_unresolved(outfile,&writer);
+		set_toc_entry(&toc[LINKER_TOC_ENTRY_SIZE],LINKER_SECTION_UNRESOLVED,start,file_position(outfile),0,0);
 
-				if (current_node->received_message == NULL && current_node->wait_message.name_length > 0)
-				{
-					/* TODO: not sure if this is required to be output */
-					printf("found a recives and waits -- need to fix w: %s (%p %p)\n",current_node->wait_message.name,(void*)current_node,(void*)current_node->sent_message);
-				}
+		flush_block(outfile);
 
-				write_empty_record(LINKER_NODE_END,outfile);
+		write_long(&file_header[LINKER_V2_FILE_SIZE_OFF],outfile->written);
 
-				current_node = current_node->next;
-			}
+		if (lseek(outfile->outfile,0,SEEK_SET) == 0)
+		{
+			write(outfile->outfile,file_header,LINKER_V2_HEADER_SIZE);
+			write(outfile->outfile,toc,toc_size);
 		}
 
-		current_timeline = current_timeline->next;
+		if (writer.failed)
+		{
+			raise_warning(0,EC_OUT_OF_MEMORY_OR_FILE_TO_BIG,NULL,NULL);
+			result = EC_FAILED;
+		}
+
+		free(toc);
 	}
 
-	write_empty_record(LINKER_SEQUENCE_END,outfile);
+	free(writer.data);
+	symbol_table_release(&writer.groups);
+
+	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
- * Name : output_samples
- * Desc : This function will output all the samples collected to the output
- *        file.
+ * Name : output_version_2
+ * Desc : This function will output the model in the version 2 format. The table
+ *        of contents is written as a place holder and rewritten once all the
+ *        sections have been written and their offsets are known.
+ *
+ *        If there is a link list then the link state is written after the
+ *        groups. In an incremental link the sections that were not rebuilt are
+ *        copied from the model that they were kept from.
  *--------------------------------------------------------------------------------*/
-static void	output_samples(OUTPUT_FILE* outfile, SAMPLE* list)
+static unsigned int	output_version_2(OUTPUT_FILE* outfile, unsigned char* file_header, LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links)
 {
-	SAMPLE*	current_sample = list;
+	LINK_STATE_SECTION*	section;
+	unsigned int	start;
+	unsigned int	toc_size;
+	unsigned int	name_offset = 0;
+	unsigned int	num_entries = 3;
+	unsigned int	result = EC_OK;
+	unsigned char*	toc;
+	unsigned char*	entry;
+	GROUP*			current = &g_group_tree;
 
-	while (current_sample != NULL)
+	/* strings, samples, applications and then a section per group */
+	while (current != NULL)
 	{
-		write_pair_record(LINKER_SAMPLE,outfile,&current_sample->name,&current_sample->sample);
-		current_sample = current_sample->next;
+		num_entries++;
+		current = current->next;
 	}
-}
 
-#if (MAX_NUM_OPTIONS > 255)
-#error Need to fix the following code to allow for greater the 255 - also will need to fix the processor
-#endif
+	if (link_list != NULL)
+	{
+		num_entries++;
+	}
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * @name: output_synopsis
- * @desc: This function will output the synopsis. As part of this it will try
- *        and validate the options specified in the synopsis list. it will list
- *        the synopsis in the numeric order that they appear in the applications
- *        list.
- *--------------------------------------------------------------------------------*/
-static void	output_synopsis(OUTPUT_FILE* outfile, SYNOPSIS_LIST* synopsys, OPTION* option_list)
-{
-	unsigned int	end;
-	unsigned int	start;
-	unsigned int	item;
-	unsigned int	index = 0;
-	unsigned int	position = 0;
-	unsigned int	name_length;
-	unsigned char	synopsis_index[MAX_NUM_OPTIONS];
-	OPTION*			option;
+	toc_size = num_entries * LINKER_TOC_ENTRY_SIZE;
 
-	while(position < synopsys->items.name_length && index < MAX_NUM_OPTIONS)
+	if ((toc = calloc(1,toc_size)) == NULL)
 	{
-		start = position;
+		result = EC_FAILED;
+	}
+	else
+	{
+		write_long(&file_header[LINKER_V2_TOC_OFF],LINKER_V2_HEADER_SIZE);
+		write_long(&file_header[LINKER_V2_TOC_ENTRIES_OFF],num_entries);
+		write_long(&file_header[LINKER_V2_FILE_SIZE_OFF],0);
 
-		/* remove white space */
-		while ((start < synopsys->items.name_length) && (synopsys->items.name[start] < 0x0f || synopsys->items.name[start] == 0x20))
-		{
-			start++;
-		}
+		write(outfile->outfile,file_header,LINKER_V2_HEADER_SIZE);
+		write(outfile->outfile,toc,toc_size);
 
-		/* find the string */
-		while (synopsys->items.name[position] != ',' && (position < synopsys->items.name_length))
-		{
-			position++;
-		}
+		outfile->written = LINKER_V2_HEADER_SIZE + toc_size;
 
-		/* trim non-valid chars */
-		end = position;
-		while ((end-1 > start) && (synopsys->items.name[end-1] < 0x0f || synopsys->items.name[end-1] == 0x20))
+		/* the string table holds the group names, in the group order */
+		start = file_position(outfile);
+		current = &g_group_tree;
+
+		while (current != NULL)
 		{
-			end--;
+			outfile->parts = 1;
+			outfile->record_size = current->name_length;
+			outfile->buffer_list[0].size = current->name_length;
+			outfile->buffer_list[0].buffer = current->name;
+			write_to_file(outfile);
+
+			current = current->next;
 		}
 
-		/* now find the option in the option list */
-		option = option_list;
+		set_toc_entry(&toc[0],LINKER_SECTION_STRINGS,start,file_position(outfile),0,0);
 
-		name_length = end - start;
+		start = file_position(outfile);
 
-		while (option != NULL)
+		if ((section = link_state_section(state,LINK_TOUCH_SAMPLES,NULL,0)) != NULL)
 		{
-			if (name_length == option->name.name_length && memcmp(&synopsys->items.name[start],option->name.name,name_length) == 0)
-			{
-				/* Ok, found it */
-				synopsis_index[index++] = option->option_id;
-				break;
-			}
-
-			option = option->next;
+			copy_section(outfile,section->data,section->length);
 		}
-
-		if (option == NULL)
-		{
-			unsigned char	hold = synopsys->items.name[end];
-
-			synopsys->items.name[end] = '\0';
-			raise_warning(0,EC_OPTION_REQUIRED_BY_SYNOPSIS_MISSING,&synopsys->items.name[start],NULL);
-			synopsys->items.name[end] = hold;
+		else
+		{
+			output_samples(outfile,g_sample_list.next);
 		}
 
-		position++;
-	}
+		set_toc_entry(&toc[LINKER_TOC_ENTRY_SIZE],LINKER_SECTION_SAMPLES,start,file_position(outfile),0,0);
 
-	/* output the synopsis to the file */
-	write_synopsis_record(LINKER_APPLICATION_SYNOPSIS,outfile,&synopsys->name,synopsis_index,index);
+		start = file_position(outfile);
 
-	if (index == MAX_NUM_OPTIONS)
-	{
-		raise_warning(0,EC_MAX_NUMBER_OF_OPTIONS_IN_SYNOPSIS,NULL,NULL);
-	}
-}
+		if ((section = link_state_section(state,LINK_TOUCH_APPLICATIONS,NULL,0)) != NULL)
+		{
+			copy_section(outfile,section->data,section->length);
+		}
+		else
+		{
+			output_applications(outfile,g_application_list.next);
+		}
 
-/*----- FUNCTION -----------------------------------------------------------------*
- * Name : output_applications
- * Desc : This function will output all the applications collected to the output
- *        file.
- *--------------------------------------------------------------------------------*/
-static void	output_applications(OUTPUT_FILE* outfile, APPLICATION* list)
-{
-	OPTION*			option;
-	SECTION*		section;
-	COMMAND*		command;
-	SECTION*		sub_section;
-	APPLICATION*	application = list;
-	SYNOPSIS_LIST*	synopsis;
+		set_toc_entry(&toc[2 * LINKER_TOC_ENTRY_SIZE],LINKER_SECTION_APPLICATIONS,start,file_position(outfile),0,0);
 
-	while (application != NULL)
-	{
-		if (application->name.name_length > 0)
+		/* now the groups */
+		entry = &toc[3 * LINKER_TOC_ENTRY_SIZE];
+		current = &g_group_tree;
+
+		while (current != NULL)
 		{
-			write_string_record(LINKER_APPLICATION_START,outfile,&application->name);
-	
-			/* now output the options */
-			option = application->option_list;
+			start = file_position(outfile);
 
-			while (option != NULL)
+			/* the groups refer to each other by name, so can be copied from any model */
+			if ((section = link_state_section(state,LINK_TOUCH_GROUP,current->name,current->name_length)) != NULL)
 			{
-				write_option_record(LINKER_APPLICATION_OPTION,outfile,option);
-
-				option = option->next;
+				copy_section(outfile,section->data,section->length);
 			}
-
-			/* now write the synposis */
-			synopsis = &application->synopsis_list;
-
-			while (synopsis != NULL)
+			else
 			{
-				if (synopsis->name.name_length > 0)
-				{
-					/* we have a synopsis and now need to process the list */
-					output_synopsis(outfile,synopsis,application->option_list);
-				}
-
-				synopsis = synopsis->next;
+				output_group(outfile,current);
 			}
 
-			/* now output the commands */
-			command = application->command_list;
-
-			while (command != NULL)
-			{
-				write_type_record(LINKER_APPLICATION_COMMAND,outfile,&command->name,&command->parameters,&command->description);
+			set_toc_entry(entry,LINKER_SECTION_GROUP,start,file_position(outfile),name_offset,current->name_length);
 
-				command = command->next;
-			}
+			name_offset += current->name_length;
+			entry += LINKER_TOC_ENTRY_SIZE;
+			current = current->next;
+		}
 
-			/* now write the sections */
-			section = application->section_list;
-			
-			while (section != NULL)
-			{
-				/* now write the sections to the file */
-				write_pair_record(LINKER_APPLICATION_SECTION,outfile,&section->name,&section->section_data);
-				
-				sub_section = section->sub_section_list;
+		if (link_list != NULL)
+		{
+			start = file_position(outfile);
+			output_link_state(outfile,state,link_list,num_links);
+			set_toc_entry(entry,LINKER_SECTION_LINK_STATE,start,file_position(outfile),0,0);
+		}
 
-				while (sub_section != NULL)
-				{
-					write_pair_record(LINKER_APPLICATION_SUB_SECTION,outfile,&sub_section->name,&sub_section->section_data);
-				
-					sub_section = sub_section->next;
-				}
+		flush_block(outfile);
 
-				section = section->next;
-			}
+		/* now the sections have been written, fill in the contents */
+		write_long(&file_header[LINKER_V2_FILE_SIZE_OFF],outfile->written);
 
-			write_empty_record(LINKER_APPLICATION_END,outfile);
-		
+		if (lseek(outfile->outfile,0,SEEK_SET) == 0)
+		{
+			write(outfile->outfile,file_header,LINKER_V2_HEADER_SIZE);
+			write(outfile->outfile,toc,toc_size);
 		}
-		application = application->next;
+
+		free(toc);
 	}
+
+	return result;
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
  * Name : produce_output
- * Desc : This function will output the resulting linked object file.
+ * Desc : This function will output the resulting linked object file. The link
+ *        state and the partial model are only written in the version 2 format.
  *--------------------------------------------------------------------------------*/
-static unsigned int	produce_output(char* output_name)
+static unsigned int	produce_output(char* output_name, unsigned int version, LINK_STATE* state, LINK_OBJECT** link_list, unsigned int num_links)
 {
 	time_t			now = time(NULL);
 	struct tm*		curr_time = gmtime(&now);
-	unsigned int	in_size;
 	unsigned int	result = EC_OK;
 	unsigned char	signature[4] = LINKED_SOURCE_MAGIC;
-	unsigned char	file_header[FILE_HEADER_SIZE];
-	GROUP*			current = &g_group_tree;
+	unsigned char	signature_v2[4] = LINKED_SOURCE_V2_MAGIC;
+	unsigned char	file_header[LINKER_V2_HEADER_SIZE];
 	OUTPUT_FILE		outfile;
 
 	if (open_file(&outfile,output_name))
 	{
 		/* ok, we have created the output file */
-		file_header[0] = signature[0];
-		file_header[1] = signature[1];
-		file_header[2] = signature[2];
-		file_header[3] = signature[3];
+		if (version == 1)
+		{
+			memcpy(file_header,signature,4);
+		}
+		else
+		{
+			memcpy(file_header,signature_v2,4);
+		}
 
 		file_header[FILE_VERSION_MAJOR] = VERSION_MAJOR;
 		file_header[FILE_VERSION_MINOR] = VERSION_MINOR;
@@ -4412,37 +8995,17 @@ static unsigned int	produce_output(char* output_name)
 		file_header[FILE_MINUTE_OFF ] = (unsigned char) curr_time->tm_min;
 		file_header[FILE_SECONDS_OFF] = (unsigned char) curr_time->tm_sec;
 
-		/* more than one imput file name so set this to zero */
-		file_header[FILE_NAME_LENGTH  ] = 0;
-		file_header[FILE_NAME_LENGTH+1] = 0;
-
-		write(outfile.outfile,file_header,FILE_HEADER_SIZE);
-
-		/* first dump all the samples */
-		output_samples(&outfile,g_sample_list.next);
-
-		/* second dump the applications to the file */
-		output_applications(&outfile,g_application_list.next);
-
-		/* ok, we have an open file */
-		while (current != NULL)
+		if (version == 1)
 		{
-			if (current->state_machine != NULL)
-			{
-				output_state_machine(&outfile,current->state_machine);
-			}
-
-			if (current->sequence_diagram != NULL)
-			{
-				output_sequence_diagram(&outfile,current->sequence_diagram);
-			}
-
-			if (current->api != NULL)
-			{
-				output_api(&outfile,current->api);
-			}
-
-			current = current->next;
+			output_version_1(&outfile,file_header);
+		}
+		else if (g_partial_link)
+		{
+			result = output_partial_model(&outfile,file_header,state);
+		}
+		else
+		{
+			result = output_version_2(&outfile,file_header,state,link_list,num_links);
 		}
 
 		close_file(&outfile);
@@ -4459,13 +9022,33 @@ int main(int argc, const char *argv[])
 	int				quiet = 0;
 	int				failed = 0;
 	int				verbose = 0;
+	unsigned int	version = 2;
 	char*			output_name = "doc.gout";
 	char*			infile_name = NULL;
 	char*			error_param = "";
 	char*			error_string = "";
 	unsigned int	start = 1;
 	unsigned int	output_length = sizeof("doc.gout")-1;
+	unsigned int	num_workers = 1;
+	unsigned int	num_objects = 0;
+	unsigned int	num_members = 0;
+	unsigned int	num_links = 0;
+	unsigned int	incremental = 0;
+	unsigned int	loaded = 0;
+	unsigned int	merged = 0;
+	unsigned int	rebuilt = 0;
+	unsigned int	write_state;
+	unsigned int	member;
 	unsigned char*	param_mask;
+	char*			member_name;
+	char*			link_name = NULL;
+	const char*		reason = "there is no link state in the model";
+	LINK_OBJECT*	objects;
+	LINK_OBJECT*	members = NULL;
+	LINK_OBJECT**	link_list;
+	ARCHIVE_MEMBER*	archive_member;
+	GROUP*			current;
+	LINK_STATE		state;
 
 	param_mask = calloc(argc,1);
 
@@ -4515,6 +9098,18 @@ int main(int argc, const char *argv[])
 						quiet = 1;
 						break;
 
+					/**-----------------------------------------------------------*
+					 * @option	-1
+					 *
+					 * @description
+					 * This writes the model in the version 1 format. This is for
+					 * document processors that do not read the version 2 format
+					 * which has a table of contents.
+					 *------------------------------------------------------------*/
+					case '1':	/* version 1 - write the old model format */
+						version = 1;
+						break;
+
 					/**-----------------------------------------------------------*
 					 * @option		-o
 					 * @value		<output file name>
@@ -4547,6 +9142,73 @@ int main(int argc, const char *argv[])
 						}
 						break;
 
+					/**-----------------------------------------------------------*
+					 * @option		-j
+					 * @value		<number of workers>
+					 * @required	no
+					 *
+					 * @description
+					 * This sets the number of workers that are used to load the
+					 * object files. The objects are always added to the model in
+					 * the order that they are given, so the output is the same
+					 * for any number of workers. The default is one worker.
+					 *------------------------------------------------------------*/
+					case 'j':	/* workers - load the objects in parallel */
+						if (argv[start][2] != '\0')
+						{
+							num_workers = atoi(&argv[start][2]);
+						}
+						else if (((start + 1) < argc) && argv[start+1][0] != '-')
+						{
+							start++;
+							num_workers = atoi(argv[start]);
+							param_mask[start] = 1;
+						}
+						else
+						{
+							error_string = "-j requires a number of workers\n";
+							failed = 1;
+						}
+
+						if (num_workers == 0 || num_workers > WORK_POOL_MAX_WORKERS)
+						{
+							error_string = "-j number of workers is out of range\n";
+							failed = 1;
+						}
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-i
+					 *
+					 * @description
+					 * This links incrementally. The model is written with a link
+					 * state, and when it is linked again only the objects that
+					 * add to the same groups as the changed objects are merged,
+					 * the rest of the groups are copied from the previous model.
+					 * If the previous model cannot be used then all the objects
+					 * are linked. The model is the same as a full link.
+					 *------------------------------------------------------------*/
+					case 'i':	/* incremental - keep the link state in the model */
+						g_link_state = 1;
+						break;
+
+					/**-----------------------------------------------------------*
+					 * @option	-r
+					 *
+					 * @description
+					 * This writes a partial model. A partial model can be given
+					 * to a later link in the place of its objects, so the objects
+					 * of a big tree can be linked in parts on different machines
+					 * and the parts linked together. The partial model holds the
+					 * merged model and the symbols that the objects did not
+					 * resolve, and it is merged without reading the objects
+					 * again. The model is not checked until the final link, as
+					 * the missing symbols may be in another part.
+					 *------------------------------------------------------------*/
+					case 'r':	/* relocatable - write a partial model */
+						g_partial_link = 1;
+						break;
+
 					/**-----------------------------------------------------------*
 					 * @option		-?
 					 *
@@ -4573,6 +9235,16 @@ int main(int argc, const char *argv[])
 	{
 		/* handle failure */
 	}
+	else if (g_link_state && g_partial_link)
+	{
+		error_string = "-i and -r cannot be used together\n";
+		failed = 1;
+	}
+	else if ((g_link_state || g_partial_link) && version == 1)
+	{
+		error_string = "-i and -r cannot be used with -1\n";
+		failed = 1;
+	}
 	else
 	{
 		/**-----------------------------------------------------------*
@@ -4582,29 +9254,217 @@ int main(int argc, const char *argv[])
 		 *
 		 * @description
 		 *
-		 * The object file(s) to link together.
+		 * The object file(s) to link together. An archive that has been
+		 * built by *pdsa* or a partial model that has been built with
+		 * -r can be given in the place of its objects.
 		 *------------------------------------------------------------*/
 		g_input_filename = NULL;
+		write_state = g_link_state;
+
+		objects = calloc(argc,sizeof(LINK_OBJECT));
 
 		for (start = 1; start < argc; start++)
 		{
 			if (param_mask[start] == 0)
 			{
 				/* ok, this should be an input file */
-				failed |= process_input(argv[start]);
+				objects[num_objects++].filename = argv[start];
+			}
+		}
+
+		/* load the objects in parallel, then merge them in the order they were given */
+		work_pool_run(num_workers,num_objects,load_job,objects);
+
+		for (start = 0; start < num_objects; start++)
+		{
+			if (objects[start].is_archive && objects[start].error == EC_OK)
+			{
+				objects[start].first_member = num_members;
+				num_members += objects[start].archive.num_members;
+			}
+		}
+
+		if (num_members > 0)
+		{
+			members = calloc(num_members,sizeof(LINK_OBJECT));
+
+			for (start = 0; start < num_objects; start++)
+			{
+				for (member = 0; objects[start].is_archive && objects[start].error == EC_OK && member < objects[start].archive.num_members; member++)
+				{
+					/* the members are named after the archive for the warnings */
+					archive_member = &objects[start].archive.members[member];
+					member_name = malloc(strlen(objects[start].filename) + archive_member->name_length + sizeof("()"));
+					sprintf(member_name,"%s(%.*s)",objects[start].filename,archive_member->name_length,archive_member->name);
+
+					members[objects[start].first_member + member].filename = member_name;
+					members[objects[start].first_member + member].data = archive_member->data;
+					members[objects[start].first_member + member].size = archive_member->size;
+				}
+			}
+
+			work_pool_run(num_workers,num_members,load_job,members);
+		}
+
+		/* the members are linked in the place of the archive */
+		link_list = calloc(num_objects + num_members + 1,sizeof(LINK_OBJECT*));
+
+		for (start = 0; start < num_objects; start++)
+		{
+			for (member = 0; objects[start].is_archive && objects[start].error == EC_OK && member < objects[start].archive.num_members; member++)
+			{
+				link_list[num_links++] = &members[objects[start].first_member + member];
+			}
+
+			link_list[num_links++] = &objects[start];
+		}
+
+		memset(&state,0,sizeof(LINK_STATE));
+
+		/* the source is the previous model */
+		state.sources = calloc(1,sizeof(LINK_SOURCE*));
+
+		if (write_state && map_input_file(output_name,&state.model) == EC_OK)
+		{
+			if (link_source_read(&state.previous,state.model.data,state.model.size) == EC_OK)
+			{
+				state.sources[state.num_sources++] = &state.previous;
+			}
+			else
+			{
+				link_source_release(&state.previous);
+			}
+		}
+
+		if (state.num_sources > 0)
+		{
+			/* the touches are needed to check the sets that are copied */
+			g_link_state = 1;
+			incremental = link_state_plan(&state,link_list,num_links,&reason);
+		}
+
+		if (incremental)
+		{
+			/* the groups are added in the order of the link, not the models */
+			for (start = 0; start < state.num_order; start++)
+			{
+				add_group(&g_group_tree,state.order[start].name,state.order[start].name_length);
 			}
 		}
 
+		failed |= merge_objects(link_list,num_links,num_workers,incremental,!g_link_state);
+
+		if (incremental && !failed && !link_state_check(&state,link_list,num_links))
+		{
+			/* throw the model away and link all the objects */
+			reason = "a changed object adds to a group that was not rebuilt";
+			incremental = 0;
+			state.incremental = 0;
+
+			reset_model(link_list,num_links);
+			failed |= merge_objects(link_list,num_links,num_workers,0,0);
+		}
+
 		/* change the filename that the error reports are going to be reported against */
 		g_input_filename = (unsigned char*) output_name;
 
-		if (!failed)
+		if (!failed && g_partial_link)
+		{
+			/* the partial model is checked when it is linked */
+			failed = produce_output(output_name,version,&state,NULL,0);
+		}
+		else if (!failed)
 		{
 			if ((failed = semantic_check()) == EC_OK)
 			{
-				failed = produce_output(output_name);
+				if (write_state || state.num_sources > 0)
+				{
+					/* the models are still mapped, so it is replaced when complete */
+					link_name = malloc(strlen(output_name) + sizeof(".tmp"));
+					sprintf(link_name,"%s.tmp",output_name);
+
+					if ((failed = produce_output(link_name,version,&state,(write_state ? link_list : NULL),num_links)) == EC_OK)
+					{
+						failed = (rename(link_name,output_name) != 0);
+					}
+
+					if (failed)
+					{
+						unlink(link_name);
+					}
+
+					free(link_name);
+				}
+				else
+				{
+					failed = produce_output(output_name,version,&state,NULL,0);
+				}
+			}
+		}
+
+		if (verbose && (write_state || state.num_sources > 0))
+		{
+			if (incremental)
+			{
+				for (start = 0; start < num_links; start++)
+				{
+					loaded += link_list[start]->loaded;
+					merged += (link_list[start]->loaded && link_list[start]->merge);
+				}
+
+				for (current = &g_group_tree; current != NULL; current = current->next)
+				{
+					rebuilt += (link_state_section(&state,LINK_TOUCH_GROUP,current->name,current->name_length) == NULL);
+				}
+
+				printf("incremental link: merged %u of %u objects, rebuilt %u of %u groups\n",merged,loaded,rebuilt,state.num_order + 1);
+			}
+			else
+			{
+				printf("full link: %s\n",reason);
+			}
+		}
+
+		if (verbose && g_partial_link && !failed)
+		{
+			printf("partial link: %u unresolved symbols\n",state.num_unresolved);
+		}
+
+		for (start = 0; verbose && start < num_objects; start++)
+		{
+			if (objects[start].is_partial && objects[start].loaded)
+			{
+				printf("partial model %s: %u unresolved symbols\n",objects[start].filename,objects[start].num_unresolved);
 			}
 		}
+
+		for (start = 0; start < num_links; start++)
+		{
+			release_object(link_list[start]);
+			free(link_list[start]->touches);
+		}
+
+		for (start = 0; start < num_members; start++)
+		{
+			free((char*) members[start].filename);
+		}
+
+		link_state_release(&state);
+
+		free(link_list);
+		free(members);
+		free(objects);
+
+		if (verbose)
+		{
+			model_symbol_stats();
+			string_pool_stats();
+			symbol_table_stats(&g_trigger_symbols,"triggers");
+			symbol_table_stats(&g_function_symbols,"functions");
+			symbol_table_stats(&g_api_function_symbols,"api functions");
+			symbol_table_stats(&g_application_symbols,"applications");
+			sequence_stats();
+		}
 	}
 
 	if (failed)
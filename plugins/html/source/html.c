@@ -46,9 +46,9 @@ static unsigned char	canvas_end[]			= "</canvas>";
 static unsigned char	header_start[]			= "<header>";
 static unsigned char	header_end[]			= "</header>";
 
-static unsigned char	header_level_a_start[]	= "<hx id=\"a";		/* these are special and get amended by the code */
+static unsigned char	header_level_a_start[]	= "<hx id=\"a";		/* these are special, the x is replaced by write_header_tag */
 static unsigned char	header_level_a_end[]	= "\">";		
-static unsigned char	header_level_start[]	= "<hx>";			/* these are special and get amended by the code */
+static unsigned char	header_level_start[]	= "<hx>";			/* these are special, the x is replaced by write_header_tag */
 static unsigned char	header_level_end[]		= "</hx>";
 
 static unsigned char	sequence_start[]		= "<div class=centered><canvas id='seq_";	/* the sequence requires an id for the javascript to be able to find it */
@@ -460,6 +460,21 @@ static	PLUGIN_LIBRARY plugin_library =
  * utility functions.
  *--------------------------------------------------------------------------------*/
 
+/*----- FUNCTION -----------------------------------------------------------------*
+ * @name: write_header_tag
+ * @desc: This function writes a header tag with the level in place of the 'x'.
+ *        The tag is copied so that the static strings are not changed.
+ *--------------------------------------------------------------------------------*/
+static void	write_header_tag(DRAW_STATE* draw_state, unsigned char* tag, unsigned int tag_size, unsigned int level_pos, unsigned int level)
+{
+	unsigned char	buffer[16];
+
+	memcpy(buffer,tag,tag_size);
+	buffer[level_pos] = ('0' + level);
+
+	output_sink_write(draw_state,buffer,tag_size);
+}
+
 /*----- FUNCTION -----------------------------------------------------------------*
  * @name: write_escaped_html
  * @desc: This function will write escaped html to the file, it will walk through
@@ -468,7 +483,7 @@ static	PLUGIN_LIBRARY plugin_library =
  *
  *        This function will also search for emp chars and handle those.
  *--------------------------------------------------------------------------------*/
-static void	write_escaped_html(int file_no, unsigned char* buffer, unsigned int buffer_length, unsigned int no_space)
+static void	write_escaped_html(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buffer_length, unsigned int no_space)
 {
 	unsigned int count;
 	unsigned int last_write = 0;
@@ -476,7 +491,7 @@ static void	write_escaped_html(int file_no, unsigned char* buffer, unsigned int
 	if (!text_punctuation(buffer) && !no_space)
 	{
 		/* it's a continuation - so need to add a space */
-		write(file_no," ",1);
+		output_sink_write(draw_state," ",1);
 	}
 
 	for (count=0; count < buffer_length; count++)
@@ -484,16 +499,16 @@ static void	write_escaped_html(int file_no, unsigned char* buffer, unsigned int
 		if (html_lookup[buffer[count]])
 		{
 			/* ok, the char needs escaping */
-			write(file_no,&buffer[last_write],count-last_write);
+			output_sink_write(draw_state,&buffer[last_write],count-last_write);
 			
 			/* skip the char */
 			last_write = count+1;
 
-			write(file_no,html_replace[html_lookup[buffer[count]]].html_char,html_replace[html_lookup[buffer[count]]].size);
+			output_sink_write(draw_state,html_replace[html_lookup[buffer[count]]].html_char,html_replace[html_lookup[buffer[count]]].size);
 		}
 	}
 
-	write(file_no,&buffer[last_write],count-last_write);
+	output_sink_write(draw_state,&buffer[last_write],count-last_write);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -502,7 +517,7 @@ static void	write_escaped_html(int file_no, unsigned char* buffer, unsigned int
  *        all the text in the given buffer and write the escaped chars out instead
  *        of the ascii chars that were passed in.
  *--------------------------------------------------------------------------------*/
-static void	write_escaped_fixed_html(int file_no, unsigned char* buffer, unsigned int buffer_length)
+static void	write_escaped_fixed_html(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buffer_length)
 {
 	unsigned int count;
 	unsigned int last_write = 0;
@@ -512,16 +527,16 @@ static void	write_escaped_fixed_html(int file_no, unsigned char* buffer, unsigne
 		if (html_lookup[buffer[count]])
 		{
 			/* ok, the char needs escaping */
-			write(file_no,&buffer[last_write],count-last_write);
+			output_sink_write(draw_state,&buffer[last_write],count-last_write);
 			
 			/* skip the char */
 			last_write = count+1;
 
-			write(file_no,html_replace[html_lookup[buffer[count]]].html_char,html_replace[html_lookup[buffer[count]]].size);
+			output_sink_write(draw_state,html_replace[html_lookup[buffer[count]]].html_char,html_replace[html_lookup[buffer[count]]].size);
 		}
 	}
 
-	write(file_no,&buffer[last_write],count-last_write);
+	output_sink_write(draw_state,&buffer[last_write],count-last_write);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -631,39 +646,39 @@ static	void	html_generate_sequence_diagrams(DRAW_STATE* draw_state, HTML_SEQUENC
 
 	if (current != NULL)
 	{
-		write(draw_state->output_file,seq_start_script_str,seq_start_script_size);
+		output_sink_write(draw_state,seq_start_script_str,seq_start_script_size);
 
 		while (current != NULL)
 		{
-			write(draw_state->output_file,seq_start_sequence_dia_str,seq_start_sequence_dia_size);
-			write(draw_state->output_file,diagram->name.name,diagram->name.name_length);
-			write(draw_state->output_file,seq_canvas_id_start_str,seq_canvas_id_start_size);
+			output_sink_write(draw_state,seq_start_sequence_dia_str,seq_start_sequence_dia_size);
+			output_sink_write(draw_state,diagram->name.name,diagram->name.name_length);
+			output_sink_write(draw_state,seq_canvas_id_start_str,seq_canvas_id_start_size);
 			num_length = SizeToString(number,current->sequence_no,10);
-			write(draw_state->output_file,&number[10-num_length],num_length);
-			write(draw_state->output_file,seq_start_timelines_str,seq_start_timelines_size);
+			output_sink_write(draw_state,&number[10-num_length],num_length);
+			output_sink_write(draw_state,seq_start_timelines_str,seq_start_timelines_size);
 
 			current_timeline = current->timeline.next;
 
 			/* output timelines first */
 			while (current_timeline != NULL)
 			{
-				write(draw_state->output_file,seq_start_timeline_str,seq_start_timeline_size);
-				write(draw_state->output_file,current_timeline->timeline->name,current_timeline->timeline->name_length);
+				output_sink_write(draw_state,seq_start_timeline_str,seq_start_timeline_size);
+				output_sink_write(draw_state,current_timeline->timeline->name,current_timeline->timeline->name_length);
 
 				/* is it the last timeline? */
 				if (current_timeline->next != NULL)
 				{
-					write(draw_state->output_file,seq_end_timeline_str,seq_end_timeline_size);
+					output_sink_write(draw_state,seq_end_timeline_str,seq_end_timeline_size);
 				}
 				else
 				{
-					write(draw_state->output_file,seq_end_all_timelines_str,seq_end_all_timelines_size);
+					output_sink_write(draw_state,seq_end_all_timelines_str,seq_end_all_timelines_size);
 				}
 
 				current_timeline = current_timeline->next;
 			}
 
-			write(draw_state->output_file,seq_start_messages_str,seq_start_messages_size);
+			output_sink_write(draw_state,seq_start_messages_str,seq_start_messages_size);
 
 			current_message = current->message.next;
 
@@ -672,22 +687,22 @@ static	void	html_generate_sequence_diagrams(DRAW_STATE* draw_state, HTML_SEQUENC
 				/* output the message */
 				num_length = SizeToString(number,current_message->from,10);
 
-				write(draw_state->output_file,seq_start_message_str,seq_start_message_size);
-				write(draw_state->output_file,&number[10-num_length],num_length);
-				write(draw_state->output_file,seq_message_name_str,seq_message_name_size);
-				write(draw_state->output_file,current_message->message->name,current_message->message->name_length);
-				write(draw_state->output_file,seq_message_to_str,seq_message_to_size);
+				output_sink_write(draw_state,seq_start_message_str,seq_start_message_size);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
+				output_sink_write(draw_state,seq_message_name_str,seq_message_name_size);
+				output_sink_write(draw_state,current_message->message->name,current_message->message->name_length);
+				output_sink_write(draw_state,seq_message_to_str,seq_message_to_size);
 				num_length = SizeToString(number,current_message->to,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
 
 				/* is it the last message? */
 				if (current_message->next != NULL)
 				{
-					write(draw_state->output_file,seq_end_message_str,seq_end_message_size);
+					output_sink_write(draw_state,seq_end_message_str,seq_end_message_size);
 				}
 				else
 				{
-					write(draw_state->output_file,seq_end_all_message_str,seq_end_all_message_size);
+					output_sink_write(draw_state,seq_end_all_message_str,seq_end_all_message_size);
 				}
 
 				current_message = current_message->next;
@@ -696,16 +711,16 @@ static	void	html_generate_sequence_diagrams(DRAW_STATE* draw_state, HTML_SEQUENC
 			/* is it the last sequence? */
 			if (current->next != NULL)
 			{
-				write(draw_state->output_file,seq_end_sequence_dia_str,seq_end_sequence_dia_size);
+				output_sink_write(draw_state,seq_end_sequence_dia_str,seq_end_sequence_dia_size);
 			}
 			else
 			{
-				write(draw_state->output_file,seq_end_sequence_table_str,seq_end_sequence_table_size);
+				output_sink_write(draw_state,seq_end_sequence_table_str,seq_end_sequence_table_size);
 			}
 
 			current = current->next;
 		}
-		write(draw_state->output_file,seq_end_script_str,seq_end_script_size);
+		output_sink_write(draw_state,seq_end_script_str,seq_end_script_size);
 	}
 }
 
@@ -727,16 +742,16 @@ static	void	html_generate_state_machines(DRAW_STATE* draw_state, HTML_STATE_MACH
 
 	if (current != NULL)
 	{
-		write(draw_state->output_file,sta_start_script_str,sta_start_script_size);
+		output_sink_write(draw_state,sta_start_script_str,sta_start_script_size);
 
 		while (current != NULL)
 		{
-			write(draw_state->output_file,sta_start_sequence_dia_str,sta_start_sequence_dia_size);
-			write(draw_state->output_file,diagram->name.name,diagram->name.name_length);
+			output_sink_write(draw_state,sta_start_sequence_dia_str,sta_start_sequence_dia_size);
+			output_sink_write(draw_state,diagram->name.name,diagram->name.name_length);
 			
-			write(draw_state->output_file,sta_canvas_id_start_str,sta_canvas_id_start_size);
+			output_sink_write(draw_state,sta_canvas_id_start_str,sta_canvas_id_start_size);
 			num_length = SizeToString(number,current->state_machine_no,10);
-			write(draw_state->output_file,&number[10-num_length],num_length);
+			output_sink_write(draw_state,&number[10-num_length],num_length);
 
 			/* need to write the size of the grid */
 			max_y = 0;
@@ -754,61 +769,61 @@ static	void	html_generate_state_machines(DRAW_STATE* draw_state, HTML_STATE_MACH
 				}
 			}
 
-			write(draw_state->output_file,sta_x_size_str,sta_x_size_size);
+			output_sink_write(draw_state,sta_x_size_str,sta_x_size_size);
 			num_length = SizeToString(number,max_x,10);
-			write(draw_state->output_file,&number[10-num_length],num_length);
+			output_sink_write(draw_state,&number[10-num_length],num_length);
 
-			write(draw_state->output_file,sta_y_size_str,sta_y_size_size);
+			output_sink_write(draw_state,sta_y_size_str,sta_y_size_size);
 			num_length = SizeToString(number,max_y,10);
-			write(draw_state->output_file,&number[10-num_length],num_length);
+			output_sink_write(draw_state,&number[10-num_length],num_length);
 
 			/* ok, now dump the nodes of the state_machine */
-			write(draw_state->output_file,sta_start_nodes_str,sta_start_nodes_size);
+			output_sink_write(draw_state,sta_start_nodes_str,sta_start_nodes_size);
 
 			for (count=0;count<current->state_machine->num_nodes; count++)
 			{
-				write(draw_state->output_file,sta_start_node_name_str,sta_start_node_name_size);
-				write(draw_state->output_file,current->state_machine->node_list[count].state->name,current->state_machine->node_list[count].state->name_length);
+				output_sink_write(draw_state,sta_start_node_name_str,sta_start_node_name_size);
+				output_sink_write(draw_state,current->state_machine->node_list[count].state->name,current->state_machine->node_list[count].state->name_length);
 
-				write(draw_state->output_file,sta_start_node_x_str,sta_start_node_x_size);
+				output_sink_write(draw_state,sta_start_node_x_str,sta_start_node_x_size);
 				num_length = SizeToString(number,current->state_machine->node_list[count].x,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
 
-				write(draw_state->output_file,sta_start_node_y_str,sta_start_node_y_size);
+				output_sink_write(draw_state,sta_start_node_y_str,sta_start_node_y_size);
 				num_length = SizeToString(number,current->state_machine->node_list[count].y,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
 
 				if (count != current->state_machine->num_nodes-1)
 				{
-					write(draw_state->output_file,sta_end_node_str,sta_end_node_size);
+					output_sink_write(draw_state,sta_end_node_str,sta_end_node_size);
 				}
 				else
 				{
-					write(draw_state->output_file,sta_end_all_nodes_str,sta_end_all_nodes_size);
+					output_sink_write(draw_state,sta_end_all_nodes_str,sta_end_all_nodes_size);
 				}
 			}
 
 			/* output the vertices to the javascript */
-			write(draw_state->output_file,sta_start_vertex_str,sta_start_vertex_size);
+			output_sink_write(draw_state,sta_start_vertex_str,sta_start_vertex_size);
 
 			for (count=0; count < current->state_machine->num_vertices; count++)
 			{
-				write(draw_state->output_file,sta_start_from_str,sta_start_from_size);
+				output_sink_write(draw_state,sta_start_from_str,sta_start_from_size);
 				num_length = SizeToString(number,current->state_machine->vertex_list[count].from,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
 
-				write(draw_state->output_file,sta_start_to_str,sta_start_to_size);
+				output_sink_write(draw_state,sta_start_to_str,sta_start_to_size);
 				num_length = SizeToString(number,current->state_machine->vertex_list[count].to,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
 
-				write(draw_state->output_file,sta_trigger_str,sta_trigger_size);
+				output_sink_write(draw_state,sta_trigger_str,sta_trigger_size);
 
 				if (current->state_machine->vertex_list[count].transition->trigger != NULL && current->state_machine->vertex_list[count].transition->trigger->name_length > 0)
 				{
-					write(draw_state->output_file,current->state_machine->vertex_list[count].transition->trigger->name,current->state_machine->vertex_list[count].transition->trigger->name_length);
+					output_sink_write(draw_state,current->state_machine->vertex_list[count].transition->trigger->name,current->state_machine->vertex_list[count].transition->trigger->name_length);
 				}
 
-				write(draw_state->output_file,sta_triggers_str,sta_triggers_size);
+				output_sink_write(draw_state,sta_triggers_str,sta_triggers_size);
 				current_triggers = current->state_machine->vertex_list[count].transition->triggers;
 
 				while (current_triggers != NULL)
@@ -817,16 +832,16 @@ static	void	html_generate_state_machines(DRAW_STATE* draw_state, HTML_STATE_MACH
 					{
 						if (current_triggers->trigger->group != NULL)
 						{
-							write(draw_state->output_file,current_triggers->trigger->group->name,current_triggers->trigger->group->name_length);
-							write(draw_state->output_file,":",1);
+							output_sink_write(draw_state,current_triggers->trigger->group->name,current_triggers->trigger->group->name_length);
+							output_sink_write(draw_state,":",1);
 						}
 
-						write(draw_state->output_file,current_triggers->trigger->name,current_triggers->trigger->name_length);
+						output_sink_write(draw_state,current_triggers->trigger->name,current_triggers->trigger->name_length);
 					}
 
 					if (current_triggers->next != NULL)
 					{
-						write(draw_state->output_file,sta_triggers_gap_str,sta_triggers_gap_size);
+						output_sink_write(draw_state,sta_triggers_gap_str,sta_triggers_gap_size);
 					}
 
 					current_triggers = current_triggers->next;
@@ -834,27 +849,27 @@ static	void	html_generate_state_machines(DRAW_STATE* draw_state, HTML_STATE_MACH
 
 				if (count != current->state_machine->num_vertices - 1)
 				{
-					write(draw_state->output_file,sta_end_vertex_str,sta_end_vertex_size);
+					output_sink_write(draw_state,sta_end_vertex_str,sta_end_vertex_size);
 				}
 				else
 				{
-					write(draw_state->output_file,sta_end_all_vertex_str,sta_end_all_vertex_size);
+					output_sink_write(draw_state,sta_end_all_vertex_str,sta_end_all_vertex_size);
 				}
 			}
 
 			if (current->next != NULL)
 			{
-				write(draw_state->output_file,sta_end_vertices_str,sta_end_vertices_size);
+				output_sink_write(draw_state,sta_end_vertices_str,sta_end_vertices_size);
 			}
 			else
 			{
-				write(draw_state->output_file,sta_end_state_table_str,sta_end_state_table_size);
+				output_sink_write(draw_state,sta_end_state_table_str,sta_end_state_table_size);
 			}
 
 			current = current->next;
 		}
 
-		write(draw_state->output_file,sta_end_script_str,sta_end_script_size);
+		output_sink_write(draw_state,sta_end_script_str,sta_end_script_size);
 	}
 }
 
@@ -1004,17 +1019,16 @@ unsigned int	format_open(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsig
 			html_init_table(&((HTML_DATA*)draw_state->format_state)->sequence_diagram);
 
 			/* file successfully opened - write header*/
-			write(draw_state->output_file,page_start_part1,page_start_part1_size);
-			write_escaped_html(draw_state->output_file,name,name_length,draw_state->no_space);
-			draw_state->no_space = 0;
-			write(draw_state->output_file,page_start_part2,page_start_part2_size);
-			write(draw_state->output_file,draw_state->model->document->document_name.name,draw_state->model->document->document_name.name_length);
-			write(draw_state->output_file,page_start_part3,page_start_part3_size);
+			output_sink_write(draw_state,page_start_part1,page_start_part1_size);
+			write_escaped_html(draw_state,name,name_length,1);
+			output_sink_write(draw_state,page_start_part2,page_start_part2_size);
+			output_sink_write(draw_state,draw_state->model->document->document_name.name,draw_state->model->document->document_name.name_length);
+			output_sink_write(draw_state,page_start_part3,page_start_part3_size);
 			
 			temp_length = make_version_string(draw_state->model->document->version,version_buffer);
-			write(draw_state->output_file,&version_buffer[temp_length],VERSION_STRING_LENGTH - temp_length);
+			output_sink_write(draw_state,&version_buffer[temp_length],VERSION_STRING_LENGTH - temp_length);
 
-			write(draw_state->output_file,page_start_part4,page_start_part4_size);
+			output_sink_write(draw_state,page_start_part4,page_start_part4_size);
 
 			input_state->title.name = index_name.name;
 			input_state->title.name_length = index_name.name_length;
@@ -1022,7 +1036,7 @@ unsigned int	format_open(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsig
 			input_state->title.name = NULL;
 			input_state->title.name_length = 0;
 
-			write(draw_state->output_file,page_start_part5,page_start_part5_size);
+			output_sink_write(draw_state,page_start_part5,page_start_part5_size);
 
 			result = EC_OK;
 		}
@@ -1044,8 +1058,8 @@ void	format_close(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 
 		/* TODO: need to write the footer here */
 
-		write(draw_state->output_file,page_end,page_end_size);
-		close(draw_state->output_file);
+		output_sink_write(draw_state,page_end,page_end_size);
+		output_sink_close(draw_state);
 		free(draw_state->output_buffer);
 	}
 
@@ -1079,9 +1093,9 @@ static void	html_start_box(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 		{
 			buffer_start = index_generate_label(input_state->index_item,0, INDEX_STYLE_NUMBERS,buffer,256,'_');
 			
-			write(draw_state->output_file,index_anchor_start,index_anchor_start_size);
-			write(draw_state->output_file,&buffer[buffer_start],256-buffer_start);
-			write(draw_state->output_file,index_anchor_end,index_anchor_end_size);
+			output_sink_write(draw_state,index_anchor_start,index_anchor_start_size);
+			output_sink_write(draw_state,&buffer[buffer_start],256-buffer_start);
+			output_sink_write(draw_state,index_anchor_end,index_anchor_end_size);
 		}
 
 		name_length = name_name.name_length + 1 + input_state->title.name_length;
@@ -1107,13 +1121,13 @@ static void	html_start_box(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 	/* start the box */
 	if (name.name_length > 0)
 	{
-		write(draw_state->output_file,item_start,item_start_size);
-		write(draw_state->output_file,name.name,name.name_length);
-		write(draw_state->output_file,item_header_end,item_header_end_size);
+		output_sink_write(draw_state,item_start,item_start_size);
+		output_sink_write(draw_state,name.name,name.name_length);
+		output_sink_write(draw_state,item_header_end,item_header_end_size);
 	}
 	else
 	{
-		write(draw_state->output_file,item_no_header,item_no_header_size);
+		output_sink_write(draw_state,item_no_header,item_no_header_size);
 	}
 
 	/* release the name */
@@ -1126,7 +1140,7 @@ static void	html_start_box(DRAW_STATE* draw_state, INPUT_STATE* input_state)
  *--------------------------------------------------------------------------------*/
 static void	html_end_box(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 {
-	write(draw_state->output_file,item_end,item_end_size);
+	output_sink_write(draw_state,item_end,item_end_size);
 	((HTML_DATA*)draw_state->format_state)->suppress_title = 0;
 }
 
@@ -1152,10 +1166,10 @@ void	format_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 			if ((draw_state->format_flags & OUTPUT_FORMAT_TABLE) == 0)
 			{
 				/* write the start of the state machine header to the file */
-				write(draw_state->output_file,state_start,state_start_size);
+				output_sink_write(draw_state,state_start,state_start_size);
 				num_length = SizeToString(number,((HTML_DATA*)draw_state->format_state)->state_machine.state_machine_no,10);
-				write(draw_state->output_file,&number[10-num_length],num_length);
-				write(draw_state->output_file,sequence_end,sequence_end_size);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
+				output_sink_write(draw_state,sequence_end,sequence_end_size);
 
 				/* now allocate the structure */
 				html_add_state_machine(&((HTML_DATA*)draw_state->format_state)->state_machine,&name);
@@ -1170,10 +1184,10 @@ void	format_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 			if ((draw_state->format_flags & OUTPUT_FORMAT_TABLE) == 0)
 			{
 				/* write the start of the sequence header to the file */
-				write(draw_state->output_file,sequence_start,sequence_start_size);
+				output_sink_write(draw_state,sequence_start,sequence_start_size);
 				num_length = SizeToString(number,((HTML_DATA*)draw_state->format_state)->sequence_diagram.sequence_no,10);	
-				write(draw_state->output_file,&number[10-num_length],num_length);
-				write(draw_state->output_file,sequence_end,sequence_end_size);
+				output_sink_write(draw_state,&number[10-num_length],num_length);
+				output_sink_write(draw_state,sequence_end,sequence_end_size);
 
 				html_add_sequence(&((HTML_DATA*)draw_state->format_state)->sequence_diagram,&name);
 			}
@@ -1183,11 +1197,11 @@ void	format_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 				/* this is a boxed item - start the box */
 				html_start_box(draw_state,input_state);
 
-				write(draw_state->output_file,pre_start,pre_start_size);
+				output_sink_write(draw_state,pre_start,pre_start_size);
 			break;
 
 		case TYPE_QUOTE_BLOCK: 
-				write(draw_state->output_file,blockquote_start,blockquote_start_size);
+				output_sink_write(draw_state,blockquote_start,blockquote_start_size);
 			break;
 		
 		case TYPE_TABLE:
@@ -1235,11 +1249,11 @@ static void	html_list_level_up(DRAW_STATE* draw_state, unsigned int new_level)
 		{
 			if (((HTML_DATA*)draw_state->format_state)->list_state.level_char[count] == '1')
 			{
-				write(draw_state->output_file,numb_list_end,numb_list_end_size);
+				output_sink_write(draw_state,numb_list_end,numb_list_end_size);
 			}
 			else
 			{
-				write(draw_state->output_file,list_end,list_end_size);
+				output_sink_write(draw_state,list_end,list_end_size);
 			}
 		}
 	}
@@ -1266,7 +1280,7 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 				state_machine_draw(((HTML_DATA*)draw_state->format_state)->state_machine.next->state_machine,draw_state);
 	
 				/* end the html */
-				write(draw_state->output_file,sequence_finish,sequence_finish_size);
+				output_sink_write(draw_state,sequence_finish,sequence_finish_size);
 			}
 
 			html_end_box(draw_state,input_state);
@@ -1277,7 +1291,7 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 		{
 			if ((draw_state->format_flags & OUTPUT_FORMAT_TABLE) == 0)
 			{
-				write(draw_state->output_file,sequence_finish,sequence_finish_size);
+				output_sink_write(draw_state,sequence_finish,sequence_finish_size);
 			}
 
 			html_end_box(draw_state,input_state);
@@ -1285,12 +1299,12 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 		break;
 
 		case TYPE_CODE_BLOCK:
-			write(draw_state->output_file,pre_end,pre_end_size);
+			output_sink_write(draw_state,pre_end,pre_end_size);
 			html_end_box(draw_state,input_state);
 		break;
 
 		case TYPE_QUOTE_BLOCK: 
-			write(draw_state->output_file,blockquote_end,blockquote_end_size);
+			output_sink_write(draw_state,blockquote_end,blockquote_end_size);
 		break;
 
 		case TYPE_TABLE:
@@ -1331,8 +1345,8 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
  *--------------------------------------------------------------------------------*/
 void	format_raw(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buffer_size)
 {
-	write(draw_state->output_file,line_break,line_break_size);
-	write(draw_state->output_file,buffer,buffer_size);
+	output_sink_write(draw_state,line_break,line_break_size);
+	output_sink_write(draw_state,buffer,buffer_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1344,13 +1358,13 @@ void	format_raw(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buff
  *--------------------------------------------------------------------------------*/
 void	format_sample(DRAW_STATE* draw_state, SAMPLE* sample)
 {
-	write(draw_state->output_file,section_start,section_start_size);
-	write(draw_state->output_file,pre_start,pre_start_size);
+	output_sink_write(draw_state,section_start,section_start_size);
+	output_sink_write(draw_state,pre_start,pre_start_size);
 	
-	write_escaped_fixed_html(draw_state->output_file,sample->sample.name,sample->sample.name_length);
+	write_escaped_fixed_html(draw_state,sample->sample.name,sample->sample.name_length);
 
-	write(draw_state->output_file,pre_end,pre_end_size);
-	write(draw_state->output_file,section_end,section_end_size);
+	output_sink_write(draw_state,pre_end,pre_end_size);
+	output_sink_write(draw_state,section_end,section_end_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1365,7 +1379,7 @@ void	format_timelines(DRAW_STATE* draw_state)
 	TIMELINE* 		current = draw_state->data.sequence.start_timeline;
 	
 	/* unformatted man page line */
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 		
 	offset = draw_state->data.sequence.column[current->column] - draw_state->data.sequence.window_start;
 	write_size = write_size;
@@ -1394,7 +1408,7 @@ void	format_timelines(DRAW_STATE* draw_state)
 		current = current->next;
 	}
 		
-	write(draw_state->output_file,draw_state->output_buffer,write_size);
+	output_sink_write(draw_state,draw_state->output_buffer,write_size);
 	
 	/* stop duplication of timelines when the bottom is called */
 	((HTML_DATA*)draw_state->format_state)->sequence_diagram.next->timelines = 1;
@@ -1520,8 +1534,8 @@ void	format_message(DRAW_STATE* draw_state, MESSAGE* message)
 			pos = draw_state->data.sequence.column[count] - draw_state->data.sequence.window_start;
 
 			/* now write the line to the file */
-			write(draw_state->output_file,"\n",1);
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->data.sequence.column[draw_state->data.sequence.num_columns]);
+			output_sink_write(draw_state,"\n",1);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->data.sequence.column[draw_state->data.sequence.num_columns]);
 		}
 	}
 }
@@ -1573,10 +1587,10 @@ void	format_marker(DRAW_STATE* draw_state, unsigned int marker)
 			break;
 
 		case OUTPUT_MARKER_EMP_START:
-			write(draw_state->output_file,italic_start,italic_start_size);
+			output_sink_write(draw_state,italic_start,italic_start_size);
 			break;
 		case OUTPUT_MARKER_EMP_END:
-			write(draw_state->output_file,italic_end,italic_end_size);
+			output_sink_write(draw_state,italic_end,italic_end_size);
 			break;
 
 		case (OUTPUT_MARKER_HEADER_START|OUTPUT_MARKER_NO_INDEX):
@@ -1588,31 +1602,29 @@ void	format_marker(DRAW_STATE* draw_state, unsigned int marker)
 				
 			size = level_index_gen_label(&draw_state->index,1,INDEX_STYLE_NUMBERS,array,200,'_');
 
-			header_level_a_start[2] = ('0' + level);
-			write(draw_state->output_file,header_level_a_start,header_level_a_start_size);
-			write(draw_state->output_file,array,size);
-			write(draw_state->output_file,header_level_a_end,header_level_a_end_size);
+			write_header_tag(draw_state,header_level_a_start,header_level_a_start_size,2,level);
+			output_sink_write(draw_state,array,size);
+			output_sink_write(draw_state,header_level_a_end,header_level_a_end_size);
 			break;
 
 		case OUTPUT_MARKER_HEADER_END:
-			header_level_end[3] = ('0' + level);
-			write(draw_state->output_file,header_level_end,header_level_end_size);
+			write_header_tag(draw_state,header_level_end,header_level_end_size,3,level);
 			break;
 		
 		case OUTPUT_MARKER_LINE_BREAK:
-			write(draw_state->output_file,line_break,line_break_size);
+			output_sink_write(draw_state,line_break,line_break_size);
 			draw_state->offset = 0;
 			break;
 
 		case OUTPUT_MARKER_PARAGRAPH_BREAK:
-			write(draw_state->output_file,paragraph,paragraph_size);
+			output_sink_write(draw_state,paragraph,paragraph_size);
 			draw_state->offset = 0;
 			break;
 
 		case OUTPUT_MARKER_ASCII_CHAR:
 			array[0] = (unsigned char) marker & 0x7f;
 			draw_state->offset++;
-			write(draw_state->output_file,array,1);
+			output_sink_write(draw_state,array,1);
 			break;
 	}
 }
@@ -1625,58 +1637,58 @@ void	format_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* text)
 {
 	if (text_style & OUTPUT_TEXT_STYLE_L_NEWLINE)
 	{
-		write(draw_state->output_file,line_break,line_break_size);
+		output_sink_write(draw_state,line_break,line_break_size);
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_L_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_CODE)
 	{
-		write(draw_state->output_file,code_start,code_start_size);
+		output_sink_write(draw_state,code_start,code_start_size);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_BOLD)
 	{
-		write(draw_state->output_file,bold_start,bold_start_size);
+		output_sink_write(draw_state,bold_start,bold_start_size);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_ITALIC)
 	{
-		write(draw_state->output_file,italic_start,italic_start_size);
+		output_sink_write(draw_state,italic_start,italic_start_size);
 	}
 
 	if (text != NULL)
 	{
-		write_escaped_html(draw_state->output_file,text->name,text->name_length,draw_state->no_space);
+		write_escaped_html(draw_state,text->name,text->name_length,draw_state->no_space);
 		draw_state->no_space = 0;
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_ITALIC))
 	{
-		write(draw_state->output_file,italic_end,italic_end_size);
+		output_sink_write(draw_state,italic_end,italic_end_size);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_BOLD)
 	{
-		write(draw_state->output_file,bold_end,bold_end_size);
+		output_sink_write(draw_state,bold_end,bold_end_size);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_CODE)
 	{
-		write(draw_state->output_file,code_end,code_end_size);
+		output_sink_write(draw_state,code_end,code_end_size);
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_T_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_T_NEWLINE)
 	{
-		write(draw_state->output_file,line_break,line_break_size);
+		output_sink_write(draw_state,line_break,line_break_size);
 	}
 }
 
@@ -1687,28 +1699,26 @@ void	format_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* text)
 void	format_section(DRAW_STATE* draw_state, unsigned int header_level,NAME* name, unsigned int format, NAME* section_data)
 {
 	header_level &= MAX_HEADER_LEVEL_MASK;
-	header_level_start[2] = ('0' + header_level);
-	write(draw_state->output_file,header_level_start,header_level_start_size);
-	write_escaped_html(draw_state->output_file,name->name,name->name_length,draw_state->no_space);
+	write_header_tag(draw_state,header_level_start,header_level_start_size,2,header_level);
+	write_escaped_html(draw_state,name->name,name->name_length,draw_state->no_space);
 	draw_state->no_space = 0;
 
-	header_level_end[3] = ('0' + header_level);
-	write(draw_state->output_file,header_level_end,header_level_end_size);
+	write_header_tag(draw_state,header_level_end,header_level_end_size,3,header_level);
 	
-	write(draw_state->output_file,paragraph,paragraph_size);
+	output_sink_write(draw_state,paragraph,paragraph_size);
 	
 	if (section_data->fixed)
 	{
-		write(draw_state->output_file,pre_start,pre_start_size);
-		write_escaped_fixed_html(draw_state->output_file,section_data->name,section_data->name_length);
-		write(draw_state->output_file,pre_end,pre_end_size);
+		output_sink_write(draw_state,pre_start,pre_start_size);
+		write_escaped_fixed_html(draw_state,section_data->name,section_data->name_length);
+		output_sink_write(draw_state,pre_end,pre_end_size);
 	}
 	else
 	{
-		write_escaped_html(draw_state->output_file,section_data->name,section_data->name_length,draw_state->no_space);
+		write_escaped_html(draw_state,section_data->name,section_data->name_length,draw_state->no_space);
 		draw_state->no_space = 0;
 	}
-	write(draw_state->output_file,paragraph,paragraph_size);
+	output_sink_write(draw_state,paragraph,paragraph_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1720,21 +1730,19 @@ void	format_title(DRAW_STATE* draw_state, unsigned int header_level, NAME* title
 	if (!((HTML_DATA*)draw_state->format_state)->suppress_title)
 	{
 		header_level &= MAX_HEADER_LEVEL_MASK;
-		header_level_start[2] = ('0' + header_level);
-		write(draw_state->output_file,header_level_start,header_level_start_size);
+		write_header_tag(draw_state,header_level_start,header_level_start_size,2,header_level);
 
-		write_escaped_html(draw_state->output_file,title->name,title->name_length,draw_state->no_space);
+		write_escaped_html(draw_state,title->name,title->name_length,draw_state->no_space);
 		draw_state->no_space = 0;
 
 		if (name != NULL)
 		{
-			write(draw_state->output_file,space,space_size);
-			write_escaped_html(draw_state->output_file,name->name,name->name_length,draw_state->no_space);
+			output_sink_write(draw_state,space,space_size);
+			write_escaped_html(draw_state,name->name,name->name_length,draw_state->no_space);
 			draw_state->no_space = 0;
 		}
 
-		header_level_end[3] = ('0' + header_level);
-		write(draw_state->output_file,header_level_end,header_level_end_size);
+		write_header_tag(draw_state,header_level_end,header_level_end_size,3,header_level);
 	}
 }
 
@@ -1746,14 +1754,14 @@ void	format_block(DRAW_STATE* draw_state, unsigned int format, NAME* block)
 {
 	if (block->fixed)
 	{
-		write(draw_state->output_file,pre_start,pre_start_size);
+		output_sink_write(draw_state,pre_start,pre_start_size);
 	}
 
 	write_block_text(draw_state,block,format);
 
 	if (block->fixed)
 	{
-		write(draw_state->output_file,pre_end,pre_end_size);
+		output_sink_write(draw_state,pre_end,pre_end_size);
 	}
 }
 
@@ -1765,23 +1773,23 @@ void	format_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 {
 	if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_PROTOTYPE)
 	{
-		write(draw_state->output_file,table_start_proto,table_start_proto_size);
+		output_sink_write(draw_state,table_start_proto,table_start_proto_size);
 	}
 	else if ((table_layout->table_flags & OUTPUT_TABLE_FORMAT_BOXED) && (table_layout->table_flags & OUTPUT_TABLE_FORMAT_FULL_WIDTH))
 	{
-		write(draw_state->output_file,table_start_fb,table_start_fb_size);
+		output_sink_write(draw_state,table_start_fb,table_start_fb_size);
 	}
 	else if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_BOXED)
 	{
-		write(draw_state->output_file,table_start_box,table_start_box_size);
+		output_sink_write(draw_state,table_start_box,table_start_box_size);
 	}
 	else if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_FULL_WIDTH)
 	{
-		write(draw_state->output_file,table_start_full,table_start_full_size);
+		output_sink_write(draw_state,table_start_full,table_start_full_size);
 	}
 	else
 	{
-		write(draw_state->output_file,table_start,table_start_size);
+		output_sink_write(draw_state,table_start,table_start_size);
 	}
 }
 
@@ -1793,25 +1801,25 @@ void	format_table_header(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TAB
 {
 	unsigned int count = 0;
 
-	write(draw_state->output_file,table_row_start,table_row_start_size);
+	output_sink_write(draw_state,table_row_start,table_row_start_size);
 	
 	for (count = 0; count < table_layout->num_columns; count++)
 	{
-		write(draw_state->output_file,table_head_start,table_head_start_size);
+		output_sink_write(draw_state,table_head_start,table_head_start_size);
 
 		if (table_row->row[count] != NULL && table_row->row[count]->name)
 		{
-			write_escaped_fixed_html(draw_state->output_file,table_row->row[count]->name,table_row->row[count]->name_length);
+			write_escaped_fixed_html(draw_state,table_row->row[count]->name,table_row->row[count]->name_length);
 		}
 		else
 		{
-			write(draw_state->output_file,space,space_size);
+			output_sink_write(draw_state,space,space_size);
 		}
 
-		write(draw_state->output_file,table_head_end,table_head_end_size);
+		output_sink_write(draw_state,table_head_end,table_head_end_size);
 	}
 
-	write(draw_state->output_file,table_row_end,table_row_end_size);
+	output_sink_write(draw_state,table_row_end,table_row_end_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1822,25 +1830,25 @@ void	format_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TABLE_
 {
 	unsigned int count = 0;
 
-	write(draw_state->output_file,table_row_start,table_row_start_size);
+	output_sink_write(draw_state,table_row_start,table_row_start_size);
 	
 	for (count = 0; count < table_layout->num_columns; count++)
 	{
-		write(draw_state->output_file,table_col_start,table_col_start_size);
+		output_sink_write(draw_state,table_col_start,table_col_start_size);
 
 		if (table_row->row[count] != NULL && table_row->row[count]->name)
 		{
-			write_escaped_fixed_html(draw_state->output_file,table_row->row[count]->name,table_row->row[count]->name_length);
+			write_escaped_fixed_html(draw_state,table_row->row[count]->name,table_row->row[count]->name_length);
 		}
 		else
 		{
-			write(draw_state->output_file,space,space_size);
+			output_sink_write(draw_state,space,space_size);
 		}
 
-		write(draw_state->output_file,table_col_end,table_col_end_size);
+		output_sink_write(draw_state,table_col_end,table_col_end_size);
 	}
 
-	write(draw_state->output_file,table_row_end,table_row_end_size);
+	output_sink_write(draw_state,table_row_end,table_row_end_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1849,7 +1857,7 @@ void	format_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TABLE_
  *--------------------------------------------------------------------------------*/
 void	format_table_end(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 {
-	write(draw_state->output_file,table_end,table_end_size);
+	output_sink_write(draw_state,table_end,table_end_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1871,23 +1879,23 @@ void	format_index_start_sublevel(DRAW_STATE* draw_state, DOC_SECTION* index_item
 
 	start = index_generate_label(index_item,0,INDEX_STYLE_NUMBERS,temp,200,'_');
 
-	write(draw_state->output_file,index_down_part1,index_down_part1_size);
-	write(draw_state->output_file,
+	output_sink_write(draw_state,index_down_part1,index_down_part1_size);
+	output_sink_write(draw_state,
 			((HTML_DATA*)draw_state->format_state)->index_state.index_number_str,
 			((HTML_DATA*)draw_state->format_state)->index_state.index_number_size);
-	write(draw_state->output_file,&temp[start],200-start);
-	write(draw_state->output_file,index_down_part2,index_down_part2_size);
-	write(draw_state->output_file,&temp[start],200-start);
-	write(draw_state->output_file,index_down_part3,index_down_part3_size);
-	write(draw_state->output_file,index_item->section_title.name,index_item->section_title.name_length);
-	write(draw_state->output_file,index_down_part4,index_down_part4_size);
-
-	write(draw_state->output_file,index_toggle_part1,index_toggle_part1_size);
-	write(draw_state->output_file,
+	output_sink_write(draw_state,&temp[start],200-start);
+	output_sink_write(draw_state,index_down_part2,index_down_part2_size);
+	output_sink_write(draw_state,&temp[start],200-start);
+	output_sink_write(draw_state,index_down_part3,index_down_part3_size);
+	output_sink_write(draw_state,index_item->section_title.name,index_item->section_title.name_length);
+	output_sink_write(draw_state,index_down_part4,index_down_part4_size);
+
+	output_sink_write(draw_state,index_toggle_part1,index_toggle_part1_size);
+	output_sink_write(draw_state,
 			((HTML_DATA*)draw_state->format_state)->index_state.index_number_str,
 			((HTML_DATA*)draw_state->format_state)->index_state.index_number_size);
-	write(draw_state->output_file,&temp[start],200-start);
-	write(draw_state->output_file,index_toggle_part2,index_toggle_part2_size);
+	output_sink_write(draw_state,&temp[start],200-start);
+	output_sink_write(draw_state,index_toggle_part2,index_toggle_part2_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1901,11 +1909,11 @@ void	format_index_entry(DRAW_STATE* draw_state, DOC_SECTION* index_item)
 
 	start = index_generate_label(index_item,0,INDEX_STYLE_NUMBERS,temp,200,'_');
 
-	write(draw_state->output_file,index_item_part1,index_item_part1_size);
-	write(draw_state->output_file,&temp[start],200-start);
-	write(draw_state->output_file,index_item_part2,index_item_part2_size);
-	write(draw_state->output_file,index_item->section_title.name,index_item->section_title.name_length);
-	write(draw_state->output_file,index_item_part3,index_item_part3_size);
+	output_sink_write(draw_state,index_item_part1,index_item_part1_size);
+	output_sink_write(draw_state,&temp[start],200-start);
+	output_sink_write(draw_state,index_item_part2,index_item_part2_size);
+	output_sink_write(draw_state,index_item->section_title.name,index_item->section_title.name_length);
+	output_sink_write(draw_state,index_item_part3,index_item_part3_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1914,7 +1922,7 @@ void	format_index_entry(DRAW_STATE* draw_state, DOC_SECTION* index_item)
  *--------------------------------------------------------------------------------*/
 void	format_index_end_sublevel(DRAW_STATE* draw_state, DOC_SECTION* index_item)
 {
-	write(draw_state->output_file,"</div>",6);
+	output_sink_write(draw_state,"</div>",6);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1925,10 +1933,10 @@ static void	write_list_start(DRAW_STATE* draw_state, unsigned char marker)
 {
 	switch(marker)
 	{
-		case '1':	write(draw_state->output_file,numb_list_start,numb_list_start_size);	break;
-		case '-':	write(draw_state->output_file,dash_list_start,dash_list_start_size);	break;
-		case '+':	write(draw_state->output_file,plus_list_start,plus_list_start_size);	break;
-		case '*':	write(draw_state->output_file,asti_list_start,asti_list_start_size);	break;
+		case '1':	output_sink_write(draw_state,numb_list_start,numb_list_start_size);	break;
+		case '-':	output_sink_write(draw_state,dash_list_start,dash_list_start_size);	break;
+		case '+':	output_sink_write(draw_state,plus_list_start,plus_list_start_size);	break;
+		case '*':	output_sink_write(draw_state,asti_list_start,asti_list_start_size);	break;
 	}
 }
 
@@ -1965,7 +1973,7 @@ void	format_list_item_start(DRAW_STATE* draw_state, unsigned int level, unsigned
 	/* write the new list start and set the level */
 	((HTML_DATA*)draw_state->format_state)->list_state.list_level = level;
 	level_index_set_level(&draw_state->list_index,level);
-	write(draw_state->output_file,list_item_start,list_item_start_size);
+	output_sink_write(draw_state,list_item_start,list_item_start_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -2001,7 +2009,7 @@ void	format_list_numeric_start(DRAW_STATE* draw_state, unsigned int level)
 	/* write the new list start and set the level */
 	((HTML_DATA*)draw_state->format_state)->list_state.list_level = level;
 	level_index_set_level(&draw_state->list_index,level);
-	write(draw_state->output_file,list_item_start,list_item_start_size);
+	output_sink_write(draw_state,list_item_start,list_item_start_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -2010,6 +2018,6 @@ void	format_list_numeric_start(DRAW_STATE* draw_state, unsigned int level)
  *--------------------------------------------------------------------------------*/
 void	format_list_end(DRAW_STATE* draw_state)
 {
-	write(draw_state->output_file,list_item_end,list_item_end_size);
+	output_sink_write(draw_state,list_item_end,list_item_end_size);
 }
 
@@ -195,7 +195,7 @@ unsigned int	DGOF_plugin_release(void)
  *
  *  TODO: It should also escape any manpage commands it finds in the text.
  *--------------------------------------------------------------------------------*/
-static void	write_escaped_manpage(int file_no, unsigned char* buffer, unsigned int buffer_length)
+static void	write_escaped_manpage(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buffer_length)
 {
 	unsigned int emp = 0;
 	unsigned int end_emp = 0;
@@ -208,8 +208,8 @@ static void	write_escaped_manpage(int file_no, unsigned char* buffer, unsigned i
 		if (space && (buffer[count] == '*' || buffer[count] == '_'))
 		{
 			/* emp start */
-			write(file_no,&buffer[last_write],count-last_write);
-			write(file_no,troff_bold,troff_bold_size);
+			output_sink_write(draw_state,&buffer[last_write],count-last_write);
+			output_sink_write(draw_state,troff_bold,troff_bold_size);
 			last_write = count+1;
 
 			emp = 1;
@@ -223,8 +223,8 @@ static void	write_escaped_manpage(int file_no, unsigned char* buffer, unsigned i
 			if (buffer[count] == 0x20)
 			{
 				/* end the emphasis */
-				write(file_no,&buffer[last_write],count-last_write-1);
-				write(file_no,"\n.\n",3);
+				output_sink_write(draw_state,&buffer[last_write],count-last_write-1);
+				output_sink_write(draw_state,"\n.\n",3);
 				last_write = count+1;
 
 				emp = 0;
@@ -238,7 +238,7 @@ static void	write_escaped_manpage(int file_no, unsigned char* buffer, unsigned i
 		space = (buffer[count] == 0x20);
 	}
 
-	write(file_no,&buffer[last_write],count-last_write);
+	output_sink_write(draw_state,&buffer[last_write],count-last_write);
 }
 
 
@@ -283,11 +283,11 @@ unsigned int	format_open(DRAW_STATE* draw_state, INPUT_STATE* input_state, unsig
 		if ((draw_state->output_file = open((char*)draw_state->path,O_CREAT | O_TRUNC | O_WRONLY, S_IWUSR | S_IRUSR)) != -1)
 		{
 			/* file successfully opened */
-			write(draw_state->output_file,troff_title,troff_title_size);
-			write(draw_state->output_file,name,name_length);
-			write(draw_state->output_file," 1",2);
-			write(draw_state->output_file,troff_new_para,troff_new_para_size);
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,troff_title,troff_title_size);
+			output_sink_write(draw_state,name,name_length);
+			output_sink_write(draw_state," 1",2);
+			output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+			output_sink_write(draw_state,"\n",1);
 
 			/* create the format state data */
 			draw_state->format_state = calloc(1,sizeof(MANPAGE_DATA));
@@ -306,7 +306,7 @@ void	format_close(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 {
 	if (draw_state->output_file != -1)
 	{
-		close(draw_state->output_file);
+		output_sink_close(draw_state);
 		free(draw_state->output_buffer);
 	}
 
@@ -327,7 +327,7 @@ void	format_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 	{
 		case TYPE_STATE_MACHINE:
 			state_machine_allocate((TEXT_STATE_MACHINE**)&draw_state->data.state_machine.data);
-			write(draw_state->output_file,troff_no_interspace,troff_no_interspace_size);
+			output_sink_write(draw_state,troff_no_interspace,troff_no_interspace_size);
 			break;
 
 		case TYPE_LIST:
@@ -338,8 +338,8 @@ void	format_header(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 	
 	if ((draw_state->format_flags & OUTPUT_FORMAT_INLINE) == 0)
 	{
-		write(draw_state->output_file,troff_new_para,troff_new_para_size);
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+		output_sink_write(draw_state,"\n",1);
 	}
 }
 
@@ -355,7 +355,7 @@ static void	manpage_list_level_up(DRAW_STATE* draw_state, unsigned int new_level
 	{
 		for (count = ((MANPAGE_DATA*)draw_state->format_state)->list_level; count > new_level; count--)
 		{
-			write(draw_state->output_file,troff_margin_left,troff_margin_left_size);
+			output_sink_write(draw_state,troff_margin_left,troff_margin_left_size);
 		}
 	}
 }
@@ -375,9 +375,9 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 				state_machine_release(draw_state->data.state_machine.data);
 				draw_state->data.state_machine.data = NULL;
 
-				write(draw_state->output_file,troff_interspace,troff_interspace_size);
-				write(draw_state->output_file,troff_new_para,troff_new_para_size);
-				write(draw_state->output_file,"\n",1);
+				output_sink_write(draw_state,troff_interspace,troff_interspace_size);
+				output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+				output_sink_write(draw_state,"\n",1);
 			}
 		break;
 
@@ -388,9 +388,9 @@ void	format_footer(DRAW_STATE* draw_state, INPUT_STATE* input_state)
 
 	if ((draw_state->format_flags & OUTPUT_FORMAT_INLINE) == 0)
 	{
-		write(draw_state->output_file,troff_interspace,troff_interspace_size);
-		write(draw_state->output_file,troff_new_para,troff_new_para_size);
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,troff_interspace,troff_interspace_size);
+		output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+		output_sink_write(draw_state,"\n",1);
 
 		draw_state->offset = 0;
 	}
@@ -412,8 +412,8 @@ void	format_raw(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buff
 		{
 			if (offset - start_point > 1)
 			{
-				write(draw_state->output_file,"\n ",2);
-				write(draw_state->output_file,&buffer[start_point],offset-start_point);
+				output_sink_write(draw_state,"\n ",2);
+				output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 			}
 			start_point = offset + 1;
 		}
@@ -422,8 +422,8 @@ void	format_raw(DRAW_STATE* draw_state, unsigned char* buffer, unsigned int buff
 
 	if (start_point < offset)
 	{
-		write(draw_state->output_file,"\n ",2);
-		write(draw_state->output_file,&buffer[start_point],offset-start_point);
+		output_sink_write(draw_state,"\n ",2);
+		output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 	}
 }
 
@@ -452,8 +452,8 @@ void	format_sample(DRAW_STATE* draw_state, SAMPLE* sample)
 		{
 			if (offset - start_point > 1)
 			{
-				write(draw_state->output_file,"\n ",2);
-				write(draw_state->output_file,&buffer[start_point],offset-start_point);
+				output_sink_write(draw_state,"\n ",2);
+				output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 			}
 			start_point = offset + 1;
 		}
@@ -462,8 +462,8 @@ void	format_sample(DRAW_STATE* draw_state, SAMPLE* sample)
 
 	if (start_point < offset)
 	{
-		write(draw_state->output_file,"\n ",2);
-		write(draw_state->output_file,&buffer[start_point],offset-start_point);
+		output_sink_write(draw_state,"\n ",2);
+		output_sink_write(draw_state,&buffer[start_point],offset-start_point);
 	}
 }
 
@@ -478,9 +478,9 @@ void	format_timelines(DRAW_STATE* draw_state)
 	TIMELINE* 		current = draw_state->data.sequence.start_timeline;
 	
 	/* unformatted man page line */
-	write(draw_state->output_file,troff_no_interspace,troff_no_interspace_size);
-	write(draw_state->output_file,troff_new_para,troff_new_para_size);
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,troff_no_interspace,troff_no_interspace_size);
+	output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+	output_sink_write(draw_state,"\n",1);
 		
 	offset = draw_state->data.sequence.column[current->column] - draw_state->data.sequence.window_start;
 	write_size = write_size;
@@ -506,7 +506,7 @@ void	format_timelines(DRAW_STATE* draw_state)
 		current = current->next;
 	}
 			
-	write(draw_state->output_file,draw_state->output_buffer,write_size);
+	output_sink_write(draw_state,draw_state->output_buffer,write_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -523,8 +523,8 @@ void	format_message(DRAW_STATE* draw_state, MESSAGE* message)
 	unsigned char	special = '<';
 	unsigned char*	buffer;
 	
-	write(draw_state->output_file,troff_new_para,troff_new_para_size);
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+	output_sink_write(draw_state,"\n",1);
 
 	buffer = &draw_state->output_buffer[draw_state->margin_width];
 
@@ -628,7 +628,7 @@ void	format_message(DRAW_STATE* draw_state, MESSAGE* message)
 			pos = draw_state->data.sequence.column[count] - draw_state->data.sequence.window_start;
 
 			/* now write the line to the file */
-			write(draw_state->output_file,draw_state->output_buffer,draw_state->page_width+1);
+			output_sink_write(draw_state,draw_state->output_buffer,draw_state->page_width+1);
 		}
 	}
 }
@@ -678,10 +678,10 @@ void	format_marker(DRAW_STATE* draw_state, unsigned int marker)
 			break;
 		
 		case OUTPUT_MARKER_EMP_START:
-			write(draw_state->output_file,troff_italic,troff_italic_size);
+			output_sink_write(draw_state,troff_italic,troff_italic_size);
 			break;
 		case OUTPUT_MARKER_EMP_END:
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 			break;
 
 		case OUTPUT_MARKER_HEADER_START:
@@ -692,29 +692,29 @@ void	format_marker(DRAW_STATE* draw_state, unsigned int marker)
 
 			if (level == 0)
 			{
-				write(draw_state->output_file,troff_section,troff_section_size);
+				output_sink_write(draw_state,troff_section,troff_section_size);
 			}
 			else
 			{
-				write(draw_state->output_file,troff_subsection,troff_subsection_size);
+				output_sink_write(draw_state,troff_subsection,troff_subsection_size);
 			}
 			break;
 
 		case OUTPUT_MARKER_HEADER_END:
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 			break;
 
 		case OUTPUT_MARKER_PARAGRAPH_BREAK:
 		case OUTPUT_MARKER_LINE_BREAK:
 			draw_state->offset = 0;
-			write(draw_state->output_file,troff_new_para,troff_new_para_size);
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+			output_sink_write(draw_state,"\n",1);
 			break;
 
 		case OUTPUT_MARKER_ASCII_CHAR:
 			array[0] = (unsigned char) marker & 0x7f;
 			draw_state->offset++;
-			write(draw_state->output_file,array,1);
+			output_sink_write(draw_state,array,1);
 			break;
 	}
 }
@@ -729,60 +729,60 @@ void	format_text(DRAW_STATE* draw_state, unsigned int text_style, NAME* text)
 	{
 		if (!draw_state->no_space)
 		{
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 		}
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_L_NEWLINE)
 	{
-		write(draw_state->output_file,troff_new_para,troff_new_para_size);
+		output_sink_write(draw_state,troff_new_para,troff_new_para_size);
 	}
 
 #if 0	
 	if (text_style & (OUTPUT_TEXT_STYLE_L_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 	}
 #endif
 
 	if (text_style & OUTPUT_TEXT_STYLE_BOLD)
 	{
-		write(draw_state->output_file,troff_bold,troff_bold_size);
+		output_sink_write(draw_state,troff_bold,troff_bold_size);
 	}
 	
 	if (text_style & (OUTPUT_TEXT_STYLE_ITALIC))
 	{
-		write(draw_state->output_file,troff_italic,troff_italic_size);
+		output_sink_write(draw_state,troff_italic,troff_italic_size);
 	}
 
 	if (text != NULL)
 	{
 		if (text->name[0] == '.' || text->name[0] == ' ')
 		{
-			write(draw_state->output_file,"\\&",2);
+			output_sink_write(draw_state,"\\&",2);
 		}
 
 		if (text_style & OUTPUT_TEXT_STYLE_ASCII_ART)
 		{
-			write(draw_state->output_file,"\n",1);
+			output_sink_write(draw_state,"\n",1);
 		}
 
-		write(draw_state->output_file,text->name,text->name_length);
+		output_sink_write(draw_state,text->name,text->name_length);
 	}
 
 	if (text_style & (OUTPUT_TEXT_STYLE_BOLD | OUTPUT_TEXT_STYLE_ITALIC))
 	{
-	/*	write(draw_state->output_file,"\n.",2); */
+	/*	output_sink_write(draw_state,"\n.",2); */
 	}
 	else if (text_style & (OUTPUT_TEXT_STYLE_T_SPACE | OUTPUT_TEXT_STYLE_SPACED))
 	{
 		/*don't write the space after a newline */
-		write(draw_state->output_file," ",1);
+		output_sink_write(draw_state," ",1);
 	}
 
 	if (text_style & OUTPUT_TEXT_STYLE_T_NEWLINE)
 	{
-		write(draw_state->output_file,troff_new_para,troff_new_para_size);
+		output_sink_write(draw_state,troff_new_para,troff_new_para_size);
 	}
 }
 
@@ -802,13 +802,13 @@ void	format_section(DRAW_STATE* draw_state, unsigned int header_level,NAME* name
 		case OHL_LEVEL_4:	level_str = troff_header_4; break;
 	}
 
-	write(draw_state->output_file,level_str,troff_header_level_size);
-	write(draw_state->output_file,troff_bold,troff_bold_size);
-	write(draw_state->output_file,name->name,name->name_length);
+	output_sink_write(draw_state,level_str,troff_header_level_size);
+	output_sink_write(draw_state,troff_bold,troff_bold_size);
+	output_sink_write(draw_state,name->name,name->name_length);
 		
-	write(draw_state->output_file,troff_margin_right,troff_margin_right_size);
-	write_escaped_manpage(draw_state->output_file,section_data->name,section_data->name_length);	
-	write(draw_state->output_file,troff_margin_left,troff_margin_left_size);
+	output_sink_write(draw_state,troff_margin_right,troff_margin_right_size);
+	write_escaped_manpage(draw_state,section_data->name,section_data->name_length);	
+	output_sink_write(draw_state,troff_margin_left,troff_margin_left_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -827,15 +827,15 @@ void	format_title(DRAW_STATE* draw_state, unsigned int header_level, NAME* title
 		case OHL_LEVEL_4:	level_str = troff_header_4; break;
 	}
 
-	write(draw_state->output_file,troff_bold,troff_bold_size);
-	write(draw_state->output_file,title->name,title->name_length);
+	output_sink_write(draw_state,troff_bold,troff_bold_size);
+	output_sink_write(draw_state,title->name,title->name_length);
 
 	if (name != NULL)
 	{
-		write(draw_state->output_file,troff_italic,troff_italic_size);
-		write(draw_state->output_file,name->name,name->name_length);
+		output_sink_write(draw_state,troff_italic,troff_italic_size);
+		output_sink_write(draw_state,name->name,name->name_length);
 	}
-	write(draw_state->output_file,troff_new_para,troff_new_para_size);
+	output_sink_write(draw_state,troff_new_para,troff_new_para_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -863,8 +863,8 @@ void	format_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 		divider = '|';
 	}
 
-	write(draw_state->output_file,tbl_start,tbl_start_size);
-	write(draw_state->output_file,"left,tab(#);\n",sizeof("left,tab(#);\n")-1);
+	output_sink_write(draw_state,tbl_start,tbl_start_size);
+	output_sink_write(draw_state,"left,tab(#);\n",sizeof("left,tab(#);\n")-1);
 
 	/* for the header row */
 	if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_HEADER)
@@ -881,9 +881,9 @@ void	format_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 				options[opt_count++] = divider;
 			}
 
-			write(draw_state->output_file,options,opt_count);
+			output_sink_write(draw_state,options,opt_count);
 		}
-		write(draw_state->output_file,"\n",1);
+		output_sink_write(draw_state,"\n",1);
 	}
 
 	/* handle the column layout */
@@ -913,7 +913,7 @@ void	format_table_start(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 			options[opt_count++] = '.';
 		}
 
-		write(draw_state->output_file,options,opt_count);
+		output_sink_write(draw_state,options,opt_count);
 	}
 }
 
@@ -925,31 +925,31 @@ void	format_table_header(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TAB
 {
 	unsigned int count;
 	
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 
 	if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_BOXED)
 	{
-		write(draw_state->output_file,"=\n",2);
+		output_sink_write(draw_state,"=\n",2);
 	}
 
 	for (count=0;count<table_layout->num_columns;count++)
 	{
 		if (table_row->row[count] != NULL && table_row->row[count]->name)
 		{
-			write(draw_state->output_file,table_row->row[count]->name,table_row->row[count]->name_length);
+			output_sink_write(draw_state,table_row->row[count]->name,table_row->row[count]->name_length);
 		}
 
 		if (count+1 < table_layout->num_columns)
 		{
-			write(draw_state->output_file,"#",1);
+			output_sink_write(draw_state,"#",1);
 		}
 	}
 	
-	write(draw_state->output_file,"",1);
+	output_sink_write(draw_state,"",1);
 
 	if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_BOXED)
 	{
-		write(draw_state->output_file,"\n=",2);
+		output_sink_write(draw_state,"\n=",2);
 	}
 }
 
@@ -961,20 +961,20 @@ void	format_table_row(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout, TABLE_
 {
 	unsigned int count;
 	
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 
 	for (count=0;count<table_layout->num_columns;count++)
 	{
 		if (table_row->row[count] != NULL && table_row->row[count]->name)
 		{
-			write(draw_state->output_file,"T{\n",3);
-			write(draw_state->output_file,table_row->row[count]->name,table_row->row[count]->name_length);
-			write(draw_state->output_file,"\nT}",3);
+			output_sink_write(draw_state,"T{\n",3);
+			output_sink_write(draw_state,table_row->row[count]->name,table_row->row[count]->name_length);
+			output_sink_write(draw_state,"\nT}",3);
 		}
 
 		if (count+1 < table_layout->num_columns)
 		{
-			write(draw_state->output_file,"#",1);
+			output_sink_write(draw_state,"#",1);
 		}
 	}
 }
@@ -987,11 +987,11 @@ void	format_table_end(DRAW_STATE* draw_state, TABLE_LAYOUT* table_layout)
 {
 	if (table_layout->table_flags & OUTPUT_TABLE_FORMAT_BOXED)
 	{
-		write(draw_state->output_file,"\n=",2);
+		output_sink_write(draw_state,"\n=",2);
 	}
 
-	write(draw_state->output_file,tbl_end,tbl_end_size);
-	write(draw_state->output_file,troff_new_para,troff_new_para_size);
+	output_sink_write(draw_state,tbl_end,tbl_end_size);
+	output_sink_write(draw_state,troff_new_para,troff_new_para_size);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1045,7 +1045,7 @@ void	format_list_item_start(DRAW_STATE* draw_state, unsigned int level, unsigned
 	else if (((MANPAGE_DATA*)draw_state->format_state)->list_level < level)
 	{
 		/* going up a level */
-		write(draw_state->output_file,troff_margin_right,troff_margin_right_size);
+		output_sink_write(draw_state,troff_margin_right,troff_margin_right_size);
 	}
 	
 	/* write the new list start and set the level */
@@ -1055,14 +1055,14 @@ void	format_list_item_start(DRAW_STATE* draw_state, unsigned int level, unsigned
 
 	if (marker == '*')
 	{
-		write(draw_state->output_file,troff_bullet,troff_bullet_size);
+		output_sink_write(draw_state,troff_bullet,troff_bullet_size);
 	}
 	else
 	{
-		write(draw_state->output_file,"\\",1);
-		write(draw_state->output_file,&marker,1);
+		output_sink_write(draw_state,"\\",1);
+		output_sink_write(draw_state,&marker,1);
 	}
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,"\n",1);
 }
 
 /*----- FUNCTION -----------------------------------------------------------------*
@@ -1086,7 +1086,7 @@ void	format_list_numeric_start(DRAW_STATE* draw_state, unsigned int level)
 	else if (((MANPAGE_DATA*)draw_state->format_state)->list_level < level)
 	{
 		/* going up a level */
-		write(draw_state->output_file,troff_margin_right,troff_margin_right_size);
+		output_sink_write(draw_state,troff_margin_right,troff_margin_right_size);
 	}
 	
 	/* write the new list start and set the level */
@@ -1109,7 +1109,7 @@ void	format_list_numeric_start(DRAW_STATE* draw_state, unsigned int level)
  *--------------------------------------------------------------------------------*/
 void	format_list_end(DRAW_STATE* draw_state)
 {
-	write(draw_state->output_file,troff_new_para,troff_new_para_size);
-	write(draw_state->output_file,"\n",1);
+	output_sink_write(draw_state,troff_new_para,troff_new_para_size);
+	output_sink_write(draw_state,"\n",1);
 }
 